@@ -38,19 +38,26 @@
 #define USE_GLSL_IMPL           0
 #define USE_CUDA_SYNC_IMPL      0
 #define USE_CUDA_ASYNC_IMPL     0
+#define USE_CPU_THREADS_IMPL    0
 ////////////////////////////////
 #define DATASET_ID              Dataset_CDnet // comment this line to fall back to custom dataset definition
 #define DATASET_OUTPUT_PATH     "results_test" // will be created in the app's working directory if using a custom dataset
 #define DATASET_PRECACHING      1
 #define DATASET_SCALE_FACTOR    1.0
 #define DATASET_WORKTHREADS     1
+#define DATASET_MAXACTIVESTREAMS DATASET_WORKTHREADS // bounds the number of batches precached & modeled at once
+// note: algorithms share the process-wide rand() state, and the engine's pool does not pin streams to workers, so results are only reproducible with a single worker thread
 #define DATASET_FORCE_GRAYSCALE 0
+#define DATASET_OUTPUT_ENCODER  lv::DataEncoder_PNG_Max // default archive format; e.g. lv::DataEncoder_PNG or lv::DataEncoder_BitPacked write masks much faster
+#define DATASET_OUTPUT_QUEUE_MB 64 // async output writing queue size (0 = synchronous writing)
 ////////////////////////////////
 #define USE_CUDA_IMPL (USE_CUDA_SYNC_IMPL||USE_CUDA_ASYNC_IMPL)
 #define USE_GPU_IMPL (USE_GLSL_IMPL||USE_CUDA_SYNC_IMPL||USE_CUDA_ASYNC_IMPL)
 #define USE_LITIV_IMPL (USE_PAWCS||USE_LOBSTER||USE_SUBSENSE)
-#if (USE_GLSL_IMPL+USE_CUDA_SYNC_IMPL+USE_CUDA_ASYNC_IMPL)>1
+#if (USE_GLSL_IMPL+USE_CUDA_SYNC_IMPL+USE_CUDA_ASYNC_IMPL+USE_CPU_THREADS_IMPL)>1
 #error "Must specify a single impl."
+#elif USE_CPU_THREADS_IMPL && !(USE_LOBSTER || USE_SUBSENSE)
+#error "Multi-threaded cpu impl only available for LOBSTER & SuBSENSE."
 #elif (USE_LOBSTER+USE_SUBSENSE+USE_PAWCS+USE_GMM)!=1
 #error "Must specify a single algorithm."
 #endif //USE_...
@@ -99,6 +106,9 @@ constexpr lv::ParallelAlgoType eAlgoImplTypeEnum = lv::CUDA;
 constexpr lv::ParallelAlgoType eDatasetImplTypeEnum = lv::CUDA;
 constexpr lv::ParallelAlgoType eAlgoImplTypeEnum = lv::CUDA;
 #endif //USE_CUDA_..._IMPL
+#elif USE_CPU_THREADS_IMPL
+constexpr lv::ParallelAlgoType eDatasetImplTypeEnum = lv::NonParallel;
+constexpr lv::ParallelAlgoType eAlgoImplTypeEnum = lv::CPUThreads;
 #else // USE_..._IMPL
 constexpr lv::ParallelAlgoType eDatasetImplTypeEnum = lv::NonParallel;
 constexpr lv::ParallelAlgoType eAlgoImplTypeEnum = lv::NonParallel;
@@ -130,7 +140,11 @@ using BackgroundSubtractorType = cv::BackgroundSubtractorMOG2;
 #error "Missing gpu impl for requested algorithm."
 #endif //USE_...(algo)
 
+#if USE_GPU_IMPL
 void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch);
+#else //!USE_GPU_IMPL
+void Analyze(const lv::IDataHandlerPtrArray& vpBatches);
+#endif //!USE_GPU_IMPL
 
 int main(int, char**) {
 #if USE_PROFILING
@@ -144,14 +158,19 @@ int main(int, char**) {
         if(nTotBatches==0 || nTotPackets==0)
             lvError_("Could not parse any data for dataset '%s'",pDataset->getName().c_str());
         std::cout << "\n[" << lv::getTimeStamp() << "]\n" << std::endl;
-        std::cout << "Executing algorithm with " << (USE_GPU_IMPL?1:DATASET_WORKTHREADS) << " thread(s)..." << std::endl;
-        lv::WorkerPool<(USE_GPU_IMPL?1:DATASET_WORKTHREADS)> oPool;
+    #if USE_GPU_IMPL
+        std::cout << "Executing algorithm with 1 thread..." << std::endl;
+        lv::WorkerPool<1> oPool;
         std::vector<std::future<void>> vTaskResults;
         size_t nCurrBatchIdx = 1;
         for(lv::IDataHandlerPtr pBatch : vpBatches)
             vTaskResults.push_back(oPool.queueTask(Analyze,std::to_string(nCurrBatchIdx++)+"/"+std::to_string(nTotBatches),pBatch));
         for(std::future<void>& oTaskRes : vTaskResults)
             oTaskRes.get();
+    #else //!USE_GPU_IMPL
+        std::cout << "Executing algorithm with " << DATASET_WORKTHREADS << " thread(s) over " << nTotBatches << " stream(s)..." << std::endl;
+        Analyze(vpBatches);
+    #endif //!USE_GPU_IMPL
         pDataset->writeEvalReport();
     }
     catch(const lv::Exception&) {std::cout << "\n!!!!!!!!!!!!!!\nTop level caught lv::Exception (check stderr)\n!!!!!!!!!!!!!!\n" << std::endl; return -1;}
@@ -189,6 +208,9 @@ void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
         const double dDefaultLearningRate = pAlgo->getDefaultLearningRate();
         oBatch.initialize_gl(pAlgo);
         oContext.setWindowSize(oBatch.getIdealGLWindowSize());
+    #if WRITE_IMG_OUTPUT
+        oBatch.setOutputEncoder(DATASET_OUTPUT_ENCODER,size_t(DATASET_OUTPUT_QUEUE_MB)*1024*1024);
+    #endif //WRITE_IMG_OUTPUT
         oBatch.startProcessing();
         size_t nNextIdx = 1;
         while(nNextIdx<=nTotPacketCount) {
@@ -273,6 +295,9 @@ void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
     #if USE_CUDA_ASYNC_IMPL
         oBatch.initialize_cuda(pAlgo);
     #endif //USE_CUDA_ASYNC_IMPL
+    #if WRITE_IMG_OUTPUT
+        oBatch.setOutputEncoder(DATASET_OUTPUT_ENCODER,size_t(DATASET_OUTPUT_QUEUE_MB)*1024*1024);
+    #endif //WRITE_IMG_OUTPUT
         oBatch.startProcessing();
         while(nCurrIdx<nTotPacketCount) {
             if(!((nCurrIdx+1)%100))
@@ -343,87 +368,169 @@ void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
     }
 }
 #else //!USE_GPU_IMPL
-void Analyze(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
-    srand(0); // for now, assures that two consecutive runs on the same data return the same results
-    //srand((unsigned int)time(NULL));
-    try {
-        DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*pBatch);
-        lvAssert(oBatch.getInputPacketType()==lv::ImagePacket && oBatch.getOutputPacketType()==lv::ImagePacket);
-        lvAssert(oBatch.getFrameCount()>1);
-        if(DATASET_PRECACHING)
-            oBatch.startPrecaching(!bool(EVALUATE_OUTPUT));
-        const std::string sCurrBatchName = lv::clampString(oBatch.getName(),12);
-        std::cout << "\t\t" << sCurrBatchName << " @ init [" << sWorkerName << "]" << std::endl;
-        const size_t nTotPacketCount = oBatch.getFrameCount();
-        const cv::Mat& oROI = oBatch.getFrameROI();
-        size_t nCurrIdx = 0;
-        cv::Mat oCurrInput = oBatch.getInput(nCurrIdx).clone();
-        lvAssert(!oCurrInput.empty() && oCurrInput.size()==oROI.size() && oCurrInput.isContinuous());
-    #if DATASET_FORCE_GRAYSCALE
-        if(oCurrInput.channels()==3)
-            cv::cvtColor(oCurrInput,oCurrInput,cv::COLOR_BGR2GRAY);
-    #endif //DATASET_FORCE_GRAYSCALE
-        cv::Mat oCurrFGMask(oBatch.getFrameSize(),CV_8UC1,cv::Scalar_<uchar>(0));
-        lvAssert(oCurrFGMask.size()==oROI.size());
-    #if USE_LITIV_IMPL
-        std::shared_ptr<IBackgroundSubtractor> pAlgo = std::make_shared<BackgroundSubtractorType>();
-        const double dDefaultLearningRate = pAlgo->getDefaultLearningRate();
-        pAlgo->initialize(oCurrInput,oROI);
-    #else //!USE_LITIV_IMPL
-    #if USE_GMM
-        cv::ocl::setUseOpenCL(false);
-        cv::setNumThreads(1);
-        cv::Ptr<BackgroundSubtractorType> pAlgo = cv::createBackgroundSubtractorMOG2();
-        const double dDefaultLearningRate = -1.0;
-    #endif //USE_...
-    #endif //!USE_LITIV_IMPL
+void Analyze(const lv::IDataHandlerPtrArray& vpBatches) {
+#if USE_LITIV_IMPL
+    using AlgoPtr = std::shared_ptr<IBackgroundSubtractor_<eAlgoImplTypeEnum>>;
+#elif USE_GMM
+    using AlgoPtr = cv::Ptr<BackgroundSubtractorType>;
+#endif //USE_...
+    /// per-batch stream state (pushed frames are processed in order on the shared engine workers)
+    struct StreamContext {
+        DatasetType::WorkBatch* pBatch;
+        std::string sBatchName,sWorkerName;
+        size_t nStreamIdx,nTotPacketCount,nNextIdx;
+        double dDefaultLearningRate;
+        std::atomic_bool bStopRequested;
+        AlgoPtr pAlgo;
     #if DISPLAY_OUTPUT>0
-        lv::DisplayHelperPtr pDisplayHelper = lv::DisplayHelper::create(oBatch.getName(),oBatch.getOutputPath()+"../");
-    #if USE_LITIV_IMPL
-        pAlgo->m_pDisplayHelper = pDisplayHelper;
-    #endif //USE_LITIV_IMPL
+        lv::DisplayHelperPtr pDisplayHelper;
     #endif //DISPLAY_OUTPUT>0
-        oBatch.startProcessing();
-        while(nCurrIdx<nTotPacketCount) {
-            if(!((nCurrIdx+1)%100))
-                std::cout << "\t\t" << sCurrBatchName << " @ F:" << std::setfill('0') << std::setw(lv::digit_count((int)nTotPacketCount)) << nCurrIdx+1 << "/" << nTotPacketCount << " [" << sWorkerName << "]" << std::endl;
-            const double dCurrLearningRate = (USE_LITIV_IMPL==1 && nCurrIdx<=100)?1:dDefaultLearningRate;
-            oCurrInput = oBatch.getInput(nCurrIdx);
+    };
+    const auto lStopBatch = [](lv::IDataHandler& oBatch) {
+        try {
+            if(oBatch.isProcessing())
+                dynamic_cast<DatasetType::WorkBatch&>(oBatch).stopProcessing();
+        } catch(...) {
+            std::cout << "\nAnalyze caught unhandled exception while attempting to stop batch processing.\n" << std::endl;
+            throw;
+        }
+    };
+    // stream contexts are referred to by the engine callbacks, so they must outlive the engine
+    std::vector<std::unique_ptr<StreamContext>> vpStreams;
+    BackgroundSubtractionEngine oEngine(DATASET_WORKTHREADS);
+    // opens a batch as a new engine stream (precaching, model init and processing clock all start here, right before its frames get pushed)
+    const auto lOpenStream = [&](size_t nBatchIdx) -> StreamContext* {
+        lv::IDataHandlerPtr pBatch = vpBatches[nBatchIdx];
+        try {
+            DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*pBatch);
+            lvAssert(oBatch.getInputPacketType()==lv::ImagePacket && oBatch.getOutputPacketType()==lv::ImagePacket);
+            lvAssert(oBatch.getFrameCount()>1);
+            if(DATASET_PRECACHING)
+                oBatch.startPrecaching(!bool(EVALUATE_OUTPUT));
+            std::unique_ptr<StreamContext> pStream = std::make_unique<StreamContext>();
+            StreamContext& oStream = *pStream;
+            oStream.pBatch = &oBatch;
+            oStream.sBatchName = lv::clampString(oBatch.getName(),12);
+            oStream.sWorkerName = std::to_string(nBatchIdx+1)+"/"+std::to_string(vpBatches.size());
+            oStream.nTotPacketCount = oBatch.getFrameCount();
+            oStream.nNextIdx = 0;
+            oStream.bStopRequested = false;
+            std::cout << "\t\t" << oStream.sBatchName << " @ init [" << oStream.sWorkerName << "]" << std::endl;
+            const cv::Mat& oROI = oBatch.getFrameROI();
+            const std::shared_ptr<const cv::Mat> pInitInputView = oBatch.getInputView(0); // zero-copy, pinned until model init is done
+            cv::Mat oInitInput = *pInitInputView;
+            lvAssert(!oInitInput.empty() && oInitInput.size()==oROI.size() && oInitInput.isContinuous());
         #if DATASET_FORCE_GRAYSCALE
-            if(oCurrInput.channels()==3)
-                cv::cvtColor(oCurrInput,oCurrInput,cv::COLOR_BGR2GRAY);
+            if(oInitInput.channels()==3)
+                cv::cvtColor(oInitInput,oInitInput,cv::COLOR_BGR2GRAY);
         #endif //DATASET_FORCE_GRAYSCALE
-            pAlgo->apply(oCurrInput,oCurrFGMask,dCurrLearningRate);
+        #if USE_LITIV_IMPL
+            oStream.pAlgo = std::make_shared<BackgroundSubtractorType>();
+            oStream.dDefaultLearningRate = oStream.pAlgo->getDefaultLearningRate();
+            srand(0); // for now, assures that two consecutive runs on the same data return the same results (only with DATASET_WORKTHREADS==1, as streams then run one after the other)
+            //srand((unsigned int)time(NULL));
+            oStream.pAlgo->initialize(oInitInput,oROI);
+        #else //!USE_LITIV_IMPL
+        #if USE_GMM
+            cv::ocl::setUseOpenCL(false);
+            cv::setNumThreads(1);
+            oStream.pAlgo = cv::createBackgroundSubtractorMOG2();
+            oStream.dDefaultLearningRate = -1.0;
+        #endif //USE_...
+        #endif //!USE_LITIV_IMPL
         #if DISPLAY_OUTPUT>0
-            cv::Mat oCurrBGImg;
-            pAlgo->getBackgroundImage(oCurrBGImg);
-            if(!oROI.empty()) {
-                cv::bitwise_or(oCurrBGImg,UCHAR_MAX/2,oCurrBGImg,oROI==0);
-                cv::bitwise_or(oCurrFGMask,UCHAR_MAX/2,oCurrFGMask,oROI==0);
+            oStream.pDisplayHelper = lv::DisplayHelper::create(oBatch.getName(),oBatch.getOutputPath()+"../");
+        #if USE_LITIV_IMPL
+            oStream.pAlgo->m_pDisplayHelper = oStream.pDisplayHelper;
+        #endif //USE_LITIV_IMPL
+        #endif //DISPLAY_OUTPUT>0
+        #if WRITE_IMG_OUTPUT
+            oBatch.setOutputEncoder(DATASET_OUTPUT_ENCODER,size_t(DATASET_OUTPUT_QUEUE_MB)*1024*1024);
+        #endif //WRITE_IMG_OUTPUT
+            oBatch.startProcessing();
+            oStream.nStreamIdx = oEngine.addStream([&oStream](const cv::Mat& oInput, cv::Mat& oFGMask, double dLearningRate) {
+                cv::Mat oCurrInput = oInput;
+            #if DATASET_FORCE_GRAYSCALE
+                if(oCurrInput.channels()==3)
+                    cv::cvtColor(oInput,oCurrInput,cv::COLOR_BGR2GRAY);
+            #endif //DATASET_FORCE_GRAYSCALE
+                oStream.pAlgo->apply(oCurrInput,oFGMask,dLearningRate);
+            },[&oStream](size_t nFrameIdx, const cv::Mat& oInput, const cv::Mat& oFGMask) {
+                if(!((nFrameIdx+1)%100))
+                    std::cout << "\t\t" << oStream.sBatchName << " @ F:" << std::setfill('0') << std::setw(lv::digit_count((int)oStream.nTotPacketCount)) << nFrameIdx+1 << "/" << oStream.nTotPacketCount << " [" << oStream.sWorkerName << "]" << std::endl;
+            #if DISPLAY_OUTPUT>0
+                const cv::Mat& oROI = oStream.pBatch->getFrameROI();
+                cv::Mat oCurrFGMask = oFGMask.clone(), oCurrBGImg;
+                oStream.pAlgo->getBackgroundImage(oCurrBGImg);
+                if(!oROI.empty()) {
+                    cv::bitwise_or(oCurrBGImg,UCHAR_MAX/2,oCurrBGImg,oROI==0);
+                    cv::bitwise_or(oCurrFGMask,UCHAR_MAX/2,oCurrFGMask,oROI==0);
+                }
+                oStream.pDisplayHelper->display(oInput,oCurrBGImg,oStream.pBatch->getColoredMask(oCurrFGMask,nFrameIdx),nFrameIdx);
+                const int nKeyPressed = oStream.pDisplayHelper->waitKey();
+                if(nKeyPressed==(int)'q')
+                    oStream.bStopRequested = true;
+                oStream.pBatch->push(oCurrFGMask,nFrameIdx);
+            #else //!(DISPLAY_OUTPUT>0)
+                UNUSED(oInput);
+                oStream.pBatch->push(oFGMask,nFrameIdx);
+            #endif //!(DISPLAY_OUTPUT>0)
+            });
+            vpStreams.push_back(std::move(pStream));
+            return &oStream;
+        }
+        catch(const lv::Exception&) {std::cout << "\nAnalyze caught lv::Exception (check stderr)\n" << std::endl;}
+        catch(const cv::Exception&) {std::cout << "\nAnalyze caught cv::Exception (check stderr)\n" << std::endl;}
+        catch(const std::exception& e) {std::cout << "\nAnalyze caught std::exception:\n" << e.what() << "\n" << std::endl;}
+        catch(...) {std::cout << "\nAnalyze caught unhandled exception\n" << std::endl;}
+        lStopBatch(*pBatch);
+        return nullptr;
+    };
+    // frames are pushed round-robin across a bounded window of active streams (the engine blocks this loop if a stream falls behind);
+    // a new batch is only opened once an active one is done, so that precaching buffers and models of pending batches stay unallocated
+    std::vector<StreamContext*> vpActiveStreams;
+    size_t nNextBatchIdx = 0;
+    while(true) {
+        while(vpActiveStreams.size()<size_t(DATASET_MAXACTIVESTREAMS) && nNextBatchIdx<vpBatches.size()) {
+            StreamContext* pStream = lOpenStream(nNextBatchIdx++);
+            if(pStream)
+                vpActiveStreams.push_back(pStream);
+        }
+        if(vpActiveStreams.empty())
+            break;
+        for(auto pStreamIter=vpActiveStreams.begin(); pStreamIter!=vpActiveStreams.end();) {
+            StreamContext& oStream = **pStreamIter;
+            DatasetType::WorkBatch& oBatch = *oStream.pBatch;
+            try {
+                if(oStream.nNextIdx<oStream.nTotPacketCount && !oStream.bStopRequested) {
+                    const size_t nCurrIdx = oStream.nNextIdx++;
+                    const double dCurrLearningRate = (USE_LITIV_IMPL==1 && nCurrIdx<=100)?1:oStream.dDefaultLearningRate;
+                    oEngine.push(oStream.nStreamIdx,oBatch.getInputView(nCurrIdx),dCurrLearningRate); // the packet stays pinned in the precacher until processed
+                    ++pStreamIter;
+                    continue;
+                }
+                oEngine.waitStream(oStream.nStreamIdx);
+                oBatch.stopProcessing();
+                const BackgroundSubtractionEngine::StreamStats oStats = oEngine.getStreamStats(oStream.nStreamIdx);
+                const double dTimeElapsed = oBatch.getFinalProcessTime();
+                const double dProcessSpeed = (double)oStats.nProcessedFrames/dTimeElapsed;
+                std::cout << "\t\t" << oStream.sBatchName << " @ end [" << oStream.sWorkerName << "] (" << std::fixed << std::setw(4) << dTimeElapsed << " sec, " << std::setw(4) << dProcessSpeed << " Hz, "
+                          << std::setw(4) << oStats.dMeanLatency*1000 << " ms mean latency)" << std::endl;
+                oBatch.writeEvalReport(); // this line is optional; it allows results to be read before all batches are processed
             }
-            pDisplayHelper->display(oCurrInput,oCurrBGImg,oBatch.getColoredMask(oCurrFGMask,nCurrIdx),nCurrIdx);
-            const int nKeyPressed = pDisplayHelper->waitKey();
-            if(nKeyPressed==(int)'q')
-                break;
+            catch(const lv::Exception&) {std::cout << "\nAnalyze caught lv::Exception (check stderr)\n" << std::endl;}
+            catch(const cv::Exception&) {std::cout << "\nAnalyze caught cv::Exception (check stderr)\n" << std::endl;}
+            catch(const std::exception& e) {std::cout << "\nAnalyze caught std::exception:\n" << e.what() << "\n" << std::endl;}
+            catch(...) {std::cout << "\nAnalyze caught unhandled exception\n" << std::endl;}
+            lStopBatch(oBatch);
+            // the engine keeps the stream callbacks alive, but the (possibly large) model can be released once queued frames are drained
+            try {oEngine.waitStream(oStream.nStreamIdx);} catch(...) {}
+            oStream.pAlgo = AlgoPtr();
+        #if DISPLAY_OUTPUT>0
+            oStream.pDisplayHelper = lv::DisplayHelperPtr();
         #endif //DISPLAY_OUTPUT>0
-            oBatch.push(oCurrFGMask,nCurrIdx++);
+            pStreamIter = vpActiveStreams.erase(pStreamIter);
         }
-        oBatch.stopProcessing();
-        const double dTimeElapsed = oBatch.getFinalProcessTime();
-        const double dProcessSpeed = (double)nCurrIdx/dTimeElapsed;
-        std::cout << "\t\t" << sCurrBatchName << " @ end [" << sWorkerName << "] (" << std::fixed << std::setw(4) << dTimeElapsed << " sec, " << std::setw(4) << dProcessSpeed << " Hz)" << std::endl;
-        oBatch.writeEvalReport(); // this line is optional; it allows results to be read before all batches are processed
-    }
-    catch(const lv::Exception&) {std::cout << "\nAnalyze caught lv::Exception (check stderr)\n" << std::endl;}
-    catch(const cv::Exception&) {std::cout << "\nAnalyze caught cv::Exception (check stderr)\n" << std::endl;}
-    catch(const std::exception& e) {std::cout << "\nAnalyze caught std::exception:\n" << e.what() << "\n" << std::endl;}
-    catch(...) {std::cout << "\nAnalyze caught unhandled exception\n" << std::endl;}
-    try {
-        if(pBatch->isProcessing())
-            dynamic_cast<DatasetType::WorkBatch&>(*pBatch).stopProcessing();
-    } catch(...) {
-        std::cout << "\nAnalyze caught unhandled exception while attempting to stop batch processing.\n" << std::endl;
-        throw;
     }
 }
 #endif //!USE_GPU_IMPL
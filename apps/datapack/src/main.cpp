@@ -0,0 +1,101 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "litiv/datasets.hpp"
+
+////////////////////////////////
+#define DATAPACK_OUTPUT_PATH    "packs" // will be created in the app's working directory
+#define DATAPACK_USE_LZ4        USING_LZ4 // falls back to raw blocks if lz4 is missing from the framework
+#define DATAPACK_WITH_GT        1
+////////////////////////////////
+#define DATASET_ID              Dataset_CDnet // comment this line to fall back to custom dataset definition
+#define DATASET_OUTPUT_PATH     "results_test" // will be created in the app's working directory if using a custom dataset
+#define DATASET_SCALE_FACTOR    1.0
+#define DATASET_WORKTHREADS     4
+////////////////////////////////
+#ifndef DATASET_ID
+#define DATASET_ID Dataset_Custom
+#define DATASET_PARAMS \
+    "####",                                                      /* => const std::string& sDatasetName */ \
+    "####",                                                      /* => const std::string& sDatasetDirPath */ \
+    DATASET_OUTPUT_PATH,                                         /* => const std::string& sOutputDirPath */ \
+    std::vector<std::string>{"###","###","###","..."},           /* => const std::vector<std::string>& vsWorkBatchDirs */ \
+    std::vector<std::string>{"###","###","###","..."},           /* => const std::vector<std::string>& vsSkippedDirTokens */ \
+    false,                                                       /* => bool bSaveOutput */ \
+    false,                                                       /* => bool bUseEvaluator */ \
+    false,                                                       /* => bool bForce4ByteDataAlign */ \
+    DATASET_SCALE_FACTOR                                         /* => double dScaleFactor */
+#else //defined(DATASET_ID)
+#define DATASET_PARAMS \
+    DATASET_OUTPUT_PATH,                                         /* => const std::string& sOutputDirName */ \
+    false,                                                       /* => bool bSaveOutput */ \
+    false,                                                       /* => bool bUseEvaluator */ \
+    false,                                                       /* => bool bForce4ByteDataAlign */ \
+    DATASET_SCALE_FACTOR                                         /* => double dScaleFactor */
+#endif //defined(DATASET_ID)
+
+void Pack(std::string sWorkerName, lv::IDataHandlerPtr pBatch);
+using DatasetType = lv::Dataset_<lv::DatasetTask_ChgDet,lv::DATASET_ID,lv::NonParallel>;
+
+int main(int, char**) {
+    try {
+        DatasetType::Ptr pDataset = DatasetType::create(DATASET_PARAMS);
+        lv::IDataHandlerPtrArray vpBatches = pDataset->getBatches(false);
+        const size_t nTotPackets = pDataset->getInputCount();
+        const size_t nTotBatches = vpBatches.size();
+        if(nTotBatches==0 || nTotPackets==0)
+            lvError_("Could not parse any data for dataset '%s'",pDataset->getName().c_str());
+        lvAssert(lv::createDirIfNotExist(DATAPACK_OUTPUT_PATH));
+        std::cout << "\n[" << lv::getTimeStamp() << "]\n" << std::endl;
+        std::cout << "Packing " << nTotBatches << " batch(es) with " << DATASET_WORKTHREADS << " thread(s)..." << std::endl;
+        lv::WorkerPool<DATASET_WORKTHREADS> oPool;
+        std::vector<std::future<void>> vTaskResults;
+        size_t nCurrBatchIdx = 1;
+        for(lv::IDataHandlerPtr pBatch : vpBatches)
+            vTaskResults.push_back(oPool.queueTask(Pack,std::to_string(nCurrBatchIdx++)+"/"+std::to_string(nTotBatches),pBatch));
+        for(std::future<void>& oTaskRes : vTaskResults)
+            oTaskRes.get();
+    }
+    catch(const lv::Exception&) {std::cout << "\n!!!!!!!!!!!!!!\nTop level caught lv::Exception (check stderr)\n!!!!!!!!!!!!!!\n" << std::endl; return -1;}
+    catch(const cv::Exception&) {std::cout << "\n!!!!!!!!!!!!!!\nTop level caught cv::Exception (check stderr)\n!!!!!!!!!!!!!!\n" << std::endl; return -1;}
+    catch(const std::exception& e) {std::cout << "\n!!!!!!!!!!!!!!\nTop level caught std::exception:\n" << e.what() << "\n!!!!!!!!!!!!!!\n" << std::endl; return -1;}
+    catch(...) {std::cout << "\n!!!!!!!!!!!!!!\nTop level caught unhandled exception\n!!!!!!!!!!!!!!\n" << std::endl; return -1;}
+    std::cout << "\n[" << lv::getTimeStamp() << "]\n" << std::endl;
+    return 0;
+}
+
+void Pack(std::string sWorkerName, lv::IDataHandlerPtr pBatch) {
+    try {
+        DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*pBatch);
+        const std::string sCurrBatchName = lv::clampString(oBatch.getName(),12);
+        std::cout << "\t\t" << sCurrBatchName << " @ init [" << sWorkerName << "]" << std::endl;
+        const std::string sPackFilePath = lv::addDirSlashIfMissing(DATAPACK_OUTPUT_PATH)+lv::DataPack::getDefaultFileName(oBatch);
+        lv::StopWatch oStopWatch;
+        // packets are fetched sequentially, so the batch's own precacher can decode ahead of the writer
+        oBatch.startPrecaching(!bool(DATAPACK_WITH_GT));
+        lv::DataPack::write(sPackFilePath,oBatch,DATAPACK_USE_LZ4?lv::DataPackBlock_LZ4:lv::DataPackBlock_Raw,bool(DATAPACK_WITH_GT));
+        oBatch.stopPrecaching();
+        const double dTimeElapsed = oStopWatch.elapsed();
+        // reopen the pack right away to validate its index before the next run relies on it
+        const lv::DataPack oPack(sPackFilePath);
+        lvAssert(oPack.getInputCount()==oBatch.getInputCount());
+        std::cout << "\t\t" << sCurrBatchName << " @ end [" << sWorkerName << "] (" << std::fixed << std::setw(4) << dTimeElapsed << " sec, " << oPack.getInputCount() << " packet(s) => '" << sPackFilePath << "')" << std::endl;
+    }
+    catch(const lv::Exception&) {std::cout << "\nPack caught lv::Exception (check stderr)\n" << std::endl;}
+    catch(const cv::Exception&) {std::cout << "\nPack caught cv::Exception (check stderr)\n" << std::endl;}
+    catch(const std::exception& e) {std::cout << "\nPack caught std::exception:\n" << e.what() << "\n" << std::endl;}
+    catch(...) {std::cout << "\nPack caught unhandled exception\n" << std::endl;}
+}
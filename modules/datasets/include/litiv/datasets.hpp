@@ -20,6 +20,7 @@
 #include "litiv/datasets/utils.hpp"
 #include "litiv/datasets/metrics.hpp"
 #include "litiv/datasets/eval.hpp"
+#include "litiv/datasets/pack.hpp"
 
 namespace lv {
 
@@ -102,7 +103,7 @@ namespace lv {
                     this->m_oStopWatch.tick();
                 }
             }
-            /// exits 'processing' mode, releasing time-critical evaluation components (if any) and setting the processed packets promise
+            /// exits 'processing' mode, releasing time-critical evaluation components (if any), setting the processed packets promise, and flushing archived outputs
             inline void stopProcessing() {
                 lvDbgExceptionWatch;
                 if(this->m_bIsProcessing) {
@@ -113,6 +114,7 @@ namespace lv {
                     this->m_bIsProcessing = false;
                 }
                 this->stopPrecaching();
+                this->flushOutput(); // outputs may still be queued for async writing
             }
         protected:
             /// work batch instances can only be created by work groups via their protected 'createWorkBatch' function
@@ -58,8 +58,8 @@ namespace lv {
         inline void accumulate(const BinClassif& c) {
             nTP += c.nTP; nTN += c.nTN; nFN += c.nFN; nFP += c.nFP; nSE += c.nSE; nDC += c.nDC;
         }
-        /// accumulates the pixel-level classification counts of 'oClassif' vs 'oGT' into the internal counts
-        void accumulate(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI=cv::Mat());
+        /// accumulates the pixel-level classification counts of 'oClassif' vs 'oGT' into the internal counts (large frames can be split by rows over openmp threads)
+        void accumulate(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI=cv::Mat(), bool bParallel=false);
         /// returns a colored classification mask for visualization based on good/bad classifcations of 'oClassif' vs 'oGT'
         static cv::Mat getColoredMask(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI=cv::Mat());
         /// default constructor; sets all counters to zero
@@ -0,0 +1,79 @@
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "litiv/datasets/utils.hpp"
+
+namespace lv {
+
+    /// list of block storage formats supported by data packs
+    enum DataPackBlockList {
+        DataPackBlock_Raw, ///< contiguous raw planes (read back as zero-copy views into the mapping, which they keep alive)
+        DataPackBlock_LZ4, ///< lz4-compressed planes (decompressed on read; falls back to raw for incompressible packets)
+    };
+
+    /// packed dataset container, holding the (post-transformation) input and gt packets of a work batch in a single indexed file read via memory mapping
+    struct DataPack {
+        /// opens an existing data pack file (maps it to memory, and validates its index)
+        explicit DataPack(const std::string& sFilePath);
+        /// returns the path of the underlying data pack file
+        inline const std::string& getFilePath() const {return m_sFilePath;}
+        /// returns the number of input packets stored in the data pack
+        inline size_t getInputCount() const {return m_nInputCount;}
+        /// returns the number of gt packets stored in the data pack
+        inline size_t getGTCount() const {return m_nGTCount;}
+        /// returns the data scale factor the packets were loaded with when the data pack was written
+        inline double getScaleFactor() const {return m_dScaleFactor;}
+        /// returns an input packet by index (raw blocks point into the mapping, and share its ownership; must not be altered; can be called concurrently)
+        cv::Mat getInput(size_t nPacketIdx) const;
+        /// returns a gt packet by index (raw blocks point into the mapping, and share its ownership; must not be altered; can be called concurrently)
+        cv::Mat getGT(size_t nPacketIdx) const;
+        /// returns whether the data of the given packet lies in this data pack's mapping (i.e. whether it is a zero-copy view)
+        bool isMappedPacket(const cv::Mat& oPacket) const;
+        /// returns the size/type of an input packet by index, as stored in the index (empty for missing packets; does not decode the packet)
+        lv::MatInfo getInputInfo(size_t nPacketIdx) const;
+        /// returns the size/type of a gt packet by index, as stored in the index (empty for missing packets; does not decode the packet)
+        lv::MatInfo getGTInfo(size_t nPacketIdx) const;
+        /// writes all input (and gt, if requested) packets of a work batch into a new data pack file
+        static void write(const std::string& sFilePath, IIDataLoader& oBatch, DataPackBlockList eBlockType=DataPackBlock_Raw, bool bWithGT=true);
+        /// returns the default data pack file name for a work batch (built from its own name and its parents')
+        static std::string getDefaultFileName(const IDataHandler& oBatch);
+    private:
+        /// fixed-size index entry, stored at the end of the file as a binary mat archive (one row of raw bytes per entry)
+        struct IndexEntry {
+            uint64_t nOffset,nStoredSize,nRawSize;
+            int32_t nType,nDims;
+            int32_t anSizes[8];
+            uint32_t nBlockType,nPadding;
+        };
+        cv::Mat getPacket(size_t nEntryIdx) const;
+        lv::MatInfo getPacketInfo(size_t nEntryIdx) const;
+        const std::string m_sFilePath;
+        std::shared_ptr<uint8_t> m_pMapping;
+        size_t m_nMappingSize;
+        size_t m_nInputCount,m_nGTCount;
+        double m_dScaleFactor;
+        cv::Mat m_oIndex;
+        const IndexEntry* m_pIndex;
+    };
+
+    /// writes data packs for all work batches of a data handler in the given directory (returns the number of packs written)
+    size_t writeDataPacks(const IDataHandlerPtr& pHandler, const std::string& sPackDirPath, DataPackBlockList eBlockType=DataPackBlock_Raw, bool bWithGT=true);
+    /// attaches existing data packs from the given directory to all matching work batches of a data handler (returns the number of packs attached)
+    size_t attachDataPacks(const IDataHandlerPtr& pHandler, const std::string& sPackDirPath);
+
+} // namespace lv
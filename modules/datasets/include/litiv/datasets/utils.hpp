@@ -22,6 +22,8 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <unordered_map>
+#include <map>
+#include <set>
 #include <fstream>
 #include <stack>
 
@@ -38,6 +40,7 @@ namespace lv {
     using IDataHandlerPtrArray = std::vector<IDataHandlerPtr>;
     using IDataHandlerConstPtr = std::shared_ptr<const IDataHandler>;
     using IDataHandlerConstPtrArray = std::vector<IDataHandlerConstPtr>;
+    struct DataPack;
     using AsyncDataCallbackFunc = std::function<void(const cv::Mat& /*oInput*/,const cv::Mat& /*oDebug*/,const cv::Mat& /*oOutput*/,const cv::Mat& /*oGT*/,const cv::Mat& /*oGTROI*/,size_t /*nIdx*/)>;
 
     /// list of computer vision tasks that can be studied using a dataset
@@ -305,9 +308,11 @@ namespace lv {
         /// writes the batch-level evaluation report
         virtual void writeEvalReport() const = 0;
         /// initializes data spooling by starting an asynchronyzed precacher to pre-fetch data packets based on queried ids
-        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX) = 0;
+        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX, size_t nDecodeWorkers=1) = 0;
         /// kills the asynchronyzed precacher, and clears internal buffers
         virtual void stopPrecaching() = 0;
+        /// blocks until all pushed output packets have been written (does nothing if outputs are not archived)
+        virtual void flushOutput() {}
     protected:
         /// work batch/group comparison function based on names
         template<typename Tp>
@@ -419,7 +424,7 @@ namespace lv {
         /// returns this work group's children batches
         virtual IDataHandlerPtrArray getBatches(bool bWithHierarchy) const override final;
         /// initializes precaching in all children work batches
-        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX) override final;
+        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX, size_t nDecodeWorkers=1) override final;
         /// stops precaching in all children work batches
         virtual void stopPrecaching() override final;
     protected:
@@ -460,16 +465,40 @@ namespace lv {
         ~DataPrecacher();
         /// fetches a packet, with or without precaching enabled (should never be called concurrently, returned packets should never be altered directly, and a single packet loaded twice is assumed identical)
         const cv::Mat& getPacket(size_t nIdx);
-        /// initializes precaching with a given buffer size (starts up thread)
-        bool startAsyncPrecaching(size_t nSuggestedBufferSize);
+        /// fetches a packet as a zero-copy view into the cache (its slot stays pinned until all copies of the view are released; same call rules as 'getPacket')
+        std::shared_ptr<const cv::Mat> getPacketView(size_t nIdx);
+        /// initializes precaching with a given buffer size (starts up thread), using 'nDecodeWorkers' parallel loader calls (0 = auto; >1 requires a reentrant callback)
+        bool startAsyncPrecaching(size_t nSuggestedBufferSize, size_t nDecodeWorkers=1);
         /// joins precaching thread and clears all internal buffers
         void stopAsyncPrecaching();
         /// returns whether the precaching thread has already been started or not
         inline bool isActive() const {return m_bIsActive;}
         /// returns the last requested packet index (i.e. the index to data still being held)
         inline size_t getLastReqIdx() const {return m_nLastReqIdx;}
+        /// drops the last requested packet held by the precacher, so that it is reloaded on the next request (needed if the callback's data source changes)
+        void resetLastPacket();
+        /// returns the number of parallel decode workers used by the precaching thread (1 = packets loaded inline)
+        inline size_t getDecodeWorkerCount() const {return m_nDecodeWorkers;}
+        /// returns the number of cached packets which can currently be fetched lock-free by the consumer
+        inline size_t getReadyPacketCount() const {return m_nReadyHead.load(std::memory_order_acquire)-m_nReadyTail.load(std::memory_order_relaxed);}
+        /// returns the number of requests since precaching started which could not be served lock-free (i.e. which locked & waited on the precaching thread)
+        inline size_t getLockedRequestCount() const {return m_nLockedRequestCount;}
+        /// returns whether the data of the given packet lies in the precaching ring buffer (i.e. whether it was not copied out of the cache)
+        bool isCachedPacket(const cv::Mat& oPacket) const;
     private:
+        /// cached packet slot in the ring buffer (recycled once consumed or skipped, and released by all views)
+        struct PacketSlot {
+            cv::Mat oPacket;
+            size_t nIdx,nOffset;
+            std::shared_ptr<std::vector<uchar>> pBuffer;
+            std::atomic_bool bReleased;
+        };
+        /// maximum number of cached packets in the single-producer/single-consumer ready queue
+        static constexpr size_t s_nMaxReadyPackets = 1024;
+        static std::shared_ptr<const cv::Mat> createPacketView(const std::shared_ptr<PacketSlot>& pSlot);
         void entry(const size_t nBufferSize);
+        void entry_decode();
+        void joinWorkers();
         const std::function<cv::Mat(size_t)> m_lCallback;
         std::thread m_hWorker;
         std::exception_ptr m_pWorkerException;
@@ -479,7 +508,20 @@ namespace lv {
         std::atomic_bool m_bIsActive,m_bGotRequest;
         size_t m_nReqIdx,m_nLastReqIdx;
         std::atomic_size_t m_nAnswIdx;
-        cv::Mat m_oReqPacket,m_oLastReqPacket;
+        std::shared_ptr<const cv::Mat> m_pReqView,m_pLastReqView;
+        /// ready queue of cached packets (written by the precaching thread at head, and popped lock-free by the consumer at tail)
+        std::vector<std::shared_ptr<PacketSlot>> m_vpReadySlots;
+        std::atomic_size_t m_nReadyHead,m_nReadyTail;
+        /// ring buffer holding cached packet data (allocated before the precaching thread starts, and kept alive by outstanding views once stopped)
+        std::shared_ptr<std::vector<uchar>> m_pCacheBuffer;
+        size_t m_nLockedRequestCount;
+        /// decode worker pool state (guarded by its own mutex; packets are decoded out of order, and committed in index order)
+        std::vector<std::thread> m_vhDecodeWorkers;
+        std::mutex m_oDecodeMutex;
+        std::condition_variable m_oDecodeCondVar;
+        std::map<size_t,cv::Mat> m_mDecodedPackets;
+        size_t m_nDecodeWorkers,m_nDecodeWindowSize,m_nDecodeByteBudget,m_nDecodedBytes;
+        size_t m_nNextDecodeIdx,m_nDecodeCommitIdx,m_nDecodeEndIdx,m_nDecodeGeneration;
         DataPrecacher& operator=(const DataPrecacher&) = delete;
         DataPrecacher(const DataPrecacher&) = delete;
     };
@@ -497,13 +539,17 @@ namespace lv {
         /// returns the input/output data packet mapping type policy (used for internal packet auto-transformations)
         inline MappingPolicy getIOMappingType() const {return m_eIOMappingType;}
         /// initializes data spooling by starting an asynchronyzed precacher to pre-fetch data packets based on queried ids
-        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX) override;
+        virtual void startPrecaching(bool bPrecacheInputOnly=true, size_t nSuggestedBufferSize=SIZE_MAX, size_t nDecodeWorkers=1) override;
         /// kills the asynchronyzed precacher, and clears internal buffers
         virtual void stopPrecaching() override;
         /// returns an input packet by index (works both with and without precaching enabled)
         const cv::Mat& getInput(size_t nPacketIdx);
         /// returns a gt packet by index (works both with and without precaching enabled)
         const cv::Mat& getGT(size_t nPacketIdx);
+        /// returns a zero-copy view of an input packet by index, which stays valid until released (works both with and without precaching enabled)
+        std::shared_ptr<const cv::Mat> getInputView(size_t nPacketIdx);
+        /// returns a zero-copy view of a gt packet by index, which stays valid until released (works both with and without precaching enabled)
+        std::shared_ptr<const cv::Mat> getGTView(size_t nPacketIdx);
         /// loads a user-defined features data packet by index (works both with and without precaching enabled)
         const cv::Mat& loadFeatures(size_t nPacketIdx);
         /// saves a user-defined features data packet by index (useful when extraction is hard/slow)
@@ -522,6 +568,12 @@ namespace lv {
         virtual bool isGTInfoConst() const = 0;
         /// returns whether this work batch is currently precaching data
         virtual bool isPrecaching() const override;
+        /// returns whether packets can be loaded concurrently by multiple precacher decode workers (false by default)
+        virtual bool isPacketLoadReentrant() const;
+        /// attaches a data pack from which input (and gt, if packed) packets will be read instead of the original dataset files (pass nullptr to detach)
+        void setDataPack(std::shared_ptr<const DataPack> pDataPack);
+        /// returns the data pack currently attached to this work batch (or nullptr if none)
+        inline const std::shared_ptr<const DataPack>& getDataPack() const {return m_pDataPack;}
     protected:
         /// types serve to automatically transform packets & define default implementations
         IIDataLoader(PacketPolicy eInputType, PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType);
@@ -535,8 +587,14 @@ namespace lv {
         /// required friend for access to precachers
         template<ArrayPolicy ePolicy>
         friend struct IDataLoader_;
+        /// input packet load function bound to the precacher (reads from the data pack if one is attached)
+        cv::Mat getInput_load(size_t nPacketIdx);
+        /// gt packet load function bound to the precacher (reads from the data pack if one is attached)
+        cv::Mat getGT_load(size_t nPacketIdx);
         /// precacher objects which may spin up a thread to pre-fetch data packets
         DataPrecacher m_oInputPrecacher,m_oGTPrecacher,m_oFeaturesPrecacher;
+        /// packed (memory-mapped) copy of this work batch's packets, if attached
+        std::shared_ptr<const DataPack> m_pDataPack;
         /// input/gt/output packet policy types
         const PacketPolicy m_eInputType,m_eGTType,m_eOutputType;
         /// output-gt and input-output mapping policy types
@@ -639,6 +697,8 @@ namespace lv {
         virtual size_t getGTCount() const override;
         /// compute the expected data load size for this batch based on frame size, frame count, and channel count
         virtual size_t getExpectedLoadSize() const override;
+        /// returns whether packets can be loaded concurrently (only true for image sequences, as the video reader is stateful)
+        virtual bool isPacketLoadReentrant() const override;
     protected:
         /// specialized constructor; still need to specify gt type, output type, and mappings
         IDataProducer_(PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType);
@@ -720,6 +780,8 @@ namespace lv {
         virtual bool isGTInfoConst() const override;
         /// returns the file name associated with an input data packet index (useful for data archiving)
         virtual std::string getInputName(size_t nPacketIdx) const override;
+        /// returns whether packets can be loaded concurrently (always true, as images are read independently)
+        virtual bool isPacketLoadReentrant() const override;
     protected:
         /// specialized constructor; still need to specify gt type, output type, and mappings
         IDataProducer_(PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType);
@@ -774,10 +836,37 @@ namespace lv {
     template<DatasetTaskList eDatasetTask, DatasetSourceList eDatasetSource, DatasetList eDataset>
     struct DataProducer_ : public IDataProducerWrapper_<eDatasetTask,eDatasetSource,eDataset> {};
 
+    /// list of built-in packet encoders available to data writers
+    enum DataEncoderList {
+        DataEncoder_Raw, ///< raw binary (stored as a lv::MatArchive_BINARY archive)
+        DataEncoder_LZ4, ///< lz4-compressed raw binary (stored as a lv::MatArchive_BINARY_LZ4 archive; requires lz4 support)
+        DataEncoder_BitPacked, ///< 1-bit-per-pixel binary mask (stored as a lv::MatArchive_BINARY_BITPACKED archive; CV_8UC1 packets only, non-zero values are decoded as 255)
+        DataEncoder_PNG, ///< png image at low compression level (lossless, but much faster than default)
+        DataEncoder_PNG_Max, ///< png image at max compression level (lossless and smallest, but slowest; default for archived image outputs)
+    };
+
     /// general-purpose, stand-alone data packet writer
     struct DataWriter {
+        /// packet encoding function type (called concurrently by all workers; fills the given buffer with the encoded packet)
+        using EncoderFunc = std::function<void(const cv::Mat& /*oPacket*/,size_t /*nIdx*/,std::vector<uchar>& /*vBuffer*/)>;
+        /// encoded packet commit function type (called by a single worker at a time, in packet index order)
+        using CommitFunc = std::function<void(const std::vector<uchar>& /*vBuffer*/,size_t /*nIdx*/)>;
+        /// queue back-pressure statistics, accumulated since the last call to 'startAsyncWriting'
+        struct Stats {
+            size_t nQueuedPackets; ///< number of packets accepted by the queue
+            size_t nDroppedPackets; ///< number of packets dropped because the queue was full
+            size_t nBlockedPackets; ///< number of packets which had to wait for room in the queue before being accepted
+            double dBlockedTime; ///< total time spent waiting for room in the queue (in seconds)
+            size_t nPeakQueueSize; ///< maximum queue size reached (in bytes)
+            size_t nCommittedPackets; ///< number of packets fully written (encoded and committed)
+            size_t nEncodedBytes; ///< total size of encoded packets (in bytes; stays zero with the callback-only writer)
+        };
         /// attaches to data archiver (the callback is the actual 'writing' action, with a signature similar to 'queue')
         DataWriter(std::function<size_t(const cv::Mat&,size_t)> lDataArchiverCallback);
+        /// attaches to a packet encoder and to an in-order commit callback (encoding runs on all workers, commits are serialized by packet index)
+        DataWriter(EncoderFunc lEncoder, CommitFunc lCommit);
+        /// attaches to a built-in packet encoder, and commits each encoded packet to the file path returned by the callback, in packet index order
+        DataWriter(DataEncoderList eEncoder, std::function<std::string(size_t)> lFilePathCallback);
         /// default destructor (joins the writing thread, if still running)
         ~DataWriter();
         /// returns whether the given packet could be added to the queue (true), or it would be dropped (false)
@@ -790,37 +879,85 @@ namespace lv {
         inline size_t getCurrentQueueSize() const {return m_nQueueSize;}
         /// returns the maximum queue size, in bytes
         inline size_t getMaxQueueSize() const {return m_nQueueMaxSize;}
-        /// initializes async writing with a given queue size (in bytes) and a number of threads
+        /// returns the queue back-pressure statistics (can be called at any time, from any thread)
+        Stats getStats() const;
+        /// initializes async writing with a given queue size (in bytes) and a number of threads (0 = auto)
         bool startAsyncWriting(size_t nSuggestedQueueSize, bool bDropPacketsIfFull=false, size_t nWorkers=1);
         /// joins writing thread and clears all internal buffers
         void stopAsyncWriting();
         /// returns whether the wariting thread has already been started or not
         inline bool isActive() const {return m_bIsActive;}
+        /// encodes a packet using a built-in encoder, filling the given buffer
+        static void encode(const cv::Mat& oPacket, std::vector<uchar>& vBuffer, DataEncoderList eEncoder);
+        /// decodes a packet previously encoded using a built-in encoder
+        static cv::Mat decode(const std::vector<uchar>& vBuffer, DataEncoderList eEncoder);
+        /// reads and decodes a packet file previously written using a built-in encoder
+        static cv::Mat read(const std::string& sFilePath, DataEncoderList eEncoder);
+        /// returns the default file extension (with leading dot) for packets written using a built-in encoder
+        static const char* getFileExt(DataEncoderList eEncoder);
     private:
+        /// internal queue entry state (packets are always committed in index order, once encoded)
+        enum PacketState {PacketState_Pending,PacketState_Encoding,PacketState_Encoded};
+        struct QueuedPacket {
+            cv::Mat oPacket;
+            std::vector<uchar> vBuffer;
+            size_t nSize;
+            PacketState eState;
+        };
         void entry();
         const std::function<size_t(const cv::Mat&,size_t)> m_lCallback;
+        const EncoderFunc m_lEncoder;
+        const CommitFunc m_lCommit;
         std::vector<std::thread> m_vhWorkers;
         std::stack<std::pair<std::exception_ptr,size_t>> m_vWorkerExceptions;
         std::mutex m_oSyncMutex;
         std::condition_variable m_oQueueCondVar;
         std::condition_variable m_oClearCondVar;
-        std::map<size_t,cv::Mat> m_mQueue;
+        std::map<size_t,QueuedPacket> m_mQueue;
+        std::set<size_t> m_snPendingIdxs;
+        bool m_bCommitting;
         std::atomic_bool m_bIsActive;
         bool m_bAllowPacketDrop;
         size_t m_nQueueMaxSize;
         std::atomic_size_t m_nQueueSize;
         std::atomic_size_t m_nQueueCount;
+        std::atomic_size_t m_nStatsQueuedPackets,m_nStatsDroppedPackets,m_nStatsBlockedPackets,m_nStatsBlockedTime_usec;
+        std::atomic_size_t m_nStatsPeakQueueSize,m_nStatsCommittedPackets,m_nStatsEncodedBytes;
         DataWriter& operator=(const DataWriter&) = delete;
         DataWriter(const DataWriter&) = delete;
     };
 
+    /// data archiver interface (holds the output packet encoder & writer shared by all archiver specializations)
+    struct IIDataArchiver : public virtual IDataHandler {
+        /// sets the encoder used to save/load output packets, and the async writing queue size (in bytes; 0 = synchronous writing) & worker count (0 = auto)
+        void setOutputEncoder(DataEncoderList eEncoder, size_t nAsyncQueueSize=0, size_t nAsyncWorkers=1);
+        /// returns the encoder used to save/load output packets (defaults to max-compression png for images, and to raw binary otherwise)
+        DataEncoderList getOutputEncoder() const;
+        /// blocks until all queued output packets have been written (rethrows the first writing error, if any)
+        virtual void flushOutput() override;
+    protected:
+        /// default constructor (uses the default encoder with synchronous writing)
+        IIDataArchiver();
+        /// writes an output packet (or queues it, if async writing is enabled) to the given file path, to which the encoder extension is appended
+        void writeOutput(const cv::Mat& oOutput, const std::string& sFilePathPrefix, size_t nQueueIdx);
+        /// reads an output packet from the given file path, to which the encoder extension is appended (flushes queued packets first)
+        cv::Mat readOutput(const std::string& sFilePathPrefix, int nFlags);
+    private:
+        int m_nOutputEncoder; // -1 = default for the output packet type
+        size_t m_nAsyncOutputQueueSize,m_nAsyncOutputWorkers;
+        std::map<size_t,std::string> m_mQueuedOutputPaths;
+        std::mutex m_oQueuedOutputPathsMutex;
+        std::mutex m_oOutputWriterMutex;
+        std::unique_ptr<DataWriter> m_pOutputWriter; // declared last so that it is destroyed (and drained) first
+    };
+
     /// default (specializable) forward declaration of the data archiver interface (used to save/load outputs)
     template<ArrayPolicy ePolicy>
     struct IDataArchiver_;
 
     /// data archiver specialization for non-array output processing
     template<>
-    struct IDataArchiver_<NotArray> : public virtual IDataHandler {
+    struct IDataArchiver_<NotArray> : public IIDataArchiver {
         /// loads an output data packet based on idx, with optional flags (-1 = internal defaults)
         virtual cv::Mat loadOutput(size_t nIdx, int nFlags=-1);
     protected:
@@ -830,7 +967,7 @@ namespace lv {
 
     /// data archiver specialization for array output processing
     template<>
-    struct IDataArchiver_<Array> : public virtual IDataHandler {
+    struct IDataArchiver_<Array> : public IIDataArchiver {
         /// loads an output data packet array based on idx, with optional flags (-1 = internal defaults)
         virtual std::vector<cv::Mat> loadOutputArray(size_t nIdx, int nFlags=-1);
         /// returns the number of parallel output streams (defaults to input or GT stream count if loader is array-based & one mapping allows it)
@@ -18,46 +18,111 @@
 #include <litiv/datasets/metrics.hpp>
 #include "litiv/datasets/metrics.hpp"
 
-void lv::BinClassif::accumulate(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI) {
+#define BINCLASSIF_PARALLEL_MIN_AREA (640*480) // smaller frames are not worth the thread sync overhead
+
+namespace {
+
+    /// accumulates binary classification counts over a contiguous pixel range without branching on labels (vectorized 64 pixels at a time, if possible)
+    void accumulateBinClassifRange(const uchar* pInput, const uchar* pGT, const uchar* pROI, size_t nPxCount, lv::BinClassif& oCounters) {
+        uint64_t nValid=0, nTP=0, nFP=0, nFN=0, nSE=0;
+        size_t nPxIdx = 0;
+    #if HAVE_SSE2
+        // each comparison is reduced to a 64-bit lane mask, so all counters only need one popcount per 64 pixels
+        for(; nPxIdx+64<=nPxCount; nPxIdx+=64) {
+            uint64_t nInvalidMask=0, nInputPosMask=0, nGTPosMask=0, nGTShadowMask=0;
+        #if HAVE_AVX2
+            lv::unroll<2>([&](size_t nBlockIdx) {
+                const size_t nOffset = nPxIdx+nBlockIdx*32;
+                const __m256i anInput = _mm256_loadu_si256((const __m256i*)(pInput+nOffset));
+                const __m256i anGT = _mm256_loadu_si256((const __m256i*)(pGT+nOffset));
+                __m256i abInvalid = _mm256_or_si256(_mm256_cmpeq_epi8(anGT,_mm256_set1_epi8(char(DATASETUTILS_OUTOFSCOPE_VAL))),_mm256_cmpeq_epi8(anGT,_mm256_set1_epi8(char(DATASETUTILS_UNKNOWN_VAL))));
+                if(pROI)
+                    abInvalid = _mm256_or_si256(abInvalid,_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(pROI+nOffset)),_mm256_set1_epi8(char(DATASETUTILS_NEGATIVE_VAL))));
+                const size_t nShift = nBlockIdx*32;
+                nInvalidMask |= uint64_t(uint32_t(_mm256_movemask_epi8(abInvalid)))<<nShift;
+                nInputPosMask |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(anInput,_mm256_set1_epi8(char(DATASETUTILS_POSITIVE_VAL))))))<<nShift;
+                nGTPosMask |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(anGT,_mm256_set1_epi8(char(DATASETUTILS_POSITIVE_VAL))))))<<nShift;
+                nGTShadowMask |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(anGT,_mm256_set1_epi8(char(DATASETUTILS_SHADOW_VAL))))))<<nShift;
+            });
+        #else //(!HAVE_AVX2)
+            lv::unroll<4>([&](size_t nBlockIdx) {
+                const size_t nOffset = nPxIdx+nBlockIdx*16;
+                const __m128i anInput = _mm_loadu_si128((const __m128i*)(pInput+nOffset));
+                const __m128i anGT = _mm_loadu_si128((const __m128i*)(pGT+nOffset));
+                __m128i abInvalid = _mm_or_si128(_mm_cmpeq_epi8(anGT,_mm_set1_epi8(char(DATASETUTILS_OUTOFSCOPE_VAL))),_mm_cmpeq_epi8(anGT,_mm_set1_epi8(char(DATASETUTILS_UNKNOWN_VAL))));
+                if(pROI)
+                    abInvalid = _mm_or_si128(abInvalid,_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pROI+nOffset)),_mm_set1_epi8(char(DATASETUTILS_NEGATIVE_VAL))));
+                const size_t nShift = nBlockIdx*16;
+                nInvalidMask |= uint64_t(_mm_movemask_epi8(abInvalid))<<nShift;
+                nInputPosMask |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(anInput,_mm_set1_epi8(char(DATASETUTILS_POSITIVE_VAL)))))<<nShift;
+                nGTPosMask |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(anGT,_mm_set1_epi8(char(DATASETUTILS_POSITIVE_VAL)))))<<nShift;
+                nGTShadowMask |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(anGT,_mm_set1_epi8(char(DATASETUTILS_SHADOW_VAL)))))<<nShift;
+            });
+        #endif //(!HAVE_AVX2)
+            const uint64_t nValidMask = ~nInvalidMask;
+            const uint64_t nValidInputPosMask = nValidMask&nInputPosMask;
+            nValid += lv::popcount(nValidMask);
+            nTP += lv::popcount(nValidInputPosMask&nGTPosMask);
+            nFP += lv::popcount(nValidInputPosMask&~nGTPosMask);
+            nFN += lv::popcount(nValidMask&~nInputPosMask&nGTPosMask);
+            nSE += lv::popcount(nValidInputPosMask&nGTShadowMask);
+        }
+    #endif //HAVE_SSE2
+        for(; nPxIdx<nPxCount; ++nPxIdx) {
+            const uint64_t bValid = uint64_t(pGT[nPxIdx]!=DATASETUTILS_OUTOFSCOPE_VAL && pGT[nPxIdx]!=DATASETUTILS_UNKNOWN_VAL && (!pROI || pROI[nPxIdx]!=DATASETUTILS_NEGATIVE_VAL));
+            const uint64_t bInputPos = uint64_t(pInput[nPxIdx]==DATASETUTILS_POSITIVE_VAL);
+            const uint64_t bGTPos = uint64_t(pGT[nPxIdx]==DATASETUTILS_POSITIVE_VAL);
+            nValid += bValid;
+            nTP += bValid&bInputPos&bGTPos;
+            nFP += bValid&bInputPos&(bGTPos^1);
+            nFN += bValid&(bInputPos^1)&bGTPos;
+            nSE += bValid&bInputPos&uint64_t(pGT[nPxIdx]==DATASETUTILS_SHADOW_VAL);
+        }
+        // negatives are whatever valid pixels are left, and 'dont cares' are whatever pixels are not valid
+        oCounters.nTP += nTP;
+        oCounters.nFP += nFP;
+        oCounters.nFN += nFN;
+        oCounters.nTN += nValid-nTP-nFP-nFN;
+        oCounters.nSE += nSE;
+        oCounters.nDC += uint64_t(nPxCount)-nValid;
+    }
+
+} // anonymous namespace
+
+void lv::BinClassif::accumulate(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI, bool bParallel) {
     lvAssert_(!oClassif.empty() && oClassif.dims==2 && oClassif.isContinuous() && oClassif.type()==CV_8UC1,"binary classifier results must be non-empty and of type 8UC1");
     lvAssert_(oGT.empty() || (oGT.type()==CV_8UC1 && oGT.isContinuous()),"gt mat must be empty, or of type 8UC1");
-    lvAssert_(oROI.empty() || (oROI.type()==CV_8UC1 && oGT.isContinuous()),"ROI mat must be empty, or of type 8UC1");
+    lvAssert_(oROI.empty() || (oROI.type()==CV_8UC1 && oROI.isContinuous()),"ROI mat must be empty, or of type 8UC1");
     lvAssert_((oGT.empty() || oClassif.size()==oGT.size()) && (oROI.empty() || oClassif.size()==oROI.size()),"all input mat sizes must match");
     if(oGT.empty()) {
         nDC += oClassif.size().area();
         return;
     }
-    const size_t step_row = oClassif.step.p[0];
-    for(size_t i = 0; i<(size_t)oClassif.rows; ++i) {
-        const size_t idx_nstep = step_row*i;
-        const uchar* input_step_ptr = oClassif.data+idx_nstep;
-        const uchar* gt_step_ptr = oGT.data+idx_nstep;
-        const uchar* roi_step_ptr = oROI.data+idx_nstep;
-        for(int j = 0; j<oClassif.cols; ++j) {
-            if(gt_step_ptr[j]!=DATASETUTILS_OUTOFSCOPE_VAL &&
-               gt_step_ptr[j]!=DATASETUTILS_UNKNOWN_VAL &&
-               (oROI.empty() || roi_step_ptr[j]!=DATASETUTILS_NEGATIVE_VAL)) {
-                if(input_step_ptr[j]==DATASETUTILS_POSITIVE_VAL) {
-                    if(gt_step_ptr[j]==DATASETUTILS_POSITIVE_VAL)
-                        ++nTP;
-                    else // gt_step_ptr[j]==s_nSegmNegative
-                        ++nFP;
-                }
-                else { // input_step_ptr[j]==s_nSegmNegative
-                    if(gt_step_ptr[j]==DATASETUTILS_POSITIVE_VAL)
-                        ++nFN;
-                    else // gt_step_ptr[j]==s_nSegmNegative
-                        ++nTN;
-                }
-                if(gt_step_ptr[j]==DATASETUTILS_SHADOW_VAL) {
-                    if(input_step_ptr[j]==DATASETUTILS_POSITIVE_VAL)
-                        ++nSE;
-                }
+    // all mats are continuous and share the same size, so rows can be processed as one contiguous range
+    const uchar* pROI = oROI.empty()?nullptr:oROI.data;
+#if USING_OPENMP
+    if(bParallel && oClassif.size().area()>=BINCLASSIF_PARALLEL_MIN_AREA) {
+        const size_t nCols = size_t(oClassif.cols);
+        const int nRows = oClassif.rows;
+        uint64_t nTP_=0, nTN_=0, nFP_=0, nFN_=0, nSE_=0, nDC_=0;
+        #pragma omp parallel reduction(+:nTP_,nTN_,nFP_,nFN_,nSE_,nDC_)
+        {
+            BinClassif oLocalCounters;
+            #pragma omp for schedule(static)
+            for(int nRowIdx=0; nRowIdx<nRows; ++nRowIdx) {
+                const size_t nOffset = size_t(nRowIdx)*nCols;
+                accumulateBinClassifRange(oClassif.data+nOffset,oGT.data+nOffset,pROI?pROI+nOffset:nullptr,nCols,oLocalCounters);
             }
-            else
-                ++nDC;
+            nTP_ += oLocalCounters.nTP; nTN_ += oLocalCounters.nTN; nFP_ += oLocalCounters.nFP;
+            nFN_ += oLocalCounters.nFN; nSE_ += oLocalCounters.nSE; nDC_ += oLocalCounters.nDC;
         }
+        nTP += nTP_; nTN += nTN_; nFP += nFP_; nFN += nFN_; nSE += nSE_; nDC += nDC_;
+        return;
     }
+#else //(!USING_OPENMP)
+    UNUSED(bParallel);
+#endif //(!USING_OPENMP)
+    accumulateBinClassifRange(oClassif.data,oGT.data,pROI,oClassif.total(),*this);
 }
 
 cv::Mat lv::BinClassif::getColoredMask(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI) {
@@ -0,0 +1,287 @@
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "litiv/datasets/pack.hpp"
+#if USING_LZ4
+#include <lz4.h>
+#endif //USING_LZ4
+
+#define DATAPACK_VERSION         2
+#define DATAPACK_BLOCK_ALIGNMENT 64 // all blocks (and the index) start on a cache line, so raw planes can be used directly
+
+namespace {
+
+    /// fixed-size file header, followed by the packet blocks, and by the index
+    struct DataPackHeader {
+        char acMagic[8];
+        uint32_t nVersion,nIndexEntrySize;
+        uint64_t nInputCount,nGTCount;
+        uint64_t nIndexOffset;
+        double dScaleFactor;
+    };
+
+    constexpr char s_acDataPackMagic[8] = {'L','V','D','P','A','C','K','\0'};
+
+    /// pads the output stream with zeros up to the next block boundary
+    uint64_t padToBlockAlignment(std::ofstream& ssFile) {
+        const uint64_t nCurrOffset = (uint64_t)ssFile.tellp();
+        const uint64_t nAlignedOffset = ((nCurrOffset+DATAPACK_BLOCK_ALIGNMENT-1)/DATAPACK_BLOCK_ALIGNMENT)*DATAPACK_BLOCK_ALIGNMENT;
+        const std::array<char,DATAPACK_BLOCK_ALIGNMENT> acPadding = {};
+        ssFile.write(acPadding.data(),std::streamsize(nAlignedOffset-nCurrOffset));
+        return nAlignedOffset;
+    }
+
+    /// read-only stream buffer over a memory block (lets binary mat archives be parsed straight from the mapping)
+    struct MappedStreamBuf : std::streambuf {
+        MappedStreamBuf(const uint8_t* pData, size_t nSize) {
+            char* pBegin = (char*)pData;
+            setg(pBegin,pBegin,pBegin+nSize);
+        }
+    };
+
+    /// mat allocator for raw packets which point into a mapping (each packet header holds a reference to the mapping via its 'userdata')
+    struct MappedPacketAllocator : public cv::MatAllocator {
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, int flags, cv::UMatUsageFlags usageFlags) const override {
+            // packets reallocated via 'create' go back to regular (owned) memory
+            return cv::Mat::getStdAllocator()->allocate(dims,sizes,type,data,step,flags,usageFlags);
+        }
+        bool allocate(cv::UMatData* data, int /*accessFlags*/, cv::UMatUsageFlags /*usageFlags*/) const override {
+            return (data!=nullptr);
+        }
+        void deallocate(cv::UMatData* data) const override {
+            if(data==nullptr)
+                return;
+            lvDbgAssert(data->urefcount>=0 && data->refcount>=0);
+            if(data->refcount==0) {
+                delete (std::shared_ptr<uint8_t>*)data->userdata;
+                data->userdata = nullptr;
+                delete data;
+            }
+        }
+    };
+
+    // this is an empty shell, but we need actual allocation due to ocv's virtual interface
+    MappedPacketAllocator g_oMappedPacketAlloc;
+
+    /// returns a zero-copy packet over a mapping, which keeps the mapping alive until all its copies are released
+    cv::Mat createMappedPacket(const std::shared_ptr<uint8_t>& pMapping, uint64_t nOffset, uint64_t nSize, int nDims, const int* anSizes, int nType) {
+        cv::Mat oPacket(nDims,anSizes,nType,(void*)(pMapping.get()+nOffset));
+        cv::UMatData* pData = new cv::UMatData(&g_oMappedPacketAlloc);
+        pData->data = pData->origdata = oPacket.data;
+        pData->size = size_t(nSize);
+        pData->flags |= cv::UMatData::USER_ALLOCATED;
+        pData->userdata = new std::shared_ptr<uint8_t>(pMapping);
+        pData->refcount = 1;
+        oPacket.u = pData;
+        return oPacket;
+    }
+
+} // anonymous namespace
+
+lv::DataPack::DataPack(const std::string& sFilePath) :
+        m_sFilePath(sFilePath) {
+    lvDbgExceptionWatch;
+    static_assert(sizeof(IndexEntry)%8==0,"data pack index entries should stay 8-byte aligned");
+    m_pMapping = lv::mapFileToMemory(m_sFilePath,m_nMappingSize);
+    lvAssert__(m_nMappingSize>=sizeof(DataPackHeader),"data pack at '%s' is too small to hold a header",m_sFilePath.c_str());
+    DataPackHeader oHeader;
+    std::copy_n(m_pMapping.get(),sizeof(DataPackHeader),(uint8_t*)&oHeader);
+    lvAssert__(std::equal(oHeader.acMagic,oHeader.acMagic+sizeof(s_acDataPackMagic),s_acDataPackMagic),"file at '%s' is not a data pack",m_sFilePath.c_str());
+    lvAssert__(oHeader.nVersion==DATAPACK_VERSION && oHeader.nIndexEntrySize==sizeof(IndexEntry),"data pack at '%s' has an unsupported version (%d)",m_sFilePath.c_str(),(int)oHeader.nVersion);
+    m_nInputCount = size_t(oHeader.nInputCount);
+    m_nGTCount = size_t(oHeader.nGTCount);
+    m_dScaleFactor = oHeader.dScaleFactor;
+    const uint64_t nEntryCount = oHeader.nInputCount+oHeader.nGTCount;
+    lvAssert__(oHeader.nIndexOffset%DATAPACK_BLOCK_ALIGNMENT==0 && oHeader.nIndexOffset<=m_nMappingSize,"data pack at '%s' has a corrupted index",m_sFilePath.c_str());
+    MappedStreamBuf oIndexStreamBuf(m_pMapping.get()+oHeader.nIndexOffset,m_nMappingSize-size_t(oHeader.nIndexOffset));
+    std::istream ssIndex(&oIndexStreamBuf);
+    lv::read(ssIndex,m_oIndex,lv::MatArchive_BINARY);
+    lvAssert__(m_oIndex.type()==CV_8UC1 && m_oIndex.dims==2 && uint64_t(m_oIndex.rows)==nEntryCount && m_oIndex.cols==int(sizeof(IndexEntry)) && m_oIndex.isContinuous(),"data pack at '%s' has a corrupted index",m_sFilePath.c_str());
+    m_pIndex = (const IndexEntry*)m_oIndex.data;
+    for(size_t nEntryIdx=0; nEntryIdx<nEntryCount; ++nEntryIdx) {
+        const IndexEntry& oEntry = m_pIndex[nEntryIdx];
+        lvAssert__(oEntry.nDims>=0 && oEntry.nDims<=int32_t(sizeof(oEntry.anSizes)/sizeof(int32_t)),"data pack at '%s' has a corrupted index entry (#%d)",m_sFilePath.c_str(),(int)nEntryIdx);
+        uint64_t nExpectedRawSize = (oEntry.nDims>0)?(uint64_t)CV_ELEM_SIZE(oEntry.nType):0u;
+        for(int32_t nDimIdx=0; nDimIdx<oEntry.nDims; ++nDimIdx) {
+            lvAssert__(oEntry.anSizes[nDimIdx]>=0,"data pack at '%s' has a corrupted index entry (#%d)",m_sFilePath.c_str(),(int)nEntryIdx);
+            nExpectedRawSize *= uint64_t(oEntry.anSizes[nDimIdx]);
+        }
+        lvAssert__(oEntry.nRawSize==nExpectedRawSize && oEntry.nOffset<=oHeader.nIndexOffset && oEntry.nStoredSize<=oHeader.nIndexOffset-oEntry.nOffset,"data pack at '%s' has a corrupted index entry (#%d)",m_sFilePath.c_str(),(int)nEntryIdx);
+        lvAssert__(oEntry.nBlockType==DataPackBlock_Raw || oEntry.nBlockType==DataPackBlock_LZ4,"data pack at '%s' has an unknown block type (entry #%d)",m_sFilePath.c_str(),(int)nEntryIdx);
+        lvAssert__(oEntry.nBlockType!=DataPackBlock_Raw || oEntry.nStoredSize==oEntry.nRawSize,"data pack at '%s' has a corrupted index entry (#%d)",m_sFilePath.c_str(),(int)nEntryIdx);
+    }
+    lvLog_(2,"data pack at '%s' opened with %zu input packet(s) and %zu gt packet(s)",m_sFilePath.c_str(),m_nInputCount,m_nGTCount);
+}
+
+cv::Mat lv::DataPack::getInput(size_t nPacketIdx) const {
+    if(nPacketIdx>=m_nInputCount)
+        return cv::Mat();
+    return getPacket(nPacketIdx);
+}
+
+cv::Mat lv::DataPack::getGT(size_t nPacketIdx) const {
+    if(nPacketIdx>=m_nGTCount)
+        return cv::Mat();
+    return getPacket(m_nInputCount+nPacketIdx);
+}
+
+lv::MatInfo lv::DataPack::getInputInfo(size_t nPacketIdx) const {
+    if(nPacketIdx>=m_nInputCount)
+        return lv::MatInfo();
+    return getPacketInfo(nPacketIdx);
+}
+
+lv::MatInfo lv::DataPack::getGTInfo(size_t nPacketIdx) const {
+    if(nPacketIdx>=m_nGTCount)
+        return lv::MatInfo();
+    return getPacketInfo(m_nInputCount+nPacketIdx);
+}
+
+bool lv::DataPack::isMappedPacket(const cv::Mat& oPacket) const {
+    return !oPacket.empty() && oPacket.datastart>=m_pMapping.get() && oPacket.dataend<=m_pMapping.get()+m_nMappingSize;
+}
+
+lv::MatInfo lv::DataPack::getPacketInfo(size_t nEntryIdx) const {
+    lvDbgAssert(nEntryIdx<m_nInputCount+m_nGTCount);
+    const IndexEntry& oEntry = m_pIndex[nEntryIdx];
+    if(oEntry.nRawSize==0u)
+        return lv::MatInfo();
+    return lv::MatInfo(lv::MatSize(oEntry.nDims,oEntry.anSizes),lv::MatType(oEntry.nType));
+}
+
+cv::Mat lv::DataPack::getPacket(size_t nEntryIdx) const {
+    lvDbgAssert(nEntryIdx<m_nInputCount+m_nGTCount);
+    const IndexEntry& oEntry = m_pIndex[nEntryIdx];
+    if(oEntry.nRawSize==0u)
+        return cv::Mat();
+    if(oEntry.nBlockType==DataPackBlock_Raw)
+        return createMappedPacket(m_pMapping,oEntry.nOffset,oEntry.nRawSize,oEntry.nDims,oEntry.anSizes,oEntry.nType);
+#if USING_LZ4
+    cv::Mat oPacket(oEntry.nDims,oEntry.anSizes,oEntry.nType);
+    lvAssert__(oEntry.nRawSize<uint64_t(std::numeric_limits<int32_t>::max()) && oEntry.nStoredSize<uint64_t(std::numeric_limits<int32_t>::max()),"data pack at '%s' holds a packet too big for lz4",m_sFilePath.c_str());
+    const int nDecomprRes = LZ4_decompress_safe((const char*)(m_pMapping.get()+oEntry.nOffset),(char*)oPacket.data,int(oEntry.nStoredSize),int(oEntry.nRawSize));
+    lvAssert__(nDecomprRes==int(oEntry.nRawSize),"lz4 decompression failed for data pack at '%s' (%d)",m_sFilePath.c_str(),nDecomprRes);
+    return oPacket;
+#else //!USING_LZ4
+    lvError_("data pack at '%s' holds lz4 blocks, but framework was built without lz4 support",m_sFilePath.c_str());
+#endif //!USING_LZ4
+}
+
+void lv::DataPack::write(const std::string& sFilePath, IIDataLoader& oBatch, DataPackBlockList eBlockType, bool bWithGT) {
+    lvDbgExceptionWatch;
+    lvAssert_(!sFilePath.empty(),"data pack file path must be non-empty");
+#if !USING_LZ4
+    lvAssert_(eBlockType!=DataPackBlock_LZ4,"framework was built without lz4 support");
+#endif //!USING_LZ4
+    // the attached pack (if any) is still mapped and read from below, so it cannot be truncated here
+    lvAssert__(!oBatch.getDataPack() || oBatch.getDataPack()->getFilePath()!=sFilePath,"cannot overwrite the data pack attached to batch '%s'",oBatch.getName().c_str());
+    std::ofstream ssFile(sFilePath,std::ios::binary);
+    lvAssert__(ssFile.is_open(),"could not open data pack at '%s' for writing",sFilePath.c_str());
+    DataPackHeader oHeader;
+    std::copy_n(s_acDataPackMagic,sizeof(s_acDataPackMagic),oHeader.acMagic);
+    oHeader.nVersion = DATAPACK_VERSION;
+    oHeader.nIndexEntrySize = uint32_t(sizeof(IndexEntry));
+    oHeader.nInputCount = uint64_t(oBatch.getInputCount());
+    oHeader.nGTCount = (bWithGT && oBatch.getGTCount()>0)?oHeader.nInputCount:0u; // gt packets are indexed like input packets (and may be empty)
+    lvAssert__(oHeader.nInputCount>0u,"cannot pack batch '%s' without input packets",oBatch.getName().c_str());
+    oHeader.nIndexOffset = 0u; // filled in once all blocks are written
+    oHeader.dScaleFactor = oBatch.getScaleFactor();
+    ssFile.write((const char*)&oHeader,sizeof(oHeader));
+    std::vector<IndexEntry> vIndex;
+    vIndex.reserve(size_t(oHeader.nInputCount+oHeader.nGTCount));
+#if USING_LZ4
+    std::vector<char> vcComprBuffer;
+#endif //USING_LZ4
+    const auto lWritePacket = [&](const cv::Mat& _oPacket) {
+        IndexEntry oEntry = {};
+        oEntry.nOffset = padToBlockAlignment(ssFile);
+        oEntry.nBlockType = DataPackBlock_Raw;
+        if(!_oPacket.empty()) {
+            lvAssert_(_oPacket.dims<=int(sizeof(oEntry.anSizes)/sizeof(int32_t)),"packet has too many dimensions for data pack");
+            const cv::Mat oPacket = _oPacket.isContinuous()?_oPacket:_oPacket.clone();
+            oEntry.nType = int32_t(oPacket.type());
+            oEntry.nDims = int32_t(oPacket.dims);
+            for(int nDimIdx=0; nDimIdx<oPacket.dims; ++nDimIdx)
+                oEntry.anSizes[nDimIdx] = int32_t(oPacket.size[nDimIdx]);
+            oEntry.nRawSize = oEntry.nStoredSize = uint64_t(oPacket.total()*oPacket.elemSize());
+        #if USING_LZ4
+            if(eBlockType==DataPackBlock_LZ4) {
+                lvAssert_(oEntry.nRawSize<uint64_t(std::numeric_limits<int32_t>::max()),"packet size too big for lz4");
+                vcComprBuffer.resize(size_t(LZ4_compressBound(int(oEntry.nRawSize))));
+                const int nComprSize = LZ4_compress_default((const char*)oPacket.data,vcComprBuffer.data(),int(oEntry.nRawSize),int(vcComprBuffer.size()));
+                lvAssert__(nComprSize>0,"lz4 compression failed (%d)",nComprSize);
+                if(uint64_t(nComprSize)<oEntry.nRawSize) { // incompressible packets are kept as raw blocks
+                    oEntry.nBlockType = DataPackBlock_LZ4;
+                    oEntry.nStoredSize = uint64_t(nComprSize);
+                    ssFile.write(vcComprBuffer.data(),nComprSize);
+                }
+            }
+        #endif //USING_LZ4
+            if(oEntry.nBlockType==DataPackBlock_Raw)
+                ssFile.write((const char*)oPacket.data,std::streamsize(oEntry.nRawSize));
+        }
+        vIndex.push_back(oEntry);
+    };
+    for(size_t nPacketIdx=0; nPacketIdx<size_t(oHeader.nInputCount); ++nPacketIdx)
+        lWritePacket(oBatch.getInput(nPacketIdx));
+    for(size_t nPacketIdx=0; nPacketIdx<size_t(oHeader.nGTCount); ++nPacketIdx)
+        lWritePacket(oBatch.getGT(nPacketIdx));
+    oHeader.nIndexOffset = padToBlockAlignment(ssFile);
+    lv::write(ssFile,cv::Mat(int(vIndex.size()),int(sizeof(IndexEntry)),CV_8UC1,vIndex.data()),lv::MatArchive_BINARY);
+    ssFile.seekp(0);
+    ssFile.write((const char*)&oHeader,sizeof(oHeader));
+    lvAssert__(ssFile,"data pack write failed for '%s'",sFilePath.c_str());
+    lvLog_(2,"data pack for batch '%s' written at '%s' (%zu input packet(s), %zu gt packet(s))",oBatch.getName().c_str(),sFilePath.c_str(),size_t(oHeader.nInputCount),size_t(oHeader.nGTCount));
+}
+
+std::string lv::DataPack::getDefaultFileName(const IDataHandler& oBatch) {
+    std::string sFileName = oBatch.getName();
+    for(IDataHandlerConstPtr pParent=oBatch.getParent(); pParent; pParent=pParent->getParent())
+        if(!pParent->isBare())
+            sFileName = pParent->getName()+"_"+sFileName;
+    return sFileName+".lvpack";
+}
+
+size_t lv::writeDataPacks(const IDataHandlerPtr& pHandler, const std::string& sPackDirPath, DataPackBlockList eBlockType, bool bWithGT) {
+    lvDbgExceptionWatch;
+    lvAssert_(pHandler,"invalid data handler");
+    const std::string sDirPath = lv::addDirSlashIfMissing(sPackDirPath);
+    lvAssert__(lv::createDirIfNotExist(sDirPath),"could not create data pack directory at '%s'",sDirPath.c_str());
+    const IDataHandlerPtrArray vpBatches = pHandler->isGroup()?pHandler->getBatches(false):IDataHandlerPtrArray{pHandler};
+    for(const IDataHandlerPtr& pBatch : vpBatches) {
+        auto pLoader = std::dynamic_pointer_cast<IIDataLoader>(pBatch);
+        lvAssert__(pLoader,"work batch '%s' cannot be packed (not a data loader)",pBatch->getName().c_str());
+        DataPack::write(sDirPath+DataPack::getDefaultFileName(*pBatch),*pLoader,eBlockType,bWithGT);
+    }
+    return vpBatches.size();
+}
+
+size_t lv::attachDataPacks(const IDataHandlerPtr& pHandler, const std::string& sPackDirPath) {
+    lvDbgExceptionWatch;
+    lvAssert_(pHandler,"invalid data handler");
+    const std::string sDirPath = lv::addDirSlashIfMissing(sPackDirPath);
+    const IDataHandlerPtrArray vpBatches = pHandler->isGroup()?pHandler->getBatches(false):IDataHandlerPtrArray{pHandler};
+    size_t nAttachedPacks = 0;
+    for(const IDataHandlerPtr& pBatch : vpBatches) {
+        auto pLoader = std::dynamic_pointer_cast<IIDataLoader>(pBatch);
+        const std::string sFilePath = sDirPath+DataPack::getDefaultFileName(*pBatch);
+        if(pLoader && lv::checkIfExists(sFilePath)) {
+            pLoader->setDataPack(std::make_shared<DataPack>(sFilePath));
+            ++nAttachedPacks;
+        }
+    }
+    return nAttachedPacks;
+}
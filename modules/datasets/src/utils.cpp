@@ -23,6 +23,7 @@
 #define PRECACHE_QUERY_TIMEOUT_MS          10
 #define PRECACHE_QUERY_END_TIMEOUT_MS      500
 #define PRECACHE_REFILL_TIMEOUT_MS         5000
+#define DATAWRITER_PNG_COMPRESSION         1 // fast (low) compression level for png-encoded packets
 #if (!(defined(_M_X64) || defined(__amd64__) || defined(__aarch64__)) && CACHE_MAX_SIZE_MB>2048)
 #error "Cache max size exceeds system limit (x86)."
 #endif //(!(defined(...arch...)) && CACHE_MAX_SIZE_MB>2048)
@@ -263,9 +264,9 @@ lv::IDataHandlerPtrArray lv::DataGroupHandler::getBatches(bool bWithHierarchy) c
     return vpBatches;
 }
 
-void lv::DataGroupHandler::startPrecaching(bool bPrecacheInputOnly, size_t nSuggestedBufferSize) {
+void lv::DataGroupHandler::startPrecaching(bool bPrecacheInputOnly, size_t nSuggestedBufferSize, size_t nDecodeWorkers) {
     for(const auto& pBatch : getBatches(true))
-        pBatch->startPrecaching(bPrecacheInputOnly,nSuggestedBufferSize);
+        pBatch->startPrecaching(bPrecacheInputOnly,nSuggestedBufferSize,nDecodeWorkers);
 }
 
 void lv::DataGroupHandler::stopPrecaching() {
@@ -299,12 +300,21 @@ void lv::DataGroupHandler::parseData() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+constexpr size_t lv::DataPrecacher::s_nMaxReadyPackets;
+
 lv::DataPrecacher::DataPrecacher(std::function<cv::Mat(size_t)> lDataLoaderCallback) :
         m_lCallback(lDataLoaderCallback) {
     lvAssert_(m_lCallback,"invalid data precacher callback");
     m_bIsActive = m_bGotRequest = false;
     m_pWorkerException = nullptr;
     m_nAnswIdx = m_nReqIdx = m_nLastReqIdx = size_t(-1);
+    m_nDecodeWorkers = 1;
+    m_nDecodeWindowSize = m_nDecodeByteBudget = m_nDecodedBytes = 0;
+    m_nNextDecodeIdx = m_nDecodeCommitIdx = m_nDecodeGeneration = 0;
+    m_nDecodeEndIdx = size_t(-1);
+    m_vpReadySlots.resize(s_nMaxReadyPackets);
+    m_nReadyHead = m_nReadyTail = 0;
+    m_nLockedRequestCount = 0;
 }
 
 lv::DataPrecacher::~DataPrecacher() {
@@ -313,16 +323,38 @@ lv::DataPrecacher::~DataPrecacher() {
 
 const cv::Mat& lv::DataPrecacher::getPacket(size_t nIdx) {
     lvDbgExceptionWatch;
-    if(nIdx==m_nLastReqIdx) {
+    // the last view is kept by the precacher itself, so the returned packet stays valid until the next call
+    return *getPacketView(nIdx);
+}
+
+std::shared_ptr<const cv::Mat> lv::DataPrecacher::getPacketView(size_t nIdx) {
+    lvDbgExceptionWatch;
+    if(nIdx==m_nLastReqIdx && m_pLastReqView) {
         lvLog_(4,"data precacher [%" PRIxPTR "] skipping request, returning (last) packet at idx = %zu...",uintptr_t(this),nIdx);
-        return m_oLastReqPacket;
+        return m_pLastReqView;
     }
     else if(!m_bIsActive) {
         lvLog_(4,"data precacher [%" PRIxPTR "] bypassing inactive precaching thread, fetching packet at idx = %zu...",uintptr_t(this),nIdx);
-        m_oLastReqPacket = m_lCallback(nIdx);
+        m_pLastReqView = std::make_shared<const cv::Mat>(m_lCallback(nIdx));
         m_nLastReqIdx = nIdx;
-        return m_oLastReqPacket;
+        return m_pLastReqView;
+    }
+    // lock-free fast path: pop the packet from the ready queue if already cached (older packets are skipped, as with in-order reads)
+    size_t nReadyTail = m_nReadyTail.load(std::memory_order_relaxed);
+    const size_t nReadyHead = m_nReadyHead.load(std::memory_order_acquire);
+    while(nReadyTail!=nReadyHead && m_vpReadySlots[nReadyTail%s_nMaxReadyPackets]->nIdx<=nIdx) {
+        const std::shared_ptr<PacketSlot>& pSlot = m_vpReadySlots[(nReadyTail++)%s_nMaxReadyPackets];
+        if(pSlot->nIdx==nIdx) {
+            m_pLastReqView = createPacketView(pSlot);
+            m_nLastReqIdx = nIdx;
+            m_nReadyTail.store(nReadyTail,std::memory_order_release);
+            m_oReqCondVar.notify_one(); // wakes up the precaching thread to refill the freed slot
+            return m_pLastReqView;
+        }
+        pSlot->bReleased.store(true,std::memory_order_release);
     }
+    m_nReadyTail.store(nReadyTail,std::memory_order_release);
+    ++m_nLockedRequestCount;
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
     lvAssert_(!m_bGotRequest,"data precacher trying two requests at once!");
     size_t nAnswIdx = size_t(-1);
@@ -331,10 +363,8 @@ const cv::Mat& lv::DataPrecacher::getPacket(size_t nIdx) {
     m_oReqCondVar.notify_one();
     lvLog_(4,"data precacher [%" PRIxPTR "] sending request for packet at idx = %zu...",uintptr_t(this),nIdx);
     const std::chrono::milliseconds nTimeout(PRECACHE_REQUEST_TIMEOUT_MS);
-    while(!m_oSyncCondVar.wait_for(sync_lock,nTimeout,[&](){return !(m_bIsActive && m_pWorkerException==nullptr && nAnswIdx!=m_nReqIdx);})) {
-        nAnswIdx = m_nAnswIdx.load();
-        if(nAnswIdx!=m_nReqIdx)
-            lvLog_(3,"data precacher [%" PRIxPTR "] retrying request for packet #%zu...",uintptr_t(this),nIdx);
+    while(!m_oSyncCondVar.wait_for(sync_lock,nTimeout,[&](){nAnswIdx = m_nAnswIdx.load(); return !(m_bIsActive && m_pWorkerException==nullptr && nAnswIdx!=m_nReqIdx);})) {
+        lvLog_(3,"data precacher [%" PRIxPTR "] retrying request for packet #%zu...",uintptr_t(this),nIdx);
         if(m_pWorkerException || !m_bIsActive) {
             lvLog_(1,"data precacher [%" PRIxPTR "] shutdown/error caught during query of packet #%zu (throwing)",uintptr_t(this),nIdx);
             break; // hard exit, something went wrong, will throw below
@@ -347,15 +377,27 @@ const cv::Mat& lv::DataPrecacher::getPacket(size_t nIdx) {
     else if(m_pWorkerException) {
         lvLog_(1,"data precacher [%" PRIxPTR "] caught precacher exception while requesting packet #%zu, will rethrow...",uintptr_t(this),nIdx);
         m_bIsActive = false;
-        m_hWorker.join();
+        sync_lock.unlock(); // the precaching thread may still be alive if a decode worker failed
+        joinWorkers();
         std::rethrow_exception(m_pWorkerException);
     }
-    m_oLastReqPacket = m_oReqPacket;
+    m_pLastReqView = std::move(m_pReqView);
     m_nLastReqIdx = nAnswIdx;
-    return m_oLastReqPacket;
+    return m_pLastReqView;
+}
+
+std::shared_ptr<const cv::Mat> lv::DataPrecacher::createPacketView(const std::shared_ptr<PacketSlot>& pSlot) {
+    // the view aliases the slot's packet header, and releases the slot (instead of deleting anything) once its last copy is gone
+    return std::shared_ptr<const cv::Mat>(&pSlot->oPacket,[pSlot](const cv::Mat*) {
+        pSlot->bReleased.store(true,std::memory_order_release);
+    });
 }
 
-bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize) {
+bool lv::DataPrecacher::isCachedPacket(const cv::Mat& oPacket) const {
+    return m_pCacheBuffer && !oPacket.empty() && oPacket.datastart>=m_pCacheBuffer->data() && oPacket.dataend<=m_pCacheBuffer->data()+m_pCacheBuffer->size();
+}
+
+bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize, size_t nDecodeWorkers) {
     static_assert(PRECACHE_REQUEST_TIMEOUT_MS>0,"Precache request timeout must be a positive value");
     static_assert(PRECACHE_QUERY_TIMEOUT_MS>0,"Precache query timeout must be a positive value");
     static_assert(PRECACHE_QUERY_END_TIMEOUT_MS>0,"Precache query post-end timeout must be a positive value");
@@ -366,9 +408,23 @@ bool lv::DataPrecacher::startAsyncPrecaching(size_t nSuggestedBufferSize) {
         m_pWorkerException = nullptr;
         m_nAnswIdx = m_nReqIdx = size_t(-1);
         m_bGotRequest = false;
+        m_nReadyHead = m_nReadyTail = 0;
+        m_nLockedRequestCount = 0;
         const size_t nBufferSize = std::max(std::min(nSuggestedBufferSize,CACHE_MAX_SIZE),CACHE_MIN_SIZE);
-        lvLog_(2,"data precacher [%" PRIxPTR "] precaching thread init w/ buffer size = %zu mb",uintptr_t(this),(nBufferSize/1024)/1024);
-        m_hWorker = std::thread(&DataPrecacher::entry,this,nBufferSize);
+        m_nDecodeWorkers = (nDecodeWorkers==0)?std::max(size_t(std::thread::hardware_concurrency()),size_t(1)):nDecodeWorkers;
+        // out-of-order packets waiting for commit take a quarter of the buffer, so that both stay within the cache size limits
+        m_nDecodeByteBudget = (m_nDecodeWorkers>1)?nBufferSize/4:0;
+        m_nDecodeWindowSize = m_nDecodeWorkers*2;
+        m_nDecodedBytes = 0;
+        m_nNextDecodeIdx = m_nDecodeCommitIdx = m_nDecodeGeneration = 0;
+        m_nDecodeEndIdx = size_t(-1);
+        m_mDecodedPackets.clear();
+        lvLog_(2,"data precacher [%" PRIxPTR "] precaching thread init w/ buffer size = %zu mb, and %zu decode worker(s)",uintptr_t(this),(nBufferSize/1024)/1024,m_nDecodeWorkers);
+        m_pCacheBuffer = std::make_shared<std::vector<uchar>>(nBufferSize-m_nDecodeByteBudget);
+        m_hWorker = std::thread(&DataPrecacher::entry,this,nBufferSize-m_nDecodeByteBudget);
+        if(m_nDecodeWorkers>1)
+            for(size_t nWorkerIdx=0; nWorkerIdx<m_nDecodeWorkers; ++nWorkerIdx)
+                m_vhDecodeWorkers.emplace_back(&DataPrecacher::entry_decode,this);
     }
     return m_bIsActive;
 }
@@ -378,31 +434,201 @@ void lv::DataPrecacher::stopAsyncPrecaching() {
     if(m_bIsActive) {
         m_bIsActive = false;
         lvLog_(2,"data precacher [%" PRIxPTR "] joining precaching thread",uintptr_t(this));
-        m_hWorker.join();
+        joinWorkers();
         lvAssert_(!m_bGotRequest,"last request should have been answered");
     }
     if(m_pWorkerException)
         std::rethrow_exception(m_pWorkerException);
 }
 
+void lv::DataPrecacher::resetLastPacket() {
+    lvDbgExceptionWatch;
+    lvAssert_(!m_bIsActive,"cannot reset last packet while precaching");
+    m_pLastReqView = nullptr;
+    m_nLastReqIdx = size_t(-1);
+}
+
+void lv::DataPrecacher::joinWorkers() {
+    lvDbgAssert(!m_bIsActive);
+    m_oDecodeCondVar.notify_all();
+    if(m_hWorker.joinable())
+        m_hWorker.join();
+    for(std::thread& hDecodeWorker : m_vhDecodeWorkers)
+        hDecodeWorker.join();
+    m_vhDecodeWorkers.clear();
+    m_mDecodedPackets.clear();
+    m_nDecodedBytes = 0;
+    // cached packets still referenced by outstanding views (and their buffer) are only freed once these are released
+    for(std::shared_ptr<PacketSlot>& pSlot : m_vpReadySlots)
+        pSlot.reset();
+    m_pReqView.reset();
+    m_pCacheBuffer.reset();
+}
+
+void lv::DataPrecacher::entry_decode() {
+    try {
+        lvDbgExceptionWatch;
+        lv::mutex_unique_lock decode_lock(m_oDecodeMutex);
+        while(m_bIsActive) {
+            // packets are claimed in index order, but only within a window past the next packet to commit (bounds memory held out of the cache)
+            const size_t nPacketIdx = m_nNextDecodeIdx;
+            if(nPacketIdx>=m_nDecodeEndIdx || nPacketIdx>=m_nDecodeCommitIdx+m_nDecodeWindowSize || (m_nDecodedBytes>=m_nDecodeByteBudget && !m_mDecodedPackets.empty())) {
+                m_oDecodeCondVar.wait_for(decode_lock,std::chrono::milliseconds(PRECACHE_QUERY_TIMEOUT_MS));
+                continue;
+            }
+            const size_t nGeneration = m_nDecodeGeneration;
+            ++m_nNextDecodeIdx;
+            decode_lock.unlock();
+            cv::Mat oPacket = m_lCallback(nPacketIdx);
+            decode_lock.lock();
+            if(nGeneration==m_nDecodeGeneration && nPacketIdx>=m_nDecodeCommitIdx) {
+                if(oPacket.empty())
+                    m_nDecodeEndIdx = std::min(m_nDecodeEndIdx,nPacketIdx);
+                m_nDecodedBytes += oPacket.total()*oPacket.elemSize();
+                m_mDecodedPackets.emplace(nPacketIdx,oPacket);
+                m_oDecodeCondVar.notify_all();
+                m_oReqCondVar.notify_one();
+            }
+            else
+                lvLog_(5,"data precacher [%" PRIxPTR "] dropping stale decoded packet at idx = %zu",uintptr_t(this),nPacketIdx);
+        }
+    }
+    catch(...) {
+        lv::mutex_lock_guard sync_lock(m_oSyncMutex);
+        if(!m_pWorkerException)
+            m_pWorkerException = std::current_exception();
+    }
+}
+
 void lv::DataPrecacher::entry(const size_t nBufferSize) {
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
     try {
         lvDbgExceptionWatch;
-        std::list<cv::Mat> lCache;
-        std::vector<uchar> vcBuffer(nBufferSize);
-        size_t nNextExpectedReqIdx = 0;
+        // slots are allocated in buffer order, and only recycled from the front once consumed (or skipped) and released by all views
+        std::deque<std::shared_ptr<PacketSlot>> qpAllocatedSlots;
+        const std::shared_ptr<std::vector<uchar>> pBuffer = m_pCacheBuffer;
+        lvDbgAssert(pBuffer && pBuffer->size()==nBufferSize);
         size_t nNextPrecacheIdx = 0;
         size_t nFirstBufferIdx = size_t(-1);
         size_t nNextBufferIdx = size_t(-1);
         size_t nLastTargetPacketIdx = size_t(-1);
         cv::Mat oLastTargetPacket;
         bool bReachedEnd = false;
-        const auto lCacheNextPacket = [&](size_t nTargetPacketIdx) -> size_t {
+        const auto lReclaimSlots = [&]() {
+            while(!qpAllocatedSlots.empty() && qpAllocatedSlots.front()->bReleased.load(std::memory_order_acquire))
+                qpAllocatedSlots.pop_front();
+            if(qpAllocatedSlots.empty())
+                nFirstBufferIdx = nNextBufferIdx = size_t(-1);
+            else
+                nFirstBufferIdx = qpAllocatedSlots.front()->nOffset;
+        };
+        const auto lGetCacheUsage = [&]() -> size_t {
+            size_t nTotCacheUsed = 0u;
+            for(const std::shared_ptr<PacketSlot>& pSlot : qpAllocatedSlots)
+                nTotCacheUsed += pSlot->oPacket.total()*pSlot->oPacket.elemSize();
+            return nTotCacheUsed;
+        };
+        // copies the packet into the buffer at the given offset, and publishes it to the consumer's ready queue
+        const auto lPushSlot = [&](const cv::Mat& oPacket, size_t nPacketIdx, size_t nOffset) {
+            std::shared_ptr<PacketSlot> pSlot = std::make_shared<PacketSlot>();
+            pSlot->oPacket = cv::Mat(oPacket.dims,oPacket.size,oPacket.type(),pBuffer->data()+nOffset);
+            oPacket.copyTo(pSlot->oPacket);
+            pSlot->nIdx = nPacketIdx;
+            pSlot->nOffset = nOffset;
+            pSlot->pBuffer = pBuffer;
+            pSlot->bReleased = false;
+            qpAllocatedSlots.push_back(pSlot);
+            const size_t nReadyHead = m_nReadyHead.load(std::memory_order_relaxed);
+            m_vpReadySlots[nReadyHead%s_nMaxReadyPackets] = std::move(pSlot);
+            m_nReadyHead.store(nReadyHead+1,std::memory_order_release);
+        };
+        // marks all ready packets up to the requested one as consumed, and returns a view to it (or nullptr if it was not cached)
+        const auto lPopRequestedSlot = [&](size_t nReqPacketIdx) -> std::shared_ptr<const cv::Mat> {
+            size_t nReadyTail = m_nReadyTail.load(std::memory_order_relaxed);
+            const size_t nReadyHead = m_nReadyHead.load(std::memory_order_relaxed);
+            std::shared_ptr<const cv::Mat> pView;
+            while(nReadyTail!=nReadyHead && !pView) {
+                const std::shared_ptr<PacketSlot>& pSlot = m_vpReadySlots[(nReadyTail++)%s_nMaxReadyPackets];
+                if(pSlot->nIdx==nReqPacketIdx)
+                    pView = createPacketView(pSlot);
+                else
+                    pSlot->bReleased = true;
+            }
+            m_nReadyTail.store(nReadyTail,std::memory_order_release);
+            return pView;
+        };
+        // drops decoded packets before 'nStartIdx', and restarts the decode workers there if it lies outside their current window (decode lock must be held)
+        const auto lResetDecodeQueue = [&](size_t nStartIdx) {
+            if(nStartIdx>=m_nDecodeCommitIdx && nStartIdx<=m_nNextDecodeIdx) {
+                while(!m_mDecodedPackets.empty() && m_mDecodedPackets.begin()->first<nStartIdx) {
+                    m_nDecodedBytes -= m_mDecodedPackets.begin()->second.total()*m_mDecodedPackets.begin()->second.elemSize();
+                    m_mDecodedPackets.erase(m_mDecodedPackets.begin());
+                }
+            }
+            else {
+                m_mDecodedPackets.clear();
+                m_nDecodedBytes = 0;
+                m_nNextDecodeIdx = nStartIdx;
+                m_nDecodeEndIdx = size_t(-1);
+                ++m_nDecodeGeneration;
+            }
+            m_nDecodeCommitIdx = nStartIdx;
+            m_oDecodeCondVar.notify_all();
+        };
+        // fetches the next packet to commit from the decode workers (or loads it inline w/o workers); returns false if it is not decoded yet
+        const auto lFetchNextPacket = [&](size_t nTargetPacketIdx, bool bWaitForDecode, cv::Mat& oPacket) -> bool {
+            if(m_nDecodeWorkers<=1) {
+                oPacket = m_lCallback(nTargetPacketIdx);
+                return true;
+            }
+            lv::mutex_unique_lock decode_lock(m_oDecodeMutex);
+            if(nTargetPacketIdx!=m_nDecodeCommitIdx)
+                lResetDecodeQueue(nTargetPacketIdx);
+            const auto lIsReady = [&]() {return nTargetPacketIdx>=m_nDecodeEndIdx || m_mDecodedPackets.count(nTargetPacketIdx)>0;};
+            if(bWaitForDecode && !lIsReady()) {
+                // the sync lock is released while waiting so that requests are never blocked on a decode
+                decode_lock.unlock();
+                sync_lock.unlock();
+                decode_lock.lock();
+                m_oDecodeCondVar.wait_for(decode_lock,std::chrono::milliseconds(PRECACHE_QUERY_END_TIMEOUT_MS),[&](){return !m_bIsActive || lIsReady();});
+                decode_lock.unlock();
+                sync_lock.lock();
+                decode_lock.lock();
+            }
+            if(nTargetPacketIdx>=m_nDecodeEndIdx) {
+                oPacket = cv::Mat();
+                return true;
+            }
+            const auto pPacketIter = m_mDecodedPackets.find(nTargetPacketIdx);
+            if(pPacketIter==m_mDecodedPackets.end())
+                return false;
+            oPacket = pPacketIter->second;
+            m_nDecodedBytes -= oPacket.total()*oPacket.elemSize();
+            m_mDecodedPackets.erase(pPacketIter);
+            m_nDecodeCommitIdx = nTargetPacketIdx+1;
+            m_oDecodeCondVar.notify_all();
+            return true;
+        };
+        // loads a requested packet directly (reusing it if already decoded), and moves the decode workers past it
+        const auto lLoadRequestedPacket = [&](size_t nReqPacketIdx) -> cv::Mat {
+            if(m_nDecodeWorkers>1) {
+                lv::mutex_lock_guard decode_lock(m_oDecodeMutex);
+                const auto pPacketIter = m_mDecodedPackets.find(nReqPacketIdx);
+                const cv::Mat oPacket = (pPacketIter!=m_mDecodedPackets.end())?pPacketIter->second:cv::Mat();
+                const bool bFound = pPacketIter!=m_mDecodedPackets.end();
+                lResetDecodeQueue(nReqPacketIdx+1);
+                if(bFound)
+                    return oPacket;
+            }
+            return m_lCallback(nReqPacketIdx);
+        };
+        const auto lCacheNextPacket = [&](size_t nTargetPacketIdx, bool bWaitForDecode) -> size_t {
             cv::Mat oNextPacket;
             bool bAlreadyTested = false;
             if(nTargetPacketIdx!=nLastTargetPacketIdx) {
-                oLastTargetPacket = oNextPacket = m_lCallback(nTargetPacketIdx);
+                if(!lFetchNextPacket(nTargetPacketIdx,bWaitForDecode,oNextPacket))
+                    return 0;
+                oLastTargetPacket = oNextPacket;
                 nLastTargetPacketIdx = nTargetPacketIdx;
             }
             else {
@@ -417,6 +643,11 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                 return 0;
             }
             bReachedEnd = false;
+            lReclaimSlots();
+            if(m_nReadyHead.load(std::memory_order_relaxed)-m_nReadyTail.load(std::memory_order_acquire)>=s_nMaxReadyPackets) {
+                lvLog_(bAlreadyTested?8:4,"data precacher [%" PRIxPTR "] cannot cache packet at idx = %zu (ready queue full)",uintptr_t(this),nTargetPacketIdx);
+                return 0;
+            }
             if(nFirstBufferIdx==size_t(-1) || nNextBufferIdx==size_t(-1) || nFirstBufferIdx<nNextBufferIdx) {
                 lvDbgAssert(!((nFirstBufferIdx==size_t(-1))^(nNextBufferIdx==size_t(-1))));
                 if(nNextBufferIdx==size_t(-1) || (nNextBufferIdx+nNextPacketSize>nBufferSize)) {
@@ -424,24 +655,18 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                         lvLog_(bAlreadyTested?8:4,"data precacher [%" PRIxPTR "] cannot cache packet at idx = %zu with size = %zu kb (too big/cache full)",uintptr_t(this),nTargetPacketIdx,nNextPacketSize/1024);
                         return 0;
                     }
-                    cv::Mat oNextPacket_cache(oNextPacket.dims,oNextPacket.size,oNextPacket.type(),vcBuffer.data());
-                    oNextPacket.copyTo(oNextPacket_cache);
-                    lCache.push_back(oNextPacket_cache);
+                    lPushSlot(oNextPacket,nTargetPacketIdx,0);
                     nNextBufferIdx = nNextPacketSize;
                     if(nFirstBufferIdx==size_t(-1))
                         nFirstBufferIdx = 0;
                 }
                 else { // nNextBufferIdx+nNextPacketSize<m_nBufferSize
-                    cv::Mat oNextPacket_cache(oNextPacket.dims,oNextPacket.size,oNextPacket.type(),vcBuffer.data()+nNextBufferIdx);
-                    oNextPacket.copyTo(oNextPacket_cache);
-                    lCache.push_back(oNextPacket_cache);
+                    lPushSlot(oNextPacket,nTargetPacketIdx,nNextBufferIdx);
                     nNextBufferIdx += nNextPacketSize;
                 }
             }
             else if(nNextBufferIdx+nNextPacketSize<nFirstBufferIdx) {
-                cv::Mat oNextPacket_cache(oNextPacket.dims,oNextPacket.size,oNextPacket.type(),vcBuffer.data()+nNextBufferIdx);
-                oNextPacket.copyTo(oNextPacket_cache);
-                lCache.push_back(oNextPacket_cache);
+                lPushSlot(oNextPacket,nTargetPacketIdx,nNextBufferIdx);
                 nNextBufferIdx += nNextPacketSize;
             }
             else {// nNextBufferIdx+nNextPacketSize>=nFirstBufferIdx
@@ -449,9 +674,7 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
                 return 0;
             }
             if(lv::getVerbosity()>=5) {
-                size_t nTotCacheUsed = 0u;
-                for(cv::Mat oPacket : lCache)
-                    nTotCacheUsed += oPacket.total()*oPacket.elemSize();
+                const size_t nTotCacheUsed = lGetCacheUsage();
                 lvLog_(5,"data precacher [%" PRIxPTR "] cached packet at idx = %zu, with size = %zu kb (currently ~%zu MB, or ~%d%% full)",uintptr_t(this),nTargetPacketIdx,nNextPacketSize/1024,nTotCacheUsed/1024/1024,int(float(nTotCacheUsed)*100/nBufferSize));
             }
             else
@@ -459,73 +682,65 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
             return nNextPacketSize;
         };
         const std::chrono::time_point<std::chrono::high_resolution_clock> nPrefillTick = std::chrono::high_resolution_clock::now();
-        while(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-nPrefillTick).count()<PRECACHE_REFILL_TIMEOUT_MS) {
-            if(lCacheNextPacket(nNextPrecacheIdx)!=0u)
+        while(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-nPrefillTick).count()<PRECACHE_REFILL_TIMEOUT_MS && !m_bGotRequest) {
+            if(lCacheNextPacket(nNextPrecacheIdx,true)!=0u)
                 ++nNextPrecacheIdx;
             else
                 break;
         }
-        while(m_bIsActive) {
-            m_oReqCondVar.wait_for(sync_lock,std::chrono::milliseconds(bReachedEnd?PRECACHE_QUERY_END_TIMEOUT_MS:PRECACHE_QUERY_TIMEOUT_MS));
-            if(m_bGotRequest) {
-                if(m_nReqIdx!=nNextExpectedReqIdx-1) {
-                    lvLog_(4,"data precacher [%" PRIxPTR "] answering request for packet at idx = %zu...",uintptr_t(this),m_nReqIdx);
-                    if(!lCache.empty()) {
-                        if(m_nReqIdx<nNextPrecacheIdx && m_nReqIdx>=nNextExpectedReqIdx) {
-                            if(m_nReqIdx>nNextExpectedReqIdx)
-                                lvLog_(3,"data precacher [%" PRIxPTR "] popping %zu extra packet(s) from cache",uintptr_t(this),m_nReqIdx-nNextExpectedReqIdx);
-                            while(m_nReqIdx-nNextExpectedReqIdx+1>0) {
-                                m_oReqPacket = lCache.front();
-                                m_nAnswIdx = m_nReqIdx;
-                                nFirstBufferIdx = (size_t)(m_oReqPacket.data-vcBuffer.data());
-                                lCache.pop_front();
-                                ++nNextExpectedReqIdx;
-                            }
-                        }
-                        else {
-                            lvLog_(3,"data precacher [%" PRIxPTR "] out-of-order request (expected = %zu), destroying cache",uintptr_t(this),nNextExpectedReqIdx);
-                            lCache = std::list<cv::Mat>();
-                            m_oReqPacket = m_lCallback(m_nReqIdx);
-                            m_nAnswIdx = m_nReqIdx;
-                            nFirstBufferIdx = nNextBufferIdx = size_t(-1);
-                            nNextExpectedReqIdx = nNextPrecacheIdx = m_nReqIdx+1;
-                            bReachedEnd = false;
-                        }
+        // requests (or freed slots) posted while the lock was released to wait on decode workers must be seen without sleeping until the timeout
+        const auto lHasPendingRequest = [&](){return m_bGotRequest && m_nAnswIdx!=m_nReqIdx;};
+        size_t nSeenReadyTail = m_nReadyTail.load(std::memory_order_acquire);
+        while(m_bIsActive && !m_pWorkerException) {
+            m_oReqCondVar.wait_for(sync_lock,std::chrono::milliseconds(bReachedEnd?PRECACHE_QUERY_END_TIMEOUT_MS:PRECACHE_QUERY_TIMEOUT_MS),[&](){
+                return !m_bIsActive || lHasPendingRequest() || (!bReachedEnd && m_nReadyTail.load(std::memory_order_acquire)!=nSeenReadyTail);
+            });
+            nSeenReadyTail = m_nReadyTail.load(std::memory_order_acquire);
+            if(lHasPendingRequest()) {
+                // the consumer is blocked until answered, so the ready queue can be consumed on its behalf here
+                lvLog_(4,"data precacher [%" PRIxPTR "] answering request for packet at idx = %zu...",uintptr_t(this),m_nReqIdx);
+                m_pReqView = lPopRequestedSlot(m_nReqIdx);
+                if(!m_pReqView) {
+                    if(m_nReqIdx<nNextPrecacheIdx) {
+                        lvLog_(3,"data precacher [%" PRIxPTR "] out-of-order request (expected >= %zu), destroying cache",uintptr_t(this),nNextPrecacheIdx);
+                        bReachedEnd = false;
                     }
-                    else {
+                    else
                         lvLog_(3,"data precacher [%" PRIxPTR "] answering request manually, precaching is falling behind",uintptr_t(this));
-                        m_oReqPacket = m_lCallback(m_nReqIdx);
-                        m_nAnswIdx = m_nReqIdx;
-                        nFirstBufferIdx = nNextBufferIdx = size_t(-1);
-                        nNextExpectedReqIdx = nNextPrecacheIdx = m_nReqIdx+1;
-                    }
+                    m_pReqView = std::make_shared<const cv::Mat>(lLoadRequestedPacket(m_nReqIdx));
+                    nNextPrecacheIdx = m_nReqIdx+1;
                 }
-                else
-                    lvLog_(3,"data precacher [%" PRIxPTR "] answering request using last packet at idx = %zu",uintptr_t(this),m_nReqIdx);
+                m_nAnswIdx = m_nReqIdx;
                 m_oSyncCondVar.notify_one();
             }
             else if(!bReachedEnd) {
-                size_t nTotCacheUsed = 0u;
-                for(cv::Mat oPacket : lCache)
-                    nTotCacheUsed += oPacket.total()*oPacket.elemSize();
+                lReclaimSlots();
+                const size_t nTotCacheUsed = lGetCacheUsage();
                 if(nTotCacheUsed<nBufferSize/4) {
                     lvLog_(3,"data precacher [%" PRIxPTR "] force filling buffer until timeout... (currently ~%zu MB, or ~%d%% full)",uintptr_t(this),nTotCacheUsed/1024/1024,int(float(nTotCacheUsed)*100/nBufferSize));
                     size_t nFillCount = 0;
                     const std::chrono::time_point<std::chrono::high_resolution_clock> nRefillTick = std::chrono::high_resolution_clock::now();
-                    while(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-nRefillTick).count()<PRECACHE_REFILL_TIMEOUT_MS && nFillCount++<10) {
-                        if(lCacheNextPacket(nNextPrecacheIdx)!=0u)
+                    while(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()-nRefillTick).count()<PRECACHE_REFILL_TIMEOUT_MS && nFillCount++<10 && !m_bGotRequest) {
+                        if(lCacheNextPacket(nNextPrecacheIdx,true)!=0u)
                             ++nNextPrecacheIdx;
                         else
                             break;
                     }
                 }
-                else if(lCacheNextPacket(nNextPrecacheIdx)!=0u)
-                    ++nNextPrecacheIdx;
+                else {
+                    // w/ decode workers, all packets decoded in order since the last wake-up are committed at once
+                    size_t nCommitCount = 0;
+                    while(nCommitCount++<m_nDecodeWorkers && lCacheNextPacket(nNextPrecacheIdx,false)!=0u)
+                        ++nNextPrecacheIdx;
+                }
             }
         }
     }
     catch(...) {
-        m_pWorkerException = std::current_exception();
+        if(!sync_lock.owns_lock())
+            sync_lock.lock();
+        if(!m_pWorkerException)
+            m_pWorkerException = std::current_exception();
     }
 }
 
@@ -533,15 +748,20 @@ void lv::DataPrecacher::entry(const size_t nBufferSize) {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void lv::IIDataLoader::startPrecaching(bool bPrecacheInputOnly, size_t nSuggestedBufferSize) {
+void lv::IIDataLoader::startPrecaching(bool bPrecacheInputOnly, size_t nSuggestedBufferSize, size_t nDecodeWorkers) {
     lvDbgExceptionWatch;
     if(nSuggestedBufferSize==SIZE_MAX)
         nSuggestedBufferSize = getExpectedLoadSize();
+    const bool bPackedLoad = m_pDataPack && (bPrecacheInputOnly || m_pDataPack->getGTCount()>0);
+    if(nDecodeWorkers!=1 && !bPackedLoad && !isPacketLoadReentrant()) {
+        lvLog_(2,"data loader [%" PRIxPTR "] for batch '%s' cannot load packets concurrently, will precache w/ a single decode worker",uintptr_t(this),getName().c_str());
+        nDecodeWorkers = 1;
+    }
     lvLog_(3,"data loader [%" PRIxPTR "] for batch '%s' will start precaching w/ buffer size = %zu mb\n\tnote: precacher ids = %" PRIxPTR ", %" PRIxPTR ", %" PRIxPTR,uintptr_t(this),getName().c_str(),(nSuggestedBufferSize/1024)/1024,uintptr_t(&m_oInputPrecacher),uintptr_t(&m_oGTPrecacher),uintptr_t(&m_oFeaturesPrecacher));
-    lvAssert_(m_oInputPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching input packets");
+    lvAssert_(m_oInputPrecacher.startAsyncPrecaching(nSuggestedBufferSize,nDecodeWorkers),"could not start precaching input packets");
     if(!bPrecacheInputOnly) {
-        lvAssert_(m_oGTPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching gt packets");
-        lvAssert_(m_oFeaturesPrecacher.startAsyncPrecaching(nSuggestedBufferSize),"could not start precaching feature packets");
+        lvAssert_(m_oGTPrecacher.startAsyncPrecaching(nSuggestedBufferSize,nDecodeWorkers),"could not start precaching gt packets");
+        lvAssert_(m_oFeaturesPrecacher.startAsyncPrecaching(nSuggestedBufferSize,nDecodeWorkers),"could not start precaching feature packets");
     }
 }
 
@@ -561,6 +781,16 @@ const cv::Mat& lv::IIDataLoader::getGT(size_t nPacketIdx) {
     return m_oGTPrecacher.getPacket(nPacketIdx);
 }
 
+std::shared_ptr<const cv::Mat> lv::IIDataLoader::getInputView(size_t nPacketIdx) {
+    lvDbgExceptionWatch;
+    return m_oInputPrecacher.getPacketView(nPacketIdx);
+}
+
+std::shared_ptr<const cv::Mat> lv::IIDataLoader::getGTView(size_t nPacketIdx) {
+    lvDbgExceptionWatch;
+    return m_oGTPrecacher.getPacketView(nPacketIdx);
+}
+
 const cv::Mat& lv::IIDataLoader::loadFeatures(size_t nPacketIdx) {
     lvDbgExceptionWatch;
     return m_oFeaturesPrecacher.getPacket(nPacketIdx);
@@ -588,9 +818,58 @@ bool lv::IIDataLoader::isPrecaching() const {
     return m_oInputPrecacher.isActive();
 }
 
+bool lv::IIDataLoader::isPacketLoadReentrant() const {
+    return false;
+}
+
+void lv::IIDataLoader::setDataPack(std::shared_ptr<const DataPack> pDataPack) {
+    lvDbgExceptionWatch;
+    lvAssert_(!isPrecaching(),"cannot swap data packs while precaching");
+    if(pDataPack) {
+        lvAssert__(pDataPack->getInputCount()==getInputCount(),"data pack input packet count mismatch for batch '%s' (%d vs %d)",getName().c_str(),(int)pDataPack->getInputCount(),(int)getInputCount());
+        lvAssert__(pDataPack->getGTCount()==0 || pDataPack->getGTCount()==getInputCount(),"data pack gt packet count mismatch for batch '%s'",getName().c_str());
+        lvAssert__(pDataPack->getScaleFactor()==getScaleFactor(),"data pack scale factor mismatch for batch '%s' (%f vs %f)",getName().c_str(),pDataPack->getScaleFactor(),getScaleFactor());
+        // packed packets must match what this batch would load itself (e.g. packs written by grayscale-forced or resized dataset variants are rejected)
+        auto pArrayLoader = dynamic_cast<IDataLoader_<Array>*>(this);
+        const auto lGetByteSize = [](const lv::MatInfo& oInfo) {return oInfo.size.empty()?size_t(0):oInfo.size.total()*oInfo.type.elemSize();};
+        const auto lIsPacketMatching = [&](const lv::MatInfo& oPackedInfo, size_t nPacketIdx, bool bGT) {
+            if(!pArrayLoader) {
+                const lv::MatInfo oExpectedInfo = bGT?getGTInfo(nPacketIdx):getInputInfo(nPacketIdx);
+                return (oPackedInfo.size.empty() && oExpectedInfo.size.empty()) || oPackedInfo==oExpectedInfo;
+            }
+            // array packets are packed into a single mat, so only their total byte size can be compared
+            size_t nExpectedByteSize = 0;
+            for(const lv::MatInfo& oStreamInfo : (bGT?pArrayLoader->getGTInfoArray(nPacketIdx):pArrayLoader->getInputInfoArray(nPacketIdx)))
+                nExpectedByteSize += lGetByteSize(oStreamInfo);
+            return lGetByteSize(oPackedInfo)==nExpectedByteSize;
+        };
+        for(size_t nPacketIdx=0; nPacketIdx<pDataPack->getInputCount(); ++nPacketIdx)
+            lvAssert__(lIsPacketMatching(pDataPack->getInputInfo(nPacketIdx),nPacketIdx,false),"data pack input packet #%d format mismatch for batch '%s' (%s in pack)",(int)nPacketIdx,getName().c_str(),pDataPack->getInputInfo(nPacketIdx).str().c_str());
+        for(size_t nPacketIdx=0; nPacketIdx<pDataPack->getGTCount(); ++nPacketIdx)
+            lvAssert__(lIsPacketMatching(pDataPack->getGTInfo(nPacketIdx),nPacketIdx,true),"data pack gt packet #%d format mismatch for batch '%s' (%s in pack)",(int)nPacketIdx,getName().c_str(),pDataPack->getGTInfo(nPacketIdx).str().c_str());
+        lvLog_(2,"data loader [%" PRIxPTR "] for batch '%s' will read packets from data pack at '%s'",uintptr_t(this),getName().c_str(),pDataPack->getFilePath().c_str());
+    }
+    m_pDataPack = std::move(pDataPack);
+    // the last packets held by the precachers were loaded from the previous source
+    m_oInputPrecacher.resetLastPacket();
+    m_oGTPrecacher.resetLastPacket();
+}
+
+cv::Mat lv::IIDataLoader::getInput_load(size_t nPacketIdx) {
+    if(m_pDataPack)
+        return m_pDataPack->getInput(nPacketIdx);
+    return getInput_redirect(nPacketIdx);
+}
+
+cv::Mat lv::IIDataLoader::getGT_load(size_t nPacketIdx) {
+    if(m_pDataPack && m_pDataPack->getGTCount()>0)
+        return m_pDataPack->getGT(nPacketIdx);
+    return getGT_redirect(nPacketIdx);
+}
+
 lv::IIDataLoader::IIDataLoader(PacketPolicy eInputType, PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType) :
-        m_oInputPrecacher(std::bind(&IIDataLoader::getInput_redirect,this,std::placeholders::_1)),
-        m_oGTPrecacher(std::bind(&IIDataLoader::getGT_redirect,this,std::placeholders::_1)),
+        m_oInputPrecacher(std::bind(&IIDataLoader::getInput_load,this,std::placeholders::_1)),
+        m_oGTPrecacher(std::bind(&IIDataLoader::getGT_load,this,std::placeholders::_1)),
         m_oFeaturesPrecacher(std::bind(&IIDataLoader::loadRawFeatures,this,std::placeholders::_1)),
         m_eInputType(eInputType),m_eGTType(eGTType),m_eOutputType(eOutputType),m_eGTMappingType(eGTMappingType),m_eIOMappingType(eIOMappingType) {}
 
@@ -838,6 +1117,10 @@ size_t lv::IDataProducer_<lv::DatasetSource_Video>::getGTCount() const {
     return m_mGTIndexLUT.size();
 }
 
+bool lv::IDataProducer_<lv::DatasetSource_Video>::isPacketLoadReentrant() const {
+    return !m_voVideoReader.isOpened();
+}
+
 size_t lv::IDataProducer_<lv::DatasetSource_Video>::getExpectedLoadSize() const {
     const cv::Mat& oROI = getFrameROI();
     const lv::MatInfo& oMatInfo = getInputInfo();
@@ -915,7 +1198,7 @@ cv::Mat lv::IDataProducer_<lv::DatasetSource_Video>::getRawGT(size_t nPacketIdx)
     lvDbgExceptionWatch;
     lvAssert_(getGTPacketType()==ImagePacket,"default impl only works for image gt packets");
     if(m_mGTIndexLUT.count(nPacketIdx)) {
-        const size_t nGTIdx = m_mGTIndexLUT[nPacketIdx];
+        const size_t nGTIdx = m_mGTIndexLUT.at(nPacketIdx);
         if(nGTIdx<m_vsGTPaths.size())
             return cv::imread(m_vsGTPaths[nGTIdx],cv::IMREAD_UNCHANGED);
     }
@@ -1145,6 +1428,10 @@ std::string lv::IDataProducer_<lv::DatasetSource_Image>::getInputName(size_t nPa
     return sFileName.substr(0,sFileName.find_last_of("."));
 }
 
+bool lv::IDataProducer_<lv::DatasetSource_Image>::isPacketLoadReentrant() const {
+    return true;
+}
+
 lv::IDataProducer_<lv::DatasetSource_Image>::IDataProducer_(PacketPolicy eGTType, PacketPolicy eOutputType, MappingPolicy eGTMappingType, MappingPolicy eIOMappingType) :
         IDataLoader_<NotArray>(ImagePacket,eGTType,eOutputType,eGTMappingType,eIOMappingType) {}
 
@@ -1159,7 +1446,7 @@ cv::Mat lv::IDataProducer_<lv::DatasetSource_Image>::getRawGT(size_t nPacketIdx)
     lvDbgExceptionWatch;
     lvAssert_(getGTPacketType()==ImagePacket,"default impl only works for image gt packets");
     if(m_mGTIndexLUT.count(nPacketIdx)) {
-        const size_t nGTIdx = m_mGTIndexLUT[nPacketIdx];
+        const size_t nGTIdx = m_mGTIndexLUT.at(nPacketIdx);
         if(nGTIdx<m_vsGTPaths.size())
             return cv::imread(m_vsGTPaths[nGTIdx],cv::IMREAD_UNCHANGED);
     }
@@ -1321,13 +1608,86 @@ void lv::IDataCounter::resetOutputCount() {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+    /// stream buffer which appends all written data to a packet buffer (used to write mat archives without copies)
+    struct PacketOutputStreamBuf : std::streambuf {
+        PacketOutputStreamBuf(std::vector<uchar>& vBuffer) : m_vBuffer(vBuffer) {}
+    protected:
+        int_type overflow(int_type nChar) override {
+            if(!traits_type::eq_int_type(nChar,traits_type::eof()))
+                m_vBuffer.push_back(uchar(nChar));
+            return traits_type::not_eof(nChar);
+        }
+        std::streamsize xsputn(const char* pData, std::streamsize nSize) override {
+            m_vBuffer.insert(m_vBuffer.end(),(const uchar*)pData,(const uchar*)pData+nSize);
+            return nSize;
+        }
+    private:
+        std::vector<uchar>& m_vBuffer;
+    };
+
+    /// stream buffer which reads directly from a packet buffer (used to read mat archives without copies)
+    struct PacketInputStreamBuf : std::streambuf {
+        PacketInputStreamBuf(const std::vector<uchar>& vBuffer) {
+            char* pBegin = (char*)vBuffer.data();
+            setg(pBegin,pBegin,pBegin+vBuffer.size());
+        }
+    };
+
+    /// returns the mat archive type used to store packets with the given built-in (binary) encoder
+    lv::MatArchiveList getPacketArchiveType(lv::DataEncoderList eEncoder) {
+        switch(eEncoder) {
+            case lv::DataEncoder_Raw: return lv::MatArchive_BINARY;
+            case lv::DataEncoder_BitPacked: return lv::MatArchive_BINARY_BITPACKED;
+        #if USING_LZ4
+            case lv::DataEncoder_LZ4: return lv::MatArchive_BINARY_LZ4;
+        #else //!USING_LZ4
+            case lv::DataEncoder_LZ4: lvError("framework was built without lz4 support");
+        #endif //!USING_LZ4
+            default: lvError_("unknown data encoder type (%d)",(int)eEncoder);
+        }
+    }
+
+} // anonymous namespace
+
 lv::DataWriter::DataWriter(std::function<size_t(const cv::Mat&,size_t)> lDataArchiverCallback) :
-        m_lCallback(lDataArchiverCallback) {
+        m_lCallback(lDataArchiverCallback),
+        // the callback does the actual writing itself, so it can run as an unordered 'encoder' with nothing left to commit
+        m_lEncoder([this](const cv::Mat& oPacket, size_t nIdx, std::vector<uchar>&) {m_lCallback(oPacket,nIdx);}) {
     lvAssert_(m_lCallback,"invalid data writer callback");
+    m_bCommitting = false;
+    m_bIsActive = false;
+    m_bAllowPacketDrop = false;
+    m_nQueueSize = 0;
+    m_nQueueCount = 0;
+    m_nStatsQueuedPackets = m_nStatsDroppedPackets = m_nStatsBlockedPackets = m_nStatsBlockedTime_usec = 0;
+    m_nStatsPeakQueueSize = m_nStatsCommittedPackets = m_nStatsEncodedBytes = 0;
+}
+
+lv::DataWriter::DataWriter(EncoderFunc lEncoder, CommitFunc lCommit) :
+        m_lEncoder(lEncoder),m_lCommit(lCommit) {
+    lvAssert_(m_lEncoder && m_lCommit,"invalid data writer encoder/commit callbacks");
+    m_bCommitting = false;
     m_bIsActive = false;
     m_bAllowPacketDrop = false;
     m_nQueueSize = 0;
     m_nQueueCount = 0;
+    m_nStatsQueuedPackets = m_nStatsDroppedPackets = m_nStatsBlockedPackets = m_nStatsBlockedTime_usec = 0;
+    m_nStatsPeakQueueSize = m_nStatsCommittedPackets = m_nStatsEncodedBytes = 0;
+}
+
+lv::DataWriter::DataWriter(DataEncoderList eEncoder, std::function<std::string(size_t)> lFilePathCallback) :
+        DataWriter([eEncoder](const cv::Mat& oPacket, size_t /*nIdx*/, std::vector<uchar>& vBuffer) {
+            encode(oPacket,vBuffer,eEncoder);
+        },[lFilePathCallback](const std::vector<uchar>& vBuffer, size_t nIdx) {
+            const std::string sFilePath = lFilePathCallback(nIdx);
+            std::ofstream ssFile(sFilePath,std::ios::binary);
+            lvAssert__(ssFile.is_open(),"could not open '%s' for writing",sFilePath.c_str());
+            ssFile.write((const char*)vBuffer.data(),std::streamsize(vBuffer.size()));
+            lvAssert__(ssFile,"could not write encoded packet to '%s'",sFilePath.c_str());
+        }) {
+    lvAssert_(lFilePathCallback,"invalid data writer file path callback");
 }
 
 lv::DataWriter::~DataWriter() {
@@ -1344,44 +1704,63 @@ bool lv::DataWriter::queue_check(const cv::Mat& oPacket, size_t nIdx) {
         return true; // since this config blocks, packet will never be dropped
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
     const auto pOldPacketIter = m_mQueue.find(nIdx);
-    const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-    const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
+    if(pOldPacketIter!=m_mQueue.end() && pOldPacketIter->second.eState!=PacketState_Pending)
+        return false; // previous packet with the same index is already being written
+    const size_t nOldPacketSize = (pOldPacketIter==m_mQueue.end())?0u:pOldPacketIter->second.nSize;
     return (m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize);
 }
 
 size_t lv::DataWriter::queue(const cv::Mat& oPacket, size_t nIdx) {
     lvDbgExceptionWatch;
-    if(!m_bIsActive)
-        return m_lCallback(oPacket,nIdx);
+    if(!m_bIsActive) {
+        if(m_lCallback)
+            return m_lCallback(oPacket,nIdx);
+        std::vector<uchar> vBuffer;
+        m_lEncoder(oPacket,nIdx,vBuffer);
+        m_lCommit(vBuffer,nIdx);
+        m_nStatsEncodedBytes += vBuffer.size();
+        ++m_nStatsCommittedPackets;
+        return 0u;
+    }
     const size_t nPacketSize = oPacket.total()*oPacket.elemSize();
     lvAssert__(nPacketSize<=m_nQueueMaxSize,"packet too large for queue, max cache size must be increased (got %d, max is %d)",(int)nPacketSize,(int)m_nQueueMaxSize);
+    lvLog_(4,"data writer [%" PRIxPTR "] received packet at idx = %zu...",uintptr_t(this),nIdx);
+    const cv::Mat oPacketCopy = oPacket.clone(); // local copy passed to writing threads (made outside the lock); provider can recycle memory following this call
     size_t nPacketPosition;
     {
-        lvLog_(4,"data writer [%" PRIxPTR "] received packet at idx = %zu...",uintptr_t(this),nIdx);
         lv::mutex_unique_lock sync_lock(m_oSyncMutex);
-        if(!m_bAllowPacketDrop) {
-            m_oClearCondVar.wait(sync_lock,[&]{
-                const auto pOldPacketIter = m_mQueue.find(nIdx);
-                const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-                const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
-                lvDbgAssert(m_nQueueSize>=nOldPacketSize);
-                return m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize;
-            });
+        const auto lCanQueue = [&]{
+            const auto pOldPacketIter = m_mQueue.find(nIdx);
+            if(pOldPacketIter!=m_mQueue.end() && pOldPacketIter->second.eState!=PacketState_Pending)
+                return false; // previous packet with the same index is already being written
+            const size_t nOldPacketSize = (pOldPacketIter==m_mQueue.end())?0u:pOldPacketIter->second.nSize;
+            lvDbgAssert(m_nQueueSize>=nOldPacketSize);
+            return m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize;
+        };
+        if(!m_bAllowPacketDrop && !lCanQueue()) {
+            ++m_nStatsBlockedPackets;
+            lv::StopWatch oBlockedStopWatch;
+            m_oClearCondVar.wait(sync_lock,lCanQueue);
+            m_nStatsBlockedTime_usec += size_t(oBlockedStopWatch.elapsed()*1e6);
         }
-        const auto pOldPacketIter = m_mQueue.find(nIdx);
-        const bool bIsNewPacket = pOldPacketIter==m_mQueue.end();
-        const size_t nOldPacketSize = bIsNewPacket?0u:(pOldPacketIter->second.total()*pOldPacketIter->second.elemSize());
-        if(m_nQueueSize+nPacketSize-nOldPacketSize<=m_nQueueMaxSize) {
-            m_mQueue[nIdx] = oPacket.clone(); // local copy passed to writing thread; provider can recycle memory following this call
-            m_nQueueSize = m_nQueueSize+nPacketSize-nOldPacketSize;
-            // @@@ could cut a find operation here using C++17's map::insert_or_assign above
-            nPacketPosition = std::distance(m_mQueue.begin(),m_mQueue.find(nIdx));
-            if(bIsNewPacket)
+        if(lCanQueue()) {
+            auto pPacketIter = m_mQueue.find(nIdx);
+            if(pPacketIter==m_mQueue.end()) {
+                pPacketIter = m_mQueue.emplace(nIdx,QueuedPacket{cv::Mat(),std::vector<uchar>(),0u,PacketState_Pending}).first;
+                m_snPendingIdxs.insert(nIdx);
                 ++m_nQueueCount;
+            }
+            m_nQueueSize = m_nQueueSize+nPacketSize-pPacketIter->second.nSize;
+            pPacketIter->second.oPacket = oPacketCopy;
+            pPacketIter->second.nSize = nPacketSize;
+            m_nStatsPeakQueueSize = std::max(m_nStatsPeakQueueSize.load(),m_nQueueSize.load());
+            ++m_nStatsQueuedPackets;
+            nPacketPosition = std::distance(m_mQueue.begin(),pPacketIter);
             m_oQueueCondVar.notify_one();
         }
         else {
             lvLog_(3,"data writer [%" PRIxPTR "] dropping packet at idx = %zu (reached max queue size)",uintptr_t(this),nIdx);
+            ++m_nStatsDroppedPackets;
             nPacketPosition = SIZE_MAX; // packet dropped
         }
     }
@@ -1390,16 +1769,34 @@ size_t lv::DataWriter::queue(const cv::Mat& oPacket, size_t nIdx) {
     return nPacketPosition;
 }
 
+lv::DataWriter::Stats lv::DataWriter::getStats() const {
+    Stats oStats;
+    oStats.nQueuedPackets = m_nStatsQueuedPackets;
+    oStats.nDroppedPackets = m_nStatsDroppedPackets;
+    oStats.nBlockedPackets = m_nStatsBlockedPackets;
+    oStats.dBlockedTime = double(m_nStatsBlockedTime_usec)/1e6;
+    oStats.nPeakQueueSize = m_nStatsPeakQueueSize;
+    oStats.nCommittedPackets = m_nStatsCommittedPackets;
+    oStats.nEncodedBytes = m_nStatsEncodedBytes;
+    return oStats;
+}
+
 bool lv::DataWriter::startAsyncWriting(size_t nSuggestedQueueSize, bool bDropPacketsIfFull, size_t nWorkers) {
     stopAsyncWriting();
     if(nSuggestedQueueSize>0) {
         m_bIsActive = true;
         m_bAllowPacketDrop = bDropPacketsIfFull;
+        m_bCommitting = false;
         m_nQueueMaxSize = std::max(std::min(nSuggestedQueueSize,CACHE_MAX_SIZE),CACHE_MIN_SIZE);
         m_nQueueSize = 0;
         m_nQueueCount = 0;
+        m_nStatsQueuedPackets = m_nStatsDroppedPackets = m_nStatsBlockedPackets = m_nStatsBlockedTime_usec = 0;
+        m_nStatsPeakQueueSize = m_nStatsCommittedPackets = m_nStatsEncodedBytes = 0;
         m_mQueue.clear();
+        m_snPendingIdxs.clear();
         m_vhWorkers.clear();
+        if(nWorkers==0)
+            nWorkers = std::max(size_t(std::thread::hardware_concurrency()),size_t(1));
         lvLog_(2,"data writer [%" PRIxPTR "] writing thread init (%zu) w/ queue size = %zu mb",uintptr_t(this),nWorkers,(m_nQueueMaxSize/1024)/1024);
         for(size_t n=0; n<nWorkers; ++n)
             m_vhWorkers.emplace_back(std::bind(&DataWriter::entry,this));
@@ -1418,6 +1815,7 @@ void lv::DataWriter::stopAsyncWriting() {
         }
         for(std::thread& oWorker : m_vhWorkers)
             oWorker.join();
+        m_vhWorkers.clear();
     }
     while(!m_vWorkerExceptions.empty()) {
         std::exception_ptr pLatestException = m_vWorkerExceptions.top().first; // add packet idx to exception...? somewhow?
@@ -1429,102 +1827,231 @@ void lv::DataWriter::stopAsyncWriting() {
 void lv::DataWriter::entry() {
     lvDbgExceptionWatch;
     lv::mutex_unique_lock sync_lock(m_oSyncMutex);
+    // only one worker commits at a time, and only the lowest queued index, once it is encoded
+    const auto lCanCommit = [&]{return !m_bCommitting && !m_mQueue.empty() && m_mQueue.begin()->second.eState==PacketState_Encoded;};
+    const auto lErasePacket = [&](std::map<size_t,QueuedPacket>::iterator pPacketIter) {
+        lvDbgAssert(m_nQueueSize>=pPacketIter->second.nSize && m_nQueueCount>0);
+        m_nQueueSize -= pPacketIter->second.nSize;
+        m_mQueue.erase(pPacketIter);
+        --m_nQueueCount;
+        m_oClearCondVar.notify_all();
+        if(m_nQueueCount==0)
+            m_oQueueCondVar.notify_all(); // lets idle workers exit once the queue is drained
+    };
     while(m_bIsActive || m_nQueueCount>0) {
-        m_oQueueCondVar.wait(sync_lock,[&](){return !m_bIsActive || m_nQueueCount>0;});
-        if(m_nQueueCount>0) {
-            auto pCurrPacket = m_mQueue.begin();
-            if(pCurrPacket!=m_mQueue.end()) {
-                const size_t nPacketSize = pCurrPacket->second.total()*pCurrPacket->second.elemSize();
-                if(nPacketSize<=m_nQueueSize) {
-                    try {
-                        lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
-                        lvLog_(4,"data writer [%" PRIxPTR "] writing packet at idx = %zu, with size = %zu kb",uintptr_t(this),pCurrPacket->first,nPacketSize/1024);
-                        m_lCallback(pCurrPacket->second,pCurrPacket->first);
-                    }
-                    catch(...) {
-                        m_vWorkerExceptions.push(std::make_pair(std::current_exception(),pCurrPacket->first));
-                    }
-                    m_nQueueSize -= nPacketSize;
-                    m_mQueue.erase(pCurrPacket);
-                    --m_nQueueCount;
-                    m_oClearCondVar.notify_all();
-                }
+        m_oQueueCondVar.wait(sync_lock,[&](){return (!m_bIsActive && m_nQueueCount==0) || !m_snPendingIdxs.empty() || lCanCommit();});
+        if(lCanCommit()) {
+            const auto pCurrPacket = m_mQueue.begin();
+            m_bCommitting = true;
+            try {
+                lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
+                lvLog_(4,"data writer [%" PRIxPTR "] committing packet at idx = %zu, with encoded size = %zu kb",uintptr_t(this),pCurrPacket->first,pCurrPacket->second.vBuffer.size()/1024);
+                m_lCommit(pCurrPacket->second.vBuffer,pCurrPacket->first);
+                ++m_nStatsCommittedPackets;
+            }
+            catch(...) {
+                m_vWorkerExceptions.push(std::make_pair(std::current_exception(),pCurrPacket->first));
+            }
+            m_bCommitting = false;
+            lErasePacket(pCurrPacket);
+        }
+        else if(!m_snPendingIdxs.empty()) {
+            // queue only inserts and commits only erase the first encoded packet, so this iterator stays valid while unlocked
+            const auto pCurrPacket = m_mQueue.find(*m_snPendingIdxs.begin());
+            m_snPendingIdxs.erase(m_snPendingIdxs.begin());
+            lvDbgAssert(pCurrPacket!=m_mQueue.end() && pCurrPacket->second.eState==PacketState_Pending);
+            pCurrPacket->second.eState = PacketState_Encoding;
+            const cv::Mat oPacket = pCurrPacket->second.oPacket;
+            std::vector<uchar> vBuffer;
+            bool bEncoded = false;
+            try {
+                lv::unlock_guard<lv::mutex_unique_lock> oUnlock(sync_lock);
+                lvLog_(4,"data writer [%" PRIxPTR "] encoding packet at idx = %zu, with size = %zu kb",uintptr_t(this),pCurrPacket->first,pCurrPacket->second.nSize/1024);
+                m_lEncoder(oPacket,pCurrPacket->first,vBuffer);
+                bEncoded = true;
+            }
+            catch(...) {
+                m_vWorkerExceptions.push(std::make_pair(std::current_exception(),pCurrPacket->first));
+            }
+            if(bEncoded && m_lCommit) {
+                // packet stays accounted for in the queue size until committed, so encoded buffers are bounded as well
+                m_nStatsEncodedBytes += vBuffer.size();
+                pCurrPacket->second.vBuffer = std::move(vBuffer);
+                pCurrPacket->second.oPacket.release();
+                pCurrPacket->second.eState = PacketState_Encoded;
+            }
+            else {
+                if(bEncoded)
+                    ++m_nStatsCommittedPackets; // callback-only writer: the packet was written by the 'encoder' itself
+                lErasePacket(pCurrPacket);
             }
         }
     }
 }
 
+void lv::DataWriter::encode(const cv::Mat& oPacket, std::vector<uchar>& vBuffer, DataEncoderList eEncoder) {
+    lvDbgExceptionWatch;
+    vBuffer.clear();
+    if(eEncoder==DataEncoder_PNG || eEncoder==DataEncoder_PNG_Max) {
+        const std::vector<int> vnComprParams = {cv::IMWRITE_PNG_COMPRESSION,eEncoder==DataEncoder_PNG?DATAWRITER_PNG_COMPRESSION:9};
+        lvAssert_(cv::imencode(".png",oPacket,vBuffer,vnComprParams),"png packet encoding failed");
+        return;
+    }
+    const lv::MatArchiveList eArchiveType = getPacketArchiveType(eEncoder);
+    if(oPacket.empty())
+        return; // empty packets are stored as empty buffers (mat archives cannot hold them)
+    PacketOutputStreamBuf oStreamBuf(vBuffer);
+    std::ostream ssStr(&oStreamBuf);
+    lv::write(ssStr,oPacket,eArchiveType);
+}
+
+cv::Mat lv::DataWriter::decode(const std::vector<uchar>& vBuffer, DataEncoderList eEncoder) {
+    lvDbgExceptionWatch;
+    if(eEncoder==DataEncoder_PNG || eEncoder==DataEncoder_PNG_Max)
+        return cv::imdecode(vBuffer,cv::IMREAD_UNCHANGED);
+    const lv::MatArchiveList eArchiveType = getPacketArchiveType(eEncoder);
+    if(vBuffer.empty())
+        return cv::Mat();
+    PacketInputStreamBuf oStreamBuf(vBuffer);
+    std::istream ssStr(&oStreamBuf);
+    cv::Mat oPacket;
+    lv::read(ssStr,oPacket,eArchiveType);
+    lvAssert_(ssStr.peek()==std::char_traits<char>::eof(),"encoded packet data size mismatch");
+    return oPacket;
+}
+
+cv::Mat lv::DataWriter::read(const std::string& sFilePath, DataEncoderList eEncoder) {
+    lvDbgExceptionWatch;
+    std::ifstream ssFile(sFilePath,std::ios::binary|std::ios::ate);
+    lvAssert__(ssFile.is_open(),"could not open '%s' for reading",sFilePath.c_str());
+    std::vector<uchar> vBuffer(size_t(ssFile.tellg()));
+    ssFile.seekg(0);
+    ssFile.read((char*)vBuffer.data(),std::streamsize(vBuffer.size()));
+    lvAssert__(ssFile,"could not read encoded packet from '%s'",sFilePath.c_str());
+    return decode(vBuffer,eEncoder);
+}
+
+const char* lv::DataWriter::getFileExt(DataEncoderList eEncoder) {
+    switch(eEncoder) {
+        case DataEncoder_Raw: return ".bin";
+        case DataEncoder_LZ4: return ".lz4";
+        case DataEncoder_BitPacked: return ".bits";
+        case DataEncoder_PNG: return ".png";
+        case DataEncoder_PNG_Max: return ".png";
+        default: lvError_("unknown data encoder type (%d)",(int)eEncoder);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-cv::Mat lv::IDataArchiver_<lv::NotArray>::loadOutput(size_t nIdx, int nFlags) {
+namespace {
+
+    /// returns the output image to archive, with zones outside ROI grayed-out if it is a binary mask with 1:1 mapping to GT images (e.g. segmentation)
+    cv::Mat getArchivedImageOutput(const lv::IIDataLoader& oLoader, const cv::Mat& oOutput, size_t nIdx, bool bImageGT) {
+        if(bImageGT && oLoader.getGTMappingType()==lv::ElemMapping &&
+           oOutput.type()==CV_8UC1 && (cv::countNonZero(oOutput==UCHAR_MAX)+cv::countNonZero(oOutput==0))==oOutput.size().area()) {
+            const cv::Mat& oROI = oLoader.getGTROI(nIdx);
+            if(!oROI.empty() && oROI.size()==oOutput.size()) {
+                cv::Mat oMaskedOutput = oOutput.clone();
+                cv::bitwise_or(oMaskedOutput,UCHAR_MAX/2,oMaskedOutput,oROI==0);
+                cv::bitwise_and(oMaskedOutput,UCHAR_MAX/2,oMaskedOutput,oROI==0);
+                return oMaskedOutput;
+            }
+        }
+        return oOutput;
+    }
+
+} // anonymous namespace
+
+lv::IIDataArchiver::IIDataArchiver() :
+        m_nOutputEncoder(-1),m_nAsyncOutputQueueSize(0),m_nAsyncOutputWorkers(1) {}
+
+void lv::IIDataArchiver::setOutputEncoder(DataEncoderList eEncoder, size_t nAsyncQueueSize, size_t nAsyncWorkers) {
     lvDbgExceptionWatch;
+    flushOutput(); // packets already queued are written with the previous encoder
+    lv::mutex_lock_guard oLock(m_oOutputWriterMutex);
+    m_nOutputEncoder = int(eEncoder);
+    m_nAsyncOutputQueueSize = nAsyncQueueSize;
+    m_nAsyncOutputWorkers = nAsyncWorkers;
+    m_pOutputWriter = nullptr;
+}
+
+lv::DataEncoderList lv::IIDataArchiver::getOutputEncoder() const {
+    if(m_nOutputEncoder>=0)
+        return DataEncoderList(m_nOutputEncoder);
     const auto pLoader = shared_from_this_cast<const IIDataLoader>(true);
-    std::stringstream sOutputFilePath;
-    sOutputFilePath << getOutputPath() << getOutputName(nIdx);
-    if(pLoader->getOutputPacketType()==ImagePacket) {
-        sOutputFilePath << ".png";
-        if(nFlags==-1)
-            return cv::imread(sOutputFilePath.str(),cv::IMREAD_UNCHANGED);
-        else
-            return cv::imread(sOutputFilePath.str(),nFlags);
+    const PacketPolicy eOutputType = pLoader->getOutputPacketType();
+    return (eOutputType==ImagePacket || eOutputType==ImageArrayPacket)?DataEncoder_PNG_Max:DataEncoder_Raw;
+}
+
+void lv::IIDataArchiver::flushOutput() {
+    lvDbgExceptionWatch;
+    lv::mutex_lock_guard oLock(m_oOutputWriterMutex);
+    if(m_pOutputWriter)
+        m_pOutputWriter->stopAsyncWriting(); // async writing restarts with the next queued packet
+}
+
+void lv::IIDataArchiver::writeOutput(const cv::Mat& oOutput, const std::string& sFilePathPrefix, size_t nQueueIdx) {
+    lvDbgExceptionWatch;
+    lv::mutex_lock_guard oLock(m_oOutputWriterMutex);
+    if(!m_pOutputWriter) {
+        m_pOutputWriter = std::make_unique<DataWriter>(getOutputEncoder(),[this](size_t nIdx) {
+            lv::mutex_lock_guard oPathsLock(m_oQueuedOutputPathsMutex);
+            const auto pPathIter = m_mQueuedOutputPaths.find(nIdx);
+            lvDbgAssert(pPathIter!=m_mQueuedOutputPaths.end());
+            const std::string sFilePath = pPathIter->second;
+            m_mQueuedOutputPaths.erase(pPathIter);
+            return sFilePath;
+        });
     }
-    else {
-        sOutputFilePath << ".bin";
-        return lv::read(sOutputFilePath.str());
+    if(m_nAsyncOutputQueueSize>0 && !m_pOutputWriter->isActive())
+        m_pOutputWriter->startAsyncWriting(m_nAsyncOutputQueueSize,false,m_nAsyncOutputWorkers);
+    {
+        lv::mutex_lock_guard oPathsLock(m_oQueuedOutputPathsMutex);
+        m_mQueuedOutputPaths[nQueueIdx] = sFilePathPrefix+DataWriter::getFileExt(getOutputEncoder());
     }
+    m_pOutputWriter->queue(oOutput,nQueueIdx);
+}
+
+cv::Mat lv::IIDataArchiver::readOutput(const std::string& sFilePathPrefix, int nFlags) {
+    lvDbgExceptionWatch;
+    flushOutput();
+    const DataEncoderList eEncoder = getOutputEncoder();
+    const std::string sFilePath = sFilePathPrefix+DataWriter::getFileExt(eEncoder);
+    if(eEncoder==DataEncoder_PNG || eEncoder==DataEncoder_PNG_Max)
+        return cv::imread(sFilePath,(nFlags==-1)?cv::IMREAD_UNCHANGED:nFlags);
+    return DataWriter::read(sFilePath,eEncoder);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+cv::Mat lv::IDataArchiver_<lv::NotArray>::loadOutput(size_t nIdx, int nFlags) {
+    lvDbgExceptionWatch;
+    return readOutput(getOutputPath()+getOutputName(nIdx),nFlags);
 }
 
-void lv::IDataArchiver_<lv::NotArray>::saveOutput(const cv::Mat& _oOutput, size_t nIdx, int /*nFlags*/) {
+void lv::IDataArchiver_<lv::NotArray>::saveOutput(const cv::Mat& oOutput, size_t nIdx, int /*nFlags*/) {
     lvDbgExceptionWatch;
     const auto pLoader = shared_from_this_cast<const IIDataLoader>(true);
-    std::stringstream sOutputFilePath;
-    sOutputFilePath << getOutputPath() << getOutputName(nIdx);
-    if(pLoader->getOutputPacketType()==ImagePacket) {
-        cv::Mat oOutput = _oOutput;
-        // automatically gray-out zones outside ROI if output is binary image mask with 1:1 mapping (e.g. segmentation)
-        if(pLoader->getGTPacketType()==ImagePacket && pLoader->getGTMappingType()==ElemMapping &&
-           _oOutput.type()==CV_8UC1 && (cv::countNonZero(_oOutput==UCHAR_MAX)+cv::countNonZero(_oOutput==0))==_oOutput.size().area()) {
-            const cv::Mat& oROI = pLoader->getGTROI(nIdx);
-            if(!oROI.empty() && oROI.size()==_oOutput.size()) {
-                oOutput = _oOutput.clone();
-                cv::bitwise_or(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-                cv::bitwise_and(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-            }
-        }
-        const std::vector<int> vnComprParams = {cv::IMWRITE_PNG_COMPRESSION,9};
-        sOutputFilePath << ".png";
-        cv::imwrite(sOutputFilePath.str(),oOutput,vnComprParams);
-    }
-    else {
-        sOutputFilePath << ".bin";
-        lv::write(sOutputFilePath.str(),_oOutput);
-    }
+    if(pLoader->getOutputPacketType()==ImagePacket)
+        writeOutput(getArchivedImageOutput(*pLoader,oOutput,nIdx,pLoader->getGTPacketType()==ImagePacket),getOutputPath()+getOutputName(nIdx),nIdx);
+    else
+        writeOutput(oOutput,getOutputPath()+getOutputName(nIdx),nIdx);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 std::vector<cv::Mat> lv::IDataArchiver_<lv::Array>::loadOutputArray(size_t nIdx, int nFlags) {
     lvDbgExceptionWatch;
-    const auto pLoader = shared_from_this_cast<const IIDataLoader>(true);
     std::vector<cv::Mat> vOutput(getOutputStreamCount());
     for(size_t nStreamIdx=0; nStreamIdx<vOutput.size(); ++nStreamIdx) {
         std::stringstream sOutputFilePath;
         sOutputFilePath << getOutputPath() << getOutputName(nIdx);
         if(vOutput.size()>size_t(1))
             sOutputFilePath << "_" << nStreamIdx;
-        if(pLoader->getOutputPacketType()==ImagePacket || pLoader->getOutputPacketType()==ImageArrayPacket) {
-            sOutputFilePath << ".png";
-            if(nFlags==-1)
-                vOutput[nStreamIdx] = cv::imread(sOutputFilePath.str(),cv::IMREAD_UNCHANGED);
-            else
-                vOutput[nStreamIdx] = cv::imread(sOutputFilePath.str(),nFlags);
-        }
-        else {
-            sOutputFilePath << ".bin";
-            vOutput[nStreamIdx] = lv::read(sOutputFilePath.str());
-        }
+        vOutput[nStreamIdx] = readOutput(sOutputFilePath.str(),nFlags);
     }
     return vOutput;
 }
@@ -1555,56 +2082,23 @@ void lv::IDataArchiver_<lv::Array>::saveOutputArray(const std::vector<cv::Mat>&
         return;
     const auto pLoader = shared_from_this_cast<const IIDataLoader>(true);
     if(nStreamCount==size_t(1)) {
-        const cv::Mat& _oOutput = vOutput[0];
-        std::stringstream sOutputFilePath;
-        sOutputFilePath << getOutputPath() << getOutputName(nIdx);
-        if(pLoader->getOutputPacketType()==ImagePacket || pLoader->getOutputPacketType()==ImageArrayPacket) {
-            cv::Mat oOutput = _oOutput;
-            // automatically gray-out zones outside ROI if output is binary image mask with 1:1 mapping (e.g. segmentation)
-            if((pLoader->getGTPacketType()==ImagePacket || pLoader->getGTPacketType()==ImageArrayPacket) && pLoader->getGTMappingType()==ElemMapping &&
-               _oOutput.type()==CV_8UC1 && (cv::countNonZero(_oOutput==UCHAR_MAX)+cv::countNonZero(_oOutput==0))==_oOutput.size().area()) {
-                const cv::Mat& oROI = pLoader->getGTROI(nIdx);
-                if(!oROI.empty() && oROI.size()==_oOutput.size()) {
-                    oOutput = _oOutput.clone();
-                    cv::bitwise_or(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-                    cv::bitwise_and(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-                }
-            }
-            const std::vector<int> vnComprParams = {cv::IMWRITE_PNG_COMPRESSION,9};
-            sOutputFilePath << ".png";
-            cv::imwrite(sOutputFilePath.str(),oOutput,vnComprParams);
-        }
-        else {
-            sOutputFilePath << ".bin";
-            lv::write(sOutputFilePath.str(),_oOutput);
-        }
+        const std::string sOutputFilePath = getOutputPath()+getOutputName(nIdx);
+        if(pLoader->getOutputPacketType()==ImagePacket || pLoader->getOutputPacketType()==ImageArrayPacket)
+            writeOutput(getArchivedImageOutput(*pLoader,vOutput[0],nIdx,pLoader->getGTPacketType()==ImagePacket || pLoader->getGTPacketType()==ImageArrayPacket),sOutputFilePath,nIdx);
+        else
+            writeOutput(vOutput[0],sOutputFilePath,nIdx);
     }
     else { // nStreamCount>size_t(1)
+        lvDbgAssert(pLoader->getOutputPacketType()!=ImagePacket);
         for(size_t nStreamIdx=0; nStreamIdx<nStreamCount; ++nStreamIdx) {
-            const cv::Mat& _oOutput = vOutput[nStreamIdx];
             std::stringstream sOutputFilePath;
             sOutputFilePath << getOutputPath() << getOutputName(nIdx) << "_" << nStreamIdx;
-            lvDbgAssert(pLoader->getOutputPacketType()!=ImagePacket);
-            if(pLoader->getOutputPacketType()==ImageArrayPacket) {
-                cv::Mat oOutput = _oOutput;
-                // automatically gray-out zones outside ROI if output is binary image mask with 1:1 mapping (e.g. segmentation)
-                if(pLoader->getGTPacketType()==ImageArrayPacket && pLoader->getGTMappingType()==ElemMapping &&
-                   _oOutput.type()==CV_8UC1 && (cv::countNonZero(_oOutput==UCHAR_MAX)+cv::countNonZero(_oOutput==0))==_oOutput.size().area()) {
-                    const cv::Mat& oROI = pLoader->getGTROI(nIdx);
-                    if(!oROI.empty() && oROI.size()==_oOutput.size()) {
-                        oOutput = _oOutput.clone();
-                        cv::bitwise_or(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-                        cv::bitwise_and(oOutput,UCHAR_MAX/2,oOutput,oROI==0);
-                    }
-                }
-                const std::vector<int> vnComprParams = {cv::IMWRITE_PNG_COMPRESSION,9};
-                sOutputFilePath << ".png";
-                cv::imwrite(sOutputFilePath.str(),oOutput,vnComprParams);
-            }
-            else {
-                sOutputFilePath << ".bin";
-                lv::write(sOutputFilePath.str(),_oOutput);
-            }
+            // streams of a packet are queued under consecutive indices, so they are still written in packet order
+            const size_t nQueueIdx = nIdx*nStreamCount+nStreamIdx;
+            if(pLoader->getOutputPacketType()==ImageArrayPacket)
+                writeOutput(getArchivedImageOutput(*pLoader,vOutput[nStreamIdx],nIdx,pLoader->getGTPacketType()==ImageArrayPacket),sOutputFilePath.str(),nQueueIdx);
+            else
+                writeOutput(vOutput[nStreamIdx],sOutputFilePath.str(),nQueueIdx);
         }
     }
 }
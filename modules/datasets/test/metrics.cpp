@@ -0,0 +1,92 @@
+
+#include "litiv/datasets.hpp"
+#include "litiv/test.hpp"
+
+namespace {
+
+    /// original branching per-pixel loop, kept as reference for the vectorized implementation
+    lv::BinClassif accumulate_ref(const cv::Mat& oClassif, const cv::Mat& oGT, const cv::Mat& oROI) {
+        lv::BinClassif oCounters;
+        for(size_t nPxIter=0; nPxIter<oClassif.total(); ++nPxIter) {
+            const uchar nGT = oGT.data[nPxIter], nInput = oClassif.data[nPxIter];
+            if(nGT!=DATASETUTILS_OUTOFSCOPE_VAL && nGT!=DATASETUTILS_UNKNOWN_VAL && (oROI.empty() || oROI.data[nPxIter]!=DATASETUTILS_NEGATIVE_VAL)) {
+                if(nInput==DATASETUTILS_POSITIVE_VAL) {
+                    if(nGT==DATASETUTILS_POSITIVE_VAL)
+                        ++oCounters.nTP;
+                    else
+                        ++oCounters.nFP;
+                }
+                else {
+                    if(nGT==DATASETUTILS_POSITIVE_VAL)
+                        ++oCounters.nFN;
+                    else
+                        ++oCounters.nTN;
+                }
+                if(nGT==DATASETUTILS_SHADOW_VAL && nInput==DATASETUTILS_POSITIVE_VAL)
+                    ++oCounters.nSE;
+            }
+            else
+                ++oCounters.nDC;
+        }
+        return oCounters;
+    }
+
+    /// fills a mask with random values picked from a list of labels (plus some noise values)
+    void randLabels(cv::Mat& oMask, const std::vector<uchar>& vLabels) {
+        for(size_t nPxIter=0; nPxIter<oMask.total(); ++nPxIter)
+            oMask.data[nPxIter] = vLabels[rand()%vLabels.size()];
+    }
+
+}
+
+TEST(datasets_metrics,regression_binclassif_accumulate) {
+    srand((uint)time((time_t*)nullptr));
+    const std::vector<uchar> vInputLabels = {DATASETUTILS_POSITIVE_VAL,DATASETUTILS_NEGATIVE_VAL,uchar(1),uchar(128),uchar(254)};
+    const std::vector<uchar> vGTLabels = {DATASETUTILS_POSITIVE_VAL,DATASETUTILS_NEGATIVE_VAL,DATASETUTILS_OUTOFSCOPE_VAL,DATASETUTILS_UNKNOWN_VAL,DATASETUTILS_SHADOW_VAL,uchar(1),uchar(254)};
+    const std::vector<cv::Size> voSizes = {cv::Size(1,1),cv::Size(15,1),cv::Size(63,3),cv::Size(64,2),cv::Size(65,7),cv::Size(321,241),cv::Size(640,480),cv::Size(1283,723)};
+    for(const cv::Size& oSize : voSizes) {
+        cv::Mat oClassif(oSize,CV_8UC1),oGT(oSize,CV_8UC1),oROI(oSize,CV_8UC1);
+        randLabels(oClassif,vInputLabels);
+        randLabels(oGT,vGTLabels);
+        randLabels(oROI,{DATASETUTILS_POSITIVE_VAL,DATASETUTILS_POSITIVE_VAL,DATASETUTILS_NEGATIVE_VAL});
+        for(bool bWithROI : {false,true}) {
+            const cv::Mat oCurrROI = bWithROI?oROI:cv::Mat();
+            const lv::BinClassif oRefCounters = accumulate_ref(oClassif,oGT,oCurrROI);
+            ASSERT_EQ(oRefCounters.total(true),uint64_t(oSize.area()));
+            for(bool bParallel : {false,true}) {
+                lv::BinClassif oCounters;
+                oCounters.accumulate(oClassif,oGT,oCurrROI,bParallel);
+                ASSERT_TRUE(oCounters.isEqual(oRefCounters)) << "size=" << oSize << ", roi=" << bWithROI << ", parallel=" << bParallel;
+                // counts must keep accumulating on top of existing ones
+                oCounters.accumulate(oClassif,oGT,oCurrROI,bParallel);
+                lv::BinClassif oDoubleRefCounters = oRefCounters;
+                oDoubleRefCounters.accumulate(oRefCounters);
+                ASSERT_TRUE(oCounters.isEqual(oDoubleRefCounters)) << "size=" << oSize << ", roi=" << bWithROI << ", parallel=" << bParallel;
+            }
+        }
+    }
+    lv::BinClassif oCounters;
+    const cv::Mat oGTOnly(cv::Size(67,5),CV_8UC1,cv::Scalar_<uchar>(DATASETUTILS_POSITIVE_VAL));
+    oCounters.accumulate(cv::Mat(oGTOnly.size(),CV_8UC1,cv::Scalar_<uchar>(DATASETUTILS_POSITIVE_VAL)),oGTOnly);
+    ASSERT_EQ(oCounters.nTP,uint64_t(oGTOnly.total()));
+    ASSERT_EQ(oCounters.total(true),uint64_t(oGTOnly.total()));
+}
+
+namespace {
+
+    void binclassif_accumulate_perftest(benchmark::State& st) {
+        const bool bParallel = st.range(0)!=0;
+        cv::Mat oClassif(cv::Size(1920,1080),CV_8UC1),oGT(cv::Size(1920,1080),CV_8UC1);
+        randLabels(oClassif,{DATASETUTILS_POSITIVE_VAL,DATASETUTILS_NEGATIVE_VAL});
+        randLabels(oGT,{DATASETUTILS_POSITIVE_VAL,DATASETUTILS_NEGATIVE_VAL,DATASETUTILS_OUTOFSCOPE_VAL,DATASETUTILS_UNKNOWN_VAL,DATASETUTILS_SHADOW_VAL});
+        lv::BinClassif oCounters;
+        while(st.KeepRunning()) {
+            oCounters.accumulate(oClassif,oGT,cv::Mat(),bParallel);
+            benchmark::DoNotOptimize(oCounters);
+        }
+        st.SetBytesProcessed(int64_t(st.iterations())*int64_t(oClassif.total()*2));
+    }
+
+}
+
+BENCHMARK(binclassif_accumulate_perftest)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -84,6 +84,52 @@ TEST(datasets_notarray,regression_custom) {
     ASSERT_TRUE(lv::checkIfExists(sOutputRootPath+"/customtest.txt"));
 }
 
+TEST(datasets_notarray,regression_custom_output_encoders) {
+    lv::setVerbosity(0);
+    using DatasetType = lv::Dataset_<lv::DatasetTask_EdgDet,lv::Dataset_Custom,lv::NonParallel>;
+    DatasetType::Ptr pDataset = DatasetType::create(
+        "customtest",
+        lv::addDirSlashIfMissing(SAMPLES_DATA_ROOT)+"custom_dataset_ex/",
+        TEST_OUTPUT_DATA_ROOT "/custom_dataset_encoders_test/",
+        std::vector<std::string>{"batch1","batch2","batch3"},
+        std::vector<std::string>(),
+        true,
+        false,
+        false,
+        1.0
+    );
+    ASSERT_TRUE(pDataset.get()!=nullptr);
+    std::vector<lv::DataEncoderList> veEncoders = {lv::DataEncoder_PNG_Max,lv::DataEncoder_PNG,lv::DataEncoder_BitPacked,lv::DataEncoder_Raw};
+#if USING_LZ4
+    veEncoders.push_back(lv::DataEncoder_LZ4);
+#endif //USING_LZ4
+    std::shared_ptr<IEdgeDetector> pAlgo = std::make_shared<EdgeDetectorLBSP>();
+    for(const lv::IDataHandlerPtr& pBatch : pDataset->getBatches(false)) {
+        DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*pBatch);
+        // image outputs keep the original (max-compression png) format by default
+        ASSERT_EQ(oBatch.getOutputEncoder(),lv::DataEncoder_PNG_Max);
+        for(lv::DataEncoderList eEncoder : veEncoders) {
+            for(size_t nAsyncQueueSize : {size_t(0),SIZE_MAX}) {
+                oBatch.setOutputEncoder(eEncoder,nAsyncQueueSize,2);
+                ASSERT_EQ(oBatch.getOutputEncoder(),eEncoder);
+                std::vector<cv::Mat> voMasks;
+                oBatch.startProcessing();
+                for(size_t nPacketIdx=0; nPacketIdx<oBatch.getImageCount(); ++nPacketIdx) {
+                    cv::Mat oEdgeMask;
+                    pAlgo->apply(oBatch.getInput(nPacketIdx),oEdgeMask);
+                    voMasks.push_back(oEdgeMask>0); // binary masks, so that bit-packed archives are lossless
+                    oBatch.push(voMasks.back(),nPacketIdx);
+                }
+                oBatch.stopProcessing(); // flushes outputs still queued for async writing
+                for(size_t nPacketIdx=0; nPacketIdx<voMasks.size(); ++nPacketIdx) {
+                    ASSERT_TRUE(lv::checkIfExists(oBatch.getOutputPath()+oBatch.getOutputName(nPacketIdx)+lv::DataWriter::getFileExt(eEncoder))) << "eEncoder=" << eEncoder;
+                    ASSERT_TRUE(lv::isEqual<uint8_t>(oBatch.loadOutput(nPacketIdx),voMasks[nPacketIdx])) << "eEncoder=" << eEncoder << ", nAsyncQueueSize=" << nAsyncQueueSize;
+                }
+            }
+        }
+    }
+}
+
 TEST(datasets_notarray,regression_specialization) {
     // ... @@@@ TODO
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+
+#include "../../../samples/datasets/src/middlebury2005.hpp" // cheat, to avoid copy & reuse in exported headers
+#include "litiv/test.hpp"
+
+namespace {
+
+    using DatasetType = lv::Dataset_<lv::DatasetTask_EdgDet,lv::Dataset_Custom,lv::NonParallel>;
+
+    DatasetType::Ptr createCustomDataset(const std::string& sOutputRootPath, bool bForce4ByteDataAlign=false) {
+        return DatasetType::create(
+            "customtest",
+            lv::addDirSlashIfMissing(SAMPLES_DATA_ROOT)+"custom_dataset_ex/",
+            sOutputRootPath,
+            std::vector<std::string>{"batch1","batch2","batch3"},
+            std::vector<std::string>(),
+            false,
+            false,
+            bForce4ByteDataAlign,
+            1.0
+        );
+    }
+
+}
+
+TEST(datasets_pack,regression_custom) {
+    lv::setVerbosity(0);
+    const std::string sOutputRootPath = TEST_OUTPUT_DATA_ROOT "/custom_dataset_pack_test/";
+    DatasetType::Ptr pDataset = createCustomDataset(sOutputRootPath);
+    ASSERT_TRUE(pDataset.get()!=nullptr);
+    const lv::IDataHandlerPtrArray vpBatches = pDataset->getBatches(false);
+    ASSERT_EQ(vpBatches.size(),size_t(3));
+    std::vector<lv::DataPackBlockList> veBlockTypes = {lv::DataPackBlock_Raw};
+#if USING_LZ4
+    veBlockTypes.push_back(lv::DataPackBlock_LZ4);
+#endif //USING_LZ4
+    for(lv::DataPackBlockList eBlockType : veBlockTypes) {
+        const std::string sPackDirPath = sOutputRootPath+"packs"+std::to_string((int)eBlockType)+"/";
+        ASSERT_EQ(lv::writeDataPacks(pDataset,sPackDirPath,eBlockType),vpBatches.size());
+        DatasetType::Ptr pPackedDataset = createCustomDataset(sOutputRootPath);
+        ASSERT_EQ(lv::attachDataPacks(pPackedDataset,sPackDirPath),vpBatches.size());
+        const lv::IDataHandlerPtrArray vpPackedBatches = pPackedDataset->getBatches(false);
+        ASSERT_EQ(vpPackedBatches.size(),vpBatches.size());
+        for(size_t nBatchIdx=0; nBatchIdx<vpBatches.size(); ++nBatchIdx) {
+            DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*vpBatches[nBatchIdx]);
+            DatasetType::WorkBatch& oPackedBatch = dynamic_cast<DatasetType::WorkBatch&>(*vpPackedBatches[nBatchIdx]);
+            ASSERT_TRUE(oPackedBatch.getDataPack()!=nullptr);
+            ASSERT_EQ(oPackedBatch.getDataPack()->getInputCount(),oBatch.getInputCount());
+            ASSERT_EQ(oPackedBatch.getDataPack()->getGTCount(),size_t(0)); // custom edge dataset has no gt
+            // packed loads are reentrant, so the precacher keeps all requested decode workers
+            oPackedBatch.startPrecaching(true,SIZE_MAX,4);
+            for(size_t nPacketIdx=0; nPacketIdx<oBatch.getInputCount(); ++nPacketIdx) {
+                const cv::Mat oInput = oBatch.getInput(nPacketIdx).clone();
+                const cv::Mat& oPackedInput = oPackedBatch.getInput(nPacketIdx);
+                ASSERT_FALSE(oInput.empty());
+                ASSERT_EQ(oPackedInput.type(),oInput.type()) << "eBlockType=" << eBlockType << ", nPacketIdx=" << nPacketIdx;
+                ASSERT_TRUE(oPackedInput.size==oInput.size) << "eBlockType=" << eBlockType << ", nPacketIdx=" << nPacketIdx;
+                ASSERT_TRUE(lv::isEqual<uchar>(oPackedInput.reshape(1),oInput.reshape(1))) << "eBlockType=" << eBlockType << ", nPacketIdx=" << nPacketIdx;
+            }
+            ASSERT_TRUE(oPackedBatch.getInput(oBatch.getInputCount()).empty());
+            oPackedBatch.stopPrecaching();
+        }
+        // packs can also be opened on their own, without the original dataset
+        const lv::DataPack oPack(sPackDirPath+lv::DataPack::getDefaultFileName(*vpBatches[0]));
+        ASSERT_EQ(oPack.getInputCount(),vpBatches[0]->getInputCount());
+        EXPECT_DOUBLE_EQ(oPack.getScaleFactor(),1.0);
+        ASSERT_TRUE(oPack.getInput(oPack.getInputCount()).empty());
+        // raw blocks are views into the mapping, while lz4 blocks are decompressed into owned memory
+        ASSERT_EQ(oPack.isMappedPacket(oPack.getInput(0)),eBlockType==lv::DataPackBlock_Raw) << "eBlockType=" << eBlockType;
+        ASSERT_EQ(oPack.getInputInfo(0),lv::MatInfo(oPack.getInput(0)));
+    }
+    // packets held from the previous source must not be returned once a pack is attached
+    DatasetType::WorkBatch& oBatch = dynamic_cast<DatasetType::WorkBatch&>(*vpBatches[0]);
+    ASSERT_FALSE(oBatch.getInput(0).empty());
+    std::shared_ptr<const lv::DataPack> pPack = std::make_shared<const lv::DataPack>(sOutputRootPath+"packs"+std::to_string((int)lv::DataPackBlock_Raw)+"/"+lv::DataPack::getDefaultFileName(oBatch));
+    oBatch.setDataPack(pPack);
+    ASSERT_TRUE(pPack->isMappedPacket(oBatch.getInput(0)));
+    oBatch.setDataPack(nullptr);
+    ASSERT_FALSE(pPack->isMappedPacket(oBatch.getInput(0)));
+    // packets (and views) keep the mapping alive once their data pack is detached & destroyed
+    const cv::Mat oRefInput = oBatch.getInput(0).clone();
+    const std::string sPackPath = pPack->getFilePath();
+    pPack.reset();
+    oBatch.setDataPack(std::make_shared<const lv::DataPack>(sPackPath));
+    const cv::Mat oHeldInput = oBatch.getInput(0);
+    const std::shared_ptr<const cv::Mat> pHeldView = oBatch.getInputView(0);
+    ASSERT_TRUE(oBatch.getDataPack()->isMappedPacket(oHeldInput));
+    ASSERT_TRUE(oBatch.getDataPack()->isMappedPacket(*pHeldView));
+    oBatch.setDataPack(nullptr);
+    ASSERT_TRUE(lv::isEqual<uchar>(oHeldInput.reshape(1),oRefInput.reshape(1)));
+    ASSERT_TRUE(lv::isEqual<uchar>(pHeldView->reshape(1),oRefInput.reshape(1)));
+    // packs written by another variant of the dataset (here, without 4-byte alignment) must be rejected
+    DatasetType::Ptr pAlignedDataset = createCustomDataset(sOutputRootPath,true);
+    ASSERT_THROW_LV_QUIET(lv::attachDataPacks(pAlignedDataset,sOutputRootPath+"packs"+std::to_string((int)lv::DataPackBlock_Raw)+"/"));
+}
+
+TEST(datasets_pack,regression_array_with_gt) {
+    lv::setVerbosity(0);
+    using ArrayDatasetType = lv::Dataset_<lv::DatasetTask_Cosegm,lv::Dataset_Middlebury2005_demo,lv::NonParallel>;
+    const std::string sOutputRootPath = TEST_OUTPUT_DATA_ROOT "/middlebury_pack_test/";
+    ArrayDatasetType::Ptr pDataset = ArrayDatasetType::create(sOutputRootPath,false,false);
+    const lv::IDataHandlerPtrArray vpBatches = pDataset->getBatches(false);
+    ASSERT_EQ(vpBatches.size(),size_t(2));
+    std::vector<lv::DataPackBlockList> veBlockTypes = {lv::DataPackBlock_Raw};
+#if USING_LZ4
+    veBlockTypes.push_back(lv::DataPackBlock_LZ4);
+#endif //USING_LZ4
+    for(lv::DataPackBlockList eBlockType : veBlockTypes) {
+        const std::string sPackDirPath = sOutputRootPath+"packs"+std::to_string((int)eBlockType)+"/";
+        ASSERT_EQ(lv::writeDataPacks(pDataset,sPackDirPath,eBlockType),vpBatches.size());
+        ArrayDatasetType::Ptr pPackedDataset = ArrayDatasetType::create(sOutputRootPath,false,false);
+        ASSERT_EQ(lv::attachDataPacks(pPackedDataset,sPackDirPath),vpBatches.size());
+        const lv::IDataHandlerPtrArray vpPackedBatches = pPackedDataset->getBatches(false);
+        for(size_t nBatchIdx=0; nBatchIdx<vpBatches.size(); ++nBatchIdx) {
+            ArrayDatasetType::WorkBatch& oBatch = dynamic_cast<ArrayDatasetType::WorkBatch&>(*vpBatches[nBatchIdx]);
+            ArrayDatasetType::WorkBatch& oPackedBatch = dynamic_cast<ArrayDatasetType::WorkBatch&>(*vpPackedBatches[nBatchIdx]);
+            ASSERT_TRUE(oPackedBatch.getDataPack()!=nullptr);
+            ASSERT_EQ(oPackedBatch.getDataPack()->getGTCount(),oBatch.getInputCount());
+            const lv::DataPack& oPack = *oPackedBatch.getDataPack();
+            if(eBlockType==lv::DataPackBlock_LZ4)
+                ASSERT_FALSE(oPack.isMappedPacket(oPack.getGT(0))) << "disparity maps should be stored as (decompressed) lz4 blocks";
+            const std::vector<cv::Mat> vInputs = oBatch.getInputArray(0);
+            const std::vector<cv::Mat> vGTs = oBatch.getGTArray(0);
+            const std::vector<cv::Mat>& vPackedInputs = oPackedBatch.getInputArray(0);
+            ASSERT_EQ(vPackedInputs.size(),vInputs.size());
+            for(size_t nStreamIdx=0; nStreamIdx<vInputs.size(); ++nStreamIdx)
+                ASSERT_TRUE(lv::isEqual<uchar>(vPackedInputs[nStreamIdx],vInputs[nStreamIdx])) << "eBlockType=" << eBlockType << ", nStreamIdx=" << nStreamIdx;
+            const std::vector<cv::Mat>& vPackedGTs = oPackedBatch.getGTArray(0);
+            ASSERT_EQ(vPackedGTs.size(),vGTs.size());
+            for(size_t nStreamIdx=0; nStreamIdx<vGTs.size(); ++nStreamIdx) {
+                ASSERT_FALSE(vGTs[nStreamIdx].empty());
+                ASSERT_TRUE(lv::isEqual<uchar>(vPackedGTs[nStreamIdx],vGTs[nStreamIdx])) << "eBlockType=" << eBlockType << ", nStreamIdx=" << nStreamIdx;
+            }
+        }
+    }
+}
+
+namespace {
+
+    void datapack_perftest(benchmark::State& st) {
+        lv::setVerbosity(0);
+        const lv::DataPackBlockList eBlockType = (lv::DataPackBlockList)st.range(0);
+        const std::string sOutputRootPath = TEST_OUTPUT_DATA_ROOT "/custom_dataset_pack_perftest/";
+        DatasetType::Ptr pDataset = createCustomDataset(sOutputRootPath);
+        const std::string sPackDirPath = sOutputRootPath+"packs"+std::to_string((int)eBlockType)+"/";
+        lv::writeDataPacks(pDataset,sPackDirPath,eBlockType,false);
+        const lv::DataPack oPack(sPackDirPath+lv::DataPack::getDefaultFileName(*pDataset->getBatches(false)[0]));
+        size_t nPacketIdx = 0;
+        while(st.KeepRunning()) {
+            benchmark::DoNotOptimize(oPack.getInput(nPacketIdx).data);
+            nPacketIdx = (nPacketIdx+1)%oPack.getInputCount();
+        }
+    }
+
+}
+
+BENCHMARK(datapack_perftest)->Arg(lv::DataPackBlock_Raw)
+#if USING_LZ4
+    ->Arg(lv::DataPackBlock_LZ4)
+#endif //USING_LZ4
+    ->Unit(benchmark::kMicrosecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -0,0 +1,254 @@
+
+#include "litiv/datasets.hpp"
+#include "litiv/test.hpp"
+#include <numeric>
+
+namespace {
+
+    /// returns a synthetic packet filled with a value derived from its index (or an empty packet past the end of the stream)
+    cv::Mat genSyntheticPacket(size_t nPacketIdx, size_t nPacketCount, bool bSlowDecode) {
+        if(bSlowDecode)
+            std::this_thread::sleep_for(std::chrono::microseconds(100+(nPacketIdx*37)%400));
+        if(nPacketIdx>=nPacketCount)
+            return cv::Mat();
+        return cv::Mat(240,320,CV_8UC3,cv::Scalar::all(double(nPacketIdx%251)));
+    }
+
+}
+
+TEST(datasets_utils,regression_precacher_decode_workers) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 200;
+    std::vector<size_t> vnSequentialIdxs(nPacketCount),vnJumpingIdxs;
+    std::iota(vnSequentialIdxs.begin(),vnSequentialIdxs.end(),size_t(0));
+    for(size_t nPacketIdx=0; nPacketIdx<80; ++nPacketIdx)
+        vnJumpingIdxs.push_back(nPacketIdx);
+    for(size_t nPacketIdx=40; nPacketIdx<60; ++nPacketIdx)
+        vnJumpingIdxs.push_back(nPacketIdx);
+    for(size_t nPacketIdx=120; nPacketIdx<nPacketCount; nPacketIdx+=3)
+        vnJumpingIdxs.push_back(nPacketIdx);
+    vnJumpingIdxs.insert(vnJumpingIdxs.end(),{10,11,11,12});
+    for(size_t nDecodeWorkers : {1,2,4,8}) {
+        for(const std::vector<size_t>& vnPacketIdxs : {vnSequentialIdxs,vnJumpingIdxs}) {
+            lv::DataPrecacher oPrecacher(std::bind(genSyntheticPacket,std::placeholders::_1,nPacketCount,true));
+            // minimal buffer size, so that the cache and decode window both fill up
+            ASSERT_TRUE(oPrecacher.startAsyncPrecaching(1,nDecodeWorkers));
+            ASSERT_EQ(oPrecacher.getDecodeWorkerCount(),nDecodeWorkers);
+            for(size_t nPacketIdx : vnPacketIdxs) {
+                const cv::Mat& oPacket = oPrecacher.getPacket(nPacketIdx);
+                ASSERT_EQ(oPacket.size(),cv::Size(320,240)) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+                ASSERT_EQ(oPacket.type(),CV_8UC3) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+                ASSERT_TRUE(lv::isEqual<uchar>(oPacket,genSyntheticPacket(nPacketIdx,nPacketCount,false))) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+                ASSERT_EQ(oPrecacher.getLastReqIdx(),nPacketIdx);
+            }
+            ASSERT_TRUE(oPrecacher.getPacket(nPacketCount).empty()) << "nDecodeWorkers=" << nDecodeWorkers;
+            oPrecacher.stopAsyncPrecaching();
+            ASSERT_FALSE(oPrecacher.isActive());
+        }
+    }
+}
+
+TEST(datasets_utils,regression_precacher_packet_views) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 100;
+    for(size_t nDecodeWorkers : {1,4}) {
+        // 1 MB packets in a minimal (10 MB) cache, so that slots get recycled while some views are still held
+        lv::DataPrecacher oPrecacher([&](size_t nPacketIdx) {
+            if(nPacketIdx>=nPacketCount)
+                return cv::Mat();
+            return cv::Mat(1024,1024,CV_8UC1,cv::Scalar::all(double(nPacketIdx%251)));
+        });
+        ASSERT_TRUE(oPrecacher.startAsyncPrecaching(1,nDecodeWorkers));
+        std::vector<std::pair<size_t,std::shared_ptr<const cv::Mat>>> vpHeldViews;
+        for(size_t nPacketIdx=0; nPacketIdx<nPacketCount; ++nPacketIdx) {
+            std::shared_ptr<const cv::Mat> pView = oPrecacher.getPacketView(nPacketIdx);
+            ASSERT_TRUE(pView!=nullptr);
+            ASSERT_EQ(cv::countNonZero(*pView!=double(nPacketIdx%251)),0) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+            ASSERT_EQ(pView.get(),oPrecacher.getPacketView(nPacketIdx).get()); // repeated requests return the same view
+            if(nPacketIdx%7==0)
+                vpHeldViews.emplace_back(nPacketIdx,pView);
+            if(vpHeldViews.size()>4)
+                vpHeldViews.erase(vpHeldViews.begin());
+            for(const auto& oHeldView : vpHeldViews)
+                ASSERT_EQ(cv::countNonZero(*oHeldView.second!=double(oHeldView.first%251)),0) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx << ", nHeldIdx=" << oHeldView.first;
+        }
+        oPrecacher.stopAsyncPrecaching();
+        // views keep their slot (and the buffer) alive past the precacher's shutdown
+        for(const auto& oHeldView : vpHeldViews)
+            ASSERT_EQ(cv::countNonZero(*oHeldView.second!=double(oHeldView.first%251)),0) << "nDecodeWorkers=" << nDecodeWorkers << ", nHeldIdx=" << oHeldView.first;
+    }
+}
+
+TEST(datasets_utils,regression_precacher_steady_state) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 50;
+    for(size_t nDecodeWorkers : {1,4}) {
+        lv::DataPrecacher oPrecacher(std::bind(genSyntheticPacket,std::placeholders::_1,nPacketCount,false));
+        // the whole stream fits in the cache, so the precaching thread can get ahead of all requests
+        ASSERT_TRUE(oPrecacher.startAsyncPrecaching(nPacketCount*320*240*3*2,nDecodeWorkers));
+        const std::chrono::time_point<std::chrono::high_resolution_clock> nStartTick = std::chrono::high_resolution_clock::now();
+        while(oPrecacher.getReadyPacketCount()<nPacketCount && std::chrono::high_resolution_clock::now()-nStartTick<std::chrono::seconds(10))
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_EQ(oPrecacher.getReadyPacketCount(),nPacketCount) << "nDecodeWorkers=" << nDecodeWorkers;
+        for(size_t nPacketIdx=0; nPacketIdx<nPacketCount; ++nPacketIdx) {
+            std::shared_ptr<const cv::Mat> pView = oPrecacher.getPacketView(nPacketIdx);
+            ASSERT_TRUE(pView!=nullptr);
+            ASSERT_TRUE(lv::isEqual<uchar>(*pView,genSyntheticPacket(nPacketIdx,nPacketCount,false))) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+            // views point straight into the ring buffer, and are popped without locking or waiting on the precaching thread
+            ASSERT_TRUE(oPrecacher.isCachedPacket(*pView)) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+            ASSERT_TRUE(oPrecacher.isCachedPacket(oPrecacher.getPacket(nPacketIdx))) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+            ASSERT_EQ(oPrecacher.getLockedRequestCount(),size_t(0)) << "nDecodeWorkers=" << nDecodeWorkers << ", nPacketIdx=" << nPacketIdx;
+        }
+        // packets copied out of the cache (or loaded directly) must not be reported as cached
+        ASSERT_FALSE(oPrecacher.isCachedPacket(oPrecacher.getPacketView(nPacketCount-1)->clone()));
+        oPrecacher.stopAsyncPrecaching();
+        ASSERT_FALSE(oPrecacher.isCachedPacket(oPrecacher.getPacket(0)));
+    }
+}
+
+TEST(datasets_utils,regression_datawriter_encoders) {
+    lv::setVerbosity(0);
+    cv::RNG oRNG(42);
+    cv::Mat oMask(240,320,CV_8UC1),oImage(240,320,CV_8UC3),oData(3,std::array<int,3>{7,11,13}.data(),CV_32FC2);
+    oRNG.fill(oMask,cv::RNG::UNIFORM,0,2);
+    oMask *= UCHAR_MAX;
+    oRNG.fill(oImage,cv::RNG::UNIFORM,0,256);
+    oRNG.fill(oData,cv::RNG::UNIFORM,-100.0f,100.0f);
+    std::vector<lv::DataEncoderList> veEncoders = {lv::DataEncoder_Raw,lv::DataEncoder_BitPacked,lv::DataEncoder_PNG,lv::DataEncoder_PNG_Max};
+#if USING_LZ4
+    veEncoders.push_back(lv::DataEncoder_LZ4);
+#endif //USING_LZ4
+    for(lv::DataEncoderList eEncoder : veEncoders) {
+        std::vector<uchar> vBuffer;
+        lv::DataWriter::encode(oMask,vBuffer,eEncoder);
+        ASSERT_TRUE(lv::isEqual<uchar>(lv::DataWriter::decode(vBuffer,eEncoder),oMask)) << "eEncoder=" << eEncoder;
+        // non-continuous packets are handled as well
+        lv::DataWriter::encode(oMask(cv::Rect(3,5,101,37)),vBuffer,eEncoder);
+        ASSERT_TRUE(lv::isEqual<uchar>(lv::DataWriter::decode(vBuffer,eEncoder),oMask(cv::Rect(3,5,101,37)).clone())) << "eEncoder=" << eEncoder;
+        if(eEncoder==lv::DataEncoder_BitPacked) {
+            lv::DataWriter::encode(oMask,vBuffer,eEncoder);
+            ASSERT_LE(vBuffer.size(),oMask.total()/8+128);
+            ASSERT_THROW_LV_QUIET(lv::DataWriter::encode(oImage,vBuffer,eEncoder));
+            continue;
+        }
+        lv::DataWriter::encode(oImage,vBuffer,eEncoder);
+        ASSERT_TRUE(lv::isEqual<uchar>(lv::DataWriter::decode(vBuffer,eEncoder),oImage)) << "eEncoder=" << eEncoder;
+        if(eEncoder!=lv::DataEncoder_PNG && eEncoder!=lv::DataEncoder_PNG_Max) {
+            lv::DataWriter::encode(oData,vBuffer,eEncoder);
+            ASSERT_TRUE(lv::isEqual<float>(lv::DataWriter::decode(vBuffer,eEncoder),oData)) << "eEncoder=" << eEncoder;
+            lv::DataWriter::encode(cv::Mat(),vBuffer,eEncoder);
+            ASSERT_TRUE(lv::DataWriter::decode(vBuffer,eEncoder).empty()) << "eEncoder=" << eEncoder;
+        }
+    }
+}
+
+TEST(datasets_utils,regression_datawriter_ordered_commit) {
+    lv::setVerbosity(0);
+    const size_t nPacketCount = 200;
+    const std::string sOutputPath = lv::addDirSlashIfMissing(TEST_OUTPUT_DATA_ROOT)+"datawriter_test/";
+    ASSERT_TRUE(lv::createDirIfNotExist(sOutputPath));
+    for(size_t nWorkers : {1,4}) {
+        for(bool bDropPacketsIfFull : {false,true}) {
+            std::vector<size_t> vnCommittedIdxs;
+            lv::DataWriter oWriter([&](const cv::Mat& oPacket, size_t nIdx, std::vector<uchar>& vBuffer) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100+(nIdx*37)%400));
+                lv::DataWriter::encode(oPacket,vBuffer,lv::DataEncoder_Raw);
+            },[&](const std::vector<uchar>& vBuffer, size_t nIdx) {
+                // commits are serialized, so no need to lock here
+                ASSERT_TRUE(lv::isEqual<uchar>(lv::DataWriter::decode(vBuffer,lv::DataEncoder_Raw),cv::Mat(1024,1024,CV_8UC1,cv::Scalar::all(double(nIdx%251)))));
+                vnCommittedIdxs.push_back(nIdx);
+            });
+            // 1 MB packets in a minimal (10 MB) queue, so that back-pressure kicks in
+            ASSERT_TRUE(oWriter.startAsyncWriting(1,bDropPacketsIfFull,nWorkers));
+            for(size_t nPacketIdx=0; nPacketIdx<nPacketCount; ++nPacketIdx)
+                oWriter.queue(cv::Mat(1024,1024,CV_8UC1,cv::Scalar::all(double(nPacketIdx%251))),nPacketIdx);
+            oWriter.stopAsyncWriting();
+            ASSERT_FALSE(oWriter.isActive());
+            ASSERT_TRUE(std::is_sorted(vnCommittedIdxs.begin(),vnCommittedIdxs.end())) << "nWorkers=" << nWorkers;
+            const lv::DataWriter::Stats oStats = oWriter.getStats();
+            ASSERT_EQ(oStats.nCommittedPackets,vnCommittedIdxs.size());
+            ASSERT_EQ(oStats.nQueuedPackets,vnCommittedIdxs.size());
+            ASSERT_EQ(oStats.nQueuedPackets+oStats.nDroppedPackets,nPacketCount);
+            ASSERT_LE(oStats.nPeakQueueSize,oWriter.getMaxQueueSize());
+            if(!bDropPacketsIfFull) {
+                ASSERT_EQ(vnCommittedIdxs.size(),nPacketCount);
+                ASSERT_EQ(oStats.nDroppedPackets,size_t(0));
+            }
+            else
+                ASSERT_EQ(oStats.nBlockedPackets,size_t(0));
+        }
+    }
+    // built-in encoders can also commit straight to files
+    lv::DataWriter oFileWriter(lv::DataEncoder_BitPacked,[&](size_t nIdx) {
+        return sOutputPath+lv::putf("%06d",(int)nIdx)+lv::DataWriter::getFileExt(lv::DataEncoder_BitPacked);
+    });
+    ASSERT_TRUE(oFileWriter.startAsyncWriting(SIZE_MAX,false,0));
+    for(size_t nPacketIdx=0; nPacketIdx<20; ++nPacketIdx)
+        oFileWriter.queue(cv::Mat(240,320,CV_8UC1,cv::Scalar::all(double((nPacketIdx%2)*UCHAR_MAX))),nPacketIdx);
+    oFileWriter.stopAsyncWriting();
+    for(size_t nPacketIdx=0; nPacketIdx<20; ++nPacketIdx) {
+        const cv::Mat oPacket = lv::DataWriter::read(sOutputPath+lv::putf("%06d",(int)nPacketIdx)+".bits",lv::DataEncoder_BitPacked);
+        ASSERT_TRUE(lv::isEqual<uchar>(oPacket,cv::Mat(240,320,CV_8UC1,cv::Scalar::all(double((nPacketIdx%2)*UCHAR_MAX)))));
+    }
+}
+
+namespace {
+
+    void precacher_perftest(benchmark::State& st) {
+        lv::setVerbosity(0);
+        const size_t nPacketCount = 100;
+        const size_t nDecodeWorkers = (size_t)st.range(0);
+        lv::DataPrecacher oPrecacher(std::bind(genSyntheticPacket,std::placeholders::_1,nPacketCount,true));
+        while(st.KeepRunning()) {
+            oPrecacher.startAsyncPrecaching(nPacketCount*320*240*3,nDecodeWorkers);
+            for(size_t nPacketIdx=0; nPacketIdx<nPacketCount; ++nPacketIdx)
+                benchmark::DoNotOptimize(oPrecacher.getPacket(nPacketIdx).data);
+            oPrecacher.stopAsyncPrecaching();
+        }
+    }
+
+    void precacher_handoff_perftest(benchmark::State& st) {
+        lv::setVerbosity(0);
+        const size_t nPacketCount = 1000;
+        const cv::Mat oPacket(240,320,CV_8UC3,cv::Scalar::all(128));
+        lv::DataPrecacher oPrecacher([&](size_t nPacketIdx) {return (nPacketIdx<nPacketCount)?oPacket:cv::Mat();});
+        oPrecacher.startAsyncPrecaching(nPacketCount*oPacket.total()*oPacket.elemSize());
+        size_t nPacketIdx = 0;
+        while(st.KeepRunning()) {
+            benchmark::DoNotOptimize(oPrecacher.getPacketView(nPacketIdx).get());
+            nPacketIdx = (nPacketIdx+1)%nPacketCount;
+        }
+        oPrecacher.stopAsyncPrecaching();
+    }
+
+    void datawriter_perftest(benchmark::State& st) {
+        lv::setVerbosity(0);
+        const lv::DataEncoderList eEncoder = (lv::DataEncoderList)st.range(0);
+        const size_t nPacketCount = 100;
+        cv::Mat oMask(480,640,CV_8UC1);
+        cv::randu(oMask,0,2);
+        oMask *= UCHAR_MAX;
+        std::atomic_size_t nEncodedBytes(0);
+        lv::DataWriter oWriter([&](const cv::Mat& oPacket, size_t, std::vector<uchar>& vBuffer) {
+            lv::DataWriter::encode(oPacket,vBuffer,eEncoder);
+        },[&](const std::vector<uchar>& vBuffer, size_t) {
+            nEncodedBytes += vBuffer.size();
+        });
+        while(st.KeepRunning()) {
+            oWriter.startAsyncWriting(nPacketCount*oMask.total(),false,4);
+            for(size_t nPacketIdx=0; nPacketIdx<nPacketCount; ++nPacketIdx)
+                oWriter.queue(oMask,nPacketIdx);
+            oWriter.stopAsyncWriting();
+        }
+        benchmark::DoNotOptimize(nEncodedBytes.load());
+    }
+
+}
+
+BENCHMARK(precacher_perftest)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(precacher_handoff_perftest)->Unit(benchmark::kMicrosecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(datawriter_perftest)->Arg(lv::DataEncoder_Raw)->Arg(lv::DataEncoder_BitPacked)->Arg(lv::DataEncoder_PNG)
+#if USING_LZ4
+    ->Arg(lv::DataEncoder_LZ4)
+#endif //USING_LZ4
+    ->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
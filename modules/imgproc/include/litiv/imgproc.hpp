@@ -56,6 +56,14 @@ namespace lv {
     void binaryMedianBlur(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat_<uchar>& oMask, int nKernelSize, bool bForceConvertBinary=true, uchar nDefaultVal=0u);
     /// computes a 2d binary consensus for a given matrix with an optional pixel-wise minimum count map (if empty, assume majority vote, equiv to binaryMedianBlur)
     void binaryConsensus(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat_<int>& oMinCountMap, int nKernelSize, bool bForceConvertBinary=true);
+    /// fills 'oHoles' with the null pixels of a binary 8UC1 image which are not 4-connected to the seed's background (equiv. to floodFill+bitwise_not), labeling tiles of 'oTileSize' in parallel
+    void computeEnclosedHoles(const cv::Mat& oInput, cv::Mat& oHoles, const cv::Size& oTileSize=cv::Size(), const cv::Point& oSeed=cv::Point(0,0));
+    /// computes the closing of a binary 8UC1 image with a (2*nRadius+1)^2 rect element in one line-buffered pass over bit-packed rows (bit-exact with cv::morphologyEx+MORPH_CLOSE)
+    void binaryClose(const cv::Mat& oInput, cv::Mat& oOutput, int nRadius=1);
+    /// fused line-buffered foreground mask post-processing over bit-packed rows; bit-exact with cv::medianBlur(oInput|oHoles|cv::erode(oClosed),oOutput) followed by
+    /// cv::dilate(oOutput,*pDilated), with all 8UC1 mats binary (0/255), rect morph elements of the given radii, and empty mats/null pointers skipped
+    void postProcessBinaryMask(const cv::Mat& oInput, const cv::Mat& oHoles, const cv::Mat& oClosed, cv::Mat& oOutput, int nMedianKernelSize,
+                               int nErodeRadius=3, cv::Mat* pDilated=nullptr, int nDilateRadius=3);
 
 
     /// performs non-maximum suppression on the input image, with a (nWinSize)x(nWinSize) window
@@ -90,6 +98,8 @@ namespace lv {
 
     /// computes the 'temporal' absolute difference between two 8U images given their optical flow map (with optional smoothing); output is a 32F image
     void computeTemporalAbsDiff(const cv::Mat& oImage1, const cv::Mat& oImage2, const cv::Mat& oFlow, cv::Mat& oOutput, int nSmoothKernelSize=1);
+    /// computes the mean 'temporal' absolute difference between two 8U images over square blocks, assuming null flow; output is a 32F image with one value per block
+    void computeBlockTemporalAbsDiff(const cv::Mat& oImage1, const cv::Mat& oImage2, int nBlockSize, cv::Mat& oOutput);
     /// computes a map-transform of an image using relative xy pixel offsets; see cv::remap for more information
     void remap_offset(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat& oOffsetMap, int nInterpType, int nBorderMode=cv::BORDER_CONSTANT, const cv::Scalar& vBorderValue=cv::Scalar());
 
@@ -358,6 +358,271 @@ void lv::binaryConsensus(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat_
     }
 }
 
+void lv::computeEnclosedHoles(const cv::Mat& oInput, cv::Mat& oHoles, const cv::Size& oTileSize, const cv::Point& oSeed) {
+    lvAssert_(!oInput.empty() && oInput.dims==2 && oInput.type()==CV_8UC1,"input must be a non-empty 8UC1 image");
+    lvAssert_(oSeed.x>=0 && oSeed.y>=0 && oSeed.x<oInput.cols && oSeed.y<oInput.rows,"seed must be located inside the image");
+    lvAssert_((oTileSize.width>=0 && oTileSize.height>=0),"invalid tile size");
+    const int nRows = oInput.rows, nCols = oInput.cols;
+    const int nTileWidth = oTileSize.width>0?std::min(oTileSize.width,nCols):nCols;
+    const int nTileHeight = oTileSize.height>0?std::min(oTileSize.height,nRows):nRows;
+    const int nTileCols = (nCols+nTileWidth-1)/nTileWidth, nTileRows = (nRows+nTileHeight-1)/nTileHeight;
+    const int nTileCount = nTileCols*nTileRows;
+    const auto lGetTileRect = [&](int nTileIdx) {
+        return cv::Rect((nTileIdx%nTileCols)*nTileWidth,(nTileIdx/nTileCols)*nTileHeight,nTileWidth,nTileHeight)&cv::Rect(0,0,nCols,nRows);
+    };
+    // step 1: label the null pixels of each tile independently (local label 0 is the non-null pixel set)
+    std::vector<cv::Mat_<int>> voTileLabels((size_t)nTileCount);
+    std::vector<int> vnTileLabelCounts((size_t)nTileCount);
+#if USING_OPENMP
+#pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nTileIdx=0; nTileIdx<nTileCount; ++nTileIdx) {
+        const cv::Mat oTileBackground = (oInput(lGetTileRect(nTileIdx))==0);
+        vnTileLabelCounts[nTileIdx] = cv::connectedComponents(oTileBackground,voTileLabels[nTileIdx],4,CV_32S);
+    }
+    // step 2: offset local labels to make them unique, and merge the components touching across tile seams
+    std::vector<int> vnTileLabelOffsets((size_t)nTileCount,0);
+    for(int nTileIdx=1; nTileIdx<nTileCount; ++nTileIdx)
+        vnTileLabelOffsets[nTileIdx] = vnTileLabelOffsets[nTileIdx-1]+vnTileLabelCounts[nTileIdx-1];
+    std::vector<int> vnLabelParents((size_t)(vnTileLabelOffsets.back()+vnTileLabelCounts.back()));
+    std::iota(vnLabelParents.begin(),vnLabelParents.end(),0);
+    const auto lFindRoot = [&](int nLabel) {
+        while(vnLabelParents[nLabel]!=nLabel)
+            nLabel = vnLabelParents[nLabel] = vnLabelParents[vnLabelParents[nLabel]];
+        return nLabel;
+    };
+    const auto lGetLabel = [&](int nTileIdx, int nRowIdx, int nColIdx) {
+        const cv::Rect oTileRect = lGetTileRect(nTileIdx);
+        const int nLocalLabel = voTileLabels[nTileIdx](nRowIdx-oTileRect.y,nColIdx-oTileRect.x);
+        return nLocalLabel?(vnTileLabelOffsets[nTileIdx]+nLocalLabel):-1;
+    };
+    const auto lMerge = [&](int nLabel1, int nLabel2) {
+        if(nLabel1>=0 && nLabel2>=0) {
+            const int nRoot1 = lFindRoot(nLabel1), nRoot2 = lFindRoot(nLabel2);
+            if(nRoot1!=nRoot2)
+                vnLabelParents[std::max(nRoot1,nRoot2)] = std::min(nRoot1,nRoot2);
+        }
+    };
+    for(int nTileRowIdx=0; nTileRowIdx<nTileRows; ++nTileRowIdx) {
+        for(int nTileColIdx=0; nTileColIdx<nTileCols; ++nTileColIdx) {
+            const int nTileIdx = nTileRowIdx*nTileCols+nTileColIdx;
+            const cv::Rect oTileRect = lGetTileRect(nTileIdx);
+            if(nTileColIdx>0) // left seam
+                for(int nRowIdx=oTileRect.y; nRowIdx<oTileRect.y+oTileRect.height; ++nRowIdx)
+                    lMerge(lGetLabel(nTileIdx,nRowIdx,oTileRect.x),lGetLabel(nTileIdx-1,nRowIdx,oTileRect.x-1));
+            if(nTileRowIdx>0) // top seam
+                for(int nColIdx=oTileRect.x; nColIdx<oTileRect.x+oTileRect.width; ++nColIdx)
+                    lMerge(lGetLabel(nTileIdx,oTileRect.y,nColIdx),lGetLabel(nTileIdx-nTileCols,oTileRect.y-1,nColIdx));
+        }
+    }
+    for(int nLabel=0; nLabel<(int)vnLabelParents.size(); ++nLabel)
+        vnLabelParents[nLabel] = lFindRoot(nLabel);
+    // step 3: all null pixels which do not belong to the seed's component are holes (if the seed is non-null, all null pixels are holes)
+    const int nSeedTileIdx = (oSeed.y/nTileHeight)*nTileCols+(oSeed.x/nTileWidth);
+    const int nSeedLabel = lGetLabel(nSeedTileIdx,oSeed.y,oSeed.x);
+    const int nSeedRoot = (nSeedLabel>=0)?vnLabelParents[nSeedLabel]:-1;
+    oHoles.create(nRows,nCols,CV_8UC1);
+#if USING_OPENMP
+#pragma omp parallel for
+#endif //USING_OPENMP
+    for(int nTileIdx=0; nTileIdx<nTileCount; ++nTileIdx) {
+        const cv::Rect oTileRect = lGetTileRect(nTileIdx);
+        const cv::Mat_<int>& oTileLabels = voTileLabels[nTileIdx];
+        const int nTileLabelOffset = vnTileLabelOffsets[nTileIdx];
+        for(int nRowIdx=0; nRowIdx<oTileRect.height; ++nRowIdx) {
+            const int* pnLabels = oTileLabels[nRowIdx];
+            uchar* pnHoles = oHoles.ptr<uchar>(oTileRect.y+nRowIdx)+oTileRect.x;
+            for(int nColIdx=0; nColIdx<oTileRect.width; ++nColIdx)
+                pnHoles[nColIdx] = uchar((pnLabels[nColIdx] && vnLabelParents[nTileLabelOffset+pnLabels[nColIdx]]!=nSeedRoot)?UCHAR_MAX:0);
+        }
+    }
+}
+
+namespace {
+
+    /// word type used to hold bit-packed binary rows in the line-buffered morph kernels
+    using PackedWord = uint64_t;
+    /// number of pixels held in each packed word
+    constexpr int s_nPackedWordBits = 64;
+
+    /// returns the number of packed words needed to hold a row of 'nCols' pixels
+    inline int getPackedWordCount(int nCols) {
+        return (nCols+s_nPackedWordBits-1)/s_nPackedWordBits;
+    }
+
+    /// packs a binary 8UC1 row into words (non-null pixels set their bit, pad bits stay null)
+    void packBinaryRow(const uchar* anRow, int nCols, PackedWord* anWords) {
+        for(int nColOffset=0, nWordIdx=0; nColOffset<nCols; nColOffset+=s_nPackedWordBits, ++nWordIdx) {
+            const int nWordCols = std::min(s_nPackedWordBits,nCols-nColOffset);
+            PackedWord nWord = 0;
+            for(int nChunkOffset=0; nChunkOffset<nWordCols; nChunkOffset+=8) {
+                const int nChunkCols = std::min(8,nWordCols-nChunkOffset);
+                uint64_t nChunk = 0;
+                memcpy(&nChunk,anRow+nColOffset+nChunkOffset,(size_t)nChunkCols);
+                if(nChunk) // masks are mostly null, so most chunks get skipped here
+                    for(int nBitIdx=nChunkOffset; nBitIdx<nChunkOffset+nChunkCols; ++nBitIdx)
+                        nWord |= PackedWord(anRow[nColOffset+nBitIdx]!=0)<<nBitIdx;
+            }
+            anWords[nWordIdx] = nWord;
+        }
+    }
+
+    /// unpacks words into a binary 8UC1 row (0/255)
+    void unpackBinaryRow(const PackedWord* anWords, int nCols, uchar* anRow) {
+        for(int nColOffset=0, nWordIdx=0; nColOffset<nCols; nColOffset+=s_nPackedWordBits, ++nWordIdx) {
+            const int nWordCols = std::min(s_nPackedWordBits,nCols-nColOffset);
+            const PackedWord nWord = anWords[nWordIdx];
+            if(!nWord)
+                memset(anRow+nColOffset,0,(size_t)nWordCols);
+            else
+                for(int nBitIdx=0; nBitIdx<nWordCols; ++nBitIdx)
+                    anRow[nColOffset+nBitIdx] = uchar(((nWord>>nBitIdx)&1)?UCHAR_MAX:0);
+        }
+    }
+
+    /// applies a horizontal erosion (or dilation) of radius 'nRadius' to a packed row, ignoring pixels outside [0,nCols) like opencv's default morph border
+    void morphBinaryRow(const PackedWord* anInput, int nCols, int nRadius, bool bErode, PackedWord* anOutput) {
+        lvDbgAssert(anInput!=anOutput && nRadius>=0 && nRadius<s_nPackedWordBits);
+        const int nWords = getPackedWordCount(nCols);
+        const PackedWord nFill = bErode?~PackedWord(0):PackedWord(0);
+        const PackedWord nLastWordMask = ~PackedWord(0)>>(nWords*s_nPackedWordBits-nCols);
+        const auto lGetWord = [&](int nWordIdx) {
+            if(nWordIdx<0 || nWordIdx>=nWords)
+                return nFill;
+            return (nWordIdx==nWords-1)?((anInput[nWordIdx]&nLastWordMask)|(nFill&~nLastWordMask)):anInput[nWordIdx];
+        };
+        for(int nWordIdx=0; nWordIdx<nWords; ++nWordIdx) {
+            const PackedWord nPrev = lGetWord(nWordIdx-1), nCurr = lGetWord(nWordIdx), nNext = lGetWord(nWordIdx+1);
+            PackedWord nResult = nCurr;
+            for(int nOffset=1; nOffset<=nRadius; ++nOffset) {
+                const PackedWord nRight = (nCurr>>nOffset)|(nNext<<(s_nPackedWordBits-nOffset)); // bit x now holds pixel x+nOffset
+                const PackedWord nLeft = (nCurr<<nOffset)|(nPrev>>(s_nPackedWordBits-nOffset)); // bit x now holds pixel x-nOffset
+                nResult = bErode?(nResult&nRight&nLeft):(nResult|nRight|nLeft);
+            }
+            anOutput[nWordIdx] = (nWordIdx==nWords-1)?(nResult&nLastWordMask):nResult;
+        }
+    }
+
+    /// ring buffer of packed rows, indexed by absolute row index
+    struct PackedRowRing {
+        PackedRowRing(int nRingRows, int nWords) : m_nRingRows(nRingRows), m_nWords(nWords), m_vWords(size_t(nRingRows*nWords)) {}
+        inline PackedWord* row(int nRowIdx) {return m_vWords.data()+(nRowIdx%m_nRingRows)*m_nWords;}
+        const int m_nRingRows, m_nWords;
+        std::vector<PackedWord> m_vWords;
+    };
+
+    /// computes row 'nRowIdx' of a rect erosion (or dilation) of radius 'nRadius' from the ring holding its input rows (rows outside [0,nRows) are ignored)
+    void morphBinaryRingRow(PackedRowRing& oRing, int nRowIdx, int nRows, int nCols, int nRadius, bool bErode, PackedWord* anTemp, PackedWord* anOutput) {
+        const int nFirstRowIdx = std::max(nRowIdx-nRadius,0), nLastRowIdx = std::min(nRowIdx+nRadius,nRows-1);
+        std::copy_n(oRing.row(nFirstRowIdx),oRing.m_nWords,anTemp);
+        for(int nOffsetRowIdx=nFirstRowIdx+1; nOffsetRowIdx<=nLastRowIdx; ++nOffsetRowIdx) {
+            const PackedWord* anRow = oRing.row(nOffsetRowIdx);
+            for(int nWordIdx=0; nWordIdx<oRing.m_nWords; ++nWordIdx)
+                anTemp[nWordIdx] = bErode?(anTemp[nWordIdx]&anRow[nWordIdx]):(anTemp[nWordIdx]|anRow[nWordIdx]);
+        }
+        morphBinaryRow(anTemp,nCols,nRadius,bErode,anOutput);
+    }
+
+} // anonymous namespace
+
+void lv::binaryClose(const cv::Mat& oInput, cv::Mat& oOutput, int nRadius) {
+    lvAssert_(!oInput.empty() && oInput.dims==2 && oInput.type()==CV_8UC1,"bad input matrix");
+    lvAssert_(nRadius>=0 && nRadius<s_nPackedWordBits,"bad morph radius");
+    const int nRows = oInput.rows, nCols = oInput.cols, nWords = getPackedWordCount(nCols);
+    oOutput.create(oInput.size(),CV_8UC1);
+    PackedRowRing oInputRing(2*nRadius+1,nWords), oDilatedRing(2*nRadius+1,nWords);
+    std::vector<PackedWord> vTemp((size_t)nWords), vEroded((size_t)nWords);
+    // rows are streamed through the dilation and then the erosion, each lagging its input by 'nRadius' rows
+    for(int nStepIdx=0; nStepIdx<nRows+nRadius*2; ++nStepIdx) {
+        if(nStepIdx<nRows)
+            packBinaryRow(oInput.ptr<uchar>(nStepIdx),nCols,oInputRing.row(nStepIdx));
+        const int nDilatedRowIdx = nStepIdx-nRadius;
+        if(nDilatedRowIdx>=0 && nDilatedRowIdx<nRows)
+            morphBinaryRingRow(oInputRing,nDilatedRowIdx,nRows,nCols,nRadius,false,vTemp.data(),oDilatedRing.row(nDilatedRowIdx));
+        const int nErodedRowIdx = nDilatedRowIdx-nRadius;
+        if(nErodedRowIdx>=0) {
+            morphBinaryRingRow(oDilatedRing,nErodedRowIdx,nRows,nCols,nRadius,true,vTemp.data(),vEroded.data());
+            unpackBinaryRow(vEroded.data(),nCols,oOutput.ptr<uchar>(nErodedRowIdx));
+        }
+    }
+}
+
+void lv::postProcessBinaryMask(const cv::Mat& oInput, const cv::Mat& oHoles, const cv::Mat& oClosed, cv::Mat& oOutput, int nMedianKernelSize,
+                               int nErodeRadius, cv::Mat* pDilated, int nDilateRadius) {
+    lvAssert_(!oInput.empty() && oInput.dims==2 && oInput.type()==CV_8UC1,"bad input matrix");
+    lvAssert_(oHoles.empty() || (oHoles.type()==CV_8UC1 && oHoles.size()==oInput.size()),"bad holes matrix");
+    lvAssert_(oClosed.empty() || (oClosed.type()==CV_8UC1 && oClosed.size()==oInput.size()),"bad closed matrix");
+    lvAssert_(nMedianKernelSize>0 && (nMedianKernelSize%2)==1,"bad median kernel size");
+    lvAssert_(nErodeRadius>=0 && nErodeRadius<s_nPackedWordBits && nDilateRadius>=0 && nDilateRadius<s_nPackedWordBits,"bad morph radius");
+    lvAssert_(!pDilated || pDilated->data!=oOutput.data || oOutput.empty(),"dilated output must not overlap the filtered output");
+    const int nRows = oInput.rows, nCols = oInput.cols, nWords = getPackedWordCount(nCols);
+    const int nMedianRadius = nMedianKernelSize/2, nMedianThreshold = (nMedianKernelSize*nMedianKernelSize)/2;
+    const int nErodeLag = oClosed.empty()?0:nErodeRadius, nDilateLag = pDilated?nDilateRadius:0;
+    oOutput.create(oInput.size(),CV_8UC1);
+    if(pDilated)
+        pDilated->create(oInput.size(),CV_8UC1);
+    // the median window needs one extra row so that the row leaving it can still be subtracted from the column counts
+    PackedRowRing oClosedRing(2*nErodeLag+1,nWords), oCombinedRing(2*nMedianRadius+2,nWords), oFilteredRing(2*nDilateLag+1,nWords);
+    std::vector<PackedWord> vTemp((size_t)nWords), vRow((size_t)nWords);
+    std::vector<int> vnColCounts((size_t)nCols,0);
+    const auto lClamp = [](int nIdx, int nSize) {return std::min(std::max(nIdx,0),nSize-1);};
+    const auto lUpdateColCounts = [&](const PackedWord* anAdded, const PackedWord* anRemoved) {
+        // only the bits which differ between the added & removed rows can change the counts
+        for(int nWordIdx=0; nWordIdx<nWords; ++nWordIdx) {
+            PackedWord nAdded = anAdded[nWordIdx];
+            PackedWord nDiff = nAdded^(anRemoved?anRemoved[nWordIdx]:PackedWord(0));
+            for(int* pnColCount=vnColCounts.data()+nWordIdx*s_nPackedWordBits; nDiff; ++pnColCount, nDiff>>=1, nAdded>>=1)
+                if(nDiff&1)
+                    *pnColCount += (nAdded&1)?1:-1;
+        }
+    };
+    // rows are streamed through the erosion+union, the median (replicated borders, like cv::medianBlur) and the dilation, each lagging by its radius
+    for(int nStepIdx=0; nStepIdx<nRows+nErodeLag+nMedianRadius+nDilateLag; ++nStepIdx) {
+        if(!oClosed.empty() && nStepIdx<nRows)
+            packBinaryRow(oClosed.ptr<uchar>(nStepIdx),nCols,oClosedRing.row(nStepIdx));
+        const int nCombinedRowIdx = nStepIdx-nErodeLag;
+        if(nCombinedRowIdx>=0 && nCombinedRowIdx<nRows) {
+            PackedWord* anCombined = oCombinedRing.row(nCombinedRowIdx);
+            if(!oClosed.empty())
+                morphBinaryRingRow(oClosedRing,nCombinedRowIdx,nRows,nCols,nErodeRadius,true,vTemp.data(),anCombined);
+            else
+                std::fill_n(anCombined,nWords,PackedWord(0));
+            packBinaryRow(oInput.ptr<uchar>(nCombinedRowIdx),nCols,vRow.data());
+            for(int nWordIdx=0; nWordIdx<nWords; ++nWordIdx)
+                anCombined[nWordIdx] |= vRow[nWordIdx];
+            if(!oHoles.empty()) {
+                packBinaryRow(oHoles.ptr<uchar>(nCombinedRowIdx),nCols,vRow.data());
+                for(int nWordIdx=0; nWordIdx<nWords; ++nWordIdx)
+                    anCombined[nWordIdx] |= vRow[nWordIdx];
+            }
+        }
+        const int nFilteredRowIdx = nCombinedRowIdx-nMedianRadius;
+        if(nFilteredRowIdx>=0 && nFilteredRowIdx<nRows) {
+            if(nFilteredRowIdx==0)
+                for(int nOffset=-nMedianRadius; nOffset<=nMedianRadius; ++nOffset)
+                    lUpdateColCounts(oCombinedRing.row(lClamp(nOffset,nRows)),nullptr);
+            else
+                lUpdateColCounts(oCombinedRing.row(lClamp(nFilteredRowIdx+nMedianRadius,nRows)),oCombinedRing.row(lClamp(nFilteredRowIdx-nMedianRadius-1,nRows)));
+            PackedWord* anFiltered = pDilated?oFilteredRing.row(nFilteredRowIdx):vRow.data();
+            std::fill_n(anFiltered,nWords,PackedWord(0));
+            int nWindowCount = 0;
+            for(int nOffset=-nMedianRadius; nOffset<=nMedianRadius; ++nOffset)
+                nWindowCount += vnColCounts[lClamp(nOffset,nCols)];
+            for(int nColIdx=0; nColIdx<nCols; ++nColIdx) {
+                if(nWindowCount>nMedianThreshold)
+                    anFiltered[nColIdx/s_nPackedWordBits] |= PackedWord(1)<<(nColIdx%s_nPackedWordBits);
+                nWindowCount += vnColCounts[lClamp(nColIdx+nMedianRadius+1,nCols)]-vnColCounts[lClamp(nColIdx-nMedianRadius,nCols)];
+            }
+            unpackBinaryRow(anFiltered,nCols,oOutput.ptr<uchar>(nFilteredRowIdx));
+        }
+        const int nDilatedRowIdx = nFilteredRowIdx-nDilateLag;
+        if(pDilated && nDilatedRowIdx>=0 && nDilatedRowIdx<nRows) {
+            morphBinaryRingRow(oFilteredRing,nDilatedRowIdx,nRows,nCols,nDilateRadius,false,vTemp.data(),vRow.data());
+            unpackBinaryRow(vRow.data(),nCols,pDilated->ptr<uchar>(nDilatedRowIdx));
+        }
+    }
+}
+
 void lv::computeImageAffinity(const cv::Mat& oImage1, const cv::Mat& oImage2, int nPatchSize,
                               cv::Mat_<float>& oAffinityMap, const std::vector<int>& vDispRange, AffinityDistType eDist,
                               const cv::Mat_<uchar>& oROI1, const cv::Mat_<uchar>& oROI2) {
@@ -728,6 +993,35 @@ void lv::computeTemporalAbsDiff(const cv::Mat& oImage1, const cv::Mat& oImage2,
         cv::GaussianBlur(oOutput,oOutput,cv::Size(nSmoothKernelSize,nSmoothKernelSize),0);
 }
 
+void lv::computeBlockTemporalAbsDiff(const cv::Mat& oImage1, const cv::Mat& oImage2, int nBlockSize, cv::Mat& oOutput) {
+    lvAssert_(!oImage1.empty() && !oImage2.empty() && nBlockSize>0,"invalid parameter(s)");
+    lvAssert_(oImage1.dims==2 && oImage1.depth()==CV_8U && lv::MatInfo(oImage1)==lv::MatInfo(oImage2),"invalid image type/size");
+    lvAssert_(size_t(nBlockSize)*nBlockSize*oImage1.channels()*UCHAR_MAX<=size_t(UINT_MAX),"block size too large");
+    const int nRows = oImage1.rows, nCols = oImage1.cols, nChannels = oImage1.channels();
+    const int nBlockRows = (nRows+nBlockSize-1)/nBlockSize, nBlockCols = (nCols+nBlockSize-1)/nBlockSize;
+    oOutput.create(nBlockRows,nBlockCols,CV_32FC1);
+    std::vector<uint32_t> vnBlockSums((size_t)nBlockCols);
+    for(int nBlockRowIdx=0; nBlockRowIdx<nBlockRows; ++nBlockRowIdx) {
+        const int nRowBeg = nBlockRowIdx*nBlockSize, nRowEnd = std::min(nRowBeg+nBlockSize,nRows);
+        std::fill(vnBlockSums.begin(),vnBlockSums.end(),0u);
+        for(int nRowIdx=nRowBeg; nRowIdx<nRowEnd; ++nRowIdx) {
+            const uint8_t* pRow1 = oImage1.ptr<uint8_t>(nRowIdx);
+            const uint8_t* pRow2 = oImage2.ptr<uint8_t>(nRowIdx);
+            for(int nBlockColIdx=0; nBlockColIdx<nBlockCols; ++nBlockColIdx) {
+                const int nElemBeg = nBlockColIdx*nBlockSize*nChannels, nElemEnd = std::min(nElemBeg+nBlockSize*nChannels,nCols*nChannels);
+                uint32_t nSum = 0; // plain loop over contiguous bytes, auto-vectorized
+                for(int nElemIdx=nElemBeg; nElemIdx<nElemEnd; ++nElemIdx)
+                    nSum += (uint32_t)std::abs((int)pRow1[nElemIdx]-(int)pRow2[nElemIdx]);
+                vnBlockSums[nBlockColIdx] += nSum;
+            }
+        }
+        for(int nBlockColIdx=0; nBlockColIdx<nBlockCols; ++nBlockColIdx) {
+            const int nBlockWidth = std::min(nBlockSize,nCols-nBlockColIdx*nBlockSize);
+            oOutput.at<float>(nBlockRowIdx,nBlockColIdx) = float(vnBlockSums[nBlockColIdx])/((nRowEnd-nRowBeg)*nBlockWidth*nChannels);
+        }
+    }
+}
+
 void lv::remap_offset(const cv::Mat& oInput, cv::Mat& oOutput, const cv::Mat& oOffsetMap, int nInterpType, int nBorderMode, const cv::Scalar& vBorderValue) {
     lvAssert_(!oInput.empty() && !oOffsetMap.empty() && oOffsetMap.type()==CV_32FC2,"invalid params");
     lvAssert_(oInput.dims==2 && lv::MatSize(oInput)==lv::MatSize(oOffsetMap),"invalid map size");
@@ -567,6 +567,105 @@ TEST(integral,regression) {
     }
 }
 
+TEST(computeBlockTemporalAbsDiff,regression) {
+    for(size_t i=0u; i<50u; ++i) {
+        const int nChannels = (rand()%2)?3:1;
+        cv::Mat oImage1((rand()%200)+1,(rand()%200)+1,CV_8UC(nChannels)), oImage2(oImage1.size(),oImage1.type());
+        cv::randu(oImage1,0,256);
+        cv::randu(oImage2,0,256);
+        const int nBlockSize = (rand()%20)+1;
+        cv::Mat oOutput,oAbsDiff;
+        lv::computeBlockTemporalAbsDiff(oImage1,oImage2,nBlockSize,oOutput);
+        ASSERT_EQ(oOutput.type(),CV_32FC1);
+        ASSERT_EQ(oOutput.rows,(oImage1.rows+nBlockSize-1)/nBlockSize);
+        ASSERT_EQ(oOutput.cols,(oImage1.cols+nBlockSize-1)/nBlockSize);
+        cv::absdiff(oImage1,oImage2,oAbsDiff);
+        for(int nBlockRowIdx=0; nBlockRowIdx<oOutput.rows; ++nBlockRowIdx) {
+            for(int nBlockColIdx=0; nBlockColIdx<oOutput.cols; ++nBlockColIdx) {
+                const cv::Rect oBlockRect = cv::Rect(nBlockColIdx*nBlockSize,nBlockRowIdx*nBlockSize,nBlockSize,nBlockSize)&cv::Rect(cv::Point(),oImage1.size());
+                const cv::Scalar vMean = cv::mean(oAbsDiff(oBlockRect));
+                const double dMean = (vMean[0]+vMean[1]+vMean[2])/nChannels;
+                ASSERT_NEAR(oOutput.at<float>(nBlockRowIdx,nBlockColIdx),dMean,1e-3);
+            }
+        }
+    }
+    const cv::Mat oImage(64,64,CV_8UC3,cv::Scalar::all(42));
+    cv::Mat oOutput;
+    lv::computeBlockTemporalAbsDiff(oImage,oImage,16,oOutput);
+    ASSERT_EQ(cv::countNonZero(oOutput),0);
+}
+
+TEST(computeEnclosedHoles,regression) {
+    for(size_t i=0u; i<50u; ++i) {
+        cv::Mat oInput((rand()%200)+1,(rand()%200)+1,CV_8UC1,cv::Scalar_<uchar>(0));
+        for(int nBlobIdx=0; nBlobIdx<10; ++nBlobIdx)
+            cv::circle(oInput,cv::Point(rand()%oInput.cols,rand()%oInput.rows),(rand()%20)+1,cv::Scalar_<uchar>(255),(rand()%3)+1);
+        const cv::Point oSeed = (i%4)?cv::Point(0,0):cv::Point(rand()%oInput.cols,rand()%oInput.rows);
+        cv::Mat oHolesRef = oInput.clone();
+        cv::floodFill(oHolesRef,oSeed,UCHAR_MAX);
+        cv::bitwise_not(oHolesRef,oHolesRef);
+        for(const cv::Size& oTileSize : {cv::Size(),cv::Size(16,16),cv::Size((rand()%50)+1,(rand()%50)+1)}) {
+            cv::Mat oHoles;
+            lv::computeEnclosedHoles(oInput,oHoles,oTileSize,oSeed);
+            ASSERT_EQ(oHoles.type(),CV_8UC1);
+            ASSERT_EQ(oHoles.size(),oInput.size());
+            ASSERT_EQ(cv::countNonZero(oHoles!=oHolesRef),0) << "i=" << i << ", tile=" << oTileSize;
+        }
+    }
+    const cv::Mat oFullImage(64,64,CV_8UC1,cv::Scalar_<uchar>(255));
+    cv::Mat oHoles;
+    lv::computeEnclosedHoles(oFullImage,oHoles,cv::Size(8,8));
+    ASSERT_EQ(cv::countNonZero(oHoles),0);
+}
+
+TEST(binaryClose,regression) {
+    for(size_t i=0u; i<50u; ++i) {
+        cv::Mat oInput((rand()%200)+1,(rand()%200)+1,CV_8UC1,cv::Scalar_<uchar>(0));
+        for(int nBlobIdx=0; nBlobIdx<10; ++nBlobIdx)
+            cv::circle(oInput,cv::Point(rand()%oInput.cols,rand()%oInput.rows),(rand()%20)+1,cv::Scalar_<uchar>(255),(rand()%3)+1);
+        for(int nRadius=0; nRadius<=2; ++nRadius) {
+            cv::Mat oOutputRef, oOutput;
+            cv::morphologyEx(oInput,oOutputRef,cv::MORPH_CLOSE,cv::getStructuringElement(cv::MORPH_RECT,cv::Size(nRadius*2+1,nRadius*2+1)));
+            lv::binaryClose(oInput,oOutput,nRadius);
+            ASSERT_EQ(oOutput.size(),oInput.size());
+            ASSERT_EQ(cv::countNonZero(oOutput!=oOutputRef),0) << "i=" << i << ", nRadius=" << nRadius;
+        }
+    }
+}
+
+TEST(postProcessBinaryMask,regression) {
+    for(size_t i=0u; i<50u; ++i) {
+        const cv::Size oSize((rand()%200)+1,(rand()%200)+1);
+        cv::Mat oInput(oSize,CV_8UC1,cv::Scalar_<uchar>(0)), oNoise(oSize,CV_8UC1);
+        for(int nBlobIdx=0; nBlobIdx<10; ++nBlobIdx)
+            cv::circle(oInput,cv::Point(rand()%oInput.cols,rand()%oInput.rows),(rand()%20)+1,cv::Scalar_<uchar>(255),(rand()%3)+1);
+        cv::randu(oNoise,0,256);
+        cv::bitwise_or(oInput,(oNoise>240),oInput);
+        cv::Mat oClosed, oHoles;
+        cv::morphologyEx(oInput,oClosed,cv::MORPH_CLOSE,cv::Mat());
+        oHoles = oClosed.clone();
+        cv::floodFill(oHoles,cv::Point(0,0),UCHAR_MAX);
+        cv::bitwise_not(oHoles,oHoles);
+        for(int nMedianKernelSize : {1,3,9,(rand()%7)*2+5}) {
+            // same chain as the one used to post-process foreground masks in the LBSP-based subtractors
+            cv::Mat oEroded, oCombined = oInput.clone(), oOutputRef, oDilatedRef;
+            cv::erode(oClosed,oEroded,cv::Mat(),cv::Point(-1,-1),3);
+            cv::bitwise_or(oCombined,oHoles,oCombined);
+            cv::bitwise_or(oCombined,oEroded,oCombined);
+            cv::medianBlur(oCombined,oOutputRef,nMedianKernelSize);
+            cv::dilate(oOutputRef,oDilatedRef,cv::Mat(),cv::Point(-1,-1),3);
+            cv::Mat oOutput, oDilated;
+            lv::postProcessBinaryMask(oInput,oHoles,oClosed,oOutput,nMedianKernelSize,3,&oDilated,3);
+            ASSERT_EQ(cv::countNonZero(oOutput!=oOutputRef),0) << "i=" << i << ", nMedianKernelSize=" << nMedianKernelSize;
+            ASSERT_EQ(cv::countNonZero(oDilated!=oDilatedRef),0) << "i=" << i << ", nMedianKernelSize=" << nMedianKernelSize;
+            // without holes, eroded mask & dilated output, this is a plain binary median blur
+            cv::medianBlur(oInput,oOutputRef,nMedianKernelSize);
+            lv::postProcessBinaryMask(oInput,cv::Mat(),cv::Mat(),oOutput,nMedianKernelSize);
+            ASSERT_EQ(cv::countNonZero(oOutput!=oOutputRef),0) << "i=" << i << ", nMedianKernelSize=" << nMedianKernelSize;
+        }
+    }
+}
+
 namespace {
 
     void medianBlur_perftest(benchmark::State& st) {
@@ -624,6 +723,32 @@ namespace {
         }
     }
 
+    void postProcessBinaryMask_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const bool bUseFusedKernel = st.range(2)!=0;
+        cv::Mat oInput(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+        for(int nBlobIdx=0; nBlobIdx<20; ++nBlobIdx)
+            cv::circle(oInput,cv::Point(rand()%oSize.width,rand()%oSize.height),(rand()%50)+5,cv::Scalar_<uchar>(255),-1);
+        cv::Mat oClosed, oHoles, oEroded, oCombined, oOutput, oDilated;
+        while(st.KeepRunning()) {
+            if(bUseFusedKernel)
+                lv::binaryClose(oInput,oClosed);
+            else
+                cv::morphologyEx(oInput,oClosed,cv::MORPH_CLOSE,cv::Mat());
+            lv::computeEnclosedHoles(oClosed,oHoles);
+            if(bUseFusedKernel)
+                lv::postProcessBinaryMask(oInput,oHoles,oClosed,oOutput,9,3,&oDilated,3);
+            else {
+                cv::erode(oClosed,oEroded,cv::Mat(),cv::Point(-1,-1),3);
+                cv::bitwise_or(oInput,oHoles,oCombined);
+                cv::bitwise_or(oCombined,oEroded,oCombined);
+                cv::medianBlur(oCombined,oOutput,9);
+                cv::dilate(oOutput,oDilated,cv::Mat(),cv::Point(-1,-1),3);
+            }
+            benchmark::DoNotOptimize(oDilated.data);
+        }
+    }
+
 }
 
 BENCHMARK(medianBlur_perftest)->Args({50,3})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
@@ -645,3 +770,5 @@ BENCHMARK(medianBlur_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->R
 BENCHMARK(binaryMedianBlur_conv_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryMedianBlur_raw_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
 BENCHMARK(binaryConsensus_perftest)->Args({800,11})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
+
+BENCHMARK(postProcessBinaryMask_perftest)->Args({1280,720,0})->Args({1280,720,1})->Args({1920,1080,0})->Args({1920,1080,1})->Unit(benchmark::kMicrosecond)->Repetitions(10)->ReportAggregatesOnly(true);
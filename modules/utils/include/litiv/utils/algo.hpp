@@ -41,6 +41,7 @@ namespace lv {
 #if HAVE_OPENCL
         OpenCL,
 #endif //HAVE_OPENCL
+        CPUThreads,
         NonParallel
     };
 
@@ -142,6 +143,42 @@ namespace lv {
 
 #endif //USE_CVCORE_WITH_UTILS
 
+    /// multi-core CPU algo interface specialization; owns the worker pool used to process independent work items concurrently
+    template<>
+    struct IParallelAlgo_<CPUThreads> : public IIParallelAlgo {
+        /// default constructor; a null thread count means one worker per hardware thread
+        IParallelAlgo_(size_t nThreadCount=0) :
+                m_pWorkerPool(std::make_unique<lv::WorkStealingPool>(nThreadCount)) {}
+        /// sets the number of worker threads (0 = one per hardware thread); pending work is completed first
+        void setThreadCount(size_t nThreadCount) {
+            m_pWorkerPool.reset();
+            m_pWorkerPool = std::make_unique<lv::WorkStealingPool>(nThreadCount);
+        }
+        /// returns the number of worker threads
+        size_t getThreadCount() const {return m_pWorkerPool->getWorkerCount();}
+        /// returns whether the algorithm is implemented for parallel processing or not
+        virtual bool isParallel() const override final {return true;}
+        /// returns which type of parallel implementation is used in this algo
+        virtual ParallelAlgoType getParallelAlgoType() const override final {return CPUThreads;}
+    protected:
+        /// runs 'lTaskFunc(nTaskIdx)' for all indices in [0,nTaskCount) on the worker pool, and blocks until all are done (rethrows the first exception, in index order)
+        template<typename Tfunc>
+        void parallelFor(size_t nTaskCount, Tfunc&& lTaskFunc) {
+            lvAssert_(m_pWorkerPool->getCurrentWorkerIdx()==SIZE_MAX,"cannot run parallel work from one of the algo's own workers");
+            std::vector<std::future<void>> voTaskResults;
+            voTaskResults.reserve(nTaskCount);
+            for(size_t nTaskIdx=0; nTaskIdx<nTaskCount; ++nTaskIdx)
+                voTaskResults.push_back(m_pWorkerPool->queueTask([&lTaskFunc,nTaskIdx](){lTaskFunc(nTaskIdx);}));
+            for(std::future<void>& oTaskResult : voTaskResults)
+                oTaskResult.wait(); // all tasks must be done before any exception is forwarded, as they reference caller data
+            for(std::future<void>& oTaskResult : voTaskResults)
+                oTaskResult.get();
+        }
+        /// worker pool used to process parallel work items
+        std::unique_ptr<lv::WorkStealingPool> m_pWorkerPool;
+    };
+    using IParallelAlgo_CPUThreads = IParallelAlgo_<CPUThreads>;
+
     /// default (non-parallel) algo interface specialization; overrides virtual pure functions from base class only
     template<>
     struct IParallelAlgo_<NonParallel> : public IIParallelAlgo {
@@ -23,6 +23,7 @@
 #include <mutex>
 #include <array>
 #include <queue>
+#include <deque>
 #include <tuple>
 #include <utility>
 #include <type_traits>
@@ -422,6 +423,43 @@ namespace lv {
         void entry();
     };
 
+    /// implements a work-stealing thread pool with a runtime worker count (tasks queued from a worker stay on its local deque unless stolen)
+    struct WorkStealingPool {
+        /// default constructor; creates 'nWorkers' threads to process queued tasks (0 = one per hardware thread)
+        explicit WorkStealingPool(size_t nWorkers=0);
+        /// default destructor; will block until all queued tasks (including the ones they queue) have been processed
+        ~WorkStealingPool();
+        /// queues a task to be processed by the pool (the task must not throw; use 'queueTask' to get exceptions back via a future)
+        void submit(std::function<void()> lTask);
+        /// queues a task to be processed by the pool, and returns a future tied to its result
+        template<typename Tfunc, typename... Targs>
+        std::future<std::result_of_t<Tfunc(Targs...)>> queueTask(Tfunc&& lTaskEntryPoint, Targs&&... args);
+        /// blocks until all queued tasks have been processed
+        void waitIdle();
+        /// returns the number of worker threads used by the pool
+        inline size_t getWorkerCount() const {return m_vhWorkers.size();}
+        /// returns the index of the calling worker thread in this pool, or SIZE_MAX if called from outside the pool
+        size_t getCurrentWorkerIdx() const;
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    protected:
+        /// per-worker task deque (owner pops from the back, thieves pop from the front)
+        struct TaskQueue {
+            std::mutex oMutex;
+            std::deque<std::function<void()>> qTasks;
+        };
+        std::vector<std::unique_ptr<TaskQueue>> m_vpQueues;
+        std::vector<std::thread> m_vhWorkers;
+        std::mutex m_oSyncMutex;
+        std::condition_variable m_oSyncVar,m_oIdleVar;
+        size_t m_nQueuedTasks,m_nUnfinishedTasks;
+        std::atomic_size_t m_nNextQueueIdx;
+        bool m_bIsActive;
+    private:
+        bool popTask(size_t nWorkerIdx, std::function<void()>& lTask);
+        void entry(size_t nWorkerIdx);
+    };
+
     /// stopwatch/chrono helper class; relies on std::chrono::high_resolution_clock internally
     struct StopWatch {
         /// default constructor; calls 'tick' for member initialization
@@ -1098,6 +1136,16 @@ void lv::WorkerPool<nWorkers>::entry() {
     }
 }
 
+template<typename Tfunc, typename... Targs>
+std::future<std::result_of_t<Tfunc(Targs...)>> lv::WorkStealingPool::queueTask(Tfunc&& lTaskEntryPoint, Targs&&... args) {
+    using task_return_t = std::result_of_t<Tfunc(Targs...)>;
+    using task_t = std::packaged_task<task_return_t()>;
+    std::shared_ptr<task_t> pSharableTask = std::make_shared<task_t>(std::bind(std::forward<Tfunc>(lTaskEntryPoint),std::forward<Targs>(args)...));
+    std::future<task_return_t> oTaskRes = pSharableTask->get_future();
+    submit([pSharableTask](){(*pSharableTask)();}); // if the execution throws, the exception will be contained in the shared state
+    return oTaskRes;
+}
+
 template<typename TVal, size_t nStaticSize, size_t nByteAlign>
 lv::AutoBuffer<TVal,nStaticSize,nByteAlign>::AutoBuffer(size_type nReqSize) {
     if(nReqSize<=m_aStaticBuffer.size()) {
@@ -132,6 +132,37 @@ namespace lv {
     }
 #endif //HAVE_SSE2
 
+    /// 4-way fastrand LCG generator w/ unaligned state storage (vectorized if SSE2 is available, and four scalar fastrand LCGs otherwise)
+    struct FastRandGen4 {
+        /// resets the generator state using the given seed
+        inline void seed(uint32_t nSeed) {
+        #if HAVE_SSE2
+            __m128i anGenerator;
+            sfastrand_vec(nSeed,anGenerator);
+            _mm_storeu_si128((__m128i*)anState.data(),anGenerator);
+        #else //(!HAVE_SSE2)
+            for(size_t n=0; n<anState.size(); ++n)
+                anState[n] = nSeed+uint32_t(n);
+        #endif //(!HAVE_SSE2)
+        }
+        /// fills the given array with four new 15-bit random values (like std::rand)
+        inline void next(std::array<uint32_t,4>& anResult) {
+        #if HAVE_SSE2
+            __m128i anGenerator = _mm_loadu_si128((const __m128i*)anState.data());
+            fastrand_vec<false,true>(anResult,anGenerator);
+            _mm_storeu_si128((__m128i*)anState.data(),anGenerator);
+        #else //(!HAVE_SSE2)
+            for(size_t n=0; n<anState.size(); ++n) {
+                int nSeed = (int)anState[n];
+                anResult[n] = (uint32_t)fastrand(nSeed);
+                anState[n] = (uint32_t)nSeed;
+            }
+        #endif //(!HAVE_SSE2)
+        }
+        /// internal generator state
+        std::array<uint32_t,4> anState;
+    };
+
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wstrict-aliasing"
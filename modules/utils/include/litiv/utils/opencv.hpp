@@ -1428,12 +1428,17 @@ namespace lv {
         MatArchive_BINARY_LZ4,
 #endif //USING_LZ4
         MatArchive_BINARY,
+        MatArchive_BINARY_BITPACKED, ///< 1-bit-per-element binary archive (CV_8UC1 matrices only; non-zero values are read back as 255)
     };
 
     /// writes matrix data locally using a binary/yml/text file format
     void write(const std::string& sFilePath, const cv::Mat& _oData, MatArchiveList eArchiveType=MatArchive_BINARY);
+    /// writes matrix data to a stream using a binary format (archives can be chained, and may start at any stream offset)
+    void write(std::ostream& ssStr, const cv::Mat& _oData, MatArchiveList eArchiveType=MatArchive_BINARY);
     /// reads matrix data locally using a binary/yml/text file format
     void read(const std::string& sFilePath, cv::Mat& oData, MatArchiveList eArchiveType=MatArchive_BINARY);
+    /// reads matrix data from a stream using a binary format (the stream is left positioned right after the archive)
+    void read(std::istream& ssStr, cv::Mat& oData, MatArchiveList eArchiveType=MatArchive_BINARY);
     /// reads matrix data locally using a binary/yml/text file format (inline version)
     inline cv::Mat read(const std::string& sFilePath, MatArchiveList eArchiveType=MatArchive_BINARY) {
         cv::Mat oData;
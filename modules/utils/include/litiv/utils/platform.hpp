@@ -37,6 +37,8 @@ namespace lv {
     bool createDirIfNotExist(const std::string& sDirPath);
     /// creates a binary file at the specified location, and fills it with unspecified/zero data bytes (useful for critical/real-time stream writing without continuous reallocation)
     std::fstream createBinFileWithPrealloc(const std::string& sFilePath, size_t nPreallocBytes, bool bZeroInit=false);
+    /// maps a local file to memory with copy-on-write semantics (pages are read on first access, and writes are never flushed back); the mapping is released with the returned pointer
+    std::shared_ptr<uint8_t> mapFileToMemory(const std::string& sFilePath, size_t& nFileSize);
     /// registers the SIGINT, SIGTERM, and SIGBREAK (if available) console signals to the given handler
     void registerAllConsoleSignals(void(*lHandler)(int));
     /// returns the amount of physical memory currently used on the system
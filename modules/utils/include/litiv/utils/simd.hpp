@@ -128,8 +128,51 @@ namespace lv {
     #endif //(!HAVE_SSE4_1)
     }
 
+    /// returns the absolute difference of two sets of eight 16-bit signed integers (values must be in [-16384,16383] to avoid overflow)
+    inline __m128i absdiff_16i(const __m128i& a, const __m128i& b) {
+        return _mm_sub_epi16(_mm_max_epi16(a,b),_mm_min_epi16(a,b));
+    }
+
+    /// returns the absolute difference of two sets of sixteen 8-bit unsigned integers
+    inline __m128i absdiff_8ui(const __m128i& a, const __m128i& b) {
+        return _mm_or_si128(_mm_subs_epu8(a,b),_mm_subs_epu8(b,a));
+    }
+
+    /// returns the sums of squares of three sets of 16-bit integers as four 32-bit integers, using the low/high half of each set (values must be in [-23170,23170] to avoid overflow)
+    template<bool bLowLanes>
+    inline __m128i sqrsum3_16i(const __m128i& a, const __m128i& b, const __m128i& c) {
+        const __m128i anAB = bLowLanes?_mm_unpacklo_epi16(a,b):_mm_unpackhi_epi16(a,b);
+        const __m128i anC0 = bLowLanes?_mm_unpacklo_epi16(c,_mm_setzero_si128()):_mm_unpackhi_epi16(c,_mm_setzero_si128());
+        return _mm_add_epi32(_mm_madd_epi16(anAB,anAB),_mm_madd_epi16(anC0,anC0));
+    }
+
+    /// returns the number of bits set in each of the eight 16-bit unsigned integers of the given array
+    inline __m128i popcount_16ui(const __m128i& anBuffer) {
+        const __m128i anBits2 = _mm_sub_epi16(anBuffer,_mm_and_si128(_mm_srli_epi16(anBuffer,1),_mm_set1_epi16(0x5555)));
+        const __m128i anBits4 = _mm_add_epi16(_mm_and_si128(anBits2,_mm_set1_epi16(0x3333)),_mm_and_si128(_mm_srli_epi16(anBits2,2),_mm_set1_epi16(0x3333)));
+        const __m128i anBits8 = _mm_and_si128(_mm_add_epi16(anBits4,_mm_srli_epi16(anBits4,4)),_mm_set1_epi16(0x0F0F));
+        return _mm_and_si128(_mm_add_epi16(anBits8,_mm_srli_epi16(anBits8,8)),_mm_set1_epi16(0x001F));
+    }
+
 #endif //HAVE_SSE2
 
+#if HAVE_AVX2
+
+    /// returns the absolute difference of two sets of sixteen 16-bit signed integers (values must be in [-16384,16383] to avoid overflow)
+    inline __m256i absdiff_16i(const __m256i& a, const __m256i& b) {
+        return _mm256_sub_epi16(_mm256_max_epi16(a,b),_mm256_min_epi16(a,b));
+    }
+
+    /// returns the number of bits set in each of the sixteen 16-bit unsigned integers of the given array
+    inline __m256i popcount_16ui(const __m256i& anBuffer) {
+        const __m256i anBits2 = _mm256_sub_epi16(anBuffer,_mm256_and_si256(_mm256_srli_epi16(anBuffer,1),_mm256_set1_epi16(0x5555)));
+        const __m256i anBits4 = _mm256_add_epi16(_mm256_and_si256(anBits2,_mm256_set1_epi16(0x3333)),_mm256_and_si256(_mm256_srli_epi16(anBits2,2),_mm256_set1_epi16(0x3333)));
+        const __m256i anBits8 = _mm256_and_si256(_mm256_add_epi16(anBits4,_mm256_srli_epi16(anBits4,4)),_mm256_set1_epi16(0x0F0F));
+        return _mm256_and_si256(_mm256_add_epi16(anBits8,_mm256_srli_epi16(anBits8,8)),_mm256_set1_epi16(0x001F));
+    }
+
+#endif //HAVE_AVX2
+
 #if HAVE_SSE4_1
 
     /// returns the minimum value of the provided 16-unsigned-byte array
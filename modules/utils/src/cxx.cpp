@@ -175,4 +175,110 @@ void lv::setVerbosity(int nLevel) {
     g_nVerbosity = nLevel;
 }
 
-void lv::doNotOptimizeCharPointer(char const volatile*) {}
\ No newline at end of file
+void lv::doNotOptimizeCharPointer(char const volatile*) {}
+
+namespace {
+
+    /// pool & worker index of the calling thread (used to keep tasks queued from a worker on its own deque)
+    thread_local const lv::WorkStealingPool* g_pCurrWorkerPool = nullptr;
+    thread_local size_t g_nCurrWorkerIdx = SIZE_MAX;
+
+} // anonymous namespace
+
+lv::WorkStealingPool::WorkStealingPool(size_t nWorkers) :
+        m_nQueuedTasks(0),
+        m_nUnfinishedTasks(0),
+        m_nNextQueueIdx(0),
+        m_bIsActive(true) {
+    if(nWorkers==0)
+        nWorkers = std::max(std::thread::hardware_concurrency(),1u);
+    for(size_t nWorkerIdx=0; nWorkerIdx<nWorkers; ++nWorkerIdx)
+        m_vpQueues.push_back(std::make_unique<TaskQueue>());
+    for(size_t nWorkerIdx=0; nWorkerIdx<nWorkers; ++nWorkerIdx)
+        m_vhWorkers.emplace_back(&WorkStealingPool::entry,this,nWorkerIdx);
+}
+
+lv::WorkStealingPool::~WorkStealingPool() {
+    {
+        lv::mutex_lock_guard oLock(m_oSyncMutex);
+        m_bIsActive = false;
+        m_oSyncVar.notify_all();
+    }
+    for(std::thread& oWorker : m_vhWorkers)
+        oWorker.join();
+}
+
+void lv::WorkStealingPool::submit(std::function<void()> lTask) {
+    lvAssert_(lTask,"cannot queue an empty task");
+    const size_t nCurrWorkerIdx = getCurrentWorkerIdx();
+    const size_t nQueueIdx = (nCurrWorkerIdx!=SIZE_MAX)?nCurrWorkerIdx:(m_nNextQueueIdx++%m_vpQueues.size());
+    {
+        lv::mutex_lock_guard oLock(m_vpQueues[nQueueIdx]->oMutex);
+        m_vpQueues[nQueueIdx]->qTasks.push_back(std::move(lTask));
+    }
+    {
+        // task is published before the counter is bumped, so a worker that reserves it is guaranteed to find it
+        lv::mutex_lock_guard oLock(m_oSyncMutex);
+        ++m_nQueuedTasks;
+        ++m_nUnfinishedTasks;
+    }
+    m_oSyncVar.notify_one();
+}
+
+void lv::WorkStealingPool::waitIdle() {
+    lvAssert_(getCurrentWorkerIdx()==SIZE_MAX,"cannot wait for pool to be idle from one of its workers");
+    lv::mutex_unique_lock oLock(m_oSyncMutex);
+    m_oIdleVar.wait(oLock,[&](){return m_nUnfinishedTasks==0;});
+}
+
+size_t lv::WorkStealingPool::getCurrentWorkerIdx() const {
+    return (g_pCurrWorkerPool==this)?g_nCurrWorkerIdx:SIZE_MAX;
+}
+
+bool lv::WorkStealingPool::popTask(size_t nWorkerIdx, std::function<void()>& lTask) {
+    {
+        TaskQueue& oLocalQueue = *m_vpQueues[nWorkerIdx];
+        lv::mutex_lock_guard oLock(oLocalQueue.oMutex);
+        if(!oLocalQueue.qTasks.empty()) {
+            lTask = std::move(oLocalQueue.qTasks.back());
+            oLocalQueue.qTasks.pop_back();
+            return true;
+        }
+    }
+    for(size_t nOffset=1; nOffset<m_vpQueues.size(); ++nOffset) {
+        TaskQueue& oVictimQueue = *m_vpQueues[(nWorkerIdx+nOffset)%m_vpQueues.size()];
+        lv::mutex_lock_guard oLock(oVictimQueue.oMutex);
+        if(!oVictimQueue.qTasks.empty()) {
+            lTask = std::move(oVictimQueue.qTasks.front());
+            oVictimQueue.qTasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void lv::WorkStealingPool::entry(size_t nWorkerIdx) {
+    g_pCurrWorkerPool = this;
+    g_nCurrWorkerIdx = nWorkerIdx;
+    std::function<void()> lTask;
+    while(true) {
+        {
+            lv::mutex_unique_lock oLock(m_oSyncMutex);
+            m_oSyncVar.wait(oLock,[&](){return !m_bIsActive || m_nQueuedTasks>0;});
+            if(m_nQueuedTasks==0)
+                break; // pool is shutting down, and nothing is left to process
+            --m_nQueuedTasks; // reserves one of the published tasks for this worker
+        }
+        while(!popTask(nWorkerIdx,lTask))
+            std::this_thread::yield();
+        lTask();
+        lTask = nullptr;
+        {
+            lv::mutex_lock_guard oLock(m_oSyncMutex);
+            if(--m_nUnfinishedTasks==0)
+                m_oIdleVar.notify_all();
+        }
+    }
+    g_pCurrWorkerPool = nullptr;
+    g_nCurrWorkerIdx = SIZE_MAX;
+}
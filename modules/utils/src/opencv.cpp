@@ -437,6 +437,19 @@ void lv::DisplayHelper::onMouseEvent(int nEvent, int x, int y, int nFlags, void*
     (*(std::function<void(int,int,int,int)>*)pData)(nEvent,x,y,nFlags);
 }
 
+namespace {
+
+    /// returns whether the given mat archive type uses the binary format (which can also be written to/read from streams)
+    bool isBinaryMatArchive(lv::MatArchiveList eArchiveType) {
+    #if USING_LZ4
+        if(eArchiveType==lv::MatArchive_BINARY_LZ4)
+            return true;
+    #endif //USING_LZ4
+        return eArchiveType==lv::MatArchive_BINARY || eArchiveType==lv::MatArchive_BINARY_BITPACKED;
+    }
+
+} // anonymous namespace
+
 void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchiveList eArchiveType) {
     lvAssert_(!sFilePath.empty() && !_oData.empty(),"output file path and matrix must both be non-empty");
     cv::Mat oData = _oData.isContinuous()?_oData:_oData.clone();
@@ -476,22 +489,34 @@ void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchi
         }
         lvAssert_(ssStr,"plain text archive write failed");
     }
-#if USING_LZ4
-    else if(eArchiveType==MatArchive_BINARY_LZ4) {
+    else if(isBinaryMatArchive(eArchiveType)) {
         std::ofstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for writing",sFilePath.c_str());
-        const int32_t nDataType = (int32_t)oData.type();
-        ssStr.write((const char*)&nDataType,sizeof(nDataType));
-        const uint64_t nElemSize = (uint64_t)oData.elemSize();
-        ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
-        const uint64_t nElemCount = (uint64_t)oData.total();
-        ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
-        const int32_t nDims = (int32_t)oData.dims;
-        ssStr.write((const char*)&nDims,sizeof(nDims));
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
-            const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
-            ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
-        }
+        lv::write(ssStr,oData,eArchiveType);
+    }
+    else
+        lvError("unrecognized mat archive type flag");
+}
+
+void lv::write(std::ostream& ssStr, const cv::Mat& _oData, lv::MatArchiveList eArchiveType) {
+    lvAssert_(!_oData.empty(),"output matrix must be non-empty");
+    lvAssert_(isBinaryMatArchive(eArchiveType),"only binary mat archives can be written to streams");
+    lvAssert_(eArchiveType!=MatArchive_BINARY_BITPACKED || _oData.type()==CV_8UC1,"bit-packed mat archives only support CV_8UC1 matrices");
+    const cv::Mat oData = _oData.isContinuous()?_oData:_oData.clone();
+    const int32_t nDataType = (int32_t)oData.type();
+    ssStr.write((const char*)&nDataType,sizeof(nDataType));
+    const uint64_t nElemSize = (uint64_t)oData.elemSize();
+    ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
+    const uint64_t nElemCount = (uint64_t)oData.total();
+    ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
+    const int32_t nDims = (int32_t)oData.dims;
+    ssStr.write((const char*)&nDims,sizeof(nDims));
+    for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
+        const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
+        ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
+    }
+#if USING_LZ4
+    if(eArchiveType==MatArchive_BINARY_LZ4) {
         if(nElemSize*nElemCount>0u) {
             static thread_local lv::AutoBuffer<char> s_aDataBuffer;
             s_aDataBuffer.resize(size_t(nElemSize*nElemCount));
@@ -508,29 +533,29 @@ void lv::write(const std::string& sFilePath, const cv::Mat& _oData, lv::MatArchi
             const int32_t nComprSize = 0;
             ssStr.write((const char*)&nComprSize,sizeof(nComprSize));
         }
-        lvAssert_(ssStr,"binary archive write failed");
     }
+    else
 #endif //USING_LZ4
-    else if(eArchiveType==MatArchive_BINARY) {
-        std::ofstream ssStr(sFilePath,std::ios::binary);
-        lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for writing",sFilePath.c_str());
-        const int32_t nDataType = (int32_t)oData.type();
-        ssStr.write((const char*)&nDataType,sizeof(nDataType));
-        const uint64_t nElemSize = (uint64_t)oData.elemSize();
-        ssStr.write((const char*)&nElemSize,sizeof(nElemSize));
-        const uint64_t nElemCount = (uint64_t)oData.total();
-        ssStr.write((const char*)&nElemCount,sizeof(nElemCount));
-        const int32_t nDims = (int32_t)oData.dims;
-        ssStr.write((const char*)&nDims,sizeof(nDims));
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx) {
-            const int32_t nDimSize = (int32_t)oData.size[nDimIdx];
-            ssStr.write((const char*)&nDimSize,sizeof(nDimSize));
+    if(eArchiveType==MatArchive_BINARY_BITPACKED) {
+        const size_t nFullBytes = size_t(nElemCount/8), nTailBits = size_t(nElemCount%8);
+        static thread_local lv::AutoBuffer<uchar> s_aDataBuffer;
+        s_aDataBuffer.resize(nFullBytes+(nTailBits?1:0));
+        const uchar* pInput = oData.data;
+        uchar* pOutput = s_aDataBuffer.data();
+        for(size_t nByteIdx=0; nByteIdx<nFullBytes; ++nByteIdx, pInput+=8)
+            pOutput[nByteIdx] = uchar((pInput[0]!=0)|((pInput[1]!=0)<<1)|((pInput[2]!=0)<<2)|((pInput[3]!=0)<<3)|
+                                      ((pInput[4]!=0)<<4)|((pInput[5]!=0)<<5)|((pInput[6]!=0)<<6)|((pInput[7]!=0)<<7));
+        if(nTailBits) {
+            uchar nLastByte = 0;
+            for(size_t nBitIdx=0; nBitIdx<nTailBits; ++nBitIdx)
+                nLastByte |= uchar((pInput[nBitIdx]!=0)<<nBitIdx);
+            pOutput[nFullBytes] = nLastByte;
         }
-        ssStr.write((const char*)(oData.data),nElemSize*nElemCount);
-        lvAssert_(ssStr,"binary archive write failed");
+        ssStr.write((const char*)pOutput,std::streamsize(nFullBytes+(nTailBits?1:0)));
     }
     else
-        lvError("unrecognized mat archive type flag");
+        ssStr.write((const char*)(oData.data),nElemSize*nElemCount);
+    lvAssert_(ssStr,"binary archive write failed");
 }
 
 void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList eArchiveType) {
@@ -570,23 +595,35 @@ void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList e
         lvAssert_(ssStr,"plain text archive read failed");
         oDataTemp.convertTo(oData,nDataDepth);
     }
-#if USING_LZ4
-    else if(eArchiveType==MatArchive_BINARY_LZ4) {
+    else if(isBinaryMatArchive(eArchiveType)) {
         std::ifstream ssStr(sFilePath,std::ios::binary);
         lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
-        int32_t nDataType;
-        ssStr.read((char*)&nDataType,sizeof(nDataType));
-        uint64_t nElemSize;
-        ssStr.read((char*)&nElemSize,sizeof(nElemSize));
-        uint64_t nElemCount;
-        ssStr.read((char*)&nElemCount,sizeof(nElemCount));
-        int32_t nDims;
-        ssStr.read((char*)&nDims,sizeof(nDims));
-        std::vector<int32_t> anSizes(nDims);
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
-            ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
-        oData.create(nDims,anSizes.data(),nDataType);
-        lvAssert_(ssStr,"binary archive read failed");
+        lv::read(ssStr,oData,eArchiveType);
+    }
+    else
+        lvError("unrecognized mat archive type flag");
+}
+
+void lv::read(std::istream& ssStr, cv::Mat& oData, lv::MatArchiveList eArchiveType) {
+    lvAssert_(isBinaryMatArchive(eArchiveType),"only binary mat archives can be read from streams");
+    int32_t nDataType;
+    ssStr.read((char*)&nDataType,sizeof(nDataType));
+    uint64_t nElemSize;
+    ssStr.read((char*)&nElemSize,sizeof(nElemSize));
+    uint64_t nElemCount;
+    ssStr.read((char*)&nElemCount,sizeof(nElemCount));
+    int32_t nDims;
+    ssStr.read((char*)&nDims,sizeof(nDims));
+    lvAssert_(ssStr && nDims>0 && nDims<=CV_MAX_DIM,"binary archive read failed");
+    std::vector<int32_t> anSizes(nDims);
+    for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
+        ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
+    lvAssert_(ssStr,"binary archive read failed");
+    oData.create(nDims,anSizes.data(),nDataType);
+    lvAssert_(uint64_t(oData.elemSize())==nElemSize && uint64_t(oData.total())==nElemCount,"binary archive header is corrupted");
+    lvAssert_(eArchiveType!=MatArchive_BINARY_BITPACKED || nDataType==CV_8UC1,"bit-packed archive header is corrupted");
+#if USING_LZ4
+    if(eArchiveType==MatArchive_BINARY_LZ4) {
         if(oData.total()>0u) {
             int32_t nComprSize;
             ssStr.read((char*)&nComprSize,sizeof(nComprSize));
@@ -604,27 +641,21 @@ void lv::read(const std::string& sFilePath, cv::Mat& oData, lv::MatArchiveList e
             }
         }
     }
+    else
 #endif //USING_LZ4
-    else if(eArchiveType==MatArchive_BINARY) {
-        std::ifstream ssStr(sFilePath,std::ios::binary);
-        lvAssert__(ssStr.is_open(),"could not open binary file at '%s' for reading",sFilePath.c_str());
-        int32_t nDataType;
-        ssStr.read((char*)&nDataType,sizeof(nDataType));
-        uint64_t nElemSize;
-        ssStr.read((char*)&nElemSize,sizeof(nElemSize));
-        uint64_t nElemCount;
-        ssStr.read((char*)&nElemCount,sizeof(nElemCount));
-        int32_t nDims;
-        ssStr.read((char*)&nDims,sizeof(nDims));
-        std::vector<int32_t> anSizes(nDims);
-        for(int32_t nDimIdx=0; nDimIdx<nDims; ++nDimIdx)
-            ssStr.read((char*)&anSizes[nDimIdx],sizeof(anSizes[nDimIdx]));
-        oData.create(nDims,anSizes.data(),nDataType);
-        ssStr.read((char*)(oData.data),nElemSize*nElemCount);
+    if(eArchiveType==MatArchive_BINARY_BITPACKED) {
+        static thread_local lv::AutoBuffer<uchar> s_aDataBuffer;
+        s_aDataBuffer.resize(size_t((nElemCount+7)/8));
+        ssStr.read((char*)s_aDataBuffer.data(),std::streamsize((nElemCount+7)/8));
         lvAssert_(ssStr,"binary archive read failed");
+        const uchar* pInput = s_aDataBuffer.data();
+        uchar* pOutput = oData.data;
+        for(size_t nElemIdx=0; nElemIdx<size_t(nElemCount); ++nElemIdx)
+            pOutput[nElemIdx] = ((pInput[nElemIdx/8]>>(nElemIdx%8))&1)?UCHAR_MAX:0;
     }
     else
-        lvError("unrecognized mat archive type flag");
+        ssStr.read((char*)(oData.data),nElemSize*nElemCount);
+    lvAssert_(ssStr,"binary archive read failed");
 }
 
 cv::Mat lv::packData(const std::vector<cv::Mat>& vMats, std::vector<lv::MatInfo>* pvOutputPackInfo) {
@@ -32,6 +32,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #endif //(!defined(_MSC_VER))
 #include <fstream>
 #include <csignal>
@@ -227,6 +229,41 @@ std::fstream lv::createBinFileWithPrealloc(const std::string & sFilePath, size_t
     return ssFile;
 }
 
+std::shared_ptr<uint8_t> lv::mapFileToMemory(const std::string& sFilePath, size_t& nFileSize) {
+    lvAssert_(!sFilePath.empty(),"file path must be non-empty");
+#if defined(_MSC_VER)
+    const std::wstring swFilePath(sFilePath.begin(),sFilePath.end());
+    HANDLE hFile = CreateFile(swFilePath.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+    lvAssert__(hFile!=INVALID_HANDLE_VALUE,"could not open file at '%s' for mapping",sFilePath.c_str());
+    LARGE_INTEGER nRawFileSize;
+    if(!GetFileSizeEx(hFile,&nRawFileSize) || nRawFileSize.QuadPart<=0) {
+        CloseHandle(hFile);
+        lvError_("could not map empty file at '%s'",sFilePath.c_str());
+    }
+    nFileSize = size_t(nRawFileSize.QuadPart);
+    HANDLE hMapping = CreateFileMapping(hFile,NULL,PAGE_WRITECOPY,0,0,NULL);
+    CloseHandle(hFile); // mapping keeps its own reference to the file
+    lvAssert__(hMapping!=NULL,"could not create file mapping for '%s'",sFilePath.c_str());
+    void* pData = MapViewOfFile(hMapping,FILE_MAP_COPY,0,0,0);
+    CloseHandle(hMapping); // view keeps its own reference to the mapping
+    lvAssert__(pData!=NULL,"could not map view of file '%s'",sFilePath.c_str());
+    return std::shared_ptr<uint8_t>((uint8_t*)pData,[](uint8_t* p){UnmapViewOfFile(p);});
+#else //(!defined(_MSC_VER))
+    const int nFD = open(sFilePath.c_str(),O_RDONLY);
+    lvAssert__(nFD!=-1,"could not open file at '%s' for mapping",sFilePath.c_str());
+    struct stat st;
+    if(fstat(nFD,&st)!=0 || st.st_size<=0) {
+        close(nFD);
+        lvError_("could not map empty file at '%s'",sFilePath.c_str());
+    }
+    nFileSize = size_t(st.st_size);
+    void* pData = mmap(nullptr,nFileSize,PROT_READ|PROT_WRITE,MAP_PRIVATE,nFD,0);
+    close(nFD); // mapping keeps its own reference to the file
+    lvAssert__(pData!=MAP_FAILED,"could not map file at '%s' to memory",sFilePath.c_str());
+    return std::shared_ptr<uint8_t>((uint8_t*)pData,[nFileSize](uint8_t* p){munmap(p,nFileSize);});
+#endif //(!defined(_MSC_VER))
+}
+
 void lv::registerAllConsoleSignals(void(*lHandler)(int)) {
     signal(SIGINT,lHandler);
     signal(SIGTERM,lHandler);
@@ -306,6 +306,42 @@ TEST(WorkerPool,regression_4threads) {
         ASSERT_EQ(vRes[i].get(),size_t(13));
 }
 
+TEST(WorkStealingPool,regression_futures) {
+    lv::WorkStealingPool wsp(4);
+    ASSERT_EQ(wsp.getWorkerCount(),size_t(4));
+    ASSERT_EQ(wsp.getCurrentWorkerIdx(),SIZE_MAX);
+    std::vector<std::future<size_t>> vRes;
+    for(size_t i=0; i<100; ++i)
+        vRes.push_back(wsp.queueTask([](size_t n){std::this_thread::sleep_for(std::chrono::milliseconds(n%5));return n*2;},i));
+    for(size_t i=0; i<vRes.size(); ++i)
+        ASSERT_EQ(vRes[i].get(),i*2);
+    std::future<void> oThrowRes = wsp.queueTask([](){lvError("test");});
+    ASSERT_THROW(oThrowRes.get(),lv::Exception);
+}
+
+TEST(WorkStealingPool,regression_nested) {
+    std::atomic_size_t nTaskCount(0);
+    {
+        std::function<void(size_t)> lSpawn; // declared first, as it must outlive the pool's destructor
+        lv::WorkStealingPool wsp(4);
+        lSpawn = [&](size_t nDepth) {
+            ++nTaskCount;
+            ASSERT_NE(wsp.getCurrentWorkerIdx(),SIZE_MAX);
+            ASSERT_LT(wsp.getCurrentWorkerIdx(),wsp.getWorkerCount());
+            if(nDepth<6) {
+                wsp.submit(std::bind(lSpawn,nDepth+1));
+                wsp.submit(std::bind(lSpawn,nDepth+1));
+            }
+        };
+        wsp.submit(std::bind(lSpawn,size_t(0)));
+        wsp.waitIdle();
+        ASSERT_EQ(nTaskCount.load(),size_t(127));
+        for(size_t i=0; i<10; ++i)
+            wsp.submit(std::bind(lSpawn,size_t(6)));
+    } // destructor must drain remaining tasks
+    ASSERT_EQ(nTaskCount.load(),size_t(137));
+}
+
 TEST(StopWatch,regression) {
     lv::StopWatch sw;
     std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -677,6 +677,31 @@ TYPED_TEST(readwrite_fixture,regression) {
         ASSERT_EQ(cv::countNonZero(oNewMat!=oNewMat),0);
     }
 #endif //USING_LZ4
+    std::vector<lv::MatArchiveList> veStreamArchiveTypes = {lv::MatArchive_BINARY};
+#if USING_LZ4
+    veStreamArchiveTypes.push_back(lv::MatArchive_BINARY_LZ4);
+#endif //USING_LZ4
+    for(lv::MatArchiveList eArchiveType : veStreamArchiveTypes) {
+        // binary archives can be chained in a single stream, starting at any offset
+        std::stringstream ssStr;
+        ssStr << "prefix";
+        std::vector<cv::Mat> vMats(10);
+        for(cv::Mat& oMat : vMats) {
+            oMat = cv::Mat_<TypeParam>(rng.uniform(1,50),rng.uniform(1,50));
+            rng.fill(oMat,cv::RNG::UNIFORM,-200,200,true);
+            lv::write(ssStr,oMat,eArchiveType);
+        }
+        ssStr.seekg(6);
+        for(const cv::Mat& oMat : vMats) {
+            cv::Mat oNewMat;
+            lv::read(ssStr,oNewMat,eArchiveType);
+            ASSERT_EQ(oNewMat.type(),oMat.type());
+            ASSERT_EQ(oNewMat.size(),oMat.size());
+            ASSERT_EQ(cv::countNonZero(oNewMat!=oMat),0);
+        }
+        ASSERT_EQ(ssStr.peek(),std::char_traits<char>::eof());
+        ASSERT_THROW_LV_QUIET(lv::read(ssStr,vMats[0],eArchiveType));
+    }
     const std::string sYMLPath = TEST_OUTPUT_DATA_ROOT "/test_readwrite.yml";
     for(size_t i=0; i<100; ++i) {
         cv::Mat_<TypeParam> oMat(rng.uniform(10,20),rng.uniform(10,20));
@@ -695,6 +720,33 @@ TYPED_TEST(readwrite_fixture,regression) {
     }
 }
 
+TEST(readwrite,regression_bitpacked) {
+    cv::RNG rng((unsigned int)time(NULL));
+    std::stringstream ssStr;
+    std::vector<cv::Mat> vMats(10);
+    for(cv::Mat& oMat : vMats) {
+        // odd sizes so that the last packed byte is usually partial
+        oMat.create(rng.uniform(1,50),rng.uniform(1,50),CV_8UC1);
+        rng.fill(oMat,cv::RNG::UNIFORM,0,2);
+        oMat *= UCHAR_MAX;
+        lv::write(ssStr,oMat,lv::MatArchive_BINARY_BITPACKED);
+    }
+    for(const cv::Mat& oMat : vMats) {
+        cv::Mat oNewMat;
+        lv::read(ssStr,oNewMat,lv::MatArchive_BINARY_BITPACKED);
+        ASSERT_EQ(oNewMat.type(),CV_8UC1);
+        ASSERT_EQ(oNewMat.size(),oMat.size());
+        ASSERT_EQ(cv::countNonZero(oNewMat!=oMat),0);
+    }
+    ASSERT_EQ(ssStr.peek(),std::char_traits<char>::eof());
+    const std::string sArchivePath = TEST_OUTPUT_DATA_ROOT "/test_readwrite_bitpacked.mat";
+    const cv::Mat oMask = (cv::Mat_<uchar>(3,3) << 0,1,2,0,0,255,0,7,0);
+    lv::write(sArchivePath,oMask,lv::MatArchive_BINARY_BITPACKED);
+    const cv::Mat oNewMask = lv::read(sArchivePath,lv::MatArchive_BINARY_BITPACKED);
+    ASSERT_EQ(cv::countNonZero(oNewMask!=(oMask>0)),0);
+    ASSERT_THROW_LV_QUIET(lv::write(sArchivePath,cv::Mat(3,3,CV_8UC3,cv::Scalar::all(255)),lv::MatArchive_BINARY_BITPACKED));
+}
+
 TEST(pack_unpack,regression) {
     srand((uint)time(nullptr));
     cv::RNG rng((unsigned int)time(NULL));
@@ -36,4 +36,30 @@ TEST(filesystem_ops,regression) {
     EXPECT_EQ(vsFiles2,(std::vector<std::string>{sDirPath+"test1.txt"}));
     EXPECT_EQ(lv::getSubDirsFromDir(sDirPath),(std::vector<std::string>{sDirPath+"subdir1",sDirPath+"subdir2"}));
     EXPECT_GT(lv::getCurrentPhysMemBytesUsed(),size_t(0));
-}
\ No newline at end of file
+}
+
+TEST(mapFileToMemory,regression) {
+    const std::string sDirPath = TEST_OUTPUT_DATA_ROOT "/platformtest/";
+    ASSERT_TRUE(lv::createDirIfNotExist(sDirPath));
+    const std::string sFilePath = sDirPath+"mapped.bin";
+    std::vector<uint8_t> vnData(10000);
+    for(size_t n=0; n<vnData.size(); ++n)
+        vnData[n] = uint8_t(n*7);
+    {
+        std::ofstream oFile(sFilePath,std::ios::binary);
+        ASSERT_TRUE(oFile.is_open());
+        oFile.write((const char*)vnData.data(),vnData.size());
+    }
+    size_t nFileSize = 0;
+    std::shared_ptr<uint8_t> pData = lv::mapFileToMemory(sFilePath,nFileSize);
+    ASSERT_TRUE(pData!=nullptr);
+    ASSERT_EQ(nFileSize,vnData.size());
+    ASSERT_EQ(memcmp(pData.get(),vnData.data(),nFileSize),0);
+    pData.get()[5] = 0xFF; // copy-on-write, should never reach the file
+    pData.reset();
+    std::ifstream oFile(sFilePath,std::ios::binary);
+    std::vector<uint8_t> vnReadData(vnData.size());
+    ASSERT_TRUE(oFile.read((char*)vnReadData.data(),vnReadData.size()));
+    ASSERT_EQ(vnReadData,vnData);
+    ASSERT_THROW(lv::mapFileToMemory(sDirPath+"missing.bin",nFileSize),lv::Exception);
+}
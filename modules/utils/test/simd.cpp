@@ -1,4 +1,5 @@
 
+#include "litiv/utils/math.hpp"
 #include "litiv/utils/simd.hpp"
 #include "litiv/test.hpp"
 
@@ -226,8 +227,75 @@ TEST(extract_32si,regression) {
     ASSERT_EQ(lv::extract_32si<3>(uData.a),4);
 }
 
+TEST(absdiff_16i,regression) {
+    union {
+        int16_t n[8];
+        __m128i a;
+    } uDataA = {0}, uDataB = {0}, uRes = {0};
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<8; ++j) {
+            uDataA.n[j] = (int16_t)(rand()%32768-16384);
+            uDataB.n[j] = (int16_t)(rand()%32768-16384);
+        }
+        uRes.a = lv::absdiff_16i(uDataA.a,uDataB.a);
+        for(size_t j=0; j<8; ++j)
+            ASSERT_EQ((int)uRes.n[j],std::abs((int)uDataA.n[j]-(int)uDataB.n[j]));
+    }
+}
+
+TEST(popcount_16ui,regression) {
+    union {
+        uint16_t n[8];
+        __m128i a;
+    } uData = {0}, uRes = {0};
+    uRes.a = lv::popcount_16ui(uData.a);
+    for(size_t j=0; j<8; ++j)
+        ASSERT_EQ(uRes.n[j],0);
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<8; ++j)
+            uData.n[j] = (uint16_t)(rand()%65536);
+        uRes.a = lv::popcount_16ui(uData.a);
+        for(size_t j=0; j<8; ++j)
+            ASSERT_EQ((size_t)uRes.n[j],lv::popcount(uData.n[j]));
+    }
+}
+
 #endif //HAVE_SSE2
 
+#if HAVE_AVX2
+
+TEST(absdiff_16i,regression_avx2) {
+    union {
+        int16_t n[16];
+        __m256i a;
+    } uDataA = {0}, uDataB = {0}, uRes = {0};
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<16; ++j) {
+            uDataA.n[j] = (int16_t)(rand()%32768-16384);
+            uDataB.n[j] = (int16_t)(rand()%32768-16384);
+        }
+        uRes.a = lv::absdiff_16i(uDataA.a,uDataB.a);
+        for(size_t j=0; j<16; ++j)
+            ASSERT_EQ((int)uRes.n[j],std::abs((int)uDataA.n[j]-(int)uDataB.n[j]));
+    }
+}
+
+TEST(popcount_16ui,regression_avx2) {
+    union {
+        uint16_t n[16];
+        __m256i a;
+    } uData = {0}, uRes = {0};
+    for(size_t i=0; i<1000; ++i) {
+        for(size_t j=0; j<16; ++j)
+            uData.n[j] = (uint16_t)(rand()%65536);
+        uRes.a = lv::popcount_16ui(uData.a);
+        for(size_t j=0; j<16; ++j)
+            ASSERT_EQ((size_t)uRes.n[j],lv::popcount(uData.n[j]));
+    }
+}
+
+#endif //HAVE_AVX2
+
 #if HAVE_SSE4_1
 
 TEST(hmax_8ui,regression) {
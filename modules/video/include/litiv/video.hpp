@@ -20,6 +20,7 @@
 #include "litiv/video/BackgroundSubtractorLOBSTER.hpp"
 #include "litiv/video/BackgroundSubtractorSuBSENSE.hpp"
 #include "litiv/video/BackgroundSubtractorPAWCS.hpp"
+#include "litiv/video/BackgroundSubtractionEngine.hpp"
 #if HAVE_OPENGM
 #include "litiv/video/VideoCosegmentationUtils.hpp"
 #else //!HAVE_OPENGM
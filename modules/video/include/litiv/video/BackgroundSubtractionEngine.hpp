@@ -0,0 +1,114 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "litiv/video/BackgroundSubtractionUtils.hpp"
+
+/// defines the default value for BackgroundSubtractionEngine::m_nMaxPendingFrames
+#define BGSENGINE_DEFAULT_MAX_PENDING_FRAMES (8)
+
+/**
+    Multi-stream background subtraction engine.
+
+    Owns one background subtraction function/instance per stream, accepts frames from any number of producer threads,
+    and schedules per-frame jobs on a shared work-stealing thread pool. Frames of a given stream are always processed
+    (and their outputs reported) in push order, and never concurrently, so algorithm instances need not be thread-safe;
+    frames of different streams are processed in parallel. Pushing blocks once a stream has too many pending frames.
+*/
+struct BackgroundSubtractionEngine {
+    /// per-stream frame processing function (must segment the input image into the fg mask using the given learning rate)
+    using ApplyFunc = std::function<void(const cv::Mat& /*oInput*/, cv::Mat& /*oFGMask*/, double /*dLearningRate*/)>;
+    /// per-stream output callback; called from a worker thread, in frame order for each stream
+    using OutputCallback = std::function<void(size_t /*nFrameIdx*/, const cv::Mat& /*oInput*/, const cv::Mat& /*oFGMask*/)>;
+    /// per-stream processing statistics (times are given in seconds)
+    struct StreamStats {
+        /// number of frames pushed to & fully processed by the stream
+        size_t nPushedFrames, nProcessedFrames;
+        /// mean & max push-to-output latency for processed frames
+        double dMeanLatency, dMaxLatency;
+        /// mean processing time per frame (only accounts for the 'apply' call)
+        double dMeanProcessTime;
+        /// processed frame rate (frames per second) since the first push
+        double dThroughput;
+    };
+    /// default constructor; 'nWorkers' threads are shared by all streams (0 = one per hardware thread)
+    explicit BackgroundSubtractionEngine(size_t nWorkers=0, size_t nMaxPendingFrames=BGSENGINE_DEFAULT_MAX_PENDING_FRAMES);
+    /// default destructor; will block until all pushed frames have been processed
+    ~BackgroundSubtractionEngine();
+    /// adds a stream driven by an already-initialized algorithm instance (using its default learning rate), and returns its index
+    size_t addStream(std::shared_ptr<IIBackgroundSubtractor> pAlgo, OutputCallback lCallback=OutputCallback());
+    /// adds a stream driven by a generic processing function (using the given default learning rate), and returns its index
+    size_t addStream(ApplyFunc lApply, OutputCallback lCallback=OutputCallback(), double dDefaultLearningRate=-1);
+    /// pushes a frame to a stream for processing (thread-safe; the frame data is shared, not copied); returns its index in the stream
+    /// (a non-positive learning rate is replaced by the stream's default learning rate)
+    size_t push(size_t nStreamIdx, const cv::Mat& oInput, double dLearningRate=-1);
+    /// pushes a frame held by a shared view to a stream for processing (e.g. a pinned dataset packet); the view is released once the frame is processed & reported
+    size_t push(size_t nStreamIdx, std::shared_ptr<const cv::Mat> pInput, double dLearningRate=-1);
+    /// blocks until all frames pushed to the given stream have been processed (rethrows the first processing error of the stream, if any)
+    void waitStream(size_t nStreamIdx);
+    /// blocks until all frames pushed to all streams have been processed (rethrows the first processing error, if any)
+    void waitAll();
+    /// returns the processing statistics of the given stream
+    StreamStats getStreamStats(size_t nStreamIdx) const;
+    /// returns the number of streams owned by the engine
+    size_t getStreamCount() const;
+    /// returns the number of worker threads shared by all streams
+    inline size_t getWorkerCount() const {return m_oPool.getWorkerCount();}
+    BackgroundSubtractionEngine(const BackgroundSubtractionEngine&) = delete;
+    BackgroundSubtractionEngine& operator=(const BackgroundSubtractionEngine&) = delete;
+
+protected:
+    using Clock = std::chrono::high_resolution_clock;
+    /// frame awaiting processing in a stream queue
+    struct PendingFrame {
+        cv::Mat oInput;
+        std::shared_ptr<const cv::Mat> pInputView;
+        double dLearningRate;
+        size_t nFrameIdx;
+        Clock::time_point nPushTime;
+    };
+    /// per-stream state (queue, scheduling flag & stats are guarded by the stream mutex)
+    struct StreamInfo {
+        ApplyFunc lApply;
+        OutputCallback lCallback;
+        double dDefaultLearningRate;
+        std::deque<PendingFrame> qPendingFrames;
+        bool bScheduled;
+        cv::Mat oFGMask;
+        std::exception_ptr pError;
+        size_t nPushedFrames, nProcessedFrames;
+        double dTotLatency, dMaxLatency, dTotProcessTime;
+        Clock::time_point nFirstPushTime, nLastOutputTime;
+        mutable std::mutex oMutex;
+        std::condition_variable oSyncVar;
+    };
+    /// returns the stream at the given index (thread-safe)
+    StreamInfo& getStream(size_t nStreamIdx) const;
+    /// queues a frame in a stream (the optional view owns the input data), and schedules the stream if needed
+    size_t pushFrame(size_t nStreamIdx, const cv::Mat& oInput, std::shared_ptr<const cv::Mat> pInputView, double dLearningRate);
+    /// processes the next pending frame of a stream, and reschedules the stream if more frames are pending
+    void processNext(StreamInfo& oStream);
+    /// maximum number of pending frames per stream before 'push' blocks
+    const size_t m_nMaxPendingFrames;
+    /// stream list (streams are never removed, so references stay valid)
+    std::vector<std::unique_ptr<StreamInfo>> m_vpStreams;
+    /// guards the stream list
+    mutable std::mutex m_oStreamsMutex;
+    /// shared worker pool (declared last so that it is destroyed, and drained, first)
+    lv::WorkStealingPool m_oPool;
+};
@@ -20,6 +20,245 @@
 #include "litiv/utils/algo.hpp"
 #include <opencv2/video/background_segm.hpp>
 
+/**
+    Versioned binary snapshot of a background model (used to save/restore the complete state of an algorithm).
+
+    Snapshot files start with a fixed header (magic tag, format version, algorithm name & model version), followed by
+    a table of named data blocks; each block is aligned to s_nBlockAlign bytes so that it can be used as-is once the
+    file is mapped to memory. Opening a snapshot maps the file copy-on-write, so nothing is parsed or read upfront, and
+    large blocks (e.g. sample stores) can be adopted directly by the model. Data is stored in native byte order.
+*/
+struct BackgroundModelSnapshot {
+    /// snapshot file format version (must be bumped whenever the header/block table layout changes)
+    static constexpr uint32_t s_nFormatVersion = 1;
+    /// byte alignment of data blocks inside snapshot files
+    static constexpr size_t s_nBlockAlign = 64;
+    /// creates an empty snapshot for the given algorithm name & model version (blocks should then be added before writing)
+    BackgroundModelSnapshot(const std::string& sAlgoName, uint32_t nModelVersion);
+    /// maps an existing snapshot file to memory, and validates its header against the given algorithm name & model version
+    static BackgroundModelSnapshot open(const std::string& sFilePath, const std::string& sAlgoName, uint32_t nModelVersion);
+    /// adds a raw data block (data is referenced, not copied, and must stay alive until 'write' is called)
+    void addBlock(const std::string& sName, const void* pData, size_t nBytes);
+    /// adds a continuous matrix block (data is referenced, not copied, and must stay alive until 'write' is called)
+    void addMat(const std::string& sName, const cv::Mat& oMat);
+    /// adds a trivially copyable value block (value is copied)
+    template<typename T>
+    void addValue(const std::string& sName, const T& oVal) {
+        static_assert(std::is_trivially_copyable<T>::value,"snapshot values must be trivially copyable");
+        addBlock(sName,nullptr,sizeof(T));
+        m_vBlocks.back().vLocalData.assign((const uchar*)&oVal,(const uchar*)&oVal+sizeof(T));
+    }
+    /// writes the snapshot header, block table, and all blocks to the given file path
+    void write(const std::string& sFilePath) const;
+    /// returns whether the snapshot contains a block with the given name
+    bool hasBlock(const std::string& sName) const;
+    /// returns the byte size of a data block
+    size_t getBlockSize(const std::string& sName) const;
+    /// returns a pointer to a (mapped) data block, checking its byte size
+    uchar* getBlock(const std::string& sName, size_t nExpectedBytes) const;
+    /// returns a matrix header pointing to a (mapped) matrix block; only valid while the snapshot or its mapping is alive
+    cv::Mat getMat(const std::string& sName) const;
+    /// returns a copy of a (mapped) trivially copyable value block
+    template<typename T>
+    T getValue(const std::string& sName) const {
+        static_assert(std::is_trivially_copyable<T>::value,"snapshot values must be trivially copyable");
+        T oVal;
+        std::memcpy(&oVal,getBlock(sName,sizeof(T)),sizeof(T));
+        return oVal;
+    }
+    /// returns the shared file mapping handle (can be kept by a model which adopts mapped blocks directly)
+    inline const std::shared_ptr<uint8_t>& getMapping() const {return m_pMapping;}
+
+protected:
+    /// data block info (pointers target the source data when writing, and the file mapping when reading)
+    struct BlockInfo {
+        std::string sName;
+        uchar* pData;
+        size_t nBytes;
+        int nMatType, nMatRows, nMatCols;
+        std::vector<uchar> vLocalData;
+    };
+    /// returns the info of the block with the given name (throws if missing)
+    const BlockInfo& getBlockInfo(const std::string& sName) const;
+    /// algorithm name & model version stored in the header
+    std::string m_sAlgoName;
+    uint32_t m_nModelVersion;
+    /// list of data blocks, in file order
+    std::vector<BlockInfo> m_vBlocks;
+    /// file mapping (only used when reading)
+    std::shared_ptr<uint8_t> m_pMapping;
+};
+
+#if USING_BGS_INSTRUMENTATION
+/// expands to its arguments only in instrumented builds (used to wrap all stats collection code so that it compiles out otherwise)
+#define lvBGSStatsOnly(...) __VA_ARGS__
+#else //!USING_BGS_INSTRUMENTATION
+#define lvBGSStatsOnly(...)
+#endif //!USING_BGS_INSTRUMENTATION
+
+/**
+    Per-stage timing & counter instrumentation data for background subtraction algorithms.
+
+    Stats are only accumulated in builds configured with USE_BGS_INSTRUMENTATION (otherwise, all collection code is
+    compiled out, and the stats always stay zeroed). Algorithms which do not have a given stage or counter leave it
+    untouched. All times are cumulative, and given in seconds; for stages processed by several threads at once, the
+    times of all threads are summed.
+*/
+struct BackgroundSubtractorStats {
+    /// processing stages with separate cumulative timings
+    enum Stage {
+        Stage_SampleMatching,
+        Stage_ModelUpdate,
+        Stage_FrameLevelAnalysis,
+        Stage_PostProcessing,
+        StageCount
+    };
+    /// number of per-pixel loop iterations between two timed pixels (used to split loop time between matching & update)
+    static constexpr size_t s_nPxTimingStride = 32;
+    /// accumulates the time spent in its scope into a stage of a stats object
+    struct ScopedStageTimer {
+        ScopedStageTimer(BackgroundSubtractorStats& oStats, Stage eStage) : m_oStats(oStats), m_eStage(eStage) {}
+        ~ScopedStageTimer() {m_oStats.adStageTimes[m_eStage] += m_oStopWatch.elapsed();}
+    private:
+        BackgroundSubtractorStats& m_oStats;
+        const Stage m_eStage;
+        const lv::StopWatch m_oStopWatch;
+    };
+    /// times a per-pixel loop, and splits its total time between the matching & update stages based on sparse pixel timings
+    struct PxLoopTimer {
+        PxLoopTimer() : m_bTimedPx(false), m_dSampledMatchingTime(0.0), m_dSampledUpdateTime(0.0) {}
+        /// must be called at the start of each pixel iteration (only every s_nPxTimingStride-th one is timed)
+        inline void beginPx(size_t nIter) {
+            m_bTimedPx = (nIter%s_nPxTimingStride)==0;
+            if(m_bTimedPx)
+                m_oPxStopWatch.tick();
+        }
+        /// must be called once sample matching is done for the current pixel
+        inline void endMatching() {
+            if(m_bTimedPx)
+                m_dSampledMatchingTime += m_oPxStopWatch.tock();
+        }
+        /// must be called once the model update is done for the current pixel
+        inline void endPx() {
+            if(m_bTimedPx)
+                m_dSampledUpdateTime += m_oPxStopWatch.elapsed();
+        }
+        /// adds the total loop time (split based on the sampled ratio) to the given stats
+        void commit(BackgroundSubtractorStats& oStats) const {
+            const double dLoopTime = m_oLoopStopWatch.elapsed();
+            const double dSampledTime = m_dSampledMatchingTime+m_dSampledUpdateTime;
+            const double dMatchingRatio = dSampledTime>0.0?m_dSampledMatchingTime/dSampledTime:0.5;
+            oStats.adStageTimes[Stage_SampleMatching] += dLoopTime*dMatchingRatio;
+            oStats.adStageTimes[Stage_ModelUpdate] += dLoopTime*(1.0-dMatchingRatio);
+        }
+    private:
+        bool m_bTimedPx;
+        double m_dSampledMatchingTime, m_dSampledUpdateTime;
+        lv::StopWatch m_oPxStopWatch;
+        const lv::StopWatch m_oLoopStopWatch;
+    };
+    /// default constructor; all stats start at zero
+    BackgroundSubtractorStats() {reset();}
+    /// resets all stats to zero
+    void reset();
+    /// accumulates the stats of another object into this one (used to merge per-thread stats)
+    BackgroundSubtractorStats& operator+=(const BackgroundSubtractorStats& oStats);
+    /// returns the name of a processing stage (also used as its JSON key)
+    static const char* getStageName(Stage eStage);
+    /// returns the total time spent in all stages
+    double getTotalTime() const;
+    /// returns the mean number of model samples tested per pixel before early exit
+    inline double getMeanTestedSamples() const {return nPixels?double(nTestedSamples)/nPixels:0.0;}
+    /// returns the mean number of matched model samples per pixel
+    inline double getMeanMatchedSamples() const {return nPixels?double(nMatchedSamples)/nPixels:0.0;}
+    /// returns all stats as a JSON object string
+    std::string toJSON() const;
+    /// writes all stats as a JSON object to the given file path
+    void writeJSON(const std::string& sFilePath) const;
+    /// cumulative time spent in each stage
+    std::array<double,StageCount> adStageTimes;
+    /// number of processed frames & pixels
+    size_t nFrames, nPixels;
+    /// number of model samples tested (matching stops early once enough samples are found) & matched
+    size_t nTestedSamples, nMatchedSamples;
+    /// number of (partial) model reset events triggered by frame-level analysis
+    size_t nModelResets;
+    /// number of pixels skipped by activity gating (not included in the processed pixel count)
+    size_t nGatedPixels;
+};
+
+/// defines the default value for IIBackgroundSubtractor::m_nGatingBlockSize
+#define BGS_DEFAULT_GATING_BLOCK_SIZE (16)
+/// defines the default value for IIBackgroundSubtractor::m_fGatingNoiseThreshold
+#define BGS_DEFAULT_GATING_NOISE_THRESHOLD (3.0f)
+/// defines the default value for IIBackgroundSubtractor::m_nGatingRefreshPeriod
+#define BGS_DEFAULT_GATING_REFRESH_PERIOD (8)
+/// defines the default value for IIBackgroundSubtractor::m_nReducedResRefineThreshold
+#define BGS_DEFAULT_REDUCED_RES_REFINE_THRESHOLD (20)
+/// defines the learning rate of the low-res background estimate used to refine mask boundaries in reduced-resolution mode
+#define BGS_REDUCED_RES_BG_LEARNING_RATE (0.05)
+/// defines the default value for IIBackgroundSubtractor::m_nMaxConsecutiveSkippedFrames
+#define BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES (2)
+
+/// set of disjoint model LUT index ranges covered by an image region, iterable as a flat sequence of model LUT indices
+struct ModelLUTSpans {
+    /// forward iterator over the model LUT indices of all ranges, in insertion order
+    struct Iterator {
+        size_t operator*() const {return nCurrIdx;}
+        Iterator& operator++() {
+            if(++nCurrIdx==pSpans[nSpanIdx].second && ++nSpanIdx<nSpanCount)
+                nCurrIdx = pSpans[nSpanIdx].first;
+            return *this;
+        }
+        bool operator!=(const Iterator& o) const {return nSpanIdx!=o.nSpanIdx || (nSpanIdx<nSpanCount && nCurrIdx!=o.nCurrIdx);}
+        const std::pair<size_t,size_t>* pSpans;
+        size_t nSpanIdx, nSpanCount, nCurrIdx;
+    };
+    /// appends the [nBeg,nEnd) model LUT index range (empty ranges are skipped, and contiguous ones are merged)
+    void add(size_t nBeg, size_t nEnd) {
+        if(nEnd<=nBeg)
+            return;
+        if(!m_vSpans.empty() && m_vSpans.back().second==nBeg)
+            m_vSpans.back().second = nEnd;
+        else
+            m_vSpans.emplace_back(nBeg,nEnd);
+    }
+    /// returns the total number of model LUT indices covered by all ranges
+    size_t size() const {
+        size_t nCount = 0;
+        for(const auto& oSpan : m_vSpans)
+            nCount += oSpan.second-oSpan.first;
+        return nCount;
+    }
+    /// returns the list of disjoint model LUT index ranges
+    const std::vector<std::pair<size_t,size_t>>& spans() const {return m_vSpans;}
+    Iterator begin() const {return Iterator{m_vSpans.data(),0,m_vSpans.size(),m_vSpans.empty()?0:m_vSpans[0].first};}
+    Iterator end() const {return Iterator{m_vSpans.data(),m_vSpans.size(),m_vSpans.size(),0};}
+private:
+    std::vector<std::pair<size_t,size_t>> m_vSpans;
+};
+
+/// connected foreground region (8-connectivity) extracted from a final segmentation mask
+struct ForegroundBlob {
+    /// bounding box of all blob pixels
+    cv::Rect oBBox;
+    /// number of blob pixels
+    size_t nArea;
+    /// center of mass of all blob pixels
+    cv::Point2f oCentroid;
+    /// horizontal runs of blob pixels as (row, first col, last col+1) triplets in raster order (only filled if requested)
+    std::vector<cv::Vec3i> vRuns;
+};
+
+namespace lv {
+
+    /// converts an 8-bit input image to the channel count of a fixed-layout impl (grayscale inputs are also accepted by 3ch impls, and get expanded)
+    cv::Mat getConvertedInput(const cv::Mat& oInputImg, int nChannels);
+    /// returns the PRNG seed of a tile/band for a given frame, hashed from a per-instance seed (shared by all tiled impls, so their outputs can match)
+    int getTileFrameSeed(uint32_t nSeed, size_t nTileIdx, size_t nFrameIdx);
+
+} // namespace lv
+
 /// super-interface for background subtraction algos which exposes common interface functions
 struct IIBackgroundSubtractor : public cv::BackgroundSubtractor {
 
@@ -33,6 +272,8 @@ struct IIBackgroundSubtractor : public cv::BackgroundSubtractor {
     virtual double getDefaultLearningRate() const = 0;
     /// segments the input image into fg/bg based on the so-far-learned background model, simultanously updating the latter based on 'dLearningRate'
     virtual void apply(cv::InputArray oImage, cv::OutputArray oFGMask, double dLearningRate=-1) = 0;
+    /// segments a batch of consecutive images (for offline use); the default impl simply calls 'apply' on each image in order
+    virtual void applyBatch(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, double dLearningRate=-1);
     /// computes the current empty background image based on model data
     virtual void getBackgroundImage(cv::OutputArray oBackgroundImage) const = 0;
     /// turns automatic model reset on or off
@@ -43,6 +284,40 @@ struct IIBackgroundSubtractor : public cv::BackgroundSubtractor {
     virtual void setROI(cv::Mat& oROI);
     /// returns a copy of the ROI used for input analysis
     virtual cv::Mat getROICopy() const;
+    /// writes the complete model state to a versioned binary snapshot file (algo & model must be initialized)
+    virtual void saveModel(const std::string& sFilePath) const;
+    /// restores the complete model state from a snapshot file written by 'saveModel' (replaces 'initialize'; params must match)
+    virtual void loadModel(const std::string& sFilePath);
+    /// returns whether stats collection was compiled in (see USE_BGS_INSTRUMENTATION)
+    static constexpr bool isInstrumentationEnabled() {return bool(USING_BGS_INSTRUMENTATION);}
+    /// returns the instrumentation stats accumulated since the last 'initialize' or 'resetStats' call (always zero if not compiled in)
+    inline const BackgroundSubtractorStats& getStats() const {return m_oStats;}
+    /// resets the accumulated instrumentation stats
+    inline void resetStats() {m_oStats.reset();}
+    /// toggles activity gating in LOBSTER/SuBSENSE CPU impls (blocks within the noise threshold skip the per-pixel model, and catch up on their updates when refreshed; PAWCS rejects it)
+    void setActivityGating(bool bEnabled, size_t nBlockSize=BGS_DEFAULT_GATING_BLOCK_SIZE, float fNoiseThreshold=BGS_DEFAULT_GATING_NOISE_THRESHOLD, size_t nRefreshPeriod=BGS_DEFAULT_GATING_REFRESH_PERIOD);
+    /// returns whether activity gating is enabled or not
+    inline bool isUsingActivityGating() const {return m_bUsingActivityGating;}
+    /// returns the fraction of blocks which were fully processed for the latest frame (always 1 without activity gating)
+    inline double getActiveBlockRatio() const {return (m_bUsingActivityGating && !m_oGatingBlockMask.empty())?double(m_nActiveBlockCount)/m_oGatingBlockMask.total():1.0;}
+    /// toggles foreground blob extraction, fused into the final mask copy of LBSP-based impls' post-processing (blobs smaller than 'nMinArea' are dropped)
+    void setBlobExtraction(bool bEnabled, bool bWithRuns=false, size_t nMinArea=1);
+    /// returns whether foreground blob extraction is enabled or not
+    inline bool isUsingBlobExtraction() const {return m_bUsingBlobExtraction;}
+    /// returns the blobs of the latest output mask, in raster order of their first pixel (always empty without blob extraction)
+    inline const std::vector<ForegroundBlob>& getLatestBlobs() const {return m_voLatestBlobs;}
+    /// toggles reduced-resolution mode in LBSP-based impls, where the model runs on inputs downscaled by 'nScaleFactor' & mask boundaries are refined at full resolution (applied on next initialization)
+    void setReducedResolution(size_t nScaleFactor, size_t nRefineThreshold=BGS_DEFAULT_REDUCED_RES_REFINE_THRESHOLD);
+    /// returns the downscaling factor applied to inputs before they reach the model (1 = full resolution)
+    inline size_t getReducedResolutionScale() const {return m_nReducedResScale;}
+    /// sets the per-frame processing time budget (in ms) of LOBSTER & SuBSENSE; while over budget, frames skip the model & predict their mask from the previous ones (0 = never skip)
+    void setFrameTimeBudget(double dBudgetMS, size_t nMaxConsecutiveSkippedFrames=BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES);
+    /// returns the per-frame processing time budget (in ms, 0 if disabled)
+    inline double getFrameTimeBudget() const {return m_dFrameTimeBudget;}
+    /// returns whether the latest frame skipped the model (i.e. whether its mask was predicted)
+    inline bool isLastFrameSkipped() const {return m_bLastFrameSkipped;}
+    /// returns the number of frames which skipped the model since the last 'initialize' call
+    inline size_t getSkippedFrameCount() const {return m_nSkippedFrameCount;}
     /// required for derived class destruction from this interface
     virtual ~IIBackgroundSubtractor() = default;
 
@@ -51,6 +326,42 @@ protected:
     IIBackgroundSubtractor();
     /// common (re)initiaization method for all impl types (should be called in impl-specific initialize func)
     virtual void initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI);
+    /// adds the common model state to a snapshot (should be called in impl-specific 'saveModel' func)
+    virtual void saveModel_common(BackgroundModelSnapshot& oSnapshot) const;
+    /// restores the common model state from a snapshot and rebuilds px LUTs (should be called in impl-specific 'loadModel' func)
+    virtual void loadModel_common(const BackgroundModelSnapshot& oSnapshot);
+    /// rebuilds the px index/info LUTs based on the current ROI
+    void initPxLUTs();
+    /// (re)allocates the activity gating maps, using the given image as the initial block reference
+    void initActivityGating(const cv::Mat& oRefImg);
+    /// flags the blocks which must be fully processed for the given input frame (must be called once per frame, before the per-pixel loops)
+    void updateActivityGating(const cv::Mat& oInputImg);
+    /// returns whether the given pixel must be fully processed for the current frame (i.e. if gating is off, or if its block is active)
+    inline bool isPxActive(size_t nPxIter) const {
+        return !m_bUsingActivityGating || m_oGatingBlockMask(m_voPxInfoLUT[nPxIter].nImgCoord_Y/(int)m_nGatingBlockSize,m_voPxInfoLUT[nPxIter].nImgCoord_X/(int)m_nGatingBlockSize);
+    }
+    /// returns the number of frames covered by the current full update of the given pixel (i.e. 1 + the number of frames its block was gated for since its last update)
+    inline size_t getPxGatedFrameCount(size_t nPxIter) const {
+        return m_bUsingActivityGating?(size_t)m_oGatingBlockFrameCount(m_voPxInfoLUT[nPxIter].nImgCoord_Y/(int)m_nGatingBlockSize,m_voPxInfoLUT[nPxIter].nImgCoord_X/(int)m_nGatingBlockSize):size_t(1);
+    }
+    /// copies a final 8UC1 mask to 'oOutput' and, if blob extraction is enabled, labels its foreground runs into 'voBlobs' row by row during the same pass
+    void copyMaskAndExtractBlobs(const cv::Mat& oFGMask, cv::Mat& oOutput, std::vector<ForegroundBlob>& voBlobs) const;
+    /// downscales the init image & ROI in reduced-resolution mode (or passes them through), and resets the low-res background estimate
+    void initReducedResolution(const cv::Mat& oInitImg, const cv::Mat& oROI, cv::Mat& oModelInitImg, cv::Mat& oModelROI);
+    /// returns whether the model was initialized in reduced-resolution mode (i.e. whether inputs & masks need to be rescaled)
+    inline bool isUsingReducedResolution() const {return m_oReducedResInputSize.area()>0;}
+    /// returns the image to feed to the model, i.e. the input itself, or its downscaled version (written in 'oBuffer') in reduced-resolution mode
+    const cv::Mat& getModelInput(const cv::Mat& oInputImg, cv::Mat& oBuffer) const;
+    /// returns the mask the model should write to, i.e. the output itself, or a model-sized scratch mask in reduced-resolution mode
+    cv::Mat getModelOutput(cv::OutputArray oFGMask);
+    /// upscales a model mask to the full-res output, relabeling pixels near its fg/bg boundaries by color distance to the low-res background (reduced-resolution mode only)
+    void refineReducedResMask(const cv::Mat& oInputImg, const cv::Mat& oModelInputImg, const cv::Mat& oModelFGMask, cv::OutputArray oFGMask);
+    /// starts timing a new frame, and returns whether it should skip the model to pay back time spent over budget by previous frames
+    bool beginBudgetedFrame();
+    /// charges the time elapsed since 'beginBudgetedFrame' against the frame time budget
+    void endBudgetedFrame();
+    /// predicts the final mask of a skipped frame by moving each blob of the last mask along its displacement since the mask before it, and copies it to 'oOutput'
+    void predictSkippedFrameMask(cv::Mat& oOutput);
 
     /// basic info struct used in px model LUTs
     struct PxInfoBase {
@@ -90,6 +401,50 @@ protected:
     cv::Mat m_oLastFGMask;
     /// copy of latest pixel intensities (used when refreshing model)
     cv::Mat m_oLastColorFrame;
+    /// per-stage instrumentation stats (only accumulated if USE_BGS_INSTRUMENTATION is enabled)
+    BackgroundSubtractorStats m_oStats;
+    /// specifies whether activity gating is enabled or not
+    bool m_bUsingActivityGating;
+    /// activity gating block size (in pixels), and number of frames between two forced refreshes of a quiet block
+    size_t m_nGatingBlockSize, m_nGatingRefreshPeriod;
+    /// mean absolute block difference (per channel) above which a block is considered active
+    float m_fGatingNoiseThreshold;
+    /// input frame content at the last time each block was fully processed (used as the activity gating reference)
+    cv::Mat m_oGatingRefFrame;
+    /// mean absolute difference between the input frame & the reference frame for each block
+    cv::Mat m_oGatingBlockDiff;
+    /// activity flags of all blocks for the current frame
+    cv::Mat_<uchar> m_oGatingBlockMask;
+    /// number of frames elapsed since the last full update of each block, including the current one (i.e. the frames its next update must account for)
+    cv::Mat_<ushort> m_oGatingBlockFrameCount;
+    /// number of active blocks for the current frame
+    size_t m_nActiveBlockCount;
+    /// specifies whether foreground blob extraction is enabled or not, and whether blob runs are kept
+    bool m_bUsingBlobExtraction, m_bBlobExtractionWithRuns;
+    /// minimum area of extracted foreground blobs
+    size_t m_nBlobMinArea;
+    /// blobs of the latest output mask
+    std::vector<ForegroundBlob> m_voLatestBlobs;
+    /// downscaling factor applied to inputs before they reach the model (1 = full resolution), and the per-channel color distance above which boundary pixels become foreground
+    size_t m_nReducedResScale, m_nReducedResRefineThreshold;
+    /// full-resolution input size in reduced-resolution mode (the model itself runs at 'm_oImgSize')
+    cv::Size m_oReducedResInputSize;
+    /// low-res running background estimate (CV_32F) used to refine mask boundaries in reduced-resolution mode
+    cv::Mat m_oReducedResBGImg;
+    /// pre-allocated matrices used in reduced-resolution mode (model input & output, boundary flags, and refined full-res mask)
+    cv::Mat m_oReducedResInputImg, m_oReducedResFGMask, m_oReducedResBoundaryMask, m_oReducedResRefinedMask;
+    /// per-frame processing time budget (in ms, 0 if disabled), and time spent over budget by previous frames which remains to be paid back
+    double m_dFrameTimeBudget, m_dFrameTimeDebt;
+    /// maximum number of consecutive frames allowed to skip the model, and current count
+    size_t m_nMaxConsecutiveSkippedFrames, m_nConsecutiveSkippedFrames;
+    /// total number of frames which skipped the model since the last initialization
+    size_t m_nSkippedFrameCount;
+    /// specifies whether the latest frame skipped the model or not
+    bool m_bLastFrameSkipped;
+    /// timer of the current budgeted frame
+    lv::StopWatch m_oFrameBudgetStopWatch;
+    /// final mask at [t-2] (used to estimate blob displacements when predicting the mask of a skipped frame)
+    cv::Mat m_oPrevFGMask;
 
 private:
     IIBackgroundSubtractor& operator=(const IIBackgroundSubtractor&) = delete;
@@ -141,6 +496,62 @@ using IBackgroundSubtractor_GLSL = IBackgroundSubtractor_<lv::GLSL>;
 // IBackgroundSubtractor_<lv::OpenCL> will not compile here, missing impl
 #endif //HAVE_OPENCL
 
+/// defines the default value for IBackgroundSubtractor_<lv::CPUThreads>::m_nTileCount
+#define BGS_DEFAULT_CPU_TILE_COUNT (16)
+
+template<>
+struct IBackgroundSubtractor_<lv::CPUThreads> :
+        public lv::IParallelAlgo_CPUThreads,
+        public IIBackgroundSubtractor {
+    /// required for derived class destruction from this interface
+    virtual ~IBackgroundSubtractor_() {}
+    /// sets the number of row tiles the px LUT is split into for parallel processing (results depend on the tile layout & seed only, never on the thread count)
+    void setTileCount(size_t nTileCount);
+    /// returns the number of tiles the px LUT is split into for parallel processing
+    size_t getTileCount() const {return m_oTileSize.area()>0?m_voTiles.size():m_nTileCount;}
+    /// switches to a 2d tile grid of the given size (e.g. to keep each tile's working set in cache), or back to row tiles if the size is empty
+    void setTileSize(const cv::Size& oTileSize);
+    /// returns the 2d tile size used to split the image for parallel processing (empty if using row tiles)
+    const cv::Size& getTileSize() const {return m_oTileSize;}
+    /// sets the base seed used to derive the per-tile PRNG streams
+    void setRandomSeed(uint32_t nSeed) {m_nRandomSeed = nSeed;}
+    /// returns the base seed used to derive the per-tile PRNG streams
+    uint32_t getRandomSeed() const {return m_nRandomSeed;}
+
+protected:
+    /// multi-threaded cpu impl constructor (a null thread count means one worker per hardware thread)
+    IBackgroundSubtractor_(size_t nThreadCount=0, size_t nTileCount=BGS_DEFAULT_CPU_TILE_COUNT, uint32_t nSeed=0);
+    /// common (re)initiaization method; also rebuilds the tile LUT once the px LUTs are ready
+    virtual void initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI) override;
+    /// restores the common model state from a snapshot; also rebuilds the tile LUT once the px LUTs are ready
+    virtual void loadModel_common(const BackgroundModelSnapshot& oSnapshot) override;
+    /// rebuilds the tile LUT based on the current px LUT & tile count/size
+    void initTiles();
+    /// returns the seed of the PRNG stream used by a tile for the current frame (derived from the base seed, frame index & tile index)
+    int getTileSeed(size_t nTileIdx) const {return getTileSeed(nTileIdx,m_nFrameIdx);}
+    /// returns the seed of the PRNG stream used by a tile for a given frame (used when several frames are processed per tile)
+    int getTileSeed(size_t nTileIdx, size_t nFrameIdx) const;
+    /// runs 'lTileFunc(nTileIdx)' for all tiles on the worker pool, and blocks until all are done (per-tile scratch data should be indexed by tile, not by worker)
+    void processTiles(const std::function<void(size_t)>& lTileFunc);
+    /// tile info used to split the px LUT for parallel processing
+    struct TileInfo {
+        /// model LUT index ranges covered by this tile (one per row for 2d tiles, merged into one for row tiles)
+        ModelLUTSpans oModelIters;
+        /// image region covered by this tile; neighbor updates which fall outside of it must be deferred
+        cv::Rect oRect;
+    };
+    /// number of row tiles the px LUT is split into (only used if the 2d tile size is empty)
+    size_t m_nTileCount;
+    /// 2d tile size used to split the px LUT (empty = row tiles)
+    cv::Size m_oTileSize;
+    /// base seed used to derive per-tile PRNG streams
+    uint32_t m_nRandomSeed;
+    /// tile LUT used to split the px LUT (rebuilt on every (re)initialization)
+    std::vector<TileInfo> m_voTiles;
+};
+
+using IBackgroundSubtractor_CPUThreads = IBackgroundSubtractor_<lv::CPUThreads>;
+
 template<>
 struct IBackgroundSubtractor_<lv::NonParallel> :
         public lv::NonParallelAlgo,
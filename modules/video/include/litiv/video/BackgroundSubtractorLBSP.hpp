@@ -26,6 +26,188 @@
 #define BGSLBSP_DEFAULT_LBSP_OFFSET_SIMILARITY_THRESHOLD (0)
 /// defines the default value for BackgroundSubtractorLBSP::m_nDefaultMedianBlurKernelSize
 #define BGSLBSP_DEFAULT_MEDIAN_BLUR_KERNEL_SIZE (9)
+/// defines the default value for BackgroundSubtractorLBSP::m_eSampleLayout
+#define BGSLBSP_DEFAULT_SAMPLE_LAYOUT (LBSPSampleStore::PixelMajor)
+/// defines the default value for BackgroundSubtractorLBSP::m_bUseSampleReordering
+#define BGSLBSP_DEFAULT_SAMPLE_REORDERING (false)
+
+/**
+    Background model sample store used by CPU-based LBSP subtractors (holds N color & LBSP descriptor samples per pixel).
+
+    Two memory layouts are offered: 'SampleMajor' keeps one full frame per sample (as the original impls did), and
+    'PixelMajor' keeps all color samples followed by all descriptor samples of a pixel in one contiguous block padded
+    to a cache line, which keeps the per-pixel sample matching loop from touching one cache line per sample.
+*/
+struct LBSPSampleStore {
+    /// sample memory layout types
+    enum Layout {
+        /// one full frame per sample; sample 's' of all pixels is contiguous
+        SampleMajor,
+        /// all samples of a pixel are contiguous; each pixel block is aligned/padded to s_nPxBlockAlign bytes
+        PixelMajor,
+    };
+    /// byte alignment of pixel blocks in pixel-major layout (one cache line)
+    static constexpr size_t s_nPxBlockAlign = 64;
+    /// byte alignment of the descriptor sub-block in pixel-major layout (allows aligned SIMD loads)
+    static constexpr size_t s_nDescBlockAlign = 16;
+    /// default constructor; the store stays empty until 'create' is called
+    LBSPSampleStore();
+    /// (re)allocates the store for a given layout, sample count, frame size and channel count; all samples are zeroed
+    void create(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels);
+    /// wraps an external data block (e.g. a mapped model snapshot) laid out as 'create' would; 'pOwner' keeps the block alive until the store is reallocated
+    void wrap(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels, uchar* pData, size_t nDataSize, std::shared_ptr<void> pOwner);
+    /// returns a pointer to the 'channels()' color values of sample 's' for pixel 'nPxIdx'
+    inline uchar* color(size_t s, size_t nPxIdx) {
+        lvDbgAssert(s<m_nSamples && nPxIdx<m_nPxCount);
+        return m_pData+s*m_nColorSampleStep+nPxIdx*m_nColorPxStep;
+    }
+    /// returns a pointer to the 'channels()' color values of sample 's' for pixel 'nPxIdx'
+    inline const uchar* color(size_t s, size_t nPxIdx) const {
+        lvDbgAssert(s<m_nSamples && nPxIdx<m_nPxCount);
+        return m_pData+s*m_nColorSampleStep+nPxIdx*m_nColorPxStep;
+    }
+    /// returns a pointer to the 'channels()' descriptor values of sample 's' for pixel 'nPxIdx'
+    inline ushort* desc(size_t s, size_t nPxIdx) {
+        lvDbgAssert(s<m_nSamples && nPxIdx<m_nPxCount);
+        return (ushort*)(m_pData+m_nDescOffset+s*m_nDescSampleStep+nPxIdx*m_nDescPxStep);
+    }
+    /// returns a pointer to the 'channels()' descriptor values of sample 's' for pixel 'nPxIdx'
+    inline const ushort* desc(size_t s, size_t nPxIdx) const {
+        lvDbgAssert(s<m_nSamples && nPxIdx<m_nPxCount);
+        return (const ushort*)(m_pData+m_nDescOffset+s*m_nDescSampleStep+nPxIdx*m_nDescPxStep);
+    }
+    /// returns the byte offset between two consecutive color samples of the same pixel
+    inline size_t colorSampleStep() const {return m_nColorSampleStep;}
+    /// returns the byte offset between two consecutive descriptor samples of the same pixel
+    inline size_t descSampleStep() const {return m_nDescSampleStep;}
+    /// returns the memory layout used by the store
+    inline Layout layout() const {return m_eLayout;}
+    /// returns the number of samples per pixel
+    inline size_t samples() const {return m_nSamples;}
+    /// returns the number of channels per sample
+    inline size_t channels() const {return m_nChannels;}
+    /// returns the total byte size of the store (including padding)
+    inline size_t size() const {return m_nDataSize;}
+    /// returns whether the store has been allocated or not
+    inline bool empty() const {return m_pData==nullptr;}
+    /// returns a pointer to the raw sample data block (of 'size()' bytes)
+    inline const uchar* data() const {return m_pData;}
+    LBSPSampleStore(const LBSPSampleStore&) = delete;
+    LBSPSampleStore& operator=(const LBSPSampleStore&) = delete;
+protected:
+    /// sets up the layout strides for the given dimensions, and returns the total byte size of the store
+    size_t setupLayout(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels);
+    /// raw sample data (color and descriptor sub-blocks, packed according to the layout), when owned by the store
+    lv::aligned_vector<uchar,s_nPxBlockAlign> m_vData;
+    /// holds external sample data alive, when wrapped by the store
+    std::shared_ptr<void> m_pExternalOwner;
+    /// pointer to the sample data block in use (owned or wrapped) & its byte size
+    uchar* m_pData;
+    size_t m_nDataSize;
+    /// memory layout used by the store
+    Layout m_eLayout;
+    /// number of samples/pixels/channels held in the store
+    size_t m_nSamples, m_nPxCount, m_nChannels;
+    /// byte offset of the first descriptor sample in the data block
+    size_t m_nDescOffset;
+    /// byte offsets between consecutive samples/pixels for color and descriptor data
+    size_t m_nColorSampleStep, m_nColorPxStep, m_nDescSampleStep, m_nDescPxStep;
+};
+
+/**
+    Batch background sample matcher used by CPU-based LBSP subtractors (tests up to s_nBatchSize samples at once).
+
+    Sample colors, descriptors and LBSP thresholds are gathered into 16-bit planar lanes, inter-LBSP descriptors are
+    computed for all samples at once, and Hamming/color distances are checked against all thresholds in registers
+    (AVX2 or SSE2 when available, with a scalar fallback). The returned bitmask flags the samples that matched, in
+    sample order, so that the caller can consume them up to its required match count, as the original loops did. Callers
+    should walk samples in 'getBatchSize' steps: the first batch only holds a few samples, so pixels which match their
+    first samples (i.e. most static background pixels) do not pay for a full-width batch.
+*/
+struct LBSPSampleMatcher {
+    /// maximum number of samples tested in a single batch (one bit per sample in the returned mask)
+    static constexpr size_t s_nBatchSize = 16;
+    /// number of samples tested in the first batch of a pixel (kept small so that well-modeled pixels can still exit early)
+    static constexpr size_t s_nFirstBatchSize = 4;
+    /// returns the size of the batch starting at sample 'nFirstSample' out of 'nSamples' (the first batch is narrow, the following ones are full-width)
+    static inline size_t getBatchSize(size_t nFirstSample, size_t nSamples) {
+        return std::min(nFirstSample?s_nBatchSize:s_nFirstBatchSize,nSamples-nFirstSample);
+    }
+    /// returns how many samples of a batch a sequential loop would have tested, i.e. up to the one bringing the match count to 'nMissingMatches' (or 'nBatchSize' if never reached)
+    static inline size_t getTestedCount(uint32_t nGoodMask, size_t nBatchSize, size_t nMissingMatches) {
+        for(size_t nBatchIdx=0; nBatchIdx<nBatchSize; ++nBatchIdx, nGoodMask>>=1)
+            if((nGoodMask&1) && --nMissingMatches==0)
+                return nBatchIdx+1;
+        return nBatchSize;
+    }
+    /// distance thresholds used for matching (all values are inclusive upper bounds)
+    struct Thresholds {
+        /// per-channel color distance threshold
+        size_t nColorDist;
+        /// per-channel descriptor distance threshold
+        size_t nDescDist;
+        /// per-channel 'sum' distance threshold (mixed color + scaled descriptor distance)
+        size_t nSumDist;
+        /// total (all-channel) descriptor distance threshold
+        size_t nTotDescDist;
+        /// total (all-channel) 'sum' distance threshold (i.e. color distance if sum distances are disabled)
+        size_t nTotSumDist;
+        /// defines whether descriptor distances average intra- & inter-LBSP distances (SuBSENSE) or only use inter-LBSP distances (LOBSTER)
+        bool bUseIntraDesc;
+        /// right shift applied to descriptor distances before scaling/adding them to color distances (0 = sum distances are plain color distances)
+        int nSumDistDescShift;
+    };
+    /**
+        Tests samples [nFirstSample,nFirstSample+nBatchSize) of pixel 'nPxIdx' against the current pixel values.
+
+        @param oSamples background sample store to read sample colors and descriptors from
+        @param nPxIdx index of the pixel to test
+        @param nFirstSample index of the first sample to test
+        @param nBatchSize number of samples to test (must be in [1,s_nBatchSize])
+        @param anCurrColor current pixel color values (nChannels)
+        @param anCurrIntraDesc current pixel intra-LBSP descriptors (nChannels; only used if 'bUseIntraDesc' is set)
+        @param anLookupVals current pixel LBSP lookup values (nChannels*16, channel-major)
+        @param anLBSPThresholdLUT LBSP threshold values for all possible 8-bit intensities
+        @param oThresholds distance thresholds used for matching
+        @param anTotDescDist output total descriptor distances for each tested sample (s_nBatchSize, may be null)
+        @param anTotSumDist output total 'sum' distances for each tested sample (s_nBatchSize, may be null)
+        @return bitmask of the matched samples (bit 'i' is set if sample nFirstSample+i matched)
+    */
+    template<size_t nChannels>
+    static uint32_t matchBatch(const LBSPSampleStore& oSamples, size_t nPxIdx, size_t nFirstSample, size_t nBatchSize,
+                               const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                               const uchar* anLBSPThresholdLUT, const Thresholds& oThresholds,
+                               ushort* anTotDescDist, ushort* anTotSumDist);
+    /**
+        Match order tracker used for move-to-front sample reordering: records the samples of a pixel which matched beyond the first
+        batch, and then swaps them into unmatched slots of the first batch so that they get tested first on the next frame. The pixel's
+        sample set is left unchanged, so random-slot model updates keep the same semantics.
+    */
+    struct MatchReorderer {
+        /// records the matched samples of the batch starting at 'nFirstSample' (as returned by 'matchBatch')
+        inline void addBatch(size_t nFirstSample, uint32_t nGoodMask) {
+            if(nFirstSample==0)
+                nFirstBatchGoodMask = nGoodMask;
+            else
+                for(size_t nBatchIdx=0; nGoodMask && nLateMatches<s_nFirstBatchSize; ++nBatchIdx, nGoodMask>>=1)
+                    if(nGoodMask&1)
+                        anLateMatchIdxs[nLateMatches++] = nFirstSample+nBatchIdx;
+        }
+        /// swaps the recorded late matches of pixel 'nPxIdx' toward the front of its samples (no-op if all matches were in the first batch)
+        inline void promote(LBSPSampleStore& oSamples, size_t nPxIdx) const {
+            if(nLateMatches)
+                promote_impl(oSamples,nPxIdx);
+        }
+        /// bitmask of the matched samples of the first batch
+        uint32_t nFirstBatchGoodMask = 0;
+        /// number of recorded matches beyond the first batch
+        size_t nLateMatches = 0;
+        /// indices of the recorded matches beyond the first batch
+        std::array<size_t,s_nFirstBatchSize> anLateMatchIdxs;
+    private:
+        void promote_impl(LBSPSampleStore& oSamples, size_t nPxIdx) const;
+    };
+};
 
 /**
     Local Binary Similarity Pattern (LBSP) algorithm interface for FG/BG video segmentation via change detection.
@@ -39,6 +221,14 @@ struct IBackgroundSubtractorLBSP_ : public IBackgroundSubtractor_<eImpl> {
 
     /// returns a copy of the latest reconstructed background descriptors image
     virtual void getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const = 0;
+    /// sets the sample store memory layout used by CPU impls (only applied on the next 'initialize' call)
+    inline void setSampleLayout(LBSPSampleStore::Layout eLayout) {m_eSampleLayout = eLayout;}
+    /// returns the sample store memory layout used by CPU impls
+    inline LBSPSampleStore::Layout getSampleLayout() const {return m_eSampleLayout;}
+    /// toggles move-to-front sample reordering in CPU impls (samples which matched late get swapped toward the first batch, shortening early-exit paths)
+    inline void setSampleReordering(bool bEnabled) {m_bUseSampleReordering = bEnabled;}
+    /// returns whether move-to-front sample reordering is enabled or not
+    inline bool isUsingSampleReordering() const {return m_bUseSampleReordering;}
 
 protected:
     /// default impl constructor (defined here as MSVC is very prude with template-class-template-cstor-definitions)
@@ -46,10 +236,12 @@ protected:
     IBackgroundSubtractorLBSP_(float fRelLBSPThreshold=BGSLBSP_DEFAULT_LBSP_REL_SIMILARITY_THRESHOLD,
                                size_t nLBSPThresholdOffset=BGSLBSP_DEFAULT_LBSP_OFFSET_SIMILARITY_THRESHOLD,
                                int nDefaultMedianBlurKernelSize=BGSLBSP_DEFAULT_MEDIAN_BLUR_KERNEL_SIZE,
-                               std::enable_if_t<eImplTemp==lv::NonParallel>* /*pUnused*/=0) :
+                               std::enable_if_t<eImplTemp==lv::NonParallel || eImplTemp==lv::CPUThreads>* /*pUnused*/=0) :
             m_nLBSPThresholdOffset(nLBSPThresholdOffset),
             m_fRelLBSPThreshold(fRelLBSPThreshold),
-            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize) {
+            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize),
+            m_eSampleLayout(BGSLBSP_DEFAULT_SAMPLE_LAYOUT),
+            m_bUseSampleReordering(BGSLBSP_DEFAULT_SAMPLE_REORDERING) {
         lvAssert_(m_fRelLBSPThreshold>=0,"relative threshold for LBSP features must be non-negative");
         IIBackgroundSubtractor::m_nROIBorderSize = LBSP::PATCH_SIZE/2;
     }
@@ -66,7 +258,9 @@ protected:
             IBackgroundSubtractor_GLSL(nLevels,nComputeStages,nExtraSSBOs,nExtraACBOs,nExtraImages,nExtraTextures,nDebugType,bUseDisplay,bUseTimers,bUseIntegralFormat),
             m_nLBSPThresholdOffset(nLBSPThresholdOffset),
             m_fRelLBSPThreshold(fRelLBSPThreshold),
-            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize) {
+            m_nDefaultMedianBlurKernelSize(nDefaultMedianBlurKernelSize),
+            m_eSampleLayout(BGSLBSP_DEFAULT_SAMPLE_LAYOUT),
+            m_bUseSampleReordering(BGSLBSP_DEFAULT_SAMPLE_REORDERING) {
         lvAssert_(m_fRelLBSPThreshold>=0,"relative threshold for LBSP features must be non-negative");
         IIBackgroundSubtractor::m_nROIBorderSize = LBSP::PATCH_SIZE/2;
     }
@@ -87,6 +281,10 @@ protected:
     virtual ~IBackgroundSubtractorLBSP_() {}
     /// common (re)initiaization method for all impl types (should be called in impl-specific initialize func)
     virtual void initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI) override;
+    /// adds the common LBSP model state to a snapshot (should be called in impl-specific 'saveModel' func)
+    virtual void saveModel_common(BackgroundModelSnapshot& oSnapshot) const override;
+    /// restores the common LBSP model state from a snapshot (should be called in impl-specific 'loadModel' func)
+    virtual void loadModel_common(const BackgroundModelSnapshot& oSnapshot) override;
     /// LBSP internal threshold offset value, used to reduce texture noise in dark regions
     const size_t m_nLBSPThresholdOffset;
     /// LBSP relative internal threshold (kept here since we don't keep an LBSP object)
@@ -97,6 +295,10 @@ protected:
     const int m_nDefaultMedianBlurKernelSize;
     /// copy of latest descriptors (used when refreshing model)
     cv::Mat m_oLastDescFrame;
+    /// sample store memory layout to use on the next initialization (only used by CPU impls)
+    LBSPSampleStore::Layout m_eSampleLayout;
+    /// specifies whether move-to-front sample reordering is enabled or not (only used by LOBSTER/SuBSENSE CPU impls)
+    bool m_bUseSampleReordering;
 };
 
 #if HAVE_GLSL
@@ -108,4 +310,5 @@ using IBackgroundSubtractorLBSP_GLSL = IBackgroundSubtractorLBSP_<lv::GLSL>;
 #if HAVE_OPENCL
 //using IBackgroundSubtractorLBSP_OpenCL = IBackgroundSubtractorLBSP_<lv::OpenCL>;
 #endif //HAVE_OPENCL
+using IBackgroundSubtractorLBSP_CPUThreads = IBackgroundSubtractorLBSP_<lv::CPUThreads>;
 using IBackgroundSubtractorLBSP = IBackgroundSubtractorLBSP_<lv::NonParallel>;
@@ -74,6 +74,9 @@ using IBackgroundSubtractorLOBSTER_GLSL = IBackgroundSubtractorLOBSTER_<lv::GLSL
 template<>
 IBackgroundSubtractorLOBSTER_GLSL::IBackgroundSubtractorLOBSTER_(size_t nDescDistThreshold, size_t nColorDistThreshold, size_t nBGSamples, size_t nRequiredBGSamples, size_t nLBSPThresholdOffset, float fRelLBSPThreshold);
 #endif //HAVE_GLSL
+using IBackgroundSubtractorLOBSTER_CPUThreads = IBackgroundSubtractorLOBSTER_<lv::CPUThreads>;
+template<>
+IBackgroundSubtractorLOBSTER_CPUThreads::IBackgroundSubtractorLOBSTER_(size_t nDescDistThreshold, size_t nColorDistThreshold, size_t nBGSamples, size_t nRequiredBGSamples, size_t nLBSPThresholdOffset, float fRelLBSPThreshold);
 
 template<lv::ParallelAlgoType eImpl>
 struct BackgroundSubtractorLOBSTER_;
@@ -129,27 +132,60 @@ using BackgroundSubtractorLOBSTER_GLSL = BackgroundSubtractorLOBSTER_<lv::GLSL>;
 // BackgroundSubtractorLOBSTER_<lv::OpenCL> will not compile here, missing impl
 #endif //HAVE_OPENCL
 
-template<>
-struct BackgroundSubtractorLOBSTER_<lv::NonParallel> : public IBackgroundSubtractorLOBSTER {
+/// default CPU impl, shared by the non-parallel & multi-threaded algo types (only the pixel loop dispatch differs)
+template<lv::ParallelAlgoType eImpl>
+struct BackgroundSubtractorLOBSTER_ : public IBackgroundSubtractorLOBSTER_<eImpl> {
+    static_assert(eImpl==lv::NonParallel || eImpl==lv::CPUThreads,"missing LOBSTER impl for this algo type");
 public:
     /// full constructor
-    using IBackgroundSubtractorLOBSTER::IBackgroundSubtractorLOBSTER;
+    using IBackgroundSubtractorLOBSTER_<eImpl>::IBackgroundSubtractorLOBSTER_;
     /// refreshes all samples based on the last analyzed frame
     void refreshModel(float fSamplesRefreshFrac, bool bForceFGUpdate=false);
     /// (re)initiaization method; needs to be called before starting background subtraction
     virtual void initialize(const cv::Mat& oInitImg, const cv::Mat& oROI) override;
     /// model update/segmentation function (synchronous version); the learning param is reinterpreted as an integer and should be > 0 (smaller values == faster adaptation)
     virtual void apply(cv::InputArray oImage, cv::OutputArray oFGMask, double dLearningRate=BGSLOBSTER_DEFAULT_LEARNING_RATE) override;
+    /// segments a batch of consecutive images, running several frames through each tile while its model is hot in cache (results are identical to calling 'apply' on each image)
+    virtual void applyBatch(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, double dLearningRate=BGSLOBSTER_DEFAULT_LEARNING_RATE) override;
     /// returns a copy of the latest reconstructed background image
     virtual void getBackgroundImage(cv::OutputArray oBGImg) const override;
     /// returns a copy of the latest reconstructed background descriptors image
     virtual void getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const override;
 
 protected:
-    /// background model pixel intensity samples
-    std::vector<cv::Mat> m_voBGColorSamples;
-    /// background model descriptors samples
-    std::vector<cv::Mat> m_voBGDescSamples;
+    /// neighbor model update which crosses a tile border; kept aside during parallel processing, and committed afterwards in tile order
+    struct DeferredNeighborUpdate {
+        /// index of the neighbor pixel whose model will be updated
+        size_t nDstPxIdx;
+        /// index of the model sample to overwrite
+        size_t nSampleIdx;
+        /// color & descriptor values to write in the sample
+        std::array<uchar,3> anColor;
+        std::array<ushort,3> anDesc;
+    };
+    /// processes the given model LUT pixels using 'lRand' as the PRNG; neighbor updates outside 'oTileRect' are deferred if 'pvDeferredUpdates' is given, and counters go to 'oStats'
+    template<typename TRandGen>
+    void apply_range(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, const ModelLUTSpans& oModelIters, const cv::Rect& oTileRect,
+                     TRandGen&& lRand, size_t nLearningRate, std::vector<DeferredNeighborUpdate>* pvDeferredUpdates, BackgroundSubtractorStats& oStats);
+    /// processes all model LUT pixels (serially in the non-parallel impl, or tile by tile on the worker pool in the multi-threaded impl)
+    void apply_all(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate);
+    /// processes all model LUT pixels for a batch of images (frame by frame in the non-parallel impl, or tile by tile along a frame wavefront in the multi-threaded impl)
+    void apply_batch_all(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, size_t nLearningRate);
+    /// background model pixel intensity & descriptor samples
+    LBSPSampleStore m_oBGSamples;
+    /// per-tile neighbor updates deferred during the last 'apply' call, or per-frame then per-tile for 'applyBatch' (only used in the multi-threaded impl)
+    std::vector<std::vector<DeferredNeighborUpdate>> m_vvDeferredUpdates;
+    /// per-tile instrumentation stats accumulated during the last 'apply' or 'applyBatch' call (only used in instrumented builds of the multi-threaded impl)
+    std::vector<BackgroundSubtractorStats> m_voTileStats;
 };
 
+using BackgroundSubtractorLOBSTER_CPUThreads = BackgroundSubtractorLOBSTER_<lv::CPUThreads>;
 using BackgroundSubtractorLOBSTER = BackgroundSubtractorLOBSTER_<lv::NonParallel>;
+template<>
+void BackgroundSubtractorLOBSTER_CPUThreads::apply_all(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate);
+template<>
+void BackgroundSubtractorLOBSTER_CPUThreads::apply_batch_all(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, size_t nLearningRate);
+template<>
+void BackgroundSubtractorLOBSTER::apply_all(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate);
+template<>
+void BackgroundSubtractorLOBSTER::apply_batch_all(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, size_t nLearningRate);
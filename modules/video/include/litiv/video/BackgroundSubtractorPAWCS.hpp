@@ -65,6 +65,14 @@ public:
     virtual void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const override;
     /// returns the default learning rate value used in 'apply'
     virtual double getDefaultLearningRate() const override {return 0;}
+    /// toggles the color prefilter used to skip LBSP distance computations for local words which cannot match (results are unaffected)
+    inline void setColorPrefilter(bool bEnabled) {m_bUseColorPrefilter = bEnabled;}
+    /// returns whether the local word color prefilter is enabled
+    inline bool isUsingColorPrefilter() const {return m_bUseColorPrefilter;}
+    /// writes the complete model state (word lists, dictionaries, adaptive maps & counters) to a versioned binary snapshot file
+    virtual void saveModel(const std::string& sFilePath) const override;
+    /// restores the complete model state from a snapshot file (dictionary pointers are rebuilt from stored word indices)
+    virtual void loadModel(const std::string& sFilePath) override;
 
 protected:
     template<size_t nChannels>
@@ -96,7 +104,6 @@ protected:
     typedef GlobalWord<ColorLBSPFeature<3>> GlobalWord_3ch;
     struct PxInfo_PAWCS : PxInfoBase {
         size_t nGlobalWordMapLookupIdx;
-        std::vector<GlobalWordBase*> vpGlobalDictSortLUT;
     };
     /// absolute minimal color distance threshold ('R' or 'radius' in the original ViBe paper, used as the default/initial 'R(x)' value here)
     const size_t m_nMinColorDistThreshold;
@@ -120,19 +127,21 @@ protected:
     size_t m_nDownSampledROIPxCount;
     /// current local word weight offset
     size_t m_nLocalWordWeightOffset;
+    /// defines whether local words are prefiltered by color distance before computing LBSP distances
+    bool m_bUseColorPrefilter;
 
-    /// word lists & dictionaries
-    std::vector<LocalWordBase*> m_vpLocalWordDict;
+    /// local words, stored contiguously per pixel (m_nCurrLocalWords entries per ROI pixel, indexed by model idx, sorted by decreasing weight)
     std::vector<LocalWord_1ch> m_voLocalWordList_1ch;
     std::vector<LocalWord_3ch> m_voLocalWordList_3ch;
-    std::vector<LocalWord_1ch>::iterator m_pLocalWordListIter_1ch;
-    std::vector<LocalWord_3ch>::iterator m_pLocalWordListIter_3ch;
+    /// global word lists & dictionaries
     std::vector<GlobalWordBase*> m_vpGlobalWordDict;
     std::vector<GlobalWord_1ch> m_voGlobalWordList_1ch;
     std::vector<GlobalWord_3ch> m_voGlobalWordList_3ch;
     std::vector<GlobalWord_1ch>::iterator m_pGlobalWordListIter_1ch;
     std::vector<GlobalWord_3ch>::iterator m_pGlobalWordListIter_3ch;
     std::vector<PxInfo_PAWCS> m_voPxInfoLUT_PAWCS;
+    /// per-pixel global word sort LUTs, stored contiguously (m_nCurrGlobalWords entries per ROI pixel, indexed by model idx)
+    std::vector<GlobalWordBase*> m_vpGlobalDictSortLUT;
 
     /// a lookup map used to keep track of regions where illumination recently changed
     cv::Mat m_oIllumUpdtRegionMask;
@@ -169,6 +178,15 @@ protected:
     cv::Mat m_oTempGlobalWordWeightDiffFactor;
     cv::Mat m_oMorphExStructElement;
 
+    /// returns the list of named per-pixel state maps which are saved in model snapshots
+    std::vector<std::pair<const char*,cv::Mat*>> getModelStateMaps();
+    /// adds the word lists & dictionaries to a snapshot, and writes it (pointers are stored as word list indices)
+    template<typename TLocalWord, typename TGlobalWord>
+    void saveModel_words(BackgroundModelSnapshot& oSnapshot, const std::string& sFilePath, const std::vector<TLocalWord>& voLocalWordList, const std::vector<TGlobalWord>& voGlobalWordList) const;
+    /// restores the word lists & dictionaries from a snapshot (pointers are rebuilt from word list indices)
+    template<typename TLocalWord, typename TGlobalWord>
+    void loadModel_words(const BackgroundModelSnapshot& oSnapshot, std::vector<TLocalWord>& voLocalWordList, std::vector<TGlobalWord>& voGlobalWordList);
+
     /// internal weight lookup function for local words
     static float GetLocalWordWeight(const LocalWordBase& w, size_t nCurrFrame, size_t nOffset);
     /// internal weight lookup function for global words
@@ -36,6 +36,7 @@
 //
 // @@@@@@@@
 
+#include "litiv/utils/math.hpp"
 #include <opencv2/video/background_segm.hpp>
 
 /// defines the internal threshold adjustment factor to use when determining if the variation of a single channel is enough to declare the pixel as foreground
@@ -167,3 +168,42 @@ public:
     /// primary model update function; the learning param is used to override the internal learning speed (ignored when <= 0)
     virtual void apply(cv::InputArray image, cv::OutputArray fgmask, double learningRateOverride=BGSPBAS_DEFAULT_LEARNING_RATE_OVERRIDE);
 };
+
+/// PBAS foreground-background segmentation algorithm (vectorized version w/ pixel-major sample storage, SIMD distance computation & per-instance fastrand PRNG)
+template<size_t nChannels>
+class BackgroundSubtractorPBAS_vec : public BackgroundSubtractorPBAS {
+    static_assert(nChannels==1 || nChannels==3,"vectorized PBAS only supports 1ch and 3ch inputs");
+public:
+    /// full constructor
+    BackgroundSubtractorPBAS_vec(size_t nInitColorDistThreshold=BGSPBAS_DEFAULT_COLOR_DIST_THRESHOLD,
+                                 float fInitUpdateRate=BGSPBAS_DEFAULT_LEARNING_RATE,
+                                 size_t nBGSamples=BGSPBAS_DEFAULT_NB_BG_SAMPLES,
+                                 size_t nRequiredBGSamples=BGSPBAS_DEFAULT_REQUIRED_NB_BG_SAMPLES);
+    /// default destructor
+    virtual ~BackgroundSubtractorPBAS_vec();
+    /// (re)initiaization method; needs to be called before starting background subtraction
+    virtual void initialize(const cv::Mat& oInitImg);
+    /// primary model update function; the learning param is used to override the internal learning speed (ignored when <= 0)
+    virtual void apply(cv::InputArray image, cv::OutputArray fgmask, double learningRateOverride=BGSPBAS_DEFAULT_LEARNING_RATE_OVERRIDE);
+    /// returns a copy of the latest reconstructed background image
+    virtual void getBackgroundImage(cv::OutputArray backgroundImage) const;
+    /// sets the seed used to reset the internal PRNG state on the next call to 'initialize'
+    void setRandomSeed(uint32_t nSeed);
+
+protected:
+    /// sample count per pixel & channel, padded up to the SIMD block size
+    size_t m_nSampleStride;
+    /// background model pixel intensity & gradient samples, stored pixel-major as [px][color channels, then gradient channels][sample]
+    lv::aligned_vector<uchar,16> m_vnBGSamples;
+    /// seed used to reset the internal PRNG state on initialization
+    uint32_t m_nRandSeed;
+    /// internal PRNG (used for both model initialization and updates)
+    lv::FastRandGen4 m_oRandGen;
+    /// defines whether the SIMD kernels are used (otherwise, the scalar fallback is used; ignored in builds without SSE2)
+    bool m_bUseSIMD;
+};
+
+/// PBAS foreground-background segmentation algorithm (1ch/grayscale vectorized version)
+using BackgroundSubtractorPBAS_1ch_vec = BackgroundSubtractorPBAS_vec<1>;
+/// PBAS foreground-background segmentation algorithm (3ch/RGB vectorized version)
+using BackgroundSubtractorPBAS_3ch_vec = BackgroundSubtractorPBAS_vec<3>;
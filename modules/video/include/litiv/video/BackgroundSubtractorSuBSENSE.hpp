@@ -29,6 +29,8 @@
 #define BGSSUBSENSE_DEFAULT_REQUIRED_NB_BG_SAMPLES (2)
 /// defines the default value for BackgroundSubtractorSuBSENSE::m_nSamplesForMovingAvgs
 #define BGSSUBSENSE_DEFAULT_N_SAMPLES_FOR_MV_AVGS (100)
+/// defines the default value for BackgroundSubtractorSuBSENSE::m_nParallelBandCount (0 = legacy single-threaded pixel loop)
+#define BGSSUBSENSE_DEFAULT_PARALLEL_BAND_COUNT (0)
 
 /**
     Self-Balanced Sensitivity segmenTER (SuBSENSE) algorithm for FG/BG video segmentation via change detection.
@@ -36,17 +38,15 @@
     Note: both grayscale and RGB/BGR images may be used with this extractor (parameters are adjusted automatically).
     For optimal grayscale results, use CV_8UC1 frames instead of CV_8UC3.
 
-    For now, only the algorithm's default CPU implementation is offered here.
+    For now, only the algorithm's CPU implementations are offered here (non-parallel, or multi-threaded via lv::CPUThreads).
 
     For more details on the different parameters or on the algorithm itself, see P.-L. St-Charles et al.,
     "Flexible Background Subtraction With Self-Balanced Local Sensitivity", in CVPRW 2014, or "SuBSENSE: A Universal
     Change Detection Method With Local Adaptive Sensitivity", in IEEE Trans. Image Processing vol.24 no.1, 2015.
 */
 template<lv::ParallelAlgoType eImpl>
-struct BackgroundSubtractorSuBSENSE_;
-
-template<>
-struct BackgroundSubtractorSuBSENSE_<lv::NonParallel> : public IBackgroundSubtractorLBSP {
+struct BackgroundSubtractorSuBSENSE_ : public IBackgroundSubtractorLBSP_<eImpl> {
+    static_assert(eImpl==lv::NonParallel || eImpl==lv::CPUThreads,"missing SuBSENSE impl for this algo type");
 public:
     /// full constructor
     BackgroundSubtractorSuBSENSE_(size_t nDescDistThresholdOffset=BGSSUBSENSE_DEFAULT_DESC_DIST_THRESHOLD_OFFSET,
@@ -67,8 +67,114 @@ public:
     void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const override;
     /// returns the default learning rate value used in 'apply'
     virtual double getDefaultLearningRate() const override {return 0;}
+    /// writes the complete model state (samples, adaptive maps & counters) to a versioned binary snapshot file
+    virtual void saveModel(const std::string& sFilePath) const override;
+    /// restores the complete model state from a snapshot file (samples are used in-place from the mapped file, and only copied on write)
+    virtual void loadModel(const std::string& sFilePath) override;
+    /// sets the number of row bands processed concurrently in 'apply' (0 = legacy serial loop based on std::rand); band PRNG streams are seeded from 'nSeed'
+    void setParallelBandCount(size_t nBandCount, uint32_t nSeed=0);
+    /// returns the number of row bands processed concurrently in 'apply' (0 = legacy serial loop)
+    size_t getParallelBandCount() const;
+    /// toggles whether the per-pixel adaptive state is kept packed as 16-bit fixed-point values during processing (lossy, but cuts state memory traffic)
+    void setCompactStateMode(bool bUseCompactState);
+    /// returns whether the per-pixel adaptive state is kept packed as 16-bit fixed-point values during processing
+    bool isUsingCompactStateMode() const {return m_bUseCompactState;}
+    /// toggles pipelined post-processing, where frame t is post-processed on a second thread while frame t+1 is matched (outputs are then delayed by one frame)
+    void setPipelinedPostProcessing(bool bUsePipelinedPostProc);
+    /// returns whether pipelined post-processing is enabled
+    bool isUsingPipelinedPostProcessing() const {return bool(m_pPostProcWorker);}
+    /// waits for pending post-processing work and returns the final mask of the last analyzed frame (only needed to get the last output in pipelined mode)
+    void flushPipeline(cv::OutputArray fgmask);
 
 protected:
+    /// neighbor spread update which crosses a band border; kept aside during parallel processing, and committed afterwards in band order
+    struct DeferredSpreadUpdate {
+        /// index of the pixel which triggered the update (its latest color/desc will be copied)
+        size_t nSrcPxIdx;
+        /// index of the neighbor pixel whose model will be updated
+        size_t nDstPxIdx;
+        /// index of the model sample to overwrite
+        size_t nSampleIdx;
+        /// whether the regular (learning rate-based) update check passed
+        bool bRegularUpdate;
+        /// whether the ghost absorption check should be evaluated with the neighbor's stats at commit time
+        bool bGhostCandidate;
+    };
+    /// indices of the per-pixel adaptive state values packed in compact state mode
+    enum CompactStateField {
+        CompactState_DistThreshold,
+        CompactState_VariationModulator,
+        CompactState_UpdateRate,
+        CompactState_MeanLastDist,
+        CompactState_MeanMinDist_LT,
+        CompactState_MeanMinDist_ST,
+        CompactState_MeanRawSegmRes_LT,
+        CompactState_MeanRawSegmRes_ST,
+        CompactStateFieldCount
+    };
+    /// per-pixel adaptive state packed as 16-bit fixed-point values (each field uses its own scale, based on its valid range)
+    struct alignas(16) CompactPxState {
+        /// packed values, indexed via CompactStateField
+        std::array<uint16_t,CompactStateFieldCount> anVals;
+    };
+    /// band info used to split the pixel LUT for parallel processing (bands are 2d tiles if the multi-threaded impl uses a tile size)
+    struct ParallelBandInfo {
+        /// model LUT index ranges covered by this band
+        ModelLUTSpans oModelIters;
+        /// image region covered by this band; spreads which fall outside of it are deferred
+        cv::Rect oRect;
+        /// number of non-zero descriptors counted in this band during the last 'apply' call
+        size_t nNonZeroDescCount;
+        /// neighbor spread updates that fell outside this band during the last 'apply' call
+        std::vector<DeferredSpreadUpdate> vDeferredUpdates;
+        /// instrumentation stats accumulated by this band during the last 'apply' call (only used in instrumented builds)
+        BackgroundSubtractorStats oStats;
+    };
+    /// rebuilds the row band LUT based on the current ROI & band count (the multi-threaded impl mirrors its tile LUT instead)
+    void initParallelBands();
+    /// runs 'lBandFunc(nBandIdx)' for all row bands (via OpenMP in the non-parallel impl, or on the worker pool in the multi-threaded impl)
+    void processParallelBands(const std::function<void(size_t)>& lBandFunc);
+    /// returns the seed of the PRNG stream used by a row band for a given frame
+    int getParallelBandSeed(size_t nBandIdx, size_t nFrameIdx) const;
+    /// processes all model LUT pixels of a given band (using 'lRand' as the PRNG, and deferring cross-band spreads only if 'bDeferCrossBandSpread' is set)
+    template<typename TRandGen>
+    void apply_band(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, ParallelBandInfo& oBand, TRandGen&& lRand, bool bDeferCrossBandSpread,
+                    float fRollAvgFactor_LT, float fRollAvgFactor_ST, double learningRateOverride, size_t nFrameIdx);
+    /// adapts the LBSP thresholds, learning rate caps & automatic model resets based on the frame-level stats of the last analyzed frame
+    void analyzeFrameLevel(const cv::Mat& oInputImg, size_t nNonZeroDescCount, float fRollAvgFactor_LT, float fRollAvgFactor_ST);
+    /// commits a neighbor spread update that was deferred during parallel processing
+    void commitDeferredSpreadUpdate(const DeferredSpreadUpdate& oUpdate);
+    /// runs the post-processing chain on a raw segmentation mask (in-place), updating the given final segmentation feedback maps & blob list
+    void postProcess(cv::Mat& oCurrFGMask, cv::Mat& oLastFGMask, cv::Mat& oBlinksFrame, cv::Mat& oMeanFinalSegmResFrame_LT, cv::Mat& oMeanFinalSegmResFrame_ST,
+                     std::vector<ForegroundBlob>& voBlobs, float fRollAvgFactor_LT, float fRollAvgFactor_ST);
+    /// runs the post-processing chain tile by tile using halos, with results identical to the full-frame chain (only used with post-processing tiles)
+    void postProcess_tiled(cv::Mat& oCurrFGMask, cv::Mat& oLastFGMask, cv::Mat& oBlinksFrame, cv::Mat& oMeanFinalSegmResFrame_LT, cv::Mat& oMeanFinalSegmResFrame_ST,
+                           std::vector<ForegroundBlob>& voBlobs, float fRollAvgFactor_LT, float fRollAvgFactor_ST);
+    /// rebuilds the post-processing tile list (only filled with 2d tiles in the multi-threaded impl; must not be called while a post-processing job is pending)
+    void initPostProcTiles();
+    /// runs 'lTileFunc(nTileIdx)' for all post-processing tiles (on the worker pool in the multi-threaded impl)
+    void processPostProcTiles(const std::function<void(size_t)>& lTileFunc);
+    /// waits for the pending post-processing job (if any), and publishes its feedback maps for the next pixel loop
+    void syncPostProcessing();
+    /// resets the post-processing worker's feedback maps to the current (published) ones
+    void resetPostProcessing();
+    /// returns the list of named per-pixel state maps which are saved in model snapshots
+    std::vector<std::pair<const char*,cv::Mat*>> getModelStateMaps();
+    /// returns the full-precision state maps which are packed in compact state mode (indexed via CompactStateField)
+    std::array<cv::Mat*,CompactStateFieldCount> getCompactStateMaps();
+    /// packs the full-precision state maps into the compact state array
+    void packCompactState();
+    /// unpacks the compact state array into the full-precision state maps
+    void unpackCompactState();
+    /// decays the distance & raw segmentation means (full-precision or packed, based on the current mode) for a skipped frame
+    void decaySkippedFrameState(float fRollAvgFactor_LT, float fRollAvgFactor_ST);
+    /// returns pointers to the adaptive state values of a pixel (in compact state mode, these point to the unpacked values in 'afCompactStateBuffer')
+    inline std::array<float*,CompactStateFieldCount> getPxStatePtrs(size_t nPxIter, std::array<float,CompactStateFieldCount>& afCompactStateBuffer);
+    /// packs the (updated) adaptive state values of a pixel back into the compact state array (with stochastic rounding seeded by the pixel & frame indices)
+    inline void storePxState(size_t nPxIter, size_t nFrameIdx, const std::array<float,CompactStateFieldCount>& afCompactStateBuffer);
+    /// returns a single adaptive state value of a pixel, reading from the compact state array or from the given float map based on the current mode
+    inline float getPxStateValue(size_t nPxIdx, CompactStateField eField, const cv::Mat& oMap) const;
+
     /// absolute minimal color distance threshold ('R' or 'radius' in the original ViBe paper, used as the default/initial 'R(x)' value here)
     const size_t m_nMinColorDistThreshold;
     /// absolute descriptor distance threshold offset
@@ -91,11 +197,21 @@ protected:
     bool m_bUse3x3Spread;
     /// specifies the downsampled frame size used for cam motion analysis
     cv::Size m_oDownSampledFrameSize;
+    /// number of row bands processed concurrently in 'apply' (0 = legacy serial loop; non-parallel impl only)
+    size_t m_nParallelBandCount;
+    /// base seed used to derive per-band PRNG streams in parallel mode (non-parallel impl only)
+    uint32_t m_nParallelSeed;
+    /// band LUT used to split the pixel LUT in parallel mode
+    std::vector<ParallelBandInfo> m_voParallelBands;
+    /// image regions post-processed independently (empty = full-frame post-processing chain)
+    std::vector<cv::Rect> m_voPostProcTiles;
+    /// specifies whether the per-pixel adaptive state is kept in the compact state array instead of the float maps during processing
+    bool m_bUseCompactState;
+    /// per-pixel packed adaptive state used in compact state mode (the matching float maps are only refreshed on demand)
+    std::vector<CompactPxState> m_voCompactState;
 
-    /// background model pixel color intensity samples (equivalent to 'B(x)' in PBAS)
-    std::vector<cv::Mat> m_voBGColorSamples;
-    /// background model descriptors samples
-    std::vector<cv::Mat> m_voBGDescSamples;
+    /// background model pixel color intensity & descriptor samples (color samples are equivalent to 'B(x)' in PBAS)
+    LBSPSampleStore m_oBGSamples;
 
     /// per-pixel update rates ('T(x)' in PBAS, which contains pixel-level 'sigmas', as referred to in ViBe)
     cv::Mat m_oUpdateRateFrame;
@@ -130,6 +246,46 @@ protected:
     cv::Mat m_oCurrRawFGBlinkMask;
     cv::Mat m_oLastRawFGBlinkMask;
     cv::Mat m_oMorphExStructElement;
+
+    /// raw segmentation mask handed to the post-processing worker in pipelined mode (holds the final mask once processed)
+    cv::Mat m_oPostProcFGMask;
+    /// final segmentation feedback maps owned by the post-processing worker in pipelined mode (published after each job)
+    cv::Mat m_oPostProcLastFGMask, m_oPostProcBlinksFrame, m_oPostProcMeanFinalSegmResFrame_LT, m_oPostProcMeanFinalSegmResFrame_ST;
+    /// blobs extracted by the post-processing worker in pipelined mode (published along with its maps)
+    std::vector<ForegroundBlob> m_voPostProcBlobs;
+    /// result of the pending post-processing job in pipelined mode (invalid if none)
+    std::future<void> m_oPostProcJobResult;
+    /// post-processing worker used in pipelined mode (null otherwise; declared last so that pending jobs are drained first on destruction)
+    std::unique_ptr<lv::WorkerPool<1>> m_pPostProcWorker;
 };
 
+using BackgroundSubtractorSuBSENSE_CPUThreads = BackgroundSubtractorSuBSENSE_<lv::CPUThreads>;
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::setParallelBandCount(size_t nBandCount, uint32_t nSeed);
+template<>
+size_t BackgroundSubtractorSuBSENSE_CPUThreads::getParallelBandCount() const;
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::initParallelBands();
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::processParallelBands(const std::function<void(size_t)>& lBandFunc);
+template<>
+int BackgroundSubtractorSuBSENSE_CPUThreads::getParallelBandSeed(size_t nBandIdx, size_t nFrameIdx) const;
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::initPostProcTiles();
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::processPostProcTiles(const std::function<void(size_t)>& lTileFunc);
 using BackgroundSubtractorSuBSENSE = BackgroundSubtractorSuBSENSE_<lv::NonParallel>;
+template<>
+void BackgroundSubtractorSuBSENSE::setParallelBandCount(size_t nBandCount, uint32_t nSeed);
+template<>
+size_t BackgroundSubtractorSuBSENSE::getParallelBandCount() const;
+template<>
+void BackgroundSubtractorSuBSENSE::initParallelBands();
+template<>
+void BackgroundSubtractorSuBSENSE::processParallelBands(const std::function<void(size_t)>& lBandFunc);
+template<>
+int BackgroundSubtractorSuBSENSE::getParallelBandSeed(size_t nBandIdx, size_t nFrameIdx) const;
+template<>
+void BackgroundSubtractorSuBSENSE::initPostProcTiles();
+template<>
+void BackgroundSubtractorSuBSENSE::processPostProcTiles(const std::function<void(size_t)>& lTileFunc);
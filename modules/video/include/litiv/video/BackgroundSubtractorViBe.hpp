@@ -36,6 +36,7 @@
 //
 // @@@@@@@@
 
+#include "litiv/utils/math.hpp"
 #include <opencv2/video/background_segm.hpp>
 
 /// defines the default value for BackgroundSubtractorViBe::m_nColorDistThreshold
@@ -113,3 +114,41 @@ public:
     /// primary model update function; the learning param is reinterpreted as an integer and should be > 0 (smaller values == faster adaptation)
     virtual void apply(cv::InputArray image, cv::OutputArray fgmask, double learningRate=BGSVIBE_DEFAULT_LEARNING_RATE);
 };
+
+/// ViBe foreground-background segmentation algorithm (vectorized version w/ pixel-major sample storage, SIMD distance counting & per-instance fastrand PRNG)
+template<size_t nChannels>
+class BackgroundSubtractorViBe_vec : public BackgroundSubtractorViBe {
+    static_assert(nChannels==1 || nChannels==3,"vectorized ViBe only supports 1ch and 3ch inputs");
+public:
+    /// full constructor
+    BackgroundSubtractorViBe_vec(size_t nColorDistThreshold=BGSVIBE_DEFAULT_COLOR_DIST_THRESHOLD,
+                                 size_t nBGSamples=BGSVIBE_DEFAULT_NB_BG_SAMPLES,
+                                 size_t nRequiredBGSamples=BGSVIBE_DEFAULT_REQUIRED_NB_BG_SAMPLES);
+    /// default destructor
+    virtual ~BackgroundSubtractorViBe_vec();
+    /// (re)initiaization method; needs to be called before starting background subtraction
+    virtual void initialize(const cv::Mat& oInitImg);
+    /// primary model update function; the learning param is reinterpreted as an integer and should be > 0 (smaller values == faster adaptation)
+    virtual void apply(cv::InputArray image, cv::OutputArray fgmask, double learningRate=BGSVIBE_DEFAULT_LEARNING_RATE);
+    /// returns a copy of the latest reconstructed background image
+    virtual void getBackgroundImage(cv::OutputArray backgroundImage) const;
+    /// sets the seed used to reset the internal PRNG state on the next call to 'initialize'
+    void setRandomSeed(uint32_t nSeed);
+
+protected:
+    /// sample count per pixel & channel, padded up to the SIMD block size
+    size_t m_nSampleStride;
+    /// background model pixel intensity samples, stored pixel-major as [px][channel][sample]
+    lv::aligned_vector<uchar,16> m_vnBGSamples;
+    /// seed used to reset the internal PRNG state on initialization
+    uint32_t m_nRandSeed;
+    /// internal PRNG (used for both model initialization and updates)
+    lv::FastRandGen4 m_oRandGen;
+    /// defines whether the SIMD kernels are used (otherwise, the scalar fallback is used; ignored in builds without SSE2)
+    bool m_bUseSIMD;
+};
+
+/// ViBe foreground-background segmentation algorithm (1ch/grayscale vectorized version)
+using BackgroundSubtractorViBe_1ch_vec = BackgroundSubtractorViBe_vec<1>;
+/// ViBe foreground-background segmentation algorithm (3ch/RGB vectorized version)
+using BackgroundSubtractorViBe_3ch_vec = BackgroundSubtractorViBe_vec<3>;
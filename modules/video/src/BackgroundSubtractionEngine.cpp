@@ -0,0 +1,164 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "litiv/video/BackgroundSubtractionEngine.hpp"
+
+BackgroundSubtractionEngine::BackgroundSubtractionEngine(size_t nWorkers, size_t nMaxPendingFrames) :
+        m_nMaxPendingFrames(nMaxPendingFrames),
+        m_oPool(nWorkers) {
+    lvAssert_(m_nMaxPendingFrames>0,"max pending frame count must be positive");
+}
+
+BackgroundSubtractionEngine::~BackgroundSubtractionEngine() {
+    // pool destructor drains all queued jobs (streams reschedule themselves until their queues are empty)
+}
+
+size_t BackgroundSubtractionEngine::addStream(std::shared_ptr<IIBackgroundSubtractor> pAlgo, OutputCallback lCallback) {
+    lvAssert_(pAlgo,"algorithm instance must be non-null");
+    return addStream([pAlgo](const cv::Mat& oInput, cv::Mat& oFGMask, double dLearningRate) {
+        pAlgo->apply(oInput,oFGMask,dLearningRate);
+    },std::move(lCallback),pAlgo->getDefaultLearningRate()); // e.g. LOBSTER rejects non-positive rates, SuBSENSE treats them as 'auto'
+}
+
+size_t BackgroundSubtractionEngine::addStream(ApplyFunc lApply, OutputCallback lCallback, double dDefaultLearningRate) {
+    lvAssert_(lApply,"stream processing function must be non-empty");
+    std::unique_ptr<StreamInfo> pStream = std::make_unique<StreamInfo>();
+    pStream->lApply = std::move(lApply);
+    pStream->lCallback = std::move(lCallback);
+    pStream->dDefaultLearningRate = dDefaultLearningRate;
+    pStream->bScheduled = false;
+    pStream->nPushedFrames = pStream->nProcessedFrames = 0;
+    pStream->dTotLatency = pStream->dMaxLatency = pStream->dTotProcessTime = 0.0;
+    lv::mutex_lock_guard oLock(m_oStreamsMutex);
+    m_vpStreams.push_back(std::move(pStream));
+    return m_vpStreams.size()-1;
+}
+
+size_t BackgroundSubtractionEngine::push(size_t nStreamIdx, const cv::Mat& oInput, double dLearningRate) {
+    return pushFrame(nStreamIdx,oInput,nullptr,dLearningRate);
+}
+
+size_t BackgroundSubtractionEngine::push(size_t nStreamIdx, std::shared_ptr<const cv::Mat> pInput, double dLearningRate) {
+    lvAssert_(pInput,"input frame view must be non-null");
+    const cv::Mat oInput = *pInput; // header only; the data stays owned by the view
+    return pushFrame(nStreamIdx,oInput,std::move(pInput),dLearningRate);
+}
+
+size_t BackgroundSubtractionEngine::pushFrame(size_t nStreamIdx, const cv::Mat& oInput, std::shared_ptr<const cv::Mat> pInputView, double dLearningRate) {
+    lvAssert_(!oInput.empty(),"input frame must be non-empty");
+    lvAssert_(m_oPool.getCurrentWorkerIdx()==SIZE_MAX,"cannot push frames from a worker thread (back-pressure would deadlock)");
+    StreamInfo& oStream = getStream(nStreamIdx);
+    lv::mutex_unique_lock oLock(oStream.oMutex);
+    oStream.oSyncVar.wait(oLock,[&](){return oStream.qPendingFrames.size()<m_nMaxPendingFrames;});
+    if(oStream.pError)
+        std::rethrow_exception(oStream.pError);
+    const size_t nFrameIdx = oStream.nPushedFrames++;
+    const Clock::time_point nPushTime = Clock::now();
+    if(nFrameIdx==0)
+        oStream.nFirstPushTime = nPushTime;
+    oStream.qPendingFrames.push_back(PendingFrame{oInput,std::move(pInputView),dLearningRate>0?dLearningRate:oStream.dDefaultLearningRate,nFrameIdx,nPushTime});
+    if(!oStream.bScheduled) {
+        oStream.bScheduled = true;
+        m_oPool.submit([this,&oStream](){processNext(oStream);});
+    }
+    return nFrameIdx;
+}
+
+void BackgroundSubtractionEngine::waitStream(size_t nStreamIdx) {
+    StreamInfo& oStream = getStream(nStreamIdx);
+    lv::mutex_unique_lock oLock(oStream.oMutex);
+    oStream.oSyncVar.wait(oLock,[&](){return !oStream.bScheduled;});
+    if(oStream.pError)
+        std::rethrow_exception(oStream.pError);
+}
+
+void BackgroundSubtractionEngine::waitAll() {
+    const size_t nStreamCount = getStreamCount();
+    for(size_t nStreamIdx=0; nStreamIdx<nStreamCount; ++nStreamIdx)
+        waitStream(nStreamIdx);
+}
+
+BackgroundSubtractionEngine::StreamStats BackgroundSubtractionEngine::getStreamStats(size_t nStreamIdx) const {
+    const StreamInfo& oStream = getStream(nStreamIdx);
+    lv::mutex_lock_guard oLock(oStream.oMutex);
+    StreamStats oStats;
+    oStats.nPushedFrames = oStream.nPushedFrames;
+    oStats.nProcessedFrames = oStream.nProcessedFrames;
+    oStats.dMeanLatency = oStream.nProcessedFrames?oStream.dTotLatency/oStream.nProcessedFrames:0.0;
+    oStats.dMaxLatency = oStream.dMaxLatency;
+    oStats.dMeanProcessTime = oStream.nProcessedFrames?oStream.dTotProcessTime/oStream.nProcessedFrames:0.0;
+    const double dElapsed = oStream.nProcessedFrames?std::chrono::duration<double>(oStream.nLastOutputTime-oStream.nFirstPushTime).count():0.0;
+    oStats.dThroughput = dElapsed>0.0?oStream.nProcessedFrames/dElapsed:0.0;
+    return oStats;
+}
+
+size_t BackgroundSubtractionEngine::getStreamCount() const {
+    lv::mutex_lock_guard oLock(m_oStreamsMutex);
+    return m_vpStreams.size();
+}
+
+BackgroundSubtractionEngine::StreamInfo& BackgroundSubtractionEngine::getStream(size_t nStreamIdx) const {
+    lv::mutex_lock_guard oLock(m_oStreamsMutex);
+    lvAssert_(nStreamIdx<m_vpStreams.size(),"stream index out of range");
+    return *m_vpStreams[nStreamIdx];
+}
+
+void BackgroundSubtractionEngine::processNext(StreamInfo& oStream) {
+    PendingFrame oFrame;
+    bool bSkip;
+    {
+        lv::mutex_lock_guard oLock(oStream.oMutex);
+        lvDbgAssert(oStream.bScheduled && !oStream.qPendingFrames.empty());
+        oFrame = std::move(oStream.qPendingFrames.front());
+        oStream.qPendingFrames.pop_front();
+        bSkip = bool(oStream.pError); // once a stream fails, its remaining frames are dropped
+    }
+    oStream.oSyncVar.notify_all(); // wakes up producers blocked on back-pressure
+    double dProcessTime = 0.0;
+    if(!bSkip) {
+        try {
+            lv::StopWatch oStopWatch;
+            oStream.lApply(oFrame.oInput,oStream.oFGMask,oFrame.dLearningRate);
+            dProcessTime = oStopWatch.elapsed();
+            if(oStream.lCallback)
+                oStream.lCallback(oFrame.nFrameIdx,oFrame.oInput,oStream.oFGMask);
+        }
+        catch(...) {
+            lv::mutex_lock_guard oLock(oStream.oMutex);
+            oStream.pError = std::current_exception();
+            bSkip = true;
+        }
+    }
+    oFrame.pInputView.reset(); // releases pinned input data as soon as possible (e.g. for the dataset precacher to recycle it)
+    const Clock::time_point nOutputTime = Clock::now();
+    {
+        lv::mutex_lock_guard oLock(oStream.oMutex);
+        if(!bSkip) {
+            const double dLatency = std::chrono::duration<double>(nOutputTime-oFrame.nPushTime).count();
+            ++oStream.nProcessedFrames;
+            oStream.dTotLatency += dLatency;
+            oStream.dMaxLatency = std::max(oStream.dMaxLatency,dLatency);
+            oStream.dTotProcessTime += dProcessTime;
+            oStream.nLastOutputTime = nOutputTime;
+        }
+        if(oStream.qPendingFrames.empty())
+            oStream.bScheduled = false;
+        else // stays on this worker's local deque unless another worker runs dry and steals it
+            m_oPool.submit([this,&oStream](){processNext(oStream);});
+    }
+    oStream.oSyncVar.notify_all();
+}
@@ -16,11 +16,177 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractionUtils.hpp"
+#include "litiv/utils/platform.hpp"
+#include "litiv/imgproc.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <numeric>
+#include <cstring>
+
+constexpr uint32_t BackgroundModelSnapshot::s_nFormatVersion;
+constexpr size_t BackgroundModelSnapshot::s_nBlockAlign;
+
+namespace {
+
+    /// magic tag found at the beginning of all snapshot files
+    constexpr char s_acSnapshotMagic[8] = {'L','V','B','G','S','N','A','P'};
+
+    /// fixed-size snapshot file header
+    struct SnapshotHeader {
+        char acMagic[8];
+        uint32_t nFormatVersion;
+        uint32_t nModelVersion;
+        char acAlgoName[32];
+        uint64_t nBlockCount;
+        uint64_t nFileSize;
+    };
+    static_assert(sizeof(SnapshotHeader)==64,"unexpected snapshot header padding");
+
+    /// fixed-size snapshot block table entry (located right after the header)
+    struct SnapshotBlockEntry {
+        char acName[40];
+        uint64_t nOffset;
+        uint64_t nBytes;
+        int32_t nMatType, nMatRows, nMatCols, nReserved;
+    };
+    static_assert(sizeof(SnapshotBlockEntry)==72,"unexpected snapshot block entry padding");
+
+    inline size_t alignSnapshotOffset(size_t nOffset) {
+        return ((nOffset+BackgroundModelSnapshot::s_nBlockAlign-1)/BackgroundModelSnapshot::s_nBlockAlign)*BackgroundModelSnapshot::s_nBlockAlign;
+    }
+
+} // anonymous namespace
+
+BackgroundModelSnapshot::BackgroundModelSnapshot(const std::string& sAlgoName, uint32_t nModelVersion) :
+        m_sAlgoName(sAlgoName),
+        m_nModelVersion(nModelVersion) {
+    lvAssert_(!sAlgoName.empty() && sAlgoName.size()<sizeof(SnapshotHeader::acAlgoName),"snapshot algorithm name must be non-empty and short");
+}
+
+BackgroundModelSnapshot BackgroundModelSnapshot::open(const std::string& sFilePath, const std::string& sAlgoName, uint32_t nModelVersion) {
+    BackgroundModelSnapshot oSnapshot(sAlgoName,nModelVersion);
+    size_t nFileSize = 0;
+    oSnapshot.m_pMapping = lv::mapFileToMemory(sFilePath,nFileSize);
+    const uint8_t* pFileData = oSnapshot.m_pMapping.get();
+    lvAssert__(nFileSize>=sizeof(SnapshotHeader),"snapshot file at '%s' is truncated",sFilePath.c_str());
+    SnapshotHeader oHeader;
+    std::memcpy(&oHeader,pFileData,sizeof(oHeader));
+    lvAssert__(std::memcmp(oHeader.acMagic,s_acSnapshotMagic,sizeof(s_acSnapshotMagic))==0,"file at '%s' is not a background model snapshot",sFilePath.c_str());
+    lvAssert__(oHeader.nFormatVersion==s_nFormatVersion,"unsupported snapshot format version (got %d, expected %d)",(int)oHeader.nFormatVersion,(int)s_nFormatVersion);
+    const std::string sFileAlgoName(oHeader.acAlgoName,strnlen(oHeader.acAlgoName,sizeof(oHeader.acAlgoName)));
+    lvAssert__(sFileAlgoName==sAlgoName,"snapshot was created by algorithm '%s' (expected '%s')",sFileAlgoName.c_str(),sAlgoName.c_str());
+    lvAssert__(oHeader.nModelVersion==nModelVersion,"unsupported %s model version (got %d, expected %d)",sAlgoName.c_str(),(int)oHeader.nModelVersion,(int)nModelVersion);
+    lvAssert__(oHeader.nFileSize==nFileSize && oHeader.nBlockCount<=(nFileSize-sizeof(SnapshotHeader))/sizeof(SnapshotBlockEntry),"snapshot file at '%s' is truncated or corrupted",sFilePath.c_str());
+    oSnapshot.m_vBlocks.resize(size_t(oHeader.nBlockCount));
+    for(size_t nBlockIdx=0; nBlockIdx<oSnapshot.m_vBlocks.size(); ++nBlockIdx) {
+        SnapshotBlockEntry oEntry;
+        std::memcpy(&oEntry,pFileData+sizeof(SnapshotHeader)+nBlockIdx*sizeof(SnapshotBlockEntry),sizeof(oEntry));
+        lvAssert__(oEntry.nOffset%s_nBlockAlign==0 && oEntry.nOffset<=nFileSize && oEntry.nBytes<=nFileSize-oEntry.nOffset,"snapshot file at '%s' is corrupted (bad block range)",sFilePath.c_str());
+        BlockInfo& oBlock = oSnapshot.m_vBlocks[nBlockIdx];
+        oBlock.sName = std::string(oEntry.acName,strnlen(oEntry.acName,sizeof(oEntry.acName)));
+        oBlock.pData = oSnapshot.m_pMapping.get()+oEntry.nOffset;
+        oBlock.nBytes = size_t(oEntry.nBytes);
+        oBlock.nMatType = oEntry.nMatType;
+        oBlock.nMatRows = oEntry.nMatRows;
+        oBlock.nMatCols = oEntry.nMatCols;
+    }
+    return oSnapshot;
+}
+
+void BackgroundModelSnapshot::addBlock(const std::string& sName, const void* pData, size_t nBytes) {
+    lvAssert_(!sName.empty() && sName.size()<sizeof(SnapshotBlockEntry::acName),"snapshot block name must be non-empty and short");
+    lvAssert__(!hasBlock(sName),"snapshot already contains a block named '%s'",sName.c_str());
+    lvAssert_(!m_pMapping,"cannot add blocks to a mapped snapshot");
+    m_vBlocks.push_back(BlockInfo{sName,(uchar*)pData,nBytes,-1,0,0,std::vector<uchar>()});
+}
+
+void BackgroundModelSnapshot::addMat(const std::string& sName, const cv::Mat& oMat) {
+    lvAssert__(oMat.empty() || (oMat.dims==2 && oMat.isContinuous()),"snapshot matrix '%s' must be 2d and continuous",sName.c_str());
+    addBlock(sName,oMat.data,oMat.total()*oMat.elemSize());
+    m_vBlocks.back().nMatType = oMat.type();
+    m_vBlocks.back().nMatRows = oMat.rows;
+    m_vBlocks.back().nMatCols = oMat.cols;
+}
+
+void BackgroundModelSnapshot::write(const std::string& sFilePath) const {
+    lvAssert_(!sFilePath.empty(),"snapshot file path must be non-empty");
+    std::vector<SnapshotBlockEntry> voEntries(m_vBlocks.size());
+    size_t nCurrOffset = alignSnapshotOffset(sizeof(SnapshotHeader)+sizeof(SnapshotBlockEntry)*m_vBlocks.size());
+    for(size_t nBlockIdx=0; nBlockIdx<m_vBlocks.size(); ++nBlockIdx) {
+        SnapshotBlockEntry& oEntry = voEntries[nBlockIdx];
+        std::memset(&oEntry,0,sizeof(oEntry));
+        std::memcpy(oEntry.acName,m_vBlocks[nBlockIdx].sName.data(),m_vBlocks[nBlockIdx].sName.size());
+        oEntry.nOffset = uint64_t(nCurrOffset);
+        oEntry.nBytes = uint64_t(m_vBlocks[nBlockIdx].nBytes);
+        oEntry.nMatType = int32_t(m_vBlocks[nBlockIdx].nMatType);
+        oEntry.nMatRows = int32_t(m_vBlocks[nBlockIdx].nMatRows);
+        oEntry.nMatCols = int32_t(m_vBlocks[nBlockIdx].nMatCols);
+        nCurrOffset = alignSnapshotOffset(nCurrOffset+m_vBlocks[nBlockIdx].nBytes);
+    }
+    SnapshotHeader oHeader;
+    std::memset(&oHeader,0,sizeof(oHeader));
+    std::memcpy(oHeader.acMagic,s_acSnapshotMagic,sizeof(s_acSnapshotMagic));
+    oHeader.nFormatVersion = s_nFormatVersion;
+    oHeader.nModelVersion = m_nModelVersion;
+    std::memcpy(oHeader.acAlgoName,m_sAlgoName.data(),m_sAlgoName.size());
+    oHeader.nBlockCount = uint64_t(m_vBlocks.size());
+    oHeader.nFileSize = uint64_t(nCurrOffset);
+    std::ofstream ssStr(sFilePath,std::ios::binary);
+    lvAssert__(ssStr.is_open(),"could not open snapshot file at '%s' for writing",sFilePath.c_str());
+    ssStr.write((const char*)&oHeader,sizeof(oHeader));
+    ssStr.write((const char*)voEntries.data(),sizeof(SnapshotBlockEntry)*voEntries.size());
+    const std::array<char,s_nBlockAlign> acPadding = {};
+    size_t nWrittenBytes = sizeof(oHeader)+sizeof(SnapshotBlockEntry)*voEntries.size();
+    for(size_t nBlockIdx=0; nBlockIdx<m_vBlocks.size(); ++nBlockIdx) {
+        ssStr.write(acPadding.data(),std::streamsize(voEntries[nBlockIdx].nOffset-nWrittenBytes));
+        const BlockInfo& oBlock = m_vBlocks[nBlockIdx];
+        ssStr.write((const char*)(oBlock.pData?oBlock.pData:oBlock.vLocalData.data()),std::streamsize(oBlock.nBytes));
+        nWrittenBytes = size_t(voEntries[nBlockIdx].nOffset)+oBlock.nBytes;
+    }
+    ssStr.write(acPadding.data(),std::streamsize(nCurrOffset-nWrittenBytes));
+    lvAssert__(ssStr,"snapshot write failed for '%s'",sFilePath.c_str());
+}
+
+bool BackgroundModelSnapshot::hasBlock(const std::string& sName) const {
+    return std::find_if(m_vBlocks.begin(),m_vBlocks.end(),[&](const BlockInfo& oBlock){return oBlock.sName==sName;})!=m_vBlocks.end();
+}
+
+const BackgroundModelSnapshot::BlockInfo& BackgroundModelSnapshot::getBlockInfo(const std::string& sName) const {
+    const auto pBlock = std::find_if(m_vBlocks.begin(),m_vBlocks.end(),[&](const BlockInfo& oBlock){return oBlock.sName==sName;});
+    lvAssert__(pBlock!=m_vBlocks.end(),"snapshot is missing block '%s'",sName.c_str());
+    return *pBlock;
+}
+
+size_t BackgroundModelSnapshot::getBlockSize(const std::string& sName) const {
+    return getBlockInfo(sName).nBytes;
+}
+
+uchar* BackgroundModelSnapshot::getBlock(const std::string& sName, size_t nExpectedBytes) const {
+    const BlockInfo& oBlock = getBlockInfo(sName);
+    lvAssert__(oBlock.nBytes==nExpectedBytes,"snapshot block '%s' has unexpected size (got %d bytes, expected %d)",sName.c_str(),(int)oBlock.nBytes,(int)nExpectedBytes);
+    return oBlock.pData?oBlock.pData:(uchar*)oBlock.vLocalData.data();
+}
+
+cv::Mat BackgroundModelSnapshot::getMat(const std::string& sName) const {
+    const BlockInfo& oBlock = getBlockInfo(sName);
+    lvAssert__(oBlock.nMatType>=0,"snapshot block '%s' is not a matrix",sName.c_str());
+    if(oBlock.nMatRows==0 || oBlock.nMatCols==0)
+        return cv::Mat();
+    lvAssert__(oBlock.nMatRows>0 && oBlock.nMatCols>0 && size_t(oBlock.nMatRows)*oBlock.nMatCols*CV_ELEM_SIZE(oBlock.nMatType)==oBlock.nBytes,"snapshot block '%s' has bad matrix dims",sName.c_str());
+    return cv::Mat(oBlock.nMatRows,oBlock.nMatCols,oBlock.nMatType,oBlock.pData);
+}
 
 void IIBackgroundSubtractor::initialize(const cv::Mat& oInitImg) {
     initialize(oInitImg,cv::Mat());
 }
 
+void IIBackgroundSubtractor::applyBatch(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, double dLearningRate) {
+    voFGMasks.resize(voImages.size());
+    for(size_t nImageIdx=0; nImageIdx<voImages.size(); ++nImageIdx)
+        apply(voImages[nImageIdx],voFGMasks[nImageIdx],dLearningRate);
+}
+
 void IIBackgroundSubtractor::setAutomaticModelReset(bool bVal) {
     m_bAutoModelResetEnabled = bVal;
 }
@@ -51,6 +217,14 @@ cv::Mat IIBackgroundSubtractor::getROICopy() const {
     return m_oROI.clone();
 }
 
+void IIBackgroundSubtractor::saveModel(const std::string& /*sFilePath*/) const {
+    lvError("model snapshots are not supported by this algorithm");
+}
+
+void IIBackgroundSubtractor::loadModel(const std::string& /*sFilePath*/) {
+    lvError("model snapshots are not supported by this algorithm");
+}
+
 IIBackgroundSubtractor::IIBackgroundSubtractor() :
         m_nROIBorderSize(0),
         m_nImgChannels(0),
@@ -65,7 +239,122 @@ IIBackgroundSubtractor::IIBackgroundSubtractor() :
         m_bInitialized(false),
         m_bModelInitialized(false),
         m_bAutoModelResetEnabled(true),
-        m_bUsingMovingCamera(false) {}
+        m_bUsingMovingCamera(false),
+        m_bUsingActivityGating(false),
+        m_nGatingBlockSize(BGS_DEFAULT_GATING_BLOCK_SIZE),
+        m_nGatingRefreshPeriod(BGS_DEFAULT_GATING_REFRESH_PERIOD),
+        m_fGatingNoiseThreshold(BGS_DEFAULT_GATING_NOISE_THRESHOLD),
+        m_nActiveBlockCount(0),
+        m_bUsingBlobExtraction(false),
+        m_bBlobExtractionWithRuns(false),
+        m_nBlobMinArea(1),
+        m_nReducedResScale(1),
+        m_nReducedResRefineThreshold(BGS_DEFAULT_REDUCED_RES_REFINE_THRESHOLD),
+        m_dFrameTimeBudget(0.0),
+        m_dFrameTimeDebt(0.0),
+        m_nMaxConsecutiveSkippedFrames(BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES),
+        m_nConsecutiveSkippedFrames(0),
+        m_nSkippedFrameCount(0),
+        m_bLastFrameSkipped(false) {}
+
+void IIBackgroundSubtractor::setActivityGating(bool bEnabled, size_t nBlockSize, float fNoiseThreshold, size_t nRefreshPeriod) {
+    lvAssert_(nBlockSize>0 && fNoiseThreshold>=0.0f && nRefreshPeriod>0,"invalid activity gating parameter(s)");
+    m_bUsingActivityGating = bEnabled;
+    m_nGatingBlockSize = nBlockSize;
+    m_fGatingNoiseThreshold = fNoiseThreshold;
+    m_nGatingRefreshPeriod = nRefreshPeriod;
+    if(m_bInitialized)
+        initActivityGating(m_oLastColorFrame);
+}
+
+void IIBackgroundSubtractor::setBlobExtraction(bool bEnabled, bool bWithRuns, size_t nMinArea) {
+    m_bUsingBlobExtraction = bEnabled;
+    m_bBlobExtractionWithRuns = bWithRuns;
+    m_nBlobMinArea = nMinArea;
+    if(!m_bUsingBlobExtraction)
+        m_voLatestBlobs.clear();
+}
+
+void IIBackgroundSubtractor::setReducedResolution(size_t nScaleFactor, size_t nRefineThreshold) {
+    lvAssert_(nScaleFactor>0,"reduced-resolution scale factor must be positive");
+    m_nReducedResScale = nScaleFactor;
+    m_nReducedResRefineThreshold = nRefineThreshold;
+}
+
+void IIBackgroundSubtractor::setFrameTimeBudget(double dBudgetMS, size_t nMaxConsecutiveSkippedFrames) {
+    lvAssert_(dBudgetMS>=0.0,"frame time budget must be non-negative");
+    m_dFrameTimeBudget = dBudgetMS;
+    m_nMaxConsecutiveSkippedFrames = nMaxConsecutiveSkippedFrames;
+    m_dFrameTimeDebt = 0.0;
+    m_nConsecutiveSkippedFrames = 0;
+}
+
+void BackgroundSubtractorStats::reset() {
+    adStageTimes.fill(0.0);
+    nFrames = nPixels = 0;
+    nTestedSamples = nMatchedSamples = 0;
+    nModelResets = 0;
+    nGatedPixels = 0;
+}
+
+BackgroundSubtractorStats& BackgroundSubtractorStats::operator+=(const BackgroundSubtractorStats& oStats) {
+    for(size_t nStageIdx=0; nStageIdx<StageCount; ++nStageIdx)
+        adStageTimes[nStageIdx] += oStats.adStageTimes[nStageIdx];
+    nFrames += oStats.nFrames;
+    nPixels += oStats.nPixels;
+    nTestedSamples += oStats.nTestedSamples;
+    nMatchedSamples += oStats.nMatchedSamples;
+    nModelResets += oStats.nModelResets;
+    nGatedPixels += oStats.nGatedPixels;
+    return *this;
+}
+
+const char* BackgroundSubtractorStats::getStageName(Stage eStage) {
+    switch(eStage) {
+        case Stage_SampleMatching: return "sample_matching";
+        case Stage_ModelUpdate: return "model_update";
+        case Stage_FrameLevelAnalysis: return "frame_level_analysis";
+        case Stage_PostProcessing: return "post_processing";
+        default: lvError("unknown background subtraction stage");
+    }
+}
+
+double BackgroundSubtractorStats::getTotalTime() const {
+    return std::accumulate(adStageTimes.begin(),adStageTimes.end(),0.0);
+}
+
+std::string BackgroundSubtractorStats::toJSON() const {
+    std::ostringstream ssStr;
+    ssStr.imbue(std::locale::classic());
+    ssStr << std::setprecision(9) << "{\n  \"instrumented\": " << (USING_BGS_INSTRUMENTATION?"true":"false") << ",\n  \"stage_times\": {";
+    for(size_t nStageIdx=0; nStageIdx<StageCount; ++nStageIdx)
+        ssStr << (nStageIdx?", ":"") << "\"" << getStageName((Stage)nStageIdx) << "\": " << adStageTimes[nStageIdx];
+    ssStr << "},\n  \"total_time\": " << getTotalTime() << ",\n  \"frames\": " << nFrames << ",\n  \"pixels\": " << nPixels
+          << ",\n  \"tested_samples\": " << nTestedSamples << ",\n  \"matched_samples\": " << nMatchedSamples
+          << ",\n  \"mean_tested_samples\": " << getMeanTestedSamples() << ",\n  \"mean_matched_samples\": " << getMeanMatchedSamples()
+          << ",\n  \"model_resets\": " << nModelResets << ",\n  \"gated_pixels\": " << nGatedPixels << "\n}\n";
+    return ssStr.str();
+}
+
+void BackgroundSubtractorStats::writeJSON(const std::string& sFilePath) const {
+    std::ofstream ssStr(sFilePath);
+    lvAssert__(ssStr.is_open(),"could not open stats file at '%s' for writing",sFilePath.c_str());
+    ssStr << toJSON();
+}
+
+cv::Mat lv::getConvertedInput(const cv::Mat& oInputImg, int nChannels) {
+    lvAssert_(nChannels==1 || nChannels==3,"converted channel count must be 1 or 3");
+    lvAssert_(oInputImg.type()==CV_8UC(nChannels) || oInputImg.type()==CV_8UC1,"input image type must be 8-bit, with 1 or 3 channels");
+    if(oInputImg.channels()==nChannels)
+        return oInputImg;
+    cv::Mat oInputImgRGB;
+    cv::cvtColor(oInputImg,oInputImgRGB,cv::COLOR_GRAY2BGR);
+    return oInputImgRGB;
+}
+
+int lv::getTileFrameSeed(uint32_t nSeed, size_t nTileIdx, size_t nFrameIdx) {
+    return (int)((nSeed*2654435761u)^((uint32_t)nFrameIdx*2246822519u)^((uint32_t)nTileIdx*3266489917u));
+}
 
 void IIBackgroundSubtractor::initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI) {
     lvAssert_(!oInitImg.empty() && oInitImg.isContinuous() && (oInitImg.type()==CV_8UC1 || oInitImg.type()==CV_8UC3 || oInitImg.type()==CV_8UC4),"provided image for initialization must be non-empty, continuous, and of type 8UC1/3/4");
@@ -110,48 +399,358 @@ void IIBackgroundSubtractor::initialize_common(const cv::Mat& oInitImg, const cv
     m_nFrameIdx = 0;
     m_nFramesSinceLastReset = 0;
     m_nModelResetCooldown = 0;
+    m_oStats.reset();
     m_oLastFGMask.create(m_oImgSize,CV_8UC1);
     m_oLastFGMask = cv::Scalar_<uchar>(0);
     m_oLastColorFrame.create(m_oImgSize,CV_8UC((int)m_nImgChannels));
     m_oLastColorFrame = cv::Scalar_<uchar>::all(0);
+    lvAssert(m_oLastColorFrame.isContinuous() && oInitImg.isContinuous());
+    initPxLUTs();
+    oInitImg.copyTo(m_oLastColorFrame,m_oROI);
+    initActivityGating(oInitImg);
+    m_oPrevFGMask.create(m_oImgSize,CV_8UC1);
+    m_oPrevFGMask = cv::Scalar_<uchar>(0);
+    m_dFrameTimeDebt = 0.0;
+    m_nConsecutiveSkippedFrames = 0;
+    m_nSkippedFrameCount = 0;
+    m_bLastFrameSkipped = false;
+}
+
+void IIBackgroundSubtractor::initReducedResolution(const cv::Mat& oInitImg, const cv::Mat& oROI, cv::Mat& oModelInitImg, cv::Mat& oModelROI) {
+    if(m_nReducedResScale<=1) {
+        m_oReducedResInputSize = cv::Size();
+        m_oReducedResBGImg.release();
+        oModelInitImg = oInitImg;
+        oModelROI = oROI;
+        return;
+    }
+    lvAssert_(!oInitImg.empty(),"provided image for initialization must be non-empty");
+    m_oReducedResInputSize = oInitImg.size();
+    const cv::Size oModelSize(oInitImg.cols/(int)m_nReducedResScale,oInitImg.rows/(int)m_nReducedResScale);
+    lvAssert_(oModelSize.area()>0,"reduced-resolution scale factor is too large for the provided image");
+    // same downsampling as the frame-level analysis maps, so that each model pixel holds the mean of its full-res block
+    cv::resize(oInitImg,oModelInitImg,oModelSize,0,0,cv::INTER_AREA);
+    if(!oROI.empty()) {
+        lvAssert_(oROI.size()==oInitImg.size(),"provided ROI mat size must be equal to the init frame size");
+        cv::resize(oROI,oModelROI,oModelSize,0,0,cv::INTER_NEAREST);
+    }
+    else
+        oModelROI = cv::Mat();
+    oModelInitImg.convertTo(m_oReducedResBGImg,CV_32F);
+}
+
+const cv::Mat& IIBackgroundSubtractor::getModelInput(const cv::Mat& oInputImg, cv::Mat& oBuffer) const {
+    if(!isUsingReducedResolution())
+        return oInputImg;
+    lvAssert_(oInputImg.type()==m_nImgType && oInputImg.size()==m_oReducedResInputSize,"input image type/size mismatch with initialization type/size");
+    cv::resize(oInputImg,oBuffer,m_oImgSize,0,0,cv::INTER_AREA);
+    return oBuffer;
+}
+
+cv::Mat IIBackgroundSubtractor::getModelOutput(cv::OutputArray oFGMask) {
+    if(!isUsingReducedResolution()) {
+        oFGMask.create(m_oImgSize,CV_8UC1);
+        return oFGMask.getMat();
+    }
+    m_oReducedResFGMask.create(m_oImgSize,CV_8UC1);
+    return m_oReducedResFGMask;
+}
+
+void IIBackgroundSubtractor::refineReducedResMask(const cv::Mat& oInputImg, const cv::Mat& oModelInputImg, const cv::Mat& oModelFGMask, cv::OutputArray oFGMask) {
+    if(!isUsingReducedResolution())
+        return;
+    lvDbgAssert(oModelFGMask.size()==m_oImgSize && oModelFGMask.type()==CV_8UC1 && oInputImg.size()==m_oReducedResInputSize);
+    cv::accumulateWeighted(oModelInputImg,m_oReducedResBGImg,BGS_REDUCED_RES_BG_LEARNING_RATE,oModelFGMask==0);
+    // only the model pixels touching a fg/bg transition can hide full-res pixels with a different label
+    cv::Mat oErodedMask;
+    cv::dilate(oModelFGMask,m_oReducedResBoundaryMask,cv::Mat());
+    cv::erode(oModelFGMask,oErodedMask,cv::Mat());
+    cv::compare(m_oReducedResBoundaryMask,oErodedMask,m_oReducedResBoundaryMask,cv::CMP_NE);
+    cv::bitwise_and(m_oReducedResBoundaryMask,m_oROI,m_oReducedResBoundaryMask);
+    m_oReducedResRefinedMask.create(m_oReducedResInputSize,CV_8UC1);
+    const int nChannels = (int)m_nImgChannels;
+    const int nDistThreshold = int(m_nReducedResRefineThreshold*m_nImgChannels);
+    std::vector<int> vnModelCols((size_t)m_oReducedResInputSize.width);
+    for(int nColIdx=0; nColIdx<m_oReducedResInputSize.width; ++nColIdx)
+        vnModelCols[nColIdx] = std::min((nColIdx*m_oImgSize.width)/m_oReducedResInputSize.width,m_oImgSize.width-1);
+    for(int nRowIdx=0; nRowIdx<m_oReducedResInputSize.height; ++nRowIdx) {
+        const int nModelRowIdx = std::min((nRowIdx*m_oImgSize.height)/m_oReducedResInputSize.height,m_oImgSize.height-1);
+        const uchar* pBoundaryRow = m_oReducedResBoundaryMask.ptr<uchar>(nModelRowIdx);
+        const uchar* pModelMaskRow = oModelFGMask.ptr<uchar>(nModelRowIdx);
+        const float* pBGRow = m_oReducedResBGImg.ptr<float>(nModelRowIdx);
+        const uchar* pInputRow = oInputImg.ptr<uchar>(nRowIdx);
+        uchar* pOutputRow = m_oReducedResRefinedMask.ptr<uchar>(nRowIdx);
+        for(int nColIdx=0; nColIdx<m_oReducedResInputSize.width; ++nColIdx) {
+            const int nModelColIdx = vnModelCols[nColIdx];
+            if(!pBoundaryRow[nModelColIdx]) {
+                pOutputRow[nColIdx] = pModelMaskRow[nModelColIdx];
+                continue;
+            }
+            int nDist = 0;
+            for(int c=0; c<nChannels; ++c)
+                nDist += std::abs(int(pInputRow[nColIdx*nChannels+c])-int(pBGRow[nModelColIdx*nChannels+c]+0.5f));
+            pOutputRow[nColIdx] = nDist>nDistThreshold?UCHAR_MAX:0;
+        }
+    }
+    oFGMask.create(m_oReducedResInputSize,CV_8UC1);
+    cv::Mat oOutput = oFGMask.getMat();
+    // blobs extracted from the model mask (if any) are replaced by the ones of the refined full-res mask
+    copyMaskAndExtractBlobs(m_oReducedResRefinedMask,oOutput,m_voLatestBlobs);
+}
+
+bool IIBackgroundSubtractor::beginBudgetedFrame() {
+    m_bLastFrameSkipped = false;
+    if(m_dFrameTimeBudget<=0.0)
+        return false;
+    m_oFrameBudgetStopWatch.tick();
+    // the first frames are always processed, as predictions need two previous final masks
+    m_bLastFrameSkipped = m_dFrameTimeDebt>0.0 && m_nConsecutiveSkippedFrames<m_nMaxConsecutiveSkippedFrames && m_nFrameIdx>2;
+    if(m_bLastFrameSkipped) {
+        ++m_nConsecutiveSkippedFrames;
+        ++m_nSkippedFrameCount;
+    }
+    else {
+        m_nConsecutiveSkippedFrames = 0;
+        m_oLastFGMask.copyTo(m_oPrevFGMask);
+    }
+    return m_bLastFrameSkipped;
+}
+
+void IIBackgroundSubtractor::endBudgetedFrame() {
+    if(m_dFrameTimeBudget<=0.0)
+        return;
+    // unused time can only be banked for one frame, so that an idle period does not hide a later burst
+    m_dFrameTimeDebt = std::max(m_dFrameTimeDebt+m_oFrameBudgetStopWatch.tock()*1000.0-m_dFrameTimeBudget,-m_dFrameTimeBudget);
+}
+
+void IIBackgroundSubtractor::predictSkippedFrameMask(cv::Mat& oOutput) {
+    lvDbgAssert(m_oLastFGMask.size()==m_oImgSize && m_oPrevFGMask.size()==m_oImgSize && oOutput.size()==m_oImgSize);
+    cv::Mat_<int> oLabels, oStats, oPrevLabels, oPrevStats;
+    cv::Mat_<double> oCentroids, oPrevCentroids;
+    const int nLabels = cv::connectedComponentsWithStats(m_oLastFGMask,oLabels,oStats,oCentroids,8,CV_32S);
+    const int nPrevLabels = cv::connectedComponentsWithStats(m_oPrevFGMask,oPrevLabels,oPrevStats,oPrevCentroids,8,CV_32S);
+    // each blob keeps the velocity of its nearest predecessor (if it lies within the blob's own extent), i.e. constant motion over the skipped frame
+    std::vector<cv::Point> voBlobShifts((size_t)nLabels,cv::Point(0,0));
+    for(int nLabel=1; nLabel<nLabels; ++nLabel) {
+        const double dMaxDist = std::max(oStats(nLabel,cv::CC_STAT_WIDTH),oStats(nLabel,cv::CC_STAT_HEIGHT));
+        double dMinSqrDist = dMaxDist*dMaxDist;
+        for(int nPrevLabel=1; nPrevLabel<nPrevLabels; ++nPrevLabel) {
+            const double dX = oCentroids(nLabel,0)-oPrevCentroids(nPrevLabel,0), dY = oCentroids(nLabel,1)-oPrevCentroids(nPrevLabel,1);
+            if(dX*dX+dY*dY<=dMinSqrDist) {
+                dMinSqrDist = dX*dX+dY*dY;
+                voBlobShifts[nLabel] = cv::Point((int)std::round(dX),(int)std::round(dY));
+            }
+        }
+    }
+    m_oLastFGMask.copyTo(m_oPrevFGMask);
+    m_oLastFGMask = cv::Scalar_<uchar>(0);
+    for(int nRowIdx=0; nRowIdx<m_oImgSize.height; ++nRowIdx) {
+        const int* pLabelRow = oLabels.ptr<int>(nRowIdx);
+        for(int nColIdx=0; nColIdx<m_oImgSize.width; ++nColIdx) {
+            if(pLabelRow[nColIdx]) {
+                const cv::Point oDstPt = cv::Point(nColIdx,nRowIdx)+voBlobShifts[pLabelRow[nColIdx]];
+                if(oDstPt.x>=0 && oDstPt.y>=0 && oDstPt.x<m_oImgSize.width && oDstPt.y<m_oImgSize.height)
+                    m_oLastFGMask.at<uchar>(oDstPt) = UCHAR_MAX;
+            }
+        }
+    }
+    cv::bitwise_and(m_oLastFGMask,m_oROI,m_oLastFGMask);
+    cv::compare(m_oLastFGMask,0,m_oLastFGMask,cv::CMP_GT);
+    copyMaskAndExtractBlobs(m_oLastFGMask,oOutput,m_voLatestBlobs);
+}
+
+void IIBackgroundSubtractor::initPxLUTs() {
     m_vnPxIdxLUT.resize(m_nTotRelevantPxCount);
     m_voPxInfoLUT.resize(m_nTotPxCount);
-    if(m_nImgChannels==1) {
-        lvAssert(m_oLastColorFrame.step.p[0]==(size_t)m_oImgSize.width && m_oLastColorFrame.step.p[1]==1);
-        for(size_t nPxIter=0, nModelIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
-            m_voPxInfoLUT[nPxIter].nImgCoord_Y = (int)nPxIter/m_oImgSize.width;
-            m_voPxInfoLUT[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
-            if(m_oROI.data[nPxIter]) {
-                m_vnPxIdxLUT[nModelIter] = nPxIter;
-                m_voPxInfoLUT[nPxIter].nModelIdx = nModelIter;
-                m_oLastColorFrame.data[nPxIter] = oInitImg.data[nPxIter];
-                ++nModelIter;
+    for(size_t nPxIter=0, nModelIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
+        m_voPxInfoLUT[nPxIter].nImgCoord_Y = (int)nPxIter/m_oImgSize.width;
+        m_voPxInfoLUT[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
+        if(m_oROI.data[nPxIter]) {
+            lvDbgAssert(nModelIter<m_nTotRelevantPxCount);
+            m_vnPxIdxLUT[nModelIter] = nPxIter;
+            m_voPxInfoLUT[nPxIter].nModelIdx = nModelIter;
+            ++nModelIter;
+        }
+        else
+            m_voPxInfoLUT[nPxIter].nModelIdx = SIZE_MAX;
+    }
+}
+
+void IIBackgroundSubtractor::saveModel_common(BackgroundModelSnapshot& oSnapshot) const {
+    lvAssert_(m_bInitialized && m_bModelInitialized,"algo & model must be initialized first");
+    lvAssert_(!isUsingReducedResolution(),"model snapshots are not supported in reduced-resolution mode");
+    oSnapshot.addValue("anImgSize",std::array<int32_t,2>{m_oImgSize.width,m_oImgSize.height});
+    oSnapshot.addValue("nImgType",int32_t(m_nImgType));
+    oSnapshot.addValue("nROIBorderSize",uint64_t(m_nROIBorderSize));
+    oSnapshot.addValue("anROIPxCounts",std::array<uint64_t,2>{uint64_t(m_nOrigROIPxCount),uint64_t(m_nFinalROIPxCount)});
+    oSnapshot.addValue("anFrameCounters",std::array<uint64_t,3>{uint64_t(m_nFrameIdx),uint64_t(m_nFramesSinceLastReset),uint64_t(m_nModelResetCooldown)});
+    oSnapshot.addValue("abFlags",std::array<bool,2>{m_bAutoModelResetEnabled,m_bUsingMovingCamera});
+    oSnapshot.addMat("oROI",m_oROI);
+    oSnapshot.addMat("oLastFGMask",m_oLastFGMask);
+    oSnapshot.addMat("oLastColorFrame",m_oLastColorFrame);
+}
+
+void IIBackgroundSubtractor::loadModel_common(const BackgroundModelSnapshot& oSnapshot) {
+    m_bInitialized = false;
+    m_bModelInitialized = false;
+    lvAssert_(m_nReducedResScale<=1,"model snapshots are not supported in reduced-resolution mode");
+    m_oReducedResInputSize = cv::Size();
+    lvAssert_(oSnapshot.getValue<uint64_t>("nROIBorderSize")==uint64_t(m_nROIBorderSize),"snapshot ROI border size does not match algorithm");
+    const std::array<int32_t,2> anImgSize = oSnapshot.getValue<std::array<int32_t,2>>("anImgSize");
+    const int nImgType = (int)oSnapshot.getValue<int32_t>("nImgType");
+    lvAssert_(anImgSize[0]>0 && anImgSize[1]>0 && (nImgType==CV_8UC1 || nImgType==CV_8UC3 || nImgType==CV_8UC4),"snapshot contains bad image info");
+    const std::array<uint64_t,2> anROIPxCounts = oSnapshot.getValue<std::array<uint64_t,2>>("anROIPxCounts");
+    const std::array<uint64_t,3> anFrameCounters = oSnapshot.getValue<std::array<uint64_t,3>>("anFrameCounters");
+    const std::array<bool,2> abFlags = oSnapshot.getValue<std::array<bool,2>>("abFlags");
+    m_oImgSize = cv::Size(anImgSize[0],anImgSize[1]);
+    m_nImgType = nImgType;
+    m_nImgChannels = (size_t)CV_MAT_CN(nImgType);
+    m_nTotPxCount = m_oImgSize.area();
+    m_nOrigROIPxCount = size_t(anROIPxCounts[0]);
+    m_nFinalROIPxCount = m_nTotRelevantPxCount = size_t(anROIPxCounts[1]);
+    m_nFrameIdx = size_t(anFrameCounters[0]);
+    m_nFramesSinceLastReset = size_t(anFrameCounters[1]);
+    m_nModelResetCooldown = size_t(anFrameCounters[2]);
+    m_oStats.reset();
+    m_bAutoModelResetEnabled = abFlags[0];
+    m_bUsingMovingCamera = abFlags[1];
+    m_oROI = oSnapshot.getMat("oROI").clone();
+    lvAssert_(m_oROI.size()==m_oImgSize && m_oROI.type()==CV_8UC1 && (size_t)cv::countNonZero(m_oROI)==m_nFinalROIPxCount,"snapshot contains bad ROI");
+    m_oLastFGMask = oSnapshot.getMat("oLastFGMask").clone();
+    lvAssert_(m_oLastFGMask.size()==m_oImgSize && m_oLastFGMask.type()==CV_8UC1,"snapshot contains bad fg mask");
+    m_oLastColorFrame = oSnapshot.getMat("oLastColorFrame").clone();
+    lvAssert_(m_oLastColorFrame.size()==m_oImgSize && m_oLastColorFrame.type()==m_nImgType,"snapshot contains bad color frame");
+    initPxLUTs();
+    initActivityGating(m_oLastColorFrame);
+}
+
+void IIBackgroundSubtractor::initActivityGating(const cv::Mat& oRefImg) {
+    m_nActiveBlockCount = 0;
+    if(!m_bUsingActivityGating) {
+        m_oGatingRefFrame.release();
+        m_oGatingBlockDiff.release();
+        m_oGatingBlockMask.release();
+        m_oGatingBlockFrameCount.release();
+        return;
+    }
+    lvAssert_(oRefImg.size()==m_oImgSize && oRefImg.type()==m_nImgType,"bad activity gating reference image");
+    // blocks which contain non-ROI pixels in the reference (e.g. after a snapshot load) are simply flagged active on the first frame
+    m_oGatingRefFrame = oRefImg.clone();
+    const int nBlockSize = (int)m_nGatingBlockSize;
+    m_oGatingBlockMask.create((m_oImgSize.height+nBlockSize-1)/nBlockSize,(m_oImgSize.width+nBlockSize-1)/nBlockSize);
+    m_oGatingBlockMask = cv::Scalar_<uchar>(1);
+    m_oGatingBlockFrameCount.create(m_oGatingBlockMask.size());
+    m_oGatingBlockFrameCount = cv::Scalar_<ushort>(1);
+}
+
+void IIBackgroundSubtractor::updateActivityGating(const cv::Mat& oInputImg) {
+    lvDbgAssert(m_bUsingActivityGating && !m_oGatingRefFrame.empty() && !m_oGatingBlockMask.empty());
+    lvDbgAssert(oInputImg.size()==m_oImgSize && oInputImg.type()==m_nImgType);
+    const int nBlockSize = (int)m_nGatingBlockSize;
+    // blocks updated on the previous frame start a new count, while gated ones accumulate the frames their next update must stand for
+    for(int nBlockIdx=0; nBlockIdx<(int)m_oGatingBlockMask.total(); ++nBlockIdx) {
+        ushort& nFrameCount = ((ushort*)m_oGatingBlockFrameCount.data)[nBlockIdx];
+        nFrameCount = m_oGatingBlockMask.data[nBlockIdx]?ushort(1):cv::saturate_cast<ushort>(nFrameCount+1);
+    }
+    if(m_nFrameIdx<=m_nGatingRefreshPeriod) // the model is still bootstrapping; everything is processed
+        m_oGatingBlockMask = cv::Scalar_<uchar>(1);
+    else {
+        lv::computeBlockTemporalAbsDiff(oInputImg,m_oGatingRefFrame,nBlockSize,m_oGatingBlockDiff);
+        for(int nBlockRowIdx=0; nBlockRowIdx<m_oGatingBlockMask.rows; ++nBlockRowIdx) {
+            for(int nBlockColIdx=0; nBlockColIdx<m_oGatingBlockMask.cols; ++nBlockColIdx) {
+                // blocks that changed beyond the noise bound or that still contain foreground must always be processed
+                const cv::Rect oBlockRect(cv::Point(nBlockColIdx*nBlockSize,nBlockRowIdx*nBlockSize),cv::Size(nBlockSize,nBlockSize));
+                m_oGatingBlockMask(nBlockRowIdx,nBlockColIdx) = (m_oGatingBlockDiff.at<float>(nBlockRowIdx,nBlockColIdx)>m_fGatingNoiseThreshold ||
+                                                                 cv::countNonZero(m_oLastFGMask(oBlockRect&cv::Rect(cv::Point(),m_oImgSize)))>0)?1:0;
             }
-            else
-                m_voPxInfoLUT[nPxIter].nModelIdx = SIZE_MAX;
         }
+        // neighbors of active blocks are also processed, as LBSP patches & sample spreading cross block borders
+        cv::dilate(m_oGatingBlockMask,m_oGatingBlockMask,cv::Mat());
+        // quiet blocks get their deferred model updates in a staggered round-robin, so each frame only refreshes a fraction of them
+        for(int nBlockIdx=0; nBlockIdx<(int)m_oGatingBlockMask.total(); ++nBlockIdx)
+            if(((m_nFrameIdx+(size_t)nBlockIdx)%m_nGatingRefreshPeriod)==0)
+                m_oGatingBlockMask.data[nBlockIdx] = 1;
+    }
+    m_nActiveBlockCount = 0;
+    for(int nBlockRowIdx=0; nBlockRowIdx<m_oGatingBlockMask.rows; ++nBlockRowIdx) {
+        for(int nBlockColIdx=0; nBlockColIdx<m_oGatingBlockMask.cols; ++nBlockColIdx) {
+            if(m_oGatingBlockMask(nBlockRowIdx,nBlockColIdx)) {
+                // the reference only follows blocks seen by the model, so slow drifts in quiet blocks eventually cross the noise bound
+                const cv::Rect oBlockRect = cv::Rect(cv::Point(nBlockColIdx*nBlockSize,nBlockRowIdx*nBlockSize),cv::Size(nBlockSize,nBlockSize))&cv::Rect(cv::Point(),m_oImgSize);
+                oInputImg(oBlockRect).copyTo(m_oGatingRefFrame(oBlockRect));
+                ++m_nActiveBlockCount;
+            }
+        }
+    }
+}
+
+void IIBackgroundSubtractor::copyMaskAndExtractBlobs(const cv::Mat& oFGMask, cv::Mat& oOutput, std::vector<ForegroundBlob>& voBlobs) const {
+    lvDbgAssert(oFGMask.type()==CV_8UC1 && oFGMask.data!=oOutput.data);
+    voBlobs.clear();
+    if(!m_bUsingBlobExtraction) {
+        oFGMask.copyTo(oOutput);
+        return;
     }
-    else { //(m_nImgChannels==3 || m_nImgChannels==4)
-        lvAssert(m_oLastColorFrame.step.p[0]==(size_t)m_oImgSize.width*m_nImgChannels && m_oLastColorFrame.step.p[1]==m_nImgChannels);
-        for(size_t nPxIter=0, nModelIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
-            m_voPxInfoLUT[nPxIter].nImgCoord_Y = (int)nPxIter/m_oImgSize.width;
-            m_voPxInfoLUT[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
-            if(m_oROI.data[nPxIter]) {
-                m_vnPxIdxLUT[nModelIter] = nPxIter;
-                m_voPxInfoLUT[nPxIter].nModelIdx = nModelIter;
-                const size_t nPxRGBIter = nPxIter*m_nImgChannels;
-                if(m_nImgChannels==3)
-                    for(size_t c=0; c<3; ++c)
-                        m_oLastColorFrame.data[nPxRGBIter+c] = oInitImg.data[nPxRGBIter+c];
-                else //m_nImgChannels==4
-                    for(size_t c=0; c<4; ++c)
-                        m_oLastColorFrame.data[nPxRGBIter+c] = oInitImg.data[nPxRGBIter+c];
-                ++nModelIter;
+    oOutput.create(oFGMask.size(),CV_8UC1);
+    // runs are labeled via union-find on the fly, always keeping the lowest index as root (i.e. the blob's first run in raster order)
+    struct Run {int nRow, nBeg, nEnd, nParent;};
+    static thread_local std::vector<Run> s_vRuns;
+    static thread_local std::vector<int> s_vnRootBlobIdxs;
+    static thread_local std::vector<cv::Point2d> s_voBlobSums;
+    s_vRuns.clear();
+    const auto lFindRoot = [](int nRunIdx) {
+        while(s_vRuns[nRunIdx].nParent!=nRunIdx)
+            nRunIdx = s_vRuns[nRunIdx].nParent = s_vRuns[s_vRuns[nRunIdx].nParent].nParent;
+        return nRunIdx;
+    };
+    size_t nPrevRowRunBeg = 0, nPrevRowRunEnd = 0;
+    for(int nRowIdx=0; nRowIdx<oFGMask.rows; ++nRowIdx) {
+        const uchar* pnInputRow = oFGMask.ptr<uchar>(nRowIdx);
+        std::copy_n(pnInputRow,oFGMask.cols,oOutput.ptr<uchar>(nRowIdx)); // the row is still cache-hot for the scan below
+        const size_t nCurrRowRunBeg = s_vRuns.size();
+        size_t nPrevRunIdx = nPrevRowRunBeg;
+        for(int nColIdx=0; nColIdx<oFGMask.cols; ++nColIdx) {
+            if(!pnInputRow[nColIdx])
+                continue;
+            const int nRunBeg = nColIdx;
+            while(nColIdx<oFGMask.cols && pnInputRow[nColIdx])
+                ++nColIdx;
+            const int nRunIdx = (int)s_vRuns.size();
+            s_vRuns.push_back({nRowIdx,nRunBeg,nColIdx,nRunIdx});
+            // with 8-connectivity, runs of the previous row touching [nRunBeg-1,nColIdx] belong to the same blob
+            while(nPrevRunIdx<nPrevRowRunEnd && s_vRuns[nPrevRunIdx].nEnd<nRunBeg)
+                ++nPrevRunIdx;
+            for(size_t nTouchingRunIdx=nPrevRunIdx; nTouchingRunIdx<nPrevRowRunEnd && s_vRuns[nTouchingRunIdx].nBeg<=nColIdx; ++nTouchingRunIdx) {
+                const int nRoot1 = lFindRoot((int)nTouchingRunIdx), nRoot2 = lFindRoot(nRunIdx);
+                if(nRoot1!=nRoot2)
+                    s_vRuns[std::max(nRoot1,nRoot2)].nParent = std::min(nRoot1,nRoot2);
             }
-            else
-                m_voPxInfoLUT[nPxIter].nModelIdx = SIZE_MAX;
         }
+        nPrevRowRunBeg = nCurrRowRunBeg;
+        nPrevRowRunEnd = s_vRuns.size();
     }
+    s_vnRootBlobIdxs.assign(s_vRuns.size(),-1);
+    s_voBlobSums.clear();
+    for(int nRunIdx=0; nRunIdx<(int)s_vRuns.size(); ++nRunIdx) {
+        const Run& oRun = s_vRuns[nRunIdx];
+        const int nRoot = lFindRoot(nRunIdx);
+        if(s_vnRootBlobIdxs[nRoot]<0) {
+            s_vnRootBlobIdxs[nRoot] = (int)voBlobs.size();
+            voBlobs.push_back({cv::Rect(oRun.nBeg,oRun.nRow,oRun.nEnd-oRun.nBeg,1),0,cv::Point2f(),{}});
+            s_voBlobSums.push_back(cv::Point2d());
+        }
+        const int nBlobIdx = s_vnRootBlobIdxs[nRoot];
+        ForegroundBlob& oBlob = voBlobs[nBlobIdx];
+        const size_t nRunLength = size_t(oRun.nEnd-oRun.nBeg);
+        oBlob.oBBox |= cv::Rect(oRun.nBeg,oRun.nRow,(int)nRunLength,1);
+        oBlob.nArea += nRunLength;
+        s_voBlobSums[nBlobIdx] += cv::Point2d((oRun.nBeg+oRun.nEnd-1)*0.5*nRunLength,double(oRun.nRow)*nRunLength);
+        if(m_bBlobExtractionWithRuns)
+            oBlob.vRuns.emplace_back(oRun.nRow,oRun.nBeg,oRun.nEnd);
+    }
+    for(size_t nBlobIdx=0; nBlobIdx<voBlobs.size(); ++nBlobIdx)
+        voBlobs[nBlobIdx].oCentroid = cv::Point2f(s_voBlobSums[nBlobIdx]*(1.0/voBlobs[nBlobIdx].nArea));
+    voBlobs.erase(std::remove_if(voBlobs.begin(),voBlobs.end(),[this](const ForegroundBlob& oBlob){return oBlob.nArea<m_nBlobMinArea;}),voBlobs.end());
 }
 
 #if HAVE_GLSL
@@ -205,3 +804,75 @@ void IBackgroundSubtractor_GLSL::apply(cv::InputArray oNextImage, cv::OutputArra
 }
 
 #endif //HAVE_GLSL
+
+IBackgroundSubtractor_CPUThreads::IBackgroundSubtractor_(size_t nThreadCount, size_t nTileCount, uint32_t nSeed) :
+        lv::IParallelAlgo_CPUThreads(nThreadCount),
+        m_nTileCount(nTileCount),
+        m_nRandomSeed(nSeed) {
+    lvAssert_(m_nTileCount>0,"tile count must be positive");
+}
+
+void IBackgroundSubtractor_CPUThreads::setTileCount(size_t nTileCount) {
+    lvAssert_(nTileCount>0,"tile count must be positive");
+    m_nTileCount = nTileCount;
+    m_oTileSize = cv::Size();
+    if(m_bInitialized)
+        initTiles();
+}
+
+void IBackgroundSubtractor_CPUThreads::setTileSize(const cv::Size& oTileSize) {
+    lvAssert_(oTileSize.area()>0 || oTileSize==cv::Size(),"tile size must be positive or empty");
+    m_oTileSize = oTileSize;
+    if(m_bInitialized)
+        initTiles();
+}
+
+void IBackgroundSubtractor_CPUThreads::initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI) {
+    IIBackgroundSubtractor::initialize_common(oInitImg,oROI);
+    initTiles();
+}
+
+void IBackgroundSubtractor_CPUThreads::loadModel_common(const BackgroundModelSnapshot& oSnapshot) {
+    IIBackgroundSubtractor::loadModel_common(oSnapshot);
+    initTiles();
+}
+
+void IBackgroundSubtractor_CPUThreads::initTiles() {
+    m_voTiles.clear();
+    if(m_oImgSize.height<=0)
+        return;
+    std::vector<cv::Rect> voTileRects;
+    if(m_oTileSize.area()>0) {
+        for(int nRowIdx=0; nRowIdx<m_oImgSize.height; nRowIdx+=m_oTileSize.height)
+            for(int nColIdx=0; nColIdx<m_oImgSize.width; nColIdx+=m_oTileSize.width)
+                voTileRects.push_back(cv::Rect(cv::Point(nColIdx,nRowIdx),m_oTileSize)&cv::Rect(cv::Point(),m_oImgSize));
+    }
+    else {
+        const int nTileCount = std::min((int)m_nTileCount,m_oImgSize.height);
+        for(int nTileIdx=0; nTileIdx<nTileCount; ++nTileIdx) {
+            const int nRowBeg = (m_oImgSize.height*nTileIdx)/nTileCount, nRowEnd = (m_oImgSize.height*(nTileIdx+1))/nTileCount;
+            voTileRects.push_back(cv::Rect(0,nRowBeg,m_oImgSize.width,nRowEnd-nRowBeg));
+        }
+    }
+    m_voTiles.resize(voTileRects.size());
+    const auto pLUTBeg = m_vnPxIdxLUT.begin(), pLUTEnd = m_vnPxIdxLUT.begin()+m_nTotRelevantPxCount;
+    for(size_t nTileIdx=0; nTileIdx<voTileRects.size(); ++nTileIdx) {
+        TileInfo& oTile = m_voTiles[nTileIdx];
+        oTile.oRect = voTileRects[nTileIdx];
+        // pixel LUT is sorted in raster order, so each tile row maps to a contiguous model index range (merged for full-width tiles)
+        for(int nRowIdx=oTile.oRect.y; nRowIdx<oTile.oRect.y+oTile.oRect.height; ++nRowIdx) {
+            const size_t nRowOffset = size_t(nRowIdx)*m_oImgSize.width;
+            oTile.oModelIters.add(size_t(std::lower_bound(pLUTBeg,pLUTEnd,nRowOffset+oTile.oRect.x)-pLUTBeg),
+                                  size_t(std::lower_bound(pLUTBeg,pLUTEnd,nRowOffset+oTile.oRect.x+oTile.oRect.width)-pLUTBeg));
+        }
+    }
+}
+
+int IBackgroundSubtractor_CPUThreads::getTileSeed(size_t nTileIdx, size_t nFrameIdx) const {
+    return lv::getTileFrameSeed(m_nRandomSeed,nTileIdx,nFrameIdx);
+}
+
+void IBackgroundSubtractor_CPUThreads::processTiles(const std::function<void(size_t)>& lTileFunc) {
+    lvAssert_(!m_voTiles.empty(),"tile LUT must be initialized first");
+    parallelFor(m_voTiles.size(),lTileFunc);
+}
@@ -16,11 +16,282 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorLBSP.hpp"
+#include "litiv/utils/simd.hpp"
+
+constexpr size_t LBSPSampleStore::s_nPxBlockAlign;
+constexpr size_t LBSPSampleStore::s_nDescBlockAlign;
+constexpr size_t LBSPSampleMatcher::s_nBatchSize;
+constexpr size_t LBSPSampleMatcher::s_nFirstBatchSize;
+
+LBSPSampleStore::LBSPSampleStore() :
+        m_pData(nullptr),
+        m_nDataSize(0),
+        m_eLayout(SampleMajor),
+        m_nSamples(0),
+        m_nPxCount(0),
+        m_nChannels(0),
+        m_nDescOffset(0),
+        m_nColorSampleStep(0),
+        m_nColorPxStep(0),
+        m_nDescSampleStep(0),
+        m_nDescPxStep(0) {}
+
+void LBSPSampleStore::create(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels) {
+    m_pExternalOwner = nullptr;
+    m_nDataSize = setupLayout(eLayout,nSamples,oFrameSize,nChannels);
+    m_vData.assign(m_nDataSize,uchar(0));
+    m_pData = m_vData.data();
+}
+
+void LBSPSampleStore::wrap(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels, uchar* pData, size_t nDataSize, std::shared_ptr<void> pOwner) {
+    lvAssert_(pData && (((uintptr_t)pData)%s_nPxBlockAlign)==0,"wrapped sample data must be non-null and aligned to pixel block boundaries");
+    const size_t nExpectedDataSize = setupLayout(eLayout,nSamples,oFrameSize,nChannels);
+    lvAssert_(nDataSize==nExpectedDataSize,"wrapped sample data size does not match store layout");
+    m_vData.clear();
+    m_vData.shrink_to_fit();
+    m_pExternalOwner = std::move(pOwner);
+    m_nDataSize = nDataSize;
+    m_pData = pData;
+}
+
+size_t LBSPSampleStore::setupLayout(Layout eLayout, size_t nSamples, const cv::Size& oFrameSize, size_t nChannels) {
+    static_assert(LBSP::DESC_SIZE==2,"bad assumptions in impl below");
+    lvAssert_(nSamples>0 && oFrameSize.area()>0 && nChannels>0,"sample store dimensions must be non-null");
+    const auto lAlignUp = [](size_t nSize, size_t nAlign) {return ((nSize+nAlign-1)/nAlign)*nAlign;};
+    m_eLayout = eLayout;
+    m_nSamples = nSamples;
+    m_nPxCount = (size_t)oFrameSize.area();
+    m_nChannels = nChannels;
+    if(eLayout==SampleMajor) {
+        m_nColorSampleStep = m_nPxCount*nChannels;
+        m_nColorPxStep = nChannels;
+        m_nDescSampleStep = m_nPxCount*nChannels*LBSP::DESC_SIZE;
+        m_nDescPxStep = nChannels*LBSP::DESC_SIZE;
+        m_nDescOffset = lAlignUp(m_nColorSampleStep*nSamples,s_nPxBlockAlign);
+        return m_nDescOffset+m_nDescSampleStep*nSamples;
+    }
+    lvAssert_(eLayout==PixelMajor,"unknown sample store layout");
+    m_nColorSampleStep = nChannels;
+    m_nDescSampleStep = nChannels*LBSP::DESC_SIZE;
+    m_nDescOffset = lAlignUp(m_nColorSampleStep*nSamples,s_nDescBlockAlign);
+    m_nColorPxStep = m_nDescPxStep = lAlignUp(m_nDescOffset+m_nDescSampleStep*nSamples,s_nPxBlockAlign);
+    return m_nColorPxStep*m_nPxCount;
+}
+
+namespace {
+
+    /// scale factor applied to (shifted) descriptor distances when mixing them with color distances
+    constexpr int s_nSumDistDescScale = int(UCHAR_MAX/LBSP::DESC_SIZE_BITS);
+
+    /// clamps a distance threshold to the signed 16-bit lane range used by the vectorized matchers
+    inline short getLaneThreshold(size_t nThreshold) {
+        return (short)std::min(nThreshold,(size_t)SHRT_MAX);
+    }
+
+    /// planar 16-bit sample data gathered for a single batch (one lane per sample)
+    template<size_t nChannels>
+    struct LBSPSampleBatch {
+        alignas(32) std::array<std::array<ushort,LBSPSampleMatcher::s_nBatchSize>,nChannels> aanColor;
+        alignas(32) std::array<std::array<ushort,LBSPSampleMatcher::s_nBatchSize>,nChannels> aanDesc;
+        alignas(32) std::array<std::array<ushort,LBSPSampleMatcher::s_nBatchSize>,nChannels> aanThreshold;
+    };
+
+#if HAVE_AVX2
+
+    /// tests all sixteen lanes of a sample batch at once; returns the bitmask of failed lanes
+    template<size_t nChannels>
+    uint32_t matchLanes_AVX2(const LBSPSampleBatch<nChannels>& oBatch, const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                             const LBSPSampleMatcher::Thresholds& oThresholds, ushort* anTotDescDist, ushort* anTotSumDist) {
+        const __m256i anColorDistThreshold = _mm256_set1_epi16(getLaneThreshold(oThresholds.nColorDist));
+        const __m256i anDescDistThreshold = _mm256_set1_epi16(getLaneThreshold(oThresholds.nDescDist));
+        const __m256i anSumDistThreshold = _mm256_set1_epi16(getLaneThreshold(oThresholds.nSumDist));
+        const __m256i anSumDistScale = _mm256_set1_epi16((short)s_nSumDistDescScale);
+        const __m256i anSumDistMax = _mm256_set1_epi16((short)UCHAR_MAX);
+        const __m128i nSumDistDescShift = _mm_cvtsi32_si128(oThresholds.nSumDistDescShift);
+        __m256i abFailed = _mm256_setzero_si256(), anTotDesc = _mm256_setzero_si256(), anTotSum = _mm256_setzero_si256();
+        for(size_t c=0; c<nChannels; ++c) {
+            const __m256i anBGColor = _mm256_load_si256((const __m256i*)oBatch.aanColor[c].data());
+            const __m256i anBGDesc = _mm256_load_si256((const __m256i*)oBatch.aanDesc[c].data());
+            const __m256i anBGThreshold = _mm256_load_si256((const __m256i*)oBatch.aanThreshold[c].data());
+            const __m256i anColorDist = lv::absdiff_16i(_mm256_set1_epi16((short)anCurrColor[c]),anBGColor);
+            __m256i anCurrInterDesc = _mm256_setzero_si256();
+            for(size_t n=0; n<LBSP::DESC_SIZE_BITS; ++n) {
+                const __m256i anLookupDist = lv::absdiff_16i(_mm256_set1_epi16((short)anLookupVals[c*LBSP::DESC_SIZE_BITS+n]),anBGColor);
+                anCurrInterDesc = _mm256_or_si256(anCurrInterDesc,_mm256_and_si256(_mm256_cmpgt_epi16(anLookupDist,anBGThreshold),_mm256_set1_epi16((short)(1<<n))));
+            }
+            __m256i anDescDist = lv::popcount_16ui(_mm256_xor_si256(anCurrInterDesc,anBGDesc));
+            if(oThresholds.bUseIntraDesc)
+                anDescDist = _mm256_srli_epi16(_mm256_add_epi16(anDescDist,lv::popcount_16ui(_mm256_xor_si256(_mm256_set1_epi16((short)anCurrIntraDesc[c]),anBGDesc))),1);
+            __m256i anSumDist = anColorDist;
+            if(oThresholds.nSumDistDescShift>0)
+                anSumDist = _mm256_min_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_srl_epi16(anDescDist,nSumDistDescShift),anSumDistScale),anColorDist),anSumDistMax);
+            abFailed = _mm256_or_si256(abFailed,_mm256_or_si256(_mm256_cmpgt_epi16(anColorDist,anColorDistThreshold),
+                                                                _mm256_or_si256(_mm256_cmpgt_epi16(anDescDist,anDescDistThreshold),_mm256_cmpgt_epi16(anSumDist,anSumDistThreshold))));
+            anTotDesc = _mm256_add_epi16(anTotDesc,anDescDist);
+            anTotSum = _mm256_add_epi16(anTotSum,anSumDist);
+        }
+        abFailed = _mm256_or_si256(abFailed,_mm256_or_si256(_mm256_cmpgt_epi16(anTotDesc,_mm256_set1_epi16(getLaneThreshold(oThresholds.nTotDescDist))),
+                                                            _mm256_cmpgt_epi16(anTotSum,_mm256_set1_epi16(getLaneThreshold(oThresholds.nTotSumDist)))));
+        if(anTotDescDist)
+            _mm256_storeu_si256((__m256i*)anTotDescDist,anTotDesc);
+        if(anTotSumDist)
+            _mm256_storeu_si256((__m256i*)anTotSumDist,anTotSum);
+        return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(_mm256_castsi256_si128(abFailed),_mm256_extracti128_si256(abFailed,1)));
+    }
+
+#elif HAVE_SSE2
+
+    /// tests eight lanes of a sample batch at once (starting at 'nLaneOffset'); returns the bitmask of failed lanes
+    template<size_t nChannels>
+    uint32_t matchLanes_SSE2(const LBSPSampleBatch<nChannels>& oBatch, size_t nLaneOffset, const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                             const LBSPSampleMatcher::Thresholds& oThresholds, ushort* anTotDescDist, ushort* anTotSumDist) {
+        const __m128i anColorDistThreshold = _mm_set1_epi16(getLaneThreshold(oThresholds.nColorDist));
+        const __m128i anDescDistThreshold = _mm_set1_epi16(getLaneThreshold(oThresholds.nDescDist));
+        const __m128i anSumDistThreshold = _mm_set1_epi16(getLaneThreshold(oThresholds.nSumDist));
+        const __m128i anSumDistScale = _mm_set1_epi16((short)s_nSumDistDescScale);
+        const __m128i anSumDistMax = _mm_set1_epi16((short)UCHAR_MAX);
+        const __m128i nSumDistDescShift = _mm_cvtsi32_si128(oThresholds.nSumDistDescShift);
+        __m128i abFailed = _mm_setzero_si128(), anTotDesc = _mm_setzero_si128(), anTotSum = _mm_setzero_si128();
+        for(size_t c=0; c<nChannels; ++c) {
+            const __m128i anBGColor = _mm_load_si128((const __m128i*)(oBatch.aanColor[c].data()+nLaneOffset));
+            const __m128i anBGDesc = _mm_load_si128((const __m128i*)(oBatch.aanDesc[c].data()+nLaneOffset));
+            const __m128i anBGThreshold = _mm_load_si128((const __m128i*)(oBatch.aanThreshold[c].data()+nLaneOffset));
+            const __m128i anColorDist = lv::absdiff_16i(_mm_set1_epi16((short)anCurrColor[c]),anBGColor);
+            __m128i anCurrInterDesc = _mm_setzero_si128();
+            for(size_t n=0; n<LBSP::DESC_SIZE_BITS; ++n) {
+                const __m128i anLookupDist = lv::absdiff_16i(_mm_set1_epi16((short)anLookupVals[c*LBSP::DESC_SIZE_BITS+n]),anBGColor);
+                anCurrInterDesc = _mm_or_si128(anCurrInterDesc,_mm_and_si128(_mm_cmpgt_epi16(anLookupDist,anBGThreshold),_mm_set1_epi16((short)(1<<n))));
+            }
+            __m128i anDescDist = lv::popcount_16ui(_mm_xor_si128(anCurrInterDesc,anBGDesc));
+            if(oThresholds.bUseIntraDesc)
+                anDescDist = _mm_srli_epi16(_mm_add_epi16(anDescDist,lv::popcount_16ui(_mm_xor_si128(_mm_set1_epi16((short)anCurrIntraDesc[c]),anBGDesc))),1);
+            __m128i anSumDist = anColorDist;
+            if(oThresholds.nSumDistDescShift>0)
+                anSumDist = _mm_min_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_srl_epi16(anDescDist,nSumDistDescShift),anSumDistScale),anColorDist),anSumDistMax);
+            abFailed = _mm_or_si128(abFailed,_mm_or_si128(_mm_cmpgt_epi16(anColorDist,anColorDistThreshold),
+                                                          _mm_or_si128(_mm_cmpgt_epi16(anDescDist,anDescDistThreshold),_mm_cmpgt_epi16(anSumDist,anSumDistThreshold))));
+            anTotDesc = _mm_add_epi16(anTotDesc,anDescDist);
+            anTotSum = _mm_add_epi16(anTotSum,anSumDist);
+        }
+        abFailed = _mm_or_si128(abFailed,_mm_or_si128(_mm_cmpgt_epi16(anTotDesc,_mm_set1_epi16(getLaneThreshold(oThresholds.nTotDescDist))),
+                                                      _mm_cmpgt_epi16(anTotSum,_mm_set1_epi16(getLaneThreshold(oThresholds.nTotSumDist)))));
+        if(anTotDescDist)
+            _mm_storeu_si128((__m128i*)(anTotDescDist+nLaneOffset),anTotDesc);
+        if(anTotSumDist)
+            _mm_storeu_si128((__m128i*)(anTotSumDist+nLaneOffset),anTotSum);
+        return ((uint32_t)_mm_movemask_epi8(_mm_packs_epi16(abFailed,_mm_setzero_si128()))&0xFFu)<<nLaneOffset;
+    }
+
+#else //(!HAVE_AVX2 && !HAVE_SSE2)
+
+    /// tests all lanes of a sample batch one at a time; returns the bitmask of failed lanes
+    template<size_t nChannels>
+    uint32_t matchLanes_scalar(const LBSPSampleBatch<nChannels>& oBatch, size_t nBatchSize, const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                               const LBSPSampleMatcher::Thresholds& oThresholds, ushort* anTotDescDist, ushort* anTotSumDist) {
+        uint32_t nFailedMask = 0;
+        for(size_t s=0; s<nBatchSize; ++s) {
+            bool bFailed = false;
+            size_t nTotDescDist = 0, nTotSumDist = 0;
+            for(size_t c=0; c<nChannels; ++c) {
+                const uchar nBGColor = (uchar)oBatch.aanColor[c][s];
+                const ushort nBGDesc = oBatch.aanDesc[c][s];
+                const size_t nColorDist = lv::L1dist(anCurrColor[c],nBGColor);
+                const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(anLookupVals+c*LBSP::DESC_SIZE_BITS,nBGColor,(uchar)oBatch.aanThreshold[c][s]);
+                size_t nDescDist = lv::hdist(nCurrInterDesc,nBGDesc);
+                if(oThresholds.bUseIntraDesc)
+                    nDescDist = (nDescDist+lv::hdist(anCurrIntraDesc[c],nBGDesc))/2;
+                const size_t nSumDist = (oThresholds.nSumDistDescShift>0)?std::min((nDescDist>>oThresholds.nSumDistDescShift)*s_nSumDistDescScale+nColorDist,(size_t)UCHAR_MAX):nColorDist;
+                bFailed |= (nColorDist>oThresholds.nColorDist || nDescDist>oThresholds.nDescDist || nSumDist>oThresholds.nSumDist);
+                nTotDescDist += nDescDist;
+                nTotSumDist += nSumDist;
+            }
+            bFailed |= (nTotDescDist>oThresholds.nTotDescDist || nTotSumDist>oThresholds.nTotSumDist);
+            nFailedMask |= uint32_t(bFailed)<<s;
+            if(anTotDescDist)
+                anTotDescDist[s] = (ushort)nTotDescDist;
+            if(anTotSumDist)
+                anTotSumDist[s] = (ushort)nTotSumDist;
+        }
+        return nFailedMask;
+    }
+
+#endif //(!HAVE_AVX2 && !HAVE_SSE2)
+
+} // anonymous namespace
+
+template<size_t nChannels>
+uint32_t LBSPSampleMatcher::matchBatch(const LBSPSampleStore& oSamples, size_t nPxIdx, size_t nFirstSample, size_t nBatchSize,
+                                       const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                                       const uchar* anLBSPThresholdLUT, const Thresholds& oThresholds,
+                                       ushort* anTotDescDist, ushort* anTotSumDist) {
+    static_assert(LBSP::DESC_SIZE_BITS==16 && s_nBatchSize==16 && s_nSumDistDescScale==15,"bad assumptions in impl below");
+    lvDbgAssert(nBatchSize>0 && nBatchSize<=s_nBatchSize && nFirstSample+nBatchSize<=oSamples.samples() && oSamples.channels()==nChannels);
+    lvDbgAssert(anCurrColor && anLookupVals && anLBSPThresholdLUT && (anCurrIntraDesc || !oThresholds.bUseIntraDesc));
+    LBSPSampleBatch<nChannels> oBatch;
+    for(size_t s=0; s<nBatchSize; ++s) {
+        const uchar* const anBGColor = oSamples.color(nFirstSample+s,nPxIdx);
+        const ushort* const anBGDesc = oSamples.desc(nFirstSample+s,nPxIdx);
+        for(size_t c=0; c<nChannels; ++c) {
+            oBatch.aanColor[c][s] = anBGColor[c];
+            oBatch.aanDesc[c][s] = anBGDesc[c];
+            oBatch.aanThreshold[c][s] = anLBSPThresholdLUT[anBGColor[c]];
+        }
+    }
+    // only the lanes which will actually be loaded by the vectorized matchers need to be cleared past the batch end
+#if HAVE_AVX2
+    const size_t nLaneCount = s_nBatchSize;
+#elif HAVE_SSE2
+    const size_t nLaneCount = (nBatchSize>s_nBatchSize/2)?s_nBatchSize:s_nBatchSize/2;
+#else //(!HAVE_AVX2 && !HAVE_SSE2)
+    const size_t nLaneCount = nBatchSize;
+#endif //(!HAVE_AVX2 && !HAVE_SSE2)
+    for(size_t s=nBatchSize; s<nLaneCount; ++s)
+        for(size_t c=0; c<nChannels; ++c)
+            oBatch.aanColor[c][s] = oBatch.aanDesc[c][s] = oBatch.aanThreshold[c][s] = 0;
+#if HAVE_AVX2
+    const uint32_t nFailedMask = matchLanes_AVX2<nChannels>(oBatch,anCurrColor,anCurrIntraDesc,anLookupVals,oThresholds,anTotDescDist,anTotSumDist);
+#elif HAVE_SSE2
+    uint32_t nFailedMask = matchLanes_SSE2<nChannels>(oBatch,0,anCurrColor,anCurrIntraDesc,anLookupVals,oThresholds,anTotDescDist,anTotSumDist);
+    if(nBatchSize>s_nBatchSize/2)
+        nFailedMask |= matchLanes_SSE2<nChannels>(oBatch,s_nBatchSize/2,anCurrColor,anCurrIntraDesc,anLookupVals,oThresholds,anTotDescDist,anTotSumDist);
+#else //(!HAVE_AVX2 && !HAVE_SSE2)
+    const uint32_t nFailedMask = matchLanes_scalar<nChannels>(oBatch,nBatchSize,anCurrColor,anCurrIntraDesc,anLookupVals,oThresholds,anTotDescDist,anTotSumDist);
+#endif //(!HAVE_AVX2 && !HAVE_SSE2)
+    return ~nFailedMask&((1u<<nBatchSize)-1u);
+}
+
+template uint32_t LBSPSampleMatcher::matchBatch<1>(const LBSPSampleStore&, size_t, size_t, size_t, const uchar*, const ushort*, const uchar*, const uchar*, const Thresholds&, ushort*, ushort*);
+template uint32_t LBSPSampleMatcher::matchBatch<3>(const LBSPSampleStore&, size_t, size_t, size_t, const uchar*, const ushort*, const uchar*, const uchar*, const Thresholds&, ushort*, ushort*);
+
+void LBSPSampleMatcher::MatchReorderer::promote_impl(LBSPSampleStore& oSamples, size_t nPxIdx) const {
+    const size_t nChannels = oSamples.channels();
+    const size_t nFirstBatchSize = getBatchSize(0,oSamples.samples());
+    size_t nFreeIdx = 0;
+    for(size_t nMatchIdx=0; nMatchIdx<nLateMatches; ++nMatchIdx) {
+        while(nFreeIdx<nFirstBatchSize && (nFirstBatchGoodMask&(1u<<nFreeIdx)))
+            ++nFreeIdx;
+        if(nFreeIdx>=nFirstBatchSize)
+            return; // first batch is full of matches already
+        lvDbgAssert(anLateMatchIdxs[nMatchIdx]>=nFirstBatchSize && anLateMatchIdxs[nMatchIdx]<oSamples.samples());
+        uchar* const anFreeColor = oSamples.color(nFreeIdx,nPxIdx);
+        ushort* const anFreeDesc = oSamples.desc(nFreeIdx,nPxIdx);
+        uchar* const anMatchColor = oSamples.color(anLateMatchIdxs[nMatchIdx],nPxIdx);
+        ushort* const anMatchDesc = oSamples.desc(anLateMatchIdxs[nMatchIdx],nPxIdx);
+        for(size_t c=0; c<nChannels; ++c) {
+            std::swap(anFreeColor[c],anMatchColor[c]);
+            std::swap(anFreeDesc[c],anMatchDesc[c]);
+        }
+        ++nFreeIdx;
+    }
+}
 
 template<lv::ParallelAlgoType eImpl>
-void IBackgroundSubtractorLBSP_<eImpl>::initialize_common(const cv::Mat& oInitImg, const cv::Mat& oROI) {
+void IBackgroundSubtractorLBSP_<eImpl>::initialize_common(const cv::Mat& oFullInitImg, const cv::Mat& oFullROI) {
     lvDbgExceptionWatch;
-    IIBackgroundSubtractor::initialize_common(oInitImg,oROI);
+    // in reduced-resolution mode, everything below (& the whole model) only ever sees downscaled frames
+    cv::Mat oInitImg,oROI;
+    this->initReducedResolution(oFullInitImg,oFullROI,oInitImg,oROI);
+    IBackgroundSubtractor_<eImpl>::initialize_common(oInitImg,oROI);
     m_oLastDescFrame.create(this->m_oImgSize,CV_16UC((int)this->m_nImgChannels));
     m_oLastDescFrame = cv::Scalar_<ushort>::all(0);
     const int nLBSPBorderSize = (int)LBSP::PATCH_SIZE/2;
@@ -64,6 +335,24 @@ void IBackgroundSubtractorLBSP_<eImpl>::initialize_common(const cv::Mat& oInitIm
     }
 }
 
+template<lv::ParallelAlgoType eImpl>
+void IBackgroundSubtractorLBSP_<eImpl>::saveModel_common(BackgroundModelSnapshot& oSnapshot) const {
+    IIBackgroundSubtractor::saveModel_common(oSnapshot);
+    oSnapshot.addValue("nLBSPThresholdOffset",uint64_t(m_nLBSPThresholdOffset));
+    oSnapshot.addValue("fRelLBSPThreshold",m_fRelLBSPThreshold);
+    oSnapshot.addValue("anLBSPThreshold_8bitLUT",m_anLBSPThreshold_8bitLUT);
+    oSnapshot.addMat("oLastDescFrame",m_oLastDescFrame);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void IBackgroundSubtractorLBSP_<eImpl>::loadModel_common(const BackgroundModelSnapshot& oSnapshot) {
+    IBackgroundSubtractor_<eImpl>::loadModel_common(oSnapshot);
+    lvAssert_(oSnapshot.getValue<uint64_t>("nLBSPThresholdOffset")==uint64_t(m_nLBSPThresholdOffset) && oSnapshot.getValue<float>("fRelLBSPThreshold")==m_fRelLBSPThreshold,"snapshot LBSP thresholds do not match algorithm params");
+    m_anLBSPThreshold_8bitLUT = oSnapshot.getValue<std::array<uchar,UCHAR_MAX+1>>("anLBSPThreshold_8bitLUT");
+    m_oLastDescFrame = oSnapshot.getMat("oLastDescFrame").clone();
+    lvAssert_(m_oLastDescFrame.size()==this->m_oImgSize && m_oLastDescFrame.type()==CV_16UC((int)this->m_nImgChannels),"snapshot contains bad descriptor frame");
+}
+
 #if HAVE_GLSL
 
 template<>
@@ -99,4 +388,5 @@ template struct IBackgroundSubtractorLBSP_<lv::GLSL>;
 //template struct IBackgroundSubtractorLBSP_<lv::OpenCL>;
 #endif //HAVE_OPENCL
 
+template struct IBackgroundSubtractorLBSP_<lv::CPUThreads>;
 template struct IBackgroundSubtractorLBSP_<lv::NonParallel>;
@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorLOBSTER.hpp"
+#include "litiv/imgproc.hpp"
 
 template<>
 IBackgroundSubtractorLOBSTER::IBackgroundSubtractorLOBSTER_(size_t nDescDistThreshold, size_t nColorDistThreshold, size_t nBGSamples,
@@ -29,6 +30,18 @@ IBackgroundSubtractorLOBSTER::IBackgroundSubtractorLOBSTER_(size_t nDescDistThre
     lvAssert_(m_nColorDistThreshold>0 || m_nDescDistThreshold>0,"distance thresholds must be positive values");
 }
 
+template<>
+IBackgroundSubtractorLOBSTER_CPUThreads::IBackgroundSubtractorLOBSTER_(size_t nDescDistThreshold, size_t nColorDistThreshold, size_t nBGSamples,
+                                                                       size_t nRequiredBGSamples, size_t nLBSPThresholdOffset, float fRelLBSPThreshold) :
+        IBackgroundSubtractorLBSP_CPUThreads(fRelLBSPThreshold,nLBSPThresholdOffset),
+        m_nColorDistThreshold(nColorDistThreshold),
+        m_nDescDistThreshold(nDescDistThreshold),
+        m_nBGSamples(nBGSamples),
+        m_nRequiredBGSamples(nRequiredBGSamples) {
+    lvAssert_(m_nBGSamples>0 && m_nRequiredBGSamples<=m_nBGSamples,"algo cannot require more sample matches than sample count in model");
+    lvAssert_(m_nColorDistThreshold>0 || m_nDescDistThreshold>0,"distance thresholds must be positive values");
+}
+
 #if HAVE_GLSL
 template<>
 IBackgroundSubtractorLOBSTER_GLSL::IBackgroundSubtractorLOBSTER_(size_t nDescDistThreshold, size_t nColorDistThreshold, size_t nBGSamples,
@@ -98,6 +111,7 @@ void BackgroundSubtractorLOBSTER_GLSL::refreshModel(float fSamplesRefreshFrac, b
 void BackgroundSubtractorLOBSTER_GLSL::initialize_gl(const cv::Mat& oInitImg, const cv::Mat& oROI) {
     lvDbgExceptionWatch;
     // == init
+    lvAssert_(m_nReducedResScale<=1,"reduced-resolution mode is not supported by the GLSL impl");
     initialize_common(oInitImg,oROI);
     // not considering relevant pixels via LUT: it would ruin shared mem usage
     m_nTMT32ModelSize = size_t(m_oROI.cols*m_oROI.rows);
@@ -407,31 +421,32 @@ template struct BackgroundSubtractorLOBSTER_<lv::GLSL>;
 //template struct BackgroundSubtractorLOBSTER_<lv::OpenCL>;
 #endif //HAVE_OPENCL
 
-void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool bForceFGUpdate) {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::refreshModel(float fSamplesRefreshFrac, bool bForceFGUpdate) {
     lvDbgExceptionWatch;
     // == refresh
-    lvAssert_(m_bInitialized,"algo must be initialized first");
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
     lvAssert_(fSamplesRefreshFrac>0.0f && fSamplesRefreshFrac<=1.0f,"model refresh must be given as a non-null fraction");
-    const size_t nModelSamplesToRefresh = fSamplesRefreshFrac<1.0f?(size_t)(fSamplesRefreshFrac*m_nBGSamples):m_nBGSamples;
-    const size_t nRefreshSampleStartPos = fSamplesRefreshFrac<1.0f?rand()%m_nBGSamples:0;
-    for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-        const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-        if(bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
+    const size_t nModelSamplesToRefresh = fSamplesRefreshFrac<1.0f?(size_t)(fSamplesRefreshFrac*this->m_nBGSamples):this->m_nBGSamples;
+    const size_t nRefreshSampleStartPos = fSamplesRefreshFrac<1.0f?rand()%this->m_nBGSamples:0;
+    for(size_t nModelIter=0; nModelIter<this->m_nTotRelevantPxCount; ++nModelIter) {
+        const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
+        if(bForceFGUpdate || !this->m_oLastFGMask.data[nPxIter]) {
             for(size_t nCurrModelSampleIdx=nRefreshSampleStartPos; nCurrModelSampleIdx<nRefreshSampleStartPos+nModelSamplesToRefresh; ++nCurrModelSampleIdx) {
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                lv::getSamplePosition_7x7_std2(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,m_voPxInfoLUT[nPxIter].nImgCoord_X,m_voPxInfoLUT[nPxIter].nImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-                if(bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
-                    const size_t nCurrRealModelSampleIdx = nCurrModelSampleIdx%m_nBGSamples;
-                    for(size_t c=0; c<m_nImgChannels; ++c) {
-                        m_voBGColorSamples[nCurrRealModelSampleIdx].data[nPxIter*m_nImgChannels+c] = m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c];
-                        if(m_nImgChannels==1)
-                            LBSP::computeDescriptor<1>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,0,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
-                        else if(m_nImgChannels==3)
-                            LBSP::computeDescriptor<3>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
+                lv::getSamplePosition_7x7_std2(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,this->m_voPxInfoLUT[nPxIter].nImgCoord_X,this->m_voPxInfoLUT[nPxIter].nImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                const size_t nSamplePxIdx = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                if(bForceFGUpdate || !this->m_oLastFGMask.data[nSamplePxIdx]) {
+                    const size_t nCurrRealModelSampleIdx = nCurrModelSampleIdx%this->m_nBGSamples;
+                    for(size_t c=0; c<this->m_nImgChannels; ++c) {
+                        m_oBGSamples.color(nCurrRealModelSampleIdx,nPxIter)[c] = this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c];
+                        if(this->m_nImgChannels==1)
+                            LBSP::computeDescriptor<1>(this->m_oLastColorFrame,this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,0,this->m_anLBSPThreshold_8bitLUT[this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c]],*((ushort*)(this->m_oLastDescFrame.data+(nSamplePxIdx*this->m_nImgChannels+c)*2)));
+                        else if(this->m_nImgChannels==3)
+                            LBSP::computeDescriptor<3>(this->m_oLastColorFrame,this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,this->m_anLBSPThreshold_8bitLUT[this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c]],*((ushort*)(this->m_oLastDescFrame.data+(nSamplePxIdx*this->m_nImgChannels+c)*2)));
                         else //m_nImgChannels==4
-                            LBSP::computeDescriptor<4>(m_oLastColorFrame,m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,m_anLBSPThreshold_8bitLUT[m_oLastColorFrame.data[nSamplePxIdx*m_nImgChannels+c]],*((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2)));
-                        *((ushort*)(m_voBGDescSamples[nCurrRealModelSampleIdx].data+(nPxIter*m_nImgChannels+c)*2)) = *((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*m_nImgChannels+c)*2));
+                            LBSP::computeDescriptor<4>(this->m_oLastColorFrame,this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c],nSampleImgCoord_X,nSampleImgCoord_Y,c,this->m_anLBSPThreshold_8bitLUT[this->m_oLastColorFrame.data[nSamplePxIdx*this->m_nImgChannels+c]],*((ushort*)(this->m_oLastDescFrame.data+(nSamplePxIdx*this->m_nImgChannels+c)*2)));
+                        m_oBGSamples.desc(nCurrRealModelSampleIdx,nPxIter)[c] = *((ushort*)(this->m_oLastDescFrame.data+(nSamplePxIdx*this->m_nImgChannels+c)*2));
                     }
                 }
             }
@@ -439,184 +454,394 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
     }
 }
 
-void BackgroundSubtractorLOBSTER::initialize(const cv::Mat& oInitImg, const cv::Mat& oROI) {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::initialize(const cv::Mat& oInitImg, const cv::Mat& oROI) {
     lvDbgExceptionWatch;
     // == init
-    IBackgroundSubtractorLBSP::initialize_common(oInitImg,oROI);
-    m_voBGColorSamples.resize(m_nBGSamples);
-    m_voBGDescSamples.resize(m_nBGSamples);
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        m_voBGColorSamples[s].create(m_oImgSize,CV_8UC((int)m_nImgChannels));
-        m_voBGColorSamples[s] = cv::Scalar_<uchar>::all(0);
-        m_voBGDescSamples[s].create(m_oImgSize,CV_16UC((int)m_nImgChannels));
-        m_voBGDescSamples[s] = cv::Scalar_<ushort>::all(0);
-    }
-    m_bInitialized = true;
+    IBackgroundSubtractorLBSP_<eImpl>::initialize_common(oInitImg,oROI);
+    m_oBGSamples.create(this->m_eSampleLayout,this->m_nBGSamples,this->m_oImgSize,this->m_nImgChannels);
+    this->m_bInitialized = true;
     refreshModel(1.0f,true);
-    m_bModelInitialized = true;
+    this->m_bModelInitialized = true;
 }
 
-void BackgroundSubtractorLOBSTER::apply(cv::InputArray _oInputImg, cv::OutputArray _oFGMask, double dLearningRate) {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::apply(cv::InputArray _oInputImg, cv::OutputArray _oFGMask, double dLearningRate) {
     lvDbgExceptionWatch;
     // == process_sync
-    lvAssert_(m_bInitialized && m_bModelInitialized,"algo & model must be initialized first");
+    lvAssert_(this->m_bInitialized && this->m_bModelInitialized,"algo & model must be initialized first");
     lvAssert_(dLearningRate>0,"learning rate must be a positive value; faster learning is achieved with smaller values");
-    cv::Mat oInputImg = _oInputImg.getMat();
-    lvAssert_(oInputImg.type()==m_nImgType && oInputImg.size()==m_oImgSize,"input image type/size mismatch with initialization type/size");
+    const cv::Mat oFullInputImg = _oInputImg.getMat();
+    const cv::Mat& oInputImg = this->getModelInput(oFullInputImg,this->m_oReducedResInputImg);
+    lvAssert_(oInputImg.type()==this->m_nImgType && oInputImg.size()==this->m_oImgSize,"input image type/size mismatch with initialization type/size");
     lvAssert_(oInputImg.isContinuous(),"input image data must be continuous");
-    _oFGMask.create(m_oImgSize,CV_8UC1);
-    cv::Mat oCurrFGMask = _oFGMask.getMat();
+    cv::Mat oCurrFGMask = this->getModelOutput(_oFGMask);
     oCurrFGMask = cv::Scalar_<uchar>(0);
+    ++this->m_nFrameIdx;
+    if(this->beginBudgetedFrame()) {
+        // LOBSTER has no temporal state besides its samples, which are simply not updated for this frame
+        this->predictSkippedFrameMask(oCurrFGMask);
+        this->refineReducedResMask(oFullInputImg,oInputImg,oCurrFGMask,_oFGMask);
+        this->endBudgetedFrame();
+        return;
+    }
+    if(this->m_bUsingActivityGating)
+        this->updateActivityGating(oInputImg);
+    const size_t nLearningRate = std::isinf(dLearningRate)?SIZE_MAX:(size_t)ceil(dLearningRate);
+    apply_all(oInputImg,oCurrFGMask,nLearningRate);
+    lvBGSStatsOnly(++this->m_oStats.nFrames;)
+    lv::postProcessBinaryMask(oCurrFGMask,cv::Mat(),cv::Mat(),this->m_oLastFGMask,this->m_nDefaultMedianBlurKernelSize);
+    this->copyMaskAndExtractBlobs(this->m_oLastFGMask,oCurrFGMask,this->m_voLatestBlobs);
+    oInputImg.copyTo(this->m_oLastColorFrame);
+    this->refineReducedResMask(oFullInputImg,oInputImg,oCurrFGMask,_oFGMask);
+    this->endBudgetedFrame();
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::applyBatch(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, double dLearningRate) {
+    lvDbgExceptionWatch;
+    // == process_batch
+    lvAssert_(this->m_bInitialized && this->m_bModelInitialized,"algo & model must be initialized first");
+    lvAssert_(dLearningRate>0,"learning rate must be a positive value; faster learning is achieved with smaller values");
+    lvAssert_(!this->m_bUsingActivityGating,"activity gating cannot be used with batched processing");
+    lvAssert_(this->m_dFrameTimeBudget<=0.0,"frame time budget cannot be used with batched processing");
+    std::vector<cv::Mat> voModelImages(voImages.size());
+    for(size_t nImgIdx=0; nImgIdx<voImages.size(); ++nImgIdx) {
+        voModelImages[nImgIdx] = this->getModelInput(voImages[nImgIdx],voModelImages[nImgIdx]);
+        lvAssert_(voModelImages[nImgIdx].type()==this->m_nImgType && voModelImages[nImgIdx].size()==this->m_oImgSize,"input image type/size mismatch with initialization type/size");
+        lvAssert_(voModelImages[nImgIdx].isContinuous(),"input image data must be continuous");
+    }
+    voFGMasks.resize(voImages.size());
+    if(voImages.empty())
+        return;
+    const bool bReducedRes = this->isUsingReducedResolution();
+    std::vector<cv::Mat> voReducedResFGMasks(bReducedRes?voImages.size():size_t(0));
+    std::vector<cv::Mat>& voModelFGMasks = bReducedRes?voReducedResFGMasks:voFGMasks;
+    for(cv::Mat& oCurrFGMask : voModelFGMasks) {
+        oCurrFGMask.create(this->m_oImgSize,CV_8UC1);
+        oCurrFGMask = cv::Scalar_<uchar>(0);
+    }
     const size_t nLearningRate = std::isinf(dLearningRate)?SIZE_MAX:(size_t)ceil(dLearningRate);
-    if(m_nImgChannels==1) {
-        for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-            const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-            const size_t nDescIter = nPxIter*2;
-            const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
+    apply_batch_all(voModelImages,voModelFGMasks,nLearningRate);
+    lvBGSStatsOnly(this->m_oStats.nFrames += voImages.size();)
+    // the model updates do not depend on the final masks, so post-processing can be done once all frames are matched
+    for(size_t nImgIdx=0; nImgIdx<voImages.size(); ++nImgIdx) {
+        lv::postProcessBinaryMask(voModelFGMasks[nImgIdx],cv::Mat(),cv::Mat(),this->m_oLastFGMask,this->m_nDefaultMedianBlurKernelSize);
+        this->copyMaskAndExtractBlobs(this->m_oLastFGMask,voModelFGMasks[nImgIdx],this->m_voLatestBlobs);
+        this->refineReducedResMask(voImages[nImgIdx],voModelImages[nImgIdx],voModelFGMasks[nImgIdx],voFGMasks[nImgIdx]);
+    }
+    voModelImages.back().copyTo(this->m_oLastColorFrame);
+}
+
+template<lv::ParallelAlgoType eImpl>
+template<typename TRandGen>
+void BackgroundSubtractorLOBSTER_<eImpl>::apply_range(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, const ModelLUTSpans& oModelIters, const cv::Rect& oTileRect,
+                                                      TRandGen&& lRand, size_t nLearningRate, std::vector<DeferredNeighborUpdate>* pvDeferredUpdates, BackgroundSubtractorStats& oStats) {
+    UNUSED(oStats); // only touched in instrumented builds
+    lvBGSStatsOnly(const size_t nPrevGatedPixels = oStats.nGatedPixels;)
+    if(this->m_nImgChannels==1) {
+        const LBSPSampleMatcher::Thresholds oMatchThresholds = {this->m_nColorDistThreshold/2,this->m_nDescDistThreshold,SIZE_MAX,SIZE_MAX,SIZE_MAX,false,0};
+        for(const size_t nModelIter : oModelIters) {
+            const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
+            if(!this->isPxActive(nPxIter)) {
+                lvBGSStatsOnly(++oStats.nGatedPixels;)
+                continue; // quiet block; stays background, and its model updates are deferred until the block gets refreshed
+            }
+            // a refreshed block catches up on the updates it skipped while gated by raising its update rate accordingly
+            const size_t nPxLearningRate = std::max(nLearningRate/this->getPxGatedFrameCount(nPxIter),size_t(1));
+            const int nCurrImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
+            const int nCurrImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const uchar nCurrColor = oInputImg.data[nPxIter];
             alignas(16) std::array<uchar,LBSP::DESC_SIZE_BITS> anLBSPLookupVals;
             LBSP::computeDescriptor_lookup<1>(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,0,anLBSPLookupVals);
-            size_t nGoodSamplesCount=0, nModelIdx=0;
-            while(nGoodSamplesCount<m_nRequiredBGSamples && nModelIdx<m_nBGSamples) {
-                const uchar nBGColor = m_voBGColorSamples[nModelIdx].data[nPxIter];
-                {
-                    const size_t nColorDist = lv::L1dist(nCurrColor,nBGColor);
-                    if(nColorDist>m_nColorDistThreshold/2)
-                        goto failedcheck1ch;
-                    const ushort nCurrInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nBGColor,m_anLBSPThreshold_8bitLUT[nBGColor]);
-                    const size_t nDescDist = lv::hdist(nCurrInputDesc,*((ushort*)(m_voBGDescSamples[nModelIdx].data+nDescIter)));
-                    if(nDescDist>m_nDescDistThreshold)
-                        goto failedcheck1ch;
-                    nGoodSamplesCount++;
-                }
-                failedcheck1ch:
-                nModelIdx++;
+            size_t nGoodSamplesCount=0;
+            LBSPSampleMatcher::MatchReorderer oReorderer;
+            for(size_t nModelIdx=0; nGoodSamplesCount<this->m_nRequiredBGSamples && nModelIdx<this->m_nBGSamples; nModelIdx+=LBSPSampleMatcher::getBatchSize(nModelIdx,this->m_nBGSamples)) {
+                const size_t nBatchSize = LBSPSampleMatcher::getBatchSize(nModelIdx,this->m_nBGSamples);
+                const uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<1>(m_oBGSamples,nPxIter,nModelIdx,nBatchSize,&nCurrColor,nullptr,anLBSPLookupVals.data(),this->m_anLBSPThreshold_8bitLUT.data(),oMatchThresholds,nullptr,nullptr);
+                lvBGSStatsOnly(oStats.nTestedSamples += LBSPSampleMatcher::getTestedCount(nGoodMask,nBatchSize,this->m_nRequiredBGSamples-nGoodSamplesCount);)
+                nGoodSamplesCount += lv::popcount(nGoodMask);
+                if(this->m_bUseSampleReordering)
+                    oReorderer.addBatch(nModelIdx,nGoodMask);
             }
-            if(nGoodSamplesCount<m_nRequiredBGSamples)
+            oReorderer.promote(m_oBGSamples,nPxIter);
+            lvBGSStatsOnly(oStats.nMatchedSamples += std::min(nGoodSamplesCount,this->m_nRequiredBGSamples);)
+            if(nGoodSamplesCount<this->m_nRequiredBGSamples)
                 oCurrFGMask.data[nPxIter] = UCHAR_MAX;
             else {
-                if((rand()%nLearningRate)==0) {
-                    const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort& nRandInputDesc = *((ushort*)(m_voBGDescSamples[nSampleModelIdx].data+nDescIter));
-                    nRandInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
-                    m_voBGColorSamples[nSampleModelIdx].data[nPxIter] = nCurrColor;
+                if((lRand()%nPxLearningRate)==0) {
+                    const size_t nSampleModelIdx = lRand()%this->m_nBGSamples;
+                    ushort& nRandInputDesc = *m_oBGSamples.desc(nSampleModelIdx,nPxIter);
+                    nRandInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,this->m_anLBSPThreshold_8bitLUT[nCurrColor]);
+                    *m_oBGSamples.color(nSampleModelIdx,nPxIter) = nCurrColor;
                 }
-                if((rand()%nLearningRate)==0) {
+                if((lRand()%nPxLearningRate)==0) {
                     int nSampleImgCoord_Y, nSampleImgCoord_X;
-                    lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                    const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort& nRandInputDesc = m_voBGDescSamples[nSampleModelIdx].at<ushort>(nSampleImgCoord_Y,nSampleImgCoord_X);
-                    nRandInputDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
-                    m_voBGColorSamples[nSampleModelIdx].at<uchar>(nSampleImgCoord_Y,nSampleImgCoord_X) = nCurrColor;
+                    lv::getNeighborPosition_3x3(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                    const size_t nSampleModelIdx = lRand()%this->m_nBGSamples;
+                    const size_t nSamplePxIdx = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                    const ushort nCurrDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,this->m_anLBSPThreshold_8bitLUT[nCurrColor]);
+                    if(pvDeferredUpdates && !oTileRect.contains(cv::Point(nSampleImgCoord_X,nSampleImgCoord_Y)))
+                        pvDeferredUpdates->push_back({nSamplePxIdx,nSampleModelIdx,{{nCurrColor,0,0}},{{nCurrDesc,0,0}}});
+                    else {
+                        *m_oBGSamples.desc(nSampleModelIdx,nSamplePxIdx) = nCurrDesc;
+                        *m_oBGSamples.color(nSampleModelIdx,nSamplePxIdx) = nCurrColor;
+                    }
                 }
             }
         }
     }
     else { //m_nImgChannels==3
-        const size_t nCurrDescDistThreshold = m_nDescDistThreshold*3;
-        const size_t nCurrColorDistThreshold = m_nColorDistThreshold*3;
+        const size_t nCurrDescDistThreshold = this->m_nDescDistThreshold*3;
+        const size_t nCurrColorDistThreshold = this->m_nColorDistThreshold*3;
         const size_t nCurrSCDescDistThreshold = nCurrDescDistThreshold/2;
         const size_t nCurrSCColorDistThreshold = nCurrColorDistThreshold/2;
-        const size_t desc_row_step = m_voBGDescSamples[0].step.p[0];
-        const size_t img_row_step = m_voBGColorSamples[0].step.p[0];
-        for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-            const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-            const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
+        // without sum distances, the total 'sum' distance threshold applies to the total color distance
+        const LBSPSampleMatcher::Thresholds oMatchThresholds = {nCurrSCColorDistThreshold,nCurrSCDescDistThreshold,SIZE_MAX,nCurrDescDistThreshold,nCurrColorDistThreshold,false,0};
+        for(const size_t nModelIter : oModelIters) {
+            const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
+            if(!this->isPxActive(nPxIter)) {
+                lvBGSStatsOnly(++oStats.nGatedPixels;)
+                continue; // quiet block; stays background, and its model updates are deferred until the block gets refreshed
+            }
+            // a refreshed block catches up on the updates it skipped while gated by raising its update rate accordingly
+            const size_t nPxLearningRate = std::max(nLearningRate/this->getPxGatedFrameCount(nPxIter),size_t(1));
+            const int nCurrImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
+            const int nCurrImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const size_t nPxIterRGB = nPxIter*3;
-            const size_t nDescIterRGB = nPxIterRGB*2;
             const uchar* const anCurrColor = oInputImg.data+nPxIterRGB;
             alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,3> aanLBSPLookupVals;
             LBSP::computeDescriptor_lookup(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,aanLBSPLookupVals);
-            size_t nGoodSamplesCount=0, nModelIdx=0;
-            while(nGoodSamplesCount<m_nRequiredBGSamples && nModelIdx<m_nBGSamples) {
-                const ushort* const anBGDesc = (ushort*)(m_voBGDescSamples[nModelIdx].data+nDescIterRGB);
-                const uchar* const anBGColor = m_voBGColorSamples[nModelIdx].data+nPxIterRGB;
-                size_t nTotColorDist = 0;
-                size_t nTotDescDist = 0;
-                for(size_t c=0;c<3; ++c) {
-                    const size_t nColorDist = lv::L1dist(anCurrColor[c],anBGColor[c]);
-                    if(nColorDist>nCurrSCColorDistThreshold)
-                        goto failedcheck3ch;
-                    const ushort nCurrInputDesc = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anBGColor[c],m_anLBSPThreshold_8bitLUT[anBGColor[c]]);
-                    const size_t nDescDist = lv::hdist(nCurrInputDesc,anBGDesc[c]);
-                    if(nDescDist>nCurrSCDescDistThreshold)
-                        goto failedcheck3ch;
-                    nTotColorDist += nColorDist;
-                    nTotDescDist += nDescDist;
-                }
-                if(nTotDescDist<=nCurrDescDistThreshold && nTotColorDist<=nCurrColorDistThreshold)
-                    nGoodSamplesCount++;
-                failedcheck3ch:
-                nModelIdx++;
+            size_t nGoodSamplesCount=0;
+            LBSPSampleMatcher::MatchReorderer oReorderer;
+            for(size_t nModelIdx=0; nGoodSamplesCount<this->m_nRequiredBGSamples && nModelIdx<this->m_nBGSamples; nModelIdx+=LBSPSampleMatcher::getBatchSize(nModelIdx,this->m_nBGSamples)) {
+                const size_t nBatchSize = LBSPSampleMatcher::getBatchSize(nModelIdx,this->m_nBGSamples);
+                const uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<3>(m_oBGSamples,nPxIter,nModelIdx,nBatchSize,anCurrColor,nullptr,aanLBSPLookupVals[0].data(),this->m_anLBSPThreshold_8bitLUT.data(),oMatchThresholds,nullptr,nullptr);
+                lvBGSStatsOnly(oStats.nTestedSamples += LBSPSampleMatcher::getTestedCount(nGoodMask,nBatchSize,this->m_nRequiredBGSamples-nGoodSamplesCount);)
+                nGoodSamplesCount += lv::popcount(nGoodMask);
+                if(this->m_bUseSampleReordering)
+                    oReorderer.addBatch(nModelIdx,nGoodMask);
             }
-            if(nGoodSamplesCount<m_nRequiredBGSamples)
+            oReorderer.promote(m_oBGSamples,nPxIter);
+            lvBGSStatsOnly(oStats.nMatchedSamples += std::min(nGoodSamplesCount,this->m_nRequiredBGSamples);)
+            if(nGoodSamplesCount<this->m_nRequiredBGSamples)
                 oCurrFGMask.data[nPxIter] = UCHAR_MAX;
             else {
-                if((rand()%nLearningRate)==0) {
-                    const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data+nDescIterRGB));
+                if((lRand()%nPxLearningRate)==0) {
+                    const size_t nSampleModelIdx = lRand()%this->m_nBGSamples;
+                    ushort* anRandInputDesc = m_oBGSamples.desc(nSampleModelIdx,nPxIter);
+                    uchar* anRandInputColor = m_oBGSamples.color(nSampleModelIdx,nPxIter);
                     for(size_t c=0; c<3; ++c) {
-                        *(m_voBGColorSamples[nSampleModelIdx].data+nPxIterRGB+c) = anCurrColor[c];
-                        anRandInputDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
+                        anRandInputColor[c] = anCurrColor[c];
+                        anRandInputDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],this->m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
                     }
                 }
-                if((rand()%nLearningRate)==0) {
+                if((lRand()%nPxLearningRate)==0) {
                     int nSampleImgCoord_Y, nSampleImgCoord_X;
-                    lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                    const size_t nSampleModelIdx = rand()%m_nBGSamples;
-                    ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + desc_row_step*nSampleImgCoord_Y + 6*nSampleImgCoord_X));
+                    lv::getNeighborPosition_3x3(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                    const size_t nSampleModelIdx = lRand()%this->m_nBGSamples;
+                    const size_t nSamplePxIdx = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                    DeferredNeighborUpdate oUpdate = {nSamplePxIdx,nSampleModelIdx,{},{}};
                     for(size_t c=0; c<3; ++c) {
-                        *(m_voBGColorSamples[nSampleModelIdx].data+img_row_step*nSampleImgCoord_Y+3*nSampleImgCoord_X+c) = anCurrColor[c];
-                        anRandInputDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
+                        oUpdate.anColor[c] = anCurrColor[c];
+                        oUpdate.anDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],this->m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
+                    }
+                    if(pvDeferredUpdates && !oTileRect.contains(cv::Point(nSampleImgCoord_X,nSampleImgCoord_Y)))
+                        pvDeferredUpdates->push_back(oUpdate);
+                    else {
+                        ushort* anRandInputDesc = m_oBGSamples.desc(nSampleModelIdx,nSamplePxIdx);
+                        uchar* anRandInputColor = m_oBGSamples.color(nSampleModelIdx,nSamplePxIdx);
+                        std::copy_n(oUpdate.anColor.begin(),3,anRandInputColor);
+                        std::copy_n(oUpdate.anDesc.begin(),3,anRandInputDesc);
                     }
                 }
             }
         }
     }
-    cv::medianBlur(oCurrFGMask,m_oLastFGMask,m_nDefaultMedianBlurKernelSize);
-    m_oLastFGMask.copyTo(oCurrFGMask);
-    oInputImg.copyTo(m_oLastColorFrame);
+    lvBGSStatsOnly(oStats.nPixels += oModelIters.size()-(oStats.nGatedPixels-nPrevGatedPixels);)
 }
 
-void BackgroundSubtractorLOBSTER::getBackgroundImage(cv::OutputArray oBGImg) const {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::getBackgroundImage(cv::OutputArray oBGImg) const {
     lvDbgExceptionWatch;
-    lvAssert_(m_bInitialized,"algo must be initialized first");
-    cv::Mat oAvgBGImg = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_nimg = m_voBGColorSamples[s].step.p[0]*y + m_voBGColorSamples[s].step.p[1]*x;
-                const size_t idx_flt32 = idx_nimg*4;
-                float* oAvgBgImgPtr = (float*)(oAvgBGImg.data+idx_flt32);
-                const uchar* const oBGImgPtr = m_voBGColorSamples[s].data+idx_nimg;
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/m_nBGSamples;
-            }
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
+    cv::Mat oAvgBGImg = cv::Mat::zeros(this->m_oImgSize,CV_32FC((int)this->m_nImgChannels));
+    // pixels are walked on the outside so that the pixel-major store is read sequentially (one block per pixel)
+    for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgImgPtr = ((float*)oAvgBGImg.data)+nPxIter*this->m_nImgChannels;
+        for(size_t s=0; s<this->m_nBGSamples; ++s) {
+            const uchar* const oBGImgPtr = m_oBGSamples.color(s,nPxIter);
+            for(size_t c=0; c<this->m_nImgChannels; ++c)
+                oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/this->m_nBGSamples;
         }
     }
     oAvgBGImg.convertTo(oBGImg,CV_8U);
 }
 
-void BackgroundSubtractorLOBSTER::getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorLOBSTER_<eImpl>::getBackgroundDescriptorsImage(cv::OutputArray oBGDescImg) const {
     static_assert(LBSP::DESC_SIZE==2,"bad assumptions in impl below");
     lvDbgExceptionWatch;
-    lvAssert_(m_bInitialized,"algo must be initialized first");
-    cv::Mat oAvgBGDesc = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t n=0; n<m_voBGDescSamples.size(); ++n) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_ndesc = m_voBGDescSamples[n].step.p[0]*y + m_voBGDescSamples[n].step.p[1]*x;
-                const size_t idx_flt32 = idx_ndesc*2;
-                float* oAvgBgDescPtr = (float*)(oAvgBGDesc.data+idx_flt32);
-                const ushort* const oBGDescPtr = (ushort*)(m_voBGDescSamples[n].data+idx_ndesc);
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_voBGDescSamples.size();
-            }
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
+    cv::Mat oAvgBGDesc = cv::Mat::zeros(this->m_oImgSize,CV_32FC((int)this->m_nImgChannels));
+    for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgDescPtr = ((float*)oAvgBGDesc.data)+nPxIter*this->m_nImgChannels;
+        for(size_t n=0; n<m_oBGSamples.samples(); ++n) {
+            const ushort* const oBGDescPtr = m_oBGSamples.desc(n,nPxIter);
+            for(size_t c=0; c<this->m_nImgChannels; ++c)
+                oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_oBGSamples.samples();
         }
     }
     oAvgBGDesc.convertTo(oBGDescImg,CV_16U);
 }
 
+
+template<>
+void BackgroundSubtractorLOBSTER::apply_all(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate) {
+    ModelLUTSpans oModelIters;
+    oModelIters.add(0,m_nTotRelevantPxCount);
+    apply_range(oInputImg,oCurrFGMask,oModelIters,cv::Rect(cv::Point(),m_oImgSize),[](){return rand();},nLearningRate,nullptr,m_oStats);
+}
+
+template<>
+void BackgroundSubtractorLOBSTER_CPUThreads::apply_all(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate) {
+    m_vvDeferredUpdates.resize(m_voTiles.size());
+    m_voTileStats.resize(m_voTiles.size());
+    processTiles([&](size_t nTileIdx) {
+        const TileInfo& oTile = m_voTiles[nTileIdx];
+        std::vector<DeferredNeighborUpdate>& vDeferredUpdates = m_vvDeferredUpdates[nTileIdx];
+        vDeferredUpdates.clear();
+        lvBGSStatsOnly(m_voTileStats[nTileIdx].reset();)
+        // each tile gets its own stream (derived from the base seed, frame index & tile index) so that results do not depend on thread scheduling
+        int nTileSeed = getTileSeed(nTileIdx);
+        const auto lTileRand = [&nTileSeed]() {
+            // fastrand only provides 15 bits per call; two draws are combined to avoid biasing large modulos
+            const int nHighBits = lv::fastrand(nTileSeed);
+            return (nHighBits<<15)|lv::fastrand(nTileSeed);
+        };
+        apply_range(oInputImg,oCurrFGMask,oTile.oModelIters,oTile.oRect,lTileRand,nLearningRate,&vDeferredUpdates,m_voTileStats[nTileIdx]);
+    });
+    lvBGSStatsOnly(for(const BackgroundSubtractorStats& oTileStats : m_voTileStats) m_oStats += oTileStats;)
+    const size_t nChannels = m_nImgChannels==1?1:3;
+    for(const std::vector<DeferredNeighborUpdate>& vDeferredUpdates : m_vvDeferredUpdates) {
+        for(const DeferredNeighborUpdate& oUpdate : vDeferredUpdates) {
+            std::copy_n(oUpdate.anColor.begin(),nChannels,m_oBGSamples.color(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+            std::copy_n(oUpdate.anDesc.begin(),nChannels,m_oBGSamples.desc(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+        }
+    }
+}
+
+template<>
+void BackgroundSubtractorLOBSTER::apply_batch_all(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, size_t nLearningRate) {
+    // the serial loop shares the global PRNG across the whole frame, so it has no tiles to block over; frames are processed in order instead
+    for(size_t nImageIdx=0; nImageIdx<voImages.size(); ++nImageIdx) {
+        ++m_nFrameIdx;
+        apply_all(voImages[nImageIdx],voFGMasks[nImageIdx],nLearningRate);
+    }
+}
+
+template<>
+void BackgroundSubtractorLOBSTER_CPUThreads::apply_batch_all(const std::vector<cv::Mat>& voImages, std::vector<cv::Mat>& voFGMasks, size_t nLearningRate) {
+    const size_t nImages = voImages.size(), nTiles = m_voTiles.size(), nFirstFrameIdx = m_nFrameIdx+1;
+    const size_t nChannels = m_nImgChannels==1?1:3;
+    m_vvDeferredUpdates.resize(nImages*nTiles);
+    m_voTileStats.resize(nTiles);
+    // tiles whose pixels can receive each other's neighbor updates (i.e. whose rects touch, diagonals included), in index order
+    std::vector<std::vector<size_t>> vvnTileNeighbors(nTiles);
+    size_t nWavefrontStride = 1;
+    for(size_t nTileIdx=0; nTileIdx<nTiles; ++nTileIdx) {
+        const cv::Rect& oRect = m_voTiles[nTileIdx].oRect;
+        const cv::Rect oGrownRect(oRect.x-1,oRect.y-1,oRect.width+2,oRect.height+2);
+        for(size_t nOtherTileIdx=0; nOtherTileIdx<nTiles; ++nOtherTileIdx) {
+            if(nOtherTileIdx!=nTileIdx && (oGrownRect&m_voTiles[nOtherTileIdx].oRect).area()>0) {
+                vvnTileNeighbors[nTileIdx].push_back(nOtherTileIdx);
+                if(nOtherTileIdx>nTileIdx) // a neighbor's previous frame must always come first on the wavefront
+                    nWavefrontStride = std::max(nWavefrontStride,nOtherTileIdx-nTileIdx+1);
+            }
+        }
+    }
+    // a tile may run frame 'f' as soon as all its neighbors are done with frame 'f-1' (it then commits the updates they deferred into it
+    // for that frame, in tile order, exactly as 'apply_all' would have before matching frame 'f'); ready tiles are picked along a
+    // wavefront (tile idx + stride * frame idx) so that each tile's model is reused for its next frame while it is still in cache
+    std::mutex oSchedMutex;
+    std::condition_variable oSchedCondVar;
+    std::vector<size_t> vnTileDoneFrames(nTiles,0);
+    std::vector<bool> vbTileBusy(nTiles,false);
+    size_t nRemainingTasks = nImages*nTiles;
+    bool bAborted = false;
+    const auto lGetNextTile = [&]() {
+        size_t nBestTileIdx = SIZE_MAX, nBestKey = SIZE_MAX;
+        for(size_t nTileIdx=0; nTileIdx<nTiles; ++nTileIdx) {
+            const size_t nFrameIdx = vnTileDoneFrames[nTileIdx];
+            if(vbTileBusy[nTileIdx] || nFrameIdx>=nImages || nTileIdx+nWavefrontStride*nFrameIdx>=nBestKey)
+                continue;
+            if(std::all_of(vvnTileNeighbors[nTileIdx].begin(),vvnTileNeighbors[nTileIdx].end(),[&](size_t nNeighborIdx){return vnTileDoneFrames[nNeighborIdx]>=nFrameIdx;})) {
+                nBestTileIdx = nTileIdx;
+                nBestKey = nTileIdx+nWavefrontStride*nFrameIdx;
+            }
+        }
+        return nBestTileIdx;
+    };
+    const auto lRunTileFrame = [&](size_t nTileIdx, size_t nImageIdx) {
+        const TileInfo& oTile = m_voTiles[nTileIdx];
+        if(nImageIdx>0) {
+            for(const size_t nNeighborIdx : vvnTileNeighbors[nTileIdx]) {
+                for(const DeferredNeighborUpdate& oUpdate : m_vvDeferredUpdates[(nImageIdx-1)*nTiles+nNeighborIdx]) {
+                    if(oTile.oRect.contains(cv::Point(int(oUpdate.nDstPxIdx%m_oImgSize.width),int(oUpdate.nDstPxIdx/m_oImgSize.width)))) {
+                        std::copy_n(oUpdate.anColor.begin(),nChannels,m_oBGSamples.color(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+                        std::copy_n(oUpdate.anDesc.begin(),nChannels,m_oBGSamples.desc(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+                    }
+                }
+            }
+        }
+        std::vector<DeferredNeighborUpdate>& vDeferredUpdates = m_vvDeferredUpdates[nImageIdx*nTiles+nTileIdx];
+        vDeferredUpdates.clear();
+        int nTileSeed = getTileSeed(nTileIdx,nFirstFrameIdx+nImageIdx);
+        const auto lTileRand = [&nTileSeed]() {
+            const int nHighBits = lv::fastrand(nTileSeed);
+            return (nHighBits<<15)|lv::fastrand(nTileSeed);
+        };
+        apply_range(voImages[nImageIdx],voFGMasks[nImageIdx],oTile.oModelIters,oTile.oRect,lTileRand,nLearningRate,&vDeferredUpdates,m_voTileStats[nTileIdx]);
+    };
+    lvBGSStatsOnly(for(BackgroundSubtractorStats& oTileStats : m_voTileStats) oTileStats.reset();)
+    parallelFor(std::min(getThreadCount(),nTiles),[&](size_t /*nWorkerIdx*/) {
+        std::unique_lock<std::mutex> oLock(oSchedMutex);
+        while(nRemainingTasks>0 && !bAborted) {
+            // a worker only waits while another one holds a task, so progress is guaranteed whatever the worker count
+            const size_t nTileIdx = lGetNextTile();
+            if(nTileIdx==SIZE_MAX) {
+                oSchedCondVar.wait(oLock);
+                continue;
+            }
+            const size_t nImageIdx = vnTileDoneFrames[nTileIdx];
+            vbTileBusy[nTileIdx] = true;
+            oLock.unlock();
+            try {
+                lRunTileFrame(nTileIdx,nImageIdx);
+            }
+            catch(...) {
+                oLock.lock();
+                bAborted = true;
+                oSchedCondVar.notify_all();
+                throw;
+            }
+            oLock.lock();
+            vbTileBusy[nTileIdx] = false;
+            ++vnTileDoneFrames[nTileIdx];
+            --nRemainingTasks;
+            oSchedCondVar.notify_all();
+        }
+    });
+    lvBGSStatsOnly(for(const BackgroundSubtractorStats& oTileStats : m_voTileStats) m_oStats += oTileStats;)
+    m_nFrameIdx += nImages;
+    // updates deferred during the last frame have no later frame to consume them, and are committed as in 'apply_all'
+    for(size_t nTileIdx=0; nTileIdx<nTiles; ++nTileIdx) {
+        for(const DeferredNeighborUpdate& oUpdate : m_vvDeferredUpdates[(nImages-1)*nTiles+nTileIdx]) {
+            std::copy_n(oUpdate.anColor.begin(),nChannels,m_oBGSamples.color(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+            std::copy_n(oUpdate.anDesc.begin(),nChannels,m_oBGSamples.desc(oUpdate.nSampleIdx,oUpdate.nDstPxIdx));
+        }
+    }
+}
+
+template struct BackgroundSubtractorLOBSTER_<lv::CPUThreads>;
 template struct BackgroundSubtractorLOBSTER_<lv::NonParallel>;
@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorPAWCS.hpp"
+#include "litiv/imgproc.hpp"
 
 //
 // NOTE: this version of PAWCS is still pretty messy (debug). The cleaner (but older) implementation made available on
@@ -82,6 +83,22 @@ static const size_t s_nColorMaxDataRange_1ch = UCHAR_MAX;
 static const size_t s_nDescMaxDataRange_1ch = LBSP::DESC_SIZE_BITS;
 static const size_t s_nColorMaxDataRange_3ch = s_nColorMaxDataRange_1ch*3;
 static const size_t s_nDescMaxDataRange_3ch = s_nDescMaxDataRange_1ch*3;
+// model snapshot version; must be bumped whenever the list or layout of snapshot blocks changes
+static const uint32_t s_nModelSnapshotVersion = 2;
+// word index used in snapshot dictionaries to represent null word pointers
+static const uint32_t s_nSnapshotNullWordIdx = UINT32_MAX;
+
+namespace {
+
+    /// trivially copyable global word record used in model snapshots (occurrence maps are stored separately)
+    template<typename TFeature>
+    struct GlobalWordRecord {
+        TFeature oFeature;
+        float fLatestWeight;
+        uchar nDescBITS;
+    };
+
+} // anonymous namespace
 
 BackgroundSubtractorPAWCS::BackgroundSubtractorPAWCS_(size_t nDescDistThresholdOffset, size_t nMinColorDistThreshold,
                                                       size_t nMaxNbWords, size_t nSamplesForMovingAvgs, float fRelLBSPThreshold) :
@@ -97,8 +114,7 @@ BackgroundSubtractorPAWCS::BackgroundSubtractorPAWCS_(size_t nDescDistThresholdO
         m_nMedianBlurKernelSize(m_nDefaultMedianBlurKernelSize),
         m_nDownSampledROIPxCount(0),
         m_nLocalWordWeightOffset(DEFAULT_LWORD_WEIGHT_OFFSET),
-        m_pLocalWordListIter_1ch(m_voLocalWordList_1ch.end()),
-        m_pLocalWordListIter_3ch(m_voLocalWordList_3ch.end()),
+        m_bUseColorPrefilter(true),
         m_pGlobalWordListIter_1ch(m_voGlobalWordList_1ch.end()),
         m_pGlobalWordListIter_3ch(m_voGlobalWordList_3ch.end()) {
     lvAssert_(m_nMaxLocalWords>0 && m_nMaxGlobalWords>0,"max local/global word counts must be positive");
@@ -113,6 +129,8 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
             const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
             if(bForceFGUpdate || !m_oLastFGMask_dilated.data[nPxIter]) {
                 const size_t nLocalDictIdx = nModelIter*m_nCurrLocalWords;
+                // words are kept sorted by weight in the pixel's own block; before the model is initialized, only the first few are filled
+                size_t nInitdLocalWords = m_bModelInitialized?m_nCurrLocalWords:0;
                 const size_t nFloatIter = nPxIter*4;
                 uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
                 const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data+nFloatIter);
@@ -120,10 +138,9 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                 const size_t nCurrDescDistThreshold = ((size_t)1<<((size_t)floor(fCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET);
                 // == refresh: local decr
                 if(fOccDecrFrac>0.0f) {
-                    for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                        LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
-                        if(pCurrLocalWord)
-                            pCurrLocalWord->nOccurrences -= (size_t)(fOccDecrFrac*pCurrLocalWord->nOccurrences);
+                    for(size_t nLocalWordIdx=0; nLocalWordIdx<nInitdLocalWords; ++nLocalWordIdx) {
+                        LocalWord_1ch& oCurrLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
+                        oCurrLocalWord.nOccurrences -= (size_t)(fOccDecrFrac*oCurrLocalWord.nOccurrences);
                     }
                 }
                 const size_t nCurrWordOccIncr = DEFAULT_LWORD_OCC_INCR;
@@ -137,55 +154,47 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                         const uchar nSampleColor = m_oLastColorFrame.data[nSamplePxIdx];
                         const size_t nSampleDescIdx = nSamplePxIdx*2;
                         const ushort nSampleIntraDesc = *((ushort*)(m_oLastDescFrame.data+nSampleDescIdx));
-                        bool bFoundUninitd = false;
                         size_t nLocalWordIdx;
-                        for(nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                            LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
-                            if(pCurrLocalWord
-                               && lv::L1dist(nSampleColor,pCurrLocalWord->oFeature.anColor[0])<=nCurrColorDistThreshold
+                        for(nLocalWordIdx=0; nLocalWordIdx<nInitdLocalWords; ++nLocalWordIdx) {
+                            LocalWord_1ch* pCurrLocalWord = &m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
+                            if(lv::L1dist(nSampleColor,pCurrLocalWord->oFeature.anColor[0])<=nCurrColorDistThreshold
                                && lv::hdist(nSampleIntraDesc,pCurrLocalWord->oFeature.anDesc[0])<=nCurrDescDistThreshold) {
                                 pCurrLocalWord->nOccurrences += nCurrWordOccIncr;
                                 pCurrLocalWord->nLastOcc = m_nFrameIdx;
                                 break;
                             }
-                            else if(!pCurrLocalWord)
-                                bFoundUninitd = true;
                         }
-                        if(nLocalWordIdx==m_nCurrLocalWords) {
-                            nLocalWordIdx = m_nCurrLocalWords-1;
-                            LocalWord_1ch& oCurrLocalWord = bFoundUninitd?*m_pLocalWordListIter_1ch++:*(LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                        if(nLocalWordIdx==nInitdLocalWords) {
+                            // new words fill the first uninitialized slot, or replace the lightest word once all slots are used
+                            nLocalWordIdx = (nInitdLocalWords<m_nCurrLocalWords)?nInitdLocalWords++:m_nCurrLocalWords-1;
+                            LocalWord_1ch& oCurrLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
                             oCurrLocalWord.oFeature.anColor[0] = nSampleColor;
                             oCurrLocalWord.oFeature.anDesc[0] = nSampleIntraDesc;
                             oCurrLocalWord.nOccurrences = nBaseOccCount;
                             oCurrLocalWord.nFirstOcc = m_nFrameIdx;
                             oCurrLocalWord.nLastOcc = m_nFrameIdx;
-                            m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx] = &oCurrLocalWord;
                         }
-                        while(nLocalWordIdx>0 && (!m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1] || GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset)>GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1],m_nFrameIdx,m_nLocalWordWeightOffset))) {
-                            std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                        while(nLocalWordIdx>0 && GetLocalWordWeight(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset)>GetLocalWordWeight(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx-1],m_nFrameIdx,m_nLocalWordWeightOffset)) {
+                            std::swap(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx-1]);
                             --nLocalWordIdx;
                         }
                     }
                 }
-                lvDbgAssert(m_vpLocalWordDict[nLocalDictIdx]);
-                for(size_t nLocalWordIdx=1; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
+                lvDbgAssert(nInitdLocalWords>0);
+                for(size_t nLocalWordIdx=std::max(nInitdLocalWords,(size_t)1); nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
                     // == refresh: local random resampling
-                    if(!(LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx]) {
-                        const size_t nRandLocalWordIdx = (rand()%nLocalWordIdx);
-                        const LocalWord_1ch& oRefLocalWord = *(LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx+nRandLocalWordIdx];
-                        const int nRandColorOffset = (rand()%(nCurrColorDistThreshold+1))-(int)nCurrColorDistThreshold/2;
-                        LocalWord_1ch& oCurrNewLocalWord = *m_pLocalWordListIter_1ch++;
-                        oCurrNewLocalWord.oFeature.anColor[0] = cv::saturate_cast<uchar>((int)oRefLocalWord.oFeature.anColor[0]+nRandColorOffset);
-                        oCurrNewLocalWord.oFeature.anDesc[0] = oRefLocalWord.oFeature.anDesc[0];
-                        oCurrNewLocalWord.nOccurrences = std::max((size_t)(oRefLocalWord.nOccurrences*((float)(m_nCurrLocalWords-nLocalWordIdx)/m_nCurrLocalWords)),(size_t)1);
-                        oCurrNewLocalWord.nFirstOcc = m_nFrameIdx;
-                        oCurrNewLocalWord.nLastOcc = m_nFrameIdx;
-                        m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx] = &oCurrNewLocalWord;
-                    }
+                    const size_t nRandLocalWordIdx = (rand()%nLocalWordIdx);
+                    const LocalWord_1ch& oRefLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nRandLocalWordIdx];
+                    const int nRandColorOffset = (rand()%(nCurrColorDistThreshold+1))-(int)nCurrColorDistThreshold/2;
+                    LocalWord_1ch& oCurrNewLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
+                    oCurrNewLocalWord.oFeature.anColor[0] = cv::saturate_cast<uchar>((int)oRefLocalWord.oFeature.anColor[0]+nRandColorOffset);
+                    oCurrNewLocalWord.oFeature.anDesc[0] = oRefLocalWord.oFeature.anDesc[0];
+                    oCurrNewLocalWord.nOccurrences = std::max((size_t)(oRefLocalWord.nOccurrences*((float)(m_nCurrLocalWords-nLocalWordIdx)/m_nCurrLocalWords)),(size_t)1);
+                    oCurrNewLocalWord.nFirstOcc = m_nFrameIdx;
+                    oCurrNewLocalWord.nLastOcc = m_nFrameIdx;
                 }
             }
         }
-        lvDbgAssert(m_voLocalWordList_1ch.end()==m_pLocalWordListIter_1ch);
         cv::Mat oGlobalDictPresenceLookupMap(m_oImgSize,CV_8UC1,cv::Scalar_<uchar>(0));
         size_t nPxIterIncr = std::max(m_nTotPxCount/m_nCurrGlobalWords,(size_t)1);
         for(size_t nSamplingPasses=0; nSamplingPasses<GWORD_DEFAULT_NB_INIT_SAMPL_PASSES; ++nSamplingPasses) {
@@ -201,8 +210,7 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                         const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data+nFloatIter);
                         const size_t nCurrColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold)/2;
                         const size_t nCurrDescDistThreshold = ((size_t)1<<((size_t)floor(fCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET);
-                        lvDbgAssert(m_vpLocalWordDict[nLocalDictIdx]);
-                        const LocalWord_1ch& oRefBestLocalWord = *(LocalWord_1ch*)m_vpLocalWordDict[nLocalDictIdx];
+                        const LocalWord_1ch& oRefBestLocalWord = m_voLocalWordList_1ch[nLocalDictIdx];
                         const float fRefBestLocalWordWeight = GetLocalWordWeight(oRefBestLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                         const uchar nRefBestLocalWordDescBITS = lv::popcount(oRefBestLocalWord.oFeature.anDesc[0]);
                         bool bFoundUninitd = false;
@@ -261,6 +269,8 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
             const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
             if(bForceFGUpdate || !m_oLastFGMask_dilated.data[nPxIter]) {
                 const size_t nLocalDictIdx = nModelIter*m_nCurrLocalWords;
+                // words are kept sorted by weight in the pixel's own block; before the model is initialized, only the first few are filled
+                size_t nInitdLocalWords = m_bModelInitialized?m_nCurrLocalWords:0;
                 const size_t nFloatIter = nPxIter*4;
                 uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
                 const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data+nFloatIter);
@@ -268,10 +278,9 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                 const size_t nCurrTotDescDistThreshold = (((size_t)1<<((size_t)floor(fCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET))*3;
                 // == refresh: local decr
                 if(fOccDecrFrac>0.0f) {
-                    for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                        LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
-                        if(pCurrLocalWord)
-                            pCurrLocalWord->nOccurrences -= (size_t)(fOccDecrFrac*pCurrLocalWord->nOccurrences);
+                    for(size_t nLocalWordIdx=0; nLocalWordIdx<nInitdLocalWords; ++nLocalWordIdx) {
+                        LocalWord_3ch& oCurrLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
+                        oCurrLocalWord.nOccurrences -= (size_t)(fOccDecrFrac*oCurrLocalWord.nOccurrences);
                     }
                 }
                 const size_t nCurrWordOccIncr = DEFAULT_LWORD_OCC_INCR;
@@ -286,23 +295,20 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                         const size_t nSampleDescRGBIdx = nSamplePxRGBIdx*2;
                         const uchar* const anSampleColor = m_oLastColorFrame.data+nSamplePxRGBIdx;
                         const ushort* const anSampleIntraDesc = ((ushort*)(m_oLastDescFrame.data+nSampleDescRGBIdx));
-                        bool bFoundUninitd = false;
                         size_t nLocalWordIdx;
-                        for(nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                            LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
-                            if(pCurrLocalWord
-                               && lv::cmixdist(anSampleColor,pCurrLocalWord->oFeature.anColor)<=nCurrTotColorDistThreshold
+                        for(nLocalWordIdx=0; nLocalWordIdx<nInitdLocalWords; ++nLocalWordIdx) {
+                            LocalWord_3ch* pCurrLocalWord = &m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
+                            if(lv::cmixdist(anSampleColor,pCurrLocalWord->oFeature.anColor)<=nCurrTotColorDistThreshold
                                && lv::hdist(anSampleIntraDesc,pCurrLocalWord->oFeature.anDesc)<=nCurrTotDescDistThreshold) {
                                 pCurrLocalWord->nOccurrences += nCurrWordOccIncr;
                                 pCurrLocalWord->nLastOcc = m_nFrameIdx;
                                 break;
                             }
-                            else if(!pCurrLocalWord)
-                                bFoundUninitd = true;
                         }
-                        if(nLocalWordIdx==m_nCurrLocalWords) {
-                            nLocalWordIdx = m_nCurrLocalWords-1;
-                            LocalWord_3ch& oCurrLocalWord = bFoundUninitd?*m_pLocalWordListIter_3ch++:*(LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                        if(nLocalWordIdx==nInitdLocalWords) {
+                            // new words fill the first uninitialized slot, or replace the lightest word once all slots are used
+                            nLocalWordIdx = (nInitdLocalWords<m_nCurrLocalWords)?nInitdLocalWords++:m_nCurrLocalWords-1;
+                            LocalWord_3ch& oCurrLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
                             for(size_t c=0; c<3; ++c) {
                                 oCurrLocalWord.oFeature.anColor[c] = anSampleColor[c];
                                 oCurrLocalWord.oFeature.anDesc[c] = anSampleIntraDesc[c];
@@ -310,35 +316,30 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                             oCurrLocalWord.nOccurrences = nBaseOccCount;
                             oCurrLocalWord.nFirstOcc = m_nFrameIdx;
                             oCurrLocalWord.nLastOcc = m_nFrameIdx;
-                            m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx] = &oCurrLocalWord;
                         }
-                        while(nLocalWordIdx>0 && (!m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1] || GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset)>GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1],m_nFrameIdx,m_nLocalWordWeightOffset))) {
-                            std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                        while(nLocalWordIdx>0 && GetLocalWordWeight(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset)>GetLocalWordWeight(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx-1],m_nFrameIdx,m_nLocalWordWeightOffset)) {
+                            std::swap(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx-1]);
                             --nLocalWordIdx;
                         }
                     }
                 }
-                lvDbgAssert(m_vpLocalWordDict[nLocalDictIdx]);
-                for(size_t nLocalWordIdx=1; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
+                lvDbgAssert(nInitdLocalWords>0);
+                for(size_t nLocalWordIdx=std::max(nInitdLocalWords,(size_t)1); nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
                     // == refresh: local random resampling
-                    if(!(LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx]) {
-                        const size_t nRandLocalWordIdx = (rand()%nLocalWordIdx);
-                        const LocalWord_3ch& oRefLocalWord = *(LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nRandLocalWordIdx];
-                        const int nRandColorOffset = (rand()%(nCurrTotColorDistThreshold/3+1))-(int)(nCurrTotColorDistThreshold/6);
-                        LocalWord_3ch& oCurrNewLocalWord = *m_pLocalWordListIter_3ch++;
-                        for(size_t c=0; c<3; ++c) {
-                            oCurrNewLocalWord.oFeature.anColor[c] = cv::saturate_cast<uchar>((int)oRefLocalWord.oFeature.anColor[c]+nRandColorOffset);
-                            oCurrNewLocalWord.oFeature.anDesc[c] = oRefLocalWord.oFeature.anDesc[c];
-                        }
-                        oCurrNewLocalWord.nOccurrences = std::max((size_t)(oRefLocalWord.nOccurrences*((float)(m_nCurrLocalWords-nLocalWordIdx)/m_nCurrLocalWords)),(size_t)1);
-                        oCurrNewLocalWord.nFirstOcc = m_nFrameIdx;
-                        oCurrNewLocalWord.nLastOcc = m_nFrameIdx;
-                        m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx] = &oCurrNewLocalWord;
+                    const size_t nRandLocalWordIdx = (rand()%nLocalWordIdx);
+                    const LocalWord_3ch& oRefLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nRandLocalWordIdx];
+                    const int nRandColorOffset = (rand()%(nCurrTotColorDistThreshold/3+1))-(int)(nCurrTotColorDistThreshold/6);
+                    LocalWord_3ch& oCurrNewLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
+                    for(size_t c=0; c<3; ++c) {
+                        oCurrNewLocalWord.oFeature.anColor[c] = cv::saturate_cast<uchar>((int)oRefLocalWord.oFeature.anColor[c]+nRandColorOffset);
+                        oCurrNewLocalWord.oFeature.anDesc[c] = oRefLocalWord.oFeature.anDesc[c];
                     }
+                    oCurrNewLocalWord.nOccurrences = std::max((size_t)(oRefLocalWord.nOccurrences*((float)(m_nCurrLocalWords-nLocalWordIdx)/m_nCurrLocalWords)),(size_t)1);
+                    oCurrNewLocalWord.nFirstOcc = m_nFrameIdx;
+                    oCurrNewLocalWord.nLastOcc = m_nFrameIdx;
                 }
             }
         }
-        lvDbgAssert(m_voLocalWordList_3ch.end()==m_pLocalWordListIter_3ch);
         cv::Mat oGlobalDictPresenceLookupMap(m_oImgSize,CV_8UC1,cv::Scalar_<uchar>(0));
         size_t nPxIterIncr = std::max(m_nTotPxCount/m_nCurrGlobalWords,(size_t)1);
         for(size_t nSamplingPasses=0; nSamplingPasses<GWORD_DEFAULT_NB_INIT_SAMPL_PASSES; ++nSamplingPasses) {
@@ -354,8 +355,7 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
                         const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data+nFloatIter);
                         const size_t nCurrTotColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold)*3;
                         const size_t nCurrTotDescDistThreshold = (((size_t)1<<((size_t)floor(fCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET))*3;
-                        lvDbgAssert(m_vpLocalWordDict[nLocalDictIdx]);
-                        const LocalWord_3ch& oRefBestLocalWord = *(LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx];
+                        const LocalWord_3ch& oRefBestLocalWord = m_voLocalWordList_3ch[nLocalDictIdx];
                         const float fRefBestLocalWordWeight = GetLocalWordWeight(oRefBestLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                         const uchar nRefBestLocalWordDescBITS = lv::popcount(oRefBestLocalWord.oFeature.anDesc);
                         bool bFoundUninitd = false;
@@ -417,11 +417,11 @@ void BackgroundSubtractorPAWCS::refreshModel(size_t nBaseOccCount, float fOccDec
         // == refresh: per-px global word sort
         const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
         const size_t nGlobalWordMapLookupIdx = m_voPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx;
-        float fLastGlobalWordLocalWeight = *(float*)(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[0]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
+        float fLastGlobalWordLocalWeight = *(float*)(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
         for(size_t nGlobalWordLUTIdx=1; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-            const float fCurrGlobalWordLocalWeight = *(float*)(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
+            const float fCurrGlobalWordLocalWeight = *(float*)(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
             if(fCurrGlobalWordLocalWeight>fLastGlobalWordLocalWeight)
-                std::swap(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx],m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx-1]);
+                std::swap(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx],m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx-1]);
             else
                 fLastGlobalWordLocalWeight = fCurrGlobalWordLocalWeight;
         }
@@ -433,9 +433,7 @@ void BackgroundSubtractorPAWCS::initialize(const cv::Mat& oInitImg, const cv::Ma
     IBackgroundSubtractorLBSP::initialize_common(oInitImg,oROI);
     m_bModelInitialized = false;
     m_voLocalWordList_1ch.clear();
-    m_pLocalWordListIter_1ch = m_voLocalWordList_1ch.end();
     m_voLocalWordList_3ch.clear();
-    m_pLocalWordListIter_3ch = m_voLocalWordList_3ch.end();
     m_voGlobalWordList_1ch.clear();
     m_pGlobalWordListIter_1ch = m_voGlobalWordList_1ch.end();
     m_voGlobalWordList_3ch.clear();
@@ -513,11 +511,10 @@ void BackgroundSubtractorPAWCS::initialize(const cv::Mat& oInitImg, const cv::Ma
     m_oTempGlobalWordWeightDiffFactor = cv::Scalar(-0.1f);
     m_oMorphExStructElement = cv::getStructuringElement(cv::MORPH_RECT,cv::Size(3,3));
     m_voPxInfoLUT_PAWCS.resize(m_nTotPxCount);
-    m_vpLocalWordDict.resize(m_nTotRelevantPxCount*m_nCurrLocalWords,nullptr);
     m_vpGlobalWordDict.resize(m_nCurrGlobalWords,nullptr);
+    m_vpGlobalDictSortLUT.resize(m_nTotRelevantPxCount*m_nCurrGlobalWords,nullptr);
     if(m_nImgChannels==1) {
         m_voLocalWordList_1ch.resize(m_nTotRelevantPxCount*m_nCurrLocalWords);
-        m_pLocalWordListIter_1ch = m_voLocalWordList_1ch.begin();
         m_voGlobalWordList_1ch.resize(m_nCurrGlobalWords);
         m_pGlobalWordListIter_1ch = m_voGlobalWordList_1ch.begin();
         for(size_t nPxIter=0, nModelIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
@@ -526,16 +523,14 @@ void BackgroundSubtractorPAWCS::initialize(const cv::Mat& oInitImg, const cv::Ma
                 m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
                 m_voPxInfoLUT_PAWCS[nPxIter].nModelIdx = nModelIter;
                 m_voPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx = (size_t)((m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)*m_oDownSampledFrameSize_GlobalWordLookup.width+(m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_X/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO))*4;
-                m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT.resize(m_nCurrGlobalWords);
                 for(size_t nGlobalWordIdxIter=0; nGlobalWordIdxIter<m_nCurrGlobalWords; ++nGlobalWordIdxIter)
-                    m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordIdxIter] = &m_voGlobalWordList_1ch[nGlobalWordIdxIter];
+                    m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordIdxIter] = &m_voGlobalWordList_1ch[nGlobalWordIdxIter];
                 ++nModelIter;
             }
         }
     }
     else { //m_nImgChannels==3
         m_voLocalWordList_3ch.resize(m_nTotRelevantPxCount*m_nCurrLocalWords);
-        m_pLocalWordListIter_3ch = m_voLocalWordList_3ch.begin();
         m_voGlobalWordList_3ch.resize(m_nCurrGlobalWords);
         m_pGlobalWordListIter_3ch = m_voGlobalWordList_3ch.begin();
         for(size_t nPxIter=0, nModelIter=0; nPxIter<m_nTotPxCount; ++nPxIter) {
@@ -544,9 +539,8 @@ void BackgroundSubtractorPAWCS::initialize(const cv::Mat& oInitImg, const cv::Ma
                 m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
                 m_voPxInfoLUT_PAWCS[nPxIter].nModelIdx = nModelIter;
                 m_voPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx = (size_t)((m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)*m_oDownSampledFrameSize_GlobalWordLookup.width+(m_voPxInfoLUT_PAWCS[nPxIter].nImgCoord_X/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO))*4;
-                m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT.resize(m_nCurrGlobalWords);
                 for(size_t nGlobalWordIdxIter=0; nGlobalWordIdxIter<m_nCurrGlobalWords; ++nGlobalWordIdxIter)
-                    m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordIdxIter] = &m_voGlobalWordList_3ch[nGlobalWordIdxIter];
+                    m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordIdxIter] = &m_voGlobalWordList_3ch[nGlobalWordIdxIter];
                 ++nModelIter;
             }
         }
@@ -559,11 +553,12 @@ void BackgroundSubtractorPAWCS::initialize(const cv::Mat& oInitImg, const cv::Ma
 void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
     // == process
     lvAssert_(m_bInitialized && m_bModelInitialized,"algo & model must be initialized first");
-    cv::Mat oInputImg = _image.getMat();
+    lvAssert_(!m_bUsingActivityGating,"activity gating is not supported by PAWCS (its word models have no deferred update path)");
+    const cv::Mat oFullInputImg = _image.getMat();
+    const cv::Mat& oInputImg = getModelInput(oFullInputImg,m_oReducedResInputImg);
     lvAssert_(oInputImg.type()==m_nImgType && oInputImg.size()==m_oImgSize,"input image type/size mismatch with initialization type/size");
     lvAssert_(oInputImg.isContinuous(),"input image data must be continuous");
-    _fgmask.create(m_oImgSize,CV_8UC1);
-    cv::Mat oCurrFGMask = _fgmask.getMat();
+    cv::Mat oCurrFGMask = getModelOutput(_fgmask);
     memset(oCurrFGMask.data,0,oCurrFGMask.cols*oCurrFGMask.rows);
     const bool bBootstrapping = ++m_nFrameIdx<=DEFAULT_BOOTSTRAP_WIN_SIZE;
     const size_t nCurrSamplesForMovingAvg_LT = bBootstrapping?m_nSamplesForMovingAvgs/2:m_nSamplesForMovingAvgs;
@@ -636,7 +631,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
             float& fCurrMeanMinDist_LT = *(float*)(m_oMeanMinDistFrame_LT.data+nFloatIter);
             float& fCurrMeanMinDist_ST = *(float*)(m_oMeanMinDistFrame_ST.data+nFloatIter);
 #endif //USE_FEEDBACK_ADJUSTMENTS
-            const float fBestLocalWordWeight = GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
+            const float fBestLocalWordWeight = GetLocalWordWeight(m_voLocalWordList_1ch[nLocalDictIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
             const float fLocalWordsWeightSumThreshold = fBestLocalWordWeight/(fCurrDistThresholdFactor*2);
             uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
             uchar& nCurrRegionIllumUpdtVal = m_oIllumUpdtRegionMask.data[nPxIter];
@@ -670,10 +665,11 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
             fPrepTimeSum_MS += (float)(std::chrono::duration_cast<std::chrono::nanoseconds>(post_prep-pre_prep).count())/1000000;
 #endif //USE_INTERNAL_HRCS
             while(nLocalWordIdx<m_nCurrLocalWords && fPotentialLocalWordsWeightSum<fLocalWordsWeightSumThreshold) {
-                LocalWord_1ch& oCurrLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                LocalWord_1ch& oCurrLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
                 const float fCurrLocalWordWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
-                {
-                    const size_t nColorDist = lv::L1dist(nCurrColor,oCurrLocalWord.oFeature.anColor[0]);
+                const size_t nColorDist = lv::L1dist(nCurrColor,oCurrLocalWord.oFeature.anColor[0]);
+                // color prefilter: both tests below require a color match, so LBSP distances are only computed for words that pass it
+                if(!m_bUseColorPrefilter || nColorDist<=nCurrColorDistThreshold) {
                     const size_t nIntraDescDist = lv::hdist(nCurrIntraDesc,oCurrLocalWord.oFeature.anDesc[0]);
                     const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,oCurrLocalWord.oFeature.anColor[0],m_anLBSPThreshold_8bitLUT[oCurrLocalWord.oFeature.anColor[0]]);
                     const size_t nInterDescDist = lv::hdist(nCurrInterDesc,oCurrLocalWord.oFeature.anDesc[0]);
@@ -706,7 +702,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     }
                 }
                 if(fCurrLocalWordWeight>fLastLocalWordWeight) {
-                    std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                    std::swap(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx-1]);
 #if DISPLAY_PAWCS_DEBUG_INFO
                     std::swap(vsWordModList[nLocalDictIdx+nLocalWordIdx],vsWordModList[nLocalDictIdx+nLocalWordIdx-1]);
 #endif //DISPLAY_PAWCS_DEBUG_INFO
@@ -716,9 +712,9 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                 ++nLocalWordIdx;
             }
             while(nLocalWordIdx<m_nCurrLocalWords) {
-                const float fCurrLocalWordWeight = GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
+                const float fCurrLocalWordWeight = GetLocalWordWeight(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
                 if(fCurrLocalWordWeight>fLastLocalWordWeight) {
-                    std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                    std::swap(m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx-1]);
 #if DISPLAY_PAWCS_DEBUG_INFO
                     std::swap(vsWordModList[nLocalDictIdx+nLocalWordIdx],vsWordModList[nLocalDictIdx+nLocalWordIdx-1]);
 #endif //DISPLAY_PAWCS_DEBUG_INFO
@@ -744,7 +740,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nGlobalWordLUTIdx;
                     GlobalWord_1ch* pCurrGlobalWord = nullptr;
                     for(nGlobalWordLUTIdx=0; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                        pCurrGlobalWord = (GlobalWord_1ch*)m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx];
+                        pCurrGlobalWord = (GlobalWord_1ch*)m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx];
                         if(lv::L1dist(pCurrGlobalWord->oFeature.anColor[0],nCurrColor)<=nCurrColorDistThreshold &&
                            lv::L1dist(nCurrIntraDescBITS,pCurrGlobalWord->nDescBITS)<=nCurrDescDistThreshold/GWORD_DESC_THRES_BITS_MATCH_FACTOR)
                             break;
@@ -779,7 +775,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nGlobalWordLUTIdx;
                     GlobalWord_1ch* pCurrGlobalWord = nullptr;
                     for(nGlobalWordLUTIdx=0; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                        pCurrGlobalWord = (GlobalWord_1ch*)m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx];
+                        pCurrGlobalWord = (GlobalWord_1ch*)m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx];
                         if(lv::L1dist(pCurrGlobalWord->oFeature.anColor[0],nCurrColor)<=nCurrColorDistThreshold &&
                            lv::L1dist(nCurrIntraDescBITS,pCurrGlobalWord->nDescBITS)<=nCurrDescDistThreshold/GWORD_DESC_THRES_BITS_MATCH_FACTOR)
                             break;
@@ -803,7 +799,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     nCurrRegionSegmVal = UCHAR_MAX;
                 if(fPotentialLocalWordsWeightSum<DEFAULT_LWORD_INIT_WEIGHT) {
                     const size_t nNewLocalWordIdx = m_nCurrLocalWords-1;
-                    LocalWord_1ch& oNewLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nLocalDictIdx+nNewLocalWordIdx];
+                    LocalWord_1ch& oNewLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nNewLocalWordIdx];
                     oNewLocalWord.oFeature.anColor[0] = nCurrColor;
                     oNewLocalWord.oFeature.anDesc[0] = nCurrIntraDesc;
                     oNewLocalWord.nOccurrences = nCurrWordOccIncr;
@@ -835,7 +831,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nNeighborLocalWordIdx = 0;
                     float fNeighborPotentialLocalWordsWeightSum = 0.0f;
                     while(nNeighborLocalWordIdx<m_nCurrLocalWords && fNeighborPotentialLocalWordsWeightSum<fLocalWordsWeightSumThreshold) {
-                        LocalWord_1ch oNeighborLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
+                        LocalWord_1ch oNeighborLocalWord = m_voLocalWordList_1ch[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
                         const size_t nNeighborColorDist = lv::L1dist(nCurrColor,oNeighborLocalWord.oFeature.anColor[0]);
                         const size_t nNeighborIntraDescDist = lv::hdist(nCurrIntraDesc,oNeighborLocalWord.oFeature.anDesc[0]);
                         const bool bNeighborRegionIsFlat = lv::popcount(oNeighborLocalWord.oFeature.anDesc[0])<FLAT_REGION_BIT_COUNT;
@@ -870,7 +866,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     }
                     if(fNeighborPotentialLocalWordsWeightSum<DEFAULT_LWORD_INIT_WEIGHT) {
                         nNeighborLocalWordIdx = m_nCurrLocalWords-1;
-                        LocalWord_1ch& oNeighborLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
+                        LocalWord_1ch& oNeighborLocalWord = m_voLocalWordList_1ch[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
                         oNeighborLocalWord.oFeature.anColor[0] = nCurrColor;
                         oNeighborLocalWord.oFeature.anDesc[0] = nCurrIntraDesc;
                         oNeighborLocalWord.nOccurrences = nCurrWordOccIncr;
@@ -964,7 +960,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
             float& fCurrMeanMinDist_LT = *(float*)(m_oMeanMinDistFrame_LT.data+nFloatIter);
             float& fCurrMeanMinDist_ST = *(float*)(m_oMeanMinDistFrame_ST.data+nFloatIter);
 #endif //USE_FEEDBACK_ADJUSTMENTS
-            const float fBestLocalWordWeight = GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
+            const float fBestLocalWordWeight = GetLocalWordWeight(m_voLocalWordList_3ch[nLocalDictIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
             const float fLocalWordsWeightSumThreshold = fBestLocalWordWeight/(fCurrDistThresholdFactor*2);
             uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
             uchar& nCurrRegionIllumUpdtVal = m_oIllumUpdtRegionMask.data[nPxIter];
@@ -1000,12 +996,14 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
             fPrepTimeSum_MS += (float)(std::chrono::duration_cast<std::chrono::nanoseconds>(post_prep-pre_prep).count())/1000000;
 #endif //USE_INTERNAL_HRCS
             while(nLocalWordIdx<m_nCurrLocalWords && fPotentialLocalWordsWeightSum<fLocalWordsWeightSumThreshold) {
-                LocalWord_3ch& oCurrLocalWord = (LocalWord_3ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                LocalWord_3ch& oCurrLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
                 const float fCurrLocalWordWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
-                {
-                    const size_t nTotColorL1Dist = lv::L1dist(anCurrColor,oCurrLocalWord.oFeature.anColor);
-                    const size_t nColorDistortion = lv::cdist(anCurrColor,oCurrLocalWord.oFeature.anColor);
-                    const size_t nTotColorMixDist = lv::cmixdist(nTotColorL1Dist,nColorDistortion);
+                const size_t nTotColorL1Dist = lv::L1dist(anCurrColor,oCurrLocalWord.oFeature.anColor);
+                // color prefilter: the mixed distance is always >= L1/2, so the color distortion is only computed when that bound passes
+                const bool bColorRejected = m_bUseColorPrefilter && nTotColorL1Dist/2>nCurrTotColorDistThreshold;
+                const size_t nTotColorMixDist = bColorRejected?nTotColorL1Dist/2:lv::cmixdist(nTotColorL1Dist,(size_t)lv::cdist(anCurrColor,oCurrLocalWord.oFeature.anColor));
+                // both tests below require a color match, so LBSP distances are only computed for words that pass it
+                if(!m_bUseColorPrefilter || nTotColorMixDist<=nCurrTotColorDistThreshold) {
                     const size_t nTotIntraDescDist = lv::hdist(anCurrIntraDesc,oCurrLocalWord.oFeature.anDesc);
                     std::array<ushort,3> anCurrInterDesc;
                     for(size_t c=0; c<3; ++c)
@@ -1042,7 +1040,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     }
                 }
                 if(fCurrLocalWordWeight>fLastLocalWordWeight) {
-                    std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                    std::swap(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx-1]);
 #if DISPLAY_PAWCS_DEBUG_INFO
                     std::swap(vsWordModList[nLocalDictIdx+nLocalWordIdx],vsWordModList[nLocalDictIdx+nLocalWordIdx-1]);
 #endif //DISPLAY_PAWCS_DEBUG_INFO
@@ -1052,9 +1050,9 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                 ++nLocalWordIdx;
             }
             while(nLocalWordIdx<m_nCurrLocalWords) {
-                const float fCurrLocalWordWeight = GetLocalWordWeight(*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
+                const float fCurrLocalWordWeight = GetLocalWordWeight(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx],m_nFrameIdx,m_nLocalWordWeightOffset);
                 if(fCurrLocalWordWeight>fLastLocalWordWeight) {
-                    std::swap(m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx],m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx-1]);
+                    std::swap(m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx],m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx-1]);
 #if DISPLAY_PAWCS_DEBUG_INFO
                     std::swap(vsWordModList[nLocalDictIdx+nLocalWordIdx],vsWordModList[nLocalDictIdx+nLocalWordIdx-1]);
 #endif //DISPLAY_PAWCS_DEBUG_INFO
@@ -1080,7 +1078,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nGlobalWordLUTIdx;
                     GlobalWord_3ch* pCurrGlobalWord = nullptr;
                     for(nGlobalWordLUTIdx=0; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                        pCurrGlobalWord = (GlobalWord_3ch*)m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx];
+                        pCurrGlobalWord = (GlobalWord_3ch*)m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx];
                         if(lv::L1dist(nCurrIntraDescBITS,pCurrGlobalWord->nDescBITS)<=nCurrTotDescDistThreshold/GWORD_DESC_THRES_BITS_MATCH_FACTOR &&
                            lv::cmixdist(anCurrColor,pCurrGlobalWord->oFeature.anColor)<=nCurrTotColorDistThreshold)
                             break;
@@ -1117,7 +1115,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nGlobalWordLUTIdx;
                     GlobalWord_3ch* pCurrGlobalWord = nullptr;
                     for(nGlobalWordLUTIdx=0; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                        pCurrGlobalWord = (GlobalWord_3ch*)m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx];
+                        pCurrGlobalWord = (GlobalWord_3ch*)m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx];
                         if(lv::L1dist(nCurrIntraDescBITS,pCurrGlobalWord->nDescBITS)<=nCurrTotDescDistThreshold/GWORD_DESC_THRES_BITS_MATCH_FACTOR &&
                            lv::cmixdist(anCurrColor,pCurrGlobalWord->oFeature.anColor)<=nCurrTotColorDistThreshold)
                             break;
@@ -1141,7 +1139,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     nCurrRegionSegmVal = UCHAR_MAX;
                 if(fPotentialLocalWordsWeightSum<DEFAULT_LWORD_INIT_WEIGHT) {
                     const size_t nNewLocalWordIdx = m_nCurrLocalWords-1;
-                    LocalWord_3ch* pNewLocalWord = (LocalWord_3ch*)m_vpLocalWordDict[nLocalDictIdx+nNewLocalWordIdx];
+                    LocalWord_3ch* pNewLocalWord = &m_voLocalWordList_3ch[nLocalDictIdx+nNewLocalWordIdx];
                     for(size_t c=0; c<3; ++c) {
                         pNewLocalWord->oFeature.anColor[c] = anCurrColor[c];
                         pNewLocalWord->oFeature.anDesc[c] = anCurrIntraDesc[c];
@@ -1175,7 +1173,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     size_t nNeighborLocalWordIdx = 0;
                     float fNeighborPotentialLocalWordsWeightSum = 0.0f;
                     while(nNeighborLocalWordIdx<m_nCurrLocalWords && fNeighborPotentialLocalWordsWeightSum<fLocalWordsWeightSumThreshold) {
-                        LocalWord_3ch& oNeighborLocalWord = (LocalWord_3ch&)*m_vpLocalWordDict[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
+                        LocalWord_3ch& oNeighborLocalWord = m_voLocalWordList_3ch[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
                         const size_t nNeighborTotColorL1Dist = lv::L1dist(anCurrColor,oNeighborLocalWord.oFeature.anColor);
                         const size_t nNeighborColorDistortion = lv::cdist(anCurrColor,oNeighborLocalWord.oFeature.anColor);
                         const size_t nNeighborTotColorMixDist = lv::cmixdist(nNeighborTotColorL1Dist,nNeighborColorDistortion);
@@ -1231,7 +1229,7 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
                     }
                     if(fNeighborPotentialLocalWordsWeightSum<DEFAULT_LWORD_INIT_WEIGHT) {
                         nNeighborLocalWordIdx = m_nCurrLocalWords-1;
-                        LocalWord_3ch& oNeighborLocalWord = (LocalWord_3ch&)*m_vpLocalWordDict[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
+                        LocalWord_3ch& oNeighborLocalWord = m_voLocalWordList_3ch[nNeighborLocalDictIdx+nNeighborLocalWordIdx];
                         for(size_t c=0; c<3; ++c) {
                             oNeighborLocalWord.oFeature.anColor[c] = anCurrColor[c];
                             oNeighborLocalWord.oFeature.anDesc[c] = anCurrIntraDesc[c];
@@ -1322,11 +1320,11 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
         for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
             const size_t nGlobalWordMapLookupIdx = m_voPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx;
-            float fLastGlobalWordLocalWeight = *(float*)(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[0]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
+            float fLastGlobalWordLocalWeight = *(float*)(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
             for(size_t nGlobalWordLUTIdx=1; nGlobalWordLUTIdx<m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                const float fCurrGlobalWordLocalWeight = *(float*)(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
+                const float fCurrGlobalWordLocalWeight = *(float*)(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx]->oSpatioOccMap.data+nGlobalWordMapLookupIdx);
                 if(fCurrGlobalWordLocalWeight>fLastGlobalWordLocalWeight)
-                    std::swap(m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx],m_voPxInfoLUT_PAWCS[nPxIter].vpGlobalDictSortLUT[nGlobalWordLUTIdx-1]);
+                    std::swap(m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx],m_vpGlobalDictSortLUT[nModelIter*m_nCurrGlobalWords+nGlobalWordLUTIdx-1]);
                 else
                     fLastGlobalWordLocalWeight = fCurrGlobalWordLocalWeight;
             }
@@ -1373,11 +1371,11 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
         printf("DBG_LDICT : (%lu occincr per match)\n",nDBGWordOccIncr);
         for(size_t nDBGWordIdx=0; nDBGWordIdx<m_nCurrLocalWords; ++nDBGWordIdx) {
             if(m_nImgChannels==1) {
-                LocalWord_1ch* pDBGLocalWord = (LocalWord_1ch*)m_vpLocalWordDict[nLocalDictDBGIdx+nDBGWordIdx];
+                LocalWord_1ch* pDBGLocalWord = &m_voLocalWordList_1ch[nLocalDictDBGIdx+nDBGWordIdx];
                 printf("\t [%02lu] : weight=[%02.03f], nColor=[%03d], nDescBITS=[%02lu]  %s\n",nDBGWordIdx,GetLocalWordWeight(*pDBGLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset),(int)pDBGLocalWord->oFeature.anColor[0],(size_t)lv::popcount(pDBGLocalWord->oFeature.anDesc[0]),vsWordModList[nLocalDictDBGIdx+nDBGWordIdx].c_str());
             }
             else { //m_nImgChannels==3
-                LocalWord_3ch* pDBGLocalWord = (LocalWord_3ch*)m_vpLocalWordDict[nLocalDictDBGIdx+nDBGWordIdx];
+                LocalWord_3ch* pDBGLocalWord = &m_voLocalWordList_3ch[nLocalDictDBGIdx+nDBGWordIdx];
                 printf("\t [%02lu] : weight=[%02.03f], anColor=[%03d,%03d,%03d], anDescBITS=[%02lu,%02lu,%02lu]  %s\n",nDBGWordIdx,GetLocalWordWeight(*pDBGLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset),(int)pDBGLocalWord->oFeature.anColor[0],(int)pDBGLocalWord->oFeature.anColor[1],(int)pDBGLocalWord->oFeature.anColor[2],(size_t)lv::popcount(pDBGLocalWord->oFeature.anDesc[0]),(size_t)lv::popcount(pDBGLocalWord->oFeature.anDesc[1]),(size_t)lv::popcount(pDBGLocalWord->oFeature.anDesc[2]),vsWordModList[nLocalDictDBGIdx+nDBGWordIdx].c_str());
             }
         }
@@ -1444,19 +1442,16 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
     cv::bitwise_or(m_oCurrRawFGBlinkMask,m_oLastRawFGBlinkMask,m_oBlinksFrame);
     m_oCurrRawFGBlinkMask.copyTo(m_oLastRawFGBlinkMask);
     oCurrFGMask.copyTo(m_oLastRawFGMask);
-    cv::morphologyEx(oCurrFGMask,m_oFGMask_PreFlood,cv::MORPH_CLOSE,m_oMorphExStructElement);
+    lv::binaryClose(oCurrFGMask,m_oFGMask_PreFlood,m_oMorphExStructElement.cols/2);
     m_oFGMask_PreFlood.copyTo(m_oFGMask_FloodedHoles);
     cv::floodFill(m_oFGMask_FloodedHoles,cv::Point(0,0),UCHAR_MAX);
     cv::bitwise_not(m_oFGMask_FloodedHoles,m_oFGMask_FloodedHoles);
-    cv::erode(m_oFGMask_PreFlood,m_oFGMask_PreFlood,cv::Mat(),cv::Point(-1,-1),3);
-    cv::bitwise_or(oCurrFGMask,m_oFGMask_FloodedHoles,oCurrFGMask);
-    cv::bitwise_or(oCurrFGMask,m_oFGMask_PreFlood,oCurrFGMask);
-    cv::medianBlur(oCurrFGMask,m_oLastFGMask,m_nMedianBlurKernelSize);
-    cv::dilate(m_oLastFGMask,m_oLastFGMask_dilated,cv::Mat(),cv::Point(-1,-1),3);
+    // erode x3, union with the raw mask & holes, median and dilate x3 in a single line-buffered pass (bit-exact with the opencv chain)
+    lv::postProcessBinaryMask(oCurrFGMask,m_oFGMask_FloodedHoles,m_oFGMask_PreFlood,m_oLastFGMask,m_nMedianBlurKernelSize,3,&m_oLastFGMask_dilated,3);
     cv::bitwise_and(m_oBlinksFrame,m_oLastFGMask_dilated_inverted,m_oBlinksFrame);
     cv::bitwise_not(m_oLastFGMask_dilated,m_oLastFGMask_dilated_inverted);
     cv::bitwise_and(m_oBlinksFrame,m_oLastFGMask_dilated_inverted,m_oBlinksFrame);
-    m_oLastFGMask.copyTo(oCurrFGMask);
+    copyMaskAndExtractBlobs(m_oLastFGMask,oCurrFGMask,m_voLatestBlobs);
     cv::addWeighted(m_oMeanFinalSegmResFrame_LT,(1.0f-fRollAvgFactor_LT),m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_LT,0,m_oMeanFinalSegmResFrame_LT,CV_32F);
     cv::addWeighted(m_oMeanFinalSegmResFrame_ST,(1.0f-fRollAvgFactor_ST),m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_ST,0,m_oMeanFinalSegmResFrame_ST,CV_32F);
     const float fCurrNonFlatRegionRatio = (float)(m_nTotRelevantPxCount-nFlatRegionCount)/m_nTotRelevantPxCount;
@@ -1520,6 +1515,175 @@ void BackgroundSubtractorPAWCS::apply(cv::InputArray _image, cv::OutputArray _fg
     std::chrono::high_resolution_clock::time_point post_all = std::chrono::high_resolution_clock::now();
     std::cout << "all=" << std::fixed << std::setprecision(1) << (float)(std::chrono::duration_cast<std::chrono::microseconds>(post_all-pre_all).count())/1000 << ". " << std::endl;
 #endif //USE_INTERNAL_HRCS
+    refineReducedResMask(oFullInputImg,oInputImg,oCurrFGMask,_fgmask);
+}
+
+std::vector<std::pair<const char*,cv::Mat*>> BackgroundSubtractorPAWCS::getModelStateMaps() {
+    return {
+        {"oDSROI_MotionAnalysis",&m_oDownSampledROI_MotionAnalysis},
+        {"oIllumUpdtRegionMask",&m_oIllumUpdtRegionMask},
+        {"oUpdateRateFrame",&m_oUpdateRateFrame},
+        {"oDistThresholdFrame",&m_oDistThresholdFrame},
+        {"oDistThresholdVarFrame",&m_oDistThresholdVariationFrame},
+        {"oMeanMinDistFrame_LT",&m_oMeanMinDistFrame_LT},
+        {"oMeanMinDistFrame_ST",&m_oMeanMinDistFrame_ST},
+        {"oMeanDSLastDistFrame_LT",&m_oMeanDownSampledLastDistFrame_LT},
+        {"oMeanDSLastDistFrame_ST",&m_oMeanDownSampledLastDistFrame_ST},
+        {"oMeanRawSegmResFrame_LT",&m_oMeanRawSegmResFrame_LT},
+        {"oMeanRawSegmResFrame_ST",&m_oMeanRawSegmResFrame_ST},
+        {"oMeanFinalSegmResFrame_LT",&m_oMeanFinalSegmResFrame_LT},
+        {"oMeanFinalSegmResFrame_ST",&m_oMeanFinalSegmResFrame_ST},
+        {"oUnstableRegionMask",&m_oUnstableRegionMask},
+        {"oBlinksFrame",&m_oBlinksFrame},
+        {"oDSFrame_MotionAnalysis",&m_oDownSampledFrame_MotionAnalysis},
+        {"oLastRawFGMask",&m_oLastRawFGMask},
+        {"oLastFGMask_dilated",&m_oLastFGMask_dilated},
+        {"oLastFGMask_dilated_inv",&m_oLastFGMask_dilated_inverted},
+        {"oCurrRawFGBlinkMask",&m_oCurrRawFGBlinkMask},
+        {"oLastRawFGBlinkMask",&m_oLastRawFGBlinkMask},
+        {"oTempGWordWeightDiffFactor",&m_oTempGlobalWordWeightDiffFactor},
+    };
+}
+
+template<typename TLocalWord, typename TGlobalWord>
+void BackgroundSubtractorPAWCS::saveModel_words(BackgroundModelSnapshot& oSnapshot, const std::string& sFilePath, const std::vector<TLocalWord>& voLocalWordList, const std::vector<TGlobalWord>& voGlobalWordList) const {
+    static_assert(std::is_trivially_copyable<TLocalWord>::value,"local words must be trivially copyable");
+    typedef GlobalWordRecord<decltype(TGlobalWord::oFeature)> GlobalWordRecord_;
+    lvAssert_(voGlobalWordList.size()<=USHRT_MAX,"word lists too large for snapshot indices");
+    std::vector<uint32_t> vnGlobalWordDict(m_vpGlobalWordDict.size());
+    for(size_t nDictIdx=0; nDictIdx<m_vpGlobalWordDict.size(); ++nDictIdx)
+        vnGlobalWordDict[nDictIdx] = m_vpGlobalWordDict[nDictIdx]?uint32_t((const TGlobalWord*)m_vpGlobalWordDict[nDictIdx]-voGlobalWordList.data()):s_nSnapshotNullWordIdx;
+    const size_t nOccMapSize = (size_t)m_oDownSampledFrameSize_GlobalWordLookup.area();
+    std::vector<GlobalWordRecord_> voGlobalWordRecords(voGlobalWordList.size());
+    std::vector<float> vfGlobalWordOccMaps(voGlobalWordList.size()*nOccMapSize);
+    for(size_t nWordIdx=0; nWordIdx<voGlobalWordList.size(); ++nWordIdx) {
+        const TGlobalWord& oWord = voGlobalWordList[nWordIdx];
+        voGlobalWordRecords[nWordIdx].oFeature = oWord.oFeature;
+        voGlobalWordRecords[nWordIdx].fLatestWeight = oWord.fLatestWeight;
+        voGlobalWordRecords[nWordIdx].nDescBITS = oWord.nDescBITS;
+        if(!oWord.oSpatioOccMap.empty()) {
+            lvAssert_(oWord.oSpatioOccMap.isContinuous() && oWord.oSpatioOccMap.total()==nOccMapSize,"unexpected global word occurrence map size");
+            std::copy_n((const float*)oWord.oSpatioOccMap.data,nOccMapSize,vfGlobalWordOccMaps.begin()+nWordIdx*nOccMapSize);
+        }
+    }
+    // per-pixel global dictionary sort LUTs are only stored for ROI pixels
+    std::vector<uint16_t> vnGlobalDictSortLUTs(m_nTotRelevantPxCount*m_nCurrGlobalWords);
+    lvDbgAssert(m_vpGlobalDictSortLUT.size()==vnGlobalDictSortLUTs.size());
+    for(size_t nLUTIdx=0; nLUTIdx<vnGlobalDictSortLUTs.size(); ++nLUTIdx)
+        vnGlobalDictSortLUTs[nLUTIdx] = uint16_t((const TGlobalWord*)m_vpGlobalDictSortLUT[nLUTIdx]-voGlobalWordList.data());
+    oSnapshot.addBlock("aoLocalWords",voLocalWordList.data(),voLocalWordList.size()*sizeof(TLocalWord));
+    oSnapshot.addBlock("aoGlobalWords",voGlobalWordRecords.data(),voGlobalWordRecords.size()*sizeof(GlobalWordRecord_));
+    oSnapshot.addBlock("afGlobalWordOccMaps",vfGlobalWordOccMaps.data(),vfGlobalWordOccMaps.size()*sizeof(float));
+    oSnapshot.addBlock("anGlobalWordDict",vnGlobalWordDict.data(),vnGlobalWordDict.size()*sizeof(uint32_t));
+    oSnapshot.addBlock("anGlobalDictSortLUTs",vnGlobalDictSortLUTs.data(),vnGlobalDictSortLUTs.size()*sizeof(uint16_t));
+    oSnapshot.write(sFilePath);
+}
+
+template<typename TLocalWord, typename TGlobalWord>
+void BackgroundSubtractorPAWCS::loadModel_words(const BackgroundModelSnapshot& oSnapshot, std::vector<TLocalWord>& voLocalWordList, std::vector<TGlobalWord>& voGlobalWordList) {
+    typedef GlobalWordRecord<decltype(TGlobalWord::oFeature)> GlobalWordRecord_;
+    const size_t nLocalWords = m_nTotRelevantPxCount*m_nCurrLocalWords;
+    voLocalWordList.resize(nLocalWords);
+    std::memcpy(voLocalWordList.data(),oSnapshot.getBlock("aoLocalWords",nLocalWords*sizeof(TLocalWord)),nLocalWords*sizeof(TLocalWord));
+    const size_t nOccMapSize = (size_t)m_oDownSampledFrameSize_GlobalWordLookup.area();
+    const GlobalWordRecord_* aoGlobalWordRecords = (const GlobalWordRecord_*)oSnapshot.getBlock("aoGlobalWords",m_nCurrGlobalWords*sizeof(GlobalWordRecord_));
+    const float* afGlobalWordOccMaps = (const float*)oSnapshot.getBlock("afGlobalWordOccMaps",m_nCurrGlobalWords*nOccMapSize*sizeof(float));
+    voGlobalWordList.resize(m_nCurrGlobalWords);
+    for(size_t nWordIdx=0; nWordIdx<m_nCurrGlobalWords; ++nWordIdx) {
+        TGlobalWord& oWord = voGlobalWordList[nWordIdx];
+        oWord.oFeature = aoGlobalWordRecords[nWordIdx].oFeature;
+        oWord.fLatestWeight = aoGlobalWordRecords[nWordIdx].fLatestWeight;
+        oWord.nDescBITS = aoGlobalWordRecords[nWordIdx].nDescBITS;
+        oWord.oSpatioOccMap.create(m_oDownSampledFrameSize_GlobalWordLookup,CV_32FC1);
+        std::copy_n(afGlobalWordOccMaps+nWordIdx*nOccMapSize,nOccMapSize,(float*)oWord.oSpatioOccMap.data);
+    }
+    const uint32_t* anGlobalWordDict = (const uint32_t*)oSnapshot.getBlock("anGlobalWordDict",m_nCurrGlobalWords*sizeof(uint32_t));
+    m_vpGlobalWordDict.resize(m_nCurrGlobalWords);
+    for(size_t nDictIdx=0; nDictIdx<m_nCurrGlobalWords; ++nDictIdx) {
+        lvAssert_(anGlobalWordDict[nDictIdx]==s_nSnapshotNullWordIdx || anGlobalWordDict[nDictIdx]<m_nCurrGlobalWords,"snapshot contains bad global word index");
+        m_vpGlobalWordDict[nDictIdx] = (anGlobalWordDict[nDictIdx]==s_nSnapshotNullWordIdx)?nullptr:&voGlobalWordList[anGlobalWordDict[nDictIdx]];
+    }
+    const uint16_t* anGlobalDictSortLUTs = (const uint16_t*)oSnapshot.getBlock("anGlobalDictSortLUTs",m_nTotRelevantPxCount*m_nCurrGlobalWords*sizeof(uint16_t));
+    m_voPxInfoLUT_PAWCS.clear();
+    m_voPxInfoLUT_PAWCS.resize(m_nTotPxCount);
+    for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
+        const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
+        PxInfo_PAWCS& oPxInfo = m_voPxInfoLUT_PAWCS[nPxIter];
+        oPxInfo.nImgCoord_Y = (int)nPxIter/m_oImgSize.width;
+        oPxInfo.nImgCoord_X = (int)nPxIter%m_oImgSize.width;
+        oPxInfo.nModelIdx = nModelIter;
+        oPxInfo.nGlobalWordMapLookupIdx = (size_t)((oPxInfo.nImgCoord_Y/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)*m_oDownSampledFrameSize_GlobalWordLookup.width+(oPxInfo.nImgCoord_X/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO))*4;
+    }
+    m_vpGlobalDictSortLUT.resize(m_nTotRelevantPxCount*m_nCurrGlobalWords);
+    for(size_t nLUTIdx=0; nLUTIdx<m_vpGlobalDictSortLUT.size(); ++nLUTIdx) {
+        lvAssert_(size_t(anGlobalDictSortLUTs[nLUTIdx])<m_nCurrGlobalWords,"snapshot contains bad global word sort index");
+        m_vpGlobalDictSortLUT[nLUTIdx] = &voGlobalWordList[anGlobalDictSortLUTs[nLUTIdx]];
+    }
+}
+
+void BackgroundSubtractorPAWCS::saveModel(const std::string& sFilePath) const {
+    lvAssert_(m_bModelInitialized,"model must be initialized first");
+    BackgroundModelSnapshot oSnapshot("PAWCS",s_nModelSnapshotVersion);
+    IBackgroundSubtractorLBSP::saveModel_common(oSnapshot);
+    oSnapshot.addValue("anParams",std::array<uint64_t,5>{uint64_t(m_nMinColorDistThreshold),uint64_t(m_nDescDistThresholdOffset),uint64_t(m_nMaxLocalWords),uint64_t(m_nMaxGlobalWords),uint64_t(m_nSamplesForMovingAvgs)});
+    oSnapshot.addValue("anWordCounts",std::array<uint64_t,2>{uint64_t(m_nCurrLocalWords),uint64_t(m_nCurrGlobalWords)});
+    oSnapshot.addValue("fLastNonFlatRegionRatio",m_fLastNonFlatRegionRatio);
+    oSnapshot.addValue("nMedianBlurKernelSize",int32_t(m_nMedianBlurKernelSize));
+    oSnapshot.addValue("nDSROIPxCount",uint64_t(m_nDownSampledROIPxCount));
+    oSnapshot.addValue("nLocalWordWeightOffset",uint64_t(m_nLocalWordWeightOffset));
+    for(const auto& oMap : const_cast<BackgroundSubtractorPAWCS*>(this)->getModelStateMaps())
+        oSnapshot.addMat(oMap.first,*oMap.second);
+    if(m_nImgChannels==1) {
+        oSnapshot.addValue("nGlobalWordListIterOffset",uint64_t(m_pGlobalWordListIter_1ch-m_voGlobalWordList_1ch.begin()));
+        saveModel_words(oSnapshot,sFilePath,m_voLocalWordList_1ch,m_voGlobalWordList_1ch);
+    }
+    else { //m_nImgChannels==3
+        oSnapshot.addValue("nGlobalWordListIterOffset",uint64_t(m_pGlobalWordListIter_3ch-m_voGlobalWordList_3ch.begin()));
+        saveModel_words(oSnapshot,sFilePath,m_voLocalWordList_3ch,m_voGlobalWordList_3ch);
+    }
+}
+
+void BackgroundSubtractorPAWCS::loadModel(const std::string& sFilePath) {
+    const BackgroundModelSnapshot oSnapshot = BackgroundModelSnapshot::open(sFilePath,"PAWCS",s_nModelSnapshotVersion);
+    const std::array<uint64_t,5> anParams = oSnapshot.getValue<std::array<uint64_t,5>>("anParams");
+    lvAssert_(anParams==(std::array<uint64_t,5>{uint64_t(m_nMinColorDistThreshold),uint64_t(m_nDescDistThresholdOffset),uint64_t(m_nMaxLocalWords),uint64_t(m_nMaxGlobalWords),uint64_t(m_nSamplesForMovingAvgs)}),
+              "snapshot was created with different algorithm params");
+    IBackgroundSubtractorLBSP::loadModel_common(oSnapshot);
+    const std::array<uint64_t,2> anWordCounts = oSnapshot.getValue<std::array<uint64_t,2>>("anWordCounts");
+    lvAssert_(anWordCounts[0]>0 && anWordCounts[0]<=m_nMaxLocalWords && anWordCounts[1]>0 && anWordCounts[1]<=m_nMaxGlobalWords,"snapshot contains bad word counts");
+    m_nCurrLocalWords = (size_t)anWordCounts[0];
+    m_nCurrGlobalWords = (size_t)anWordCounts[1];
+    m_fLastNonFlatRegionRatio = oSnapshot.getValue<float>("fLastNonFlatRegionRatio");
+    m_nMedianBlurKernelSize = (int)oSnapshot.getValue<int32_t>("nMedianBlurKernelSize");
+    m_nDownSampledROIPxCount = (size_t)oSnapshot.getValue<uint64_t>("nDSROIPxCount");
+    m_nLocalWordWeightOffset = (size_t)oSnapshot.getValue<uint64_t>("nLocalWordWeightOffset");
+    m_oDownSampledFrameSize_MotionAnalysis = cv::Size(m_oImgSize.width/FRAMELEVEL_DOWNSAMPLE_RATIO,m_oImgSize.height/FRAMELEVEL_DOWNSAMPLE_RATIO);
+    m_oDownSampledFrameSize_GlobalWordLookup = cv::Size(m_oImgSize.width/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO,m_oImgSize.height/GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO);
+    for(const auto& oMap : getModelStateMaps()) {
+        *oMap.second = oSnapshot.getMat(oMap.first).clone();
+        lvAssert__(oMap.second->size()==m_oImgSize || oMap.second->size()==m_oDownSampledFrameSize_MotionAnalysis || oMap.second->size()==m_oDownSampledFrameSize_GlobalWordLookup,"snapshot map '%s' has bad size",oMap.first);
+    }
+    m_oFGMask_PreFlood.create(m_oImgSize,CV_8UC1);
+    m_oFGMask_FloodedHoles.create(m_oImgSize,CV_8UC1);
+    m_oMorphExStructElement = cv::getStructuringElement(cv::MORPH_RECT,cv::Size(3,3));
+    const size_t nGlobalWordListIterOffset = (size_t)oSnapshot.getValue<uint64_t>("nGlobalWordListIterOffset");
+    lvAssert_(nGlobalWordListIterOffset<=m_nCurrGlobalWords,"snapshot contains bad word list offset");
+    m_voLocalWordList_1ch.clear();
+    m_voLocalWordList_3ch.clear();
+    m_voGlobalWordList_1ch.clear();
+    m_voGlobalWordList_3ch.clear();
+    m_pGlobalWordListIter_1ch = m_voGlobalWordList_1ch.end();
+    m_pGlobalWordListIter_3ch = m_voGlobalWordList_3ch.end();
+    if(m_nImgChannels==1) {
+        loadModel_words(oSnapshot,m_voLocalWordList_1ch,m_voGlobalWordList_1ch);
+        m_pGlobalWordListIter_1ch = m_voGlobalWordList_1ch.begin()+nGlobalWordListIterOffset;
+    }
+    else { //m_nImgChannels==3
+        loadModel_words(oSnapshot,m_voLocalWordList_3ch,m_voGlobalWordList_3ch);
+        m_pGlobalWordListIter_3ch = m_voGlobalWordList_3ch.begin()+nGlobalWordListIterOffset;
+    }
+    m_bInitialized = true;
+    m_bModelInitialized = true;
 }
 
 void BackgroundSubtractorPAWCS::getBackgroundImage(cv::OutputArray backgroundImage) const { // @@@ add option to reconstruct from gwords?
@@ -1534,7 +1698,7 @@ void BackgroundSubtractorPAWCS::getBackgroundImage(cv::OutputArray backgroundIma
             float fTotWeight = 0.0f;
             float fTotColor = 0.0f;
             for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                const LocalWord_1ch& oCurrLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                const LocalWord_1ch& oCurrLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
                 float fCurrWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                 fTotColor += (float)oCurrLocalWord.oFeature.anColor[0]*fCurrWeight;
                 fTotWeight += fCurrWeight;
@@ -1545,7 +1709,7 @@ void BackgroundSubtractorPAWCS::getBackgroundImage(cv::OutputArray backgroundIma
             float fTotWeight = 0.0f;
             std::array<float,3> fTotColor = {0.0f,0.0f,0.0f};
             for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                const LocalWord_3ch& oCurrLocalWord = (LocalWord_3ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                const LocalWord_3ch& oCurrLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
                 float fCurrWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                 for(size_t c=0; c<3; ++c)
                     fTotColor[c] += (float)oCurrLocalWord.oFeature.anColor[c]*fCurrWeight;
@@ -1570,7 +1734,7 @@ void BackgroundSubtractorPAWCS::getBackgroundDescriptorsImage(cv::OutputArray ba
             float fTotWeight = 0.0f;
             float fTotDesc = 0.0f;
             for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                const LocalWord_1ch& oCurrLocalWord = (LocalWord_1ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                const LocalWord_1ch& oCurrLocalWord = m_voLocalWordList_1ch[nLocalDictIdx+nLocalWordIdx];
                 float fCurrWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                 fTotDesc += (float)oCurrLocalWord.oFeature.anDesc[0]*fCurrWeight;
                 fTotWeight += fCurrWeight;
@@ -1581,7 +1745,7 @@ void BackgroundSubtractorPAWCS::getBackgroundDescriptorsImage(cv::OutputArray ba
             float fTotWeight = 0.0f;
             std::array<float,3> fTotDesc = {0.0f,0.0f,0.0f};
             for(size_t nLocalWordIdx=0; nLocalWordIdx<m_nCurrLocalWords; ++nLocalWordIdx) {
-                const LocalWord_3ch& oCurrLocalWord = (LocalWord_3ch&)*m_vpLocalWordDict[nLocalDictIdx+nLocalWordIdx];
+                const LocalWord_3ch& oCurrLocalWord = m_voLocalWordList_3ch[nLocalDictIdx+nLocalWordIdx];
                 float fCurrWeight = GetLocalWordWeight(oCurrLocalWord,m_nFrameIdx,m_nLocalWordWeightOffset);
                 for(size_t c=0; c<3; ++c)
                     fTotDesc[c] += (float)oCurrLocalWord.oFeature.anDesc[c]*fCurrWeight;
@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorPBAS.hpp"
+#include "litiv/video/BackgroundSubtractionUtils.hpp"
 #include "litiv/utils/math.hpp"
 #include "litiv/utils/opencv.hpp"
 
@@ -494,3 +495,338 @@ void BackgroundSubtractorPBAS_3ch::apply(cv::InputArray _image, cv::OutputArray
     cv::medianBlur(oFGMask,oFGMask,9);
 #endif //(!BGSPBAS_USE_ADVANCED_MORPH_OPS)
 }
+
+namespace {
+
+    /// number of 8-bit samples processed per SIMD block in the pixel-major layout (also the sample stride alignment)
+    constexpr size_t s_nSampleBlockSize = 16;
+
+    /// computes the blurred gradient magnitude image used for gradient samples (same pipeline as the reference implementations)
+    inline cv::Mat getGradMagnitude(const cv::Mat& oImg) {
+        cv::Mat oBlurredImg;
+        cv::GaussianBlur(oImg,oBlurredImg,cv::Size(3,3),0,0,cv::BORDER_DEFAULT);
+        cv::Mat oBlurredImg_GradX, oBlurredImg_GradY;
+        cv::Scharr(oBlurredImg,oBlurredImg_GradX,CV_16S,1,0,1,0,cv::BORDER_DEFAULT);
+        cv::Scharr(oBlurredImg,oBlurredImg_GradY,CV_16S,0,1,1,0,cv::BORDER_DEFAULT);
+        cv::Mat oBlurredImg_AbsGradX, oBlurredImg_AbsGradY;
+        cv::convertScaleAbs(oBlurredImg_GradX,oBlurredImg_AbsGradX);
+        cv::convertScaleAbs(oBlurredImg_GradY,oBlurredImg_AbsGradY);
+        cv::Mat oBlurredImg_AbsGrad;
+        cv::addWeighted(oBlurredImg_AbsGradX,0.5,oBlurredImg_AbsGradY,0.5,0,oBlurredImg_AbsGrad);
+        return oBlurredImg_AbsGrad;
+    }
+
+#if HAVE_SSE2
+    /// converts four of the sixteen 8-bit unsigned integers of the given array to 32-bit floats (lanes [4*nQuarter,4*nQuarter+3])
+    template<int nQuarter>
+    inline __m128 cvt_8ui_to_32f(const __m128i& anBuffer) {
+        const __m128i anBuffer_16ui = (nQuarter<2)?_mm_unpacklo_epi8(anBuffer,_mm_setzero_si128()):_mm_unpackhi_epi8(anBuffer,_mm_setzero_si128());
+        return _mm_cvtepi32_ps((nQuarter%2)==0?_mm_unpacklo_epi16(anBuffer_16ui,_mm_setzero_si128()):_mm_unpackhi_epi16(anBuffer_16ui,_mm_setzero_si128()));
+    }
+
+    /// returns the L2 distances of four 3-channel samples as 32-bit floats, given their per-channel 8-bit absolute differences (lanes [4*nQuarter,4*nQuarter+3])
+    template<int nQuarter>
+    inline __m128 getL2Dist_3ch(const __m128i* anDist) {
+        __m128i anDist_16ui[3];
+        for(size_t c=0; c<3; ++c)
+            anDist_16ui[c] = (nQuarter<2)?_mm_unpacklo_epi8(anDist[c],_mm_setzero_si128()):_mm_unpackhi_epi8(anDist[c],_mm_setzero_si128());
+        return _mm_sqrt_ps(_mm_cvtepi32_ps(lv::sqrsum3_16i<(nQuarter%2)==0>(anDist_16ui[0],anDist_16ui[1],anDist_16ui[2])));
+    }
+
+    /// stores the sum distances & gradient distances of four samples, i.e. min(gradweight*graddist+colordist,255) & graddist (lanes [4*nQuarter,4*nQuarter+3])
+    template<int nQuarter>
+    inline void storeBlockDists(const __m128& afColorDist, const __m128& afGradDist, const __m128& afGradWeight, float* afSumDistOut, float* afGradDistOut) {
+        _mm_store_ps(afSumDistOut+nQuarter*4,_mm_min_ps(_mm_add_ps(_mm_mul_ps(afGradWeight,afGradDist),afColorDist),_mm_set1_ps((float)UCHAR_MAX)));
+        _mm_store_ps(afGradDistOut+nQuarter*4,afGradDist);
+    }
+#endif //HAVE_SSE2
+
+    /// computes the sum distances & gradient distances of a block of pixel samples w.r.t. the current input color & gradient values (1ch version, L1 distances)
+    inline void computeBlockDists_1ch(const uchar* pnInputColor, const uchar* pnInputGrad, const uchar* pnPxSamples, size_t nSampleStride, size_t nBlockIdx,
+                                      float fGradWeight, float* afSumDist, float* afGradDist, bool bUseSIMD) {
+#if HAVE_SSE2
+        if(bUseSIMD) {
+            const __m128i anColorDist = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+nBlockIdx)),_mm_set1_epi8((char)pnInputColor[0]));
+            const __m128i anGradDist = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+nSampleStride+nBlockIdx)),_mm_set1_epi8((char)pnInputGrad[0]));
+            const __m128 afGradWeight = _mm_set1_ps(fGradWeight);
+            storeBlockDists<0>(cvt_8ui_to_32f<0>(anColorDist),cvt_8ui_to_32f<0>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<1>(cvt_8ui_to_32f<1>(anColorDist),cvt_8ui_to_32f<1>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<2>(cvt_8ui_to_32f<2>(anColorDist),cvt_8ui_to_32f<2>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<3>(cvt_8ui_to_32f<3>(anColorDist),cvt_8ui_to_32f<3>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            return;
+        }
+#else //(!HAVE_SSE2)
+        lvIgnore(bUseSIMD);
+#endif //(!HAVE_SSE2)
+        for(size_t n=0; n<s_nSampleBlockSize; ++n) {
+            const size_t nColorDist = lv::L1dist(pnInputColor[0],pnPxSamples[nBlockIdx+n]);
+            afGradDist[n] = (float)lv::L1dist(pnInputGrad[0],pnPxSamples[nSampleStride+nBlockIdx+n]);
+            afSumDist[n] = std::min((fGradWeight*afGradDist[n])+nColorDist,(float)UCHAR_MAX);
+        }
+    }
+
+    /// computes the sum distances & gradient distances of a block of pixel samples w.r.t. the current input color & gradient values (3ch version, L2 distances)
+    inline void computeBlockDists_3ch(const uchar* pnInputColor, const uchar* pnInputGrad, const uchar* pnPxSamples, size_t nSampleStride, size_t nBlockIdx,
+                                      float fGradWeight, float* afSumDist, float* afGradDist, bool bUseSIMD) {
+#if HAVE_SSE2
+        if(bUseSIMD) {
+            __m128i anColorDist[3], anGradDist[3];
+            for(size_t c=0; c<3; ++c) {
+                anColorDist[c] = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+c*nSampleStride+nBlockIdx)),_mm_set1_epi8((char)pnInputColor[c]));
+                anGradDist[c] = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+(3+c)*nSampleStride+nBlockIdx)),_mm_set1_epi8((char)pnInputGrad[c]));
+            }
+            const __m128 afGradWeight = _mm_set1_ps(fGradWeight);
+            storeBlockDists<0>(getL2Dist_3ch<0>(anColorDist),getL2Dist_3ch<0>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<1>(getL2Dist_3ch<1>(anColorDist),getL2Dist_3ch<1>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<2>(getL2Dist_3ch<2>(anColorDist),getL2Dist_3ch<2>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            storeBlockDists<3>(getL2Dist_3ch<3>(anColorDist),getL2Dist_3ch<3>(anGradDist),afGradWeight,afSumDist,afGradDist);
+            return;
+        }
+#else //(!HAVE_SSE2)
+        lvIgnore(bUseSIMD);
+#endif //(!HAVE_SSE2)
+        for(size_t n=0; n<s_nSampleBlockSize; ++n) {
+            const uchar anColorSample[3] = {pnPxSamples[nBlockIdx+n],pnPxSamples[nSampleStride+nBlockIdx+n],pnPxSamples[nSampleStride*2+nBlockIdx+n]};
+            const uchar anGradSample[3] = {pnPxSamples[nSampleStride*3+nBlockIdx+n],pnPxSamples[nSampleStride*4+nBlockIdx+n],pnPxSamples[nSampleStride*5+nBlockIdx+n]};
+            const float fColorDist = lv::L2dist<3>(pnInputColor,anColorSample);
+            afGradDist[n] = lv::L2dist<3>(pnInputGrad,anGradSample);
+            afSumDist[n] = std::min((fGradWeight*afGradDist[n])+fColorDist,(float)UCHAR_MAX);
+        }
+    }
+
+} // anonymous namespace
+
+template<size_t nChannels>
+BackgroundSubtractorPBAS_vec<nChannels>::BackgroundSubtractorPBAS_vec(size_t nInitColorDistThreshold, float fInitUpdateRate, size_t nBGSamples, size_t nRequiredBGSamples) :
+        BackgroundSubtractorPBAS(nInitColorDistThreshold,fInitUpdateRate,nBGSamples,nRequiredBGSamples),
+        m_nSampleStride(((nBGSamples+s_nSampleBlockSize-1)/s_nSampleBlockSize)*s_nSampleBlockSize),
+        m_nRandSeed(0),
+        m_bUseSIMD(true) {
+    // samples are kept in the pixel-major buffer instead
+    m_voBGImg.clear();
+    m_voBGGrad.clear();
+}
+
+template<size_t nChannels>
+BackgroundSubtractorPBAS_vec<nChannels>::~BackgroundSubtractorPBAS_vec() {}
+
+template<size_t nChannels>
+void BackgroundSubtractorPBAS_vec<nChannels>::setRandomSeed(uint32_t nSeed) {
+    m_nRandSeed = nSeed;
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorPBAS_vec<nChannels>::initialize(const cv::Mat& oInitImg) {
+    lvAssert(!oInitImg.empty() && oInitImg.cols>0 && oInitImg.rows>0);
+    lvAssert(oInitImg.isContinuous());
+    const cv::Mat oInitImgConv = lv::getConvertedInput(oInitImg,(int)nChannels);
+    m_oImgSize = oInitImgConv.size();
+    m_oDistThresholdFrame.create(m_oImgSize,CV_32FC1);
+    m_oDistThresholdFrame = cv::Scalar(1.0f);
+#if BGSPBAS_USE_R2_ACCELERATION
+    m_oDistThresholdVariationFrame.create(m_oImgSize,CV_32FC1);
+    m_oDistThresholdVariationFrame = cv::Scalar(BGSPBAS_R2_LOWER);
+#endif //BGSPBAS_USE_R2_ACCELERATION
+    m_oUpdateRateFrame.create(m_oImgSize,CV_32FC1);
+    m_oUpdateRateFrame = cv::Scalar(m_fDefaultUpdateRate);
+    m_oMeanMinDistFrame.create(m_oImgSize,CV_32FC1);
+    m_oMeanMinDistFrame = cv::Scalar(0.0f);
+    m_oLastFGMask.create(m_oImgSize,CV_8UC1);
+    m_oLastFGMask = cv::Scalar(0);
+    m_oFloodedFGMask.create(m_oImgSize,CV_8UC1);
+    m_oFloodedFGMask = cv::Scalar(0);
+    const cv::Mat oInitGradImg = getGradMagnitude(oInitImgConv);
+    const size_t nPxStride = m_nSampleStride*nChannels*2;
+    // padding lanes stay null forever (they are never scanned, and do not bias background image sums)
+    m_vnBGSamples.assign(m_oImgSize.area()*nPxStride,uchar(0));
+    m_oRandGen.seed(m_nRandSeed);
+    std::array<uint32_t,4> anRand;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            uchar* const pnPxSamples = m_vnBGSamples.data()+(size_t(y)*m_oImgSize.width+x)*nPxStride;
+            for(size_t s=0; s<m_nBGSamples; ++s) {
+                if((s%anRand.size())==0)
+                    m_oRandGen.next(anRand);
+                int x_sample,y_sample;
+                lv::getSamplePosition_7x7_std2((int)anRand[s%anRand.size()],x_sample,y_sample,x,y,0,m_oImgSize);
+                const uchar* const pnSampleColor = oInitImgConv.ptr<uchar>(y_sample)+x_sample*nChannels;
+                const uchar* const pnSampleGrad = oInitGradImg.ptr<uchar>(y_sample)+x_sample*nChannels;
+                for(size_t c=0; c<nChannels; ++c) {
+                    pnPxSamples[c*m_nSampleStride+s] = pnSampleColor[c];
+                    pnPxSamples[(nChannels+c)*m_nSampleStride+s] = pnSampleGrad[c];
+                }
+            }
+        }
+    }
+    m_bInitialized = true;
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorPBAS_vec<nChannels>::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
+    lvAssert(m_bInitialized);
+    const cv::Mat oInputImg = lv::getConvertedInput(_image.getMat(),(int)nChannels);
+    lvAssert(oInputImg.size()==m_oImgSize);
+    _fgmask.create(m_oImgSize,CV_8UC1);
+    cv::Mat oFGMask = _fgmask.getMat();
+    const cv::Mat oInputGradImg = getGradMagnitude(oInputImg);
+    const size_t nPxStride = m_nSampleStride*nChannels*2;
+    const float fGradWeight = BGSPBAS_GRAD_WEIGHT_ALPHA/m_fFormerMeanGradDist;
+    // the 1ch reference accumulates integer gradient distances, and the 3ch one accumulates float distances
+    size_t nFrameTotGradDist=0;
+    float fFrameTotGradDist=0;
+    size_t nFrameTotBadSamplesCount=1;
+    static const size_t nChannelSize = UCHAR_MAX;
+    alignas(16) std::array<float,s_nSampleBlockSize> afSumDist, afGradDist;
+    std::array<uint32_t,4> anRand;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        const uchar* const pnInputRow = oInputImg.ptr<uchar>(y);
+        const uchar* const pnInputGradRow = oInputGradImg.ptr<uchar>(y);
+        uchar* const pnFGMaskRow = oFGMask.ptr<uchar>(y);
+        float* const pfDistThresholdFactorRow = m_oDistThresholdFrame.ptr<float>(y);
+        float* const pfMeanMinDistRow = m_oMeanMinDistFrame.ptr<float>(y);
+        float* const pfLearningRateRow = m_oUpdateRateFrame.ptr<float>(y);
+        uchar* const pnSamplesRow = m_vnBGSamples.data()+size_t(y)*m_oImgSize.width*nPxStride;
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            const uchar* const pnInputPx = pnInputRow+x*nChannels;
+            const uchar* const pnInputGradPx = pnInputGradRow+x*nChannels;
+            uchar* const pnPxSamples = pnSamplesRow+x*nPxStride;
+            float* const pfCurrDistThresholdFactor = pfDistThresholdFactorRow+x;
+            const float fCurrDistThreshold = ((*pfCurrDistThresholdFactor)*m_nDefaultColorDistThreshold);
+            float fMinDist=(float)nChannelSize;
+            size_t nGoodSamplesCount=0;
+            // distances are computed one SIMD block at a time, but scanned in sample order to keep the reference early exit semantics
+            for(size_t nBlockIdx=0; nBlockIdx<m_nSampleStride && nGoodSamplesCount<m_nRequiredBGSamples; nBlockIdx+=s_nSampleBlockSize) {
+                if(nChannels==1)
+                    computeBlockDists_1ch(pnInputPx,pnInputGradPx,pnPxSamples,m_nSampleStride,nBlockIdx,fGradWeight,afSumDist.data(),afGradDist.data(),m_bUseSIMD);
+                else
+                    computeBlockDists_3ch(pnInputPx,pnInputGradPx,pnPxSamples,m_nSampleStride,nBlockIdx,fGradWeight,afSumDist.data(),afGradDist.data(),m_bUseSIMD);
+                const size_t nBlockSamples = std::min(s_nSampleBlockSize,m_nBGSamples-nBlockIdx);
+                for(size_t n=0; n<nBlockSamples && nGoodSamplesCount<m_nRequiredBGSamples; ++n) {
+                    if(afSumDist[n]<=fCurrDistThreshold) {
+                        if(fMinDist>afSumDist[n])
+                            fMinDist = afSumDist[n];
+                        nGoodSamplesCount++;
+                    }
+                    else {
+                        if(nChannels==1)
+                            nFrameTotGradDist += (size_t)afGradDist[n];
+                        else
+                            fFrameTotGradDist += afGradDist[n];
+                        nFrameTotBadSamplesCount++;
+                    }
+                }
+            }
+            float* const pfCurrMeanMinDist = pfMeanMinDistRow+x;
+            *pfCurrMeanMinDist = ((*pfCurrMeanMinDist)*(BGSPBAS_N_SAMPLES_FOR_MEAN-1) + (fMinDist/nChannelSize))/BGSPBAS_N_SAMPLES_FOR_MEAN;
+            float* const pfCurrLearningRate = pfLearningRateRow+x;
+            if(nGoodSamplesCount<m_nRequiredBGSamples) {
+                pnFGMaskRow[x] = UCHAR_MAX;
+                *pfCurrLearningRate += BGSPBAS_T_INCR/((*pfCurrMeanMinDist)*BGSPBAS_T_SCALE+BGSPBAS_T_OFFST);
+                if((*pfCurrLearningRate)>BGSPBAS_T_UPPER)
+                    *pfCurrLearningRate = BGSPBAS_T_UPPER;
+            }
+            else {
+                pnFGMaskRow[x] = 0;
+                const size_t nLearningRate = learningRateOverride>0?(size_t)ceil(learningRateOverride):(size_t)ceil((*pfCurrLearningRate));
+                m_oRandGen.next(anRand);
+                if((anRand[0]%nLearningRate)==0) {
+                    const size_t s_rand = anRand[2]%m_nBGSamples;
+                    for(size_t c=0; c<nChannels; ++c) {
+                        pnPxSamples[c*m_nSampleStride+s_rand] = pnInputPx[c];
+                        pnPxSamples[(nChannels+c)*m_nSampleStride+s_rand] = pnInputGradPx[c];
+                    }
+                }
+                if((anRand[1]%nLearningRate)==0) {
+                    int x_rand,y_rand;
+                    lv::getNeighborPosition_3x3((int)anRand[3],x_rand,y_rand,x,y,0,m_oImgSize);
+                    const size_t s_rand = (anRand[3]>>3)%m_nBGSamples; // low bits already picked the neighbor
+                    uchar* const pnNeighborSamples = m_vnBGSamples.data()+(size_t(y_rand)*m_oImgSize.width+x_rand)*nPxStride;
+#if BGSPBAS_USE_SELF_DIFFUSION
+                    const uchar* const pnNeighborColor = oInputImg.ptr<uchar>(y_rand)+x_rand*nChannels;
+                    const uchar* const pnNeighborGrad = oInputGradImg.ptr<uchar>(y_rand)+x_rand*nChannels;
+#else //(!BGSPBAS_USE_SELF_DIFFUSION)
+                    const uchar* const pnNeighborColor = pnInputPx;
+                    const uchar* const pnNeighborGrad = pnInputGradPx;
+#endif //(!BGSPBAS_USE_SELF_DIFFUSION)
+                    for(size_t c=0; c<nChannels; ++c) {
+                        pnNeighborSamples[c*m_nSampleStride+s_rand] = pnNeighborColor[c];
+                        pnNeighborSamples[(nChannels+c)*m_nSampleStride+s_rand] = pnNeighborGrad[c];
+                    }
+                }
+                *pfCurrLearningRate -= BGSPBAS_T_DECR/((*pfCurrMeanMinDist)*BGSPBAS_T_SCALE+BGSPBAS_T_OFFST);
+                if((*pfCurrLearningRate)<BGSPBAS_T_LOWER)
+                    *pfCurrLearningRate = BGSPBAS_T_LOWER;
+            }
+#if BGSPBAS_USE_R2_ACCELERATION
+            float* const pfCurrDistThresholdVariationFactor = m_oDistThresholdVariationFrame.ptr<float>(y)+x;
+            if((*pfCurrMeanMinDist)>BGSPBAS_R2_OFFST && (pnFGMaskRow[x]!=m_oLastFGMask.ptr<uchar>(y)[x])) {
+                if((*pfCurrDistThresholdVariationFactor)<BGSPBAS_R2_UPPER)
+                    (*pfCurrDistThresholdVariationFactor) += BGSPBAS_R2_INCR;
+            }
+            else {
+                if((*pfCurrDistThresholdVariationFactor)>BGSPBAS_R2_LOWER)
+                    (*pfCurrDistThresholdVariationFactor) -= BGSPBAS_R2_DECR;
+            }
+            if((*pfCurrDistThresholdFactor)<BGSPBAS_R_LOWER+(*pfCurrMeanMinDist)*BGSPBAS_R_SCALE+BGSPBAS_R_OFFST) {
+                if((*pfCurrDistThresholdFactor)<BGSPBAS_R_UPPER)
+                    (*pfCurrDistThresholdFactor) *= BGSPBAS_R_INCR*(*pfCurrDistThresholdVariationFactor);
+            }
+            else if((*pfCurrDistThresholdFactor)>BGSPBAS_R_LOWER)
+                (*pfCurrDistThresholdFactor) *= BGSPBAS_R_DECR*(*pfCurrDistThresholdVariationFactor);
+#else //(!BGSPBAS_USE_R2_ACCELERATION)
+            if((*pfCurrDistThresholdFactor)<BGSPBAS_R_LOWER+(*pfCurrMeanMinDist)*BGSPBAS_R_SCALE+BGSPBAS_R_OFFST) {
+                if((*pfCurrDistThresholdFactor)<BGSPBAS_R_UPPER)
+                    (*pfCurrDistThresholdFactor) *= BGSPBAS_R_INCR;
+            }
+            else if((*pfCurrDistThresholdFactor)>BGSPBAS_R_LOWER)
+                (*pfCurrDistThresholdFactor) *= BGSPBAS_R_DECR;
+#endif //(!BGSPBAS_USE_R2_ACCELERATION)
+        }
+    }
+    m_fFormerMeanGradDist = std::max(((nChannels==1)?(float)nFrameTotGradDist:fFrameTotGradDist)/nFrameTotBadSamplesCount,20.0f);
+#if BGSPBAS_USE_ADVANCED_MORPH_OPS || BGSPBAS_USE_R2_ACCELERATION
+    oFGMask.copyTo(m_oLastFGMask);
+#endif //BGSPBAS_USE_ADVANCED_MORPH_OPS || BGSPBAS_USE_R2_ACCELERATION
+#if BGSPBAS_USE_ADVANCED_MORPH_OPS
+    cv::medianBlur(oFGMask,oFGMask,3);
+    oFGMask.copyTo(m_oFloodedFGMask);
+    cv::dilate(m_oFloodedFGMask,m_oFloodedFGMask,cv::Mat());
+    cv::erode(m_oFloodedFGMask,m_oFloodedFGMask,cv::Mat());
+    cv::floodFill(m_oFloodedFGMask,cv::Point(0,0),255);
+    cv::bitwise_not(m_oFloodedFGMask,m_oFloodedFGMask);
+    cv::bitwise_or(m_oFloodedFGMask,m_oLastFGMask,oFGMask);
+    cv::medianBlur(oFGMask,oFGMask,9);
+#else //(!BGSPBAS_USE_ADVANCED_MORPH_OPS)
+    cv::medianBlur(oFGMask,oFGMask,9);
+#endif //(!BGSPBAS_USE_ADVANCED_MORPH_OPS)
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorPBAS_vec<nChannels>::getBackgroundImage(cv::OutputArray backgroundImage) const {
+    lvAssert(m_bInitialized);
+    backgroundImage.create(m_oImgSize,CV_8UC((int)nChannels));
+    cv::Mat oBGImg = backgroundImage.getMat();
+    const size_t nPxStride = m_nSampleStride*nChannels*2;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        uchar* const pnBGImgRow = oBGImg.ptr<uchar>(y);
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            const uchar* const pnPxSamples = m_vnBGSamples.data()+(size_t(y)*m_oImgSize.width+x)*nPxStride;
+            for(size_t c=0; c<nChannels; ++c) {
+                size_t nSampleSum = 0;
+#if HAVE_SSE2
+                if(m_bUseSIMD) {
+                    for(size_t nBlockIdx=0; nBlockIdx<m_nSampleStride; nBlockIdx+=s_nSampleBlockSize)
+                        nSampleSum += lv::hsum_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+c*m_nSampleStride+nBlockIdx)));
+                }
+                else
+#endif //HAVE_SSE2
+                for(size_t s=0; s<m_nBGSamples; ++s)
+                    nSampleSum += pnPxSamples[c*m_nSampleStride+s];
+                pnBGImgRow[x*nChannels+c] = cv::saturate_cast<uchar>(float(nSampleSum)/m_nBGSamples);
+            }
+        }
+    }
+}
+
+template class BackgroundSubtractorPBAS_vec<1>;
+template class BackgroundSubtractorPBAS_vec<3>;
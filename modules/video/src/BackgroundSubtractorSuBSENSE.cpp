@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorSuBSENSE.hpp"
+#include "litiv/imgproc.hpp"
 
 //
 // NOTE: this version of SuBSENSE is still pretty messy (debug). The cleaner (but older) implementation made available on
@@ -58,10 +59,36 @@ static const size_t s_nColorMaxDataRange_1ch = UCHAR_MAX;
 static const size_t s_nDescMaxDataRange_1ch = LBSP::DESC_SIZE_BITS;
 static const size_t s_nColorMaxDataRange_3ch = s_nColorMaxDataRange_1ch*3;
 static const size_t s_nDescMaxDataRange_3ch = s_nDescMaxDataRange_1ch*3;
+// model snapshot version; must be bumped whenever the list or layout of snapshot blocks changes
+static const uint32_t s_nModelSnapshotVersion = 1;
+// fixed-point scales used to pack adaptive state values in compact state mode (R(x) in [1,16), v(x) in [0.1,1024), T(x) in [1,512), means in [0,1])
+// note: v(x) is unbounded in float mode, and only saturates once packed (after ~1000 net blinking frames); its 1/64 step stays below FEEDBACK_V_DECR/4
+static const std::array<float,8> s_afCompactStateScales = {{4096.0f,64.0f,128.0f,65536.0f,65536.0f,65536.0f,65536.0f,65536.0f}};
 
-BackgroundSubtractorSuBSENSE::BackgroundSubtractorSuBSENSE_(size_t nDescDistThresholdOffset, size_t nMinColorDistThreshold, size_t nBGSamples,
-                                                            size_t nRequiredBGSamples, size_t nSamplesForMovingAvgs, float fRelLBSPThreshold) :
-        IBackgroundSubtractorLBSP(fRelLBSPThreshold),
+// packs a value by rounding to nearest by default; a uniform dither in [0,1) instead gives stochastic rounding
+static inline uint16_t packCompactStateValue(float fVal, float fScale, float fDither=0.5f) {
+    return (uint16_t)std::min(std::max(fVal*fScale+fDither,0.0f),(float)UINT16_MAX);
+}
+
+// returns a uniform dither value in [0,1) which only depends on the pixel, frame & field indices (so results do not depend on thread scheduling)
+static inline float getCompactStateDither(size_t nPxIter, size_t nFrameIdx, size_t nFieldIdx) {
+    uint32_t nHash = uint32_t(nPxIter)*0x9E3779B1u ^ uint32_t(nFrameIdx)*0x85EBCA77u ^ uint32_t(nFieldIdx+1)*0xC2B2AE3Du;
+    nHash ^= nHash>>15;
+    nHash *= 0x2C1B3C6Du;
+    nHash ^= nHash>>12;
+    nHash *= 0x297A2D39u;
+    nHash ^= nHash>>15;
+    return float(nHash>>8)*(1.0f/16777216.0f);
+}
+
+static inline float unpackCompactStateValue(uint16_t nVal, float fScale) {
+    return (float)nVal/fScale;
+}
+
+template<lv::ParallelAlgoType eImpl>
+BackgroundSubtractorSuBSENSE_<eImpl>::BackgroundSubtractorSuBSENSE_(size_t nDescDistThresholdOffset, size_t nMinColorDistThreshold, size_t nBGSamples,
+                                                                    size_t nRequiredBGSamples, size_t nSamplesForMovingAvgs, float fRelLBSPThreshold) :
+        IBackgroundSubtractorLBSP_<eImpl>(fRelLBSPThreshold),
         m_nMinColorDistThreshold(nMinColorDistThreshold),
         m_nDescDistThresholdOffset(nDescDistThresholdOffset),
         m_nBGSamples(nBGSamples),
@@ -71,32 +98,36 @@ BackgroundSubtractorSuBSENSE::BackgroundSubtractorSuBSENSE_(size_t nDescDistThre
         m_bLearningRateScalingEnabled(true),
         m_fCurrLearningRateLowerCap(FEEDBACK_T_LOWER),
         m_fCurrLearningRateUpperCap(FEEDBACK_T_UPPER),
-        m_nMedianBlurKernelSize(m_nDefaultMedianBlurKernelSize),
-        m_bUse3x3Spread(true) {
+        m_nMedianBlurKernelSize(this->m_nDefaultMedianBlurKernelSize),
+        m_bUse3x3Spread(true),
+        m_nParallelBandCount(BGSSUBSENSE_DEFAULT_PARALLEL_BAND_COUNT),
+        m_nParallelSeed(0),
+        m_bUseCompactState(false) {
     lvAssert_(m_nBGSamples>0 && m_nRequiredBGSamples<=m_nBGSamples,"algo cannot require more sample matches than sample count in model");
     lvAssert_(m_nMinColorDistThreshold>0 || m_nDescDistThresholdOffset>0,"distance thresholds must be positive values");
 }
 
-void BackgroundSubtractorSuBSENSE::refreshModel(float fSamplesRefreshFrac, bool bForceFGUpdate) {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::refreshModel(float fSamplesRefreshFrac, bool bForceFGUpdate) {
     // == refresh
-    lvAssert_(m_bInitialized,"algo must be initialized first");
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
     lvAssert_(fSamplesRefreshFrac>0.0f && fSamplesRefreshFrac<=1.0f,"model refresh must be given as a non-null fraction");
-    lvDbgAssert(!m_voBGColorSamples.empty() && !m_voBGColorSamples[0].empty());
+    lvDbgAssert(!m_oBGSamples.empty());
     const size_t nModelSamplesToRefresh = fSamplesRefreshFrac<1.0f?(size_t)(fSamplesRefreshFrac*m_nBGSamples):m_nBGSamples;
     const size_t nRefreshSampleStartPos = fSamplesRefreshFrac<1.0f?rand()%m_nBGSamples:0;
-    const size_t nChannels = m_voBGColorSamples[0].channels();
-    for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-        const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-        if(bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
+    const size_t nChannels = m_oBGSamples.channels();
+    for(size_t nModelIter=0; nModelIter<this->m_nTotRelevantPxCount; ++nModelIter) {
+        const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
+        if(bForceFGUpdate || !this->m_oLastFGMask.data[nPxIter]) {
             for(size_t nCurrModelSampleIdx=nRefreshSampleStartPos; nCurrModelSampleIdx<nRefreshSampleStartPos+nModelSamplesToRefresh; ++nCurrModelSampleIdx) {
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                lv::getSamplePosition_7x7_std2(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,m_voPxInfoLUT[nPxIter].nImgCoord_X,m_voPxInfoLUT[nPxIter].nImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-                if(bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
+                lv::getSamplePosition_7x7_std2(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,this->m_voPxInfoLUT[nPxIter].nImgCoord_X,this->m_voPxInfoLUT[nPxIter].nImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                const size_t nSamplePxIdx = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                if(bForceFGUpdate || !this->m_oLastFGMask.data[nSamplePxIdx]) {
                     const size_t nCurrRealModelSampleIdx = nCurrModelSampleIdx%m_nBGSamples;
                     for(size_t c=0; c<nChannels; ++c) {
-                        m_voBGColorSamples[nCurrRealModelSampleIdx].data[nPxIter*nChannels+c] = m_oLastColorFrame.data[nSamplePxIdx*nChannels+c];
-                        *((ushort*)(m_voBGDescSamples[nCurrRealModelSampleIdx].data+(nPxIter*nChannels+c)*2)) = *((ushort*)(m_oLastDescFrame.data+(nSamplePxIdx*nChannels+c)*2));
+                        m_oBGSamples.color(nCurrRealModelSampleIdx,nPxIter)[c] = this->m_oLastColorFrame.data[nSamplePxIdx*nChannels+c];
+                        m_oBGSamples.desc(nCurrRealModelSampleIdx,nPxIter)[c] = *((ushort*)(this->m_oLastDescFrame.data+(nSamplePxIdx*nChannels+c)*2));
                     }
                 }
             }
@@ -104,254 +135,524 @@ void BackgroundSubtractorSuBSENSE::refreshModel(float fSamplesRefreshFrac, bool
     }
 }
 
-void BackgroundSubtractorSuBSENSE::initialize(const cv::Mat& oInitImg, const cv::Mat& oROI) {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::initialize(const cv::Mat& oInitImg, const cv::Mat& oROI) {
     // == init
-    IBackgroundSubtractorLBSP::initialize_common(oInitImg,oROI);
+    syncPostProcessing();
+    IBackgroundSubtractorLBSP_<eImpl>::initialize_common(oInitImg,oROI);
     m_fLastNonZeroDescRatio = 0.0f;
-    const int nTotImgPixels = m_oImgSize.height*m_oImgSize.width;
-    if(m_nOrigROIPxCount>=m_nTotPxCount/2 && (int)m_nTotPxCount>=DEFAULT_FRAME_SIZE.area()) {
+    const int nTotImgPixels = this->m_oImgSize.height*this->m_oImgSize.width;
+    if(this->m_nOrigROIPxCount>=this->m_nTotPxCount/2 && (int)this->m_nTotPxCount>=DEFAULT_FRAME_SIZE.area()) {
         m_bLearningRateScalingEnabled = true;
-        m_bAutoModelResetEnabled = true;
+        this->m_bAutoModelResetEnabled = true;
         m_bUse3x3Spread = !(nTotImgPixels>DEFAULT_FRAME_SIZE.area()*2);
-        const int nRawMedianBlurKernelSize = std::min((int)floor((float)nTotImgPixels/DEFAULT_FRAME_SIZE.area()+0.5f)+m_nDefaultMedianBlurKernelSize,14);
+        const int nRawMedianBlurKernelSize = std::min((int)floor((float)nTotImgPixels/DEFAULT_FRAME_SIZE.area()+0.5f)+this->m_nDefaultMedianBlurKernelSize,14);
         m_nMedianBlurKernelSize = (nRawMedianBlurKernelSize%2)?nRawMedianBlurKernelSize:nRawMedianBlurKernelSize-1;
         m_fCurrLearningRateLowerCap = FEEDBACK_T_LOWER;
         m_fCurrLearningRateUpperCap = FEEDBACK_T_UPPER;
     }
     else {
         m_bLearningRateScalingEnabled = false;
-        m_bAutoModelResetEnabled = false;
+        this->m_bAutoModelResetEnabled = false;
         m_bUse3x3Spread = true;
-        m_nMedianBlurKernelSize = m_nDefaultMedianBlurKernelSize;
+        m_nMedianBlurKernelSize = this->m_nDefaultMedianBlurKernelSize;
         m_fCurrLearningRateLowerCap = FEEDBACK_T_LOWER*2;
         m_fCurrLearningRateUpperCap = FEEDBACK_T_UPPER*2;
     }
-    m_oUpdateRateFrame.create(m_oImgSize,CV_32FC1);
+    m_oUpdateRateFrame.create(this->m_oImgSize,CV_32FC1);
     m_oUpdateRateFrame = cv::Scalar(m_fCurrLearningRateLowerCap);
-    m_oDistThresholdFrame.create(m_oImgSize,CV_32FC1);
+    m_oDistThresholdFrame.create(this->m_oImgSize,CV_32FC1);
     m_oDistThresholdFrame = cv::Scalar(1.0f);
-    m_oVariationModulatorFrame.create(m_oImgSize,CV_32FC1);
+    m_oVariationModulatorFrame.create(this->m_oImgSize,CV_32FC1);
     m_oVariationModulatorFrame = cv::Scalar(10.0f); // should always be >= FEEDBACK_V_DECR
-    m_oMeanLastDistFrame.create(m_oImgSize,CV_32FC1);
+    m_oMeanLastDistFrame.create(this->m_oImgSize,CV_32FC1);
     m_oMeanLastDistFrame = cv::Scalar(0.0f);
-    m_oMeanMinDistFrame_LT.create(m_oImgSize,CV_32FC1);
+    m_oMeanMinDistFrame_LT.create(this->m_oImgSize,CV_32FC1);
     m_oMeanMinDistFrame_LT = cv::Scalar(0.0f);
-    m_oMeanMinDistFrame_ST.create(m_oImgSize,CV_32FC1);
+    m_oMeanMinDistFrame_ST.create(this->m_oImgSize,CV_32FC1);
     m_oMeanMinDistFrame_ST = cv::Scalar(0.0f);
-    m_oDownSampledFrameSize = cv::Size(m_oImgSize.width/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO,m_oImgSize.height/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO);
-    m_oMeanDownSampledLastDistFrame_LT.create(m_oDownSampledFrameSize,CV_32FC((int)m_nImgChannels));
+    m_oDownSampledFrameSize = cv::Size(this->m_oImgSize.width/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO,this->m_oImgSize.height/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO);
+    m_oMeanDownSampledLastDistFrame_LT.create(m_oDownSampledFrameSize,CV_32FC((int)this->m_nImgChannels));
     m_oMeanDownSampledLastDistFrame_LT = cv::Scalar(0.0f);
-    m_oMeanDownSampledLastDistFrame_ST.create(m_oDownSampledFrameSize,CV_32FC((int)m_nImgChannels));
+    m_oMeanDownSampledLastDistFrame_ST.create(m_oDownSampledFrameSize,CV_32FC((int)this->m_nImgChannels));
     m_oMeanDownSampledLastDistFrame_ST = cv::Scalar(0.0f);
-    m_oMeanRawSegmResFrame_LT.create(m_oImgSize,CV_32FC1);
+    m_oMeanRawSegmResFrame_LT.create(this->m_oImgSize,CV_32FC1);
     m_oMeanRawSegmResFrame_LT = cv::Scalar(0.0f);
-    m_oMeanRawSegmResFrame_ST.create(m_oImgSize,CV_32FC1);
+    m_oMeanRawSegmResFrame_ST.create(this->m_oImgSize,CV_32FC1);
     m_oMeanRawSegmResFrame_ST = cv::Scalar(0.0f);
-    m_oMeanFinalSegmResFrame_LT.create(m_oImgSize,CV_32FC1);
+    m_oMeanFinalSegmResFrame_LT.create(this->m_oImgSize,CV_32FC1);
     m_oMeanFinalSegmResFrame_LT = cv::Scalar(0.0f);
-    m_oMeanFinalSegmResFrame_ST.create(m_oImgSize,CV_32FC1);
+    m_oMeanFinalSegmResFrame_ST.create(this->m_oImgSize,CV_32FC1);
     m_oMeanFinalSegmResFrame_ST = cv::Scalar(0.0f);
-    m_oUnstableRegionMask.create(m_oImgSize,CV_8UC1);
+    m_oUnstableRegionMask.create(this->m_oImgSize,CV_8UC1);
     m_oUnstableRegionMask = cv::Scalar_<uchar>(0);
-    m_oBlinksFrame.create(m_oImgSize,CV_8UC1);
+    m_oBlinksFrame.create(this->m_oImgSize,CV_8UC1);
     m_oBlinksFrame = cv::Scalar_<uchar>(0);
-    m_oDownSampledFrame_MotionAnalysis.create(m_oDownSampledFrameSize,CV_8UC((int)m_nImgChannels));
+    m_oDownSampledFrame_MotionAnalysis.create(m_oDownSampledFrameSize,CV_8UC((int)this->m_nImgChannels));
     m_oDownSampledFrame_MotionAnalysis = cv::Scalar_<uchar>::all(0);
-    m_oLastRawFGMask.create(m_oImgSize,CV_8UC1);
+    m_oLastRawFGMask.create(this->m_oImgSize,CV_8UC1);
     m_oLastRawFGMask = cv::Scalar_<uchar>(0);
-    m_oLastFGMask_dilated.create(m_oImgSize,CV_8UC1);
+    m_oLastFGMask_dilated.create(this->m_oImgSize,CV_8UC1);
     m_oLastFGMask_dilated = cv::Scalar_<uchar>(0);
-    m_oLastFGMask_dilated_inverted.create(m_oImgSize,CV_8UC1);
+    m_oLastFGMask_dilated_inverted.create(this->m_oImgSize,CV_8UC1);
     m_oLastFGMask_dilated_inverted = cv::Scalar_<uchar>(0);
-    m_oFGMask_FloodedHoles.create(m_oImgSize,CV_8UC1);
+    m_oFGMask_FloodedHoles.create(this->m_oImgSize,CV_8UC1);
     m_oFGMask_FloodedHoles = cv::Scalar_<uchar>(0);
-    m_oFGMask_PreFlood.create(m_oImgSize,CV_8UC1);
+    m_oFGMask_PreFlood.create(this->m_oImgSize,CV_8UC1);
     m_oFGMask_PreFlood = cv::Scalar_<uchar>(0);
-    m_oCurrRawFGBlinkMask.create(m_oImgSize,CV_8UC1);
+    m_oCurrRawFGBlinkMask.create(this->m_oImgSize,CV_8UC1);
     m_oCurrRawFGBlinkMask = cv::Scalar_<uchar>(0);
-    m_oLastRawFGBlinkMask.create(m_oImgSize,CV_8UC1);
+    m_oLastRawFGBlinkMask.create(this->m_oImgSize,CV_8UC1);
     m_oLastRawFGBlinkMask = cv::Scalar_<uchar>(0);
     m_oMorphExStructElement = cv::getStructuringElement(cv::MORPH_RECT,cv::Size(3,3));
-    m_voBGColorSamples.resize(m_nBGSamples);
-    m_voBGDescSamples.resize(m_nBGSamples);
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        m_voBGColorSamples[s].create(m_oImgSize,CV_8UC((int)m_nImgChannels));
-        m_voBGColorSamples[s] = cv::Scalar_<uchar>::all(0);
-        m_voBGDescSamples[s].create(m_oImgSize,CV_16UC((int)m_nImgChannels));
-        m_voBGDescSamples[s] = cv::Scalar_<ushort>::all(0);
-    }
-    m_bInitialized = true;
+    m_oBGSamples.create(this->m_eSampleLayout,m_nBGSamples,this->m_oImgSize,this->m_nImgChannels);
+    if(m_bUseCompactState)
+        packCompactState();
+    initParallelBands();
+    this->m_bInitialized = true;
     refreshModel(1.0f);
-    m_bModelInitialized = true;
+    if(m_pPostProcWorker)
+        resetPostProcessing();
+    this->m_bModelInitialized = true;
 }
 
-void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
-    // == process
-    lvAssert_(m_bInitialized && m_bModelInitialized,"algo & model must be initialized first");
-    cv::Mat oInputImg = _image.getMat();
-    lvAssert_(oInputImg.type()==m_nImgType && oInputImg.size()==m_oImgSize,"input image type/size mismatch with initialization type/size");
-    lvAssert_(oInputImg.isContinuous(),"input image data must be continuous");
-    _fgmask.create(m_oImgSize,CV_8UC1);
-    cv::Mat oCurrFGMask = _fgmask.getMat();
-    memset(oCurrFGMask.data,0,oCurrFGMask.cols*oCurrFGMask.rows);
-    size_t nNonZeroDescCount = 0;
-    const float fRollAvgFactor_LT = 1.0f/std::min(++m_nFrameIdx,m_nSamplesForMovingAvgs);
-    const float fRollAvgFactor_ST = 1.0f/std::min(m_nFrameIdx,m_nSamplesForMovingAvgs/4);
-    if(m_nImgChannels==1) {
-        for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-            const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
+template<lv::ParallelAlgoType eImpl>
+std::vector<std::pair<const char*,cv::Mat*>> BackgroundSubtractorSuBSENSE_<eImpl>::getModelStateMaps() {
+    return {
+        {"oUpdateRateFrame",&m_oUpdateRateFrame},
+        {"oDistThresholdFrame",&m_oDistThresholdFrame},
+        {"oVariationModulatorFrame",&m_oVariationModulatorFrame},
+        {"oMeanLastDistFrame",&m_oMeanLastDistFrame},
+        {"oMeanMinDistFrame_LT",&m_oMeanMinDistFrame_LT},
+        {"oMeanMinDistFrame_ST",&m_oMeanMinDistFrame_ST},
+        {"oMeanDSLastDistFrame_LT",&m_oMeanDownSampledLastDistFrame_LT},
+        {"oMeanDSLastDistFrame_ST",&m_oMeanDownSampledLastDistFrame_ST},
+        {"oMeanRawSegmResFrame_LT",&m_oMeanRawSegmResFrame_LT},
+        {"oMeanRawSegmResFrame_ST",&m_oMeanRawSegmResFrame_ST},
+        {"oMeanFinalSegmResFrame_LT",&m_oMeanFinalSegmResFrame_LT},
+        {"oMeanFinalSegmResFrame_ST",&m_oMeanFinalSegmResFrame_ST},
+        {"oUnstableRegionMask",&m_oUnstableRegionMask},
+        {"oBlinksFrame",&m_oBlinksFrame},
+        {"oDSFrame_MotionAnalysis",&m_oDownSampledFrame_MotionAnalysis},
+        {"oLastRawFGMask",&m_oLastRawFGMask},
+        {"oLastFGMask_dilated",&m_oLastFGMask_dilated},
+        {"oLastFGMask_dilated_inv",&m_oLastFGMask_dilated_inverted},
+        {"oCurrRawFGBlinkMask",&m_oCurrRawFGBlinkMask},
+        {"oLastRawFGBlinkMask",&m_oLastRawFGBlinkMask},
+    };
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::saveModel(const std::string& sFilePath) const {
+    lvAssert_(!m_oPostProcJobResult.valid(),"pending post-processing must be flushed via 'flushPipeline' before saving the model");
+    BackgroundModelSnapshot oSnapshot("SuBSENSE",s_nModelSnapshotVersion);
+    IBackgroundSubtractorLBSP_<eImpl>::saveModel_common(oSnapshot);
+    oSnapshot.addValue("anParams",std::array<uint64_t,5>{uint64_t(m_nMinColorDistThreshold),uint64_t(m_nDescDistThresholdOffset),uint64_t(m_nBGSamples),uint64_t(m_nRequiredBGSamples),uint64_t(m_nSamplesForMovingAvgs)});
+    oSnapshot.addValue("fLastNonZeroDescRatio",m_fLastNonZeroDescRatio);
+    oSnapshot.addValue("bLearningRateScaling",m_bLearningRateScalingEnabled);
+    oSnapshot.addValue("afLearningRateCaps",std::array<float,2>{m_fCurrLearningRateLowerCap,m_fCurrLearningRateUpperCap});
+    oSnapshot.addValue("nMedianBlurKernelSize",int32_t(m_nMedianBlurKernelSize));
+    oSnapshot.addValue("bUse3x3Spread",m_bUse3x3Spread);
+    oSnapshot.addValue("nSampleLayout",int32_t(m_oBGSamples.layout()));
+    oSnapshot.addBlock("oBGSamples",m_oBGSamples.data(),m_oBGSamples.size());
+    // snapshots always hold the full-precision maps; in compact state mode, these are only refreshed here
+    if(m_bUseCompactState)
+        const_cast<BackgroundSubtractorSuBSENSE_*>(this)->unpackCompactState();
+    for(const auto& oMap : const_cast<BackgroundSubtractorSuBSENSE_*>(this)->getModelStateMaps())
+        oSnapshot.addMat(oMap.first,*oMap.second);
+    oSnapshot.write(sFilePath);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::loadModel(const std::string& sFilePath) {
+    syncPostProcessing();
+    const BackgroundModelSnapshot oSnapshot = BackgroundModelSnapshot::open(sFilePath,"SuBSENSE",s_nModelSnapshotVersion);
+    const std::array<uint64_t,5> anParams = oSnapshot.getValue<std::array<uint64_t,5>>("anParams");
+    lvAssert_(anParams==(std::array<uint64_t,5>{uint64_t(m_nMinColorDistThreshold),uint64_t(m_nDescDistThresholdOffset),uint64_t(m_nBGSamples),uint64_t(m_nRequiredBGSamples),uint64_t(m_nSamplesForMovingAvgs)}),
+              "snapshot was created with different algorithm params");
+    IBackgroundSubtractorLBSP_<eImpl>::loadModel_common(oSnapshot);
+    m_fLastNonZeroDescRatio = oSnapshot.getValue<float>("fLastNonZeroDescRatio");
+    m_bLearningRateScalingEnabled = oSnapshot.getValue<bool>("bLearningRateScaling");
+    const std::array<float,2> afLearningRateCaps = oSnapshot.getValue<std::array<float,2>>("afLearningRateCaps");
+    m_fCurrLearningRateLowerCap = afLearningRateCaps[0];
+    m_fCurrLearningRateUpperCap = afLearningRateCaps[1];
+    m_nMedianBlurKernelSize = (int)oSnapshot.getValue<int32_t>("nMedianBlurKernelSize");
+    m_bUse3x3Spread = oSnapshot.getValue<bool>("bUse3x3Spread");
+    m_oDownSampledFrameSize = cv::Size(this->m_oImgSize.width/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO,this->m_oImgSize.height/FRAMELEVEL_ANALYSIS_DOWNSAMPLE_RATIO);
+    for(const auto& oMap : getModelStateMaps()) {
+        *oMap.second = oSnapshot.getMat(oMap.first).clone();
+        lvAssert__(oMap.second->size()==this->m_oImgSize || oMap.second->size()==m_oDownSampledFrameSize,"snapshot map '%s' has bad size",oMap.first);
+    }
+    m_oFGMask_PreFlood.create(this->m_oImgSize,CV_8UC1);
+    m_oFGMask_FloodedHoles.create(this->m_oImgSize,CV_8UC1);
+    m_oMorphExStructElement = cv::getStructuringElement(cv::MORPH_RECT,cv::Size(3,3));
+    const LBSPSampleStore::Layout eSampleLayout = (LBSPSampleStore::Layout)oSnapshot.getValue<int32_t>("nSampleLayout");
+    lvAssert_(eSampleLayout==LBSPSampleStore::SampleMajor || eSampleLayout==LBSPSampleStore::PixelMajor,"snapshot contains bad sample layout");
+    this->m_eSampleLayout = eSampleLayout;
+    const size_t nSampleDataSize = oSnapshot.getBlockSize("oBGSamples");
+    m_oBGSamples.wrap(eSampleLayout,m_nBGSamples,this->m_oImgSize,this->m_nImgChannels,oSnapshot.getBlock("oBGSamples",nSampleDataSize),nSampleDataSize,oSnapshot.getMapping());
+    if(m_bUseCompactState)
+        packCompactState();
+    initParallelBands();
+    if(m_pPostProcWorker)
+        resetPostProcessing();
+    this->m_bInitialized = true;
+    this->m_bModelInitialized = true;
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::setCompactStateMode(bool bUseCompactState) {
+    if(this->m_bInitialized && bUseCompactState!=m_bUseCompactState) {
+        if(bUseCompactState)
+            packCompactState();
+        else
+            unpackCompactState();
+    }
+    m_bUseCompactState = bUseCompactState;
+    if(!m_bUseCompactState)
+        std::vector<CompactPxState>().swap(m_voCompactState);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::setPipelinedPostProcessing(bool bUsePipelinedPostProc) {
+    if(!bUsePipelinedPostProc) {
+        syncPostProcessing();
+        m_pPostProcWorker.reset();
+    }
+    else if(!m_pPostProcWorker) {
+        m_pPostProcWorker = std::make_unique<lv::WorkerPool<1>>();
+        if(this->m_bInitialized)
+            resetPostProcessing();
+    }
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::flushPipeline(cv::OutputArray fgmask) {
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
+    syncPostProcessing();
+    this->m_oLastFGMask.copyTo(fgmask);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::syncPostProcessing() {
+    if(!m_oPostProcJobResult.valid())
+        return;
+    m_oPostProcJobResult.get(); // rethrows worker exceptions, if any
+    m_oPostProcLastFGMask.copyTo(this->m_oLastFGMask);
+    m_oPostProcBlinksFrame.copyTo(m_oBlinksFrame);
+    m_oPostProcMeanFinalSegmResFrame_LT.copyTo(m_oMeanFinalSegmResFrame_LT);
+    m_oPostProcMeanFinalSegmResFrame_ST.copyTo(m_oMeanFinalSegmResFrame_ST);
+    std::swap(m_voPostProcBlobs,this->m_voLatestBlobs);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::resetPostProcessing() {
+    lvDbgAssert(!m_oPostProcJobResult.valid());
+    this->m_oLastFGMask.copyTo(m_oPostProcLastFGMask);
+    m_oBlinksFrame.copyTo(m_oPostProcBlinksFrame);
+    m_oMeanFinalSegmResFrame_LT.copyTo(m_oPostProcMeanFinalSegmResFrame_LT);
+    m_oMeanFinalSegmResFrame_ST.copyTo(m_oPostProcMeanFinalSegmResFrame_ST);
+    m_oPostProcFGMask.create(this->m_oImgSize,CV_8UC1);
+}
+
+template<lv::ParallelAlgoType eImpl>
+std::array<cv::Mat*,BackgroundSubtractorSuBSENSE_<eImpl>::CompactStateFieldCount> BackgroundSubtractorSuBSENSE_<eImpl>::getCompactStateMaps() {
+    static_assert(size_t(CompactStateFieldCount)==std::tuple_size<decltype(s_afCompactStateScales)>::value,"compact state scale LUT size mismatch");
+    return {{
+        &m_oDistThresholdFrame,
+        &m_oVariationModulatorFrame,
+        &m_oUpdateRateFrame,
+        &m_oMeanLastDistFrame,
+        &m_oMeanMinDistFrame_LT,
+        &m_oMeanMinDistFrame_ST,
+        &m_oMeanRawSegmResFrame_LT,
+        &m_oMeanRawSegmResFrame_ST,
+    }};
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::packCompactState() {
+    const std::array<cv::Mat*,CompactStateFieldCount> apMaps = getCompactStateMaps();
+    m_voCompactState.resize(this->m_nTotPxCount);
+    for(size_t nFieldIdx=0; nFieldIdx<CompactStateFieldCount; ++nFieldIdx) {
+        lvAssert_(apMaps[nFieldIdx]->type()==CV_32FC1 && apMaps[nFieldIdx]->total()==this->m_nTotPxCount && apMaps[nFieldIdx]->isContinuous(),"bad state map for packing");
+        const float* pfMapData = (float*)apMaps[nFieldIdx]->data;
+        for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter)
+            m_voCompactState[nPxIter].anVals[nFieldIdx] = packCompactStateValue(pfMapData[nPxIter],s_afCompactStateScales[nFieldIdx]);
+    }
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::unpackCompactState() {
+    lvAssert_(m_voCompactState.size()==this->m_nTotPxCount,"compact state array must be initialized first");
+    const std::array<cv::Mat*,CompactStateFieldCount> apMaps = getCompactStateMaps();
+    for(size_t nFieldIdx=0; nFieldIdx<CompactStateFieldCount; ++nFieldIdx) {
+        float* pfMapData = (float*)apMaps[nFieldIdx]->data;
+        for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter)
+            pfMapData[nPxIter] = unpackCompactStateValue(m_voCompactState[nPxIter].anVals[nFieldIdx],s_afCompactStateScales[nFieldIdx]);
+    }
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::decaySkippedFrameState(float fRollAvgFactor_LT, float fRollAvgFactor_ST) {
+    static const std::array<std::pair<CompactStateField,bool>,5> s_aeDecayedFields = {{
+        {CompactState_MeanLastDist,false},
+        {CompactState_MeanMinDist_LT,true},
+        {CompactState_MeanMinDist_ST,false},
+        {CompactState_MeanRawSegmRes_LT,true},
+        {CompactState_MeanRawSegmRes_ST,false},
+    }};
+    if(m_bUseCompactState) {
+        // the full-precision maps are stale in compact state mode, so the packed values are decayed in place (with the same dithering as regular updates)
+        for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
+            CompactPxState& oState = m_voCompactState[nPxIter];
+            for(const auto& oField : s_aeDecayedFields) {
+                const float fScale = s_afCompactStateScales[oField.first];
+                const float fDecay = 1.0f-(oField.second?fRollAvgFactor_LT:fRollAvgFactor_ST);
+                oState.anVals[oField.first] = packCompactStateValue(unpackCompactStateValue(oState.anVals[oField.first],fScale)*fDecay,fScale,getCompactStateDither(nPxIter,this->m_nFrameIdx,oField.first));
+            }
+        }
+        return;
+    }
+    const std::array<cv::Mat*,CompactStateFieldCount> apMaps = getCompactStateMaps();
+    for(const auto& oField : s_aeDecayedFields)
+        *apMaps[oField.first] *= 1.0f-(oField.second?fRollAvgFactor_LT:fRollAvgFactor_ST);
+}
+
+template<lv::ParallelAlgoType eImpl>
+inline std::array<float*,BackgroundSubtractorSuBSENSE_<eImpl>::CompactStateFieldCount> BackgroundSubtractorSuBSENSE_<eImpl>::getPxStatePtrs(size_t nPxIter, std::array<float,CompactStateFieldCount>& afCompactStateBuffer) {
+    if(m_bUseCompactState) {
+        const CompactPxState& oState = m_voCompactState[nPxIter];
+        std::array<float*,CompactStateFieldCount> apfState;
+        for(size_t nFieldIdx=0; nFieldIdx<CompactStateFieldCount; ++nFieldIdx) {
+            afCompactStateBuffer[nFieldIdx] = unpackCompactStateValue(oState.anVals[nFieldIdx],s_afCompactStateScales[nFieldIdx]);
+            apfState[nFieldIdx] = &afCompactStateBuffer[nFieldIdx];
+        }
+        return apfState;
+    }
+    const size_t nFloatIter = nPxIter*4;
+    return {{
+        (float*)(m_oDistThresholdFrame.data+nFloatIter),
+        (float*)(m_oVariationModulatorFrame.data+nFloatIter),
+        (float*)(m_oUpdateRateFrame.data+nFloatIter),
+        (float*)(m_oMeanLastDistFrame.data+nFloatIter),
+        (float*)(m_oMeanMinDistFrame_LT.data+nFloatIter),
+        (float*)(m_oMeanMinDistFrame_ST.data+nFloatIter),
+        (float*)(m_oMeanRawSegmResFrame_LT.data+nFloatIter),
+        (float*)(m_oMeanRawSegmResFrame_ST.data+nFloatIter),
+    }};
+}
+
+template<lv::ParallelAlgoType eImpl>
+inline void BackgroundSubtractorSuBSENSE_<eImpl>::storePxState(size_t nPxIter, size_t nFrameIdx, const std::array<float,CompactStateFieldCount>& afCompactStateBuffer) {
+    CompactPxState& oState = m_voCompactState[nPxIter];
+    // stochastic rounding keeps per-frame updates smaller than a quantization step (e.g. R(x) decrements when v(x) is large) from vanishing
+    for(size_t nFieldIdx=0; nFieldIdx<CompactStateFieldCount; ++nFieldIdx)
+        oState.anVals[nFieldIdx] = packCompactStateValue(afCompactStateBuffer[nFieldIdx],s_afCompactStateScales[nFieldIdx],getCompactStateDither(nPxIter,nFrameIdx,nFieldIdx));
+}
+
+template<lv::ParallelAlgoType eImpl>
+inline float BackgroundSubtractorSuBSENSE_<eImpl>::getPxStateValue(size_t nPxIdx, CompactStateField eField, const cv::Mat& oMap) const {
+    return m_bUseCompactState?unpackCompactStateValue(m_voCompactState[nPxIdx].anVals[eField],s_afCompactStateScales[eField]):((const float*)oMap.data)[nPxIdx];
+}
+
+template<lv::ParallelAlgoType eImpl>
+template<typename TRandGen>
+void BackgroundSubtractorSuBSENSE_<eImpl>::apply_band(const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, ParallelBandInfo& oBand, TRandGen&& lRand, bool bDeferCrossBandSpread,
+                                                      float fRollAvgFactor_LT, float fRollAvgFactor_ST, double learningRateOverride, size_t nFrameIdx) {
+    lvBGSStatsOnly(BackgroundSubtractorStats::PxLoopTimer oLoopTimer;)
+    if(this->m_nImgChannels==1) {
+        for(const size_t nModelIter : oBand.oModelIters) {
+            const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
             const size_t nDescIter = nPxIter*2;
+            if(!this->isPxActive(nPxIter)) {
+                // quiet block; model & state updates are deferred to the block's next refresh (which accounts for the skipped frames), and the last descriptor stands in for the current one
+                if(lv::popcount(*((ushort*)(this->m_oLastDescFrame.data+nDescIter)))>=2)
+                    ++oBand.nNonZeroDescCount;
+                lvBGSStatsOnly(++oBand.oStats.nGatedPixels;)
+                continue;
+            }
+            lvBGSStatsOnly(oLoopTimer.beginPx(nModelIter);)
+            // a refreshed block catches up on the frames it skipped while gated: rolling averages & feedback loops advance once per covered frame, and sample updates get likelier
+            const size_t nPxFrameCount = this->getPxGatedFrameCount(nPxIter);
+            const float fPxRollAvgFactor_LT = (nPxFrameCount>1)?1.0f-std::pow(1.0f-fRollAvgFactor_LT,(float)nPxFrameCount):fRollAvgFactor_LT;
+            const float fPxRollAvgFactor_ST = (nPxFrameCount>1)?1.0f-std::pow(1.0f-fRollAvgFactor_ST,(float)nPxFrameCount):fRollAvgFactor_ST;
             const size_t nFloatIter = nPxIter*4;
-            const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
+            const int nCurrImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
+            const int nCurrImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const uchar nCurrColor = oInputImg.data[nPxIter];
             size_t nMinDescDist = s_nDescMaxDataRange_1ch;
             size_t nMinSumDist = s_nColorMaxDataRange_1ch;
-            float* pfCurrDistThresholdFactor = (float*)(m_oDistThresholdFrame.data+nFloatIter);
-            float* pfCurrVariationFactor = (float*)(m_oVariationModulatorFrame.data+nFloatIter);
-            float* pfCurrLearningRate = ((float*)(m_oUpdateRateFrame.data+nFloatIter));
-            float* pfCurrMeanLastDist = ((float*)(m_oMeanLastDistFrame.data+nFloatIter));
-            float* pfCurrMeanMinDist_LT = ((float*)(m_oMeanMinDistFrame_LT.data+nFloatIter));
-            float* pfCurrMeanMinDist_ST = ((float*)(m_oMeanMinDistFrame_ST.data+nFloatIter));
-            float* pfCurrMeanRawSegmRes_LT = ((float*)(m_oMeanRawSegmResFrame_LT.data+nFloatIter));
-            float* pfCurrMeanRawSegmRes_ST = ((float*)(m_oMeanRawSegmResFrame_ST.data+nFloatIter));
+            std::array<float,CompactStateFieldCount> afCurrCompactState;
+            const std::array<float*,CompactStateFieldCount> apfCurrState = getPxStatePtrs(nPxIter,afCurrCompactState);
+            float* pfCurrDistThresholdFactor = apfCurrState[CompactState_DistThreshold];
+            float* pfCurrVariationFactor = apfCurrState[CompactState_VariationModulator];
+            float* pfCurrLearningRate = apfCurrState[CompactState_UpdateRate];
+            float* pfCurrMeanLastDist = apfCurrState[CompactState_MeanLastDist];
+            float* pfCurrMeanMinDist_LT = apfCurrState[CompactState_MeanMinDist_LT];
+            float* pfCurrMeanMinDist_ST = apfCurrState[CompactState_MeanMinDist_ST];
+            float* pfCurrMeanRawSegmRes_LT = apfCurrState[CompactState_MeanRawSegmRes_LT];
+            float* pfCurrMeanRawSegmRes_ST = apfCurrState[CompactState_MeanRawSegmRes_ST];
             float* pfCurrMeanFinalSegmRes_LT = ((float*)(m_oMeanFinalSegmResFrame_LT.data+nFloatIter));
             float* pfCurrMeanFinalSegmRes_ST = ((float*)(m_oMeanFinalSegmResFrame_ST.data+nFloatIter));
-            ushort& nLastIntraDesc = *((ushort*)(m_oLastDescFrame.data+nDescIter));
-            uchar& nLastColor = m_oLastColorFrame.data[nPxIter];
+            ushort& nLastIntraDesc = *((ushort*)(this->m_oLastDescFrame.data+nDescIter));
+            uchar& nLastColor = this->m_oLastColorFrame.data[nPxIter];
             const size_t nCurrColorDistThreshold = (size_t)(((*pfCurrDistThresholdFactor)*m_nMinColorDistThreshold)-((!m_oUnstableRegionMask.data[nPxIter])*STAB_COLOR_DIST_OFFSET))/2;
             const size_t nCurrDescDistThreshold = ((size_t)1<<((size_t)floor(*pfCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(m_oUnstableRegionMask.data[nPxIter]*UNSTAB_DESC_DIST_OFFSET);
             alignas(16) std::array<uchar,LBSP::DESC_SIZE_BITS> anLBSPLookupVals;
             LBSP::computeDescriptor_lookup<1>(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,0,anLBSPLookupVals);
-            const ushort nCurrIntraDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,m_anLBSPThreshold_8bitLUT[nCurrColor]);
+            const ushort nCurrIntraDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nCurrColor,this->m_anLBSPThreshold_8bitLUT[nCurrColor]);
             m_oUnstableRegionMask.data[nPxIter] = ((*pfCurrDistThresholdFactor)>UNSTABLE_REG_RDIST_MIN || (*pfCurrMeanRawSegmRes_LT-*pfCurrMeanFinalSegmRes_LT)>UNSTABLE_REG_RATIO_MIN || (*pfCurrMeanRawSegmRes_ST-*pfCurrMeanFinalSegmRes_ST)>UNSTABLE_REG_RATIO_MIN)?1:0;
-            size_t nGoodSamplesCount=0, nSampleIdx=0;
-            while(nGoodSamplesCount<m_nRequiredBGSamples && nSampleIdx<m_nBGSamples) {
-                const uchar& nBGColor = m_voBGColorSamples[nSampleIdx].data[nPxIter];
-                {
-                    const size_t nColorDist = lv::L1dist(nCurrColor,nBGColor);
-                    if(nColorDist>nCurrColorDistThreshold)
-                        goto failedcheck1ch;
-                    const ushort& nBGIntraDesc = *((ushort*)(m_voBGDescSamples[nSampleIdx].data+nDescIter));
-                    const size_t nIntraDescDist = lv::hdist(nCurrIntraDesc,nBGIntraDesc);
-                    const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(anLBSPLookupVals,nBGColor,m_anLBSPThreshold_8bitLUT[nBGColor]);
-                    const size_t nInterDescDist = lv::hdist(nCurrInterDesc,nBGIntraDesc);
-                    const size_t nDescDist = (nIntraDescDist+nInterDescDist)/2;
-                    if(nDescDist>nCurrDescDistThreshold)
-                        goto failedcheck1ch;
-                    const size_t nSumDist = std::min((nDescDist/4)*(s_nColorMaxDataRange_1ch/s_nDescMaxDataRange_1ch)+nColorDist,s_nColorMaxDataRange_1ch);
-                    if(nSumDist>nCurrColorDistThreshold)
-                        goto failedcheck1ch;
-                    if(nMinDescDist>nDescDist)
-                        nMinDescDist = nDescDist;
-                    if(nMinSumDist>nSumDist)
-                        nMinSumDist = nSumDist;
-                    nGoodSamplesCount++;
+            // sum dist = min((desc dist/4)*(color range/desc range)+color dist,color range), checked against the color dist threshold
+            const LBSPSampleMatcher::Thresholds oMatchThresholds = {nCurrColorDistThreshold,nCurrDescDistThreshold,nCurrColorDistThreshold,SIZE_MAX,SIZE_MAX,true,2};
+            size_t nGoodSamplesCount=0;
+            LBSPSampleMatcher::MatchReorderer oReorderer;
+            for(size_t nSampleIdx=0; nGoodSamplesCount<m_nRequiredBGSamples && nSampleIdx<m_nBGSamples; nSampleIdx+=LBSPSampleMatcher::getBatchSize(nSampleIdx,m_nBGSamples)) {
+                const size_t nBatchSize = LBSPSampleMatcher::getBatchSize(nSampleIdx,m_nBGSamples);
+                std::array<ushort,LBSPSampleMatcher::s_nBatchSize> anDescDist,anSumDist;
+                uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<1>(m_oBGSamples,nPxIter,nSampleIdx,nBatchSize,&nCurrColor,&nCurrIntraDesc,anLBSPLookupVals.data(),this->m_anLBSPThreshold_8bitLUT.data(),oMatchThresholds,anDescDist.data(),anSumDist.data());
+                lvBGSStatsOnly(oBand.oStats.nTestedSamples += LBSPSampleMatcher::getTestedCount(nGoodMask,nBatchSize,m_nRequiredBGSamples-nGoodSamplesCount);)
+                if(this->m_bUseSampleReordering)
+                    oReorderer.addBatch(nSampleIdx,nGoodMask);
+                for(size_t nBatchIdx=0; nGoodMask && nGoodSamplesCount<m_nRequiredBGSamples; ++nBatchIdx, nGoodMask>>=1) {
+                    if(nGoodMask&1) {
+                        if(nMinDescDist>(size_t)anDescDist[nBatchIdx])
+                            nMinDescDist = anDescDist[nBatchIdx];
+                        if(nMinSumDist>(size_t)anSumDist[nBatchIdx])
+                            nMinSumDist = anSumDist[nBatchIdx];
+                        nGoodSamplesCount++;
+                    }
                 }
-                failedcheck1ch:
-                nSampleIdx++;
             }
+            oReorderer.promote(m_oBGSamples,nPxIter);
+            lvBGSStatsOnly(oBand.oStats.nMatchedSamples += nGoodSamplesCount; oLoopTimer.endMatching();)
             const float fNormalizedLastDist = ((float)lv::L1dist(nLastColor,nCurrColor)/s_nColorMaxDataRange_1ch+(float)lv::hdist(nLastIntraDesc,nCurrIntraDesc)/s_nDescMaxDataRange_1ch)/2;
-            *pfCurrMeanLastDist = (*pfCurrMeanLastDist)*(1.0f-fRollAvgFactor_ST) + fNormalizedLastDist*fRollAvgFactor_ST;
+            *pfCurrMeanLastDist = (*pfCurrMeanLastDist)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedLastDist*fPxRollAvgFactor_ST;
             if(nGoodSamplesCount<m_nRequiredBGSamples) {
                 // == foreground
                 const float fNormalizedMinDist = std::min(1.0f,((float)nMinSumDist/s_nColorMaxDataRange_1ch+(float)nMinDescDist/s_nDescMaxDataRange_1ch)/2 + (float)(m_nRequiredBGSamples-nGoodSamplesCount)/m_nRequiredBGSamples);
-                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fRollAvgFactor_LT) + fNormalizedMinDist*fRollAvgFactor_LT;
-                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
-                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fRollAvgFactor_LT) + fRollAvgFactor_LT;
-                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fRollAvgFactor_ST) + fRollAvgFactor_ST;
+                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fPxRollAvgFactor_LT) + fNormalizedMinDist*fPxRollAvgFactor_LT;
+                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedMinDist*fPxRollAvgFactor_ST;
+                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fPxRollAvgFactor_LT) + fPxRollAvgFactor_LT;
+                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fPxRollAvgFactor_ST) + fPxRollAvgFactor_ST;
                 oCurrFGMask.data[nPxIter] = UCHAR_MAX;
-                if(m_nModelResetCooldown && (rand()%(size_t)FEEDBACK_T_LOWER)==0) {
-                    const size_t s_rand = rand()%m_nBGSamples;
-                    *((ushort*)(m_voBGDescSamples[s_rand].data+nDescIter)) = nCurrIntraDesc;
-                    m_voBGColorSamples[s_rand].data[nPxIter] = nCurrColor;
+                if(this->m_nModelResetCooldown && (lRand()%(size_t)FEEDBACK_T_LOWER)==0) {
+                    const size_t s_rand = lRand()%m_nBGSamples;
+                    *m_oBGSamples.desc(s_rand,nPxIter) = nCurrIntraDesc;
+                    *m_oBGSamples.color(s_rand,nPxIter) = nCurrColor;
                 }
             }
             else {
                 // == background
                 const float fNormalizedMinDist = ((float)nMinSumDist/s_nColorMaxDataRange_1ch+(float)nMinDescDist/s_nDescMaxDataRange_1ch)/2;
-                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fRollAvgFactor_LT) + fNormalizedMinDist*fRollAvgFactor_LT;
-                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
-                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fRollAvgFactor_LT);
-                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fRollAvgFactor_ST);
-                const size_t nLearningRate = std::isinf(learningRateOverride)?SIZE_MAX:(learningRateOverride>0?(size_t)ceil(learningRateOverride):(size_t)ceil(*pfCurrLearningRate));
-                if((rand()%nLearningRate)==0) {
-                    const size_t s_rand = rand()%m_nBGSamples;
-                    *((ushort*)(m_voBGDescSamples[s_rand].data+nDescIter)) = nCurrIntraDesc;
-                    m_voBGColorSamples[s_rand].data[nPxIter] = nCurrColor;
+                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fPxRollAvgFactor_LT) + fNormalizedMinDist*fPxRollAvgFactor_LT;
+                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedMinDist*fPxRollAvgFactor_ST;
+                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fPxRollAvgFactor_LT);
+                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fPxRollAvgFactor_ST);
+                const size_t nLearningRate = std::max((std::isinf(learningRateOverride)?SIZE_MAX:(learningRateOverride>0?(size_t)ceil(learningRateOverride):(size_t)ceil(*pfCurrLearningRate)))/nPxFrameCount,size_t(1));
+                if((lRand()%nLearningRate)==0) {
+                    const size_t s_rand = lRand()%m_nBGSamples;
+                    *m_oBGSamples.desc(s_rand,nPxIter) = nCurrIntraDesc;
+                    *m_oBGSamples.color(s_rand,nPxIter) = nCurrColor;
                 }
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
                 const bool bCurrUsing3x3Spread = m_bUse3x3Spread && !m_oUnstableRegionMask.data[nPxIter];
                 if(bCurrUsing3x3Spread)
-                    lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
+                    lv::getNeighborPosition_3x3(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
                 else
-                    lv::getNeighborPosition_5x5(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                const size_t n_rand = rand();
-                const size_t idx_rand_uchar = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-                const size_t idx_rand_flt32 = idx_rand_uchar*4;
-                const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data+idx_rand_flt32));
-                const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data+idx_rand_flt32));
-                if((n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0
-                    || (fRandMeanRawSegmRes>GHOSTDET_S_MIN && fRandMeanLastDist<GHOSTDET_D_MAX && (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0)) {
-                    const size_t idx_rand_ushrt = idx_rand_uchar*2;
-                    const size_t s_rand = rand()%m_nBGSamples;
-                    *((ushort*)(m_voBGDescSamples[s_rand].data+idx_rand_ushrt)) = nCurrIntraDesc;
-                    m_voBGColorSamples[s_rand].data[idx_rand_uchar] = nCurrColor;
+                    lv::getNeighborPosition_5x5(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                const size_t n_rand = lRand();
+                const size_t idx_rand_uchar = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                if(bDeferCrossBandSpread && !oBand.oRect.contains(cv::Point(nSampleImgCoord_X,nSampleImgCoord_Y))) {
+                    // neighbor belongs to another band; its stats & samples can only be safely accessed once all bands are done
+                    const bool bRegularUpdate = (n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0;
+                    const bool bGhostCandidate = (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0;
+                    if(bRegularUpdate || bGhostCandidate)
+                        oBand.vDeferredUpdates.push_back(DeferredSpreadUpdate{nPxIter,idx_rand_uchar,lRand()%m_nBGSamples,bRegularUpdate,bGhostCandidate});
+                }
+                else {
+                    const float fRandMeanLastDist = getPxStateValue(idx_rand_uchar,CompactState_MeanLastDist,m_oMeanLastDistFrame);
+                    const float fRandMeanRawSegmRes = getPxStateValue(idx_rand_uchar,CompactState_MeanRawSegmRes_ST,m_oMeanRawSegmResFrame_ST);
+                    if((n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0
+                        || (fRandMeanRawSegmRes>GHOSTDET_S_MIN && fRandMeanLastDist<GHOSTDET_D_MAX && (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0)) {
+                        const size_t s_rand = lRand()%m_nBGSamples;
+                        *m_oBGSamples.desc(s_rand,idx_rand_uchar) = nCurrIntraDesc;
+                        *m_oBGSamples.color(s_rand,idx_rand_uchar) = nCurrColor;
+                    }
                 }
             }
-            if(m_oLastFGMask.data[nPxIter] || (std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)<UNSTABLE_REG_RATIO_MIN && oCurrFGMask.data[nPxIter])) {
-                if((*pfCurrLearningRate)<m_fCurrLearningRateUpperCap)
-                    *pfCurrLearningRate += FEEDBACK_T_INCR/(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*(*pfCurrVariationFactor));
-            }
-            else if((*pfCurrLearningRate)>m_fCurrLearningRateLowerCap)
-                *pfCurrLearningRate -= FEEDBACK_T_DECR*(*pfCurrVariationFactor)/std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST);
-            if((*pfCurrLearningRate)<m_fCurrLearningRateLowerCap)
-                *pfCurrLearningRate = m_fCurrLearningRateLowerCap;
-            else if((*pfCurrLearningRate)>m_fCurrLearningRateUpperCap)
-                *pfCurrLearningRate = m_fCurrLearningRateUpperCap;
-            if(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)>UNSTABLE_REG_RATIO_MIN && m_oBlinksFrame.data[nPxIter])
-                (*pfCurrVariationFactor) += FEEDBACK_V_INCR;
-            else if((*pfCurrVariationFactor)>FEEDBACK_V_DECR) {
-                (*pfCurrVariationFactor) -= m_oLastFGMask.data[nPxIter]?FEEDBACK_V_DECR/4:m_oUnstableRegionMask.data[nPxIter]?FEEDBACK_V_DECR/2:FEEDBACK_V_DECR;
-                if((*pfCurrVariationFactor)<FEEDBACK_V_DECR)
-                    (*pfCurrVariationFactor) = FEEDBACK_V_DECR;
-            }
-            if((*pfCurrDistThresholdFactor)<std::pow(1.0f+std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*2,2))
-                (*pfCurrDistThresholdFactor) += FEEDBACK_R_VAR*(*pfCurrVariationFactor-FEEDBACK_V_DECR);
-            else {
-                (*pfCurrDistThresholdFactor) -= FEEDBACK_R_VAR/(*pfCurrVariationFactor);
-                if((*pfCurrDistThresholdFactor)<1.0f)
-                    (*pfCurrDistThresholdFactor) = 1.0f;
+            for(size_t nFrameStep=0; nFrameStep<nPxFrameCount; ++nFrameStep) {
+                if(this->m_oLastFGMask.data[nPxIter] || (std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)<UNSTABLE_REG_RATIO_MIN && oCurrFGMask.data[nPxIter])) {
+                    if((*pfCurrLearningRate)<m_fCurrLearningRateUpperCap)
+                        *pfCurrLearningRate += FEEDBACK_T_INCR/(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*(*pfCurrVariationFactor));
+                }
+                else if((*pfCurrLearningRate)>m_fCurrLearningRateLowerCap)
+                    *pfCurrLearningRate -= FEEDBACK_T_DECR*(*pfCurrVariationFactor)/std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST);
+                if((*pfCurrLearningRate)<m_fCurrLearningRateLowerCap)
+                    *pfCurrLearningRate = m_fCurrLearningRateLowerCap;
+                else if((*pfCurrLearningRate)>m_fCurrLearningRateUpperCap)
+                    *pfCurrLearningRate = m_fCurrLearningRateUpperCap;
+                if(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)>UNSTABLE_REG_RATIO_MIN && m_oBlinksFrame.data[nPxIter])
+                    (*pfCurrVariationFactor) += FEEDBACK_V_INCR;
+                else if((*pfCurrVariationFactor)>FEEDBACK_V_DECR) {
+                    (*pfCurrVariationFactor) -= this->m_oLastFGMask.data[nPxIter]?FEEDBACK_V_DECR/4:m_oUnstableRegionMask.data[nPxIter]?FEEDBACK_V_DECR/2:FEEDBACK_V_DECR;
+                    if((*pfCurrVariationFactor)<FEEDBACK_V_DECR)
+                        (*pfCurrVariationFactor) = FEEDBACK_V_DECR;
+                }
+                if((*pfCurrDistThresholdFactor)<std::pow(1.0f+std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*2,2))
+                    (*pfCurrDistThresholdFactor) += FEEDBACK_R_VAR*(*pfCurrVariationFactor-FEEDBACK_V_DECR);
+                else {
+                    (*pfCurrDistThresholdFactor) -= FEEDBACK_R_VAR/(*pfCurrVariationFactor);
+                    if((*pfCurrDistThresholdFactor)<1.0f)
+                        (*pfCurrDistThresholdFactor) = 1.0f;
+                }
             }
             if(lv::popcount(nCurrIntraDesc)>=2)
-                ++nNonZeroDescCount;
+                ++oBand.nNonZeroDescCount;
             nLastIntraDesc = nCurrIntraDesc;
             nLastColor = nCurrColor;
+            if(m_bUseCompactState)
+                storePxState(nPxIter,nFrameIdx,afCurrCompactState);
+            lvBGSStatsOnly(oLoopTimer.endPx();)
         }
     }
     else { //m_nImgChannels==3
-        for(size_t nModelIter=0; nModelIter<m_nTotRelevantPxCount; ++nModelIter) {
-            const size_t nPxIter = m_vnPxIdxLUT[nModelIter];
-            const int nCurrImgCoord_X = m_voPxInfoLUT[nPxIter].nImgCoord_X;
-            const int nCurrImgCoord_Y = m_voPxInfoLUT[nPxIter].nImgCoord_Y;
+        for(const size_t nModelIter : oBand.oModelIters) {
+            const size_t nPxIter = this->m_vnPxIdxLUT[nModelIter];
             const size_t nPxIterRGB = nPxIter*3;
             const size_t nDescIterRGB = nPxIterRGB*2;
+            if(!this->isPxActive(nPxIter)) {
+                // quiet block; model & state updates are deferred to the block's next refresh (which accounts for the skipped frames), and the last descriptor stands in for the current one
+                if(lv::popcount<3>((ushort*)(this->m_oLastDescFrame.data+nDescIterRGB))>=4)
+                    ++oBand.nNonZeroDescCount;
+                lvBGSStatsOnly(++oBand.oStats.nGatedPixels;)
+                continue;
+            }
+            lvBGSStatsOnly(oLoopTimer.beginPx(nModelIter);)
+            // a refreshed block catches up on the frames it skipped while gated: rolling averages & feedback loops advance once per covered frame, and sample updates get likelier
+            const size_t nPxFrameCount = this->getPxGatedFrameCount(nPxIter);
+            const float fPxRollAvgFactor_LT = (nPxFrameCount>1)?1.0f-std::pow(1.0f-fRollAvgFactor_LT,(float)nPxFrameCount):fRollAvgFactor_LT;
+            const float fPxRollAvgFactor_ST = (nPxFrameCount>1)?1.0f-std::pow(1.0f-fRollAvgFactor_ST,(float)nPxFrameCount):fRollAvgFactor_ST;
+            const int nCurrImgCoord_X = this->m_voPxInfoLUT[nPxIter].nImgCoord_X;
+            const int nCurrImgCoord_Y = this->m_voPxInfoLUT[nPxIter].nImgCoord_Y;
             const size_t nFloatIter = nPxIter*4;
             const uchar* const anCurrColor = oInputImg.data+nPxIterRGB;
             size_t nMinTotDescDist=s_nDescMaxDataRange_3ch;
             size_t nMinTotSumDist=s_nColorMaxDataRange_3ch;
-            float* pfCurrDistThresholdFactor = (float*)(m_oDistThresholdFrame.data+nFloatIter);
-            float* pfCurrVariationFactor = (float*)(m_oVariationModulatorFrame.data+nFloatIter);
-            float* pfCurrLearningRate = ((float*)(m_oUpdateRateFrame.data+nFloatIter));
-            float* pfCurrMeanLastDist = ((float*)(m_oMeanLastDistFrame.data+nFloatIter));
-            float* pfCurrMeanMinDist_LT = ((float*)(m_oMeanMinDistFrame_LT.data+nFloatIter));
-            float* pfCurrMeanMinDist_ST = ((float*)(m_oMeanMinDistFrame_ST.data+nFloatIter));
-            float* pfCurrMeanRawSegmRes_LT = ((float*)(m_oMeanRawSegmResFrame_LT.data+nFloatIter));
-            float* pfCurrMeanRawSegmRes_ST = ((float*)(m_oMeanRawSegmResFrame_ST.data+nFloatIter));
+            std::array<float,CompactStateFieldCount> afCurrCompactState;
+            const std::array<float*,CompactStateFieldCount> apfCurrState = getPxStatePtrs(nPxIter,afCurrCompactState);
+            float* pfCurrDistThresholdFactor = apfCurrState[CompactState_DistThreshold];
+            float* pfCurrVariationFactor = apfCurrState[CompactState_VariationModulator];
+            float* pfCurrLearningRate = apfCurrState[CompactState_UpdateRate];
+            float* pfCurrMeanLastDist = apfCurrState[CompactState_MeanLastDist];
+            float* pfCurrMeanMinDist_LT = apfCurrState[CompactState_MeanMinDist_LT];
+            float* pfCurrMeanMinDist_ST = apfCurrState[CompactState_MeanMinDist_ST];
+            float* pfCurrMeanRawSegmRes_LT = apfCurrState[CompactState_MeanRawSegmRes_LT];
+            float* pfCurrMeanRawSegmRes_ST = apfCurrState[CompactState_MeanRawSegmRes_ST];
             float* pfCurrMeanFinalSegmRes_LT = ((float*)(m_oMeanFinalSegmResFrame_LT.data+nFloatIter));
             float* pfCurrMeanFinalSegmRes_ST = ((float*)(m_oMeanFinalSegmResFrame_ST.data+nFloatIter));
-            ushort* anLastIntraDesc = ((ushort*)(m_oLastDescFrame.data+nDescIterRGB));
-            uchar* anLastColor = m_oLastColorFrame.data+nPxIterRGB;
+            ushort* anLastIntraDesc = ((ushort*)(this->m_oLastDescFrame.data+nDescIterRGB));
+            uchar* anLastColor = this->m_oLastColorFrame.data+nPxIterRGB;
             const size_t nCurrColorDistThreshold = (size_t)(((*pfCurrDistThresholdFactor)*m_nMinColorDistThreshold)-((!m_oUnstableRegionMask.data[nPxIter])*STAB_COLOR_DIST_OFFSET));
             const size_t nCurrDescDistThreshold = ((size_t)1<<((size_t)floor(*pfCurrDistThresholdFactor+0.5f)))+m_nDescDistThresholdOffset+(m_oUnstableRegionMask.data[nPxIter]*UNSTAB_DESC_DIST_OFFSET);
             const size_t nCurrTotColorDistThreshold = nCurrColorDistThreshold*3;
@@ -361,133 +662,299 @@ void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray
             LBSP::computeDescriptor_lookup(oInputImg,nCurrImgCoord_X,nCurrImgCoord_Y,aanLBSPLookupVals);
             std::array<ushort,3> anCurrIntraDesc;
             for(size_t c=0; c<3; ++c)
-                anCurrIntraDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
+                anCurrIntraDesc[c] = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anCurrColor[c],this->m_anLBSPThreshold_8bitLUT[anCurrColor[c]]);
             m_oUnstableRegionMask.data[nPxIter] = ((*pfCurrDistThresholdFactor)>UNSTABLE_REG_RDIST_MIN || (*pfCurrMeanRawSegmRes_LT-*pfCurrMeanFinalSegmRes_LT)>UNSTABLE_REG_RATIO_MIN || (*pfCurrMeanRawSegmRes_ST-*pfCurrMeanFinalSegmRes_ST)>UNSTABLE_REG_RATIO_MIN)?1:0;
-            size_t nGoodSamplesCount=0, nSampleIdx=0;
-            while(nGoodSamplesCount<m_nRequiredBGSamples && nSampleIdx<m_nBGSamples) {
-                const ushort* const anBGIntraDesc = (ushort*)(m_voBGDescSamples[nSampleIdx].data+nDescIterRGB);
-                const uchar* const anBGColor = m_voBGColorSamples[nSampleIdx].data+nPxIterRGB;
-                size_t nTotDescDist = 0;
-                size_t nTotSumDist = 0;
-                for(size_t c=0;c<3; ++c) {
-                    const size_t nColorDist = lv::L1dist(anCurrColor[c],anBGColor[c]);
-                    if(nColorDist>nCurrSCColorDistThreshold)
-                        goto failedcheck3ch;
-                    const size_t nIntraDescDist = lv::hdist(anCurrIntraDesc[c],anBGIntraDesc[c]);
-                    const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(aanLBSPLookupVals[c],anBGColor[c],m_anLBSPThreshold_8bitLUT[anBGColor[c]]);
-                    const size_t nInterDescDist = lv::hdist(nCurrInterDesc,anBGIntraDesc[c]);
-                    const size_t nDescDist = (nIntraDescDist+nInterDescDist)/2;
-                    const size_t nSumDist = std::min((nDescDist/2)*(s_nColorMaxDataRange_1ch/s_nDescMaxDataRange_1ch)+nColorDist,s_nColorMaxDataRange_1ch);
-                    if(nSumDist>nCurrSCColorDistThreshold)
-                        goto failedcheck3ch;
-                    nTotDescDist += nDescDist;
-                    nTotSumDist += nSumDist;
+            // per-channel sum dist = min((desc dist/2)*(color range/desc range)+color dist,color range), checked against the single-channel color dist threshold
+            const LBSPSampleMatcher::Thresholds oMatchThresholds = {nCurrSCColorDistThreshold,SIZE_MAX,nCurrSCColorDistThreshold,nCurrTotDescDistThreshold,nCurrTotColorDistThreshold,true,1};
+            size_t nGoodSamplesCount=0;
+            LBSPSampleMatcher::MatchReorderer oReorderer;
+            for(size_t nSampleIdx=0; nGoodSamplesCount<m_nRequiredBGSamples && nSampleIdx<m_nBGSamples; nSampleIdx+=LBSPSampleMatcher::getBatchSize(nSampleIdx,m_nBGSamples)) {
+                const size_t nBatchSize = LBSPSampleMatcher::getBatchSize(nSampleIdx,m_nBGSamples);
+                std::array<ushort,LBSPSampleMatcher::s_nBatchSize> anTotDescDist,anTotSumDist;
+                uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<3>(m_oBGSamples,nPxIter,nSampleIdx,nBatchSize,anCurrColor,anCurrIntraDesc.data(),aanLBSPLookupVals[0].data(),this->m_anLBSPThreshold_8bitLUT.data(),oMatchThresholds,anTotDescDist.data(),anTotSumDist.data());
+                lvBGSStatsOnly(oBand.oStats.nTestedSamples += LBSPSampleMatcher::getTestedCount(nGoodMask,nBatchSize,m_nRequiredBGSamples-nGoodSamplesCount);)
+                if(this->m_bUseSampleReordering)
+                    oReorderer.addBatch(nSampleIdx,nGoodMask);
+                for(size_t nBatchIdx=0; nGoodMask && nGoodSamplesCount<m_nRequiredBGSamples; ++nBatchIdx, nGoodMask>>=1) {
+                    if(nGoodMask&1) {
+                        if(nMinTotDescDist>(size_t)anTotDescDist[nBatchIdx])
+                            nMinTotDescDist = anTotDescDist[nBatchIdx];
+                        if(nMinTotSumDist>(size_t)anTotSumDist[nBatchIdx])
+                            nMinTotSumDist = anTotSumDist[nBatchIdx];
+                        nGoodSamplesCount++;
+                    }
                 }
-                if(nTotDescDist>nCurrTotDescDistThreshold || nTotSumDist>nCurrTotColorDistThreshold)
-                    goto failedcheck3ch;
-                if(nMinTotDescDist>nTotDescDist)
-                    nMinTotDescDist = nTotDescDist;
-                if(nMinTotSumDist>nTotSumDist)
-                    nMinTotSumDist = nTotSumDist;
-                nGoodSamplesCount++;
-                failedcheck3ch:
-                nSampleIdx++;
             }
+            oReorderer.promote(m_oBGSamples,nPxIter);
+            lvBGSStatsOnly(oBand.oStats.nMatchedSamples += nGoodSamplesCount; oLoopTimer.endMatching();)
             const float fNormalizedLastDist = ((float)lv::L1dist<3>(anLastColor,anCurrColor)/s_nColorMaxDataRange_3ch+(float)lv::hdist<3>(anLastIntraDesc,anCurrIntraDesc)/s_nDescMaxDataRange_3ch)/2;
-            *pfCurrMeanLastDist = (*pfCurrMeanLastDist)*(1.0f-fRollAvgFactor_ST) + fNormalizedLastDist*fRollAvgFactor_ST;
+            *pfCurrMeanLastDist = (*pfCurrMeanLastDist)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedLastDist*fPxRollAvgFactor_ST;
             if(nGoodSamplesCount<m_nRequiredBGSamples) {
                 // == foreground
                 const float fNormalizedMinDist = std::min(1.0f,((float)nMinTotSumDist/s_nColorMaxDataRange_3ch+(float)nMinTotDescDist/s_nDescMaxDataRange_3ch)/2 + (float)(m_nRequiredBGSamples-nGoodSamplesCount)/m_nRequiredBGSamples);
-                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fRollAvgFactor_LT) + fNormalizedMinDist*fRollAvgFactor_LT;
-                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
-                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fRollAvgFactor_LT) + fRollAvgFactor_LT;
-                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fRollAvgFactor_ST) + fRollAvgFactor_ST;
+                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fPxRollAvgFactor_LT) + fNormalizedMinDist*fPxRollAvgFactor_LT;
+                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedMinDist*fPxRollAvgFactor_ST;
+                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fPxRollAvgFactor_LT) + fPxRollAvgFactor_LT;
+                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fPxRollAvgFactor_ST) + fPxRollAvgFactor_ST;
                 oCurrFGMask.data[nPxIter] = UCHAR_MAX;
-                if(m_nModelResetCooldown && (rand()%(size_t)FEEDBACK_T_LOWER)==0) {
-                    const size_t s_rand = rand()%m_nBGSamples;
+                if(this->m_nModelResetCooldown && (lRand()%(size_t)FEEDBACK_T_LOWER)==0) {
+                    const size_t s_rand = lRand()%m_nBGSamples;
+                    ushort* const anRandBGIntraDesc = m_oBGSamples.desc(s_rand,nPxIter);
+                    uchar* const anRandBGColor = m_oBGSamples.color(s_rand,nPxIter);
                     for(size_t c=0; c<3; ++c) {
-                        *((ushort*)(m_voBGDescSamples[s_rand].data+nDescIterRGB+2*c)) = anCurrIntraDesc[c];
-                        *(m_voBGColorSamples[s_rand].data+nPxIterRGB+c) = anCurrColor[c];
+                        anRandBGIntraDesc[c] = anCurrIntraDesc[c];
+                        anRandBGColor[c] = anCurrColor[c];
                     }
                 }
             }
             else {
                 // == background
                 const float fNormalizedMinDist = ((float)nMinTotSumDist/s_nColorMaxDataRange_3ch+(float)nMinTotDescDist/s_nDescMaxDataRange_3ch)/2;
-                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fRollAvgFactor_LT) + fNormalizedMinDist*fRollAvgFactor_LT;
-                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
-                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fRollAvgFactor_LT);
-                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fRollAvgFactor_ST);
-                const size_t nLearningRate = std::isinf(learningRateOverride)?SIZE_MAX:(learningRateOverride>0?(size_t)ceil(learningRateOverride):(size_t)ceil(*pfCurrLearningRate));
-                if((rand()%nLearningRate)==0) {
-                    const size_t s_rand = rand()%m_nBGSamples;
+                *pfCurrMeanMinDist_LT = (*pfCurrMeanMinDist_LT)*(1.0f-fPxRollAvgFactor_LT) + fNormalizedMinDist*fPxRollAvgFactor_LT;
+                *pfCurrMeanMinDist_ST = (*pfCurrMeanMinDist_ST)*(1.0f-fPxRollAvgFactor_ST) + fNormalizedMinDist*fPxRollAvgFactor_ST;
+                *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f-fPxRollAvgFactor_LT);
+                *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f-fPxRollAvgFactor_ST);
+                const size_t nLearningRate = std::max((std::isinf(learningRateOverride)?SIZE_MAX:(learningRateOverride>0?(size_t)ceil(learningRateOverride):(size_t)ceil(*pfCurrLearningRate)))/nPxFrameCount,size_t(1));
+                if((lRand()%nLearningRate)==0) {
+                    const size_t s_rand = lRand()%m_nBGSamples;
+                    ushort* const anRandBGIntraDesc = m_oBGSamples.desc(s_rand,nPxIter);
+                    uchar* const anRandBGColor = m_oBGSamples.color(s_rand,nPxIter);
                     for(size_t c=0; c<3; ++c) {
-                        *((ushort*)(m_voBGDescSamples[s_rand].data+nDescIterRGB+2*c)) = anCurrIntraDesc[c];
-                        *(m_voBGColorSamples[s_rand].data+nPxIterRGB+c) = anCurrColor[c];
+                        anRandBGIntraDesc[c] = anCurrIntraDesc[c];
+                        anRandBGColor[c] = anCurrColor[c];
                     }
                 }
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
                 const bool bCurrUsing3x3Spread = m_bUse3x3Spread && !m_oUnstableRegionMask.data[nPxIter];
                 if(bCurrUsing3x3Spread)
-                    lv::getNeighborPosition_3x3(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
+                    lv::getNeighborPosition_3x3(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
                 else
-                    lv::getNeighborPosition_5x5(rand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,m_oImgSize);
-                const size_t n_rand = rand();
-                const size_t idx_rand_uchar = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-                const size_t idx_rand_flt32 = idx_rand_uchar*4;
-                const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data+idx_rand_flt32));
-                const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data+idx_rand_flt32));
-                if((n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0
-                    || (fRandMeanRawSegmRes>GHOSTDET_S_MIN && fRandMeanLastDist<GHOSTDET_D_MAX && (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0)) {
-                    const size_t idx_rand_uchar_rgb = idx_rand_uchar*3;
-                    const size_t idx_rand_ushrt_rgb = idx_rand_uchar_rgb*2;
-                    const size_t s_rand = rand()%m_nBGSamples;
-                    for(size_t c=0; c<3; ++c) {
-                        *((ushort*)(m_voBGDescSamples[s_rand].data+idx_rand_ushrt_rgb+2*c)) = anCurrIntraDesc[c];
-                        *(m_voBGColorSamples[s_rand].data+idx_rand_uchar_rgb+c) = anCurrColor[c];
+                    lv::getNeighborPosition_5x5(lRand(),nSampleImgCoord_X,nSampleImgCoord_Y,nCurrImgCoord_X,nCurrImgCoord_Y,LBSP::PATCH_SIZE/2,this->m_oImgSize);
+                const size_t n_rand = lRand();
+                const size_t idx_rand_uchar = this->m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
+                if(bDeferCrossBandSpread && !oBand.oRect.contains(cv::Point(nSampleImgCoord_X,nSampleImgCoord_Y))) {
+                    // neighbor belongs to another band; its stats & samples can only be safely accessed once all bands are done
+                    const bool bRegularUpdate = (n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0;
+                    const bool bGhostCandidate = (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0;
+                    if(bRegularUpdate || bGhostCandidate)
+                        oBand.vDeferredUpdates.push_back(DeferredSpreadUpdate{nPxIter,idx_rand_uchar,lRand()%m_nBGSamples,bRegularUpdate,bGhostCandidate});
+                }
+                else {
+                    const float fRandMeanLastDist = getPxStateValue(idx_rand_uchar,CompactState_MeanLastDist,m_oMeanLastDistFrame);
+                    const float fRandMeanRawSegmRes = getPxStateValue(idx_rand_uchar,CompactState_MeanRawSegmRes_ST,m_oMeanRawSegmResFrame_ST);
+                    if((n_rand%(bCurrUsing3x3Spread?nLearningRate:(nLearningRate/2+1)))==0
+                        || (fRandMeanRawSegmRes>GHOSTDET_S_MIN && fRandMeanLastDist<GHOSTDET_D_MAX && (n_rand%((size_t)m_fCurrLearningRateLowerCap))==0)) {
+                        const size_t s_rand = lRand()%m_nBGSamples;
+                        ushort* const anRandBGIntraDesc = m_oBGSamples.desc(s_rand,idx_rand_uchar);
+                        uchar* const anRandBGColor = m_oBGSamples.color(s_rand,idx_rand_uchar);
+                        for(size_t c=0; c<3; ++c) {
+                            anRandBGIntraDesc[c] = anCurrIntraDesc[c];
+                            anRandBGColor[c] = anCurrColor[c];
+                        }
                     }
                 }
             }
-            if(m_oLastFGMask.data[nPxIter] || (std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)<UNSTABLE_REG_RATIO_MIN && oCurrFGMask.data[nPxIter])) {
-                if((*pfCurrLearningRate)<m_fCurrLearningRateUpperCap)
-                    *pfCurrLearningRate += FEEDBACK_T_INCR/(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*(*pfCurrVariationFactor));
-            }
-            else if((*pfCurrLearningRate)>m_fCurrLearningRateLowerCap)
-                *pfCurrLearningRate -= FEEDBACK_T_DECR*(*pfCurrVariationFactor)/std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST);
-            if((*pfCurrLearningRate)<m_fCurrLearningRateLowerCap)
-                *pfCurrLearningRate = m_fCurrLearningRateLowerCap;
-            else if((*pfCurrLearningRate)>m_fCurrLearningRateUpperCap)
-                *pfCurrLearningRate = m_fCurrLearningRateUpperCap;
-            if(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)>UNSTABLE_REG_RATIO_MIN && m_oBlinksFrame.data[nPxIter])
-                (*pfCurrVariationFactor) += FEEDBACK_V_INCR;
-            else if((*pfCurrVariationFactor)>FEEDBACK_V_DECR) {
-                (*pfCurrVariationFactor) -= m_oLastFGMask.data[nPxIter]?FEEDBACK_V_DECR/4:m_oUnstableRegionMask.data[nPxIter]?FEEDBACK_V_DECR/2:FEEDBACK_V_DECR;
-                if((*pfCurrVariationFactor)<FEEDBACK_V_DECR)
-                    (*pfCurrVariationFactor) = FEEDBACK_V_DECR;
-            }
-            if((*pfCurrDistThresholdFactor)<std::pow(1.0f+std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*2,2))
-                (*pfCurrDistThresholdFactor) += FEEDBACK_R_VAR*(*pfCurrVariationFactor-FEEDBACK_V_DECR);
-            else {
-                (*pfCurrDistThresholdFactor) -= FEEDBACK_R_VAR/(*pfCurrVariationFactor);
-                if((*pfCurrDistThresholdFactor)<1.0f)
-                    (*pfCurrDistThresholdFactor) = 1.0f;
+            for(size_t nFrameStep=0; nFrameStep<nPxFrameCount; ++nFrameStep) {
+                if(this->m_oLastFGMask.data[nPxIter] || (std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)<UNSTABLE_REG_RATIO_MIN && oCurrFGMask.data[nPxIter])) {
+                    if((*pfCurrLearningRate)<m_fCurrLearningRateUpperCap)
+                        *pfCurrLearningRate += FEEDBACK_T_INCR/(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*(*pfCurrVariationFactor));
+                }
+                else if((*pfCurrLearningRate)>m_fCurrLearningRateLowerCap)
+                    *pfCurrLearningRate -= FEEDBACK_T_DECR*(*pfCurrVariationFactor)/std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST);
+                if((*pfCurrLearningRate)<m_fCurrLearningRateLowerCap)
+                    *pfCurrLearningRate = m_fCurrLearningRateLowerCap;
+                else if((*pfCurrLearningRate)>m_fCurrLearningRateUpperCap)
+                    *pfCurrLearningRate = m_fCurrLearningRateUpperCap;
+                if(std::max(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)>UNSTABLE_REG_RATIO_MIN && m_oBlinksFrame.data[nPxIter])
+                    (*pfCurrVariationFactor) += FEEDBACK_V_INCR;
+                else if((*pfCurrVariationFactor)>FEEDBACK_V_DECR) {
+                    (*pfCurrVariationFactor) -= this->m_oLastFGMask.data[nPxIter]?FEEDBACK_V_DECR/4:m_oUnstableRegionMask.data[nPxIter]?FEEDBACK_V_DECR/2:FEEDBACK_V_DECR;
+                    if((*pfCurrVariationFactor)<FEEDBACK_V_DECR)
+                        (*pfCurrVariationFactor) = FEEDBACK_V_DECR;
+                }
+                if((*pfCurrDistThresholdFactor)<std::pow(1.0f+std::min(*pfCurrMeanMinDist_LT,*pfCurrMeanMinDist_ST)*2,2))
+                    (*pfCurrDistThresholdFactor) += FEEDBACK_R_VAR*(*pfCurrVariationFactor-FEEDBACK_V_DECR);
+                else {
+                    (*pfCurrDistThresholdFactor) -= FEEDBACK_R_VAR/(*pfCurrVariationFactor);
+                    if((*pfCurrDistThresholdFactor)<1.0f)
+                        (*pfCurrDistThresholdFactor) = 1.0f;
+                }
             }
             if(lv::popcount<3>(anCurrIntraDesc)>=4)
-                ++nNonZeroDescCount;
+                ++oBand.nNonZeroDescCount;
             for(size_t c=0; c<3; ++c) {
                 anLastIntraDesc[c] = anCurrIntraDesc[c];
                 anLastColor[c] = anCurrColor[c];
             }
+            if(m_bUseCompactState)
+                storePxState(nPxIter,nFrameIdx,afCurrCompactState);
+            lvBGSStatsOnly(oLoopTimer.endPx();)
+        }
+    }
+    lvBGSStatsOnly(oBand.oStats.nPixels += oBand.oModelIters.size()-oBand.oStats.nGatedPixels; oLoopTimer.commit(oBand.oStats);)
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::commitDeferredSpreadUpdate(const DeferredSpreadUpdate& oUpdate) {
+    if(!oUpdate.bRegularUpdate) {
+        lvDbgAssert(oUpdate.bGhostCandidate);
+        const float fRandMeanLastDist = getPxStateValue(oUpdate.nDstPxIdx,CompactState_MeanLastDist,m_oMeanLastDistFrame);
+        const float fRandMeanRawSegmRes = getPxStateValue(oUpdate.nDstPxIdx,CompactState_MeanRawSegmRes_ST,m_oMeanRawSegmResFrame_ST);
+        if(!(fRandMeanRawSegmRes>GHOSTDET_S_MIN && fRandMeanLastDist<GHOSTDET_D_MAX))
+            return;
+    }
+    // the source pixel's 'last' color/desc were already overwritten with the current frame's values during its band pass
+    for(size_t c=0; c<this->m_nImgChannels; ++c) {
+        m_oBGSamples.desc(oUpdate.nSampleIdx,oUpdate.nDstPxIdx)[c] = *((ushort*)(this->m_oLastDescFrame.data+(oUpdate.nSrcPxIdx*this->m_nImgChannels+c)*2));
+        m_oBGSamples.color(oUpdate.nSampleIdx,oUpdate.nDstPxIdx)[c] = this->m_oLastColorFrame.data[oUpdate.nSrcPxIdx*this->m_nImgChannels+c];
+    }
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::postProcess(cv::Mat& oCurrFGMask, cv::Mat& oLastFGMask, cv::Mat& oBlinksFrame, cv::Mat& oMeanFinalSegmResFrame_LT, cv::Mat& oMeanFinalSegmResFrame_ST,
+                                                      std::vector<ForegroundBlob>& voBlobs, float fRollAvgFactor_LT, float fRollAvgFactor_ST) {
+    if(!m_voPostProcTiles.empty()) {
+        postProcess_tiled(oCurrFGMask,oLastFGMask,oBlinksFrame,oMeanFinalSegmResFrame_LT,oMeanFinalSegmResFrame_ST,voBlobs,fRollAvgFactor_LT,fRollAvgFactor_ST);
+        return;
+    }
+    cv::bitwise_xor(oCurrFGMask,m_oLastRawFGMask,m_oCurrRawFGBlinkMask);
+    cv::bitwise_or(m_oCurrRawFGBlinkMask,m_oLastRawFGBlinkMask,oBlinksFrame);
+    m_oCurrRawFGBlinkMask.copyTo(m_oLastRawFGBlinkMask);
+    oCurrFGMask.copyTo(m_oLastRawFGMask);
+    lv::binaryClose(oCurrFGMask,m_oFGMask_PreFlood,m_oMorphExStructElement.cols/2);
+    m_oFGMask_PreFlood.copyTo(m_oFGMask_FloodedHoles);
+    cv::floodFill(m_oFGMask_FloodedHoles,cv::Point(0,0),UCHAR_MAX);
+    cv::bitwise_not(m_oFGMask_FloodedHoles,m_oFGMask_FloodedHoles);
+    // erode x3, union with the raw mask & holes, median and dilate x3 in a single line-buffered pass (bit-exact with the opencv chain)
+    lv::postProcessBinaryMask(oCurrFGMask,m_oFGMask_FloodedHoles,m_oFGMask_PreFlood,oLastFGMask,m_nMedianBlurKernelSize,3,&m_oLastFGMask_dilated,3);
+    cv::bitwise_and(oBlinksFrame,m_oLastFGMask_dilated_inverted,oBlinksFrame);
+    cv::bitwise_not(m_oLastFGMask_dilated,m_oLastFGMask_dilated_inverted);
+    cv::bitwise_and(oBlinksFrame,m_oLastFGMask_dilated_inverted,oBlinksFrame);
+    this->copyMaskAndExtractBlobs(oLastFGMask,oCurrFGMask,voBlobs);
+    cv::addWeighted(oMeanFinalSegmResFrame_LT,(1.0f-fRollAvgFactor_LT),oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_LT,0,oMeanFinalSegmResFrame_LT,CV_32F);
+    cv::addWeighted(oMeanFinalSegmResFrame_ST,(1.0f-fRollAvgFactor_ST),oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_ST,0,oMeanFinalSegmResFrame_ST,CV_32F);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::postProcess_tiled(cv::Mat& oCurrFGMask, cv::Mat& oLastFGMask, cv::Mat& oBlinksFrame, cv::Mat& oMeanFinalSegmResFrame_LT, cv::Mat& oMeanFinalSegmResFrame_ST,
+                                                            std::vector<ForegroundBlob>& voBlobs, float fRollAvgFactor_LT, float fRollAvgFactor_ST) {
+    // same ops as the full-frame chain; each tile filters its region padded with a halo at least as wide as the op chain's total
+    // radius, and only writes back its own region, so seams cannot leak (shared inputs are never written in the same pass)
+    const cv::Rect oImgRect(cv::Point(),this->m_oImgSize);
+    const auto lGetHaloRect = [&oImgRect](const cv::Rect& oTile, int nHalo) {
+        return cv::Rect(oTile.x-nHalo,oTile.y-nHalo,oTile.width+nHalo*2,oTile.height+nHalo*2)&oImgRect;
+    };
+    const int nCloseHalo = std::max(m_oMorphExStructElement.cols,m_oMorphExStructElement.rows)/2*2;
+    processPostProcTiles([&](size_t nTileIdx) {
+        const cv::Rect& oTile = m_voPostProcTiles[nTileIdx];
+        cv::Mat oCurrFGMaskTile = oCurrFGMask(oTile), oLastRawFGMaskTile = m_oLastRawFGMask(oTile);
+        cv::Mat oCurrBlinkTile = m_oCurrRawFGBlinkMask(oTile), oLastBlinkTile = m_oLastRawFGBlinkMask(oTile), oBlinksTile = oBlinksFrame(oTile);
+        cv::bitwise_xor(oCurrFGMaskTile,oLastRawFGMaskTile,oCurrBlinkTile);
+        cv::bitwise_or(oCurrBlinkTile,oLastBlinkTile,oBlinksTile);
+        oCurrBlinkTile.copyTo(oLastBlinkTile);
+        oCurrFGMaskTile.copyTo(oLastRawFGMaskTile);
+        const cv::Rect oHaloRect = lGetHaloRect(oTile,nCloseHalo);
+        cv::Mat oPreFlood;
+        lv::binaryClose(oCurrFGMask(oHaloRect),oPreFlood,m_oMorphExStructElement.cols/2);
+        oPreFlood(oTile-oHaloRect.tl()).copyTo(m_oFGMask_PreFlood(oTile));
+    });
+    // hole filling needs global connectivity; the tile-aware labeling merges components across seams instead of flooding serially
+    lv::computeEnclosedHoles(m_oFGMask_PreFlood,m_oFGMask_FloodedHoles,m_voPostProcTiles[0].size());
+    const int nFilterHalo = 3+m_nMedianBlurKernelSize/2+3; // erode x3, median, dilate x3
+    processPostProcTiles([&](size_t nTileIdx) {
+        const cv::Rect& oTile = m_voPostProcTiles[nTileIdx];
+        const cv::Rect oHaloRect = lGetHaloRect(oTile,nFilterHalo);
+        const cv::Rect oInnerRect = oTile-oHaloRect.tl();
+        cv::Mat oFilteredFGMask, oFilteredFGMask_dilated;
+        lv::postProcessBinaryMask(oCurrFGMask(oHaloRect),m_oFGMask_FloodedHoles(oHaloRect),m_oFGMask_PreFlood(oHaloRect),oFilteredFGMask,m_nMedianBlurKernelSize,3,&oFilteredFGMask_dilated,3);
+        cv::Mat oLastFGMaskTile = oLastFGMask(oTile), oBlinksTile = oBlinksFrame(oTile), oDilatedInvTile = m_oLastFGMask_dilated_inverted(oTile);
+        oFilteredFGMask(oInnerRect).copyTo(oLastFGMaskTile);
+        oFilteredFGMask_dilated(oInnerRect).copyTo(m_oLastFGMask_dilated(oTile));
+        cv::bitwise_and(oBlinksTile,oDilatedInvTile,oBlinksTile);
+        cv::bitwise_not(oFilteredFGMask_dilated(oInnerRect),oDilatedInvTile);
+        cv::bitwise_and(oBlinksTile,oDilatedInvTile,oBlinksTile);
+        cv::Mat oMeanFinalSegmResTile_LT = oMeanFinalSegmResFrame_LT(oTile), oMeanFinalSegmResTile_ST = oMeanFinalSegmResFrame_ST(oTile);
+        cv::addWeighted(oMeanFinalSegmResTile_LT,(1.0f-fRollAvgFactor_LT),oLastFGMaskTile,(1.0/UCHAR_MAX)*fRollAvgFactor_LT,0,oMeanFinalSegmResTile_LT,CV_32F);
+        cv::addWeighted(oMeanFinalSegmResTile_ST,(1.0f-fRollAvgFactor_ST),oLastFGMaskTile,(1.0/UCHAR_MAX)*fRollAvgFactor_ST,0,oMeanFinalSegmResTile_ST,CV_32F);
+    });
+    // the raw mask is read in the halos of the pass above, so it can only be overwritten once all tiles are done
+    this->copyMaskAndExtractBlobs(oLastFGMask,oCurrFGMask,voBlobs);
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
+    // == process
+    lvAssert_(this->m_bInitialized && this->m_bModelInitialized,"algo & model must be initialized first");
+    lvAssert_(!m_pPostProcWorker || !this->isUsingReducedResolution(),"pipelined post-processing cannot be used in reduced-resolution mode");
+    lvAssert_(!m_pPostProcWorker || this->m_dFrameTimeBudget<=0.0,"pipelined post-processing cannot be used with a frame time budget");
+    const cv::Mat oFullInputImg = _image.getMat();
+    const cv::Mat& oInputImg = this->getModelInput(oFullInputImg,this->m_oReducedResInputImg);
+    lvAssert_(oInputImg.type()==this->m_nImgType && oInputImg.size()==this->m_oImgSize,"input image type/size mismatch with initialization type/size");
+    lvAssert_(oInputImg.isContinuous(),"input image data must be continuous");
+    cv::Mat oCurrFGMask = this->getModelOutput(_fgmask);
+    memset(oCurrFGMask.data,0,oCurrFGMask.cols*oCurrFGMask.rows);
+    size_t nNonZeroDescCount = 0;
+    const float fRollAvgFactor_LT = 1.0f/std::min(++this->m_nFrameIdx,m_nSamplesForMovingAvgs);
+    const float fRollAvgFactor_ST = 1.0f/std::min(this->m_nFrameIdx,m_nSamplesForMovingAvgs/4);
+    if(this->beginBudgetedFrame()) {
+        // pixel models get no new observation; the final segmentation stats & blink map age along the predicted mask
+        this->predictSkippedFrameMask(oCurrFGMask);
+        cv::dilate(this->m_oLastFGMask,m_oLastFGMask_dilated,cv::Mat(),cv::Point(-1,-1),3);
+        cv::bitwise_not(m_oLastFGMask_dilated,m_oLastFGMask_dilated_inverted);
+        cv::bitwise_and(m_oBlinksFrame,m_oLastFGMask_dilated_inverted,m_oBlinksFrame);
+        cv::addWeighted(m_oMeanFinalSegmResFrame_LT,(1.0f-fRollAvgFactor_LT),this->m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_LT,0,m_oMeanFinalSegmResFrame_LT,CV_32F);
+        cv::addWeighted(m_oMeanFinalSegmResFrame_ST,(1.0f-fRollAvgFactor_ST),this->m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_ST,0,m_oMeanFinalSegmResFrame_ST,CV_32F);
+        // the distance & raw segmentation means decay at their per-frame rates, and the model reset cooldown keeps counting frames
+        decaySkippedFrameState(fRollAvgFactor_LT,fRollAvgFactor_ST);
+        if(m_bLearningRateScalingEnabled && this->m_nModelResetCooldown>0)
+            --this->m_nModelResetCooldown;
+        this->refineReducedResMask(oFullInputImg,oInputImg,oCurrFGMask,_fgmask);
+        this->endBudgetedFrame();
+        return;
+    }
+    if(this->m_bUsingActivityGating)
+        this->updateActivityGating(oInputImg);
+    if(m_voParallelBands.empty()) {
+        ParallelBandInfo oFullBand;
+        oFullBand.oModelIters.add(0,this->m_nTotRelevantPxCount);
+        oFullBand.oRect = cv::Rect(cv::Point(),this->m_oImgSize);
+        oFullBand.nNonZeroDescCount = 0;
+        apply_band(oInputImg,oCurrFGMask,oFullBand,[](){return rand();},false,fRollAvgFactor_LT,fRollAvgFactor_ST,learningRateOverride,this->m_nFrameIdx);
+        nNonZeroDescCount = oFullBand.nNonZeroDescCount;
+        lvBGSStatsOnly(this->m_oStats += oFullBand.oStats;)
+    }
+    else {
+        processParallelBands([&](size_t nBandIdx) {
+            ParallelBandInfo& oBand = m_voParallelBands[nBandIdx];
+            oBand.nNonZeroDescCount = 0;
+            oBand.vDeferredUpdates.clear();
+            lvBGSStatsOnly(oBand.oStats.reset();)
+            // each band gets its own stream (derived from the base seed, frame index & band index) so that results do not depend on thread scheduling
+            int nBandSeed = getParallelBandSeed(nBandIdx,this->m_nFrameIdx);
+            const auto lBandRand = [&nBandSeed]() {
+                // fastrand only provides 15 bits per call; two draws are combined to avoid biasing large modulos
+                const int nHighBits = lv::fastrand(nBandSeed);
+                return (nHighBits<<15)|lv::fastrand(nBandSeed);
+            };
+            apply_band(oInputImg,oCurrFGMask,oBand,lBandRand,true,fRollAvgFactor_LT,fRollAvgFactor_ST,learningRateOverride,this->m_nFrameIdx);
+        });
+        for(const ParallelBandInfo& oBand : m_voParallelBands) {
+            nNonZeroDescCount += oBand.nNonZeroDescCount;
+            lvBGSStatsOnly(this->m_oStats += oBand.oStats;)
+            for(const DeferredSpreadUpdate& oUpdate : oBand.vDeferredUpdates)
+                commitDeferredSpreadUpdate(oUpdate);
         }
     }
 #if DISPLAY_SUBSENSE_DEBUG_INFO
     cv::Point2i oDbgPt(-1,-1);
-    if(m_pDisplayHelper) {
-        lv::mutex_lock_guard oLock(m_pDisplayHelper->m_oEventMutex);
-        const cv::Point2f& oDbgPt_rel = cv::Point2f(float(m_pDisplayHelper->m_oLatestMouseEvent.oPosition.x)/m_pDisplayHelper->m_oLatestMouseEvent.oDisplaySize.width,float(m_pDisplayHelper->m_oLatestMouseEvent.oPosition.y)/m_pDisplayHelper->m_oLatestMouseEvent.oDisplaySize.height);
-        oDbgPt = cv::Point2i(int(oDbgPt_rel.x*m_oImgSize.width),int(oDbgPt_rel.y*m_oImgSize.height));
+    if(this->m_pDisplayHelper) {
+        lv::mutex_lock_guard oLock(this->m_pDisplayHelper->m_oEventMutex);
+        const cv::Point2f& oDbgPt_rel = cv::Point2f(float(this->m_pDisplayHelper->m_oLatestMouseEvent.oPosition.x)/this->m_pDisplayHelper->m_oLatestMouseEvent.oDisplaySize.width,float(this->m_pDisplayHelper->m_oLatestMouseEvent.oPosition.y)/this->m_pDisplayHelper->m_oLatestMouseEvent.oDisplaySize.height);
+        oDbgPt = cv::Point2i(int(oDbgPt_rel.x*this->m_oImgSize.width),int(oDbgPt_rel.y*this->m_oImgSize.height));
     }
-    if(oDbgPt.x>=0 && oDbgPt.x<m_oImgSize.width && oDbgPt.y>=0 && oDbgPt.y<m_oImgSize.height) {
+    if(oDbgPt.x>=0 && oDbgPt.x<this->m_oImgSize.width && oDbgPt.y>=0 && oDbgPt.y<this->m_oImgSize.height) {
+        if(m_bUseCompactState)
+            unpackCompactState();
         std::cout << std::endl;
         cv::Mat oMeanMinDistFrameNormalized;
         m_oMeanMinDistFrame_ST.copyTo(oMeanMinDistFrameNormalized);
@@ -533,35 +1000,42 @@ void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray
         std::cout << std::fixed << std::setprecision(5) << "      t(" << oDbgPt << ") = " << m_oUpdateRateFrame.at<float>(oDbgPt) << std::endl;
     }
 #endif //DISPLAY_SUBSENSE_DEBUG_INFO
-    cv::bitwise_xor(oCurrFGMask,m_oLastRawFGMask,m_oCurrRawFGBlinkMask);
-    cv::bitwise_or(m_oCurrRawFGBlinkMask,m_oLastRawFGBlinkMask,m_oBlinksFrame);
-    m_oCurrRawFGBlinkMask.copyTo(m_oLastRawFGBlinkMask);
-    oCurrFGMask.copyTo(m_oLastRawFGMask);
-    cv::morphologyEx(oCurrFGMask,m_oFGMask_PreFlood,cv::MORPH_CLOSE,m_oMorphExStructElement);
-    m_oFGMask_PreFlood.copyTo(m_oFGMask_FloodedHoles);
-    cv::floodFill(m_oFGMask_FloodedHoles,cv::Point(0,0),UCHAR_MAX);
-    cv::bitwise_not(m_oFGMask_FloodedHoles,m_oFGMask_FloodedHoles);
-    cv::erode(m_oFGMask_PreFlood,m_oFGMask_PreFlood,cv::Mat(),cv::Point(-1,-1),3);
-    cv::bitwise_or(oCurrFGMask,m_oFGMask_FloodedHoles,oCurrFGMask);
-    cv::bitwise_or(oCurrFGMask,m_oFGMask_PreFlood,oCurrFGMask);
-    cv::medianBlur(oCurrFGMask,m_oLastFGMask,m_nMedianBlurKernelSize);
-    cv::dilate(m_oLastFGMask,m_oLastFGMask_dilated,cv::Mat(),cv::Point(-1,-1),3);
-    cv::bitwise_and(m_oBlinksFrame,m_oLastFGMask_dilated_inverted,m_oBlinksFrame);
-    cv::bitwise_not(m_oLastFGMask_dilated,m_oLastFGMask_dilated_inverted);
-    cv::bitwise_and(m_oBlinksFrame,m_oLastFGMask_dilated_inverted,m_oBlinksFrame);
-    m_oLastFGMask.copyTo(oCurrFGMask);
-    cv::addWeighted(m_oMeanFinalSegmResFrame_LT,(1.0f-fRollAvgFactor_LT),m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_LT,0,m_oMeanFinalSegmResFrame_LT,CV_32F);
-    cv::addWeighted(m_oMeanFinalSegmResFrame_ST,(1.0f-fRollAvgFactor_ST),m_oLastFGMask,(1.0/UCHAR_MAX)*fRollAvgFactor_ST,0,m_oMeanFinalSegmResFrame_ST,CV_32F);
-    const float fCurrNonZeroDescRatio = (float)nNonZeroDescCount/m_nTotRelevantPxCount;
+    lvBGSStatsOnly(lv::StopWatch oStageStopWatch;)
+    if(m_pPostProcWorker) {
+        // the previous frame's job overlapped with this frame's pixel loop; its maps are published here for the next one
+        // (only the stall & hand-off times are counted in the post-processing stage stats, as the job itself runs off the critical path)
+        syncPostProcessing();
+        initPostProcTiles();
+        oCurrFGMask.copyTo(m_oPostProcFGMask);
+        m_oPostProcJobResult = m_pPostProcWorker->queueTask([this,fRollAvgFactor_LT,fRollAvgFactor_ST]() {
+            postProcess(m_oPostProcFGMask,m_oPostProcLastFGMask,m_oPostProcBlinksFrame,m_oPostProcMeanFinalSegmResFrame_LT,m_oPostProcMeanFinalSegmResFrame_ST,m_voPostProcBlobs,fRollAvgFactor_LT,fRollAvgFactor_ST);
+        });
+        // output is delayed by one frame (i.e. it holds the final mask of the previous frame, published above)
+        this->m_oLastFGMask.copyTo(oCurrFGMask);
+    }
+    else {
+        initPostProcTiles();
+        postProcess(oCurrFGMask,this->m_oLastFGMask,m_oBlinksFrame,m_oMeanFinalSegmResFrame_LT,m_oMeanFinalSegmResFrame_ST,this->m_voLatestBlobs,fRollAvgFactor_LT,fRollAvgFactor_ST);
+    }
+    lvBGSStatsOnly(this->m_oStats.adStageTimes[BackgroundSubtractorStats::Stage_PostProcessing] += oStageStopWatch.tock();)
+    analyzeFrameLevel(oInputImg,nNonZeroDescCount,fRollAvgFactor_LT,fRollAvgFactor_ST);
+    lvBGSStatsOnly(this->m_oStats.adStageTimes[BackgroundSubtractorStats::Stage_FrameLevelAnalysis] += oStageStopWatch.elapsed(); ++this->m_oStats.nFrames;)
+    this->refineReducedResMask(oFullInputImg,oInputImg,oCurrFGMask,_fgmask);
+    this->endBudgetedFrame();
+}
+
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::analyzeFrameLevel(const cv::Mat& oInputImg, size_t nNonZeroDescCount, float fRollAvgFactor_LT, float fRollAvgFactor_ST) {
+    const float fCurrNonZeroDescRatio = (float)nNonZeroDescCount/this->m_nTotRelevantPxCount;
     if(fCurrNonZeroDescRatio<LBSPDESC_NONZERO_RATIO_MIN && m_fLastNonZeroDescRatio<LBSPDESC_NONZERO_RATIO_MIN) {
         for(size_t t=0; t<=UCHAR_MAX; ++t)
-            if(m_anLBSPThreshold_8bitLUT[t]>cv::saturate_cast<uchar>(m_nLBSPThresholdOffset+ceil(t*m_fRelLBSPThreshold/4)))
-                --m_anLBSPThreshold_8bitLUT[t];
+            if(this->m_anLBSPThreshold_8bitLUT[t]>cv::saturate_cast<uchar>(this->m_nLBSPThresholdOffset+ceil(t*this->m_fRelLBSPThreshold/4)))
+                --this->m_anLBSPThreshold_8bitLUT[t];
     }
     else if(fCurrNonZeroDescRatio>LBSPDESC_NONZERO_RATIO_MAX && m_fLastNonZeroDescRatio>LBSPDESC_NONZERO_RATIO_MAX) {
         for(size_t t=0; t<=UCHAR_MAX; ++t)
-            if(m_anLBSPThreshold_8bitLUT[t]<cv::saturate_cast<uchar>(m_nLBSPThresholdOffset+UCHAR_MAX*m_fRelLBSPThreshold))
-                ++m_anLBSPThreshold_8bitLUT[t];
+            if(this->m_anLBSPThreshold_8bitLUT[t]<cv::saturate_cast<uchar>(this->m_nLBSPThresholdOffset+UCHAR_MAX*this->m_fRelLBSPThreshold))
+                ++this->m_anLBSPThreshold_8bitLUT[t];
     }
     m_fLastNonZeroDescRatio = fCurrNonZeroDescRatio;
     if(m_bLearningRateScalingEnabled) {
@@ -573,7 +1047,7 @@ void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray
             const size_t idx1 = m_oMeanDownSampledLastDistFrame_ST.step.p[0]*i;
             for(int j=0; j<m_oMeanDownSampledLastDistFrame_ST.cols; ++j) {
                 const size_t idx2 = idx1+m_oMeanDownSampledLastDistFrame_ST.step.p[1]*j;
-                nTotColorDiff += (m_nImgChannels==1)?
+                nTotColorDiff += (this->m_nImgChannels==1)?
                     (size_t)fabs((*(float*)(m_oMeanDownSampledLastDistFrame_ST.data+idx2))-(*(float*)(m_oMeanDownSampledLastDistFrame_LT.data+idx2)))/2
                             :  //(m_nImgChannels==3)
                         std::max((size_t)fabs((*(float*)(m_oMeanDownSampledLastDistFrame_ST.data+idx2))-(*(float*)(m_oMeanDownSampledLastDistFrame_LT.data+idx2))),
@@ -582,21 +1056,25 @@ void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray
             }
         }
         const float fCurrColorDiffRatio = (float)nTotColorDiff/(m_oMeanDownSampledLastDistFrame_ST.rows*m_oMeanDownSampledLastDistFrame_ST.cols);
-        if(m_bAutoModelResetEnabled) {
-            if(m_nFramesSinceLastReset>1000)
-                m_bAutoModelResetEnabled = false;
-            else if(fCurrColorDiffRatio>=FRAMELEVEL_MIN_COLOR_DIFF_THRESHOLD && m_nModelResetCooldown==0) {
-                m_nFramesSinceLastReset = 0;
+        if(this->m_bAutoModelResetEnabled) {
+            if(this->m_nFramesSinceLastReset>1000)
+                this->m_bAutoModelResetEnabled = false;
+            else if(fCurrColorDiffRatio>=FRAMELEVEL_MIN_COLOR_DIFF_THRESHOLD && this->m_nModelResetCooldown==0) {
+                this->m_nFramesSinceLastReset = 0;
                 refreshModel(0.1f); // reset 10% of the bg model
-                m_nModelResetCooldown = m_nSamplesForMovingAvgs/4;
+                lvBGSStatsOnly(++this->m_oStats.nModelResets;)
+                this->m_nModelResetCooldown = m_nSamplesForMovingAvgs/4;
                 m_oUpdateRateFrame = cv::Scalar(1.0f);
+                if(m_bUseCompactState)
+                    for(CompactPxState& oState : m_voCompactState)
+                        oState.anVals[CompactState_UpdateRate] = packCompactStateValue(1.0f,s_afCompactStateScales[CompactState_UpdateRate]);
             }
             else
-                ++m_nFramesSinceLastReset;
+                ++this->m_nFramesSinceLastReset;
         }
         else if(fCurrColorDiffRatio>=FRAMELEVEL_MIN_COLOR_DIFF_THRESHOLD*2) {
-            m_nFramesSinceLastReset = 0;
-            m_bAutoModelResetEnabled = true;
+            this->m_nFramesSinceLastReset = 0;
+            this->m_bAutoModelResetEnabled = true;
         }
         if(fCurrColorDiffRatio>=FRAMELEVEL_MIN_COLOR_DIFF_THRESHOLD/2) {
             m_fCurrLearningRateLowerCap = (float)std::max((int)FEEDBACK_T_LOWER>>(int)(fCurrColorDiffRatio/2),1);
@@ -606,44 +1084,154 @@ void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray
             m_fCurrLearningRateLowerCap = FEEDBACK_T_LOWER;
             m_fCurrLearningRateUpperCap = FEEDBACK_T_UPPER;
         }
-        if(m_nModelResetCooldown>0)
-            --m_nModelResetCooldown;
+        if(this->m_nModelResetCooldown>0)
+            --this->m_nModelResetCooldown;
     }
 }
 
-void BackgroundSubtractorSuBSENSE::getBackgroundImage(cv::OutputArray backgroundImage) const {
-    lvAssert_(m_bInitialized,"algo must be initialized first");
-    cv::Mat oAvgBGImg = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t s=0; s<m_nBGSamples; ++s) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_nimg = m_voBGColorSamples[s].step.p[0]*y + m_voBGColorSamples[s].step.p[1]*x;
-                const size_t nFloatIter = idx_nimg*4;
-                float* oAvgBgImgPtr = (float*)(oAvgBGImg.data+nFloatIter);
-                const uchar* const oBGImgPtr = m_voBGColorSamples[s].data+idx_nimg;
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/m_nBGSamples;
-            }
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::getBackgroundImage(cv::OutputArray backgroundImage) const {
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
+    cv::Mat oAvgBGImg = cv::Mat::zeros(this->m_oImgSize,CV_32FC((int)this->m_nImgChannels));
+    // pixels are walked on the outside so that the pixel-major store is read sequentially (one block per pixel)
+    for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgImgPtr = ((float*)oAvgBGImg.data)+nPxIter*this->m_nImgChannels;
+        for(size_t s=0; s<m_nBGSamples; ++s) {
+            const uchar* const oBGImgPtr = m_oBGSamples.color(s,nPxIter);
+            for(size_t c=0; c<this->m_nImgChannels; ++c)
+                oAvgBgImgPtr[c] += ((float)oBGImgPtr[c])/m_nBGSamples;
         }
     }
     oAvgBGImg.convertTo(backgroundImage,CV_8U);
 }
 
-void BackgroundSubtractorSuBSENSE::getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const {
+template<lv::ParallelAlgoType eImpl>
+void BackgroundSubtractorSuBSENSE_<eImpl>::getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const {
     static_assert(LBSP::DESC_SIZE==2,"bad assumptions in impl below");
-    lvAssert_(m_bInitialized,"algo must be initialized first");
-    cv::Mat oAvgBGDesc = cv::Mat::zeros(m_oImgSize,CV_32FC((int)m_nImgChannels));
-    for(size_t n=0; n<m_voBGDescSamples.size(); ++n) {
-        for(int y=0; y<m_oImgSize.height; ++y) {
-            for(int x=0; x<m_oImgSize.width; ++x) {
-                const size_t idx_ndesc = m_voBGDescSamples[n].step.p[0]*y + m_voBGDescSamples[n].step.p[1]*x;
-                const size_t nFloatIter = idx_ndesc*2;
-                float* oAvgBgDescPtr = (float*)(oAvgBGDesc.data+nFloatIter);
-                const ushort* const oBGDescPtr = (ushort*)(m_voBGDescSamples[n].data+idx_ndesc);
-                for(size_t c=0; c<m_nImgChannels; ++c)
-                    oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_voBGDescSamples.size();
-            }
+    lvAssert_(this->m_bInitialized,"algo must be initialized first");
+    cv::Mat oAvgBGDesc = cv::Mat::zeros(this->m_oImgSize,CV_32FC((int)this->m_nImgChannels));
+    for(size_t nPxIter=0; nPxIter<this->m_nTotPxCount; ++nPxIter) {
+        float* oAvgBgDescPtr = ((float*)oAvgBGDesc.data)+nPxIter*this->m_nImgChannels;
+        for(size_t n=0; n<m_oBGSamples.samples(); ++n) {
+            const ushort* const oBGDescPtr = m_oBGSamples.desc(n,nPxIter);
+            for(size_t c=0; c<this->m_nImgChannels; ++c)
+                oAvgBgDescPtr[c] += ((float)oBGDescPtr[c])/m_oBGSamples.samples();
         }
     }
     oAvgBGDesc.convertTo(backgroundDescImage,CV_16U);
 }
+
+template<>
+void BackgroundSubtractorSuBSENSE::setParallelBandCount(size_t nBandCount, uint32_t nSeed) {
+    m_nParallelBandCount = nBandCount;
+    m_nParallelSeed = nSeed;
+    if(m_bInitialized)
+        initParallelBands();
+}
+
+template<>
+size_t BackgroundSubtractorSuBSENSE::getParallelBandCount() const {
+    return m_nParallelBandCount;
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE::initParallelBands() {
+    m_voParallelBands.clear();
+    if(m_nParallelBandCount==0 || m_oImgSize.height<=0)
+        return;
+    const int nBandCount = std::min((int)m_nParallelBandCount,m_oImgSize.height);
+    m_voParallelBands.resize((size_t)nBandCount);
+    const auto pLUTBeg = m_vnPxIdxLUT.begin(), pLUTEnd = m_vnPxIdxLUT.begin()+m_nTotRelevantPxCount;
+    for(int nBandIdx=0; nBandIdx<nBandCount; ++nBandIdx) {
+        ParallelBandInfo& oBand = m_voParallelBands[nBandIdx];
+        const int nRowBeg = (m_oImgSize.height*nBandIdx)/nBandCount, nRowEnd = (m_oImgSize.height*(nBandIdx+1))/nBandCount;
+        oBand.oRect = cv::Rect(0,nRowBeg,m_oImgSize.width,nRowEnd-nRowBeg);
+        // pixel LUT is sorted in raster order, so each row range maps to a contiguous model index range
+        oBand.oModelIters.add(size_t(std::lower_bound(pLUTBeg,pLUTEnd,size_t(nRowBeg*m_oImgSize.width))-pLUTBeg),
+                              size_t(std::lower_bound(pLUTBeg,pLUTEnd,size_t(nRowEnd*m_oImgSize.width))-pLUTBeg));
+        oBand.nNonZeroDescCount = 0;
+    }
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE::processParallelBands(const std::function<void(size_t)>& lBandFunc) {
+#if USING_OPENMP
+    #pragma omp parallel for schedule(dynamic,1)
+#endif //USING_OPENMP
+    for(int nBandIdx=0; nBandIdx<(int)m_voParallelBands.size(); ++nBandIdx)
+        lBandFunc((size_t)nBandIdx);
+}
+
+template<>
+int BackgroundSubtractorSuBSENSE::getParallelBandSeed(size_t nBandIdx, size_t nFrameIdx) const {
+    return lv::getTileFrameSeed(m_nParallelSeed,nBandIdx,nFrameIdx);
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE::initPostProcTiles() {
+    m_voPostProcTiles.clear(); // row bands always use the full-frame post-processing chain
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE::processPostProcTiles(const std::function<void(size_t)>& lTileFunc) {
+    for(size_t nTileIdx=0; nTileIdx<m_voPostProcTiles.size(); ++nTileIdx)
+        lTileFunc(nTileIdx);
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::setParallelBandCount(size_t nBandCount, uint32_t nSeed) {
+    lvAssert_(nBandCount>0,"multi-threaded impl cannot use the legacy serial loop");
+    setTileCount(nBandCount);
+    setRandomSeed(nSeed);
+    if(m_bInitialized)
+        initParallelBands();
+}
+
+template<>
+size_t BackgroundSubtractorSuBSENSE_CPUThreads::getParallelBandCount() const {
+    return getTileCount();
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::initParallelBands() {
+    // bands mirror the tile LUT, which the multi-threaded interface rebuilds on every (re)initialization
+    m_voParallelBands.resize(m_voTiles.size());
+    for(size_t nBandIdx=0; nBandIdx<m_voTiles.size(); ++nBandIdx) {
+        ParallelBandInfo& oBand = m_voParallelBands[nBandIdx];
+        oBand.oModelIters = m_voTiles[nBandIdx].oModelIters;
+        oBand.oRect = m_voTiles[nBandIdx].oRect;
+        oBand.nNonZeroDescCount = 0;
+    }
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::processParallelBands(const std::function<void(size_t)>& lBandFunc) {
+    // tile layout may have been changed via 'setTileCount' or 'setTileSize' since the last call
+    if(m_voParallelBands.size()!=m_voTiles.size() || !std::equal(m_voTiles.begin(),m_voTiles.end(),m_voParallelBands.begin(),
+                                                                 [](const TileInfo& oTile, const ParallelBandInfo& oBand){return oTile.oRect==oBand.oRect;}))
+        initParallelBands();
+    processTiles(lBandFunc);
+}
+
+template<>
+int BackgroundSubtractorSuBSENSE_CPUThreads::getParallelBandSeed(size_t nBandIdx, size_t nFrameIdx) const {
+    return getTileSeed(nBandIdx,nFrameIdx);
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::initPostProcTiles() {
+    // only 2d tiles are post-processed independently; row tiles keep the full-frame chain, and so does pipelined mode, as its
+    // post-processing thread would otherwise share the pool with the pixel loop of the next frame (tiled results are bit-exact)
+    m_voPostProcTiles.clear();
+    if(getTileSize().area()>0 && !m_pPostProcWorker)
+        for(const TileInfo& oTile : m_voTiles)
+            m_voPostProcTiles.push_back(oTile.oRect);
+}
+
+template<>
+void BackgroundSubtractorSuBSENSE_CPUThreads::processPostProcTiles(const std::function<void(size_t)>& lTileFunc) {
+    parallelFor(m_voPostProcTiles.size(),lTileFunc);
+}
+
+template struct BackgroundSubtractorSuBSENSE_<lv::CPUThreads>;
+template struct BackgroundSubtractorSuBSENSE_<lv::NonParallel>;
@@ -16,6 +16,7 @@
 // limitations under the License.
 
 #include "litiv/video/BackgroundSubtractorViBe.hpp"
+#include "litiv/video/BackgroundSubtractionUtils.hpp"
 #include "litiv/utils/math.hpp"
 #include "litiv/utils/opencv.hpp"
 
@@ -189,3 +190,228 @@ void BackgroundSubtractorViBe_3ch::apply(cv::InputArray _image, cv::OutputArray
         }
     }
 }
+
+namespace {
+
+    /// number of 8-bit samples processed per SIMD block in the pixel-major layout (also the sample stride alignment)
+    constexpr size_t s_nSampleBlockSize = 16;
+
+    /// returns the bitmask of valid lanes for the sample block starting at 'nBlockIdx' (padding lanes must never count as matches)
+    inline uint32_t getValidLaneMask(size_t nBlockIdx, size_t nBGSamples) {
+        return (nBGSamples-nBlockIdx>=s_nSampleBlockSize)?0xFFFFu:((1u<<(nBGSamples-nBlockIdx))-1u);
+    }
+
+    /// returns whether enough of the pixel's samples are within the color distance threshold (1ch version, with per-block early exit)
+    inline bool isBGMatch_1ch(const uchar* pnInputPx, const uchar* pnPxSamples, size_t nSampleStride,
+                              size_t nBGSamples, size_t nRequiredBGSamples, size_t nColorDistThreshold, bool bUseSIMD) {
+        size_t nGoodSamplesCount = 0;
+        if(nColorDistThreshold==0)
+            return nRequiredBGSamples==0;
+#if HAVE_SSE2
+        if(bUseSIMD) {
+            const __m128i anInput = _mm_set1_epi8((char)pnInputPx[0]);
+            const __m128i anMaxDist = _mm_set1_epi8((char)(std::min(nColorDistThreshold,size_t(UCHAR_MAX+1))-1));
+            for(size_t nBlockIdx=0; nBlockIdx<nSampleStride && nGoodSamplesCount<nRequiredBGSamples; nBlockIdx+=s_nSampleBlockSize) {
+                const __m128i anDist = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+nBlockIdx)),anInput);
+                const uint32_t nMatchMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(anDist,anMaxDist),anDist));
+                nGoodSamplesCount += lv::popcount(nMatchMask&getValidLaneMask(nBlockIdx,nBGSamples));
+            }
+            return nGoodSamplesCount>=nRequiredBGSamples;
+        }
+#else //(!HAVE_SSE2)
+        lvIgnore(nSampleStride);
+        lvIgnore(bUseSIMD);
+#endif //(!HAVE_SSE2)
+        for(size_t nSampleIdx=0; nSampleIdx<nBGSamples && nGoodSamplesCount<nRequiredBGSamples; ++nSampleIdx)
+            if(lv::L1dist(pnInputPx[0],pnPxSamples[nSampleIdx])<nColorDistThreshold)
+                ++nGoodSamplesCount;
+        return nGoodSamplesCount>=nRequiredBGSamples;
+    }
+
+    /// returns whether enough of the pixel's samples are within the color distance threshold (3ch version, with per-block early exit)
+    inline bool isBGMatch_3ch(const uchar* pnInputPx, const uchar* pnPxSamples, size_t nSampleStride,
+                              size_t nBGSamples, size_t nRequiredBGSamples, size_t nColorDistThreshold, bool bUseSIMD) {
+        size_t nGoodSamplesCount = 0;
+#if BGSVIBE_USE_SC_THRS_VALIDATION
+        const size_t nCurrSCColorDistThreshold = (size_t)(nColorDistThreshold*BGSVIBE_SINGLECHANNEL_THRESHOLD_DIFF_FACTOR)/3;
+#endif //BGSVIBE_USE_SC_THRS_VALIDATION
+#if HAVE_SSE2
+        if(bUseSIMD) {
+            const __m128i anInput[3] = {_mm_set1_epi8((char)pnInputPx[0]),_mm_set1_epi8((char)pnInputPx[1]),_mm_set1_epi8((char)pnInputPx[2])};
+#if BGSVIBE_USE_SC_THRS_VALIDATION
+            const __m128i anMaxSCDist = _mm_set1_epi8((char)std::min(nCurrSCColorDistThreshold,size_t(UCHAR_MAX)));
+#endif //BGSVIBE_USE_SC_THRS_VALIDATION
+#if BGSVIBE_USE_L1_DISTANCE_CHECK
+            const __m128i anDistThreshold = _mm_set1_epi16((short)std::min(nColorDistThreshold*3,size_t(UCHAR_MAX*3+1)));
+#else //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+            const size_t nDistThreshold = std::min(nColorDistThreshold*3,size_t(UCHAR_MAX*2));
+            const __m128i anSqrDistThreshold = _mm_set1_epi32((int)(nDistThreshold*nDistThreshold));
+#endif //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+            const __m128i anZero = _mm_setzero_si128();
+            for(size_t nBlockIdx=0; nBlockIdx<nSampleStride && nGoodSamplesCount<nRequiredBGSamples; nBlockIdx+=s_nSampleBlockSize) {
+                __m128i anDist[3], anDistLo[3], anDistHi[3];
+                for(size_t c=0; c<3; ++c) {
+                    anDist[c] = lv::absdiff_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+c*nSampleStride+nBlockIdx)),anInput[c]);
+                    anDistLo[c] = _mm_unpacklo_epi8(anDist[c],anZero);
+                    anDistHi[c] = _mm_unpackhi_epi8(anDist[c],anZero);
+                }
+#if BGSVIBE_USE_L1_DISTANCE_CHECK
+                const __m128i abMatchedLo = _mm_cmplt_epi16(_mm_add_epi16(_mm_add_epi16(anDistLo[0],anDistLo[1]),anDistLo[2]),anDistThreshold);
+                const __m128i abMatchedHi = _mm_cmplt_epi16(_mm_add_epi16(_mm_add_epi16(anDistHi[0],anDistHi[1]),anDistHi[2]),anDistThreshold);
+#else //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+                const __m128i abMatchedLo = _mm_packs_epi32(_mm_cmplt_epi32(lv::sqrsum3_16i<true>(anDistLo[0],anDistLo[1],anDistLo[2]),anSqrDistThreshold),
+                                                            _mm_cmplt_epi32(lv::sqrsum3_16i<false>(anDistLo[0],anDistLo[1],anDistLo[2]),anSqrDistThreshold));
+                const __m128i abMatchedHi = _mm_packs_epi32(_mm_cmplt_epi32(lv::sqrsum3_16i<true>(anDistHi[0],anDistHi[1],anDistHi[2]),anSqrDistThreshold),
+                                                            _mm_cmplt_epi32(lv::sqrsum3_16i<false>(anDistHi[0],anDistHi[1],anDistHi[2]),anSqrDistThreshold));
+#endif //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+                uint32_t nMatchMask = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(abMatchedLo,abMatchedHi));
+#if BGSVIBE_USE_SC_THRS_VALIDATION
+                for(size_t c=0; c<3; ++c)
+                    nMatchMask &= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(anDist[c],anMaxSCDist),anDist[c]));
+#endif //BGSVIBE_USE_SC_THRS_VALIDATION
+                nGoodSamplesCount += lv::popcount(nMatchMask&getValidLaneMask(nBlockIdx,nBGSamples));
+            }
+            return nGoodSamplesCount>=nRequiredBGSamples;
+        }
+#else //(!HAVE_SSE2)
+        lvIgnore(nSampleStride);
+        lvIgnore(bUseSIMD);
+#endif //(!HAVE_SSE2)
+        for(size_t nSampleIdx=0; nSampleIdx<nBGSamples && nGoodSamplesCount<nRequiredBGSamples; ++nSampleIdx) {
+            const std::array<uchar,3> anSample = {{pnPxSamples[nSampleIdx],pnPxSamples[nSampleStride+nSampleIdx],pnPxSamples[nSampleStride*2+nSampleIdx]}};
+#if BGSVIBE_USE_SC_THRS_VALIDATION
+            if(lv::L1dist(pnInputPx[0],anSample[0])>nCurrSCColorDistThreshold ||
+               lv::L1dist(pnInputPx[1],anSample[1])>nCurrSCColorDistThreshold ||
+               lv::L1dist(pnInputPx[2],anSample[2])>nCurrSCColorDistThreshold)
+                continue;
+#endif //BGSVIBE_USE_SC_THRS_VALIDATION
+#if BGSVIBE_USE_L1_DISTANCE_CHECK
+            if(lv::L1dist<3>(pnInputPx,anSample.data())<nColorDistThreshold*3)
+#else //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+            if(lv::L2dist<3>(pnInputPx,anSample.data())<nColorDistThreshold*3)
+#endif //(!BGSVIBE_USE_L1_DISTANCE_CHECK)
+                ++nGoodSamplesCount;
+        }
+        return nGoodSamplesCount>=nRequiredBGSamples;
+    }
+
+} // anonymous namespace
+
+template<size_t nChannels>
+BackgroundSubtractorViBe_vec<nChannels>::BackgroundSubtractorViBe_vec(size_t nColorDistThreshold, size_t nBGSamples, size_t nRequiredBGSamples) :
+        BackgroundSubtractorViBe(nColorDistThreshold,nBGSamples,nRequiredBGSamples),
+        m_nSampleStride(((nBGSamples+s_nSampleBlockSize-1)/s_nSampleBlockSize)*s_nSampleBlockSize),
+        m_nRandSeed(0),
+        m_bUseSIMD(true) {
+    m_voBGImg.clear(); // samples are kept in the pixel-major buffer instead
+}
+
+template<size_t nChannels>
+BackgroundSubtractorViBe_vec<nChannels>::~BackgroundSubtractorViBe_vec() {}
+
+template<size_t nChannels>
+void BackgroundSubtractorViBe_vec<nChannels>::setRandomSeed(uint32_t nSeed) {
+    m_nRandSeed = nSeed;
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorViBe_vec<nChannels>::initialize(const cv::Mat& oInitImg) {
+    lvAssert(!oInitImg.empty() && oInitImg.cols>0 && oInitImg.rows>0);
+    lvAssert(oInitImg.isContinuous());
+    const cv::Mat oInitImgConv = lv::getConvertedInput(oInitImg,(int)nChannels);
+    m_oImgSize = oInitImgConv.size();
+    const size_t nPxStride = m_nSampleStride*nChannels;
+    // padding lanes stay null forever (they are masked out when matching, and do not bias background image sums)
+    m_vnBGSamples.assign(m_oImgSize.area()*nPxStride,uchar(0));
+    m_oRandGen.seed(m_nRandSeed);
+    std::array<uint32_t,4> anRand;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            uchar* const pnPxSamples = m_vnBGSamples.data()+(size_t(y)*m_oImgSize.width+x)*nPxStride;
+            for(size_t s=0; s<m_nBGSamples; ++s) {
+                if((s%anRand.size())==0)
+                    m_oRandGen.next(anRand);
+                int y_sample, x_sample;
+                lv::getSamplePosition_7x7_std2((int)anRand[s%anRand.size()],x_sample,y_sample,x,y,0,m_oImgSize);
+                const uchar* const pnSamplePx = oInitImgConv.ptr<uchar>(y_sample)+x_sample*nChannels;
+                for(size_t c=0; c<nChannels; ++c)
+                    pnPxSamples[c*m_nSampleStride+s] = pnSamplePx[c];
+            }
+        }
+    }
+    m_bInitialized = true;
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorViBe_vec<nChannels>::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRate) {
+    lvAssert(m_bInitialized);
+    lvAssert(learningRate>0);
+    const cv::Mat oInputImg = lv::getConvertedInput(_image.getMat(),(int)nChannels);
+    lvAssert(oInputImg.size()==m_oImgSize);
+    _fgmask.create(m_oImgSize,CV_8UC1);
+    cv::Mat oFGMask = _fgmask.getMat();
+    const size_t nLearningRate = (size_t)ceil(learningRate);
+    const size_t nPxStride = m_nSampleStride*nChannels;
+    std::array<uint32_t,4> anRand;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        const uchar* const pnInputRow = oInputImg.ptr<uchar>(y);
+        uchar* const pnFGMaskRow = oFGMask.ptr<uchar>(y);
+        uchar* const pnSamplesRow = m_vnBGSamples.data()+size_t(y)*m_oImgSize.width*nPxStride;
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            const uchar* const pnInputPx = pnInputRow+x*nChannels;
+            uchar* const pnPxSamples = pnSamplesRow+x*nPxStride;
+            const bool bMatched = (nChannels==1)?
+                isBGMatch_1ch(pnInputPx,pnPxSamples,m_nSampleStride,m_nBGSamples,m_nRequiredBGSamples,m_nColorDistThreshold,m_bUseSIMD):
+                isBGMatch_3ch(pnInputPx,pnPxSamples,m_nSampleStride,m_nBGSamples,m_nRequiredBGSamples,m_nColorDistThreshold,m_bUseSIMD);
+            if(!bMatched) {
+                pnFGMaskRow[x] = UCHAR_MAX;
+                continue;
+            }
+            pnFGMaskRow[x] = 0;
+            m_oRandGen.next(anRand);
+            if((anRand[0]%nLearningRate)==0) {
+                const size_t s_rand = anRand[2]%m_nBGSamples;
+                for(size_t c=0; c<nChannels; ++c)
+                    pnPxSamples[c*m_nSampleStride+s_rand] = pnInputPx[c];
+            }
+            if((anRand[1]%nLearningRate)==0) {
+                int x_rand,y_rand;
+                lv::getNeighborPosition_3x3((int)anRand[3],x_rand,y_rand,x,y,0,m_oImgSize);
+                const size_t s_rand = (anRand[3]>>3)%m_nBGSamples; // low bits already picked the neighbor
+                uchar* const pnNeighborSamples = m_vnBGSamples.data()+(size_t(y_rand)*m_oImgSize.width+x_rand)*nPxStride;
+                for(size_t c=0; c<nChannels; ++c)
+                    pnNeighborSamples[c*m_nSampleStride+s_rand] = pnInputPx[c];
+            }
+        }
+    }
+}
+
+template<size_t nChannels>
+void BackgroundSubtractorViBe_vec<nChannels>::getBackgroundImage(cv::OutputArray backgroundImage) const {
+    lvAssert(m_bInitialized);
+    backgroundImage.create(m_oImgSize,CV_8UC((int)nChannels));
+    cv::Mat oBGImg = backgroundImage.getMat();
+    const size_t nPxStride = m_nSampleStride*nChannels;
+    for(int y=0; y<m_oImgSize.height; ++y) {
+        uchar* const pnBGImgRow = oBGImg.ptr<uchar>(y);
+        for(int x=0; x<m_oImgSize.width; ++x) {
+            const uchar* const pnPxSamples = m_vnBGSamples.data()+(size_t(y)*m_oImgSize.width+x)*nPxStride;
+            for(size_t c=0; c<nChannels; ++c) {
+                size_t nSampleSum = 0;
+#if HAVE_SSE2
+                if(m_bUseSIMD) {
+                    for(size_t nBlockIdx=0; nBlockIdx<m_nSampleStride; nBlockIdx+=s_nSampleBlockSize)
+                        nSampleSum += lv::hsum_8ui(_mm_load_si128((const __m128i*)(pnPxSamples+c*m_nSampleStride+nBlockIdx)));
+                }
+                else
+#endif //HAVE_SSE2
+                for(size_t s=0; s<m_nBGSamples; ++s)
+                    nSampleSum += pnPxSamples[c*m_nSampleStride+s];
+                pnBGImgRow[x*nChannels+c] = cv::saturate_cast<uchar>(float(nSampleSum)/m_nBGSamples);
+            }
+        }
+    }
+}
+
+template class BackgroundSubtractorViBe_vec<1>;
+template class BackgroundSubtractorViBe_vec<3>;
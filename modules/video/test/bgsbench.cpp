@@ -0,0 +1,237 @@
+#include "litiv/video/BackgroundSubtractorLOBSTER.hpp"
+#include "litiv/video/BackgroundSubtractorSuBSENSE.hpp"
+#include "litiv/video/BackgroundSubtractorPAWCS.hpp"
+#include "litiv/video/BackgroundSubtractorViBe.hpp"
+#include "litiv/video/BackgroundSubtractorPBAS.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+TEST(bgsbench,synthetic_video) {
+    const cv::Size oSize(160,120);
+    for(int nChannels : {1,3}) {
+        const cv::Mat oFrameA = lv::test::genSyntheticVideoFrame(oSize,nChannels,7);
+        const cv::Mat oFrameB = lv::test::genSyntheticVideoFrame(oSize,nChannels,7);
+        ASSERT_EQ(oFrameA.size(),oSize);
+        ASSERT_EQ(oFrameA.type(),CV_8UC(nChannels));
+        ASSERT_TRUE(lv::isEqual<uchar>(oFrameA,oFrameB));
+        // background brightness must drift over time (measured away from all moving shapes)
+        const cv::Rect oStaticRegion(0,0,oSize.width/4,oSize.height/6);
+        const double dMeanStart = cv::mean(lv::test::genSyntheticVideoFrame(oSize,nChannels,0)(oStaticRegion))[0];
+        const double dMeanDrifted = cv::mean(lv::test::genSyntheticVideoFrame(oSize,nChannels,50)(oStaticRegion))[0];
+        EXPECT_GT(dMeanDrifted-dMeanStart,10.0) << "nChannels=" << nChannels;
+    }
+    const cv::Mat oROI = lv::test::genSyntheticROI(oSize);
+    ASSERT_EQ(cv::countNonZero((oROI>0)&(oROI<UCHAR_MAX)),0);
+    const double dROIRatio = double(cv::countNonZero(oROI))/oROI.total();
+    EXPECT_GT(dROIRatio,0.5);
+    EXPECT_LT(dROIRatio,0.75);
+}
+
+namespace {
+
+    /// list of benchmarked background subtraction algorithms
+    enum BenchmarkedAlgo {
+        BenchmarkedAlgo_LOBSTER,
+        BenchmarkedAlgo_SuBSENSE,
+        BenchmarkedAlgo_PAWCS,
+        BenchmarkedAlgo_ViBe,
+        BenchmarkedAlgo_PBAS,
+        BenchmarkedAlgoCount
+    };
+
+    /// type-erased algorithm wrapper (ViBe & PBAS do not share the LBSP-based algorithms' interface, and do not support ROIs)
+    struct BenchmarkedAlgoWrapper {
+        std::function<void(const cv::Mat&, const cv::Mat&)> lInitialize;
+        std::function<void(const cv::Mat&, cv::Mat&)> lApply;
+    };
+
+    bool isROISupported(BenchmarkedAlgo eAlgo) {
+        return eAlgo==BenchmarkedAlgo_LOBSTER || eAlgo==BenchmarkedAlgo_SuBSENSE || eAlgo==BenchmarkedAlgo_PAWCS;
+    }
+
+    const char* getAlgoName(BenchmarkedAlgo eAlgo) {
+        static const std::array<const char*,BenchmarkedAlgoCount> s_asAlgoNames = {{"LOBSTER","SuBSENSE","PAWCS","ViBe","PBAS"}};
+        return s_asAlgoNames[eAlgo];
+    }
+
+    template<typename TAlgo>
+    BenchmarkedAlgoWrapper wrapAlgo(std::shared_ptr<TAlgo> pAlgo) {
+        return BenchmarkedAlgoWrapper{
+            [pAlgo](const cv::Mat& oInitImg, const cv::Mat& oROI) {pAlgo->initialize(oInitImg,oROI);},
+            [pAlgo](const cv::Mat& oInput, cv::Mat& oFGMask) {pAlgo->apply(oInput,oFGMask);}
+        };
+    }
+
+    template<typename TAlgo>
+    BenchmarkedAlgoWrapper wrapAlgoNoROI(std::shared_ptr<TAlgo> pAlgo) {
+        return BenchmarkedAlgoWrapper{
+            [pAlgo](const cv::Mat& oInitImg, const cv::Mat&) {pAlgo->initialize(oInitImg);},
+            [pAlgo](const cv::Mat& oInput, cv::Mat& oFGMask) {pAlgo->apply(oInput,oFGMask);}
+        };
+    }
+
+    BenchmarkedAlgoWrapper createAlgo(BenchmarkedAlgo eAlgo, int nChannels) {
+        switch(eAlgo) {
+            case BenchmarkedAlgo_LOBSTER: return wrapAlgo(std::make_shared<BackgroundSubtractorLOBSTER>());
+            case BenchmarkedAlgo_SuBSENSE: return wrapAlgo(std::make_shared<BackgroundSubtractorSuBSENSE>());
+            case BenchmarkedAlgo_PAWCS: return wrapAlgo(std::make_shared<BackgroundSubtractorPAWCS>());
+            case BenchmarkedAlgo_ViBe:
+                if(nChannels==1)
+                    return wrapAlgoNoROI(std::make_shared<BackgroundSubtractorViBe_1ch>());
+                return wrapAlgoNoROI(std::make_shared<BackgroundSubtractorViBe_3ch>());
+            case BenchmarkedAlgo_PBAS:
+                if(nChannels==1)
+                    return wrapAlgoNoROI(std::make_shared<BackgroundSubtractorPBAS_1ch>());
+                return wrapAlgoNoROI(std::make_shared<BackgroundSubtractorPBAS_3ch>());
+            default: lvError("unexpected algo type");
+        }
+    }
+
+    /// benchmark args: {algo, width, height, channels, use ROI}
+    void setBenchmarkArgs(benchmark::internal::Benchmark* pBenchmark) {
+        for(int nAlgoIdx=0; nAlgoIdx<BenchmarkedAlgoCount; ++nAlgoIdx)
+            for(const cv::Size& oSize : {cv::Size(320,240),cv::Size(640,480),cv::Size(1280,720)})
+                for(int nChannels : {1,3})
+                    for(int nUseROI : {0,1})
+                        if(nUseROI==0 || isROISupported((BenchmarkedAlgo)nAlgoIdx))
+                            pBenchmark->Args({nAlgoIdx,oSize.width,oSize.height,nChannels,nUseROI});
+    }
+
+    void bgsbench_initialize_perftest(benchmark::State& st) {
+        const BenchmarkedAlgo eAlgo = (BenchmarkedAlgo)st.range(0);
+        const cv::Size oSize((int)st.range(1),(int)st.range(2));
+        const int nChannels = (int)st.range(3);
+        const cv::Mat oROI = st.range(4)?lv::test::genSyntheticROI(oSize):cv::Mat();
+        const cv::Mat oInitFrame = lv::test::genSyntheticVideoFrame(oSize,nChannels,0);
+        srand(0);
+        BenchmarkedAlgoWrapper oAlgo = createAlgo(eAlgo,nChannels);
+        while(st.KeepRunning())
+            oAlgo.lInitialize(oInitFrame,oROI);
+        st.SetItemsProcessed(int64_t(st.iterations())*oSize.area());
+        st.SetLabel(getAlgoName(eAlgo));
+    }
+
+    void bgsbench_apply_perftest(benchmark::State& st) {
+        const BenchmarkedAlgo eAlgo = (BenchmarkedAlgo)st.range(0);
+        const cv::Size oSize((int)st.range(1),(int)st.range(2));
+        const int nChannels = (int)st.range(3);
+        const cv::Mat oROI = st.range(4)?lv::test::genSyntheticROI(oSize):cv::Mat();
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<50; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticVideoFrame(oSize,nChannels,nFrameIdx*4));
+        srand(0);
+        BenchmarkedAlgoWrapper oAlgo = createAlgo(eAlgo,nChannels);
+        oAlgo.lInitialize(voFrames[0],oROI);
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.lApply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        // 'items' are pixels here, so the reported item rate is the pixel throughput (regardless of ROI)
+        st.SetItemsProcessed(int64_t(st.iterations())*oSize.area());
+        st.SetLabel(getAlgoName(eAlgo));
+    }
+
+    /// static scene benchmark args: {algo (LOBSTER or SuBSENSE only), width, height, use activity gating}
+    void bgsbench_static_scene_perftest(benchmark::State& st) {
+        const BenchmarkedAlgo eAlgo = (BenchmarkedAlgo)st.range(0);
+        const cv::Size oSize((int)st.range(1),(int)st.range(2));
+        const bool bUseActivityGating = st.range(3)!=0;
+        lvAssert_(eAlgo==BenchmarkedAlgo_LOBSTER || eAlgo==BenchmarkedAlgo_SuBSENSE,"activity gating is only supported by LOBSTER & SuBSENSE");
+        // mostly static footage: a single small square moves over a textured background with mild sensor noise
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<50; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        srand(0);
+        std::shared_ptr<IIBackgroundSubtractor> pAlgo;
+        BenchmarkedAlgoWrapper oAlgo;
+        if(eAlgo==BenchmarkedAlgo_LOBSTER) {
+            std::shared_ptr<BackgroundSubtractorLOBSTER> pLOBSTER = std::make_shared<BackgroundSubtractorLOBSTER>();
+            oAlgo = wrapAlgo(pLOBSTER);
+            pAlgo = pLOBSTER;
+        }
+        else {
+            std::shared_ptr<BackgroundSubtractorSuBSENSE> pSuBSENSE = std::make_shared<BackgroundSubtractorSuBSENSE>();
+            oAlgo = wrapAlgo(pSuBSENSE);
+            pAlgo = pSuBSENSE;
+        }
+        pAlgo->setActivityGating(bUseActivityGating);
+        oAlgo.lInitialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        // the bootstrap period (where gating is inactive) is excluded from the timings
+        for(size_t nFrameIdx=1; nFrameIdx<=BGS_DEFAULT_GATING_REFRESH_PERIOD; ++nFrameIdx)
+            oAlgo.lApply(voFrames[nFrameIdx],oFGMask);
+        size_t nFrameIdx = BGS_DEFAULT_GATING_REFRESH_PERIOD+1, nProcessedFrames = 0;
+        double dTotActiveBlockRatio = 0.0;
+        while(st.KeepRunning()) {
+            oAlgo.lApply(voFrames[nFrameIdx],oFGMask);
+            dTotActiveBlockRatio += pAlgo->getActiveBlockRatio();
+            ++nProcessedFrames;
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        st.SetItemsProcessed(int64_t(st.iterations())*oSize.area());
+        st.SetLabel(lv::putf("%s, %.1f%% active blocks",getAlgoName(eAlgo),nProcessedFrames?100.0*dTotActiveBlockRatio/nProcessedFrames:100.0));
+    }
+
+    /// reduced-resolution benchmark args: {algo (LBSP-based only), width, height, downscaling factor}
+    void bgsbench_reduced_res_perftest(benchmark::State& st) {
+        const BenchmarkedAlgo eAlgo = (BenchmarkedAlgo)st.range(0);
+        const cv::Size oSize((int)st.range(1),(int)st.range(2));
+        const size_t nScaleFactor = (size_t)st.range(3);
+        lvAssert_(isROISupported(eAlgo),"reduced-resolution mode is only supported by LBSP-based algorithms");
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<100; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        const auto lCreateAlgo = [&](BenchmarkedAlgoWrapper& oAlgo) {
+            std::shared_ptr<IIBackgroundSubtractor> pAlgo;
+            if(eAlgo==BenchmarkedAlgo_LOBSTER) {
+                std::shared_ptr<BackgroundSubtractorLOBSTER> pLOBSTER = std::make_shared<BackgroundSubtractorLOBSTER>();
+                oAlgo = wrapAlgo(pLOBSTER);
+                pAlgo = pLOBSTER;
+            }
+            else if(eAlgo==BenchmarkedAlgo_SuBSENSE) {
+                std::shared_ptr<BackgroundSubtractorSuBSENSE> pSuBSENSE = std::make_shared<BackgroundSubtractorSuBSENSE>();
+                oAlgo = wrapAlgo(pSuBSENSE);
+                pAlgo = pSuBSENSE;
+            }
+            else {
+                std::shared_ptr<BackgroundSubtractorPAWCS> pPAWCS = std::make_shared<BackgroundSubtractorPAWCS>();
+                oAlgo = wrapAlgo(pPAWCS);
+                pAlgo = pPAWCS;
+            }
+            pAlgo->setReducedResolution(nScaleFactor);
+            oAlgo.lInitialize(voFrames[0],cv::Mat());
+        };
+        // accuracy is measured on a separate (untimed) pass over the whole sequence, skipping the model warmup
+        srand(0);
+        BenchmarkedAlgoWrapper oAlgo;
+        lCreateAlgo(oAlgo);
+        std::vector<cv::Mat> voFGMasks(voFrames.size());
+        for(size_t nFrameIdx=0; nFrameIdx<voFrames.size(); ++nFrameIdx)
+            oAlgo.lApply(voFrames[nFrameIdx],voFGMasks[nFrameIdx]);
+        const double dFMeasure = lv::test::getSyntheticFMeasure(voFGMasks,40);
+        srand(0);
+        lCreateAlgo(oAlgo);
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.lApply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        st.SetItemsProcessed(int64_t(st.iterations())*oSize.area());
+        st.SetLabel(lv::putf("%s, 1/%d res, F-measure=%.4f",getAlgoName(eAlgo),(int)nScaleFactor,dFMeasure));
+    }
+
+}
+
+BENCHMARK(bgsbench_initialize_perftest)->Apply(setBenchmarkArgs)->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_apply_perftest)->Apply(setBenchmarkArgs)->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_static_scene_perftest)->Args({BenchmarkedAlgo_LOBSTER,640,480,0})->Args({BenchmarkedAlgo_LOBSTER,640,480,1})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_static_scene_perftest)->Args({BenchmarkedAlgo_SuBSENSE,640,480,0})->Args({BenchmarkedAlgo_SuBSENSE,640,480,1})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_reduced_res_perftest)->Args({BenchmarkedAlgo_LOBSTER,1280,720,1})->Args({BenchmarkedAlgo_LOBSTER,1280,720,2})->Args({BenchmarkedAlgo_LOBSTER,1280,720,4})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_reduced_res_perftest)->Args({BenchmarkedAlgo_SuBSENSE,1280,720,1})->Args({BenchmarkedAlgo_SuBSENSE,1280,720,2})->Args({BenchmarkedAlgo_SuBSENSE,1280,720,4})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(bgsbench_reduced_res_perftest)->Args({BenchmarkedAlgo_PAWCS,1280,720,1})->Args({BenchmarkedAlgo_PAWCS,1280,720,2})->Args({BenchmarkedAlgo_PAWCS,1280,720,4})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
@@ -0,0 +1,216 @@
+#include "litiv/video/BackgroundSubtractionEngine.hpp"
+#include "litiv/video/BackgroundSubtractorSuBSENSE.hpp"
+#include "litiv/video/BackgroundSubtractorLOBSTER.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+TEST(bgsengine,regression_stream_ordering) {
+    const size_t nStreams = 8, nFrames = 50;
+    std::vector<std::vector<size_t>> vvnOutputIdxs(nStreams);
+    std::vector<std::atomic_int> vnActiveCalls(nStreams);
+    std::atomic_bool bOverlap(false);
+    BackgroundSubtractionEngine oEngine(4,4);
+    ASSERT_EQ(oEngine.getWorkerCount(),size_t(4));
+    for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+        vnActiveCalls[nStreamIdx] = 0;
+        const size_t nNewStreamIdx = oEngine.addStream([&,nStreamIdx](const cv::Mat& oInput, cv::Mat& oFGMask, double) {
+            if(vnActiveCalls[nStreamIdx]++!=0)
+                bOverlap = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(rand()%500));
+            oFGMask = oInput.clone();
+            --vnActiveCalls[nStreamIdx];
+        },[&,nStreamIdx](size_t nFrameIdx, const cv::Mat&, const cv::Mat& oFGMask) {
+            ASSERT_EQ((size_t)oFGMask.at<int>(0,0),nFrameIdx);
+            vvnOutputIdxs[nStreamIdx].push_back(nFrameIdx);
+        });
+        ASSERT_EQ(nNewStreamIdx,nStreamIdx);
+    }
+    ASSERT_EQ(oEngine.getStreamCount(),nStreams);
+    std::vector<std::thread> vProducers;
+    for(size_t nProducerIdx=0; nProducerIdx<2; ++nProducerIdx) {
+        vProducers.emplace_back([&,nProducerIdx]() {
+            for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+                for(size_t nStreamIdx=nProducerIdx; nStreamIdx<nStreams; nStreamIdx+=2)
+                    oEngine.push(nStreamIdx,cv::Mat(1,1,CV_32SC1,cv::Scalar_<int>((int)nFrameIdx)));
+        });
+    }
+    for(std::thread& oProducer : vProducers)
+        oProducer.join();
+    oEngine.waitAll();
+    ASSERT_FALSE(bOverlap);
+    for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+        ASSERT_EQ(vvnOutputIdxs[nStreamIdx].size(),nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            ASSERT_EQ(vvnOutputIdxs[nStreamIdx][nFrameIdx],nFrameIdx);
+        const BackgroundSubtractionEngine::StreamStats oStats = oEngine.getStreamStats(nStreamIdx);
+        ASSERT_EQ(oStats.nPushedFrames,nFrames);
+        ASSERT_EQ(oStats.nProcessedFrames,nFrames);
+        ASSERT_GE(oStats.dMaxLatency,oStats.dMeanLatency);
+        ASSERT_GT(oStats.dThroughput,0.0);
+    }
+}
+
+TEST(bgsengine,regression_stream_error) {
+    BackgroundSubtractionEngine oEngine(2);
+    const size_t nStreamIdx = oEngine.addStream([](const cv::Mat& oInput, cv::Mat&, double) {
+        lvAssert_(oInput.at<uchar>(0,0)!=3,"bad frame");
+    });
+    for(uchar nVal=0; nVal<3; ++nVal)
+        oEngine.push(nStreamIdx,cv::Mat(1,1,CV_8UC1,cv::Scalar_<uchar>(nVal)));
+    ASSERT_NO_THROW(oEngine.waitStream(nStreamIdx));
+    oEngine.push(nStreamIdx,cv::Mat(1,1,CV_8UC1,cv::Scalar_<uchar>(3)));
+    ASSERT_THROW(oEngine.waitStream(nStreamIdx),lv::Exception);
+    ASSERT_EQ(oEngine.getStreamStats(nStreamIdx).nProcessedFrames,size_t(3));
+}
+
+TEST(bgsengine,regression_input_views) {
+    const size_t nFrames = 20;
+    std::atomic_size_t nReleasedViews(0);
+    std::vector<int> vnOutputVals;
+    BackgroundSubtractionEngine oEngine(2,4);
+    const size_t nStreamIdx = oEngine.addStream([](const cv::Mat& oInput, cv::Mat& oFGMask, double) {
+        oFGMask = oInput.clone();
+    },[&](size_t, const cv::Mat& oInput, const cv::Mat& oFGMask) {
+        ASSERT_EQ(oInput.at<int>(0,0),oFGMask.at<int>(0,0));
+        vnOutputVals.push_back(oFGMask.at<int>(0,0));
+    });
+    std::vector<int> vnData(nFrames);
+    for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx) {
+        // the view only wraps external data, and must stay alive until its frame has been reported
+        vnData[nFrameIdx] = (int)nFrameIdx;
+        std::shared_ptr<const cv::Mat> pView(new cv::Mat(1,1,CV_32SC1,&vnData[nFrameIdx]),[&](const cv::Mat* pMat) {
+            delete pMat;
+            ++nReleasedViews;
+        });
+        oEngine.push(nStreamIdx,std::move(pView));
+    }
+    oEngine.waitStream(nStreamIdx);
+    ASSERT_EQ(vnOutputVals.size(),nFrames);
+    for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+        ASSERT_EQ(vnOutputVals[nFrameIdx],(int)nFrameIdx);
+    // views are released before the stream is flagged as idle
+    ASSERT_EQ(nReleasedViews.load(),nFrames);
+}
+
+TEST(bgsengine,regression_subsense_vs_serial) {
+    const cv::Size oSize(160,120);
+    const size_t nStreams = 4, nFrames = 20;
+    std::vector<std::vector<cv::Mat>> vvoSerialMasks(nStreams), vvoEngineMasks(nStreams);
+    for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+        // single-band mode uses a per-instance seeded generator, so outputs do not depend on the calling thread
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setParallelBandCount(1,(uint32_t)nStreamIdx);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx) {
+            cv::Mat oFGMask;
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx+nStreamIdx),oFGMask);
+            vvoSerialMasks[nStreamIdx].push_back(oFGMask.clone());
+        }
+    }
+    {
+        BackgroundSubtractionEngine oEngine(3);
+        for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+            srand(0);
+            std::shared_ptr<BackgroundSubtractorSuBSENSE> pAlgo = std::make_shared<BackgroundSubtractorSuBSENSE>();
+            pAlgo->setParallelBandCount(1,(uint32_t)nStreamIdx);
+            pAlgo->initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+            oEngine.addStream(pAlgo,[&,nStreamIdx](size_t, const cv::Mat&, const cv::Mat& oFGMask) {
+                vvoEngineMasks[nStreamIdx].push_back(oFGMask.clone());
+            });
+        }
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx)
+                oEngine.push(nStreamIdx,lv::test::genSyntheticFrame(oSize,3,nFrameIdx+nStreamIdx));
+        oEngine.waitAll();
+    }
+    for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+        ASSERT_EQ(vvoEngineMasks[nStreamIdx].size(),nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(vvoSerialMasks[nStreamIdx][nFrameIdx]!=vvoEngineMasks[nStreamIdx][nFrameIdx]),0) << "nStreamIdx=" << nStreamIdx << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(bgsengine,regression_lobster_default_learning_rate) {
+    const cv::Size oSize(160,120);
+    const size_t nFrames = 20;
+    // LOBSTER rejects non-positive learning rates, so default pushes must fall back on the algorithm's own default
+    srand(0);
+    BackgroundSubtractorLOBSTER oAlgo;
+    const std::vector<cv::Mat> voSerialMasks = lv::test::runSyntheticSequence(oAlgo,3,nFrames,oSize);
+    std::vector<cv::Mat> voEngineMasks;
+    {
+        BackgroundSubtractionEngine oEngine(2);
+        // a single stream is the only 'rand()' consumer, so it follows the same sequence as the serial run
+        srand(0);
+        std::shared_ptr<BackgroundSubtractorLOBSTER> pAlgo = std::make_shared<BackgroundSubtractorLOBSTER>();
+        pAlgo->initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        const size_t nStreamIdx = oEngine.addStream(pAlgo,[&](size_t, const cv::Mat&, const cv::Mat& oFGMask) {
+            voEngineMasks.push_back(oFGMask.clone());
+        });
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            oEngine.push(nStreamIdx,lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        ASSERT_NO_THROW(oEngine.waitStream(nStreamIdx));
+    }
+    ASSERT_EQ(voEngineMasks.size(),nFrames);
+    for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+        ASSERT_EQ(cv::countNonZero(voSerialMasks[nFrameIdx]!=voEngineMasks[nFrameIdx]),0) << "nFrameIdx=" << nFrameIdx;
+}
+
+TEST(bgsengine,regression_sequential_batches_reproducible) {
+    const cv::Size oSize(160,120);
+    const size_t nBatches = 3, nFrames = 15;
+    // mimics the changedet scheduling with a single worker: one active stream at a time, each seeded with 'srand(0)' right before its model init
+    const auto lRun = [&]() {
+        std::vector<std::vector<cv::Mat>> vvoMasks(nBatches);
+        BackgroundSubtractionEngine oEngine(1);
+        for(size_t nBatchIdx=0; nBatchIdx<nBatches; ++nBatchIdx) {
+            srand(0);
+            std::shared_ptr<BackgroundSubtractorLOBSTER> pAlgo = std::make_shared<BackgroundSubtractorLOBSTER>();
+            pAlgo->initialize(lv::test::genSyntheticFrame(oSize,3,nBatchIdx),cv::Mat());
+            const size_t nStreamIdx = oEngine.addStream(pAlgo,[&,nBatchIdx](size_t, const cv::Mat&, const cv::Mat& oFGMask) {
+                vvoMasks[nBatchIdx].push_back(oFGMask.clone());
+            });
+            for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+                oEngine.push(nStreamIdx,lv::test::genSyntheticFrame(oSize,3,nFrameIdx+nBatchIdx));
+            oEngine.waitStream(nStreamIdx);
+        }
+        return vvoMasks;
+    };
+    const std::vector<std::vector<cv::Mat>> vvoMasks1 = lRun();
+    const std::vector<std::vector<cv::Mat>> vvoMasks2 = lRun();
+    for(size_t nBatchIdx=0; nBatchIdx<nBatches; ++nBatchIdx) {
+        ASSERT_EQ(vvoMasks1[nBatchIdx].size(),nFrames);
+        ASSERT_EQ(vvoMasks2[nBatchIdx].size(),nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(vvoMasks1[nBatchIdx][nFrameIdx]!=vvoMasks2[nBatchIdx][nFrameIdx]),0) << "nBatchIdx=" << nBatchIdx << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+namespace {
+
+    void bgsengine_perftest(benchmark::State& st) {
+        const cv::Size oSize(320,240);
+        const size_t nStreams = (size_t)st.range(0);
+        const size_t nWorkers = (size_t)st.range(1);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        BackgroundSubtractionEngine oEngine(nWorkers);
+        for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx) {
+            std::shared_ptr<BackgroundSubtractorSuBSENSE> pAlgo = std::make_shared<BackgroundSubtractorSuBSENSE>();
+            pAlgo->initialize(voFrames[0],cv::Mat());
+            oEngine.addStream(pAlgo);
+        }
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            for(size_t nStreamIdx=0; nStreamIdx<nStreams; ++nStreamIdx)
+                oEngine.push(nStreamIdx,voFrames[nFrameIdx]);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+        }
+        oEngine.waitAll();
+    }
+
+}
+
+BENCHMARK(bgsengine_perftest)->Args({16,1})->Args({16,4})->Args({16,0})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
@@ -0,0 +1,309 @@
+
+// This file is part of the LITIV framework; visit the original repository at
+// https://github.com/plstcharles/litiv for more information.
+//
+// Copyright 2015 Pierre-Luc St-Charles; pierre-luc.st-charles<at>polymtl.ca
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "litiv/test.hpp"
+#include "litiv/video/BackgroundSubtractionUtils.hpp"
+#include <opencv2/imgproc.hpp>
+
+namespace lv {
+
+    namespace test {
+
+        /// generates a textured static background with a moving foreground square (unless disabled) and mild sensor noise
+        inline cv::Mat genSyntheticFrame(const cv::Size& oSize, int nChannels, size_t nFrameIdx, bool bMovingSquare=true) {
+            cv::Mat oFrame(oSize,CV_8UC(nChannels));
+            cv::RNG oBGRNG(0x1234);
+            oBGRNG.fill(oFrame,cv::RNG::UNIFORM,cv::Scalar::all(32),cv::Scalar::all(224));
+            cv::GaussianBlur(oFrame,oFrame,cv::Size(5,5),0);
+            if(bMovingSquare) {
+                const int nSquareSize = std::max(oSize.height/5,8);
+                const int nSquareX = int((nFrameIdx*3)%size_t(std::max(oSize.width-nSquareSize,1)));
+                const int nSquareY = (oSize.height-nSquareSize)/2;
+                cv::rectangle(oFrame,cv::Rect(nSquareX,nSquareY,nSquareSize,nSquareSize),cv::Scalar::all(255),-1);
+            }
+            cv::Mat oNoise(oSize,CV_8UC(nChannels));
+            cv::RNG oNoiseRNG((uint64)(nFrameIdx+1));
+            oNoiseRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(6));
+            cv::add(oFrame,oNoise,oFrame);
+            return oFrame;
+        }
+
+        /// generates the ground truth foreground mask matching 'genSyntheticFrame' (i.e. the moving square only)
+        inline cv::Mat genSyntheticGTMask(const cv::Size& oSize, size_t nFrameIdx) {
+            cv::Mat oMask(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+            const int nSquareSize = std::max(oSize.height/5,8);
+            const int nSquareX = int((nFrameIdx*3)%size_t(std::max(oSize.width-nSquareSize,1)));
+            const int nSquareY = (oSize.height-nSquareSize)/2;
+            cv::rectangle(oMask,cv::Rect(nSquareX,nSquareY,nSquareSize,nSquareSize),cv::Scalar_<uchar>(255),-1);
+            return oMask;
+        }
+
+        /// generates a richer synthetic video frame for benchmarking (textured background, several moving shapes, sensor noise & slow global illumination drift)
+        inline cv::Mat genSyntheticVideoFrame(const cv::Size& oSize, int nChannels, size_t nFrameIdx) {
+            cv::Mat oFrame(oSize,CV_8UC(nChannels));
+            cv::RNG oBGRNG(0x4321);
+            oBGRNG.fill(oFrame,cv::RNG::UNIFORM,cv::Scalar::all(48),cv::Scalar::all(208));
+            cv::GaussianBlur(oFrame,oFrame,cv::Size(7,7),0);
+            const int nShapeSize = std::max(std::min(oSize.width,oSize.height)/8,4);
+            const int nRangeX = std::max(oSize.width-nShapeSize,1), nRangeY = std::max(oSize.height-nShapeSize,1);
+            const int nRectX = int((nFrameIdx*4)%size_t(nRangeX));
+            cv::rectangle(oFrame,cv::Rect(nRectX,oSize.height/4,nShapeSize,nShapeSize),cv::Scalar::all(240),-1);
+            const int nCircleY = int((nFrameIdx*3)%size_t(nRangeY))+nShapeSize/2;
+            cv::circle(oFrame,cv::Point(oSize.width/2,nCircleY),nShapeSize/2,cv::Scalar::all(16),-1);
+            const int nBarX = nRangeX-1-int((nFrameIdx*2)%size_t(nRangeX));
+            cv::rectangle(oFrame,cv::Rect(nBarX,(oSize.height*2)/3,nShapeSize*2,std::max(nShapeSize/3,1)),cv::Scalar(200,60,120),-1);
+            // global illumination slowly oscillates by +/-16 levels with a 200-frame period
+            const double dDrift = 16.0*std::sin(2.0*CV_PI*double(nFrameIdx%200)/200.0);
+            oFrame.convertTo(oFrame,-1,1.0,dDrift);
+            cv::Mat oNoise(oSize,CV_8UC(nChannels));
+            cv::RNG oNoiseRNG((uint64)(nFrameIdx+1));
+            oNoiseRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(8));
+            cv::add(oFrame,oNoise,oFrame);
+            return oFrame;
+        }
+
+        /// generates an elliptic region of interest mask (0/255 values) covering roughly 60% of the frame
+        inline cv::Mat genSyntheticROI(const cv::Size& oSize) {
+            cv::Mat oROI(oSize,CV_8UC1,cv::Scalar_<uchar>(0));
+            cv::ellipse(oROI,cv::Point(oSize.width/2,oSize.height/2),cv::Size((oSize.width*9)/20,(oSize.height*9)/20),0.0,0.0,360.0,cv::Scalar_<uchar>(255),-1);
+            return oROI;
+        }
+
+        /// returns the F-measure of the given output masks w.r.t. 'genSyntheticGTMask', ignoring the first 'nSkipFrames' frames (i.e. the model warmup)
+        inline double getSyntheticFMeasure(const std::vector<cv::Mat>& voMasks, size_t nSkipFrames) {
+            size_t nTP=0, nFP=0, nFN=0;
+            for(size_t nFrameIdx=nSkipFrames; nFrameIdx<voMasks.size(); ++nFrameIdx) {
+                const cv::Mat oGTMask = genSyntheticGTMask(voMasks[nFrameIdx].size(),nFrameIdx);
+                nTP += (size_t)cv::countNonZero(voMasks[nFrameIdx]&oGTMask);
+                nFP += (size_t)cv::countNonZero(voMasks[nFrameIdx]&~oGTMask);
+                nFN += (size_t)cv::countNonZero(~voMasks[nFrameIdx]&oGTMask);
+            }
+            return nTP?(2.0*nTP)/(2.0*nTP+nFP+nFN):0.0;
+        }
+
+        /// returns the F-measure of the given output masks w.r.t. reference masks (e.g. from another impl), ignoring the first 'nSkipFrames' frames
+        inline double getFMeasure(const std::vector<cv::Mat>& voMasks, const std::vector<cv::Mat>& voRefMasks, size_t nSkipFrames) {
+            lvAssert_(voMasks.size()==voRefMasks.size(),"mask sequence size mismatch");
+            size_t nTP=0, nFP=0, nFN=0;
+            for(size_t nFrameIdx=nSkipFrames; nFrameIdx<voMasks.size(); ++nFrameIdx) {
+                nTP += (size_t)cv::countNonZero(voMasks[nFrameIdx]&voRefMasks[nFrameIdx]);
+                nFP += (size_t)cv::countNonZero(voMasks[nFrameIdx]&~voRefMasks[nFrameIdx]);
+                nFN += (size_t)cv::countNonZero(~voMasks[nFrameIdx]&voRefMasks[nFrameIdx]);
+            }
+            return nTP?(2.0*nTP)/(2.0*nTP+nFP+nFN):0.0;
+        }
+
+        namespace detail {
+
+            template<typename TAlgo>
+            inline auto initializeAlgo(TAlgo& oAlgo, const cv::Mat& oInitImg, int) -> decltype(oAlgo.initialize(oInitImg,cv::Mat()),void()) {
+                oAlgo.initialize(oInitImg,cv::Mat());
+            }
+
+            template<typename TAlgo>
+            inline void initializeAlgo(TAlgo& oAlgo, const cv::Mat& oInitImg, long) {
+                oAlgo.initialize(oInitImg); // for impls which do not take a ROI (e.g. ViBe, PBAS)
+            }
+
+            template<typename TAlgo>
+            inline auto applyBatch(TAlgo& oAlgo, const std::vector<cv::Mat>& voFrames, std::vector<cv::Mat>& voMasks, int) -> decltype(oAlgo.applyBatch(voFrames,voMasks),void()) {
+                oAlgo.applyBatch(voFrames,voMasks);
+            }
+
+            template<typename TAlgo>
+            inline void applyBatch(TAlgo&, const std::vector<cv::Mat>&, std::vector<cv::Mat>&, long) {
+                lvError("background subtractor does not support batched processing"); // e.g. ViBe, PBAS
+            }
+
+        } // namespace detail
+
+        /// per-frame hook for 'runSyntheticSequence', called once the mask of the given frame is available (e.g. to read per-frame algorithm stats)
+        using SyntheticFrameCallback = std::function<void(size_t /*nFrameIdx*/)>;
+
+        /// runs an already configured background subtractor over a synthetic sequence frame by frame (or in batches of 'nBatchSize' frames, if non-null), and returns the output masks
+        template<typename TAlgo>
+        inline std::vector<cv::Mat> runSyntheticSequence(TAlgo& oAlgo, int nChannels, size_t nFrames, const cv::Size& oSize=cv::Size(160,120), size_t nBatchSize=0,
+                                                         const SyntheticFrameCallback& lFrameCallback=SyntheticFrameCallback()) {
+            detail::initializeAlgo(oAlgo,genSyntheticFrame(oSize,nChannels,0),0);
+            std::vector<cv::Mat> voMasks(nFrames);
+            const size_t nFrameStep = std::max(nBatchSize,size_t(1));
+            for(size_t nFrameIdx=0; nFrameIdx<nFrames; nFrameIdx+=nFrameStep) {
+                const size_t nBatchEndIdx = std::min(nFrameIdx+nFrameStep,nFrames);
+                if(nBatchSize==0)
+                    oAlgo.apply(genSyntheticFrame(oSize,nChannels,nFrameIdx),voMasks[nFrameIdx]);
+                else {
+                    std::vector<cv::Mat> voFrames,voBatchMasks;
+                    for(size_t nBatchFrameIdx=nFrameIdx; nBatchFrameIdx<nBatchEndIdx; ++nBatchFrameIdx)
+                        voFrames.push_back(genSyntheticFrame(oSize,nChannels,nBatchFrameIdx));
+                    detail::applyBatch(oAlgo,voFrames,voBatchMasks,0);
+                    std::copy(voBatchMasks.begin(),voBatchMasks.end(),voMasks.begin()+nFrameIdx);
+                }
+                if(lFrameCallback)
+                    for(size_t nBatchFrameIdx=nFrameIdx; nBatchFrameIdx<nBatchEndIdx; ++nBatchFrameIdx)
+                        lFrameCallback(nBatchFrameIdx);
+            }
+            return voMasks;
+        }
+
+        /// creates either the reference or the vectorized impl of a pixel-major subtractor (ViBe, PBAS) for the given channel count; vectorized impls are seeded with 'nSeed'
+        template<typename TBase, typename T1ch, typename T3ch, typename T1chVec, typename T3chVec>
+        inline std::unique_ptr<TBase> createVectorizableAlgo(int nChannels, bool bUseVectorized, uint32_t nSeed=0) {
+            if(!bUseVectorized)
+                return nChannels==1?std::unique_ptr<TBase>(std::make_unique<T1ch>()):std::unique_ptr<TBase>(std::make_unique<T3ch>());
+            if(nChannels==1) {
+                auto pAlgo = std::make_unique<T1chVec>();
+                pAlgo->setRandomSeed(nSeed);
+                return std::unique_ptr<TBase>(std::move(pAlgo));
+            }
+            auto pAlgo = std::make_unique<T3chVec>();
+            pAlgo->setRandomSeed(nSeed);
+            return std::unique_ptr<TBase>(std::move(pAlgo));
+        }
+
+        /// checks that the SIMD kernels of a vectorized subtractor (ViBe, PBAS) give the exact same masks & background images as its scalar fallback, pixel per pixel
+        template<typename TAlgoVec>
+        inline void checkVectorizedVsScalar(int nChannels, size_t nFrames) {
+            struct AlgoScalar : TAlgoVec {
+                AlgoScalar() {this->m_bUseSIMD = false;}
+            };
+            const cv::Size oSize(160,120);
+            for(uint32_t nSeed : {0u,42u,1234u}) {
+                // both instances draw from their own generator with the same seed, so any divergence comes from the kernels
+                TAlgoVec oAlgoSIMD;
+                AlgoScalar oAlgoScalar;
+                oAlgoSIMD.setRandomSeed(nSeed);
+                oAlgoScalar.setRandomSeed(nSeed);
+                const cv::Mat oInitImg = genSyntheticFrame(oSize,nChannels,0);
+                oAlgoSIMD.initialize(oInitImg);
+                oAlgoScalar.initialize(oInitImg);
+                cv::Mat oMaskSIMD, oMaskScalar, oBGImgSIMD, oBGImgScalar;
+                for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx) {
+                    const cv::Mat oFrame = genSyntheticFrame(oSize,nChannels,nFrameIdx);
+                    oAlgoSIMD.apply(oFrame,oMaskSIMD);
+                    oAlgoScalar.apply(oFrame,oMaskScalar);
+                    ASSERT_EQ(cv::countNonZero(oMaskSIMD!=oMaskScalar),0) << "nChannels=" << nChannels << ", nSeed=" << nSeed << ", nFrameIdx=" << nFrameIdx;
+                    oAlgoSIMD.getBackgroundImage(oBGImgSIMD);
+                    oAlgoScalar.getBackgroundImage(oBGImgScalar);
+                    ASSERT_EQ(cv::countNonZero(oBGImgSIMD.reshape(1)!=oBGImgScalar.reshape(1)),0) << "nChannels=" << nChannels << ", nSeed=" << nSeed << ", nFrameIdx=" << nFrameIdx;
+                }
+            }
+        }
+
+        /// checks that frame time budgets skip model updates as expected for a background subtractor type (loose budgets must not change anything)
+        template<typename TAlgo>
+        inline void checkFrameTimeBudget() {
+            for(int nChannels : {1,3}) {
+                std::vector<bool> vbSkippedRef, vbSkippedLoose, vbSkippedTight;
+                const auto lRunSequence = [&](TAlgo& oAlgo, double dBudgetMS, std::vector<bool>& vbSkipped) {
+                    srand(0);
+                    oAlgo.setFrameTimeBudget(dBudgetMS);
+                    vbSkipped.resize(120);
+                    return runSyntheticSequence(oAlgo,nChannels,120,cv::Size(160,120),0,[&](size_t nFrameIdx) {
+                        vbSkipped[nFrameIdx] = oAlgo.isLastFrameSkipped();
+                    });
+                };
+                TAlgo oAlgoRef;
+                const std::vector<cv::Mat> voMasksRef = lRunSequence(oAlgoRef,0.0,vbSkippedRef);
+                // a budget which is never exceeded must not change anything
+                TAlgo oAlgoLoose;
+                const std::vector<cv::Mat> voMasksLoose = lRunSequence(oAlgoLoose,1e6,vbSkippedLoose);
+                ASSERT_EQ(oAlgoLoose.getSkippedFrameCount(),size_t(0));
+                for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+                    ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksLoose[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+                // a budget which is always exceeded skips as many frames as allowed, once the first two masks are available
+                TAlgo oAlgoTight;
+                const std::vector<cv::Mat> voMasksTight = lRunSequence(oAlgoTight,1e-6,vbSkippedTight);
+                size_t nExpectedSkippedFrames = 0;
+                for(size_t nFrameIdx=0; nFrameIdx<vbSkippedTight.size(); ++nFrameIdx) {
+                    const bool bExpectedSkip = nFrameIdx>=2 && (nFrameIdx-2)%(BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES+1)!=BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES;
+                    ASSERT_EQ((bool)vbSkippedTight[nFrameIdx],bExpectedSkip) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+                    ASSERT_EQ(voMasksTight[nFrameIdx].size(),voMasksRef[nFrameIdx].size());
+                    nExpectedSkippedFrames += bExpectedSkip?1:0;
+                }
+                ASSERT_EQ(oAlgoTight.getSkippedFrameCount(),nExpectedSkippedFrames);
+                const double dFMeasureRef = getSyntheticFMeasure(voMasksRef,40);
+                EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+                EXPECT_NEAR(getSyntheticFMeasure(voMasksTight,40),dFMeasureRef,0.1) << "nChannels=" << nChannels;
+            }
+        }
+
+        /// checks that sample reordering strictly reduces the mean number of tested samples on a stationary sequence (only checked in instrumented builds)
+        template<typename TAlgo>
+        inline void checkSampleReorderingOnStationarySequence() {
+            if(!TAlgo::isInstrumentationEnabled())
+                return;
+            const cv::Size oSize(160,120);
+            for(int nChannels : {1,3}) {
+                std::array<double,2> adMeanTestedSamples;
+                for(bool bUseSampleReordering : {false,true}) {
+                    srand(0);
+                    TAlgo oAlgo;
+                    oAlgo.setSampleReordering(bUseSampleReordering);
+                    oAlgo.initialize(genSyntheticFrame(oSize,nChannels,0,false),cv::Mat());
+                    cv::Mat oFGMask;
+                    for(size_t nFrameIdx=1; nFrameIdx<=100; ++nFrameIdx)
+                        oAlgo.apply(genSyntheticFrame(oSize,nChannels,nFrameIdx,false),oFGMask);
+                    adMeanTestedSamples[bUseSampleReordering] = oAlgo.getStats().getMeanTestedSamples();
+                    ::testing::Test::RecordProperty(std::string("MeanTestedSamples_")+std::to_string(nChannels)+(bUseSampleReordering?"ch_reordered":"ch_ref"),std::to_string(adMeanTestedSamples[bUseSampleReordering]));
+                }
+                ASSERT_GT(adMeanTestedSamples[0],0.0) << "nChannels=" << nChannels;
+                // neighbor-initialized samples which never match on a static background must sink below those which do
+                EXPECT_LT(adMeanTestedSamples[1],adMeanTestedSamples[0]) << "nChannels=" << nChannels << ", ref=" << adMeanTestedSamples[0] << ", reordered=" << adMeanTestedSamples[1];
+            }
+        }
+
+        /// checks that the given blob list matches the 8-connected components of a mask (in raster order of their first pixel), including runs if any
+        inline ::testing::AssertionResult isBlobListValid(const cv::Mat& oMask, const std::vector<ForegroundBlob>& voBlobs, size_t nMinArea=1) {
+            cv::Mat_<int> oLabels, oStats;
+            cv::Mat_<double> oCentroids;
+            const int nLabels = cv::connectedComponentsWithStats(oMask>0,oLabels,oStats,oCentroids,8,CV_32S);
+            std::vector<int> vnOrderedLabels;
+            std::vector<bool> vbLabelSeen((size_t)nLabels,false);
+            for(int nRowIdx=0; nRowIdx<oLabels.rows; ++nRowIdx) {
+                for(int nColIdx=0; nColIdx<oLabels.cols; ++nColIdx) {
+                    const int nLabel = oLabels(nRowIdx,nColIdx);
+                    if(nLabel>0 && !vbLabelSeen[nLabel] && size_t(oStats(nLabel,cv::CC_STAT_AREA))>=nMinArea)
+                        vnOrderedLabels.push_back(nLabel);
+                    vbLabelSeen[nLabel] = true;
+                }
+            }
+            if(vnOrderedLabels.size()!=voBlobs.size())
+                return ::testing::AssertionFailure() << "expected " << vnOrderedLabels.size() << " blobs, got " << voBlobs.size();
+            for(size_t nBlobIdx=0; nBlobIdx<voBlobs.size(); ++nBlobIdx) {
+                const int nLabel = vnOrderedLabels[nBlobIdx];
+                const ForegroundBlob& oBlob = voBlobs[nBlobIdx];
+                const cv::Rect oBBox(oStats(nLabel,cv::CC_STAT_LEFT),oStats(nLabel,cv::CC_STAT_TOP),oStats(nLabel,cv::CC_STAT_WIDTH),oStats(nLabel,cv::CC_STAT_HEIGHT));
+                if(oBlob.oBBox!=oBBox || oBlob.nArea!=size_t(oStats(nLabel,cv::CC_STAT_AREA)))
+                    return ::testing::AssertionFailure() << "bad bbox/area for blob #" << nBlobIdx;
+                if(std::abs(oBlob.oCentroid.x-oCentroids(nLabel,0))>1e-3 || std::abs(oBlob.oCentroid.y-oCentroids(nLabel,1))>1e-3)
+                    return ::testing::AssertionFailure() << "bad centroid for blob #" << nBlobIdx;
+                if(!oBlob.vRuns.empty()) {
+                    cv::Mat oBlobMask(oMask.size(),CV_8UC1,cv::Scalar_<uchar>(0));
+                    for(const cv::Vec3i& vRun : oBlob.vRuns)
+                        oBlobMask.row(vRun[0]).colRange(vRun[1],vRun[2]) = cv::Scalar_<uchar>(255);
+                    if(cv::countNonZero(oBlobMask!=(oLabels==nLabel))!=0)
+                        return ::testing::AssertionFailure() << "bad runs for blob #" << nBlobIdx;
+                }
+            }
+            return ::testing::AssertionSuccess();
+        }
+
+    } // namespace test
+
+} // namespace lv
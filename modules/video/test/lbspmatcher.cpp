@@ -0,0 +1,312 @@
+#include "litiv/video/BackgroundSubtractorLBSP.hpp"
+#include "litiv/test.hpp"
+
+namespace {
+
+    /// fills a sample store and a current pixel with random (but mostly similar) values; in 'static' mode, samples all stay close to the current pixel (i.e. a well-modeled background pixel)
+    template<size_t nChannels>
+    void fillRandomPixel(LBSPSampleStore& oSamples, size_t nPxIdx, std::array<uchar,nChannels>& anCurrColor,
+                         std::array<ushort,nChannels>& anCurrIntraDesc, std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels>& aanLookupVals,
+                         bool bStatic=false) {
+        for(size_t c=0; c<nChannels; ++c) {
+            anCurrColor[c] = (uchar)(rand()%256);
+            anCurrIntraDesc[c] = bStatic?ushort(0):(ushort)(rand()%65536);
+            for(size_t n=0; n<LBSP::DESC_SIZE_BITS; ++n)
+                aanLookupVals[c][n] = cv::saturate_cast<uchar>(anCurrColor[c]+(bStatic?rand()%5-2:rand()%41-20));
+        }
+        for(size_t s=0; s<oSamples.samples(); ++s) {
+            for(size_t c=0; c<nChannels; ++c) {
+                oSamples.color(s,nPxIdx)[c] = cv::saturate_cast<uchar>(anCurrColor[c]+(bStatic?rand()%9-4:rand()%61-30));
+                oSamples.desc(s,nPxIdx)[c] = bStatic?anCurrIntraDesc[c]:(ushort)(anCurrIntraDesc[c]^(1<<(rand()%16))^(rand()%2?(1<<(rand()%16)):0));
+            }
+        }
+    }
+
+    /// reference (per-sample) matcher mirroring the original SuBSENSE/LOBSTER matching loops
+    template<size_t nChannels>
+    uint32_t matchReference(const LBSPSampleStore& oSamples, size_t nPxIdx, size_t nFirstSample, size_t nBatchSize,
+                            const uchar* anCurrColor, const ushort* anCurrIntraDesc, const uchar* anLookupVals,
+                            const uchar* anLBSPThresholdLUT, const LBSPSampleMatcher::Thresholds& oThresholds,
+                            ushort* anTotDescDist, ushort* anTotSumDist) {
+        uint32_t nGoodMask = 0;
+        for(size_t s=0; s<nBatchSize; ++s) {
+            const uchar* const anBGColor = oSamples.color(nFirstSample+s,nPxIdx);
+            const ushort* const anBGDesc = oSamples.desc(nFirstSample+s,nPxIdx);
+            bool bGood = true;
+            size_t nTotDescDist = 0, nTotSumDist = 0;
+            for(size_t c=0; c<nChannels; ++c) {
+                const size_t nColorDist = lv::L1dist(anCurrColor[c],anBGColor[c]);
+                const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(anLookupVals+c*LBSP::DESC_SIZE_BITS,anBGColor[c],anLBSPThresholdLUT[anBGColor[c]]);
+                const size_t nInterDescDist = lv::hdist(nCurrInterDesc,anBGDesc[c]);
+                const size_t nDescDist = oThresholds.bUseIntraDesc?(lv::hdist(anCurrIntraDesc[c],anBGDesc[c])+nInterDescDist)/2:nInterDescDist;
+                const size_t nSumDist = oThresholds.nSumDistDescShift?std::min((nDescDist>>oThresholds.nSumDistDescShift)*(UCHAR_MAX/LBSP::DESC_SIZE_BITS)+nColorDist,(size_t)UCHAR_MAX):nColorDist;
+                if(nColorDist>oThresholds.nColorDist || nDescDist>oThresholds.nDescDist || nSumDist>oThresholds.nSumDist)
+                    bGood = false;
+                nTotDescDist += nDescDist;
+                nTotSumDist += nSumDist;
+            }
+            if(nTotDescDist>oThresholds.nTotDescDist || nTotSumDist>oThresholds.nTotSumDist)
+                bGood = false;
+            anTotDescDist[s] = (ushort)nTotDescDist;
+            anTotSumDist[s] = (ushort)nTotSumDist;
+            nGoodMask |= uint32_t(bGood)<<s;
+        }
+        return nGoodMask;
+    }
+
+    /// original early-exit SuBSENSE/LOBSTER pixel matching loop (one sample at a time, until enough samples matched), kept as baseline for the batch matcher
+    template<size_t nChannels>
+    size_t matchPixelLegacy(const LBSPSampleStore& oSamples, size_t nPxIdx, size_t nRequiredSamples, const uchar* anCurrColor,
+                            const ushort* anCurrIntraDesc, const uchar* anLookupVals, const uchar* anLBSPThresholdLUT,
+                            const LBSPSampleMatcher::Thresholds& oThresholds, size_t& nMinTotDescDist, size_t& nMinTotSumDist,
+                            size_t* pnTestedSamples=nullptr) {
+        size_t nGoodSamplesCount=0, nSampleIdx=0;
+        while(nGoodSamplesCount<nRequiredSamples && nSampleIdx<oSamples.samples()) {
+            const uchar* const anBGColor = oSamples.color(nSampleIdx,nPxIdx);
+            const ushort* const anBGDesc = oSamples.desc(nSampleIdx,nPxIdx);
+            size_t nTotDescDist = 0, nTotSumDist = 0;
+            for(size_t c=0; c<nChannels; ++c) {
+                const size_t nColorDist = lv::L1dist(anCurrColor[c],anBGColor[c]);
+                if(nColorDist>oThresholds.nColorDist)
+                    goto failedcheck;
+                const ushort nCurrInterDesc = LBSP::computeDescriptor_threshold(anLookupVals+c*LBSP::DESC_SIZE_BITS,anBGColor[c],anLBSPThresholdLUT[anBGColor[c]]);
+                const size_t nInterDescDist = lv::hdist(nCurrInterDesc,anBGDesc[c]);
+                const size_t nDescDist = oThresholds.bUseIntraDesc?(lv::hdist(anCurrIntraDesc[c],anBGDesc[c])+nInterDescDist)/2:nInterDescDist;
+                if(nDescDist>oThresholds.nDescDist)
+                    goto failedcheck;
+                const size_t nSumDist = oThresholds.nSumDistDescShift?std::min((nDescDist>>oThresholds.nSumDistDescShift)*(UCHAR_MAX/LBSP::DESC_SIZE_BITS)+nColorDist,(size_t)UCHAR_MAX):nColorDist;
+                if(nSumDist>oThresholds.nSumDist)
+                    goto failedcheck;
+                nTotDescDist += nDescDist;
+                nTotSumDist += nSumDist;
+            }
+            if(nTotDescDist>oThresholds.nTotDescDist || nTotSumDist>oThresholds.nTotSumDist)
+                goto failedcheck;
+            if(nMinTotDescDist>nTotDescDist)
+                nMinTotDescDist = nTotDescDist;
+            if(nMinTotSumDist>nTotSumDist)
+                nMinTotSumDist = nTotSumDist;
+            nGoodSamplesCount++;
+            failedcheck:
+            nSampleIdx++;
+        }
+        if(pnTestedSamples)
+            *pnTestedSamples = nSampleIdx;
+        return nGoodSamplesCount;
+    }
+
+    /// batched pixel matching loop, as used by SuBSENSE/LOBSTER (matched samples are consumed in order, up to the required count)
+    template<size_t nChannels>
+    size_t matchPixelBatched(const LBSPSampleStore& oSamples, size_t nPxIdx, size_t nRequiredSamples, const uchar* anCurrColor,
+                             const ushort* anCurrIntraDesc, const uchar* anLookupVals, const uchar* anLBSPThresholdLUT,
+                             const LBSPSampleMatcher::Thresholds& oThresholds, size_t& nMinTotDescDist, size_t& nMinTotSumDist,
+                             size_t* pnTestedSamples=nullptr) {
+        size_t nGoodSamplesCount=0, nTestedSamples=0;
+        for(size_t nSampleIdx=0; nGoodSamplesCount<nRequiredSamples && nSampleIdx<oSamples.samples(); nSampleIdx+=LBSPSampleMatcher::getBatchSize(nSampleIdx,oSamples.samples())) {
+            const size_t nBatchSize = LBSPSampleMatcher::getBatchSize(nSampleIdx,oSamples.samples());
+            std::array<ushort,LBSPSampleMatcher::s_nBatchSize> anTotDescDist,anTotSumDist;
+            uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<nChannels>(oSamples,nPxIdx,nSampleIdx,nBatchSize,anCurrColor,anCurrIntraDesc,anLookupVals,anLBSPThresholdLUT,oThresholds,anTotDescDist.data(),anTotSumDist.data());
+            nTestedSamples += LBSPSampleMatcher::getTestedCount(nGoodMask,nBatchSize,nRequiredSamples-nGoodSamplesCount);
+            for(size_t nBatchIdx=0; nGoodMask && nGoodSamplesCount<nRequiredSamples; ++nBatchIdx, nGoodMask>>=1) {
+                if(nGoodMask&1) {
+                    if(nMinTotDescDist>(size_t)anTotDescDist[nBatchIdx])
+                        nMinTotDescDist = anTotDescDist[nBatchIdx];
+                    if(nMinTotSumDist>(size_t)anTotSumDist[nBatchIdx])
+                        nMinTotSumDist = anTotSumDist[nBatchIdx];
+                    nGoodSamplesCount++;
+                }
+            }
+        }
+        if(pnTestedSamples)
+            *pnTestedSamples = nTestedSamples;
+        return nGoodSamplesCount;
+    }
+
+    /// returns the four threshold configurations used by SuBSENSE/LOBSTER for a given channel count
+    std::vector<LBSPSampleMatcher::Thresholds> getThresholdConfigs(size_t nChannels) {
+        if(nChannels==1)
+            return {
+                {20,6,20,SIZE_MAX,SIZE_MAX,true,2}, // SuBSENSE
+                {15,4,SIZE_MAX,SIZE_MAX,SIZE_MAX,false,0}, // LOBSTER
+                {SIZE_MAX,SIZE_MAX,SIZE_MAX,SIZE_MAX,SIZE_MAX,true,2}, // all-pass
+                {0,0,0,0,0,true,2}, // all-fail (except exact matches)
+            };
+        return {
+            {45,SIZE_MAX,45,18,90,true,1}, // SuBSENSE
+            {45,6,SIZE_MAX,12,90,false,0}, // LOBSTER
+            {SIZE_MAX,SIZE_MAX,SIZE_MAX,SIZE_MAX,SIZE_MAX,true,1}, // all-pass
+            {0,0,0,0,0,true,1}, // all-fail (except exact matches)
+        };
+    }
+
+    template<size_t nChannels>
+    void testMatcherEquivalence() {
+        const size_t nSamples = 50;
+        std::array<uchar,UCHAR_MAX+1> anLBSPThresholdLUT;
+        for(size_t t=0; t<=UCHAR_MAX; ++t)
+            anLBSPThresholdLUT[t] = cv::saturate_cast<uchar>((t*0.333f)/(nChannels==1?3:1));
+        for(LBSPSampleStore::Layout eLayout : {LBSPSampleStore::SampleMajor,LBSPSampleStore::PixelMajor}) {
+            LBSPSampleStore oSamples;
+            oSamples.create(eLayout,nSamples,cv::Size(8,4),nChannels);
+            for(const LBSPSampleMatcher::Thresholds& oThresholds : getThresholdConfigs(nChannels)) {
+                for(size_t nIter=0; nIter<200; ++nIter) {
+                    const size_t nPxIdx = size_t(rand()%32);
+                    alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels> aanLookupVals;
+                    std::array<uchar,nChannels> anCurrColor;
+                    std::array<ushort,nChannels> anCurrIntraDesc;
+                    fillRandomPixel<nChannels>(oSamples,nPxIdx,anCurrColor,anCurrIntraDesc,aanLookupVals);
+                    for(size_t nFirstSample=0; nFirstSample<nSamples; nFirstSample+=LBSPSampleMatcher::s_nBatchSize) {
+                        const size_t nBatchSize = std::min(LBSPSampleMatcher::s_nBatchSize,nSamples-nFirstSample);
+                        std::array<ushort,LBSPSampleMatcher::s_nBatchSize> anTotDescDist,anTotSumDist,anRefTotDescDist,anRefTotSumDist;
+                        const uint32_t nGoodMask = LBSPSampleMatcher::matchBatch<nChannels>(oSamples,nPxIdx,nFirstSample,nBatchSize,anCurrColor.data(),anCurrIntraDesc.data(),aanLookupVals[0].data(),anLBSPThresholdLUT.data(),oThresholds,anTotDescDist.data(),anTotSumDist.data());
+                        const uint32_t nRefGoodMask = matchReference<nChannels>(oSamples,nPxIdx,nFirstSample,nBatchSize,anCurrColor.data(),anCurrIntraDesc.data(),aanLookupVals[0].data(),anLBSPThresholdLUT.data(),oThresholds,anRefTotDescDist.data(),anRefTotSumDist.data());
+                        ASSERT_EQ(nGoodMask,nRefGoodMask) << "nChannels=" << nChannels << ", nBatchSize=" << nBatchSize;
+                        for(size_t s=0; s<nBatchSize; ++s) {
+                            ASSERT_EQ(anTotDescDist[s],anRefTotDescDist[s]) << "nChannels=" << nChannels << ", s=" << s;
+                            ASSERT_EQ(anTotSumDist[s],anRefTotSumDist[s]) << "nChannels=" << nChannels << ", s=" << s;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    template<size_t nChannels>
+    void testPixelLoopEquivalence() {
+        const size_t nSamples = 50;
+        std::array<uchar,UCHAR_MAX+1> anLBSPThresholdLUT;
+        for(size_t t=0; t<=UCHAR_MAX; ++t)
+            anLBSPThresholdLUT[t] = cv::saturate_cast<uchar>((t*0.333f)/(nChannels==1?3:1));
+        for(LBSPSampleStore::Layout eLayout : {LBSPSampleStore::SampleMajor,LBSPSampleStore::PixelMajor}) {
+            LBSPSampleStore oSamples;
+            oSamples.create(eLayout,nSamples,cv::Size(8,4),nChannels);
+            for(const LBSPSampleMatcher::Thresholds& oThresholds : getThresholdConfigs(nChannels)) {
+                for(size_t nRequiredSamples : {size_t(1),size_t(2),nSamples}) {
+                    for(size_t nIter=0; nIter<200; ++nIter) {
+                        const size_t nPxIdx = size_t(rand()%32);
+                        alignas(16) std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels> aanLookupVals;
+                        std::array<uchar,nChannels> anCurrColor;
+                        std::array<ushort,nChannels> anCurrIntraDesc;
+                        fillRandomPixel<nChannels>(oSamples,nPxIdx,anCurrColor,anCurrIntraDesc,aanLookupVals,(nIter%2)!=0);
+                        size_t nMinTotDescDist=SIZE_MAX, nMinTotSumDist=SIZE_MAX, nRefMinTotDescDist=SIZE_MAX, nRefMinTotSumDist=SIZE_MAX;
+                        size_t nTestedSamples=0, nRefTestedSamples=0;
+                        const size_t nGoodSamplesCount = matchPixelBatched<nChannels>(oSamples,nPxIdx,nRequiredSamples,anCurrColor.data(),anCurrIntraDesc.data(),aanLookupVals[0].data(),anLBSPThresholdLUT.data(),oThresholds,nMinTotDescDist,nMinTotSumDist,&nTestedSamples);
+                        const size_t nRefGoodSamplesCount = matchPixelLegacy<nChannels>(oSamples,nPxIdx,nRequiredSamples,anCurrColor.data(),anCurrIntraDesc.data(),aanLookupVals[0].data(),anLBSPThresholdLUT.data(),oThresholds,nRefMinTotDescDist,nRefMinTotSumDist,&nRefTestedSamples);
+                        ASSERT_EQ(nGoodSamplesCount,nRefGoodSamplesCount) << "nChannels=" << nChannels << ", nRequiredSamples=" << nRequiredSamples;
+                        // the instrumentation counters must report the samples the sequential loop would have tested, not whole batches
+                        ASSERT_EQ(nTestedSamples,nRefTestedSamples) << "nChannels=" << nChannels << ", nRequiredSamples=" << nRequiredSamples;
+                        ASSERT_EQ(nMinTotDescDist,nRefMinTotDescDist) << "nChannels=" << nChannels << ", nRequiredSamples=" << nRequiredSamples;
+                        ASSERT_EQ(nMinTotSumDist,nRefMinTotSumDist) << "nChannels=" << nChannels << ", nRequiredSamples=" << nRequiredSamples;
+                    }
+                }
+            }
+        }
+    }
+
+}
+
+TEST(lbspmatcher,regression_1ch) {
+    srand(0);
+    testMatcherEquivalence<1>();
+}
+
+TEST(lbspmatcher,regression_3ch) {
+    srand(0);
+    testMatcherEquivalence<3>();
+}
+
+TEST(lbspmatcher,regression_legacy_pixel_loop) {
+    srand(0);
+    testPixelLoopEquivalence<1>();
+    testPixelLoopEquivalence<3>();
+}
+
+namespace {
+
+    template<size_t nChannels>
+    void lbspmatcher_perftest_impl(benchmark::State& st, size_t nSamples, bool bUseBatchMatcher) {
+        const size_t nPxCount = 1024;
+        std::array<uchar,UCHAR_MAX+1> anLBSPThresholdLUT;
+        for(size_t t=0; t<=UCHAR_MAX; ++t)
+            anLBSPThresholdLUT[t] = cv::saturate_cast<uchar>((t*0.333f)/(nChannels==1?3:1));
+        LBSPSampleStore oSamples;
+        oSamples.create(LBSPSampleStore::PixelMajor,nSamples,cv::Size((int)nPxCount,1),nChannels);
+        lv::aligned_vector<std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels>,16> vaanLookupVals(nPxCount);
+        std::vector<std::array<uchar,nChannels>> vanCurrColor(nPxCount);
+        std::vector<std::array<ushort,nChannels>> vanCurrIntraDesc(nPxCount);
+        srand(0);
+        for(size_t nPxIdx=0; nPxIdx<nPxCount; ++nPxIdx)
+            fillRandomPixel<nChannels>(oSamples,nPxIdx,vanCurrColor[nPxIdx],vanCurrIntraDesc[nPxIdx],vaanLookupVals[nPxIdx]);
+        const LBSPSampleMatcher::Thresholds oThresholds = getThresholdConfigs(nChannels)[0];
+        std::array<ushort,LBSPSampleMatcher::s_nBatchSize> anTotDescDist,anTotSumDist;
+        size_t nPxIdx = 0;
+        while(st.KeepRunning()) {
+            size_t nGoodSamplesCount = 0;
+            for(size_t nFirstSample=0; nFirstSample<nSamples; nFirstSample+=LBSPSampleMatcher::s_nBatchSize) {
+                const size_t nBatchSize = std::min(LBSPSampleMatcher::s_nBatchSize,nSamples-nFirstSample);
+                if(bUseBatchMatcher)
+                    nGoodSamplesCount += lv::popcount(LBSPSampleMatcher::matchBatch<nChannels>(oSamples,nPxIdx,nFirstSample,nBatchSize,vanCurrColor[nPxIdx].data(),vanCurrIntraDesc[nPxIdx].data(),vaanLookupVals[nPxIdx][0].data(),anLBSPThresholdLUT.data(),oThresholds,anTotDescDist.data(),anTotSumDist.data()));
+                else
+                    nGoodSamplesCount += lv::popcount(matchReference<nChannels>(oSamples,nPxIdx,nFirstSample,nBatchSize,vanCurrColor[nPxIdx].data(),vanCurrIntraDesc[nPxIdx].data(),vaanLookupVals[nPxIdx][0].data(),anLBSPThresholdLUT.data(),oThresholds,anTotDescDist.data(),anTotSumDist.data()));
+            }
+            benchmark::DoNotOptimize(nGoodSamplesCount);
+            nPxIdx = (nPxIdx+1)%nPxCount;
+        }
+    }
+
+    void lbspmatcher_perftest(benchmark::State& st) {
+        const size_t nSamples = (size_t)st.range(1);
+        const bool bUseBatchMatcher = st.range(2)!=0;
+        if(st.range(0)==1)
+            lbspmatcher_perftest_impl<1>(st,nSamples,bUseBatchMatcher);
+        else
+            lbspmatcher_perftest_impl<3>(st,nSamples,bUseBatchMatcher);
+    }
+
+    template<size_t nChannels>
+    void lbspmatcher_pixel_perftest_impl(benchmark::State& st, const LBSPSampleMatcher::Thresholds& oThresholds, size_t nRequiredSamples, bool bUseBatchMatcher, bool bStatic) {
+        const size_t nPxCount = 1024, nSamples = 50;
+        std::array<uchar,UCHAR_MAX+1> anLBSPThresholdLUT;
+        for(size_t t=0; t<=UCHAR_MAX; ++t)
+            anLBSPThresholdLUT[t] = cv::saturate_cast<uchar>((t*0.333f)/(nChannels==1?3:1));
+        LBSPSampleStore oSamples;
+        oSamples.create(LBSPSampleStore::PixelMajor,nSamples,cv::Size((int)nPxCount,1),nChannels);
+        lv::aligned_vector<std::array<std::array<uchar,LBSP::DESC_SIZE_BITS>,nChannels>,16> vaanLookupVals(nPxCount);
+        std::vector<std::array<uchar,nChannels>> vanCurrColor(nPxCount);
+        std::vector<std::array<ushort,nChannels>> vanCurrIntraDesc(nPxCount);
+        srand(0);
+        for(size_t nPxIdx=0; nPxIdx<nPxCount; ++nPxIdx)
+            fillRandomPixel<nChannels>(oSamples,nPxIdx,vanCurrColor[nPxIdx],vanCurrIntraDesc[nPxIdx],vaanLookupVals[nPxIdx],bStatic);
+        size_t nPxIdx = 0;
+        while(st.KeepRunning()) {
+            size_t nMinTotDescDist=SIZE_MAX, nMinTotSumDist=SIZE_MAX;
+            const size_t nGoodSamplesCount = bUseBatchMatcher?
+                matchPixelBatched<nChannels>(oSamples,nPxIdx,nRequiredSamples,vanCurrColor[nPxIdx].data(),vanCurrIntraDesc[nPxIdx].data(),vaanLookupVals[nPxIdx][0].data(),anLBSPThresholdLUT.data(),oThresholds,nMinTotDescDist,nMinTotSumDist):
+                matchPixelLegacy<nChannels>(oSamples,nPxIdx,nRequiredSamples,vanCurrColor[nPxIdx].data(),vanCurrIntraDesc[nPxIdx].data(),vaanLookupVals[nPxIdx][0].data(),anLBSPThresholdLUT.data(),oThresholds,nMinTotDescDist,nMinTotSumDist);
+            benchmark::DoNotOptimize(nGoodSamplesCount);
+            benchmark::DoNotOptimize(nMinTotSumDist);
+            nPxIdx = (nPxIdx+1)%nPxCount;
+        }
+    }
+
+    /// compares the original goto-based pixel loop (batch matcher off) with the batched one, using the SuBSENSE (0) or LOBSTER (1) thresholds, on noisy or static pixels
+    void lbspmatcher_pixel_perftest(benchmark::State& st) {
+        const size_t nChannels = (size_t)st.range(0);
+        const LBSPSampleMatcher::Thresholds oThresholds = getThresholdConfigs(nChannels)[(size_t)st.range(1)];
+        const size_t nRequiredSamples = 2; // default required match count of both SuBSENSE & LOBSTER
+        const bool bUseBatchMatcher = st.range(2)!=0;
+        const bool bStatic = st.range(3)!=0;
+        if(nChannels==1)
+            lbspmatcher_pixel_perftest_impl<1>(st,oThresholds,nRequiredSamples,bUseBatchMatcher,bStatic);
+        else
+            lbspmatcher_pixel_perftest_impl<3>(st,oThresholds,nRequiredSamples,bUseBatchMatcher,bStatic);
+    }
+
+}
+
+BENCHMARK(lbspmatcher_perftest)->Args({1,16,0})->Args({1,16,1})->Args({1,50,0})->Args({1,50,1})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(lbspmatcher_perftest)->Args({3,16,0})->Args({3,16,1})->Args({3,50,0})->Args({3,50,1})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(lbspmatcher_pixel_perftest)->Args({1,0,0,0})->Args({1,0,1,0})->Args({1,1,0,0})->Args({1,1,1,0})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(lbspmatcher_pixel_perftest)->Args({3,0,0,0})->Args({3,0,1,0})->Args({3,1,0,0})->Args({3,1,1,0})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(lbspmatcher_pixel_perftest)->Args({1,0,0,1})->Args({1,0,1,1})->Args({1,1,0,1})->Args({1,1,1,1})->Repetitions(10)->ReportAggregatesOnly(true);
+BENCHMARK(lbspmatcher_pixel_perftest)->Args({3,0,0,1})->Args({3,0,1,1})->Args({3,1,0,1})->Args({3,1,1,1})->Repetitions(10)->ReportAggregatesOnly(true);
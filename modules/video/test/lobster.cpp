@@ -0,0 +1,282 @@
+#include "litiv/video/BackgroundSubtractorLOBSTER.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+namespace {
+
+    /// runs LOBSTER over a synthetic sequence and returns the output masks
+    std::vector<cv::Mat> runSyntheticSequence(int nChannels, size_t nFrames, LBSPSampleStore::Layout eLayout) {
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgo;
+        oAlgo.setSampleLayout(eLayout);
+        return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames);
+    }
+
+    /// runs the multi-threaded LOBSTER impl over a synthetic sequence and returns the output masks
+    std::vector<cv::Mat> runSyntheticSequence_CPUThreads(int nChannels, size_t nFrames, size_t nThreadCount, size_t nTileCount, uint32_t nSeed,
+                                                         const cv::Size& oTileSize=cv::Size()) {
+        BackgroundSubtractorLOBSTER_CPUThreads oAlgo;
+        oAlgo.setThreadCount(nThreadCount);
+        oAlgo.setTileCount(nTileCount);
+        oAlgo.setTileSize(oTileSize);
+        oAlgo.setRandomSeed(nSeed);
+        return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames);
+    }
+
+}
+
+TEST(lobster,regression_sample_layouts) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksSampleMajor = runSyntheticSequence(nChannels,30,LBSPSampleStore::SampleMajor);
+        const std::vector<cv::Mat> voMasksPixelMajor = runSyntheticSequence(nChannels,30,LBSPSampleStore::PixelMajor);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksSampleMajor.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksSampleMajor[nFrameIdx]!=voMasksPixelMajor[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        EXPECT_GT(cv::countNonZero(voMasksPixelMajor.back()),0) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(lobster,regression_cpu_threads_deterministic) {
+    for(int nChannels : {1,3}) {
+        // each tile owns its PRNG stream & deferred update list, so the thread count must not affect the output
+        const std::vector<cv::Mat> voMasksSingleThread = runSyntheticSequence_CPUThreads(nChannels,30,1,8,42);
+        const std::vector<cv::Mat> voMasksMultiThread = runSyntheticSequence_CPUThreads(nChannels,30,4,8,42);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksSingleThread.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksSingleThread[nFrameIdx]!=voMasksMultiThread[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(lobster,regression_cpu_threads_vs_serial) {
+    for(int nChannels : {1,3}) {
+        // both impls draw from different generators, so only the segmentation quality can be compared
+        const double dFMeasureSerial = lv::test::getSyntheticFMeasure(runSyntheticSequence(nChannels,120,BGSLBSP_DEFAULT_SAMPLE_LAYOUT),40);
+        const double dFMeasureThreaded = lv::test::getSyntheticFMeasure(runSyntheticSequence_CPUThreads(nChannels,120,4,16,0),40);
+        EXPECT_GT(dFMeasureSerial,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureThreaded,dFMeasureSerial,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(lobster,regression_cpu_threads_2d_tiles) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksSingleThread = runSyntheticSequence_CPUThreads(nChannels,120,1,1,42,cv::Size(48,40));
+        const std::vector<cv::Mat> voMasksMultiThread = runSyntheticSequence_CPUThreads(nChannels,120,4,1,42,cv::Size(48,40));
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksSingleThread.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksSingleThread[nFrameIdx]!=voMasksMultiThread[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        const double dFMeasureRows = lv::test::getSyntheticFMeasure(runSyntheticSequence_CPUThreads(nChannels,120,4,16,42),40);
+        EXPECT_NEAR(lv::test::getSyntheticFMeasure(voMasksMultiThread,40),dFMeasureRows,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(lobster,regression_activity_gating) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        double dRatioRef=0.0,dRatioGated=0.0;
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoRef;
+        oAlgoRef.setActivityGating(false);
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize,0,[&](size_t) {
+            dRatioRef += oAlgoRef.getActiveBlockRatio()/120;
+        }),40);
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoGated;
+        oAlgoGated.setActivityGating(true);
+        const double dFMeasureGated = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoGated,nChannels,120,oSize,0,[&](size_t) {
+            dRatioGated += oAlgoGated.getActiveBlockRatio()/120;
+        }),40);
+        // only the moving square & its surroundings (plus the staggered refreshes) should be processed once the model is bootstrapped
+        ASSERT_NEAR(dRatioRef,1.0,1e-6);
+        EXPECT_LT(dRatioGated,0.5) << "nChannels=" << nChannels;
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureGated,dFMeasureRef,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(lobster,regression_blob_extraction) {
+    const cv::Size oSize(160,120);
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgo;
+        oAlgo.setBlobExtraction(true,true);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,nChannels,0),cv::Mat());
+        cv::Mat oFGMask;
+        for(size_t nFrameIdx=0; nFrameIdx<60; ++nFrameIdx) {
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+            ASSERT_TRUE(lv::test::isBlobListValid(oFGMask,oAlgo.getLatestBlobs())) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        }
+        oAlgo.setBlobExtraction(true,false,50);
+        oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,60),oFGMask);
+        ASSERT_TRUE(lv::test::isBlobListValid(oFGMask,oAlgo.getLatestBlobs(),50)) << "nChannels=" << nChannels;
+        EXPECT_FALSE(oAlgo.getLatestBlobs().empty()) << "nChannels=" << nChannels;
+        for(const ForegroundBlob& oBlob : oAlgo.getLatestBlobs())
+            ASSERT_TRUE(oBlob.vRuns.empty());
+        oAlgo.setBlobExtraction(false);
+        oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,61),oFGMask);
+        ASSERT_TRUE(oAlgo.getLatestBlobs().empty());
+    }
+}
+
+TEST(lobster,regression_batch) {
+    for(int nChannels : {1,3}) {
+        {
+            // the serial impl processes batches frame by frame, so results must match exactly
+            srand(0);
+            BackgroundSubtractorLOBSTER oAlgoRef;
+            const std::vector<cv::Mat> voMasksRef = lv::test::runSyntheticSequence(oAlgoRef,nChannels,40);
+            srand(0);
+            BackgroundSubtractorLOBSTER oAlgoBatched;
+            const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,40,cv::Size(160,120),7);
+            for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+                ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        }
+        {
+            // with a single tile, no neighbor update is ever deferred, so batching cannot change the results either
+            srand(0);
+            BackgroundSubtractorLOBSTER_CPUThreads oAlgoRef;
+            oAlgoRef.setTileCount(1);
+            const std::vector<cv::Mat> voMasksRef = lv::test::runSyntheticSequence(oAlgoRef,nChannels,40);
+            srand(0);
+            BackgroundSubtractorLOBSTER_CPUThreads oAlgoBatched;
+            oAlgoBatched.setTileCount(1);
+            const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,40,cv::Size(160,120),7);
+            for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+                ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        }
+        for(const cv::Size& oTileSize : {cv::Size(),cv::Size(48,40),cv::Size(37,29)}) {
+            // with several tiles, cross-tile neighbor updates are committed by their target tile before its next frame, so results must match exactly too
+            srand(0);
+            BackgroundSubtractorLOBSTER_CPUThreads oAlgoRef;
+            oAlgoRef.setTileCount(8);
+            oAlgoRef.setTileSize(oTileSize);
+            const std::vector<cv::Mat> voMasksRef = lv::test::runSyntheticSequence(oAlgoRef,nChannels,40);
+            for(size_t nThreadCount : {1,4}) {
+                srand(0);
+                BackgroundSubtractorLOBSTER_CPUThreads oAlgoBatched;
+                oAlgoBatched.setThreadCount(nThreadCount);
+                oAlgoBatched.setTileCount(8);
+                oAlgoBatched.setTileSize(oTileSize);
+                const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,40,cv::Size(160,120),8);
+                for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+                    ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", oTileSize=" << oTileSize << ", nThreadCount=" << nThreadCount << ", nFrameIdx=" << nFrameIdx;
+                // updates deferred during the last frame of the batch must also have landed in the model
+                cv::Mat oBGImageRef,oBGImageBatched;
+                oAlgoRef.getBackgroundImage(oBGImageRef);
+                oAlgoBatched.getBackgroundImage(oBGImageBatched);
+                ASSERT_EQ(cv::norm(oBGImageRef,oBGImageBatched,cv::NORM_INF),0.0) << "nChannels=" << nChannels << ", oTileSize=" << oTileSize << ", nThreadCount=" << nThreadCount;
+            }
+        }
+    }
+}
+
+TEST(lobster,regression_reduced_resolution) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoRef;
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize),40);
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoReduced;
+        oAlgoReduced.setReducedResolution(2);
+        const std::vector<cv::Mat> voMasksReduced = lv::test::runSyntheticSequence(oAlgoReduced,nChannels,120,oSize);
+        ASSERT_EQ(voMasksReduced.back().size(),oSize);
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(lv::test::getSyntheticFMeasure(voMasksReduced,40),dFMeasureRef,0.1) << "nChannels=" << nChannels;
+        // the serial impl processes batches frame by frame, so the refined masks must match exactly
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoBatched;
+        oAlgoBatched.setReducedResolution(2);
+        const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,120,oSize,7);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksReduced.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksReduced[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(lobster,regression_frame_time_budget) {
+    ASSERT_NO_FATAL_FAILURE(lv::test::checkFrameTimeBudget<BackgroundSubtractorLOBSTER>());
+}
+
+TEST(lobster,regression_sample_reordering) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoRef;
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize),40);
+        srand(0);
+        BackgroundSubtractorLOBSTER oAlgoReordered;
+        oAlgoReordered.setSampleReordering(true);
+        const double dFMeasureReordered = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoReordered,nChannels,120,oSize),40);
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureReordered,dFMeasureRef,0.05) << "nChannels=" << nChannels;
+        // samples which keep matching get tested first, so the early exit should never come later on average
+        if(BackgroundSubtractorLOBSTER::isInstrumentationEnabled())
+            EXPECT_LE(oAlgoReordered.getStats().getMeanTestedSamples(),oAlgoRef.getStats().getMeanTestedSamples()) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(lobster,regression_sample_reordering_stationary) {
+    ASSERT_NO_FATAL_FAILURE(lv::test::checkSampleReorderingOnStationarySequence<BackgroundSubtractorLOBSTER>());
+}
+
+namespace {
+
+    void lobster_batch_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const size_t nBatchSize = (size_t)st.range(2);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<nBatchSize; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        BackgroundSubtractorLOBSTER_CPUThreads oAlgo;
+        // thin row tiles keep the batch wavefront (~2 tiles between two frames of a tile) within the last-level cache
+        oAlgo.setTileCount(size_t(oSize.height/4));
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        std::vector<cv::Mat> voFGMasks;
+        while(st.KeepRunning()) {
+            oAlgo.applyBatch(voFrames,voFGMasks);
+            benchmark::DoNotOptimize(voFGMasks.back().data);
+        }
+        st.SetItemsProcessed(int64_t(st.iterations())*nBatchSize);
+    }
+
+    void lobster_threads_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const int nChannels = (int)st.range(2);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx));
+        BackgroundSubtractorLOBSTER_CPUThreads oAlgo;
+        oAlgo.setThreadCount((size_t)st.range(3));
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+    void lobster_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const int nChannels = (int)st.range(2);
+        const LBSPSampleStore::Layout eLayout = (LBSPSampleStore::Layout)st.range(3);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx));
+        BackgroundSubtractorLOBSTER oAlgo;
+        oAlgo.setSampleLayout(eLayout);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+}
+
+BENCHMARK(lobster_perftest)->Args({640,480,3,LBSPSampleStore::SampleMajor})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(lobster_perftest)->Args({640,480,3,LBSPSampleStore::PixelMajor})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(lobster_perftest)->Args({640,480,1,LBSPSampleStore::SampleMajor})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(lobster_perftest)->Args({640,480,1,LBSPSampleStore::PixelMajor})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(lobster_batch_perftest)->Args({1920,1080,1})->Args({1920,1080,4})->Args({1920,1080,16})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(lobster_threads_perftest)->Args({640,480,3,1})->Args({640,480,3,4})->Args({1920,1080,3,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
@@ -0,0 +1,113 @@
+#include "litiv/video/BackgroundSubtractorPAWCS.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+namespace {
+
+    /// runs PAWCS over a synthetic sequence and returns the output masks
+    std::vector<cv::Mat> runSyntheticSequence(int nChannels, size_t nFrames, bool bUseColorPrefilter) {
+        srand(0);
+        BackgroundSubtractorPAWCS oAlgo;
+        oAlgo.setColorPrefilter(bUseColorPrefilter);
+        return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames);
+    }
+
+    /// runs PAWCS over a larger synthetic sequence with its model downscaled by 'nScaleFactor', and returns the full-res output masks
+    std::vector<cv::Mat> runReducedResSyntheticSequence(int nChannels, size_t nFrames, size_t nScaleFactor) {
+        srand(0);
+        BackgroundSubtractorPAWCS oAlgo;
+        oAlgo.setReducedResolution(nScaleFactor);
+        return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames,cv::Size(320,240));
+    }
+
+}
+
+TEST(pawcs,regression_color_prefilter) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksRef = runSyntheticSequence(nChannels,30,false);
+        const std::vector<cv::Mat> voMasksPrefiltered = runSyntheticSequence(nChannels,30,true);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksPrefiltered[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        EXPECT_GT(cv::countNonZero(voMasksPrefiltered.back()),0) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(pawcs,regression_model_snapshot) {
+    const cv::Size oSize(160,120);
+    const std::string sSnapshotPath = TEST_OUTPUT_DATA_ROOT "/pawcs_snapshot_test.bin";
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorPAWCS oAlgo;
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,nChannels,0),cv::Mat());
+        cv::Mat oFGMask,oRestoredFGMask;
+        for(size_t nFrameIdx=0; nFrameIdx<20; ++nFrameIdx)
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+        oAlgo.saveModel(sSnapshotPath);
+        BackgroundSubtractorPAWCS oRestoredAlgo;
+        oRestoredAlgo.loadModel(sSnapshotPath);
+        for(size_t nFrameIdx=20; nFrameIdx<40; ++nFrameIdx) {
+            // PAWCS relies on the global PRNG, so both instances are reseeded identically before each frame
+            srand((unsigned)nFrameIdx);
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+            srand((unsigned)nFrameIdx);
+            oRestoredAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oRestoredFGMask);
+            ASSERT_EQ(cv::countNonZero(oFGMask!=oRestoredFGMask),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        }
+        cv::Mat oBGImg,oRestoredBGImg;
+        oAlgo.getBackgroundImage(oBGImg);
+        oRestoredAlgo.getBackgroundImage(oRestoredBGImg);
+        ASSERT_TRUE(lv::isEqual<uchar>(oBGImg,oRestoredBGImg)) << "nChannels=" << nChannels;
+    }
+    BackgroundSubtractorPAWCS oMismatchedAlgo(BGSPAWCS_DEFAULT_DESC_DIST_THRESHOLD_OFFSET,BGSPAWCS_DEFAULT_MIN_COLOR_DIST_THRESHOLD,BGSPAWCS_DEFAULT_MAX_NB_WORDS/2);
+    ASSERT_THROW(oMismatchedAlgo.loadModel(sSnapshotPath),lv::Exception);
+}
+
+TEST(pawcs,regression_reduced_resolution) {
+    for(int nChannels : {1,3}) {
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(runReducedResSyntheticSequence(nChannels,120,1),40);
+        const std::vector<cv::Mat> voMasksReduced = runReducedResSyntheticSequence(nChannels,120,2);
+        ASSERT_EQ(voMasksReduced.back().size(),cv::Size(320,240));
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(lv::test::getSyntheticFMeasure(voMasksReduced,40),dFMeasureRef,0.1) << "nChannels=" << nChannels;
+    }
+    // snapshots only hold the model itself, which would not match the full-res frames given on restore
+    BackgroundSubtractorPAWCS oAlgo;
+    oAlgo.setReducedResolution(2);
+    oAlgo.initialize(lv::test::genSyntheticFrame(cv::Size(320,240),3,0),cv::Mat());
+    ASSERT_THROW(oAlgo.saveModel(TEST_OUTPUT_DATA_ROOT "/pawcs_reduced_snapshot_test.bin"),lv::Exception);
+}
+
+TEST(pawcs,regression_activity_gating_unsupported) {
+    // the word models have no deferred update path, so gating must be refused instead of silently dropping updates
+    BackgroundSubtractorPAWCS oAlgo;
+    const cv::Mat oInitFrame = lv::test::genSyntheticFrame(cv::Size(160,120),3,0);
+    oAlgo.initialize(oInitFrame,cv::Mat());
+    oAlgo.setActivityGating(true);
+    cv::Mat oFGMask;
+    ASSERT_THROW(oAlgo.apply(oInitFrame,oFGMask),lv::Exception);
+}
+
+namespace {
+
+    void pawcs_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const int nChannels = (int)st.range(2);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx));
+        BackgroundSubtractorPAWCS oAlgo;
+        oAlgo.setColorPrefilter(st.range(3)!=0);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+}
+
+BENCHMARK(pawcs_perftest)->Args({640,480,3,0})->Args({640,480,3,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(pawcs_perftest)->Args({640,480,1,0})->Args({640,480,1,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
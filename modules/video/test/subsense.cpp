@@ -0,0 +1,746 @@
+#include "litiv/video/BackgroundSubtractorSuBSENSE.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+namespace {
+
+    /// runs SuBSENSE over a synthetic sequence and returns the output masks (realigned with their input frames in pipelined mode)
+    std::vector<cv::Mat> runSyntheticSequence(int nChannels, size_t nBandCount, uint32_t nSeed, size_t nFrames,
+                                              LBSPSampleStore::Layout eLayout=BGSLBSP_DEFAULT_SAMPLE_LAYOUT, bool bUseCompactState=false,
+                                              bool bUsePipelinedPostProc=false) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setParallelBandCount(nBandCount,nSeed);
+        oAlgo.setSampleLayout(eLayout);
+        oAlgo.setCompactStateMode(bUseCompactState);
+        oAlgo.setPipelinedPostProcessing(bUsePipelinedPostProc);
+        if(!bUsePipelinedPostProc)
+            return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames);
+        const cv::Size oSize(160,120);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,nChannels,0),cv::Mat());
+        std::vector<cv::Mat> voMasks(nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx) {
+            cv::Mat oFGMask;
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+            if(nFrameIdx>0)
+                voMasks[nFrameIdx-1] = oFGMask;
+            else if(cv::countNonZero(oFGMask)!=0)
+                return {}; // first output of the pipeline should always be empty
+        }
+        oAlgo.flushPipeline(voMasks.back());
+        return voMasks;
+    }
+
+    /// runs the multi-threaded SuBSENSE impl over a synthetic sequence and returns the output masks
+    std::vector<cv::Mat> runSyntheticSequence_CPUThreads(int nChannels, size_t nThreadCount, size_t nBandCount, uint32_t nSeed, size_t nFrames,
+                                                         const cv::Size& oTileSize=cv::Size()) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE_CPUThreads oAlgo;
+        oAlgo.setThreadCount(nThreadCount);
+        oAlgo.setParallelBandCount(nBandCount,nSeed);
+        oAlgo.setTileSize(oTileSize);
+        return lv::test::runSyntheticSequence(oAlgo,nChannels,nFrames);
+    }
+
+    /// gives access to the adaptive state maps of SuBSENSE (unpacked from the compact state array if needed)
+    struct SuBSENSEStateReader : BackgroundSubtractorSuBSENSE {
+        /// returns the mean distance threshold factor, i.e. R(x), over the whole frame
+        float getMeanDistThresholdFactor() {
+            if(m_bUseCompactState)
+                unpackCompactState();
+            return (float)cv::mean(m_oDistThresholdFrame)[0];
+        }
+        /// returns copies of the distance & raw segmentation mean maps (last dist, min dist LT/ST, raw segm res LT/ST)
+        std::vector<cv::Mat> getMeanStateMaps() {
+            if(m_bUseCompactState)
+                unpackCompactState();
+            return {m_oMeanLastDistFrame.clone(),m_oMeanMinDistFrame_LT.clone(),m_oMeanMinDistFrame_ST.clone(),m_oMeanRawSegmResFrame_LT.clone(),m_oMeanRawSegmResFrame_ST.clone()};
+        }
+        /// returns the LT & ST rolling average factors which the next call to 'apply' will use
+        std::pair<float,float> getNextRollAvgFactors() const {
+            return {1.0f/std::min(this->m_nFrameIdx+1,m_nSamplesForMovingAvgs),1.0f/std::min(this->m_nFrameIdx+1,m_nSamplesForMovingAvgs/4)};
+        }
+        /// gives direct access to the model reset cooldown counter
+        size_t& modelResetCooldown() {return this->m_nModelResetCooldown;}
+        /// overwrites the variation modulator, i.e. v(x), over the whole frame (repacking it in compact state mode)
+        void setVariationModulator(float fVal) {
+            if(m_bUseCompactState)
+                unpackCompactState();
+            m_oVariationModulatorFrame = cv::Scalar(fVal);
+            if(m_bUseCompactState)
+                packCompactState();
+        }
+        /// returns the max of the variation modulator, i.e. v(x), over the whole frame
+        double getMaxVariationModulator() {
+            if(m_bUseCompactState)
+                unpackCompactState();
+            double dMax;
+            cv::minMaxIdx(m_oVariationModulatorFrame,nullptr,&dMax);
+            return dMax;
+        }
+    };
+
+    /// gives direct access to the SuBSENSE post-processing chain, so tiled & full-frame runs can be fed identical raw masks
+    struct SuBSENSEPostProcRunner : BackgroundSubtractorSuBSENSE_CPUThreads {
+        /// runs the post-processing chain on a copy of the given raw mask using the algo's own feedback maps, and returns the final mask
+        cv::Mat postProcessRawMask(const cv::Mat& oRawFGMask, float fRollAvgFactor) {
+            cv::Mat oCurrFGMask = oRawFGMask.clone();
+            initPostProcTiles(); // normally done by 'apply', as the tile layout may change between frames
+            postProcess(oCurrFGMask,this->m_oLastFGMask,m_oBlinksFrame,m_oMeanFinalSegmResFrame_LT,m_oMeanFinalSegmResFrame_ST,this->m_voLatestBlobs,fRollAvgFactor,fRollAvgFactor);
+            return oCurrFGMask;
+        }
+        /// returns whether all post-processing outputs & feedback maps are bit-exact with those of another runner
+        ::testing::AssertionResult isPostProcStateEqual(const SuBSENSEPostProcRunner& oOther) const {
+            if(cv::countNonZero(this->m_oLastFGMask!=oOther.m_oLastFGMask) || cv::countNonZero(m_oBlinksFrame!=oOther.m_oBlinksFrame))
+                return ::testing::AssertionFailure() << "final mask or blinks map mismatch";
+            if(cv::norm(m_oMeanFinalSegmResFrame_LT,oOther.m_oMeanFinalSegmResFrame_LT,cv::NORM_INF)!=0.0 || cv::norm(m_oMeanFinalSegmResFrame_ST,oOther.m_oMeanFinalSegmResFrame_ST,cv::NORM_INF)!=0.0)
+                return ::testing::AssertionFailure() << "final segmentation result map mismatch";
+            if(this->m_voLatestBlobs.size()!=oOther.m_voLatestBlobs.size())
+                return ::testing::AssertionFailure() << "blob count mismatch";
+            for(size_t nBlobIdx=0; nBlobIdx<this->m_voLatestBlobs.size(); ++nBlobIdx)
+                if(this->m_voLatestBlobs[nBlobIdx].oBBox!=oOther.m_voLatestBlobs[nBlobIdx].oBBox || this->m_voLatestBlobs[nBlobIdx].vRuns!=oOther.m_voLatestBlobs[nBlobIdx].vRuns)
+                    return ::testing::AssertionFailure() << "blob #" << nBlobIdx << " mismatch";
+            return ::testing::AssertionSuccess();
+        }
+    };
+
+    /// runs SuBSENSE over a sequence made of real photos (an object cut from one image moving over another, with sensor noise & illumination flicker), and returns the output & ground truth masks
+    std::vector<cv::Mat> runRealImageSequence(BackgroundSubtractorSuBSENSE& oAlgo, int nChannels, size_t nFrames, std::vector<cv::Mat>& voGTMasks) {
+        const cv::Size oSize(240,160), oObjectSize(48,48);
+        cv::Mat oBGImage = cv::imread(SAMPLES_DATA_ROOT "/108073.jpg",nChannels==1?cv::IMREAD_GRAYSCALE:cv::IMREAD_COLOR);
+        cv::Mat oObjectImage = cv::imread(SAMPLES_DATA_ROOT "/custom_dataset_ex/batch1/124084.jpg",nChannels==1?cv::IMREAD_GRAYSCALE:cv::IMREAD_COLOR);
+        if(oBGImage.empty() || oObjectImage.empty())
+            return {};
+        cv::resize(oBGImage,oBGImage,oSize,0,0,cv::INTER_AREA);
+        cv::resize(oObjectImage(cv::Rect(oObjectImage.cols/4,oObjectImage.rows/4,oObjectImage.cols/2,oObjectImage.rows/2)),oObjectImage,oObjectSize,0,0,cv::INTER_AREA);
+        const auto lGenFrame = [&](size_t nFrameIdx, cv::Mat& oGTMask) {
+            cv::Mat oFrame = oBGImage.clone();
+            const cv::Rect oObjectBBox(int((nFrameIdx*3)%size_t(oSize.width-oObjectSize.width)),(oSize.height-oObjectSize.height)/2,oObjectSize.width,oObjectSize.height);
+            oGTMask.create(oSize,CV_8UC1);
+            oGTMask = cv::Scalar_<uchar>(0);
+            if(nFrameIdx>0) {
+                oObjectImage.copyTo(oFrame(oObjectBBox));
+                oGTMask(oObjectBBox) = cv::Scalar_<uchar>(255);
+            }
+            // global illumination flickers by +/-4 levels on top of the sensor noise
+            const int nFlicker = (nFrameIdx%2)?4:-4;
+            cv::Mat oNoise(oSize,CV_16SC(nChannels));
+            cv::RNG oNoiseRNG((uint64)(nFrameIdx+1));
+            oNoiseRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(nFlicker-6),cv::Scalar::all(nFlicker+6));
+            cv::add(oFrame,oNoise,oFrame,cv::noArray(),CV_8U);
+            return oFrame;
+        };
+        cv::Mat oFGMask;
+        voGTMasks.resize(nFrames);
+        oAlgo.initialize(lGenFrame(0,oFGMask),cv::Mat());
+        std::vector<cv::Mat> voMasks(nFrames);
+        for(size_t nFrameIdx=0; nFrameIdx<nFrames; ++nFrameIdx)
+            oAlgo.apply(lGenFrame(nFrameIdx,voGTMasks[nFrameIdx]),voMasks[nFrameIdx]);
+        return voMasks;
+    }
+
+    /// runs SuBSENSE over a heavily noisy sequence (to raise R(x)) followed by a long static one (where R(x) must decay), and returns R(x) means
+    void runDistThresholdRecoverySequence(int nChannels, bool bUseCompactState, float& fPeakMeanR, float& fFinalMeanR, bool bUseActivityGating=false) {
+        const cv::Size oSize(160,120);
+        srand(0);
+        SuBSENSEStateReader oAlgo;
+        oAlgo.setCompactStateMode(bUseCompactState);
+        oAlgo.setActivityGating(bUseActivityGating);
+        const cv::Mat oStaticFrame = lv::test::genSyntheticFrame(oSize,nChannels,0);
+        oAlgo.initialize(oStaticFrame,cv::Mat());
+        cv::Mat oFGMask;
+        for(size_t nFrameIdx=0; nFrameIdx<100; ++nFrameIdx) {
+            cv::Mat oNoise(oSize,CV_16SC(nChannels)), oNoisyFrame;
+            cv::RNG oNoiseRNG((uint64)(nFrameIdx+1));
+            oNoiseRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(-40),cv::Scalar::all(40));
+            cv::add(oStaticFrame,oNoise,oNoisyFrame,cv::noArray(),CV_8U);
+            oAlgo.apply(oNoisyFrame,oFGMask);
+        }
+        fPeakMeanR = oAlgo.getMeanDistThresholdFactor();
+        for(size_t nFrameIdx=0; nFrameIdx<600; ++nFrameIdx)
+            oAlgo.apply(oStaticFrame,oFGMask);
+        fFinalMeanR = oAlgo.getMeanDistThresholdFactor();
+    }
+
+}
+
+TEST(subsense,regression_sample_layouts) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksSampleMajor = runSyntheticSequence(nChannels,0,0,30,LBSPSampleStore::SampleMajor);
+        const std::vector<cv::Mat> voMasksPixelMajor = runSyntheticSequence(nChannels,0,0,30,LBSPSampleStore::PixelMajor);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksSampleMajor.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksSampleMajor[nFrameIdx]!=voMasksPixelMajor[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(subsense,regression_parallel_bands_deterministic) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksA = runSyntheticSequence(nChannels,4,42,30);
+        const std::vector<cv::Mat> voMasksB = runSyntheticSequence(nChannels,4,42,30);
+        ASSERT_EQ(voMasksA.size(),voMasksB.size());
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksA.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksA[nFrameIdx]!=voMasksB[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(subsense,regression_parallel_bands_vs_serial) {
+    for(int nChannels : {1,3}) {
+        // per-band PRNG streams & deferred cross-band spreads change individual pixels, but not the segmentation quality over the sequence
+        const std::vector<cv::Mat> voMasksSerial = runSyntheticSequence(nChannels,0,0,120);
+        const double dFMeasureSerial = lv::test::getSyntheticFMeasure(voMasksSerial,40);
+        EXPECT_GT(dFMeasureSerial,0.5) << "nChannels=" << nChannels;
+        for(size_t nBandCount : {size_t(4),size_t(8)}) {
+            const std::vector<cv::Mat> voMasksParallel = runSyntheticSequence(nChannels,nBandCount,0,120);
+            const double dFMeasureParallel = lv::test::getSyntheticFMeasure(voMasksParallel,40);
+            EXPECT_NEAR(dFMeasureParallel,dFMeasureSerial,0.01) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount;
+        }
+    }
+}
+
+TEST(subsense,regression_cpu_threads_vs_bands) {
+    for(int nChannels : {1,3}) {
+        // the multi-threaded impl uses the same band layout & per-band PRNG streams as the band-parallel mode
+        const std::vector<cv::Mat> voMasksBands = runSyntheticSequence(nChannels,4,42,30);
+        const std::vector<cv::Mat> voMasksSingleThread = runSyntheticSequence_CPUThreads(nChannels,1,4,42,30);
+        const std::vector<cv::Mat> voMasksMultiThread = runSyntheticSequence_CPUThreads(nChannels,4,4,42,30);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksBands.size(); ++nFrameIdx) {
+            ASSERT_EQ(cv::countNonZero(voMasksBands[nFrameIdx]!=voMasksSingleThread[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+            ASSERT_EQ(cv::countNonZero(voMasksSingleThread[nFrameIdx]!=voMasksMultiThread[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        }
+    }
+}
+
+TEST(subsense,regression_cpu_threads_2d_tiles) {
+    for(int nChannels : {1,3}) {
+        // full-width 2d tiles reproduce the row tile layout exactly, so only the tiled post-processing chain differs here
+        const std::vector<cv::Mat> voMasksRows = runSyntheticSequence_CPUThreads(nChannels,4,4,42,60);
+        const std::vector<cv::Mat> voMasksFullWidthTiles = runSyntheticSequence_CPUThreads(nChannels,4,4,42,60,cv::Size(160,30));
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksRows.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksRows[nFrameIdx]!=voMasksFullWidthTiles[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        const std::vector<cv::Mat> voMasksSingleThread = runSyntheticSequence_CPUThreads(nChannels,1,1,42,120,cv::Size(48,40));
+        const std::vector<cv::Mat> voMasksMultiThread = runSyntheticSequence_CPUThreads(nChannels,4,1,42,120,cv::Size(48,40));
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksSingleThread.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksSingleThread[nFrameIdx]!=voMasksMultiThread[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+        const double dFMeasureRows = lv::test::getSyntheticFMeasure(runSyntheticSequence_CPUThreads(nChannels,4,4,42,120),40);
+        EXPECT_GT(dFMeasureRows,0.5) << "nChannels=" << nChannels;
+        EXPECT_NEAR(lv::test::getSyntheticFMeasure(voMasksMultiThread,40),dFMeasureRows,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_tiled_post_processing) {
+    const cv::Size oSize(160,120);
+    // none of these tile sizes divide the frame size, so the last tile row & column are clipped
+    for(const cv::Size& oTileSize : {cv::Size(48,36),cv::Size(37,29),cv::Size(100,50)}) {
+        SuBSENSEPostProcRunner oAlgoFullFrame,oAlgoTiled;
+        oAlgoTiled.setThreadCount(4);
+        oAlgoTiled.setTileSize(oTileSize);
+        for(SuBSENSEPostProcRunner* pAlgo : {&oAlgoFullFrame,&oAlgoTiled}) {
+            pAlgo->setBlobExtraction(true,true);
+            pAlgo->initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        }
+        for(size_t nFrameIdx=1; nFrameIdx<60; ++nFrameIdx) {
+            // moving square with speckle noise, so that closing, hole filling & median all alter the mask across tile seams
+            cv::Mat oNoise(oSize,CV_8UC1), oRawFGMask;
+            cv::RNG((uint64)nFrameIdx).fill(oNoise,cv::RNG::UNIFORM,0,256);
+            cv::bitwise_or(lv::test::genSyntheticGTMask(oSize,nFrameIdx),(oNoise>235),oRawFGMask);
+            const float fRollAvgFactor = 1.0f/std::min(nFrameIdx,(size_t)25);
+            const cv::Mat oFGMaskFullFrame = oAlgoFullFrame.postProcessRawMask(oRawFGMask,fRollAvgFactor);
+            const cv::Mat oFGMaskTiled = oAlgoTiled.postProcessRawMask(oRawFGMask,fRollAvgFactor);
+            ASSERT_EQ(cv::countNonZero(oFGMaskFullFrame!=oFGMaskTiled),0) << "oTileSize=" << oTileSize << ", nFrameIdx=" << nFrameIdx;
+            ASSERT_TRUE(oAlgoTiled.isPostProcStateEqual(oAlgoFullFrame)) << "oTileSize=" << oTileSize << ", nFrameIdx=" << nFrameIdx;
+        }
+    }
+}
+
+TEST(subsense,regression_compact_state) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksFloat = runSyntheticSequence(nChannels,4,0,120);
+        const std::vector<cv::Mat> voMasksCompact = runSyntheticSequence(nChannels,4,0,120,BGSLBSP_DEFAULT_SAMPLE_LAYOUT,true);
+        const double dFMeasureFloat = lv::test::getSyntheticFMeasure(voMasksFloat,40);
+        const double dFMeasureCompact = lv::test::getSyntheticFMeasure(voMasksCompact,40);
+        EXPECT_GT(dFMeasureFloat,0.5) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureCompact,dFMeasureFloat,0.02) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_compact_state_recovery) {
+    for(int nChannels : {1,3}) {
+        float fPeakMeanR_Float,fFinalMeanR_Float,fPeakMeanR_Compact,fFinalMeanR_Compact;
+        runDistThresholdRecoverySequence(nChannels,false,fPeakMeanR_Float,fFinalMeanR_Float);
+        runDistThresholdRecoverySequence(nChannels,true,fPeakMeanR_Compact,fFinalMeanR_Compact);
+        ASSERT_GT(fPeakMeanR_Float-fFinalMeanR_Float,0.05f) << "nChannels=" << nChannels;
+        // with v(x) high after the noisy part, R(x) decrements are smaller than a quantization step, and must not get lost
+        EXPECT_GT(fPeakMeanR_Compact-fFinalMeanR_Compact,(fPeakMeanR_Float-fFinalMeanR_Float)*0.75f) << "nChannels=" << nChannels;
+        EXPECT_NEAR(fFinalMeanR_Compact,fFinalMeanR_Float,fFinalMeanR_Float*0.1f) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_compact_state_variation_range) {
+    const cv::Size oSize(160,120);
+    for(int nChannels : {1,3}) {
+        std::array<double,2> adMaxVariations;
+        for(bool bUseCompactState : {false,true}) {
+            srand(0);
+            SuBSENSEStateReader oAlgo;
+            oAlgo.setCompactStateMode(bUseCompactState);
+            const cv::Mat oStaticFrame = lv::test::genSyntheticFrame(oSize,nChannels,0);
+            oAlgo.initialize(oStaticFrame,cv::Mat());
+            // start v(x) right below 256, then make pixels blink long enough to push it past that
+            oAlgo.setVariationModulator(250.0f);
+            cv::Mat oFGMask;
+            for(size_t nFrameIdx=0; nFrameIdx<100; ++nFrameIdx) {
+                cv::Mat oNoise(oSize,CV_16SC(nChannels)), oNoisyFrame;
+                cv::RNG oNoiseRNG((uint64)(nFrameIdx+1));
+                oNoiseRNG.fill(oNoise,cv::RNG::UNIFORM,cv::Scalar::all(-40),cv::Scalar::all(40));
+                cv::add(oStaticFrame,oNoise,oNoisyFrame,cv::noArray(),CV_8U);
+                oAlgo.apply(oNoisyFrame,oFGMask);
+            }
+            adMaxVariations[bUseCompactState] = oAlgo.getMaxVariationModulator();
+        }
+        // v(x) is unbounded in float mode, and the compact state range must follow it well past 256
+        ASSERT_GT(adMaxVariations[0],256.0) << "nChannels=" << nChannels;
+        EXPECT_NEAR(adMaxVariations[1],adMaxVariations[0],2.0) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_compact_state_real_images) {
+    for(int nChannels : {1,3}) {
+        std::array<double,2> adFMeasures;
+        for(bool bUseCompactState : {false,true}) {
+            srand(0);
+            BackgroundSubtractorSuBSENSE oAlgo;
+            oAlgo.setCompactStateMode(bUseCompactState);
+            std::vector<cv::Mat> voGTMasks;
+            const std::vector<cv::Mat> voMasks = runRealImageSequence(oAlgo,nChannels,200,voGTMasks);
+            ASSERT_FALSE(voMasks.empty()) << " --- make sure the sample images are available in " SAMPLES_DATA_ROOT;
+            adFMeasures[bUseCompactState] = lv::test::getFMeasure(voMasks,voGTMasks,50);
+        }
+        EXPECT_GT(adFMeasures[0],0.5) << "nChannels=" << nChannels;
+        EXPECT_NEAR(adFMeasures[1],adFMeasures[0],0.02) << "nChannels=" << nChannels;
+    }
+}
+
+#if USE_OPENCV_x264_TEST
+
+TEST(subsense,regression_compact_state_real_sequence) {
+    const std::string sFileLocation = SAMPLES_DATA_ROOT "/tractor.mp4";
+    cv::VideoCapture oCap(sFileLocation);
+    ASSERT_TRUE(oCap.isOpened()) << " --- make sure your OpenCV installation can read x264 videos!";
+    std::vector<cv::Mat> voFrames;
+    cv::Mat oFrame;
+    while(voFrames.size()<200 && oCap.read(oFrame)) {
+        cv::resize(oFrame,oFrame,cv::Size(oFrame.cols/4,oFrame.rows/4),0,0,cv::INTER_AREA);
+        voFrames.push_back(oFrame.clone());
+    }
+    ASSERT_EQ(voFrames.size(),size_t(200));
+    std::array<std::vector<cv::Mat>,2> avvoMasks;
+    for(bool bUseCompactState : {false,true}) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setCompactStateMode(bUseCompactState);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        std::vector<cv::Mat>& voMasks = avvoMasks[bUseCompactState];
+        voMasks.resize(voFrames.size());
+        for(size_t nFrameIdx=0; nFrameIdx<voFrames.size(); ++nFrameIdx)
+            oAlgo.apply(voFrames[nFrameIdx],voMasks[nFrameIdx]);
+    }
+    // no ground truth is shipped with the sample video, so the float path output is used as reference
+    EXPECT_GT(lv::test::getFMeasure(avvoMasks[1],avvoMasks[0],50),0.9);
+}
+
+#endif //USE_OPENCV_x264_TEST
+
+TEST(subsense,regression_pipelined_post_processing) {
+    for(int nChannels : {1,3}) {
+        for(size_t nBandCount : {size_t(0),size_t(4)}) {
+            const std::vector<cv::Mat> voMasksSerial = runSyntheticSequence(nChannels,nBandCount,0,120);
+            const std::vector<cv::Mat> voMasksPipelinedA = runSyntheticSequence(nChannels,nBandCount,0,120,BGSLBSP_DEFAULT_SAMPLE_LAYOUT,false,true);
+            const std::vector<cv::Mat> voMasksPipelinedB = runSyntheticSequence(nChannels,nBandCount,0,120,BGSLBSP_DEFAULT_SAMPLE_LAYOUT,false,true);
+            ASSERT_EQ(voMasksPipelinedA.size(),voMasksSerial.size()) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount;
+            ASSERT_EQ(voMasksPipelinedB.size(),voMasksSerial.size()) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount;
+            for(size_t nFrameIdx=0; nFrameIdx<voMasksPipelinedA.size(); ++nFrameIdx)
+                ASSERT_EQ(cv::countNonZero(voMasksPipelinedA[nFrameIdx]!=voMasksPipelinedB[nFrameIdx]),0) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount << ", nFrameIdx=" << nFrameIdx;
+            // the pipelined feedback loop lags by one extra frame, so results are only expected to be statistically equivalent
+            const double dFMeasureSerial = lv::test::getSyntheticFMeasure(voMasksSerial,40);
+            const double dFMeasurePipelined = lv::test::getSyntheticFMeasure(voMasksPipelinedA,40);
+            EXPECT_GT(dFMeasureSerial,0.5) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount;
+            EXPECT_NEAR(dFMeasurePipelined,dFMeasureSerial,0.03) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount;
+        }
+    }
+    const cv::Size oSize(160,120);
+    const std::string sSnapshotPath = TEST_OUTPUT_DATA_ROOT "/subsense_pipelined_snapshot_test.bin";
+    BackgroundSubtractorSuBSENSE oAlgo;
+    oAlgo.setPipelinedPostProcessing(true);
+    ASSERT_TRUE(oAlgo.isUsingPipelinedPostProcessing());
+    oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+    cv::Mat oFGMask,oFlushedFGMask;
+    for(size_t nFrameIdx=0; nFrameIdx<20; ++nFrameIdx)
+        oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx),oFGMask);
+    ASSERT_THROW(oAlgo.saveModel(sSnapshotPath),lv::Exception);
+    oAlgo.flushPipeline(oFlushedFGMask);
+    ASSERT_NO_THROW(oAlgo.saveModel(sSnapshotPath));
+    oAlgo.setPipelinedPostProcessing(false);
+    ASSERT_FALSE(oAlgo.isUsingPipelinedPostProcessing());
+    oAlgo.flushPipeline(oFGMask);
+    ASSERT_EQ(cv::countNonZero(oFGMask!=oFlushedFGMask),0);
+}
+
+TEST(subsense,regression_stats) {
+    const cv::Size oSize(160,120);
+    for(size_t nBandCount : {size_t(0),size_t(4)}) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setParallelBandCount(nBandCount);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        cv::Mat oFGMask;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx),oFGMask);
+        const BackgroundSubtractorStats& oStats = oAlgo.getStats();
+        const std::string sJSON = oStats.toJSON();
+        for(size_t nStageIdx=0; nStageIdx<BackgroundSubtractorStats::StageCount; ++nStageIdx)
+            ASSERT_NE(sJSON.find(BackgroundSubtractorStats::getStageName((BackgroundSubtractorStats::Stage)nStageIdx)),std::string::npos);
+        if(BackgroundSubtractorSuBSENSE::isInstrumentationEnabled()) {
+            ASSERT_EQ(oStats.nFrames,size_t(10));
+            ASSERT_GT(oStats.nPixels,size_t(0));
+            ASSERT_EQ(oStats.nPixels%10,size_t(0));
+            ASSERT_GE(oStats.nTestedSamples,oStats.nMatchedSamples);
+            ASSERT_GE(oStats.getMeanTestedSamples(),1.0);
+            ASSERT_GT(oStats.adStageTimes[BackgroundSubtractorStats::Stage_SampleMatching],0.0);
+            ASSERT_GT(oStats.adStageTimes[BackgroundSubtractorStats::Stage_PostProcessing],0.0);
+            ASSERT_NE(sJSON.find("\"instrumented\": true"),std::string::npos);
+        }
+        else {
+            ASSERT_EQ(oStats.nFrames,size_t(0));
+            ASSERT_EQ(oStats.getTotalTime(),0.0);
+            ASSERT_NE(sJSON.find("\"instrumented\": false"),std::string::npos);
+        }
+        oAlgo.resetStats();
+        ASSERT_EQ(oAlgo.getStats().nFrames,size_t(0));
+        ASSERT_EQ(oAlgo.getStats().nTestedSamples,size_t(0));
+    }
+}
+
+TEST(subsense,regression_model_snapshot) {
+    const cv::Size oSize(160,120);
+    const std::string sSnapshotPath = TEST_OUTPUT_DATA_ROOT "/subsense_snapshot_test.bin";
+    for(int nChannels : {1,3}) {
+        for(LBSPSampleStore::Layout eLayout : {LBSPSampleStore::SampleMajor,LBSPSampleStore::PixelMajor}) {
+            srand(0);
+            BackgroundSubtractorSuBSENSE oAlgo;
+            oAlgo.setParallelBandCount(2,7);
+            oAlgo.setSampleLayout(eLayout);
+            oAlgo.initialize(lv::test::genSyntheticFrame(oSize,nChannels,0),cv::Mat());
+            cv::Mat oFGMask,oRestoredFGMask;
+            for(size_t nFrameIdx=0; nFrameIdx<20; ++nFrameIdx)
+                oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+            oAlgo.saveModel(sSnapshotPath);
+            BackgroundSubtractorSuBSENSE oRestoredAlgo;
+            oRestoredAlgo.setParallelBandCount(2,7);
+            oRestoredAlgo.loadModel(sSnapshotPath);
+            for(size_t nFrameIdx=20; nFrameIdx<40; ++nFrameIdx) {
+                oAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oFGMask);
+                oRestoredAlgo.apply(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx),oRestoredFGMask);
+                ASSERT_EQ(cv::countNonZero(oFGMask!=oRestoredFGMask),0) << "nChannels=" << nChannels << ", eLayout=" << (int)eLayout << ", nFrameIdx=" << nFrameIdx;
+            }
+            cv::Mat oBGImg,oRestoredBGImg;
+            oAlgo.getBackgroundImage(oBGImg);
+            oRestoredAlgo.getBackgroundImage(oRestoredBGImg);
+            ASSERT_TRUE(lv::isEqual<uchar>(oBGImg,oRestoredBGImg));
+        }
+    }
+    BackgroundSubtractorSuBSENSE oMismatchedAlgo(BGSSUBSENSE_DEFAULT_DESC_DIST_THRESHOLD_OFFSET,BGSSUBSENSE_DEFAULT_MIN_COLOR_DIST_THRESHOLD,BGSSUBSENSE_DEFAULT_NB_BG_SAMPLES/2);
+    ASSERT_THROW(oMismatchedAlgo.loadModel(sSnapshotPath),lv::Exception);
+    ASSERT_THROW(oMismatchedAlgo.loadModel(TEST_OUTPUT_DATA_ROOT "/subsense_missing_snapshot.bin"),lv::Exception);
+}
+
+TEST(subsense,regression_activity_gating) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        double dRatioRef=0.0,dRatioGated=0.0;
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgoRef;
+        oAlgoRef.setActivityGating(false);
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize,0,[&](size_t) {
+            dRatioRef += oAlgoRef.getActiveBlockRatio()/120;
+        }),40);
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgoGated;
+        oAlgoGated.setActivityGating(true);
+        const double dFMeasureGated = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoGated,nChannels,120,oSize,0,[&](size_t) {
+            dRatioGated += oAlgoGated.getActiveBlockRatio()/120;
+        }),40);
+        // only the moving square & its surroundings (plus the staggered refreshes) should be processed once the model is bootstrapped
+        ASSERT_NEAR(dRatioRef,1.0,1e-6);
+        EXPECT_LT(dRatioGated,0.5) << "nChannels=" << nChannels;
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureGated,dFMeasureRef,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_activity_gating_deferred_updates) {
+    for(int nChannels : {1,3}) {
+        float fPeakMeanR_Ref,fFinalMeanR_Ref,fPeakMeanR_Gated,fFinalMeanR_Gated;
+        runDistThresholdRecoverySequence(nChannels,false,fPeakMeanR_Ref,fFinalMeanR_Ref);
+        runDistThresholdRecoverySequence(nChannels,false,fPeakMeanR_Gated,fFinalMeanR_Gated,true);
+        ASSERT_GT(fPeakMeanR_Ref-fFinalMeanR_Ref,0.05f) << "nChannels=" << nChannels;
+        // the static part is almost entirely gated; R(x) must still decay as if each skipped frame had been processed
+        EXPECT_GT(fPeakMeanR_Gated-fFinalMeanR_Gated,(fPeakMeanR_Ref-fFinalMeanR_Ref)*0.75f) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_blob_extraction) {
+    const cv::Size oSize(160,120);
+    for(bool bUsePipelinedPostProc : {false,true}) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setPipelinedPostProcessing(bUsePipelinedPostProc);
+        oAlgo.setBlobExtraction(true,true);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        cv::Mat oFGMask;
+        // in pipelined mode, the blobs are published along with the (delayed) output mask
+        for(size_t nFrameIdx=0; nFrameIdx<40; ++nFrameIdx) {
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx),oFGMask);
+            ASSERT_TRUE(lv::test::isBlobListValid(oFGMask,oAlgo.getLatestBlobs())) << "bUsePipelinedPostProc=" << bUsePipelinedPostProc << ", nFrameIdx=" << nFrameIdx;
+        }
+        oAlgo.flushPipeline(oFGMask);
+        ASSERT_TRUE(lv::test::isBlobListValid(oFGMask,oAlgo.getLatestBlobs())) << "bUsePipelinedPostProc=" << bUsePipelinedPostProc;
+    }
+    BackgroundSubtractorSuBSENSE_CPUThreads oTiledAlgo;
+    oTiledAlgo.setTileSize(cv::Size(48,40));
+    oTiledAlgo.setBlobExtraction(true,true);
+    oTiledAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+    cv::Mat oFGMask;
+    for(size_t nFrameIdx=0; nFrameIdx<40; ++nFrameIdx) {
+        oTiledAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx),oFGMask);
+        ASSERT_TRUE(lv::test::isBlobListValid(oFGMask,oTiledAlgo.getLatestBlobs())) << "nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(subsense,regression_batch) {
+    for(int nChannels : {1,3}) {
+        // SuBSENSE has no multi-frame blocking (each frame's pixel loop needs the previous frame's whole-frame feedback), so batches are applied frame by frame
+        for(size_t nBandCount : {0,4}) {
+            srand(0);
+            BackgroundSubtractorSuBSENSE oAlgoRef;
+            oAlgoRef.setParallelBandCount(nBandCount,42);
+            const std::vector<cv::Mat> voMasksRef = lv::test::runSyntheticSequence(oAlgoRef,nChannels,30);
+            srand(0);
+            BackgroundSubtractorSuBSENSE oAlgoBatched;
+            oAlgoBatched.setParallelBandCount(nBandCount,42);
+            const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,30,cv::Size(160,120),7);
+            for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+                ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", nBandCount=" << nBandCount << ", nFrameIdx=" << nFrameIdx;
+        }
+        BackgroundSubtractorSuBSENSE_CPUThreads oAlgoRef;
+        oAlgoRef.setTileSize(cv::Size(48,40));
+        const std::vector<cv::Mat> voMasksRef = lv::test::runSyntheticSequence(oAlgoRef,nChannels,40);
+        BackgroundSubtractorSuBSENSE_CPUThreads oAlgoBatched;
+        oAlgoBatched.setTileSize(cv::Size(48,40));
+        const std::vector<cv::Mat> voMasksBatched = lv::test::runSyntheticSequence(oAlgoBatched,nChannels,40,cv::Size(160,120),8);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksRef.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksRef[nFrameIdx]!=voMasksBatched[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(subsense,regression_reduced_resolution) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgoRef;
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize),40);
+        for(size_t nScaleFactor : {2,4}) {
+            srand(0);
+            BackgroundSubtractorSuBSENSE oAlgoReduced;
+            oAlgoReduced.setReducedResolution(nScaleFactor);
+            const std::vector<cv::Mat> voMasksReduced = lv::test::runSyntheticSequence(oAlgoReduced,nChannels,120,oSize);
+            ASSERT_EQ(voMasksReduced.back().size(),oSize);
+            EXPECT_NEAR(lv::test::getSyntheticFMeasure(voMasksReduced,40),dFMeasureRef,0.1) << "nChannels=" << nChannels << ", nScaleFactor=" << nScaleFactor;
+        }
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+    }
+    BackgroundSubtractorSuBSENSE oAlgo;
+    oAlgo.setReducedResolution(2);
+    oAlgo.setPipelinedPostProcessing(true);
+    cv::Mat oFGMask;
+    oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+    ASSERT_THROW(oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,1),oFGMask),lv::Exception);
+}
+
+TEST(subsense,regression_frame_time_budget) {
+    ASSERT_NO_FATAL_FAILURE(lv::test::checkFrameTimeBudget<BackgroundSubtractorSuBSENSE>());
+}
+
+TEST(subsense,regression_frame_time_budget_state_decay) {
+    const cv::Size oSize(160,120);
+    for(bool bUseCompactState : {false,true}) {
+        srand(0);
+        SuBSENSEStateReader oAlgo;
+        oAlgo.setCompactStateMode(bUseCompactState);
+        oAlgo.setFrameTimeBudget(1e-6);
+        oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        // frames are processed until the LT & ST rates differ, and the next skipped frame is then checked
+        while(nFrameIdx<40 || (nFrameIdx-2)%(BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES+1)==BGS_DEFAULT_MAX_CONSECUTIVE_SKIPPED_FRAMES)
+            oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx++),oFGMask);
+        const std::vector<cv::Mat> voMapsBefore = oAlgo.getMeanStateMaps();
+        const std::pair<float,float> oRollAvgFactors = oAlgo.getNextRollAvgFactors();
+        ASSERT_NE(oRollAvgFactors.first,oRollAvgFactors.second);
+        oAlgo.modelResetCooldown() = 5;
+        oAlgo.apply(lv::test::genSyntheticFrame(oSize,3,nFrameIdx),oFGMask);
+        ASSERT_TRUE(oAlgo.isLastFrameSkipped()) << "bUseCompactState=" << bUseCompactState;
+        EXPECT_EQ(oAlgo.modelResetCooldown(),size_t(4)) << "bUseCompactState=" << bUseCompactState;
+        const std::vector<cv::Mat> voMapsAfter = oAlgo.getMeanStateMaps();
+        // one packing step (plus dither) of error is allowed in compact state mode
+        const double dMaxError = bUseCompactState?2.0/65536:1e-6;
+        for(size_t nMapIdx=0; nMapIdx<voMapsBefore.size(); ++nMapIdx) {
+            const bool bLongTerm = nMapIdx==1 || nMapIdx==3;
+            ASSERT_GT(cv::norm(voMapsBefore[nMapIdx],cv::NORM_INF),0.0) << "bUseCompactState=" << bUseCompactState << ", nMapIdx=" << nMapIdx;
+            const cv::Mat oExpectedMap = voMapsBefore[nMapIdx]*(1.0f-(bLongTerm?oRollAvgFactors.first:oRollAvgFactors.second));
+            EXPECT_LE(cv::norm(voMapsAfter[nMapIdx],oExpectedMap,cv::NORM_INF),dMaxError) << "bUseCompactState=" << bUseCompactState << ", nMapIdx=" << nMapIdx;
+        }
+    }
+}
+
+TEST(subsense,regression_sample_reordering) {
+    const cv::Size oSize(320,240);
+    for(int nChannels : {1,3}) {
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgoRef;
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoRef,nChannels,120,oSize),40);
+        srand(0);
+        BackgroundSubtractorSuBSENSE oAlgoReordered;
+        oAlgoReordered.setSampleReordering(true);
+        ASSERT_TRUE(oAlgoReordered.isUsingSampleReordering());
+        const double dFMeasureReordered = lv::test::getSyntheticFMeasure(lv::test::runSyntheticSequence(oAlgoReordered,nChannels,120,oSize),40);
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureReordered,dFMeasureRef,0.05) << "nChannels=" << nChannels;
+        // samples which keep matching get tested first, so the early exit should never come later on average
+        if(BackgroundSubtractorSuBSENSE::isInstrumentationEnabled())
+            EXPECT_LE(oAlgoReordered.getStats().getMeanTestedSamples(),oAlgoRef.getStats().getMeanTestedSamples()) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(subsense,regression_sample_reordering_stationary) {
+    ASSERT_NO_FATAL_FAILURE(lv::test::checkSampleReorderingOnStationarySequence<BackgroundSubtractorSuBSENSE>());
+}
+
+namespace {
+
+    void subsense_budget_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const double dBudgetMS = (double)st.range(2);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setFrameTimeBudget(dBudgetMS);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        st.SetItemsProcessed(int64_t(st.iterations()));
+        st.SetLabel(lv::putf("%.1f%% skipped",st.iterations()?100.0*oAlgo.getSkippedFrameCount()/st.iterations():0.0));
+    }
+
+    void subsense_reordering_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setSampleReordering(st.range(2)!=0);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        if(BackgroundSubtractorSuBSENSE::isInstrumentationEnabled())
+            st.SetLabel(lv::putf("%.2f samples/px",oAlgo.getStats().getMeanTestedSamples()));
+    }
+
+    void subsense_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const int nChannels = (int)st.range(2);
+        const size_t nBandCount = (size_t)st.range(3);
+        const LBSPSampleStore::Layout eLayout = (LBSPSampleStore::Layout)st.range(4);
+        const bool bUseCompactState = st.range(5)!=0;
+        const bool bUsePipelinedPostProc = st.range(6)!=0;
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx));
+        BackgroundSubtractorSuBSENSE oAlgo;
+        oAlgo.setParallelBandCount(nBandCount);
+        oAlgo.setSampleLayout(eLayout);
+        oAlgo.setCompactStateMode(bUseCompactState);
+        oAlgo.setPipelinedPostProcessing(bUsePipelinedPostProc);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+        // sustained frame rate is reported as items/s; the segmentation quality of the same config is measured on the small test sequence
+        st.SetItemsProcessed(int64_t(st.iterations()));
+        const double dFMeasure = lv::test::getSyntheticFMeasure(runSyntheticSequence(nChannels,nBandCount,0,120,eLayout,bUseCompactState,bUsePipelinedPostProc),40);
+        st.SetLabel(lv::putf("F-measure: %.4f",dFMeasure));
+    }
+
+    void subsense_tiles_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const cv::Size oTileSize((int)st.range(2),(int)st.range(3));
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<4; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,3,nFrameIdx));
+        BackgroundSubtractorSuBSENSE_CPUThreads oAlgo;
+        oAlgo.setTileSize(oTileSize);
+        oAlgo.initialize(voFrames[0],cv::Mat());
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            oAlgo.apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+    void subsense_snapshot_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const std::string sSnapshotPath = TEST_OUTPUT_DATA_ROOT "/subsense_snapshot_perftest.bin";
+        {
+            BackgroundSubtractorSuBSENSE oAlgo;
+            oAlgo.initialize(lv::test::genSyntheticFrame(oSize,3,0),cv::Mat());
+            oAlgo.saveModel(sSnapshotPath);
+        }
+        BackgroundSubtractorSuBSENSE oAlgo;
+        while(st.KeepRunning()) {
+            oAlgo.loadModel(sSnapshotPath);
+            benchmark::DoNotOptimize(&oAlgo);
+        }
+    }
+
+}
+
+BENCHMARK(subsense_snapshot_perftest)->Args({1920,1080})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,3,0,LBSPSampleStore::SampleMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,3,0,LBSPSampleStore::PixelMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,1,0,LBSPSampleStore::SampleMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,1,0,LBSPSampleStore::PixelMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,3,4,LBSPSampleStore::PixelMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,3,16,LBSPSampleStore::PixelMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({1920,1080,3,16,LBSPSampleStore::PixelMajor,0,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({1920,1080,3,16,LBSPSampleStore::PixelMajor,1,0})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({640,480,3,0,LBSPSampleStore::PixelMajor,0,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_perftest)->Args({1920,1080,3,16,LBSPSampleStore::PixelMajor,0,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_tiles_perftest)->Args({3840,2160,0,0})->Args({3840,2160,128,64})->Args({3840,2160,256,128})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_budget_perftest)->Args({1280,720,0})->Args({1280,720,20})->Args({1280,720,5})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
+BENCHMARK(subsense_reordering_perftest)->Args({1280,720,0})->Args({1280,720,1})->Unit(benchmark::kMillisecond)->Repetitions(3)->ReportAggregatesOnly(true);
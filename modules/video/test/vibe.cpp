@@ -0,0 +1,88 @@
+#include "litiv/video/BackgroundSubtractorViBe.hpp"
+#include "litiv/test.hpp"
+#include "bgsutils.hpp"
+
+namespace {
+
+    /// creates either the reference or the vectorized ViBe implementation for the given channel count
+    std::unique_ptr<BackgroundSubtractorViBe> createAlgo(int nChannels, bool bUseVectorized, uint32_t nSeed=0) {
+        return lv::test::createVectorizableAlgo<BackgroundSubtractorViBe,BackgroundSubtractorViBe_1ch,BackgroundSubtractorViBe_3ch,
+                                                BackgroundSubtractorViBe_1ch_vec,BackgroundSubtractorViBe_3ch_vec>(nChannels,bUseVectorized,nSeed);
+    }
+
+    /// runs ViBe over a synthetic sequence and returns the output masks
+    std::vector<cv::Mat> runSyntheticSequence(int nChannels, size_t nFrames, bool bUseVectorized, uint32_t nSeed=0) {
+        srand(0);
+        std::unique_ptr<BackgroundSubtractorViBe> pAlgo = createAlgo(nChannels,bUseVectorized,nSeed);
+        return lv::test::runSyntheticSequence(*pAlgo,nChannels,nFrames);
+    }
+
+}
+
+TEST(vibe,regression_vectorized_vs_reference) {
+    for(int nChannels : {1,3}) {
+        // both versions draw from different generators, so only the segmentation quality can be compared
+        const double dFMeasureRef = lv::test::getSyntheticFMeasure(runSyntheticSequence(nChannels,120,false),40);
+        const double dFMeasureVec = lv::test::getSyntheticFMeasure(runSyntheticSequence(nChannels,120,true),40);
+        EXPECT_GT(dFMeasureRef,0.4) << "nChannels=" << nChannels;
+        EXPECT_NEAR(dFMeasureVec,dFMeasureRef,0.05) << "nChannels=" << nChannels;
+    }
+}
+
+TEST(vibe,regression_vectorized_deterministic) {
+    for(int nChannels : {1,3}) {
+        const std::vector<cv::Mat> voMasksA = runSyntheticSequence(nChannels,30,true,42);
+        srand(1234); // the vectorized version must not depend on the global PRNG
+        const std::vector<cv::Mat> voMasksB = runSyntheticSequence(nChannels,30,true,42);
+        for(size_t nFrameIdx=0; nFrameIdx<voMasksA.size(); ++nFrameIdx)
+            ASSERT_EQ(cv::countNonZero(voMasksA[nFrameIdx]!=voMasksB[nFrameIdx]),0) << "nChannels=" << nChannels << ", nFrameIdx=" << nFrameIdx;
+    }
+}
+
+TEST(vibe,regression_vectorized_simd_vs_scalar) {
+    lv::test::checkVectorizedVsScalar<BackgroundSubtractorViBe_1ch_vec>(1,60);
+    lv::test::checkVectorizedVsScalar<BackgroundSubtractorViBe_3ch_vec>(3,60);
+}
+
+TEST(vibe,regression_vectorized_bg_image) {
+    const cv::Size oSize(160,120);
+    for(int nChannels : {1,3}) {
+        const cv::Mat oInitImg = lv::test::genSyntheticFrame(oSize,nChannels,0);
+        srand(0);
+        std::unique_ptr<BackgroundSubtractorViBe> pAlgoRef = createAlgo(nChannels,false);
+        std::unique_ptr<BackgroundSubtractorViBe> pAlgoVec = createAlgo(nChannels,true);
+        pAlgoRef->initialize(oInitImg);
+        pAlgoVec->initialize(oInitImg);
+        cv::Mat oBGImgRef, oBGImgVec;
+        pAlgoRef->getBackgroundImage(oBGImgRef);
+        pAlgoVec->getBackgroundImage(oBGImgVec);
+        ASSERT_EQ(oBGImgRef.type(),oBGImgVec.type());
+        ASSERT_EQ(oBGImgRef.size(),oBGImgVec.size());
+        // both models are sampled from the same local neighborhoods, so their averages should only differ by sampling noise
+        EXPECT_LT(cv::norm(oBGImgRef,oBGImgVec,cv::NORM_L1)/(oSize.area()*nChannels),4.0) << "nChannels=" << nChannels;
+    }
+}
+
+namespace {
+
+    void vibe_perftest(benchmark::State& st) {
+        const cv::Size oSize((int)st.range(0),(int)st.range(1));
+        const int nChannels = (int)st.range(2);
+        std::vector<cv::Mat> voFrames;
+        for(size_t nFrameIdx=0; nFrameIdx<10; ++nFrameIdx)
+            voFrames.push_back(lv::test::genSyntheticFrame(oSize,nChannels,nFrameIdx));
+        std::unique_ptr<BackgroundSubtractorViBe> pAlgo = createAlgo(nChannels,st.range(3)!=0);
+        pAlgo->initialize(voFrames[0]);
+        cv::Mat oFGMask;
+        size_t nFrameIdx = 0;
+        while(st.KeepRunning()) {
+            pAlgo->apply(voFrames[nFrameIdx],oFGMask);
+            nFrameIdx = (nFrameIdx+1)%voFrames.size();
+            benchmark::DoNotOptimize(oFGMask.data);
+        }
+    }
+
+}
+
+BENCHMARK(vibe_perftest)->Args({640,480,1,0})->Args({640,480,1,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);
+BENCHMARK(vibe_perftest)->Args({640,480,3,0})->Args({640,480,3,1})->Unit(benchmark::kMillisecond)->Repetitions(5)->ReportAggregatesOnly(true);